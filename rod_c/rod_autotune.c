@@ -0,0 +1,343 @@
+/**
+ * @file rod_autotune.c
+ * @brief Offline search of the cheapest adaptive threshold windows
+ * @author Noé Game
+ * @date 14/10/2026
+ * @see rod_config.h
+ * @copyright Cecill-C (Cf. LICENCE.txt)
+ *
+ * This program:
+ * - Loads recorded frames through the emulated camera (same stream as rod_detection)
+ * - Detects with the current profile (ROD_ADAPTIVE_THRESH_WIN_SIZE_*) as reference
+ * - Sweeps threshold windows from the fewest passes up and keeps the sets that
+ *   find every fixed marker (20-23) of the reference and enough of the others
+ * - Prints the fastest accepted set as rod_config.h macros
+ */
+
+/* ******************************************************* Includes ****************************************************** */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <stdbool.h>
+#include "camera_interface.h"
+#include "opencv_wrapper.h"
+#include "rod_config.h"
+
+/* ***************************************************** Public macros *************************************************** */
+
+#define DEFAULT_FRAMES 10          // Frames loaded from the folder (the emulated camera cycles)
+#define DEFAULT_MIN_RECALL 0.95f   // Robot and game element markers kept, relative to the reference
+#define MAX_FRAMES 64
+#define MAX_MARKER_ID 64
+#define MAX_CANDIDATES 1024
+#define WIN_SIZE_LIMIT 73          // Largest threshold window tried
+
+/* ************************************************** Public types definition ******************************************** */
+
+/**
+ * @brief Markers found on one frame, counted per ID
+ */
+typedef struct {
+    int counts[MAX_MARKER_ID];
+} FrameMarkers;
+
+/**
+ * @brief One threshold window set to evaluate
+ */
+typedef struct {
+    int win_min;
+    int win_max;
+    int win_step;
+    int passes;
+} ThresholdCandidate;
+
+/* *********************************************** Public functions declarations ***************************************** */
+
+/**
+ * @brief Load and preprocess frames from the emulated camera
+ * @return Number of frames loaded, -1 on failure
+ */
+static int load_frames(const char* folder, ImageHandle** frames, int max_frames);
+
+/**
+ * @brief Detect on all frames with the given threshold windows
+ * @return Total detection time in ms, -1 on failure
+ */
+static double detect_frames(ArucoDictionaryHandle* dictionary, const ThresholdCandidate* candidate,
+                            ImageHandle** frames, int frame_count, FrameMarkers* found);
+
+/**
+ * @brief Build the candidate list sorted by number of threshold passes
+ * @return Number of candidates
+ */
+static int build_candidates(ThresholdCandidate* candidates, int max_candidates);
+
+/* ******************************************* Public callback functions declarations ************************************ */
+
+/* ********************************************* Function implementations *********************************************** */
+
+static double get_time_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+static int load_frames(const char* folder, ImageHandle** frames, int max_frames) {
+    Camera* camera = camera_create(CAMERA_TYPE_EMULATED);
+    if (!camera) {
+        fprintf(stderr, "rod_autotune: Failed to create emulated camera\n");
+        return -1;
+    }
+
+    // Same main stream as rod_detection: full resolution luma, no preview
+    if (camera_interface_set_size(camera, ROD_CAMERA_WIDTH, ROD_CAMERA_HEIGHT) != 0 ||
+        camera_interface_set_format(camera, ROD_CAMERA_FORMAT, 0, 0) != 0 ||
+        camera_interface_set_folder(camera, folder) != 0 ||
+        camera_interface_start(camera) != 0) {
+        fprintf(stderr, "rod_autotune: Failed to start emulated camera on %s\n", folder);
+        camera_destroy(camera);
+        return -1;
+    }
+
+    int count = 0;
+    for (; count < max_frames; count++) {
+        CameraFrame frame;
+        if (camera_interface_acquire_frame(camera, &frame) != 0) {
+            fprintf(stderr, "rod_autotune: Failed to acquire frame %d\n", count + 1);
+            break;
+        }
+
+        // Detector input as in the pipeline before the field mask exists (sharpened gray)
+        ImageHandle* view = create_image_view_from_buffer(frame.data, frame.width, frame.height,
+                                                          camera_frame_channels(&frame), frame.stride);
+        frames[count] = view ? sharpen_mask_gray_reuse(view, NULL, NULL) : NULL;
+        release_image(view);
+        camera_interface_release_frame(camera, &frame);
+
+        if (!frames[count]) {
+            fprintf(stderr, "rod_autotune: Failed to preprocess frame %d\n", count + 1);
+            break;
+        }
+    }
+
+    camera_interface_stop(camera);
+    camera_destroy(camera);
+    return count;
+}
+
+static double detect_frames(ArucoDictionaryHandle* dictionary, const ThresholdCandidate* candidate,
+                            ImageHandle** frames, int frame_count, FrameMarkers* found) {
+    DetectorParametersHandle* params = createDetectorParameters();
+    if (!params) {
+        return -1.0;
+    }
+    rod_config_configure_detector_parameters(params);
+    setAdaptiveThreshWinSizeMin(params, candidate->win_min);
+    setAdaptiveThreshWinSizeMax(params, candidate->win_max);
+    setAdaptiveThreshWinSizeStep(params, candidate->win_step);
+
+    ArucoDetectorHandle* detector = createArucoDetector(dictionary, params);
+    if (!detector) {
+        releaseDetectorParameters(params);
+        return -1.0;
+    }
+
+    double total_ms = 0.0;
+    for (int f = 0; f < frame_count; f++) {
+        memset(&found[f], 0, sizeof(found[f]));
+
+        double t_start = get_time_ms();
+        DetectionResult* result = detectMarkersWithConfidence(detector, frames[f]);
+        total_ms += get_time_ms() - t_start;
+
+        if (!result) {
+            total_ms = -1.0;
+            break;
+        }
+        for (int i = 0; i < result->count; i++) {
+            int id = result->markers[i].id;
+            if (id >= 0 && id < MAX_MARKER_ID && rod_config_is_valid_marker_id(id)) {
+                found[f].counts[id]++;
+            }
+        }
+        releaseDetectionResult(result);
+    }
+
+    releaseArucoDetector(detector);
+    releaseDetectorParameters(params);
+    return total_ms;
+}
+
+static int compare_candidates(const void* a, const void* b) {
+    const ThresholdCandidate* ca = (const ThresholdCandidate*)a;
+    const ThresholdCandidate* cb = (const ThresholdCandidate*)b;
+    if (ca->passes != cb->passes) return ca->passes - cb->passes;
+    if (ca->win_min != cb->win_min) return ca->win_min - cb->win_min;
+    return ca->win_step - cb->win_step;
+}
+
+static int build_candidates(ThresholdCandidate* candidates, int max_candidates) {
+    // Odd windows only: odd minimum and even step
+    static const int win_mins[] = {3, 5, 7, 9, 11, 13, 15, 19, 23};
+    static const int win_steps[] = {4, 6, 8, 10, 12, 16, 20, 24, 30, 40, 50};
+    int count = 0;
+
+    for (size_t m = 0; m < sizeof(win_mins) / sizeof(win_mins[0]); m++) {
+        // One pass: the step is irrelevant
+        if (count < max_candidates) {
+            candidates[count++] = (ThresholdCandidate){win_mins[m], win_mins[m], 4, 1};
+        }
+        for (size_t s = 0; s < sizeof(win_steps) / sizeof(win_steps[0]); s++) {
+            for (int passes = 2; ; passes++) {
+                int win_max = win_mins[m] + win_steps[s] * (passes - 1);
+                if (win_max > WIN_SIZE_LIMIT || count >= max_candidates) break;
+                candidates[count++] = (ThresholdCandidate){win_mins[m], win_max, win_steps[s], passes};
+            }
+        }
+    }
+
+    qsort(candidates, count, sizeof(candidates[0]), compare_candidates);
+    return count;
+}
+
+/**
+ * @brief Check a candidate against the reference detections
+ * @param recall Output recall on the non fixed markers (1.0 if the reference has none)
+ * @return true if every fixed marker of the reference is found
+ */
+static bool evaluate_recall(const FrameMarkers* reference, const FrameMarkers* found, int frame_count, float* recall) {
+    bool fixed_ok = true;
+    int expected = 0;
+    int matched = 0;
+
+    for (int f = 0; f < frame_count; f++) {
+        for (int id = 0; id < MAX_MARKER_ID; id++) {
+            int kept = found[f].counts[id] < reference[f].counts[id] ? found[f].counts[id] : reference[f].counts[id];
+            if (rod_config_get_marker_category(id) == MARKER_CATEGORY_FIXED) {
+                fixed_ok = fixed_ok && kept == reference[f].counts[id];
+            } else {
+                expected += reference[f].counts[id];
+                matched += kept;
+            }
+        }
+    }
+
+    *recall = expected > 0 ? (float)matched / expected : 1.0f;
+    return fixed_ok;
+}
+
+int main(int argc, char* argv[]) {
+    static ImageHandle* frames[MAX_FRAMES];
+    static FrameMarkers reference[MAX_FRAMES];
+    static FrameMarkers found[MAX_FRAMES];
+    static ThresholdCandidate candidates[MAX_CANDIDATES];
+
+    const char* folder = NULL;
+    int max_frames = DEFAULT_FRAMES;
+    float min_recall = DEFAULT_MIN_RECALL;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            max_frames = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--min-recall") == 0 && i + 1 < argc) {
+            min_recall = (float)atof(argv[++i]);
+        } else if (argv[i][0] != '-' && !folder) {
+            folder = argv[i];
+        } else {
+            folder = NULL;
+            break;
+        }
+    }
+    if (!folder || max_frames <= 0 || max_frames > MAX_FRAMES) {
+        fprintf(stderr, "Usage: %s <image_folder> [--frames N (1-%d, default %d)] [--min-recall R (default %.2f)]\n",
+                argv[0], MAX_FRAMES, DEFAULT_FRAMES, DEFAULT_MIN_RECALL);
+        return 1;
+    }
+
+    printf("=== ROD Autotune - Adaptive threshold windows ===\n");
+
+    int frame_count = load_frames(folder, frames, max_frames);
+    if (frame_count <= 0) {
+        fprintf(stderr, "rod_autotune: No frame loaded from %s\n", folder);
+        return 1;
+    }
+    printf("Loaded %d frame(s) from %s\n", frame_count, folder);
+
+    ArucoDictionaryHandle* dictionary = rod_config_create_aruco_dictionary();
+    if (!dictionary) {
+        fprintf(stderr, "rod_autotune: Failed to create ArUco dictionary\n");
+        return 1;
+    }
+
+    // Reference: the current profile
+    ThresholdCandidate current = {
+        ROD_ADAPTIVE_THRESH_WIN_SIZE_MIN, ROD_ADAPTIVE_THRESH_WIN_SIZE_MAX, ROD_ADAPTIVE_THRESH_WIN_SIZE_STEP,
+        (ROD_ADAPTIVE_THRESH_WIN_SIZE_MAX - ROD_ADAPTIVE_THRESH_WIN_SIZE_MIN) / ROD_ADAPTIVE_THRESH_WIN_SIZE_STEP + 1
+    };
+    double reference_ms = detect_frames(dictionary, &current, frames, frame_count, reference);
+    if (reference_ms < 0.0) {
+        fprintf(stderr, "rod_autotune: Reference detection failed\n");
+        return 1;
+    }
+    int fixed_total = 0;
+    for (int f = 0; f < frame_count; f++) {
+        for (int id = 20; id <= 23; id++) {
+            fixed_total += reference[f].counts[id];
+        }
+    }
+    printf("Reference %d-%d step %d (%d passes): %.1f ms/frame, %d fixed marker(s) over %d frame(s)\n",
+           current.win_min, current.win_max, current.win_step, current.passes,
+           reference_ms / frame_count, fixed_total, frame_count);
+    if (fixed_total == 0) {
+        printf("Warning: the reference finds no fixed marker, recall on 20-23 is not constrained\n");
+    }
+
+    // Fewest passes first: the first pass count with an accepted set holds the cheapest one
+    int candidate_count = build_candidates(candidates, MAX_CANDIDATES);
+    ThresholdCandidate best = current;
+    double best_ms = reference_ms;
+    float best_recall = 1.0f;
+    int accepted_passes = 0;
+
+    for (int c = 0; c < candidate_count; c++) {
+        const ThresholdCandidate* candidate = &candidates[c];
+        if (candidate->passes >= current.passes) break;
+        if (accepted_passes > 0 && candidate->passes > accepted_passes) break;
+
+        double ms = detect_frames(dictionary, candidate, frames, frame_count, found);
+        if (ms < 0.0) continue;
+
+        float recall;
+        bool fixed_ok = evaluate_recall(reference, found, frame_count, &recall);
+        bool accepted = fixed_ok && recall >= min_recall;
+        printf("  %2d-%2d step %2d (%d passes): %7.1f ms/frame, recall %.3f%s%s\n",
+               candidate->win_min, candidate->win_max, candidate->win_step, candidate->passes,
+               ms / frame_count, recall, fixed_ok ? "" : ", fixed marker lost", accepted ? "  [ok]" : "");
+
+        if (accepted && ms < best_ms) {
+            best = *candidate;
+            best_ms = ms;
+            best_recall = recall;
+            accepted_passes = candidate->passes;
+        }
+    }
+
+    printf("\n=== Result ===\n");
+    if (accepted_passes == 0) {
+        printf("No cheaper set keeps the recall, current profile kept\n");
+    } else {
+        printf("%d passes instead of %d, %.1f ms/frame instead of %.1f (recall %.3f)\n",
+               best.passes, current.passes, best_ms / frame_count, reference_ms / frame_count, best_recall);
+    }
+    printf("#define ROD_ADAPTIVE_THRESH_WIN_SIZE_MIN %d\n", best.win_min);
+    printf("#define ROD_ADAPTIVE_THRESH_WIN_SIZE_MAX %d\n", best.win_max);
+    printf("#define ROD_ADAPTIVE_THRESH_WIN_SIZE_STEP %d\n", best.win_step);
+
+    releaseArucoDictionary(dictionary);
+    for (int f = 0; f < frame_count; f++) {
+        release_image(frames[f]);
+    }
+    return 0;
+}
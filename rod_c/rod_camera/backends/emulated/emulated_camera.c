@@ -1,25 +1,53 @@
 #include "emulated_camera.h"
 #include "opencv_wrapper.h"
+#include "rod_frame_queue.h"
+#include "rod_session.h"
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
 #include <dirent.h>
+#include <pthread.h>
 #include <sys/stat.h>
+#include <time.h>
 
 #define MAX_PATH_LENGTH 1024
 #define MAX_IMAGE_FILES 1000
 
 // Internal definition of EmulatedCameraContext
 struct EmulatedCameraContext {
-    char image_folder[MAX_PATH_LENGTH];
-    char** image_files;         // Array of image file paths
+    char image_folder[MAX_PATH_LENGTH];  // Image folder, or recorded session file
+    int is_session;             // image_folder is a session file (rod_session.h)
+    char** image_files;         // Array of image file paths (image folder)
+    RodSessionReader* session;  // Mapped session (session file)
     int num_images;             // Number of images found
     int current_index;          // Current image index (for cycling)
     int width;                  // Desired width (0 = original size)
     int height;                 // Desired height (0 = original size)
+    CameraPixelFormat format;   // Frame format delivered by acquire
+    int preview_width;          // Preview width (0 = no preview)
+    int preview_height;         // Preview height (0 = no preview)
     int is_started;             // Whether camera has been started
+    uint32_t sequence;          // Frames acquired since start (emulated sensor counter)
+    
+    // Replay acceleration (decode cost kept out of the pipeline timings)
+    int prefetch_depth;         // Frames decoded ahead by a background thread (0 = decode in acquire)
+    int preload;                // Decode every image at start, then replay from memory
+    struct EmulatedFrame** cache;  // Preloaded frames (num_images entries, NULL if not preloaded)
+    RodFrameQueue* prefetched;  // Decoded frames waiting for acquire (NULL if no prefetch thread)
+    pthread_t prefetch_thread;
 };
 
+// Images lent with an acquired frame (kept alive until release)
+typedef struct EmulatedFrame {
+    ImageHandle* image;         // Main image (BGR or gray)
+    ImageHandle* preview;       // Low resolution BGR preview (NULL if not configured)
+    int index;                  // Source image index
+    int cached;                 // Owned by the preload cache (not freed at release)
+    int recorded;               // Session frame: sequence and timestamp below are the recorded ones
+    uint32_t recorded_sequence;
+    uint64_t recorded_timestamp_ns;
+} EmulatedFrame;
+
 /**
  * Check if a file has a supported image extension.
  */
@@ -100,6 +128,218 @@ static int load_image_list(EmulatedCameraContext* ctx) {
     return 0;
 }
 
+/**
+ * Map the recorded session file: its frames replace the image list.
+ */
+static int load_session(EmulatedCameraContext* ctx) {
+    ctx->session = rod_session_reader_open(ctx->image_folder);
+    if (!ctx->session) {
+        return -1;
+    }
+    
+    ctx->num_images = rod_session_reader_count(ctx->session);
+    if (ctx->num_images == 0) {
+        fprintf(stderr, "Error: No frames in session: %s\n", ctx->image_folder);
+        rod_session_reader_close(ctx->session);
+        ctx->session = NULL;
+        return -1;
+    }
+    
+    printf("Emulated camera initialized with %d recorded frames from: %s\n",
+           ctx->num_images, ctx->image_folder);
+    
+    return 0;
+}
+
+/**
+ * Source image of a frame: decoded file, or recorded pixels used in place
+ * (recorded is then filled with the frame metadata).
+ */
+static ImageHandle* load_source_image(EmulatedCameraContext* ctx, int index, RodSessionFrame* recorded) {
+    if (!ctx->session) {
+        ImageHandle* image = load_image(ctx->image_files[index]);
+        if (!image) {
+            fprintf(stderr, "Error: Failed to load image: %s\n", ctx->image_files[index]);
+        }
+        return image;
+    }
+    
+    // A view over the read-only mapping: no decoding and no copy (frames are never written)
+    if (rod_session_reader_get(ctx->session, index, recorded) != 0) {
+        return NULL;
+    }
+    ImageHandle* image = create_image_view_from_buffer((uint8_t*)recorded->data, recorded->width, recorded->height,
+                                                       recorded->channels, recorded->stride);
+    if (!image) {
+        fprintf(stderr, "Error: Failed to read recorded frame %d\n", index);
+    }
+    return image;
+}
+
+/**
+ * Decode an image and convert it to the delivered frame (size, format, preview).
+ */
+static EmulatedFrame* prepare_frame(EmulatedCameraContext* ctx, int index) {
+    RodSessionFrame recorded;
+    ImageHandle* image = load_source_image(ctx, index, &recorded);
+    if (!image) {
+        return NULL;
+    }
+    
+    // Resize if dimensions are specified
+    if (ctx->width > 0 && ctx->height > 0 &&
+        (get_image_width(image) != ctx->width || get_image_height(image) != ctx->height)) {
+        ImageHandle* resized = resize_image(image, ctx->width, ctx->height);
+        release_image(image);
+        if (!resized) {
+            fprintf(stderr, "Error: Failed to resize image\n");
+            return NULL;
+        }
+        image = resized;
+    }
+    
+    EmulatedFrame* prepared = (EmulatedFrame*)malloc(sizeof(EmulatedFrame));
+    if (!prepared) {
+        fprintf(stderr, "Error: Failed to allocate frame\n");
+        release_image(image);
+        return NULL;
+    }
+    prepared->image = image;
+    prepared->preview = NULL;
+    prepared->index = index;
+    prepared->cached = 0;
+    prepared->recorded = ctx->session != NULL;
+    prepared->recorded_sequence = prepared->recorded ? recorded.sequence : 0;
+    prepared->recorded_timestamp_ns = prepared->recorded ? recorded.timestamp_ns : 0;
+    
+    // Preview is scaled from the color image, like the camera viewfinder stream (gray for a recorded luma plane)
+    int channels = get_image_channels(image);
+    if (ctx->preview_width > 0 && ctx->preview_height > 0) {
+        prepared->preview = (channels == 3) ? resize_image(image, ctx->preview_width, ctx->preview_height)
+                                            : resize_to_bgr_reuse(image, ctx->preview_width, ctx->preview_height, NULL);
+    }
+    
+    // YUV420: only the luma plane is exposed, emulate it with a gray conversion (a recorded luma plane is kept)
+    // BGR888: a recorded luma plane is expanded to gray BGR
+    if ((ctx->format == CAMERA_FORMAT_YUV420) != (channels == 1)) {
+        prepared->image = (channels == 3) ? convert_to_grayscale(image) : convert_gray_to_bgr(image);
+        release_image(image);
+        if (!prepared->image) {
+            fprintf(stderr, "Error: Failed to convert image format\n");
+            release_image(prepared->preview);
+            free(prepared);
+            return NULL;
+        }
+    }
+    
+    return prepared;
+}
+
+static void free_frame(EmulatedFrame* frame) {
+    if (!frame) return;
+    release_image(frame->image);
+    release_image(frame->preview);
+    free(frame);
+}
+
+/**
+ * Decode every image once (replay at the pipeline's own rate, no decode cost).
+ */
+static int preload_frames(EmulatedCameraContext* ctx) {
+    ctx->cache = (EmulatedFrame**)calloc((size_t)ctx->num_images, sizeof(EmulatedFrame*));
+    if (!ctx->cache) {
+        fprintf(stderr, "Error: Memory allocation failed for frame cache\n");
+        return -1;
+    }
+    
+    size_t bytes = 0;
+    for (int i = 0; i < ctx->num_images; i++) {
+        ctx->cache[i] = prepare_frame(ctx, i);
+        if (!ctx->cache[i]) {
+            return -1;
+        }
+        ctx->cache[i]->cached = 1;
+        bytes += get_image_data_size(ctx->cache[i]->image);
+        if (ctx->cache[i]->preview) {
+            bytes += get_image_data_size(ctx->cache[i]->preview);
+        }
+    }
+    
+    printf("Emulated camera preloaded %d frames (%.1f MB)\n", ctx->num_images, (double)bytes / (1024.0 * 1024.0));
+    return 0;
+}
+
+static void free_cache(EmulatedCameraContext* ctx) {
+    if (!ctx->cache) return;
+    for (int i = 0; i < ctx->num_images; i++) {
+        free_frame(ctx->cache[i]);
+    }
+    free(ctx->cache);
+    ctx->cache = NULL;
+}
+
+/**
+ * Read-ahead thread: decode the next images while the pipeline works on the current one.
+ * Blocks when prefetch_depth frames are ready, stops when the queue is closed.
+ */
+static void* prefetch_thread_main(void* arg) {
+    EmulatedCameraContext* ctx = (EmulatedCameraContext*)arg;
+    int index = 0;
+    int failures = 0;
+    
+    while (!rod_frame_queue_is_closed(ctx->prefetched)) {
+        EmulatedFrame* prepared = prepare_frame(ctx, index);
+        index = (index + 1) % ctx->num_images;
+        if (!prepared) {
+            // Skip unreadable files, give up when none of them can be decoded
+            if (++failures >= ctx->num_images) {
+                fprintf(stderr, "Error: No image could be decoded, stopping prefetch\n");
+                rod_frame_queue_close(ctx->prefetched);
+            }
+            continue;
+        }
+        failures = 0;
+        
+        if (rod_frame_queue_push(ctx->prefetched, prepared) != 0) {
+            free_frame(prepared);  // Closed while blocked: camera stopping
+        }
+    }
+    
+    return NULL;
+}
+
+static int start_prefetch(EmulatedCameraContext* ctx) {
+    ctx->prefetched = rod_frame_queue_create(ctx->prefetch_depth);
+    if (!ctx->prefetched) {
+        fprintf(stderr, "Error: Failed to create prefetch queue\n");
+        return -1;
+    }
+    
+    if (pthread_create(&ctx->prefetch_thread, NULL, prefetch_thread_main, ctx) != 0) {
+        fprintf(stderr, "Error: Failed to start prefetch thread\n");
+        rod_frame_queue_destroy(ctx->prefetched);
+        ctx->prefetched = NULL;
+        return -1;
+    }
+    
+    return 0;
+}
+
+static void stop_prefetch(EmulatedCameraContext* ctx) {
+    if (!ctx->prefetched) return;
+    
+    rod_frame_queue_close(ctx->prefetched);
+    pthread_join(ctx->prefetch_thread, NULL);
+    
+    // Free the frames decoded but never acquired
+    EmulatedFrame* pending;
+    while ((pending = (EmulatedFrame*)rod_frame_queue_pop(ctx->prefetched, 0)) != NULL) {
+        free_frame(pending);
+    }
+    rod_frame_queue_destroy(ctx->prefetched);
+    ctx->prefetched = NULL;
+}
+
 EmulatedCameraContext* emulated_camera_init() {
     EmulatedCameraContext* ctx = (EmulatedCameraContext*)malloc(sizeof(EmulatedCameraContext));
     if (!ctx) {
@@ -109,12 +349,22 @@ EmulatedCameraContext* emulated_camera_init() {
     
     // Initialize fields
     memset(ctx->image_folder, 0, MAX_PATH_LENGTH);
+    ctx->is_session = 0;
     ctx->image_files = NULL;
+    ctx->session = NULL;
     ctx->num_images = 0;
     ctx->current_index = 0;
     ctx->width = 0;
     ctx->height = 0;
+    ctx->format = CAMERA_FORMAT_BGR888;
+    ctx->preview_width = 0;
+    ctx->preview_height = 0;
     ctx->is_started = 0;
+    ctx->sequence = 0;
+    ctx->prefetch_depth = 0;
+    ctx->preload = 0;
+    ctx->cache = NULL;
+    ctx->prefetched = NULL;
     
     return ctx;
 }
@@ -125,17 +375,18 @@ int emulated_camera_set_folder(EmulatedCameraContext* ctx, const char* folder_pa
         return -1;
     }
     
-    // Check if folder exists
+    // Check if folder (or session file) exists
     struct stat st;
-    if (stat(folder_path, &st) != 0 || !S_ISDIR(st.st_mode)) {
-        fprintf(stderr, "Error: Folder does not exist: %s\n", folder_path);
+    if (stat(folder_path, &st) != 0 || (!S_ISDIR(st.st_mode) && !rod_session_is_file(folder_path))) {
+        fprintf(stderr, "Error: Folder or session file does not exist: %s\n", folder_path);
         return -1;
     }
     
     strncpy(ctx->image_folder, folder_path, MAX_PATH_LENGTH - 1);
     ctx->image_folder[MAX_PATH_LENGTH - 1] = '\0';
+    ctx->is_session = !S_ISDIR(st.st_mode);
     
-    printf("Emulated camera folder set to: %s\n", ctx->image_folder);
+    printf("Emulated camera %s set to: %s\n", ctx->is_session ? "session" : "folder", ctx->image_folder);
     return 0;
 }
 
@@ -158,6 +409,67 @@ int emulated_camera_set_size(EmulatedCameraContext* ctx, int width, int height)
     return 0;
 }
 
+int emulated_camera_set_format(EmulatedCameraContext* ctx, CameraPixelFormat format,
+                               int preview_width, int preview_height) {
+    if (!ctx) {
+        fprintf(stderr, "Error: Invalid context\n");
+        return -1;
+    }
+    
+    if (preview_width < 0 || preview_height < 0 || (preview_width == 0) != (preview_height == 0)) {
+        fprintf(stderr, "Error: Invalid preview dimensions %dx%d\n", preview_width, preview_height);
+        return -1;
+    }
+    
+    ctx->format = format;
+    ctx->preview_width = preview_width;
+    ctx->preview_height = preview_height;
+    
+    printf("Emulated camera format set to: %s", format == CAMERA_FORMAT_YUV420 ? "YUV420 (gray)" : "BGR888");
+    if (preview_width > 0) {
+        printf(" + %dx%d preview", preview_width, preview_height);
+    }
+    printf("\n");
+    return 0;
+}
+
+int emulated_camera_set_buffering(EmulatedCameraContext* ctx, int buffer_count, int newest_only) {
+    (void)newest_only;
+
+    if (!ctx) {
+        fprintf(stderr, "Error: Invalid context\n");
+        return -1;
+    }
+    
+    if (buffer_count < 0) {
+        fprintf(stderr, "Error: Invalid buffer count %d\n", buffer_count);
+        return -1;
+    }
+    
+    return 0;
+}
+
+int emulated_camera_set_prefetch(EmulatedCameraContext* ctx, int depth, int preload) {
+    if (!ctx) {
+        fprintf(stderr, "Error: Invalid context\n");
+        return -1;
+    }
+    
+    if (ctx->is_started) {
+        fprintf(stderr, "Error: Cannot set prefetch after camera is started\n");
+        return -1;
+    }
+    
+    if (depth < 0) {
+        fprintf(stderr, "Error: Invalid prefetch depth %d\n", depth);
+        return -1;
+    }
+    
+    ctx->prefetch_depth = depth;
+    ctx->preload = preload;
+    return 0;
+}
+
 int emulated_camera_start(EmulatedCameraContext* ctx) {
     if (!ctx) {
         fprintf(stderr, "Error: Invalid context\n");
@@ -174,13 +486,21 @@ int emulated_camera_start(EmulatedCameraContext* ctx) {
         return 0;
     }
     
-    // Load list of images from folder
-    if (load_image_list(ctx) != 0) {
+    // Load list of images from folder, or map the session
+    if ((ctx->is_session ? load_session(ctx) : load_image_list(ctx)) != 0) {
         return -1;
     }
     
     ctx->is_started = 1;
     ctx->current_index = 0;
+    ctx->sequence = 0;
+    
+    // Preloading makes read-ahead useless: frames are already decoded
+    if ((ctx->preload && preload_frames(ctx) != 0) ||
+        (!ctx->preload && ctx->prefetch_depth > 0 && start_prefetch(ctx) != 0)) {
+        emulated_camera_stop(ctx);
+        return -1;
+    }
     
     printf("Emulated camera started successfully\n");
     return 0;
@@ -206,6 +526,11 @@ int emulated_camera_take_picture(EmulatedCameraContext* ctx,
         return -1;
     }
     
+    if (ctx->session) {
+        fprintf(stderr, "Error: Session replay needs emulated_camera_acquire_frame()\n");
+        return -1;
+    }
+    
     // Get current image path
     const char* image_path = ctx->image_files[ctx->current_index];
     
@@ -285,9 +610,96 @@ int emulated_camera_take_picture(EmulatedCameraContext* ctx,
     return 0;
 }
 
+int emulated_camera_acquire_frame(EmulatedCameraContext* ctx, CameraFrame* frame) {
+    if (!ctx || !frame) {
+        fprintf(stderr, "Error: Invalid parameters\n");
+        return -1;
+    }
+    
+    if (!ctx->is_started) {
+        fprintf(stderr, "Error: Camera not started. Call emulated_camera_start() first.\n");
+        return -1;
+    }
+    
+    if (ctx->num_images == 0) {
+        fprintf(stderr, "Error: No images available\n");
+        return -1;
+    }
+    
+    // The "exposure" happens now, before decoding (like a sensor timestamp)
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    
+    // Preloaded, decoded ahead by the prefetch thread, or decoded now
+    EmulatedFrame* lent;
+    if (ctx->cache) {
+        lent = ctx->cache[ctx->current_index];
+    } else if (ctx->prefetched) {
+        lent = (EmulatedFrame*)rod_frame_queue_pop(ctx->prefetched, -1);
+    } else {
+        lent = prepare_frame(ctx, ctx->current_index);
+    }
+    if (!lent) {
+        return -1;
+    }
+    
+    // The decoded images themselves are lent to the caller (kept alive until release)
+    frame->data = get_image_data(lent->image);
+    frame->width = get_image_width(lent->image);
+    frame->height = get_image_height(lent->image);
+    frame->stride = (size_t)frame->width * get_image_channels(lent->image);
+    frame->size = get_image_data_size(lent->image);
+    frame->format = ctx->format;
+    frame->timestamp_ns = (uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec;
+    frame->sequence = ctx->sequence++;
+    // Session metadata only: latencies stay on the acquire clock, which never goes back on loop around
+    frame->recorded = lent->recorded;
+    frame->recorded_sequence = lent->recorded_sequence;
+    frame->recorded_timestamp_ns = lent->recorded_timestamp_ns;
+    frame->preview_data = lent->preview ? get_image_data(lent->preview) : NULL;
+    frame->preview_width = lent->preview ? get_image_width(lent->preview) : 0;
+    frame->preview_height = lent->preview ? get_image_height(lent->preview) : 0;
+    frame->preview_stride = (size_t)frame->preview_width * 3;
+    frame->backend_handle = lent;
+    
+    // Move to next image (circular buffer)
+    ctx->current_index = (ctx->current_index + 1) % ctx->num_images;
+    
+    if (ctx->session) {
+        printf("Emulated camera replayed frame %d (%dx%d)\n", lent->index, frame->width, frame->height);
+    } else {
+        printf("Emulated camera captured image: %s (%dx%d)\n",
+               ctx->image_files[lent->index], frame->width, frame->height);
+    }
+    
+    return 0;
+}
+
+int emulated_camera_release_frame(EmulatedCameraContext* ctx, CameraFrame* frame) {
+    if (!ctx || !frame) {
+        return -1;
+    }
+    
+    EmulatedFrame* lent = (EmulatedFrame*)frame->backend_handle;
+    if (lent && !lent->cached) {
+        free_frame(lent);
+    }
+    frame->backend_handle = NULL;
+    frame->data = NULL;
+    frame->preview_data = NULL;
+    
+    return 0;
+}
+
 void emulated_camera_stop(EmulatedCameraContext* ctx) {
     if (!ctx) return;
     
+    // The prefetch thread reads the file list, and frames are views of the session mapping: stop it first
+    stop_prefetch(ctx);
+    free_cache(ctx);
+    rod_session_reader_close(ctx->session);
+    ctx->session = NULL;
+    
     // Free image file paths
     if (ctx->image_files) {
         for (int i = 0; i < ctx->num_images; i++) {
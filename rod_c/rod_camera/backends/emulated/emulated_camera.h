@@ -3,6 +3,7 @@
 
 #include <stdint.h>
 #include <stddef.h>
+#include "camera_frame.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -20,8 +21,11 @@ EmulatedCameraContext* emulated_camera_init();
 /**
  * Set the image folder path for the emulated camera.
  * Must be called before emulated_camera_start().
+ * A session file recorded by rod_detection --record (rod_session.h) can be given
+ * instead: its frames are replayed in recorded order from a read-only mapping,
+ * without decoding (frames at the configured size and format are not even copied).
  * @param ctx The camera context
- * @param folder_path Path to folder containing images
+ * @param folder_path Path to folder containing images, or to a session file
  * @return 0 on success, -1 on failure
  */
 int emulated_camera_set_folder(EmulatedCameraContext* ctx, const char* folder_path);
@@ -37,7 +41,42 @@ int emulated_camera_set_folder(EmulatedCameraContext* ctx, const char* folder_pa
 int emulated_camera_set_size(EmulatedCameraContext* ctx, int width, int height);
 
 /**
- * Start the emulated camera (load image list from folder).
+ * Set the frame format and the optional preview (same contract as the real camera).
+ * CAMERA_FORMAT_YUV420 delivers the gray (luma) image in frame->data.
+ * @param ctx The camera context
+ * @param format CAMERA_FORMAT_BGR888 (default) or CAMERA_FORMAT_YUV420
+ * @param preview_width Low resolution BGR888 preview width (0 = no preview)
+ * @param preview_height Low resolution BGR888 preview height (0 = no preview)
+ * @return 0 on success, -1 on failure
+ */
+int emulated_camera_set_format(EmulatedCameraContext* ctx, CameraPixelFormat format,
+                               int preview_width, int preview_height);
+
+/**
+ * Set the buffering policy (same contract as the real camera).
+ * Frames are decoded on demand: the values are only validated.
+ * @param ctx The camera context
+ * @param buffer_count Buffers per stream (0 = default)
+ * @param newest_only Non-zero: drop stale frames (no effect, no frame is ever stale)
+ * @return 0 on success, -1 on failure
+ */
+int emulated_camera_set_buffering(EmulatedCameraContext* ctx, int buffer_count, int newest_only);
+
+/**
+ * Take image decoding out of acquire, for replays at the pipeline's maximum rate.
+ * Must be called before emulated_camera_start().
+ * With preload, every image is decoded at start (memory: one converted frame and
+ * preview per image) and acquire lends the cached frames, which stay valid until stop.
+ * Otherwise a background thread decodes up to depth frames ahead of acquire.
+ * @param ctx The camera context
+ * @param depth Frames decoded ahead (0 = decode in acquire)
+ * @param preload Non-zero: decode all images at start (depth is then ignored)
+ * @return 0 on success, -1 on failure
+ */
+int emulated_camera_set_prefetch(EmulatedCameraContext* ctx, int depth, int preload);
+
+/**
+ * Start the emulated camera (load image list from folder, or map the session file).
  * @param ctx The camera context
  * @return 0 on success, -1 on failure
  */
@@ -60,6 +99,23 @@ int emulated_camera_take_picture(EmulatedCameraContext* ctx,
                                   int* out_height,
                                   size_t* out_size);
 
+/**
+ * Borrow the next image from the folder without an extra copy (cycles through images).
+ * The frame points into the decoded image, which is kept until emulated_camera_release_frame().
+ * @param ctx The camera context
+ * @param frame Frame descriptor to fill (format set by emulated_camera_set_format())
+ * @return 0 on success, -1 on failure
+ */
+int emulated_camera_acquire_frame(EmulatedCameraContext* ctx, CameraFrame* frame);
+
+/**
+ * Release a frame obtained from emulated_camera_acquire_frame().
+ * @param ctx The camera context
+ * @param frame Frame to release
+ * @return 0 on success, -1 on failure
+ */
+int emulated_camera_release_frame(EmulatedCameraContext* ctx, CameraFrame* frame);
+
 /**
  * Stop the emulated camera and reset state.
  * @param ctx The camera context
@@ -15,6 +15,11 @@ struct CameraContext {
     LibCameraContext* libcamera_ctx;
     int width;
     int height;
+    CameraPixelFormat format;
+    int preview_width;      // 0 = no preview stream
+    int preview_height;
+    int buffer_count;       // Buffers per stream (0 = libcamera default)
+    int newest_only;        // Drop stale completed frames on acquire
     int configured;
     int started;
     CameraParameters params;
@@ -44,6 +49,11 @@ CameraContext* camera_init() {
 
     ctx->width = 640;       // Default resolution
     ctx->height = 480;
+    ctx->format = CAMERA_FORMAT_BGR888;
+    ctx->preview_width = 0;
+    ctx->preview_height = 0;
+    ctx->buffer_count = 0;
+    ctx->newest_only = 0;
     ctx->configured = 0;
     ctx->started = 0;
     ctx->params = camera_default_parameters();
@@ -73,13 +83,92 @@ int camera_set_size(CameraContext* ctx, int width, int height) {
     return 0;
 }
 
+int camera_set_format(CameraContext* ctx, CameraPixelFormat format, int preview_width, int preview_height) {
+    if (!ctx) {
+        return -1;
+    }
+
+    if (ctx->started) {
+        fprintf(stderr, "Cannot set format after camera is started\n");
+        return -1;
+    }
+
+    if (preview_width < 0 || preview_height < 0 || (preview_width == 0) != (preview_height == 0)) {
+        fprintf(stderr, "Error: Invalid preview dimensions %dx%d\n", preview_width, preview_height);
+        return -1;
+    }
+
+    ctx->format = format;
+    ctx->preview_width = preview_width;
+    ctx->preview_height = preview_height;
+    ctx->configured = 0;  // Streams are reconfigured at next start
+
+    return 0;
+}
+
+int camera_set_buffering(CameraContext* ctx, int buffer_count, int newest_only) {
+    if (!ctx) {
+        return -1;
+    }
+
+    if (ctx->started) {
+        fprintf(stderr, "Cannot set buffering after camera is started\n");
+        return -1;
+    }
+
+    if (buffer_count < 0) {
+        fprintf(stderr, "Error: Invalid buffer count %d\n", buffer_count);
+        return -1;
+    }
+
+    ctx->buffer_count = buffer_count;
+    ctx->newest_only = newest_only;
+    ctx->configured = 0;  // Buffers are allocated at next configure
+
+    return 0;
+}
+
+int camera_list_sensor_modes(CameraContext* ctx, CameraSensorMode* modes, int capacity) {
+    if (!ctx) {
+        return -1;
+    }
+
+    if (ctx->started) {
+        fprintf(stderr, "Cannot list sensor modes after camera is started\n");
+        return -1;
+    }
+
+    ctx->configured = 0;  // Listing configures the camera with each raw mode
+    return libcamera_list_sensor_modes(ctx->libcamera_ctx, modes, capacity);
+}
+
+int camera_set_sensor_mode(CameraContext* ctx, const CameraSensorMode* mode) {
+    if (!ctx) {
+        return -1;
+    }
+
+    if (ctx->started) {
+        fprintf(stderr, "Cannot set sensor mode after camera is started\n");
+        return -1;
+    }
+
+    if (libcamera_set_sensor_mode(ctx->libcamera_ctx, mode) != 0) {
+        fprintf(stderr, "Error: Invalid sensor mode\n");
+        return -1;
+    }
+    ctx->configured = 0;
+
+    return 0;
+}
+
 int camera_set_parameters(CameraContext* ctx, const CameraParameters* params) {
     if (!ctx || !params) {
         return -1;
     }
 
-    if (ctx->started) {
-        fprintf(stderr, "Cannot set parameters after camera is started\n");
+    // Running: the new controls go with the next frame requests (no restart)
+    if (ctx->started && libcamera_set_controls(ctx->libcamera_ctx, params) != 0) {
+        fprintf(stderr, "Failed to update camera parameters\n");
         return -1;
     }
 
@@ -98,7 +187,9 @@ int camera_start(CameraContext* ctx) {
 
     // Configure camera if not already done
     if (!ctx->configured) {
-        if (libcamera_configure(ctx->libcamera_ctx, ctx->width, ctx->height) != 0) {
+        libcamera_set_buffering(ctx->libcamera_ctx, ctx->buffer_count, ctx->newest_only);
+        if (libcamera_configure_streams(ctx->libcamera_ctx, ctx->width, ctx->height, ctx->format,
+                                        ctx->preview_width, ctx->preview_height) != 0) {
             fprintf(stderr, "Failed to configure camera\n");
             return -1;
         }
@@ -145,6 +236,33 @@ int camera_take_picture(CameraContext* ctx,
     return 0;
 }
 
+int camera_acquire_frame(CameraContext* ctx, CameraFrame* frame) {
+    if (!ctx || !ctx->libcamera_ctx || !frame) {
+        return -1;
+    }
+
+    if (!ctx->started) {
+        fprintf(stderr, "Camera not started\n");
+        return -1;
+    }
+
+    // Borrow frame with 1000ms timeout
+    if (libcamera_acquire_frame(ctx->libcamera_ctx, frame, 1000) != 0) {
+        fprintf(stderr, "Failed to acquire frame\n");
+        return -1;
+    }
+
+    return 0;
+}
+
+int camera_release_frame(CameraContext* ctx, CameraFrame* frame) {
+    if (!ctx || !ctx->libcamera_ctx || !frame) {
+        return -1;
+    }
+
+    return libcamera_release_frame(ctx->libcamera_ctx, frame);
+}
+
 void camera_stop(CameraContext* ctx) {
     if (!ctx || !ctx->libcamera_ctx) {
         return;
@@ -3,6 +3,7 @@
 
 #include <stdint.h>
 #include <stddef.h>
+#include "camera_frame.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -33,9 +34,15 @@ typedef struct CameraParameters {
     int awb_enable;             // -1=default(true), 0=false, 1=true
     int colour_temperature;     // -1=auto, else 100-100000 K
     
-    // Frame timing
-    int64_t frame_duration_min; // -1=default(100), else nanoseconds
-    int64_t frame_duration_max; // -1=default(1000000000), else nanoseconds
+    // Frame timing (FrameDurationLimits, min = max fixes the frame rate)
+    int64_t frame_duration_min; // -1=default(100), else microseconds
+    int64_t frame_duration_max; // -1=default(1000000000), else microseconds
+    
+    // Field of view (ScalerCrop, full resolution sensor pixel coordinates)
+    int scaler_crop_x;          // -1=default(0)
+    int scaler_crop_y;          // -1=default(0)
+    int scaler_crop_width;      // -1=default(full sensor width)
+    int scaler_crop_height;     // -1=default(full sensor height)
 } CameraParameters;
 
 /**
@@ -55,6 +62,10 @@ static inline CameraParameters camera_default_parameters() {
     params.colour_temperature = -1;
     params.frame_duration_min = -1;
     params.frame_duration_max = -1;
+    params.scaler_crop_x = -1;
+    params.scaler_crop_y = -1;
+    params.scaler_crop_width = -1;
+    params.scaler_crop_height = -1;
     return params;
 }
 
@@ -75,9 +86,52 @@ CameraContext* camera_init();
 int camera_set_size(CameraContext* ctx, int width, int height);
 
 /**
- * Set camera control parameters.
+ * Set the main stream pixel format and the optional preview stream.
+ * Must be called before camera_start().
+ * @param ctx The camera context
+ * @param format CAMERA_FORMAT_BGR888 (default) or CAMERA_FORMAT_YUV420 (Y plane exposed)
+ * @param preview_width Low resolution BGR888 preview width (0 = no preview)
+ * @param preview_height Low resolution BGR888 preview height (0 = no preview)
+ * @return 0 on success, -1 on failure
+ */
+int camera_set_format(CameraContext* ctx, CameraPixelFormat format, int preview_width, int preview_height);
+
+/**
+ * Set the number of buffers per stream and the stale frame policy.
+ * Must be called before camera_start().
+ * Frames held by the caller are not refilled: buffer_count must exceed the number
+ * of frames held at once, or the sensor stalls.
+ * @param ctx The camera context
+ * @param buffer_count Buffers per stream (0 = libcamera default, 1 for still capture)
+ * @param newest_only Non-zero: acquire returns the newest completed frame and requeues older ones
+ * @return 0 on success, -1 on failure
+ */
+int camera_set_buffering(CameraContext* ctx, int buffer_count, int newest_only);
+
+/**
+ * List the sensor readout modes with their highest frame rate.
+ * Must be called before camera_start() (the camera is reconfigured at start).
+ * @param ctx The camera context
+ * @param modes Output array
+ * @param capacity Size of the output array
+ * @return Number of modes written, -1 on failure
+ */
+int camera_list_sensor_modes(CameraContext* ctx, CameraSensorMode* modes, int capacity);
+
+/**
+ * Force the sensor readout mode.
  * Must be called before camera_start().
  * @param ctx The camera context
+ * @param mode Mode from camera_list_sensor_modes() (NULL = chosen from the stream size)
+ * @return 0 on success, -1 on failure
+ */
+int camera_set_sensor_mode(CameraContext* ctx, const CameraSensorMode* mode);
+
+/**
+ * Set camera control parameters.
+ * Before camera_start(): used when the camera starts. While started: applied to
+ * the next frame requests, without stopping the camera.
+ * @param ctx The camera context
  * @param params Parameter structure (pass camera_default_parameters() for defaults)
  * @return 0 on success, -1 on failure
  */
@@ -107,6 +161,24 @@ int camera_take_picture(CameraContext* ctx,
                        int* out_height,
                        size_t* out_size);
 
+/**
+ * Borrow the next captured frame without copying it.
+ * The frame points directly into the libcamera buffer (frame->format, frame->stride bytes per row)
+ * and must be given back with camera_release_frame() once processed.
+ * @param ctx The camera context
+ * @param frame Frame descriptor to fill
+ * @return 0 on success, -1 on failure
+ */
+int camera_acquire_frame(CameraContext* ctx, CameraFrame* frame);
+
+/**
+ * Give a borrowed frame back to the camera so its buffer can be refilled.
+ * @param ctx The camera context
+ * @param frame Frame obtained from camera_acquire_frame()
+ * @return 0 on success, -1 on failure
+ */
+int camera_release_frame(CameraContext* ctx, CameraFrame* frame);
+
 /**
  * Stop the camera.
  * @param ctx The camera context
@@ -0,0 +1,88 @@
+#ifndef CAMERA_FRAME_H
+#define CAMERA_FRAME_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Pixel format of the main camera stream
+ */
+typedef enum {
+    CAMERA_FORMAT_BGR888 = 0,  // Packed BGR, 3 bytes per pixel (OpenCV native)
+    CAMERA_FORMAT_YUV420       // Planar YUV420: `data` is the Y plane (1 byte per pixel, gray)
+} CameraPixelFormat;
+
+/**
+ * Sensor readout mode
+ *
+ * Binned modes read the whole field of view at a lower resolution and a much
+ * higher frame rate (IMX477: 2028x1520 2x2 binned at 40 fps against 4056x3040
+ * at 10 fps). The ISP scales the readout to the configured stream size.
+ */
+typedef struct CameraSensorMode {
+    int width;                  // Sensor output width in pixels
+    int height;                 // Sensor output height in pixels
+    int bit_depth;              // Raw bits per pixel
+    double max_fps;             // Highest frame rate of the mode (0 = unknown)
+} CameraSensorMode;
+
+/**
+ * Borrowed camera frame
+ *
+ * Describes a frame that stays owned by the camera backend. The pixel data
+ * points directly into the backend buffer (mmapped dmabuf for libcamera,
+ * decoded image for the emulated camera): nothing is copied.
+ *
+ * With CAMERA_FORMAT_YUV420 only the luma plane is exposed: it is exactly the
+ * gray image the detector needs. The chroma planes are not used.
+ *
+ * When a preview stream is configured, `preview_data` points to a low
+ * resolution BGR888 image of the same exposure (used for debug images).
+ *
+ * `timestamp_ns` and `sequence` identify the exposure: they stay valid after
+ * the release and are what latency measurements must be based on. A frame
+ * replayed from a session file is stamped at acquire like a live one; the
+ * values of the recording are kept apart in `recorded_*` (another run's
+ * clock, going back at each loop of the replay).
+ *
+ * The frame is valid between a successful acquire and the matching release.
+ * The caller must not keep any reference to `data` or `preview_data`
+ * (e.g. an ImageHandle view) after releasing the frame.
+ */
+typedef struct CameraFrame {
+    uint8_t* data;              // Main stream pixels (read-only, owned by the backend)
+    int width;                  // Image width in pixels
+    int height;                 // Image height in pixels
+    size_t stride;              // Bytes per row (may include padding)
+    size_t size;                // Total buffer size in bytes (stride * height)
+    CameraPixelFormat format;   // Layout of `data`
+    uint64_t timestamp_ns;      // Sensor timestamp of the exposure (nanoseconds, CLOCK_MONOTONIC)
+    uint32_t sequence;          // Sensor frame counter (a gap means frames were lost before acquire)
+    int recorded;               // Replayed from a session file: recorded_* below are valid
+    uint32_t recorded_sequence; // Sensor frame counter when the frame was recorded
+    uint64_t recorded_timestamp_ns;  // Capture time when the frame was recorded (not comparable with timestamp_ns)
+
+    uint8_t* preview_data;      // Low resolution BGR888 preview (NULL if not configured)
+    int preview_width;
+    int preview_height;
+    size_t preview_stride;
+
+    void* backend_handle;       // Backend private token (do not modify)
+} CameraFrame;
+
+/**
+ * Bytes per pixel of the main stream as seen through `data`
+ */
+static inline int camera_frame_channels(const CameraFrame* frame) {
+    return frame->format == CAMERA_FORMAT_YUV420 ? 1 : 3;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CAMERA_FRAME_H
@@ -70,6 +70,81 @@ int camera_interface_set_size(Camera* camera, int width, int height) {
     return -1;
 }
 
+int camera_interface_set_format(Camera* camera, CameraPixelFormat format,
+                                int preview_width, int preview_height) {
+    if (!camera) {
+        return -1;
+    }
+    
+    if (camera->type == CAMERA_TYPE_IMX477) {
+        CameraContext* ctx = (CameraContext*)camera->backend_context;
+        return camera_set_format(ctx, format, preview_width, preview_height);
+    } else if (camera->type == CAMERA_TYPE_EMULATED) {
+        EmulatedCameraContext* ctx = (EmulatedCameraContext*)camera->backend_context;
+        return emulated_camera_set_format(ctx, format, preview_width, preview_height);
+    }
+    
+    return -1;
+}
+
+int camera_interface_set_buffering(Camera* camera, int buffer_count, int newest_only) {
+    if (!camera) {
+        return -1;
+    }
+    
+    if (camera->type == CAMERA_TYPE_IMX477) {
+        CameraContext* ctx = (CameraContext*)camera->backend_context;
+        return camera_set_buffering(ctx, buffer_count, newest_only);
+    } else if (camera->type == CAMERA_TYPE_EMULATED) {
+        EmulatedCameraContext* ctx = (EmulatedCameraContext*)camera->backend_context;
+        return emulated_camera_set_buffering(ctx, buffer_count, newest_only);
+    }
+    
+    return -1;
+}
+
+int camera_interface_list_sensor_modes(Camera* camera, CameraSensorMode* modes, int capacity) {
+    if (!camera || !modes || capacity < 0) {
+        return -1;
+    }
+    
+    if (camera->type == CAMERA_TYPE_IMX477) {
+        CameraContext* ctx = (CameraContext*)camera->backend_context;
+        return camera_list_sensor_modes(ctx, modes, capacity);
+    }
+    
+    // Emulated camera has no sensor
+    return 0;
+}
+
+int camera_interface_set_sensor_mode(Camera* camera, const CameraSensorMode* mode) {
+    if (!camera) {
+        return -1;
+    }
+    
+    if (camera->type == CAMERA_TYPE_IMX477) {
+        CameraContext* ctx = (CameraContext*)camera->backend_context;
+        return camera_set_sensor_mode(ctx, mode);
+    }
+    
+    // Emulated camera has no sensor
+    return 0;
+}
+
+int camera_interface_set_prefetch(Camera* camera, int depth, int preload) {
+    if (!camera) {
+        return -1;
+    }
+    
+    if (camera->type == CAMERA_TYPE_EMULATED) {
+        EmulatedCameraContext* ctx = (EmulatedCameraContext*)camera->backend_context;
+        return emulated_camera_set_prefetch(ctx, depth, preload);
+    }
+    
+    // Real camera delivers frames as they are exposed
+    return 0;
+}
+
 int camera_interface_set_folder(Camera* camera, const char* folder_path) {
     if (!camera) {
         return -1;
@@ -104,8 +179,12 @@ int camera_interface_set_parameters(Camera* camera, const RodCameraParameters* p
         backend_params.saturation = (double)params->saturation;
         backend_params.awb_enable = params->awb_enable;
         backend_params.colour_temperature = -1;
-        backend_params.frame_duration_min = -1;
-        backend_params.frame_duration_max = -1;
+        backend_params.frame_duration_min = params->frame_duration_min;
+        backend_params.frame_duration_max = params->frame_duration_max;
+        backend_params.scaler_crop_x = params->crop_x;
+        backend_params.scaler_crop_y = params->crop_y;
+        backend_params.scaler_crop_width = params->crop_width;
+        backend_params.scaler_crop_height = params->crop_height;
         
         return camera_set_parameters(ctx, &backend_params);
     }
@@ -155,6 +234,46 @@ int camera_interface_capture_frame(Camera* camera, uint8_t** out_buffer,
     return result;
 }
 
+int camera_interface_acquire_frame(Camera* camera, CameraFrame* frame) {
+    if (!camera || !frame) {
+        return -1;
+    }
+    
+    int result = -1;
+    
+    if (camera->type == CAMERA_TYPE_IMX477) {
+        CameraContext* ctx = (CameraContext*)camera->backend_context;
+        result = camera_acquire_frame(ctx, frame);
+    } else if (camera->type == CAMERA_TYPE_EMULATED) {
+        EmulatedCameraContext* ctx = (EmulatedCameraContext*)camera->backend_context;
+        result = emulated_camera_acquire_frame(ctx, frame);
+    }
+    
+    if (result == 0) {
+        // Update internal dimensions from actual capture
+        camera->width = frame->width;
+        camera->height = frame->height;
+    }
+    
+    return result;
+}
+
+int camera_interface_release_frame(Camera* camera, CameraFrame* frame) {
+    if (!camera || !frame) {
+        return -1;
+    }
+    
+    if (camera->type == CAMERA_TYPE_IMX477) {
+        CameraContext* ctx = (CameraContext*)camera->backend_context;
+        return camera_release_frame(ctx, frame);
+    } else if (camera->type == CAMERA_TYPE_EMULATED) {
+        EmulatedCameraContext* ctx = (EmulatedCameraContext*)camera->backend_context;
+        return emulated_camera_release_frame(ctx, frame);
+    }
+    
+    return -1;
+}
+
 int camera_interface_get_width(Camera* camera) {
     if (!camera) {
         return -1;
@@ -222,4 +341,10 @@ void camera_get_default_parameters(RodCameraParameters* params) {
     params->awb_enable = -1;
     params->aec_enable = -1;
     params->noise_reduction_mode = -1;
+    params->frame_duration_min = -1;
+    params->frame_duration_max = -1;
+    params->crop_x = -1;
+    params->crop_y = -1;
+    params->crop_width = -1;
+    params->crop_height = -1;
 }
@@ -3,6 +3,7 @@
 
 #include <stddef.h>
 #include <stdint.h>
+#include "camera_frame.h"
 
 /**
  * Unified camera interface for ROD project
@@ -15,9 +16,10 @@
  *   camera_interface_set_size(cam, 640, 480);
  *   camera_interface_set_folder(cam, "path/to/images");  // For emulated only
  *   camera_interface_start(cam);
- *   unsigned char* frame;
- *   camera_interface_capture_frame(cam, &frame, &w, &h, &size);
- *   // ... process frame ...
+ *   CameraFrame frame;
+ *   camera_interface_acquire_frame(cam, &frame);   // Zero-copy (borrowed buffer)
+ *   // ... process frame.data ...
+ *   camera_interface_release_frame(cam, &frame);
  *   camera_interface_stop(cam);
  *   camera_destroy(cam);
  */
@@ -43,6 +45,12 @@ typedef struct RodCameraParameters {
     int awb_enable;          // 0 or 1, -1 for auto
     int aec_enable;          // 0 or 1, -1 for auto
     int noise_reduction_mode; // 0-4, -1 for auto
+    int frame_duration_min;  // Microseconds, -1 for sensor mode limit (min = max fixes the frame rate)
+    int frame_duration_max;  // Microseconds, -1 for sensor mode limit
+    int crop_x;              // ScalerCrop in full resolution sensor pixels, -1 for 0
+    int crop_y;
+    int crop_width;          // -1 for full field of view
+    int crop_height;
 } RodCameraParameters;
 
 /**
@@ -64,18 +72,90 @@ Camera* camera_create(CameraType type);
  */
 int camera_interface_set_size(Camera* camera, int width, int height);
 
+/**
+ * Set frame format and optional preview stream
+ * Must be called before camera_interface_start()
+ * 
+ * CAMERA_FORMAT_YUV420 exposes only the Y plane (gray, 1 byte per pixel):
+ * the ISP does the color conversion and a third of the bandwidth is used.
+ * The preview is a low resolution BGR888 image of the same frame.
+ * 
+ * @param camera Camera instance
+ * @param format CAMERA_FORMAT_BGR888 (default) or CAMERA_FORMAT_YUV420
+ * @param preview_width Preview width (0 = no preview)
+ * @param preview_height Preview height (0 = no preview)
+ * @return 0 on success, -1 on failure
+ */
+int camera_interface_set_format(Camera* camera, CameraPixelFormat format,
+                                int preview_width, int preview_height);
+
+/**
+ * Set the number of camera buffers and the stale frame policy
+ * Must be called before camera_interface_start()
+ * 
+ * A frame acquired with camera_interface_acquire_frame() is not refilled until
+ * it is released: buffer_count must exceed the number of frames the pipeline
+ * holds at once. With newest_only, acquire skips frames that completed while
+ * the pipeline was busy (they are given back to the camera at once).
+ * 
+ * @param camera Camera instance
+ * @param buffer_count Buffers per stream (0 = backend default)
+ * @param newest_only Non-zero: always return the newest completed frame
+ * @return 0 on success, -1 on failure
+ */
+int camera_interface_set_buffering(Camera* camera, int buffer_count, int newest_only);
+
+/**
+ * List the sensor readout modes (real camera only)
+ * Must be called before camera_interface_start()
+ * 
+ * @param camera Camera instance
+ * @param modes Output array
+ * @param capacity Size of the output array
+ * @return Number of modes written (0 for the emulated camera), -1 on failure
+ */
+int camera_interface_list_sensor_modes(Camera* camera, CameraSensorMode* modes, int capacity);
+
+/**
+ * Force the sensor readout mode (real camera only)
+ * Must be called before camera_interface_start()
+ * 
+ * A binned mode trades resolution for frame rate; the stream size set with
+ * camera_interface_set_size() should then match the mode to avoid upscaling.
+ * 
+ * @param camera Camera instance
+ * @param mode Mode from camera_interface_list_sensor_modes() (NULL = automatic)
+ * @return 0 on success, -1 on failure
+ */
+int camera_interface_set_sensor_mode(Camera* camera, const CameraSensorMode* mode);
+
+/**
+ * Decode replay images ahead of acquire (emulated camera only)
+ * Must be called before camera_interface_start()
+ * 
+ * Keeps the JPEG decode out of the pipeline timings: a background thread decodes
+ * up to depth frames ahead, or every image is decoded once at start (preload).
+ * 
+ * @param camera Camera instance
+ * @param depth Frames decoded ahead (0 = decode in acquire)
+ * @param preload Non-zero: decode all images at start and replay them from memory
+ * @return 0 on success, -1 on failure
+ */
+int camera_interface_set_prefetch(Camera* camera, int depth, int preload);
+
 /**
  * Set image folder (emulated camera only)
  * Must be called before camera_interface_start() for emulated cameras
  * 
  * @param camera Camera instance
- * @param folder_path Path to folder containing images
+ * @param folder_path Path to folder containing images, or to a recorded session file
  * @return 0 on success, -1 on failure
  */
 int camera_interface_set_folder(Camera* camera, const char* folder_path);
 
 /**
  * Set camera parameters (real camera only)
+ * Can be called while the camera runs: the new controls apply a few frames later
  * 
  * @param camera Camera instance
  * @param params Camera parameters
@@ -112,6 +192,27 @@ int camera_interface_start(Camera* camera);
 int camera_interface_capture_frame(Camera* camera, uint8_t** out_buffer, 
                                    int* out_width, int* out_height, size_t* out_size);
 
+/**
+ * Borrow the next frame without copying it
+ * The frame data points into the backend buffer and stays valid until
+ * camera_interface_release_frame() is called (release every acquired frame,
+ * and drop any ImageHandle view on frame->data before releasing).
+ * 
+ * @param camera Camera instance
+ * @param frame Frame descriptor to fill (frame->format, frame->stride bytes per row)
+ * @return 0 on success, -1 on failure
+ */
+int camera_interface_acquire_frame(Camera* camera, CameraFrame* frame);
+
+/**
+ * Give a borrowed frame back to the camera backend
+ * 
+ * @param camera Camera instance
+ * @param frame Frame obtained from camera_interface_acquire_frame()
+ * @return 0 on success, -1 on failure
+ */
+int camera_interface_release_frame(Camera* camera, CameraFrame* frame);
+
 /**
  * Get current image width
  * 
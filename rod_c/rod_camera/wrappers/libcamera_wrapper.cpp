@@ -6,14 +6,29 @@
 #include <thread>
 #include <chrono>
 #include <cstring>
+#include <cstdlib>
+#include <string>
 #include <sys/mman.h>
 #include <vector>
 #include <queue>
 #include <condition_variable>
 #include <mutex>
+#include <map>
+#include <algorithm>
+#include <optional>
 
 using namespace libcamera;
 
+// Stream indices in the camera configuration
+#define MAIN_STREAM 0
+#define PREVIEW_STREAM 1
+
+// Memory mapping of one FrameBuffer (mapped once at start, reused for every frame)
+struct MappedFrameBuffer {
+    std::vector<uint8_t*> planes;                   // Start address of each plane
+    std::vector<std::pair<void*, size_t>> mappings; // One mmap per distinct dmabuf fd
+};
+
 // Internal definition of LibCameraContext (C++ types)
 struct LibCameraContext {
     std::unique_ptr<CameraManager> camera_manager;
@@ -21,12 +36,23 @@ struct LibCameraContext {
     std::unique_ptr<CameraConfiguration> config;
     FrameBufferAllocator *allocator;
     std::vector<std::unique_ptr<Request>> requests;
+    std::map<const FrameBuffer*, MappedFrameBuffer> mapped_buffers;
+    CameraPixelFormat format;  // Main stream format (after validation)
+    bool has_preview;          // Low resolution BGR888 viewfinder stream configured
+    unsigned int buffer_count; // Requested buffers per stream (0 = libcamera default)
+    bool newest_only;          // Acquire requeues older completed requests and returns the newest
+    CameraSensorMode sensor_mode; // Forced sensor mode (width 0 = chosen by libcamera)
     
     // Synchronization for request completion
     std::mutex request_mutex;
     std::condition_variable request_cv;
     std::queue<Request*> completed_requests;  // Queue of completed requests (not just one)
     bool running;  // Flag to control continuous capture
+
+    // Controls changed while running, set on the next requeued request
+    std::mutex controls_mutex;
+    ControlList pending_controls;
+    bool has_pending_controls;
 };
 
 // Static context pointer for signal callback (single camera support)
@@ -34,31 +60,65 @@ static LibCameraContext *g_active_context = nullptr;
 static std::mutex g_context_mutex;
 
 // Static callback handler for request completion signal
-// Follows libcamera pattern: add to queue, requeue immediately, notify
+// Completed requests are only queued here: the buffer belongs to the consumer
+// until it is released, which is when the request is requeued to the camera.
 static void request_completed_handler(Request *request) {
     std::lock_guard<std::mutex> ctx_lock(g_context_mutex);
     
     if (!g_active_context || !request) return;
     
-    {
-        std::lock_guard<std::mutex> lock(g_active_context->request_mutex);
-        
-        // Add to queue for processing (only if status is good)
-        if (request->status() == Request::RequestComplete) {
-            g_active_context->completed_requests.push(request);
-            g_active_context->request_cv.notify_one();
-        } else if (request->status() == Request::RequestCancelled) {
-            // Don't queue cancelled requests
-            std::cerr << "Request cancelled in callback" << std::endl;
+    std::lock_guard<std::mutex> lock(g_active_context->request_mutex);
+    
+    // Add to queue for processing (only if status is good)
+    if (request->status() == Request::RequestComplete) {
+        g_active_context->completed_requests.push(request);
+        g_active_context->request_cv.notify_one();
+    } else if (request->status() == Request::RequestCancelled) {
+        // Don't queue cancelled requests
+        std::cerr << "Request cancelled in callback" << std::endl;
+    }
+}
+
+/**
+ * Map every plane of a FrameBuffer into the process address space.
+ * Planes sharing the same dmabuf fd (e.g. YUV420) share a single mapping.
+ */
+static int map_frame_buffer(const FrameBuffer* buffer, MappedFrameBuffer& mapped) {
+    const auto& planes = buffer->planes();
+    
+    // Compute mapping length per fd (planes may be stored at offsets in the same dmabuf)
+    std::map<int, size_t> fd_lengths;
+    for (const auto& plane : planes) {
+        size_t end = static_cast<size_t>(plane.offset) + plane.length;
+        size_t& length = fd_lengths[plane.fd.get()];
+        length = std::max(length, end);
+    }
+    
+    std::map<int, uint8_t*> fd_addresses;
+    for (const auto& entry : fd_lengths) {
+        void* mem = mmap(nullptr, entry.second, PROT_READ, MAP_SHARED, entry.first, 0);
+        if (mem == MAP_FAILED) {
+            std::cerr << "Failed to mmap frame buffer" << std::endl;
+            return -1;
         }
+        mapped.mappings.push_back({mem, entry.second});
+        fd_addresses[entry.first] = static_cast<uint8_t*>(mem);
     }
     
-    // Requeue immediately for continuous capture (standard libcamera pattern)
-    // This happens OUTSIDE the queue lock to avoid deadlock
-    if (g_active_context->running && request->status() == Request::RequestComplete) {
-        request->reuse(Request::ReuseBuffers);
-        g_active_context->camera->queueRequest(request);
+    for (const auto& plane : planes) {
+        mapped.planes.push_back(fd_addresses[plane.fd.get()] + plane.offset);
     }
+    
+    return 0;
+}
+
+static void unmap_frame_buffers(LibCameraContext* ctx) {
+    for (auto& entry : ctx->mapped_buffers) {
+        for (auto& mapping : entry.second.mappings) {
+            munmap(mapping.first, mapping.second);
+        }
+    }
+    ctx->mapped_buffers.clear();
 }
 
 extern "C" {
@@ -67,8 +127,14 @@ LibCameraContext* libcamera_init() {
     LibCameraContext* ctx = new LibCameraContext();
     ctx->camera_manager = std::make_unique<CameraManager>();
     ctx->allocator = nullptr;
+    ctx->format = CAMERA_FORMAT_BGR888;
+    ctx->has_preview = false;
+    ctx->buffer_count = 0;
+    ctx->newest_only = false;
+    ctx->sensor_mode = CameraSensorMode{0, 0, 0, 0.0};
     // completed_requests queue is constructed empty by default
     ctx->running = false;
+    ctx->has_pending_controls = false;
 
     int ret = ctx->camera_manager->start();
     if (ret) {
@@ -104,18 +170,132 @@ int libcamera_open_camera(LibCameraContext* ctx, int camera_index) {
     return 0;
 }
 
+int libcamera_set_buffering(LibCameraContext* ctx, int buffer_count, int newest_only) {
+    if (!ctx || buffer_count < 0)
+        return -1;
+
+    ctx->buffer_count = static_cast<unsigned int>(buffer_count);
+    ctx->newest_only = newest_only != 0;
+    return 0;
+}
+
+/**
+ * Bits per pixel of a raw Bayer format, from its name (e.g. "SRGGB12_CSI2P" -> 12).
+ */
+static int raw_bit_depth(const PixelFormat& format) {
+    std::string name = format.toString();
+    size_t start = name.find_first_of("0123456789");
+    if (start == std::string::npos)
+        return 0;
+    return std::atoi(name.c_str() + start);
+}
+
+int libcamera_list_sensor_modes(LibCameraContext* ctx, CameraSensorMode* modes, int capacity) {
+    if (!ctx || !ctx->camera || !modes || capacity < 0 || ctx->running)
+        return -1;
+
+    // The raw stream formats are the sensor modes; the frame rate limits of a mode
+    // are only known once the camera is configured with it
+    std::unique_ptr<CameraConfiguration> raw = ctx->camera->generateConfiguration({StreamRole::Raw});
+    if (!raw || raw->size() != 1)
+        return -1;
+
+    StreamConfiguration &rawConfig = raw->at(0);
+    const StreamFormats formats = rawConfig.formats();
+    int count = 0;
+    for (const PixelFormat& format : formats.pixelformats()) {
+        int bit_depth = raw_bit_depth(format);
+        for (const Size& size : formats.sizes(format)) {
+            // Packed and unpacked variants of the same readout are one mode
+            bool known = false;
+            for (int i = 0; i < count; i++) {
+                known = known || (modes[i].width == (int)size.width && modes[i].height == (int)size.height &&
+                                  modes[i].bit_depth == bit_depth);
+            }
+            if (known || count >= capacity)
+                continue;
+
+            rawConfig.pixelFormat = format;
+            rawConfig.size = size;
+            double max_fps = 0.0;
+            if (raw->validate() != CameraConfiguration::Invalid && ctx->camera->configure(raw.get()) == 0) {
+                auto limits = ctx->camera->controls().find(&controls::FrameDurationLimits);
+                if (limits != ctx->camera->controls().end() && limits->second.min().get<int64_t>() > 0)
+                    max_fps = 1e6 / static_cast<double>(limits->second.min().get<int64_t>());
+            }
+
+            modes[count++] = CameraSensorMode{(int)size.width, (int)size.height, bit_depth, max_fps};
+        }
+    }
+
+    return count;
+}
+
+int libcamera_set_sensor_mode(LibCameraContext* ctx, const CameraSensorMode* mode) {
+    if (!ctx)
+        return -1;
+
+    if (!mode || mode->width <= 0 || mode->height <= 0) {
+        ctx->sensor_mode = CameraSensorMode{0, 0, 0, 0.0};
+        return 0;
+    }
+    if (mode->bit_depth <= 0)
+        return -1;
+
+    ctx->sensor_mode = *mode;
+    return 0;
+}
+
 int libcamera_configure(LibCameraContext* ctx, int width, int height) {
+    return libcamera_configure_streams(ctx, width, height, CAMERA_FORMAT_BGR888, 0, 0);
+}
+
+int libcamera_configure_streams(LibCameraContext* ctx, int width, int height,
+                                CameraPixelFormat format, int preview_width, int preview_height) {
     if (!ctx || !ctx->camera)
         return -1;
 
-    ctx->config = ctx->camera->generateConfiguration({StreamRole::StillCapture});
-    if (!ctx->config)
+    // Main stream at full resolution, optional low resolution viewfinder for debug images
+    bool want_preview = preview_width > 0 && preview_height > 0;
+    std::vector<StreamRole> roles = {StreamRole::StillCapture};
+    if (want_preview) {
+        roles.push_back(StreamRole::Viewfinder);
+    }
+
+    ctx->config = ctx->camera->generateConfiguration(roles);
+    if (!ctx->config || ctx->config->size() != roles.size())
         return -1;
 
-    StreamConfiguration &streamConfig = ctx->config->at(0);
+    // YUV420 lets the ISP produce luma directly: the Y plane is used as a gray image
+    const char* main_format = (format == CAMERA_FORMAT_YUV420) ? "YUV420" : "BGR888";
+    StreamConfiguration &streamConfig = ctx->config->at(MAIN_STREAM);
     streamConfig.size.width = width;
     streamConfig.size.height = height;
-    streamConfig.pixelFormat = PixelFormat::fromString("BGR888");
+    streamConfig.pixelFormat = PixelFormat::fromString(main_format);
+
+    if (want_preview) {
+        StreamConfiguration &previewConfig = ctx->config->at(PREVIEW_STREAM);
+        previewConfig.size.width = preview_width;
+        previewConfig.size.height = preview_height;
+        previewConfig.pixelFormat = PixelFormat::fromString("BGR888");
+    }
+
+    // Forced sensor readout (e.g. binned for frame rate): the ISP scales it to the stream size.
+    // Otherwise the StillCapture role picks the full resolution mode
+    if (ctx->sensor_mode.width > 0) {
+        SensorConfiguration sensor;
+        sensor.bitDepth = static_cast<unsigned int>(ctx->sensor_mode.bit_depth);
+        sensor.outputSize = Size(ctx->sensor_mode.width, ctx->sensor_mode.height);
+        ctx->config->sensorConfig = sensor;
+    }
+
+    // Frames borrowed by the consumer are not refilled: the camera needs more
+    // buffers than the consumer holds at once to keep streaming
+    if (ctx->buffer_count > 0) {
+        for (unsigned int i = 0; i < ctx->config->size(); i++) {
+            ctx->config->at(i).bufferCount = ctx->buffer_count;
+        }
+    }
 
     // Validate configuration (may modify format/size)
     CameraConfiguration::Status status = ctx->config->validate();
@@ -124,11 +304,35 @@ int libcamera_configure(LibCameraContext* ctx, int width, int height) {
         return -1;
     }
 
+    // Pixel formats must survive validation: the consumers rely on the layout
+    const StreamConfiguration &cfg = ctx->config->at(MAIN_STREAM);
+    if (!(cfg.pixelFormat == PixelFormat::fromString(main_format))) {
+        std::cerr << "Camera does not support " << main_format << " (got "
+                  << cfg.pixelFormat.toString() << ")" << std::endl;
+        return -1;
+    }
+    if (want_preview && !(ctx->config->at(PREVIEW_STREAM).pixelFormat == PixelFormat::fromString("BGR888"))) {
+        std::cerr << "Camera preview stream does not support BGR888" << std::endl;
+        return -1;
+    }
+
     // Debug: Print actual configuration after validation
-    const StreamConfiguration &cfg = ctx->config->at(0);
     std::cout << "Camera configured: " << cfg.size.width << "x" << cfg.size.height
               << " format=" << cfg.pixelFormat.toString()
-              << " stride=" << cfg.stride << std::endl;
+              << " stride=" << cfg.stride
+              << " buffers=" << cfg.bufferCount
+              << (ctx->newest_only ? " (newest frame only)" : "") << std::endl;
+    if (want_preview) {
+        const StreamConfiguration &preview = ctx->config->at(PREVIEW_STREAM);
+        std::cout << "Preview configured: " << preview.size.width << "x" << preview.size.height
+                  << " format=" << preview.pixelFormat.toString()
+                  << " stride=" << preview.stride << std::endl;
+    }
+    
+    if (ctx->sensor_mode.width > 0) {
+        std::cout << "Sensor mode: " << ctx->sensor_mode.width << "x" << ctx->sensor_mode.height
+                  << " " << ctx->sensor_mode.bit_depth << " bits" << std::endl;
+    }
     
     if (status == CameraConfiguration::Adjusted) {
         std::cout << "Note: Configuration was adjusted by libcamera" << std::endl;
@@ -137,6 +341,8 @@ int libcamera_configure(LibCameraContext* ctx, int width, int height) {
     if (ctx->camera->configure(ctx->config.get()) < 0)
         return -1;
 
+    ctx->format = format;
+    ctx->has_preview = want_preview;
     return 0;
 }
 
@@ -211,7 +417,15 @@ static ControlList build_control_list(const struct CameraParameters* params) {
         controls.set(controls::ColourTemperature, static_cast<int32_t>(params->colour_temperature));
     }
     
-    // Frame duration limits (default: 100ns to 1s)
+    // Sensor area scaled to the output (default: full field of view)
+    if (params && params->scaler_crop_width > 0 && params->scaler_crop_height > 0) {
+        controls.set(controls::ScalerCrop, Rectangle(params->scaler_crop_x < 0 ? 0 : params->scaler_crop_x,
+                                                     params->scaler_crop_y < 0 ? 0 : params->scaler_crop_y,
+                                                     static_cast<unsigned int>(params->scaler_crop_width),
+                                                     static_cast<unsigned int>(params->scaler_crop_height)));
+    }
+    
+    // Frame duration limits (default: 100 us to 1000 s, i.e. the sensor mode limits)
     int64_t frame_min = 100;
     int64_t frame_max = 1000000000;
     if (params && params->frame_duration_min >= 0) {
@@ -233,33 +447,56 @@ int libcamera_start_with_params(LibCameraContext* ctx, const struct CameraParame
     if (!ctx->allocator) {
         ctx->allocator = new FrameBufferAllocator(ctx->camera);
 
-        Stream *stream = ctx->config->at(0).stream();
-        if (ctx->allocator->allocate(stream) < 0) {
-            delete ctx->allocator;
-            ctx->allocator = nullptr;
-            return -1;
+        // Allocate buffers for every configured stream (main, then preview)
+        std::vector<Stream*> streams;
+        size_t request_count = 0;
+        for (unsigned int i = 0; i < ctx->config->size(); i++) {
+            Stream *stream = ctx->config->at(i).stream();
+            if (ctx->allocator->allocate(stream) < 0) {
+                delete ctx->allocator;
+                ctx->allocator = nullptr;
+                return -1;
+            }
+            size_t count = ctx->allocator->buffers(stream).size();
+            request_count = streams.empty() ? count : std::min(request_count, count);
+            streams.push_back(stream);
         }
         
-        // Create requests for each allocated buffer (per libcamera docs pattern)
-        const auto &buffers = ctx->allocator->buffers(stream);
-        for (const auto &buffer : buffers) {
+        // Create one request per buffer set (per libcamera docs pattern)
+        for (size_t index = 0; index < request_count; index++) {
             std::unique_ptr<Request> request = ctx->camera->createRequest();
             if (!request) {
                 std::cerr << "Failed to create request" << std::endl;
                 return -1;
             }
             
-            if (request->addBuffer(stream, buffer.get()) < 0) {
-                std::cerr << "Failed to add buffer to request" << std::endl;
-                return -1;
+            for (Stream *stream : streams) {
+                FrameBuffer *buffer = ctx->allocator->buffers(stream)[index].get();
+                if (request->addBuffer(stream, buffer) < 0) {
+                    std::cerr << "Failed to add buffer to request" << std::endl;
+                    return -1;
+                }
+                
+                // Map the buffer once for the whole capture session (zero-copy access)
+                MappedFrameBuffer mapped;
+                if (map_frame_buffer(buffer, mapped) != 0) {
+                    unmap_frame_buffers(ctx);
+                    return -1;
+                }
+                ctx->mapped_buffers[buffer] = std::move(mapped);
             }
             
             ctx->requests.push_back(std::move(request));
         }
     }
 
-    // Build control list from parameters
+    // Build control list from parameters (they supersede any runtime change not applied yet)
     ControlList controls = build_control_list(params);
+    {
+        std::lock_guard<std::mutex> lock(ctx->controls_mutex);
+        ctx->pending_controls.clear();
+        ctx->has_pending_controls = false;
+    }
     
     // Apply controls and start camera
     if (ctx->camera->start(&controls) < 0)
@@ -280,6 +517,23 @@ int libcamera_start_with_params(LibCameraContext* ctx, const struct CameraParame
     return 0;
 }
 
+/**
+ * Change the controls of a running camera: they are set on the next request
+ * given back to the camera, so they take effect a few frames later without
+ * stopping the stream. Replaces controls not applied yet.
+ * Returns 0 on success, -1 if the camera is not running.
+ */
+int libcamera_set_controls(LibCameraContext* ctx, const struct CameraParameters* params) {
+    if (!ctx || !ctx->camera || !params || !ctx->running)
+        return -1;
+
+    ControlList controls = build_control_list(params);
+    std::lock_guard<std::mutex> lock(ctx->controls_mutex);
+    ctx->pending_controls = std::move(controls);
+    ctx->has_pending_controls = true;
+    return 0;
+}
+
 int libcamera_stop(LibCameraContext* ctx) {
     if (!ctx || !ctx->camera)
         return -1;
@@ -301,8 +555,10 @@ int libcamera_stop(LibCameraContext* ctx) {
         }
     }
     
-    // Clear requests and allocator for clean restart
+    // Clear requests, mappings and allocator for clean restart
+    // (frames still acquired by the caller are invalid from now on)
     ctx->requests.clear();
+    unmap_frame_buffers(ctx);
     
     if (ctx->allocator) {
         delete ctx->allocator;
@@ -313,18 +569,51 @@ int libcamera_stop(LibCameraContext* ctx) {
 }
 
 /**
- * Capture a single frame and return its buffer, dimensions and size.
- * Returns BGR888 format buffer (OpenCV native format).
- * The caller must free() the returned buffer.
+ * Find the mapped planes of the buffer a request holds for a stream.
+ * Returns nullptr if the request has no mapped buffer for this stream.
+ */
+static const MappedFrameBuffer* find_mapped_buffer(LibCameraContext* ctx, Request* request, unsigned int index) {
+    FrameBuffer *buffer = request->findBuffer(ctx->config->at(index).stream());
+    auto mapped = buffer ? ctx->mapped_buffers.find(buffer) : ctx->mapped_buffers.end();
+    if (mapped == ctx->mapped_buffers.end() || mapped->second.planes.empty())
+        return nullptr;
+    return &mapped->second;
+}
+
+/**
+ * Give a request back to the camera so its buffers are filled again.
+ */
+static int requeue_request(LibCameraContext* ctx, Request* request) {
+    if (!ctx->running)
+        return 0;  // Camera stopped: requests are no longer valid
+
+    request->reuse(Request::ReuseBuffers);
+    {
+        // Controls persist in the pipeline once applied: one request carries them
+        std::lock_guard<std::mutex> lock(ctx->controls_mutex);
+        if (ctx->has_pending_controls) {
+            request->controls().merge(ctx->pending_controls);
+            ctx->pending_controls.clear();
+            ctx->has_pending_controls = false;
+        }
+    }
+    if (ctx->camera->queueRequest(request) < 0) {
+        std::cerr << "Failed to requeue request" << std::endl;
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * Borrow the oldest completed frame without copying it (the newest one when
+ * newest_only is set: older completed requests go straight back to the camera).
+ * The returned data points into the mmapped FrameBuffer (BGR888, or the Y plane
+ * for YUV420; cfg.stride bytes per row), plus the preview buffer if configured.
+ * The request stays owned by the caller until libcamera_release_frame() requeues it.
  * Returns 0 on success, -1 on failure.
- * 
- * Note: Requests are automatically requeued by the completion callback,
- * so this function only waits for and processes the buffer.
  */
-int libcamera_capture_frame(LibCameraContext* ctx, uint8_t** out_buffer,
-                            int* out_width, int* out_height,
-                            size_t* out_size, int timeout_ms) {
-    if (!ctx || !ctx->camera || !ctx->allocator)
+int libcamera_acquire_frame(LibCameraContext* ctx, CameraFrame* frame, int timeout_ms) {
+    if (!ctx || !ctx->camera || !ctx->allocator || !frame)
         return -1;
 
     // Wait for a completed request to be available in the queue
@@ -340,69 +629,136 @@ int libcamera_capture_frame(LibCameraContext* ctx, uint8_t** out_buffer,
         return -1;
     }
 
-    // Pop the oldest completed request from the queue
+    // Pop the oldest completed request from the queue, or skip to the newest one
+    // (stale exposures would only add latency)
+    std::vector<Request*> stale;
+    if (ctx->newest_only) {
+        while (ctx->completed_requests.size() > 1) {
+            stale.push_back(ctx->completed_requests.front());
+            ctx->completed_requests.pop();
+        }
+    }
     Request* request = ctx->completed_requests.front();
     ctx->completed_requests.pop();
-    lock.unlock();  // Release lock while processing buffer
+    lock.unlock();
+
+    for (Request* old : stale)
+        requeue_request(ctx, old);
 
     if (!request) {
         std::cerr << "Null request in queue" << std::endl;
         return -1;
     }
 
-    // Get buffer from request
-    Stream *stream = ctx->config->at(0).stream();
-    FrameBuffer *buffer = request->findBuffer(stream);
-    if (!buffer) {
-        std::cerr << "No buffer found in completed request" << std::endl;
+    // Get buffers from request
+    const MappedFrameBuffer* mapped = find_mapped_buffer(ctx, request, MAIN_STREAM);
+    const MappedFrameBuffer* preview = ctx->has_preview ? find_mapped_buffer(ctx, request, PREVIEW_STREAM) : nullptr;
+    if (!mapped || (ctx->has_preview && !preview)) {
+        std::cerr << "No mapped buffer found in completed request" << std::endl;
+        requeue_request(ctx, request);
         return -1;
     }
 
-    // Get stream configuration for dimensions and stride
-    const StreamConfiguration &cfg = ctx->config->at(0);
-    *out_width = cfg.size.width;
-    *out_height = cfg.size.height;
-    unsigned int stride = cfg.stride;
+    // Describe the frame in place (no copy); for YUV420 plane 0 is the Y plane
+    const StreamConfiguration &cfg = ctx->config->at(MAIN_STREAM);
+    frame->data = mapped->planes.front();
+    frame->width = cfg.size.width;
+    frame->height = cfg.size.height;
+    frame->stride = cfg.stride;
+    frame->size = static_cast<size_t>(cfg.stride) * cfg.size.height;
+    frame->format = ctx->format;
+
+    // Exposure identity: sensor timestamp from the request metadata (same clock as
+    // CLOCK_MONOTONIC), buffer timestamp if the pipeline handler does not report it
+    const FrameBuffer *buffer = request->findBuffer(cfg.stream());
+    const FrameMetadata &buffer_metadata = buffer->metadata();
+    std::optional<int64_t> sensor_timestamp = request->metadata().get(controls::SensorTimestamp);
+    frame->timestamp_ns = sensor_timestamp ? static_cast<uint64_t>(*sensor_timestamp) : buffer_metadata.timestamp;
+    frame->sequence = buffer_metadata.sequence;
+    frame->recorded = 0;
+    frame->recorded_sequence = 0;
+    frame->recorded_timestamp_ns = 0;
+
+    if (preview) {
+        const StreamConfiguration &preview_cfg = ctx->config->at(PREVIEW_STREAM);
+        frame->preview_data = preview->planes.front();
+        frame->preview_width = preview_cfg.size.width;
+        frame->preview_height = preview_cfg.size.height;
+        frame->preview_stride = preview_cfg.stride;
+    } else {
+        frame->preview_data = nullptr;
+        frame->preview_width = 0;
+        frame->preview_height = 0;
+        frame->preview_stride = 0;
+    }
 
-    // Map buffer and copy data to caller-owned buffer
-    const FrameBuffer::Plane &plane = buffer->planes().front();
-    void *mem = mmap(nullptr, plane.length, PROT_READ, MAP_SHARED, plane.fd.get(), 0);
-    if (mem == MAP_FAILED) {
-        std::cerr << "Failed to mmap buffer" << std::endl;
+    frame->backend_handle = request;
+
+    return 0;
+}
+
+/**
+ * Give a borrowed frame back to the camera.
+ * The request is requeued so its buffer can be filled by the sensor again.
+ * Returns 0 on success, -1 on failure.
+ */
+int libcamera_release_frame(LibCameraContext* ctx, CameraFrame* frame) {
+    if (!ctx || !ctx->camera || !frame || !frame->backend_handle)
         return -1;
-    }
 
-    // Allocate buffer for caller (BGR888: 3 bytes per pixel, no padding)
-    size_t data_size = (*out_width) * (*out_height) * 3;
+    Request* request = static_cast<Request*>(frame->backend_handle);
+    frame->backend_handle = nullptr;
+    frame->data = nullptr;
+    frame->preview_data = nullptr;
+
+    return requeue_request(ctx, request);
+}
+
+/**
+ * Capture a single frame and return its buffer, dimensions and size.
+ * Returns a BGR888 buffer (OpenCV native format), or the Y plane only
+ * (1 byte per pixel) when the main stream is configured as YUV420.
+ * The caller must free() the returned buffer.
+ * Returns 0 on success, -1 on failure.
+ * 
+ * Note: This is the copying variant of libcamera_acquire_frame(); the request
+ * is requeued as soon as the copy is done.
+ */
+int libcamera_capture_frame(LibCameraContext* ctx, uint8_t** out_buffer,
+                            int* out_width, int* out_height,
+                            size_t* out_size, int timeout_ms) {
+    CameraFrame frame;
+    if (libcamera_acquire_frame(ctx, &frame, timeout_ms) != 0)
+        return -1;
+
+    *out_width = frame.width;
+    *out_height = frame.height;
+
+    // Allocate buffer for caller (BGR888: 3 bytes per pixel, Y plane: 1, no padding)
+    size_t row_bytes = static_cast<size_t>(*out_width) * camera_frame_channels(&frame);
+    size_t data_size = row_bytes * (*out_height);
     *out_buffer = (uint8_t*)malloc(data_size);
     if (!(*out_buffer)) {
-        munmap(mem, plane.length);
+        libcamera_release_frame(ctx, &frame);
         return -1;
     }
 
     // Copy data handling stride (row padding)
-    uint8_t* src = (uint8_t*)mem;
+    uint8_t* src = frame.data;
     uint8_t* dst = *out_buffer;
-    unsigned int row_bytes = (*out_width) * 3;  // BGR888 = 3 bytes per pixel
-    
-    if (stride == row_bytes) {
+    if (frame.stride == row_bytes) {
         // No padding - simple copy
         memcpy(dst, src, data_size);
     } else {
         // Stride includes padding - copy row by row
         for (int y = 0; y < *out_height; y++) {
-            memcpy(dst + y * row_bytes, src + y * stride, row_bytes);
+            memcpy(dst + y * row_bytes, src + y * frame.stride, row_bytes);
         }
     }
     
     *out_size = data_size;
 
-    // Unmap the buffer
-    munmap(mem, plane.length);
-    
-    // Request is already requeued by the callback - nothing more to do here
-
-    return 0;
+    return libcamera_release_frame(ctx, &frame);
 }
 
 void libcamera_cleanup(LibCameraContext* ctx) {
@@ -437,8 +793,9 @@ void libcamera_cleanup(LibCameraContext* ctx) {
         }
     }
     
-    // Clear requests before deleting allocator
+    // Clear requests and mappings before deleting allocator
     ctx->requests.clear();
+    unmap_frame_buffers(ctx);
     
     // Delete allocator after camera is stopped
     if (ctx->allocator) {
@@ -3,6 +3,7 @@
 
 #include <stdint.h>
 #include <stddef.h>
+#include "camera_frame.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -17,11 +18,25 @@ struct CameraParameters;
 LibCameraContext* libcamera_init();
 int libcamera_open_camera(LibCameraContext* ctx, int camera_index);
 int libcamera_configure(LibCameraContext* ctx, int width, int height);
+// Main stream format and optional low resolution BGR888 preview stream (0x0 = none)
+int libcamera_configure_streams(LibCameraContext* ctx, int width, int height,
+                                CameraPixelFormat format, int preview_width, int preview_height);
+// Buffers per stream (0 = libcamera default, 1 for StillCapture) and stale frame policy,
+// applied at the next configure
+int libcamera_set_buffering(LibCameraContext* ctx, int buffer_count, int newest_only);
+// Sensor modes (leaves the camera unconfigured, not while running), returns the count written
+int libcamera_list_sensor_modes(LibCameraContext* ctx, CameraSensorMode* modes, int capacity);
+// Sensor mode used at the next configure (NULL or 0x0 = chosen by libcamera from the stream size)
+int libcamera_set_sensor_mode(LibCameraContext* ctx, const CameraSensorMode* mode);
 int libcamera_start_with_params(LibCameraContext* ctx, const struct CameraParameters* params);
+// Controls applied to the next requests given back to the running camera (no restart)
+int libcamera_set_controls(LibCameraContext* ctx, const struct CameraParameters* params);
 int libcamera_stop(LibCameraContext* ctx);
 int libcamera_capture_frame(LibCameraContext* ctx, uint8_t** out_buffer,
                             int* out_width, int* out_height,
                             size_t* out_size, int timeout_ms);
+int libcamera_acquire_frame(LibCameraContext* ctx, CameraFrame* frame, int timeout_ms);
+int libcamera_release_frame(LibCameraContext* ctx, CameraFrame* frame);
 void libcamera_cleanup(LibCameraContext* ctx);
 
 #ifdef __cplusplus
@@ -7,9 +7,18 @@
  * @copyright Cecill-C (Cf. LICENCE.txt)
  * 
  * This program implements the communication thread that:
- * - Connects to the detection thread via Unix socket
- * - Receives detected marker positions [[id, x, y, angle], ...]
- * - Prints detection data to console
+ * - Connects to the detection thread via Unix socket, from an epoll loop
+ *   woken by the socket, an inotify watch of the socket directory (the
+ *   detection process (re)creating it) and a reconnect backoff timer
+ * - Receives detection messages (binary framed, see rod_protocol.h,
+ *   or legacy text lines [[id, x, y, angle], ...] with --text), never
+ *   processing an incomplete one
+ * - Drains the socket on each wakeup and only processes the newest complete
+ *   message of a burst: older snapshots are superseded, not queued
+ * - Or, with --shm, reads the snapshots published in shared memory
+ *   (see rod_shm.h), alongside any number of other readers
+ * - Prints detection data to console, with the latency of each frame from
+ *   the sensor timestamp to detection, publication and reception
  * - Will eventually transmit data to the robot's main process
  */
 
@@ -24,15 +33,25 @@
 #include <errno.h>
 #include <signal.h>
 #include <stdbool.h>
-#include <poll.h>
+#include <time.h>
+#include <sys/epoll.h>
+#include <sys/inotify.h>
+#include <sys/timerfd.h>
+#include "rod_protocol.h"
+#include "rod_shm.h"
 
 /* ***************************************************** Public macros *************************************************** */
 
 // Socket configuration (must match rod_detection.c)
-#define SOCKET_PATH "/tmp/rod_detection.sock"
-#define MAX_BUFFER_SIZE 4096
-#define RECONNECT_DELAY_US 1000000  // 1 second in microseconds
-#define POLL_TIMEOUT_MS 100         // 100ms poll timeout for responsive shutdown
+#define SOCKET_DIR "/tmp"                         // Watched with inotify for the socket creation
+#define SOCKET_NAME "rod_detection.sock"
+#define SOCKET_PATH SOCKET_DIR "/" SOCKET_NAME
+#define SHM_NAME "/rod_detections"                // Must match ROD_SHM_NAME
+#define MAX_BUFFER_SIZE 4096                      // Text mode line buffer
+#define RECONNECT_BACKOFF_MIN_MS 10               // First retry delay, doubled after each failure
+#define RECONNECT_BACKOFF_MAX_MS 1000             // Retry delay upper bound
+#define POLL_TIMEOUT_MS 100                       // Shared memory wait timeout for responsive shutdown
+#define MAX_EVENTS 4                              // Socket, inotify, timer
 
 /* ************************************************** Public types definition ******************************************** */
 
@@ -41,8 +60,19 @@
  */
 typedef struct {
     int socket_fd;
+    int epoll_fd;
+    int inotify_fd;                 // SOCKET_DIR watch, -1 if unavailable (backoff only)
+    int timer_fd;                   // Reconnect backoff
     bool running;
     bool connected;
+    bool text_mode;                 // Legacy text lines instead of binary messages
+    int backoff_ms;                 // Next reconnect delay
+    RodProtocolDecoder decoder;     // Binary stream reassembly (partial reads)
+    char line[MAX_BUFFER_SIZE];     // Text stream reassembly
+    size_t line_length;
+    RodProtocolMessage latest;      // Newest complete message of the current burst
+    char latest_line[MAX_BUFFER_SIZE];
+    unsigned long superseded;       // Messages replaced by a newer one before being processed
 } CommContext;
 
 /* *********************************************** Public functions declarations ***************************************** */
@@ -53,6 +83,19 @@ typedef struct {
  */
 static void init_comm_context(CommContext* ctx);
 
+/**
+ * @brief Create the epoll instance, the socket directory watch and the backoff timer
+ * @param ctx Communication context
+ * @return 0 on success, -1 on failure
+ */
+static int setup_event_loop(CommContext* ctx);
+
+/**
+ * @brief Try to connect now, or arm the backoff timer for the next attempt
+ * @param ctx Communication context
+ */
+static void try_connect(CommContext* ctx);
+
 /**
  * @brief Connect to the detection thread socket
  * @param ctx Communication context
@@ -60,6 +103,12 @@ static void init_comm_context(CommContext* ctx);
  */
 static int connect_to_detection_socket(CommContext* ctx);
 
+/**
+ * @brief Close the detection socket (the event loop stays open)
+ * @param ctx Communication context
+ */
+static void close_connection(CommContext* ctx);
+
 /**
  * @brief Cleanup communication context
  * @param ctx Communication context
@@ -67,11 +116,43 @@ static int connect_to_detection_socket(CommContext* ctx);
 static void cleanup_comm_context(CommContext* ctx);
 
 /**
- * @brief Process received detection data
- * @param data Received data string
+ * @brief Receive every available byte, then process the newest complete message
+ * @param ctx Communication context
+ * @return 0 while connected, -1 if the peer closed the connection or on error
+ */
+static int receive_messages(CommContext* ctx);
+
+/**
+ * @brief Extract the complete messages received so far into ctx->latest / ctx->latest_line
+ * @param ctx Communication context
+ * @return Number of complete messages extracted
+ */
+static int extract_messages(CommContext* ctx);
+
+/**
+ * @brief Handle the socket directory events (reconnect as soon as the socket appears)
+ * @param ctx Communication context
+ */
+static void handle_inotify_events(CommContext* ctx);
+
+/**
+ * @brief Process one decoded detection message
+ * @param message Decoded message
+ */
+static void process_detection_message(const RodProtocolMessage* message);
+
+/**
+ * @brief Process received detection data (text mode)
+ * @param data Received data string (one line)
  */
 static void process_detection_data(const char* data);
 
+/**
+ * @brief Read detection snapshots from shared memory until shutdown
+ * @return 0 on success
+ */
+static int run_shm_loop(void);
+
 /**
  * @brief Signal handler for graceful shutdown
  * @param signum Signal number
@@ -92,22 +173,63 @@ static void signal_handler(int signum) {
 
 static void init_comm_context(CommContext* ctx) {
     ctx->socket_fd = -1;
+    ctx->epoll_fd = -1;
+    ctx->inotify_fd = -1;
+    ctx->timer_fd = -1;
     ctx->running = true;
     ctx->connected = false;
+    ctx->text_mode = false;
+    ctx->backoff_ms = RECONNECT_BACKOFF_MIN_MS;
+    rod_protocol_decoder_init(&ctx->decoder);
+    ctx->line_length = 0;
+    ctx->superseded = 0;
+}
+
+static int setup_event_loop(CommContext* ctx) {
+    ctx->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (ctx->epoll_fd < 0) {
+        fprintf(stderr, "Failed to create epoll instance: %s\n", strerror(errno));
+        return -1;
+    }
+    
+    ctx->timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (ctx->timer_fd < 0) {
+        fprintf(stderr, "Failed to create reconnect timer: %s\n", strerror(errno));
+        return -1;
+    }
+    struct epoll_event event = {.events = EPOLLIN, .data.fd = ctx->timer_fd};
+    if (epoll_ctl(ctx->epoll_fd, EPOLL_CTL_ADD, ctx->timer_fd, &event) != 0) {
+        fprintf(stderr, "Failed to watch reconnect timer: %s\n", strerror(errno));
+        return -1;
+    }
+    
+    // The socket directory watch only shortens the reconnect delay: the backoff timer still works without it
+    ctx->inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (ctx->inotify_fd >= 0 && inotify_add_watch(ctx->inotify_fd, SOCKET_DIR, IN_CREATE) < 0) {
+        close(ctx->inotify_fd);
+        ctx->inotify_fd = -1;
+    }
+    if (ctx->inotify_fd >= 0) {
+        event.data.fd = ctx->inotify_fd;
+        if (epoll_ctl(ctx->epoll_fd, EPOLL_CTL_ADD, ctx->inotify_fd, &event) != 0) {
+            close(ctx->inotify_fd);
+            ctx->inotify_fd = -1;
+        }
+    }
+    if (ctx->inotify_fd < 0) {
+        fprintf(stderr, "Cannot watch %s (%s), reconnecting on the backoff timer only\n", SOCKET_DIR, strerror(errno));
+    }
+    return 0;
 }
 
 static int connect_to_detection_socket(CommContext* ctx) {
     struct sockaddr_un addr;
     
     // Close existing connection if any
-    if (ctx->socket_fd >= 0) {
-        close(ctx->socket_fd);
-        ctx->socket_fd = -1;
-        ctx->connected = false;
-    }
+    close_connection(ctx);
     
-    // Create socket
-    ctx->socket_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    // Create socket (non-blocking: each wakeup drains it until EAGAIN)
+    ctx->socket_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
     if (ctx->socket_fd < 0) {
         fprintf(stderr, "Failed to create socket: %s\n", strerror(errno));
         return -1;
@@ -126,19 +248,207 @@ static int connect_to_detection_socket(CommContext* ctx) {
         return -1;
     }
     
+    struct epoll_event event = {.events = EPOLLIN | EPOLLRDHUP, .data.fd = ctx->socket_fd};
+    if (epoll_ctl(ctx->epoll_fd, EPOLL_CTL_ADD, ctx->socket_fd, &event) != 0) {
+        fprintf(stderr, "Failed to watch socket: %s\n", strerror(errno));
+        close(ctx->socket_fd);
+        ctx->socket_fd = -1;
+        return -1;
+    }
+    
+    // Drop partial data from a previous connection
+    rod_protocol_decoder_init(&ctx->decoder);
+    ctx->line_length = 0;
+    
     ctx->connected = true;
     printf("Successfully connected to detection socket: %s\n", SOCKET_PATH);
     return 0;
 }
 
-static void cleanup_comm_context(CommContext* ctx) {
+static void try_connect(CommContext* ctx) {
+    struct itimerspec timer;
+    memset(&timer, 0, sizeof(timer));
+    
+    if (connect_to_detection_socket(ctx) == 0) {
+        ctx->backoff_ms = RECONNECT_BACKOFF_MIN_MS;
+        timerfd_settime(ctx->timer_fd, 0, &timer, NULL);  // Disarm
+        return;
+    }
+    
+    printf("Connection failed, retrying in %d ms%s...\n", ctx->backoff_ms,
+           ctx->inotify_fd >= 0 ? " or when the socket is created" : "");
+    timer.it_value.tv_sec = ctx->backoff_ms / 1000;
+    timer.it_value.tv_nsec = (long)(ctx->backoff_ms % 1000) * 1000000L;
+    timerfd_settime(ctx->timer_fd, 0, &timer, NULL);
+    
+    ctx->backoff_ms *= 2;
+    if (ctx->backoff_ms > RECONNECT_BACKOFF_MAX_MS) {
+        ctx->backoff_ms = RECONNECT_BACKOFF_MAX_MS;
+    }
+}
+
+static void close_connection(CommContext* ctx) {
     if (ctx->socket_fd >= 0) {
-        close(ctx->socket_fd);
+        close(ctx->socket_fd);  // Also removes it from the epoll set
         ctx->socket_fd = -1;
     }
     ctx->connected = false;
 }
 
+static void cleanup_comm_context(CommContext* ctx) {
+    close_connection(ctx);
+    if (ctx->inotify_fd >= 0) close(ctx->inotify_fd);
+    if (ctx->timer_fd >= 0) close(ctx->timer_fd);
+    if (ctx->epoll_fd >= 0) close(ctx->epoll_fd);
+    ctx->inotify_fd = -1;
+    ctx->timer_fd = -1;
+    ctx->epoll_fd = -1;
+}
+
+static void handle_inotify_events(CommContext* ctx) {
+    char buffer[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+    bool created = false;
+    ssize_t length;
+    
+    while ((length = read(ctx->inotify_fd, buffer, sizeof(buffer))) > 0) {
+        for (char* p = buffer; p < buffer + length; ) {
+            const struct inotify_event* event = (const struct inotify_event*)p;
+            if (event->len > 0 && strcmp(event->name, SOCKET_NAME) == 0) {
+                created = true;
+            }
+            p += sizeof(struct inotify_event) + event->len;
+        }
+    }
+    
+    if (created && !ctx->connected) {
+        // The server binds before it listens: a refused attempt is retried from the minimum delay
+        printf("Detection socket created, connecting...\n");
+        ctx->backoff_ms = RECONNECT_BACKOFF_MIN_MS;
+        try_connect(ctx);
+    }
+}
+
+static int extract_messages(CommContext* ctx) {
+    int count = 0;
+    
+    if (!ctx->text_mode) {
+        int ret;
+        while ((ret = rod_protocol_decoder_next(&ctx->decoder, &ctx->latest)) != 0) {
+            if (ret > 0) {
+                count++;
+            } else {
+                fprintf(stderr, "Invalid data skipped (%lu bytes so far)\n", ctx->decoder.discarded);
+            }
+        }
+        return count;
+    }
+    
+    // Text mode: keep the last complete line, the incomplete end stays buffered
+    ctx->line[ctx->line_length] = '\0';
+    char* line_start = ctx->line;
+    char* newline;
+    while ((newline = strchr(line_start, '\n')) != NULL) {
+        size_t length = (size_t)(newline + 1 - line_start);
+        memcpy(ctx->latest_line, line_start, length);
+        ctx->latest_line[length] = '\0';
+        line_start = newline + 1;
+        count++;
+    }
+    
+    size_t remaining = ctx->line_length - (size_t)(line_start - ctx->line);
+    if (remaining == MAX_BUFFER_SIZE - 1) {
+        fprintf(stderr, "Text line too long, dropped\n");
+        remaining = 0;
+    }
+    memmove(ctx->line, line_start, remaining);
+    ctx->line_length = remaining;
+    return count;
+}
+
+static int receive_messages(CommContext* ctx) {
+    int count = 0;
+    int result = 0;
+    
+    // Drain the socket: a burst queued while this process was busy is read in one go
+    while (true) {
+        uint8_t* dst;
+        size_t available;
+        if (!ctx->text_mode) {
+            dst = rod_protocol_decoder_write_ptr(&ctx->decoder, &available);
+        } else {
+            dst = (uint8_t*)ctx->line + ctx->line_length;
+            available = MAX_BUFFER_SIZE - 1 - ctx->line_length;
+        }
+        
+        ssize_t bytes_received = recv(ctx->socket_fd, dst, available, 0);
+        if (bytes_received < 0 && errno == EINTR) continue;
+        if (bytes_received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+        if (bytes_received == 0) {
+            printf("Detection thread closed connection, reconnecting...\n");
+            result = -1;
+            break;
+        }
+        if (bytes_received < 0) {
+            fprintf(stderr, "Error receiving data: %s\n", strerror(errno));
+            result = -1;
+            break;
+        }
+        
+        if (!ctx->text_mode) {
+            rod_protocol_decoder_commit(&ctx->decoder, (size_t)bytes_received);
+        } else {
+            ctx->line_length += (size_t)bytes_received;
+        }
+        // Extract as we go so the buffer always has room, only the last message is kept
+        count += extract_messages(ctx);
+    }
+    
+    // Only the newest snapshot matters to the robot: older ones of the burst are superseded
+    if (count > 1) {
+        ctx->superseded += (unsigned long)(count - 1);
+        printf("%d older messages superseded (%lu so far)\n", count - 1, ctx->superseded);
+    }
+    if (count > 0) {
+        if (!ctx->text_mode) {
+            process_detection_message(&ctx->latest);
+        } else {
+            process_detection_data(ctx->latest_line);
+        }
+    }
+    return result;
+}
+
+/**
+ * @brief Current CLOCK_MONOTONIC time in microseconds (same clock as the sensor timestamps)
+ */
+static uint64_t get_time_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ULL + (uint64_t)ts.tv_nsec / 1000ULL;
+}
+
+static void process_detection_message(const RodProtocolMessage* message) {
+    uint64_t now_us = get_time_us();
+    double received_ms = now_us > message->timestamp_us ? (now_us - message->timestamp_us) / 1000.0 : 0.0;
+    
+    const char* origin = (message->flags & ROD_PROTOCOL_FLAG_CARRIED_OVER) ? " (carried over)"
+                       : (message->flags & ROD_PROTOCOL_FLAG_ROI_ONLY) ? " (regions only)" : "";
+    
+    printf("Frame %u (t=%.3fms): %d markers%s, latency acquired %.1fms detected %.1fms published %.1fms received %.1fms\n",
+           message->sequence, message->timestamp_us / 1000.0, message->count, origin,
+           message->timings.acquired_us / 1000.0, message->timings.detected_us / 1000.0,
+           message->timings.published_us / 1000.0, received_ms);
+    for (int i = 0; i < message->count; i++) {
+        const RodProtocolMarker* m = &message->markers[i];
+        printf("  [%d, %.2f, %.2f, %.4f] age %.1fms\n", m->id, m->x, m->y, m->angle, m->age_us / 1000.0);
+    }
+    
+    // TODO: In the future, this function will:
+    // - Transform coordinates to robot coordinate system
+    // - Send data to robot's main process via appropriate protocol
+    // - Handle acknowledgments and retransmissions
+}
+
 static void process_detection_data(const char* data) {
     // Print received detection data
     printf("Received detection data: %s", data);
@@ -150,95 +460,135 @@ static void process_detection_data(const char* data) {
     // - Handle acknowledgments and retransmissions
 }
 
+static int run_shm_loop(void) {
+    static RodProtocolMessage message;
+    RodShmReader* reader = NULL;
+    int backoff_ms = RECONNECT_BACKOFF_MIN_MS;
+    
+    while (g_running) {
+        if (!reader) {
+            reader = rod_shm_reader_open(SHM_NAME);
+            if (!reader) {
+                printf("Shared memory %s not available, retrying in %d ms...\n", SHM_NAME, backoff_ms);
+                usleep((useconds_t)backoff_ms * 1000);
+                backoff_ms = backoff_ms * 2 > RECONNECT_BACKOFF_MAX_MS ? RECONNECT_BACKOFF_MAX_MS : backoff_ms * 2;
+                continue;
+            }
+            printf("Successfully opened shared memory: %s\n", SHM_NAME);
+            backoff_ms = RECONNECT_BACKOFF_MIN_MS;
+        }
+        
+        // Sleep on the futex, with a timeout for responsive shutdown
+        rod_shm_reader_wait(reader, POLL_TIMEOUT_MS);
+        
+        // Catch up to the newest snapshot, the ones published in between are superseded
+        // (each call resets its lost count: add them up)
+        unsigned long total_lost = 0;
+        unsigned long lost = 0;
+        int count = 0;
+        int ret;
+        while ((ret = rod_shm_reader_next(reader, &message, &lost)) > 0) {
+            total_lost += lost;
+            count++;
+        }
+        if (total_lost > 0) {
+            fprintf(stderr, "%lu snapshots overwritten before being read\n", total_lost);
+        }
+        if (count > 1) {
+            printf("%d older snapshots superseded\n", count - 1);
+        }
+        if (count > 0) {
+            process_detection_message(&message);
+        }
+        
+        if (ret < 0) {
+            printf("Detection process closed shared memory, reopening...\n");
+            rod_shm_reader_close(reader);
+            reader = NULL;
+        }
+    }
+    
+    rod_shm_reader_close(reader);
+    return 0;
+}
+
 /**
  * @brief Main function of the communication thread
  * Connects to the detection thread socket and receives marker detection data.
  */
 int main(int argc, char* argv[]) {
-    CommContext ctx;
-    char buffer[MAX_BUFFER_SIZE];
+    static CommContext ctx;  // Holds the stream buffers, kept off the stack
     
-    (void)argc;  // Unused
-    (void)argv;  // Unused
+    // Initialize context
+    init_comm_context(&ctx);
+    
+    bool use_shm = false;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--text") == 0) {
+            ctx.text_mode = true;  // Must match ROD_SOCKET_TEXT_PROTOCOL of rod_detection
+        } else if (strcmp(argv[i], "--shm") == 0) {
+            use_shm = true;
+        } else {
+            fprintf(stderr, "Usage: %s [--text | --shm]\n", argv[0]);
+            return 1;
+        }
+    }
     
     printf("=== ROD Communication - IPC Thread ===\n");
-    printf("Waiting for detection data from %s\n\n", SOCKET_PATH);
     
     // Setup signal handler for graceful shutdown
     signal(SIGINT, signal_handler);
     signal(SIGTERM, signal_handler);
     
-    // Initialize context
-    init_comm_context(&ctx);
+    if (use_shm) {
+        printf("Waiting for detection snapshots from shared memory %s\n\n", SHM_NAME);
+        run_shm_loop();
+        printf("ROD Communication stopped successfully\n");
+        return 0;
+    }
     
-    // Main communication loop
+    // Shutdown signals are only delivered inside epoll_pwait(): no timeout needed to notice them
+    sigset_t blocked;
+    sigset_t wait_mask;
+    sigemptyset(&blocked);
+    sigaddset(&blocked, SIGINT);
+    sigaddset(&blocked, SIGTERM);
+    sigprocmask(SIG_BLOCK, &blocked, &wait_mask);
+    
+    if (setup_event_loop(&ctx) != 0) {
+        cleanup_comm_context(&ctx);
+        return 1;
+    }
+    
+    printf("Waiting for %s detection data from %s\n\n", ctx.text_mode ? "text" : "binary", SOCKET_PATH);
+    printf("Attempting to connect to detection socket...\n");
+    try_connect(&ctx);
+    
+    // Main communication loop: sleeps until data, the socket creation or the backoff timer
     while (g_running && ctx.running) {
-        // Try to connect if not connected
-        if (!ctx.connected) {
-            printf("Attempting to connect to detection socket...\n");
-            if (connect_to_detection_socket(&ctx) != 0) {
-                printf("Connection failed, retrying in 1 second...\n");
-                usleep(RECONNECT_DELAY_US);
-                continue;
-            }
+        struct epoll_event events[MAX_EVENTS];
+        int count = epoll_pwait(ctx.epoll_fd, events, MAX_EVENTS, -1, &wait_mask);
+        if (count < 0) {
+            if (errno == EINTR) continue;  // Interrupted by signal, check g_running
+            fprintf(stderr, "epoll error: %s\n", strerror(errno));
+            break;
         }
         
-        // Use poll() to wait for data with timeout (allows responsive shutdown)
-        struct pollfd pfd;
-        pfd.fd = ctx.socket_fd;
-        pfd.events = POLLIN;
-        pfd.revents = 0;
-        
-        int poll_result = poll(&pfd, 1, POLL_TIMEOUT_MS);
-        
-        if (poll_result < 0) {
-            // Poll error
-            if (errno == EINTR) {
-                // Interrupted by signal, check g_running and continue
-                continue;
-            }
-            fprintf(stderr, "Poll error: %s\n", strerror(errno));
-            cleanup_comm_context(&ctx);
-            usleep(RECONNECT_DELAY_US);
-            continue;
-            
-        } else if (poll_result == 0) {
-            // Timeout - no data available, loop back to check g_running
-            continue;
-            
-        } else {
-            // Data available or connection event
-            if (pfd.revents & (POLLHUP | POLLERR | POLLNVAL)) {
-                // Connection closed or error
-                printf("Detection thread closed connection, reconnecting...\n");
-                cleanup_comm_context(&ctx);
-                usleep(RECONNECT_DELAY_US);
-                continue;
-            }
-            
-            if (pfd.revents & POLLIN) {
-                // Data available - receive it
-                ssize_t bytes_received = recv(ctx.socket_fd, buffer, MAX_BUFFER_SIZE - 1, 0);
-                
-                if (bytes_received > 0) {
-                    // Null-terminate received data
-                    buffer[bytes_received] = '\0';
-                    
-                    // Process the detection data
-                    process_detection_data(buffer);
-                    
-                } else if (bytes_received == 0) {
-                    // Connection closed by detection thread
-                    printf("Detection thread closed connection, reconnecting...\n");
-                    cleanup_comm_context(&ctx);
-                    usleep(RECONNECT_DELAY_US);
-                    
-                } else {
-                    // Error occurred
-                    fprintf(stderr, "Error receiving data: %s\n", strerror(errno));
-                    cleanup_comm_context(&ctx);
-                    usleep(RECONNECT_DELAY_US);
+        for (int i = 0; i < count; i++) {
+            int fd = events[i].data.fd;
+            if (fd == ctx.socket_fd && ctx.connected) {
+                // Data, hangup or error: receive first so the last messages before a close are not lost
+                if (receive_messages(&ctx) != 0) {
+                    close_connection(&ctx);
+                    try_connect(&ctx);
+                }
+            } else if (fd == ctx.timer_fd) {
+                uint64_t expirations;
+                if (read(ctx.timer_fd, &expirations, sizeof(expirations)) > 0 && !ctx.connected) {
+                    try_connect(&ctx);
                 }
+            } else if (fd == ctx.inotify_fd) {
+                handle_inotify_events(&ctx);
             }
         }
     }
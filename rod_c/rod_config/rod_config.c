@@ -10,6 +10,7 @@
 /* ******************************************************* Includes ****************************************************** */
 
 #include "rod_config.h"
+#include "rod_runtime_config.h"
 #include <time.h>
 #include <sys/time.h>
 #include <sys/stat.h>
@@ -17,6 +18,10 @@
 #include <string.h>
 #include <stdio.h>
 
+/* ***************************************************** Public macros *************************************************** */
+
+#define ARUCO_DICTIONARY_SIZE 50  // Entries of DICT_4X4_50
+
 /* ******************************************* Public callback functions declarations ************************************ */
 
 /* ********************************************* Function implementations *********************************************** */
@@ -67,42 +72,50 @@ float rod_config_get_marker_size(int id) {
 }
 
 void rod_config_configure_detector_parameters(DetectorParametersHandle* params) {
-    // Adaptive thresholding parameters
-    // These values are CRITICAL - validated through extensive testing
-    setAdaptiveThreshWinSizeMin(params, 3);
-    setAdaptiveThreshWinSizeMax(params, 53);
-    setAdaptiveThreshWinSizeStep(params, 4);
-    
-    // Marker size constraints
-    setMinMarkerPerimeterRate(params, 0.01);
-    setMaxMarkerPerimeterRate(params, 4.0);
-    
-    // Polygon approximation accuracy
-    setPolygonalApproxAccuracyRate(params, 0.05);
-    
-    // Corner refinement for sub-pixel accuracy
-    setCornerRefinementMethod(params, CORNER_REFINE_SUBPIX);
-    setCornerRefinementWinSize(params, 5);
-    setCornerRefinementMaxIterations(params, 50);
-    
-    // Detection constraints
-    setMinDistanceToBorder(params, 0);
-    setMinOtsuStdDev(params, 2.0);
-    
-    // Perspective removal
-    setPerspectiveRemoveIgnoredMarginPerCell(params, 0.15);
+    // Built-in values, kept in one place with the runtime reloadable ones
+    RodRuntimeConfig config;
+    rod_runtime_config_set_defaults(&config);
+    rod_runtime_config_apply_detector(&config, params);
 }
 
 int rod_config_get_aruco_dictionary_type(void) {
     return DICT_4X4_50;
 }
 
+int rod_config_get_valid_marker_ids(int* ids, int max_ids) {
+    int count = 0;
+    for (int id = 0; id < ARUCO_DICTIONARY_SIZE && count < max_ids; id++) {
+        if (rod_config_is_valid_marker_id(id)) {
+            ids[count++] = id;
+        }
+    }
+    return count;
+}
+
+ArucoDictionaryHandle* rod_config_create_aruco_dictionary(void) {
+    if (!ROD_RESTRICTED_DICTIONARY) {
+        return getPredefinedDictionary(rod_config_get_aruco_dictionary_type());
+    }
+    
+    int ids[ARUCO_DICTIONARY_SIZE];
+    int count = rod_config_get_valid_marker_ids(ids, ARUCO_DICTIONARY_SIZE);
+    return createRestrictedDictionary(rod_config_get_aruco_dictionary_type(), ids, count);
+}
+
+// Sensor area seen by the main stream (full resolution pixels)
+#define FIELD_OF_VIEW_X (ROD_CAMERA_CROP_WIDTH > 0 ? ROD_CAMERA_CROP_X : 0)
+#define FIELD_OF_VIEW_Y (ROD_CAMERA_CROP_HEIGHT > 0 ? ROD_CAMERA_CROP_Y : 0)
+#define FIELD_OF_VIEW_WIDTH (ROD_CAMERA_CROP_WIDTH > 0 ? ROD_CAMERA_CROP_WIDTH : ROD_CALIBRATION_WIDTH)
+#define FIELD_OF_VIEW_HEIGHT (ROD_CAMERA_CROP_HEIGHT > 0 ? ROD_CAMERA_CROP_HEIGHT : ROD_CALIBRATION_HEIGHT)
+#define SCALE_X ((double)ROD_CAMERA_WIDTH / FIELD_OF_VIEW_WIDTH)
+#define SCALE_Y ((double)ROD_CAMERA_HEIGHT / FIELD_OF_VIEW_HEIGHT)
+
 const float* rod_config_get_camera_matrix(void) {
-    // Camera calibration matrix from fisheye calibration
+    // Camera calibration matrix from fisheye calibration (full resolution)
     // Matches values from Python implementation (rod_python/lab/8 detect aruco tags...)
     static const float camera_matrix[9] = {
-        2493.62477, 0.0, 1977.18701,
-        0.0, 2493.11358, 2034.91176,
+        2493.62477 * SCALE_X, 0.0, (1977.18701 - FIELD_OF_VIEW_X) * SCALE_X,
+        0.0, 2493.11358 * SCALE_Y, (2034.91176 - FIELD_OF_VIEW_Y) * SCALE_Y,
         0.0, 0.0, 1.0
     };
     return camera_matrix;
@@ -22,12 +22,134 @@
 
 // Socket configuration
 #define ROD_SOCKET_PATH "/tmp/rod_detection.sock"
-#define ROD_MAX_DETECTION_SIZE 1024
+#define ROD_SHM_ENABLED 1                 // Also publish every frame in a shared memory ring (rod_shm.h)
+#define ROD_SHM_NAME "/rod_detections"    // POSIX shared memory object name
+#define ROD_SOCKET_TEXT_PROTOCOL 0         // 1 = legacy text lines [[id,x,y,angle],...], 0 = binary messages (rod_protocol.h)
+
+// Runtime configuration (detector, camera controls, save interval, pipeline mode; see rod_runtime_config.h)
+#define ROD_RUNTIME_CONFIG_FILE "/opt/roboteseo/ROD/rod_c/rod_detection.conf"  // Reloaded on SIGHUP
 
 // Debug configuration
 #define ROD_PICTURES_BASE_FOLDER "/var/roboteseo/pictures/camera"
 #define ROD_DEBUG_BASE_FOLDER "/var/roboteseo/pictures/debug"
-#define ROD_SAVE_DEBUG_IMAGE_INTERVAL 1  // Save every N frames
+#define ROD_SAVE_DEBUG_IMAGE_INTERVAL 1  // Save every N frames (default of save_debug_image_interval)
+#define ROD_DEBUG_PREVIEW_WIDTH 1014     // Annotated debug image width, downscaled from the raw image (0 = raw size)
+#define ROD_DEBUG_JPEG_QUALITY 75         // JPEG quality of the annotated debug image (raw images keep 95)
+#define ROD_WRITER_QUEUE_DEPTH 4          // Images waiting to be written (2 per saved frame)
+#define ROD_WRITER_DROP_POLICY ROD_WRITER_DROP_NEWEST  // See RodWriterDropPolicy (rod_writer.h)
+#define ROD_SESSION_RECORD_INTERVAL 1     // Frames recorded by --record: every N frames (raw, see rod_session.h)
+
+// Live stream configuration (annotated preview over HTTP, see rod_stream.h)
+#define ROD_STREAM_ENABLED 1
+#define ROD_STREAM_PORT 5000                       // http://<rod>:5000/ (same as tools/stream.py)
+#define ROD_STREAM_MAX_FPS 10                      // Frames tapped off the pipeline per second, at most
+#define ROD_STREAM_WIDTH 640                       // Stream image width (height follows the frame aspect ratio)
+#define ROD_STREAM_JPEG_QUALITY 60
+#define ROD_STREAM_ENCODER_DEVICE "/dev/video31"   // V4L2 M2M JPEG encoder (Raspberry Pi), software if missing
+
+// Detection pipeline configuration
+#define ROD_PIPELINE_SLOTS 6              // Frame slots in flight (capture -> publish)
+#define ROD_PIPELINE_QUEUE_DEPTH 1        // Frames waiting in front of each stage (oldest dropped when full)
+
+// Real-time mode of the pipelined stages (--realtime, see rod_realtime.h)
+// CPU masks: bit n = CPU n, 0 = not pinned. CPU 0 is left to the system (logging, SSH, interrupts),
+// preprocess and detect share CPUs 2-3 with the OpenCV workers they start.
+#define ROD_REALTIME_ENABLED 0                    // 1 = always on, otherwise only with --realtime
+#define ROD_REALTIME_CPUS_CAPTURE 0x2
+#define ROD_REALTIME_CPUS_PREPROCESS 0xC
+#define ROD_REALTIME_CPUS_DETECT 0xC
+#define ROD_REALTIME_CPUS_PUBLISH 0x2
+#define ROD_REALTIME_PRIORITY_CAPTURE 50          // SCHED_FIFO priority (1-99, 0 = stay SCHED_OTHER)
+#define ROD_REALTIME_PRIORITY_PREPROCESS 40
+#define ROD_REALTIME_PRIORITY_DETECT 40
+#define ROD_REALTIME_PRIORITY_PUBLISH 60          // Shortest stage, never waits behind a detection
+#define ROD_REALTIME_HEAP_PREFAULT (64u << 20)    // Heap touched before mlockall (frame copies, previews)
+#define ROD_REALTIME_STACK_PREFAULT (256u << 10)  // Stack touched by each stage thread
+
+// Instrumentation (per-stage latency histograms, see rod_metrics.h)
+#define ROD_METRICS_FILE "/tmp/rod_metrics.txt"  // Text report: counters, p50/p99/max per stage
+#define ROD_METRICS_DUMP_INTERVAL_MS 1000 // Report refresh period (0 = only at shutdown)
+#define ROD_LOG_FRAME_SUMMARY 0           // 1 = print detection and timing summary of every frame (slow on journald)
+
+// ROI tracking configuration (detect only around last known markers)
+#define ROD_ROI_TRACKING_ENABLED 1        // 0 = full-frame detection on every frame
+#define ROD_ROI_FULL_SCAN_INTERVAL 15     // Full-frame scan every N frames (finds new markers)
+#define ROD_ROI_PADDING_RATIO 0.75f       // Region padding relative to marker size
+
+// Motion-gated detection (static field: frames skipped or searched around known markers only, see rod_motion_gate.h)
+#define ROD_MOTION_GATE_ENABLED 1         // 0 = every frame detected
+#define ROD_MOTION_GATE_GRID_COLS 32      // Field thumbnail cells (about 90 x 80 px each at full resolution)
+#define ROD_MOTION_GATE_GRID_ROWS 24
+#define ROD_MOTION_GATE_CELL_THRESHOLD 6  // Mean luma change (0-255) of a changed cell
+#define ROD_MOTION_GATE_MIN_CELLS 2       // Changed cells for the field to count as moving
+#define ROD_MOTION_GATE_SETTLE_FRAMES 5   // Frames still detected once the field stopped moving
+#define ROD_MOTION_GATE_ROI_INTERVAL 3    // Static field: regions-only detection every N frames, others carried over
+#define ROD_MOTION_GATE_FULL_INTERVAL_MS 500  // Static field: full-frame detection at least this often
+
+// Pyramid detection configuration (coarse candidates, full resolution corner refinement)
+#define ROD_DETECTION_PYRAMID_SCALE 1.0f  // Coarse level scale (1.0 = disabled, e.g. 0.5f = half resolution)
+
+// Tiled detection configuration (full-frame scans split across cores)
+#define ROD_DETECTION_TILES_X 2           // Tile columns (1 x 1 = single call detection)
+#define ROD_DETECTION_TILES_Y 2           // Tile rows
+#define ROD_DETECTION_TILE_MARGIN 1.5f    // Overlap safety factor on the ground plane marker extent (robot tops, fisheye)
+
+// Camera sensor configuration (speed vs resolution, see camera_interface_list_sensor_modes())
+#define ROD_CAMERA_WIDTH 4056             // Main stream size (the calibration is scaled to it)
+#define ROD_CAMERA_HEIGHT 3040
+#define ROD_CAMERA_SENSOR_MODE_WIDTH 0    // Forced readout, e.g. 2028x1520 (2x2 binned, 40 fps), 0 = chosen from the stream size
+#define ROD_CAMERA_SENSOR_MODE_HEIGHT 0
+#define ROD_CAMERA_SENSOR_MODE_BIT_DEPTH 12
+#define ROD_CAMERA_FRAME_DURATION_US -1   // Fixed frame duration (e.g. 25000 = 40 fps), -1 = sensor mode limits
+#define ROD_CAMERA_CROP_X 0               // ScalerCrop in full resolution sensor pixels (e.g. field bounding box)
+#define ROD_CAMERA_CROP_Y 0
+#define ROD_CAMERA_CROP_WIDTH 0           // 0 = full field of view
+#define ROD_CAMERA_CROP_HEIGHT 0
+#define ROD_CALIBRATION_WIDTH 4056        // Sensor resolution of the calibration below
+#define ROD_CALIBRATION_HEIGHT 3040
+
+// Replay benchmark (rod_bench)
+#define ROD_BENCH_FRAMES 300              // Frames published per run
+#define ROD_BENCH_OUTPUT_FILE "/tmp/rod_bench.txt"  // Result file ("key value" lines, usable as a baseline)
+#define ROD_BENCH_TOLERANCE 0.10          // Allowed degradation against the baseline (10%)
+
+// Emulated camera replay configuration
+#define ROD_EMULATED_PREFETCH_DEPTH 4     // Frames decoded ahead by a background thread (0 = decode in acquire)
+#define ROD_EMULATED_PRELOAD 0            // 1 = decode the whole folder at start (benchmarks, ~14 MB per frame)
+
+// Camera stream configuration
+#define ROD_CAMERA_FORMAT CAMERA_FORMAT_YUV420  // See CameraPixelFormat (camera_frame.h), YUV420 = Y plane to the detector
+#define ROD_CAMERA_PREVIEW_WIDTH 1014     // Low resolution color stream for debug images (0 = none)
+#define ROD_CAMERA_PREVIEW_HEIGHT 760
+#define ROD_CAMERA_BUFFER_COUNT 4         // Frames held by capture + preprocess, plus one being exposed (still capture default: 1)
+#define ROD_CAMERA_NEWEST_FRAME_ONLY 1    // 1 = skip frames completed while the pipeline was busy (lowest latency)
+
+// Preprocessing configuration
+#define ROD_PREPROCESS_FUSED 1            // 1 = single-pass sharpen + mask + gray, 0 = separate BGR passes
+#define ROD_CROP_TO_FIELD 1               // 1 = preprocess and detect on the field bounding box only, 0 = whole frame
+
+// Localization configuration (precomputed undistort + homography grid)
+#define ROD_LOCALIZATION_GRID_ENABLED 1   // 1 = bilinear lookup in a grid rebuilt on homography change, 0 = exact per frame
+#define ROD_LOCALIZATION_GRID_CELL 16     // Grid node spacing in pixels
+
+// Background recalibration (fixed tags 20-23 tracked after the first field mask, see rod_recalibration.h)
+#define ROD_RECALIBRATION_ENABLED 1       // 1 = rebuild homography and mask off the hot path when the camera moved
+#define ROD_RECALIBRATION_DRIFT_MM 10.0f  // Field corner error of the current homography that triggers it
+
+// Temporal marker filter (alpha-beta per marker, see rod_marker_filter.h)
+#define ROD_MARKER_FILTER_ENABLED 1          // 1 = send filtered positions (with age_us), 0 = raw per frame positions
+#define ROD_MARKER_FILTER_ALPHA 0.5f         // Position gain (1 = raw measurement)
+#define ROD_MARKER_FILTER_BETA 0.17f         // Velocity gain (alpha^2 / (2 - alpha))
+#define ROD_MARKER_FILTER_GATE_MM 150.0f     // Farther measurements start a new track instead of moving this one
+#define ROD_MARKER_FILTER_CONFIRM_HITS 2     // Frames a new track needs before being sent
+#define ROD_MARKER_FILTER_MAX_AGE_MS 300     // Lost markers are predicted for this long, then dropped
+#define ROD_MARKER_FILTER_VELOCITY_DECAY 0.8f  // Velocity kept per missed frame
+
+// Detector profile (see rod_autotune to measure cheaper threshold windows on recorded frames)
+#define ROD_RESTRICTED_DICTIONARY 1       // 1 = dictionary holding only the valid Eurobot IDs, 0 = full DICT_4X4_50
+#define ROD_ADAPTIVE_THRESH_WIN_SIZE_MIN 3   // Python lab values: 13 threshold passes per frame (runtime defaults)
+#define ROD_ADAPTIVE_THRESH_WIN_SIZE_MAX 53
+#define ROD_ADAPTIVE_THRESH_WIN_SIZE_STEP 4
 
 // Camera test configuration
 #define ROD_CAMERA_TESTS_OUTPUT_FOLDER "/var/roboteseo/pictures/camera_tests"
@@ -103,10 +225,32 @@ void rod_config_configure_detector_parameters(DetectorParametersHandle* params);
  */
 int rod_config_get_aruco_dictionary_type(void);
 
+/**
+ * @brief List the valid marker IDs of the dictionary
+ * @param ids Output array
+ * @param max_ids Capacity of ids
+ * @return Number of IDs written (see rod_config_is_valid_marker_id)
+ */
+int rod_config_get_valid_marker_ids(int* ids, int max_ids);
+
+/**
+ * @brief Create the ArUco dictionary used for detection
+ * @return Dictionary handle (release with releaseArucoDictionary), or NULL on failure
+ * 
+ * With ROD_RESTRICTED_DICTIONARY, the dictionary only holds the valid
+ * Eurobot IDs: fewer codes to match per candidate and markers outside the
+ * rules are never reported. Detected IDs are the DICT_4X4_50 ones either way.
+ */
+ArucoDictionaryHandle* rod_config_create_aruco_dictionary(void);
+
 /**
  * @brief Get the camera calibration matrix (3x3) for fisheye lens
  * @return Pointer to 3x3 camera matrix (row-major order)
  * 
+ * The full resolution calibration is mapped to the main stream: crop to
+ * ROD_CAMERA_CROP_* then scale to ROD_CAMERA_WIDTH x ROD_CAMERA_HEIGHT
+ * (binning keeps the field of view, so only the crop and the size matter).
+ * 
  * Camera matrix K from fisheye calibration:
  * [fx  0  cx]
  * [0  fy  cy]
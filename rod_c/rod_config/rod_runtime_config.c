@@ -0,0 +1,290 @@
+/**
+ * @file rod_runtime_config.c
+ * @brief Settings reloadable while rod_detection runs (key = value file)
+ * @author Noé Game
+ * @date 14/10/2026
+ * @see rod_runtime_config.h
+ * @copyright Cecill-C (Cf. LICENCE.txt)
+ */
+
+/* ******************************************************* Includes ****************************************************** */
+
+#include "rod_runtime_config.h"
+#include "rod_config.h"
+#include <ctype.h>
+#include <errno.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* ***************************************************** Public macros *************************************************** */
+
+/* ************************************************** Public types definition ******************************************** */
+
+typedef enum {
+    SETTING_INT,
+    SETTING_FLOAT,
+    SETTING_DOUBLE,
+    SETTING_PIPELINE_MODE  // "pipelined" or "sequential" (bool)
+} SettingType;
+
+/**
+ * @brief One key of the file: where it is stored and its accepted range
+ */
+typedef struct {
+    const char* key;
+    SettingType type;
+    size_t offset;  // In RodRuntimeConfig
+    double min;
+    double max;
+} Setting;
+
+#define DETECTOR_SETTING(name, type, min, max) \
+    { #name, type, offsetof(RodRuntimeConfig, detector.name), min, max }
+#define CAMERA_SETTING(name, type, min, max) \
+    { "camera_" #name, type, offsetof(RodRuntimeConfig, camera.name), min, max }
+
+static const Setting SETTINGS[] = {
+    DETECTOR_SETTING(adaptive_thresh_win_size_min, SETTING_INT, 3, 255),
+    DETECTOR_SETTING(adaptive_thresh_win_size_max, SETTING_INT, 3, 255),
+    DETECTOR_SETTING(adaptive_thresh_win_size_step, SETTING_INT, 1, 255),
+    DETECTOR_SETTING(min_marker_perimeter_rate, SETTING_DOUBLE, 0.0, 4.0),
+    DETECTOR_SETTING(max_marker_perimeter_rate, SETTING_DOUBLE, 0.0, 8.0),
+    DETECTOR_SETTING(polygonal_approx_accuracy_rate, SETTING_DOUBLE, 0.0, 1.0),
+    DETECTOR_SETTING(corner_refinement_method, SETTING_INT, CORNER_REFINE_NONE, CORNER_REFINE_APRILTAG),
+    DETECTOR_SETTING(corner_refinement_win_size, SETTING_INT, 1, 64),
+    DETECTOR_SETTING(corner_refinement_max_iterations, SETTING_INT, 1, 1000),
+    DETECTOR_SETTING(min_distance_to_border, SETTING_INT, 0, 1000),
+    DETECTOR_SETTING(min_otsu_std_dev, SETTING_DOUBLE, 0.0, 255.0),
+    DETECTOR_SETTING(perspective_remove_ignored_margin_per_cell, SETTING_DOUBLE, 0.0, 0.5),
+    CAMERA_SETTING(exposure_time, SETTING_INT, -1, 10000000),
+    CAMERA_SETTING(analogue_gain, SETTING_FLOAT, -1.0, 22.26),
+    CAMERA_SETTING(brightness, SETTING_FLOAT, -1.0, 1.0),
+    CAMERA_SETTING(contrast, SETTING_FLOAT, -1.0, 32.0),
+    CAMERA_SETTING(saturation, SETTING_FLOAT, -1.0, 32.0),
+    CAMERA_SETTING(sharpness, SETTING_FLOAT, -1.0, 16.0),
+    CAMERA_SETTING(awb_enable, SETTING_INT, -1, 1),
+    CAMERA_SETTING(aec_enable, SETTING_INT, -1, 1),
+    CAMERA_SETTING(noise_reduction_mode, SETTING_INT, -1, 4),
+    { "save_debug_image_interval", SETTING_INT, offsetof(RodRuntimeConfig, save_debug_image_interval), 1, 1000000 },
+    { "pipeline_mode", SETTING_PIPELINE_MODE, offsetof(RodRuntimeConfig, sequential), 0, 1 },
+};
+
+#define SETTING_COUNT (sizeof(SETTINGS) / sizeof(SETTINGS[0]))
+
+/* ******************************************* Public callback functions declarations ************************************ */
+
+/* ********************************************* Function implementations *********************************************** */
+
+void rod_runtime_config_set_defaults(RodRuntimeConfig* config) {
+    if (!config) return;
+    memset(config, 0, sizeof(RodRuntimeConfig));
+
+    // Detector: Python lab values, validated through extensive testing
+    RodDetectorSettings* detector = &config->detector;
+    detector->adaptive_thresh_win_size_min = ROD_ADAPTIVE_THRESH_WIN_SIZE_MIN;
+    detector->adaptive_thresh_win_size_max = ROD_ADAPTIVE_THRESH_WIN_SIZE_MAX;
+    detector->adaptive_thresh_win_size_step = ROD_ADAPTIVE_THRESH_WIN_SIZE_STEP;
+    detector->min_marker_perimeter_rate = 0.01;
+    detector->max_marker_perimeter_rate = 4.0;
+    detector->polygonal_approx_accuracy_rate = 0.05;
+    detector->corner_refinement_method = CORNER_REFINE_SUBPIX;
+    detector->corner_refinement_win_size = 5;
+    detector->corner_refinement_max_iterations = 50;
+    detector->min_distance_to_border = 0;
+    detector->min_otsu_std_dev = 2.0;
+    detector->perspective_remove_ignored_margin_per_cell = 0.15;
+
+    // Camera: "match" parameters from test_camera_parameters.c, ArUco optimized for full resolution
+    RodCameraControls* camera = &config->camera;
+    camera->exposure_time = -1;         // Let AE decide (auto-exposure)
+    camera->analogue_gain = -1.0f;      // Let AE decide (auto-exposure)
+    camera->brightness = 0.0f;          // Default brightness
+    camera->contrast = 1.5f;            // Slight contrast boost for black/white markers
+    camera->saturation = -1.0f;         // Default saturation (auto)
+    camera->sharpness = 4.0f;           // Moderate sharpness boost for ArUco detection
+    camera->awb_enable = 1;             // Auto white balance enabled
+    camera->aec_enable = 1;             // Auto-exposure enabled for adaptability
+    camera->noise_reduction_mode = 2;   // HighQuality
+
+    config->save_debug_image_interval = ROD_SAVE_DEBUG_IMAGE_INTERVAL;
+    config->sequential = false;
+}
+
+static char* trim(char* text) {
+    while (isspace((unsigned char)*text)) text++;
+    char* end = text + strlen(text);
+    while (end > text && isspace((unsigned char)end[-1])) end--;
+    *end = '\0';
+    return text;
+}
+
+static const Setting* find_setting(const char* key) {
+    for (size_t i = 0; i < SETTING_COUNT; i++) {
+        if (strcmp(SETTINGS[i].key, key) == 0) return &SETTINGS[i];
+    }
+    return NULL;
+}
+
+/**
+ * @brief Parse a value and store it in the configuration
+ * @return 0 on success, -1 if the value is not a number of the setting range
+ */
+static int store_setting(const Setting* setting, const char* value, RodRuntimeConfig* config) {
+    char* field = (char*)config + setting->offset;
+
+    if (setting->type == SETTING_PIPELINE_MODE) {
+        if (strcmp(value, "sequential") == 0) {
+            *(bool*)field = true;
+        } else if (strcmp(value, "pipelined") == 0) {
+            *(bool*)field = false;
+        } else {
+            return -1;
+        }
+        return 0;
+    }
+
+    char* end = NULL;
+    errno = 0;
+    double number = strtod(value, &end);
+    if (end == value || *end != '\0' || errno != 0) return -1;
+    if (number < setting->min || number > setting->max) return -1;
+
+    switch (setting->type) {
+        case SETTING_INT:
+            if (number != (double)(int)number) return -1;
+            *(int*)field = (int)number;
+            break;
+        case SETTING_FLOAT:
+            *(float*)field = (float)number;
+            break;
+        default:
+            *(double*)field = number;
+            break;
+    }
+    return 0;
+}
+
+int rod_runtime_config_load(const char* path, const RodRuntimeConfig* base, RodRuntimeConfig* config) {
+    if (!path || !base || !config) return -1;
+
+    FILE* file = fopen(path, "r");
+    if (!file) {
+        fprintf(stderr, "rod_runtime_config: Cannot open %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+
+    // Parsed into a copy: the output is only written once the whole file is valid
+    RodRuntimeConfig parsed = *base;
+    char line[ROD_RUNTIME_CONFIG_MAX_LINE];
+    int line_number = 0;
+    int result = 0;
+    while (result == 0 && fgets(line, sizeof(line), file)) {
+        line_number++;
+        if (!strchr(line, '\n') && !feof(file)) {
+            fprintf(stderr, "rod_runtime_config: %s:%d: Line too long\n", path, line_number);
+            result = -1;
+            break;
+        }
+
+        char* comment = strchr(line, '#');
+        if (comment) *comment = '\0';
+        char* text = trim(line);
+        if (*text == '\0') continue;
+
+        char* equal = strchr(text, '=');
+        if (!equal) {
+            fprintf(stderr, "rod_runtime_config: %s:%d: Expected key = value\n", path, line_number);
+            result = -1;
+            break;
+        }
+        *equal = '\0';
+        char* key = trim(text);
+        char* value = trim(equal + 1);
+
+        const Setting* setting = find_setting(key);
+        if (!setting) {
+            fprintf(stderr, "rod_runtime_config: %s:%d: Unknown key '%s'\n", path, line_number, key);
+            result = -1;
+        } else if (store_setting(setting, value, &parsed) != 0) {
+            fprintf(stderr, "rod_runtime_config: %s:%d: Invalid value '%s' for %s\n", path, line_number, value, key);
+            result = -1;
+        }
+    }
+    fclose(file);
+
+    if (result == 0 && parsed.detector.adaptive_thresh_win_size_min > parsed.detector.adaptive_thresh_win_size_max) {
+        fprintf(stderr, "rod_runtime_config: %s: adaptive_thresh_win_size_min is above the max\n", path);
+        result = -1;
+    }
+    if (result == 0 && parsed.detector.min_marker_perimeter_rate > parsed.detector.max_marker_perimeter_rate) {
+        fprintf(stderr, "rod_runtime_config: %s: min_marker_perimeter_rate is above the max\n", path);
+        result = -1;
+    }
+
+    if (result == 0) {
+        *config = parsed;
+    }
+    return result;
+}
+
+void rod_runtime_config_apply_detector(const RodRuntimeConfig* config, DetectorParametersHandle* params) {
+    if (!config || !params) return;
+    const RodDetectorSettings* detector = &config->detector;
+
+    // Adaptive thresholding parameters
+    setAdaptiveThreshWinSizeMin(params, detector->adaptive_thresh_win_size_min);
+    setAdaptiveThreshWinSizeMax(params, detector->adaptive_thresh_win_size_max);
+    setAdaptiveThreshWinSizeStep(params, detector->adaptive_thresh_win_size_step);
+
+    // Marker size constraints
+    setMinMarkerPerimeterRate(params, detector->min_marker_perimeter_rate);
+    setMaxMarkerPerimeterRate(params, detector->max_marker_perimeter_rate);
+
+    // Polygon approximation accuracy
+    setPolygonalApproxAccuracyRate(params, detector->polygonal_approx_accuracy_rate);
+
+    // Corner refinement for sub-pixel accuracy
+    setCornerRefinementMethod(params, detector->corner_refinement_method);
+    setCornerRefinementWinSize(params, detector->corner_refinement_win_size);
+    setCornerRefinementMaxIterations(params, detector->corner_refinement_max_iterations);
+
+    // Detection constraints
+    setMinDistanceToBorder(params, detector->min_distance_to_border);
+    setMinOtsuStdDev(params, detector->min_otsu_std_dev);
+
+    // Perspective removal
+    setPerspectiveRemoveIgnoredMarginPerCell(params, detector->perspective_remove_ignored_margin_per_cell);
+}
+
+bool rod_runtime_config_same_detector(const RodRuntimeConfig* a, const RodRuntimeConfig* b) {
+    const RodDetectorSettings* x = &a->detector;
+    const RodDetectorSettings* y = &b->detector;
+    return x->adaptive_thresh_win_size_min == y->adaptive_thresh_win_size_min &&
+           x->adaptive_thresh_win_size_max == y->adaptive_thresh_win_size_max &&
+           x->adaptive_thresh_win_size_step == y->adaptive_thresh_win_size_step &&
+           x->min_marker_perimeter_rate == y->min_marker_perimeter_rate &&
+           x->max_marker_perimeter_rate == y->max_marker_perimeter_rate &&
+           x->polygonal_approx_accuracy_rate == y->polygonal_approx_accuracy_rate &&
+           x->corner_refinement_method == y->corner_refinement_method &&
+           x->corner_refinement_win_size == y->corner_refinement_win_size &&
+           x->corner_refinement_max_iterations == y->corner_refinement_max_iterations &&
+           x->min_distance_to_border == y->min_distance_to_border &&
+           x->min_otsu_std_dev == y->min_otsu_std_dev &&
+           x->perspective_remove_ignored_margin_per_cell == y->perspective_remove_ignored_margin_per_cell;
+}
+
+bool rod_runtime_config_same_camera(const RodRuntimeConfig* a, const RodRuntimeConfig* b) {
+    const RodCameraControls* x = &a->camera;
+    const RodCameraControls* y = &b->camera;
+    return x->exposure_time == y->exposure_time &&
+           x->analogue_gain == y->analogue_gain &&
+           x->brightness == y->brightness &&
+           x->contrast == y->contrast &&
+           x->saturation == y->saturation &&
+           x->sharpness == y->sharpness &&
+           x->awb_enable == y->awb_enable &&
+           x->aec_enable == y->aec_enable &&
+           x->noise_reduction_mode == y->noise_reduction_mode;
+}
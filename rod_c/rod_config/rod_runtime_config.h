@@ -0,0 +1,114 @@
+/**
+ * @file rod_runtime_config.h
+ * @brief Settings reloadable while rod_detection runs (key = value file)
+ * @author Noé Game
+ * @date 14/10/2026
+ * @see rod_runtime_config.c
+ * @copyright Cecill-C (Cf. LICENCE.txt)
+ *
+ * The detector parameters, camera controls, debug save interval and pipeline
+ * mode are read from a text file (ROD_RUNTIME_CONFIG_FILE) at startup and
+ * again on SIGHUP (systemctl reload rod-detection), so they can be tuned on
+ * the field without a rebuild or a camera restart.
+ *
+ * File format, one setting per line (see rod_detection.conf):
+ *     # comment
+ *     adaptive_thresh_win_size_max = 23
+ *     pipeline_mode = sequential
+ *
+ * Keys missing from the file keep their built-in default. A file holding an
+ * unknown key or an invalid value is rejected as a whole, so a typo never
+ * leaves half of a new configuration in force.
+ */
+
+#pragma once
+
+/* ******************************************************* Includes ****************************************************** */
+
+#include "opencv_wrapper.h"
+#include <stdbool.h>
+
+/* ***************************************************** Public macros *************************************************** */
+
+#define ROD_RUNTIME_CONFIG_MAX_LINE 256  // Longer lines are rejected
+
+/* ************************************************** Public types definition ******************************************** */
+
+/**
+ * @brief ArUco detector parameters (applied by rod_runtime_config_apply_detector())
+ */
+typedef struct {
+    int adaptive_thresh_win_size_min;
+    int adaptive_thresh_win_size_max;
+    int adaptive_thresh_win_size_step;
+    double min_marker_perimeter_rate;
+    double max_marker_perimeter_rate;
+    double polygonal_approx_accuracy_rate;
+    int corner_refinement_method;       // CORNER_REFINE_*
+    int corner_refinement_win_size;
+    int corner_refinement_max_iterations;
+    int min_distance_to_border;
+    double min_otsu_std_dev;
+    double perspective_remove_ignored_margin_per_cell;
+} RodDetectorSettings;
+
+/**
+ * @brief Camera controls (same meaning as RodCameraParameters, -1 = auto / default)
+ */
+typedef struct {
+    int exposure_time;         // Microseconds
+    float analogue_gain;
+    float brightness;
+    float contrast;
+    float saturation;
+    float sharpness;
+    int awb_enable;
+    int aec_enable;
+    int noise_reduction_mode;  // 0-4
+} RodCameraControls;
+
+/**
+ * @brief Settings reloadable at runtime
+ */
+typedef struct {
+    RodDetectorSettings detector;
+    RodCameraControls camera;
+    int save_debug_image_interval;  // Save raw and debug images every N frames
+    bool sequential;                // Pipeline mode: true = one thread, false = one thread per stage
+} RodRuntimeConfig;
+
+/* *********************************************** Public functions declarations ***************************************** */
+
+/**
+ * @brief Fill a configuration with the built-in defaults (rod_config.h values)
+ * @param config Output configuration
+ */
+void rod_runtime_config_set_defaults(RodRuntimeConfig* config);
+
+/**
+ * @brief Read a configuration file on top of a base configuration
+ * @param path File path
+ * @param base Values of the keys missing from the file (usually the defaults)
+ * @param config Output configuration, only written on success (may be base)
+ * @return 0 on success, -1 if the file cannot be read or holds an invalid line (config unchanged)
+ */
+int rod_runtime_config_load(const char* path, const RodRuntimeConfig* base, RodRuntimeConfig* config);
+
+/**
+ * @brief Set detector parameters from the detector settings
+ * @param config Configuration
+ * @param params Detector parameters to configure
+ */
+void rod_runtime_config_apply_detector(const RodRuntimeConfig* config, DetectorParametersHandle* params);
+
+/**
+ * @brief Compare the detector settings of two configurations
+ * @return true if a detector built from a matches b
+ */
+bool rod_runtime_config_same_detector(const RodRuntimeConfig* a, const RodRuntimeConfig* b);
+
+/**
+ * @brief Compare the camera controls of two configurations
+ * @return true if the camera needs no update to go from a to b
+ */
+bool rod_runtime_config_same_camera(const RodRuntimeConfig* a, const RodRuntimeConfig* b);
@@ -3,6 +3,12 @@
 #include "opencv_wrapper.h"
 #include <cstring>   // For strlen
 #include <cstdio>    // For fprintf
+#include <vector>
+#include <mutex>
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
 
 extern "C" {
 
@@ -61,6 +67,49 @@ ImageHandle* create_image_from_buffer(uint8_t* data, int width, int height, int
     return reinterpret_cast<ImageHandle*>(image);
 }
 
+ImageHandle* create_image_view_from_buffer(uint8_t* data, int width, int height, int channels, size_t stride) {
+    if (data == nullptr || width <= 0 || height <= 0 || channels <= 0) {
+        return nullptr;
+    }
+    
+    int cv_type;
+    if (channels == 1) {
+        cv_type = CV_8UC1;
+    } else if (channels == 3) {
+        cv_type = CV_8UC3;
+    } else if (channels == 4) {
+        cv_type = CV_8UC4;
+    } else {
+        return nullptr;
+    }
+    
+    if (stride == 0) {
+        stride = static_cast<size_t>(width) * channels;
+    } else if (stride < static_cast<size_t>(width) * channels) {
+        return nullptr;
+    }
+    
+    // Non-owning Mat header over the external buffer (no copy, no free on release)
+    cv::Mat* image = new cv::Mat(height, width, cv_type, data, stride);
+    return reinterpret_cast<ImageHandle*>(image);
+}
+
+ImageHandle* clone_image(ImageHandle* handle) {
+    if (handle == nullptr) return nullptr;
+    
+    cv::Mat* image = reinterpret_cast<cv::Mat*>(handle);
+    cv::Mat* copy = new cv::Mat(image->clone());
+    return reinterpret_cast<ImageHandle*>(copy);
+}
+
+ImageHandle* share_image(ImageHandle* handle) {
+    if (handle == nullptr) return nullptr;
+    
+    cv::Mat* image = reinterpret_cast<cv::Mat*>(handle);
+    cv::Mat* shared = new cv::Mat(*image);  // Header copy, data refcount incremented
+    return reinterpret_cast<ImageHandle*>(shared);
+}
+
 void release_image(ImageHandle* handle) {
     if (handle != nullptr) {
         cv::Mat* image = reinterpret_cast<cv::Mat*>(handle);
@@ -122,7 +171,22 @@ ImageHandle* convert_to_grayscale(ImageHandle* handle) {
     return reinterpret_cast<ImageHandle*>(gray);
 }
 
+ImageHandle* convert_gray_to_bgr(ImageHandle* handle) {
+    if (handle == nullptr) return nullptr;
+    
+    cv::Mat* src = reinterpret_cast<cv::Mat*>(handle);
+    cv::Mat* bgr = new cv::Mat();
+    
+    cv::cvtColor(*src, *bgr, cv::COLOR_GRAY2BGR);
+    
+    return reinterpret_cast<ImageHandle*>(bgr);
+}
+
 int save_image(const char* path, ImageHandle* handle) {
+    return save_image_with_quality(path, handle, 0);
+}
+
+int save_image_with_quality(const char* path, ImageHandle* handle, int jpeg_quality) {
     if (handle == nullptr) {
         fprintf(stderr, "save_image: handle is null\n");
         return 0;
@@ -158,10 +222,10 @@ int save_image(const char* path, ImageHandle* handle) {
             compression_params.push_back(cv::IMWRITE_PNG_COMPRESSION);
             compression_params.push_back(1);  // Compression level 1 (fast, low compression)
         }
-        // JPEG format: use high quality (95 = high quality)
+        // JPEG format: high quality by default (95), lower on request (faster, smaller)
         else if (strcasecmp(ext, ".jpg") == 0 || strcasecmp(ext, ".jpeg") == 0) {
             compression_params.push_back(cv::IMWRITE_JPEG_QUALITY);
-            compression_params.push_back(95);
+            compression_params.push_back(jpeg_quality > 0 ? std::min(jpeg_quality, 100) : 95);
         }
     }
     
@@ -174,23 +238,89 @@ int save_image(const char* path, ImageHandle* handle) {
     return success ? 1 : 0;
 }
 
+const uint8_t* encode_jpeg(ImageHandle* handle, int jpeg_quality, int swap_rb, size_t* size) {
+    if (handle == nullptr || size == nullptr) return nullptr;
+    
+    cv::Mat* image = reinterpret_cast<cv::Mat*>(handle);
+    if (image->empty()) return nullptr;
+    
+    // Buffers kept per thread: no allocation once the largest frame was encoded
+    static thread_local std::vector<unsigned char> encoded;
+    static thread_local cv::Mat swapped;
+    const cv::Mat* source = image;
+    if (swap_rb && image->channels() == 3) {
+        cv::cvtColor(*image, swapped, cv::COLOR_BGR2RGB);
+        source = &swapped;
+    }
+    
+    std::vector<int> params = {cv::IMWRITE_JPEG_QUALITY, jpeg_quality > 0 ? std::min(jpeg_quality, 100) : 95};
+    if (!cv::imencode(".jpg", *source, encoded, params)) {
+        fprintf(stderr, "encode_jpeg: cv::imencode failed\n");
+        return nullptr;
+    }
+    
+    *size = encoded.size();
+    return encoded.data();
+}
+
+// Dictionary and the marker ID of each of its entries (empty = entry index is the ID)
+struct ArucoDictionaryState {
+    cv::Ptr<cv::aruco::Dictionary> dictionary;
+    std::vector<int> ids;
+};
+
+// Parameters of one tile of detect_tiled, kept while the tile size does not change
+struct TileParameters {
+    int side = 0;            // Largest tile side the rates were scaled for
+    int full_side = 0;       // Largest image side
+    cv::Ptr<cv::aruco::DetectorParameters> parameters;
+};
+
 // Structure to hold detector state for OpenCV 4.6 compatibility
 struct ArucoDetectorState {
     cv::Ptr<cv::aruco::Dictionary> dictionary;
-    cv::Ptr<cv::aruco::DetectorParameters> parameters;
+    cv::Ptr<cv::aruco::DetectorParameters> parameters;         // Copied when the detector is created
+    cv::Ptr<cv::aruco::DetectorParameters> coarse_parameters;  // Same without corner refinement (pyramid)
+    std::vector<TileParameters> tile_parameters;               // One per tile index (tiled detection)
+    std::vector<int> ids;  // Entry index -> marker ID (restricted dictionary)
 };
 
-ArucoDictionaryHandle* getPredefinedDictionary(int dict_id) {
+static cv::Ptr<cv::aruco::Dictionary> predefined_dictionary(int dict_id) {
     // OpenCV 4.7+ changed the return type to cv::aruco::Dictionary (not cv::Ptr)
     #if CV_VERSION_MAJOR > 4 || (CV_VERSION_MAJOR == 4 && CV_VERSION_MINOR >= 7)
         cv::aruco::Dictionary dict = cv::aruco::getPredefinedDictionary(dict_id);
-        cv::Ptr<cv::aruco::Dictionary> dict_ptr = cv::makePtr<cv::aruco::Dictionary>(dict);
+        return cv::makePtr<cv::aruco::Dictionary>(dict);
     #else
-        cv::Ptr<cv::aruco::Dictionary> dict_ptr = cv::aruco::getPredefinedDictionary(dict_id);
+        return cv::aruco::getPredefinedDictionary(dict_id);
     #endif
+}
+
+ArucoDictionaryHandle* getPredefinedDictionary(int dict_id) {
+    ArucoDictionaryState* state = new ArucoDictionaryState();
+    state->dictionary = predefined_dictionary(dict_id);
+    return reinterpret_cast<ArucoDictionaryHandle*>(state);
+}
+
+ArucoDictionaryHandle* createRestrictedDictionary(int dict_id, const int* ids, int count) {
+    if (ids == nullptr || count <= 0) return nullptr;
+    
+    cv::Ptr<cv::aruco::Dictionary> base = predefined_dictionary(dict_id);
+    cv::Mat bytes(count, base->bytesList.cols, base->bytesList.type());
+    for (int i = 0; i < count; i++) {
+        if (ids[i] < 0 || ids[i] >= base->bytesList.rows) {
+            fprintf(stderr, "createRestrictedDictionary: marker ID %d not in dictionary %d\n", ids[i], dict_id);
+            return nullptr;
+        }
+        cv::Mat row = bytes.row(i);
+        base->bytesList.row(ids[i]).copyTo(row);
+    }
     
-    cv::Ptr<cv::aruco::Dictionary>* result = new cv::Ptr<cv::aruco::Dictionary>(dict_ptr);
-    return reinterpret_cast<ArucoDictionaryHandle*>(result);
+    // Same correction bits as the full dictionary: a marker outside the subset
+    // is rejected instead of being corrected into a kept one
+    ArucoDictionaryState* state = new ArucoDictionaryState();
+    state->dictionary = cv::makePtr<cv::aruco::Dictionary>(bytes, base->markerSize, base->maxCorrectionBits);
+    state->ids.assign(ids, ids + count);
+    return reinterpret_cast<ArucoDictionaryHandle*>(state);
 }
 
 DetectorParametersHandle* createDetectorParameters() {
@@ -209,8 +339,15 @@ ArucoDetectorHandle* createArucoDetector(ArucoDictionaryHandle* dict, DetectorPa
     if (dict == nullptr || params == nullptr) return nullptr;
     
     ArucoDetectorState* state = new ArucoDetectorState();
-    state->dictionary = *reinterpret_cast<cv::Ptr<cv::aruco::Dictionary>*>(dict);
-    state->parameters = *reinterpret_cast<cv::Ptr<cv::aruco::DetectorParameters>*>(params);
+    ArucoDictionaryState* dictionary = reinterpret_cast<ArucoDictionaryState*>(dict);
+    state->dictionary = dictionary->dictionary;
+    state->ids = dictionary->ids;
+    // Own copy: the derived parameters below are built once, so the detector
+    // must be created again (as after a settings reload) to apply new settings
+    state->parameters = cv::makePtr<cv::aruco::DetectorParameters>(
+        **reinterpret_cast<cv::Ptr<cv::aruco::DetectorParameters>*>(params));
+    state->coarse_parameters = cv::makePtr<cv::aruco::DetectorParameters>(*state->parameters);
+    state->coarse_parameters->cornerRefinementMethod = CORNER_REFINE_NONE;
     
     return reinterpret_cast<ArucoDetectorHandle*>(state);
 }
@@ -224,7 +361,7 @@ void releaseArucoDetector(ArucoDetectorHandle* detector) {
 
 void releaseArucoDictionary(ArucoDictionaryHandle* dict) {
     if (dict != nullptr) {
-        cv::Ptr<cv::aruco::Dictionary>* dictionary = reinterpret_cast<cv::Ptr<cv::aruco::Dictionary>*>(dict);
+        ArucoDictionaryState* dictionary = reinterpret_cast<ArucoDictionaryState*>(dict);
         delete dictionary;
     }
 }
@@ -309,54 +446,391 @@ void setPerspectiveRemoveIgnoredMarginPerCell(DetectorParametersHandle* params,
     (*p)->perspectiveRemoveIgnoredMarginPerCell = value;
 }
 
-DetectionResult* detectMarkersWithConfidence(ArucoDetectorHandle* detector, ImageHandle* image) {
-    if (detector == nullptr || image == nullptr) return nullptr;
-    
-    ArucoDetectorState* state = reinterpret_cast<ArucoDetectorState*>(detector);
-    cv::Mat* img = reinterpret_cast<cv::Mat*>(image);
-    
-    std::vector<int> markerIds;
-    std::vector<std::vector<cv::Point2f>> markerCorners, rejectedCandidates;
+// Detected markers in OpenCV form
+struct MarkerList {
+    std::vector<int> ids;
+    std::vector<std::vector<cv::Point2f>> corners;
+    
+    void clear() {
+        ids.clear();
+        corners.clear();
+    }
+};
+
+// Per-thread scratch list of the public detection functions (keeps its capacity between frames)
+static MarkerList& scratch_markers() {
+    static thread_local MarkerList markers;
+    markers.clear();
+    return markers;
+}
+
+// Run the OpenCV detector and translate dictionary entries to marker IDs
+static void detect_markers(const ArucoDetectorState* state, const cv::Mat& image,
+                           const cv::Ptr<cv::aruco::DetectorParameters>& parameters, MarkerList& out) {
+    static thread_local std::vector<std::vector<cv::Point2f>> rejectedCandidates;
+    cv::aruco::detectMarkers(image, state->dictionary, out.corners, out.ids, parameters, rejectedCandidates);
+    
+    if (!state->ids.empty()) {
+        for (auto& id : out.ids) {
+            id = state->ids[id];
+        }
+    }
+}
+
+// Fill one C marker from OpenCV corners, shifted by (offset_x, offset_y)
+static void fill_detected_marker(DetectedMarker* marker, int id, const std::vector<cv::Point2f>& corners,
+                                 float offset_x, float offset_y) {
+    marker->id = id;
+    
+    // Copy corner coordinates
+    for (int j = 0; j < 4; j++) {
+        marker->corners[j][0] = corners[j].x + offset_x;
+        marker->corners[j][1] = corners[j].y + offset_y;
+    }
     
-    // Detect markers using OpenCV 4.6 API
-    cv::aruco::detectMarkers(*img, state->dictionary, markerCorners, markerIds, state->parameters, rejectedCandidates);
+    // Calculate confidence score based on corner quality
+    // For now, we use a simple metric: marker perimeter vs expected perimeter
+    // A better metric would consider image quality, corner sharpness, etc.
+    float perimeter = 0.0f;
+    for (int j = 0; j < 4; j++) {
+        int next = (j + 1) % 4;
+        float dx = corners[next].x - corners[j].x;
+        float dy = corners[next].y - corners[j].y;
+        perimeter += std::sqrt(dx * dx + dy * dy);
+    }
     
-    // Create result structure
+    // Normalize confidence (larger markers = higher confidence, up to 1.0)
+    // This is a simplified metric; adjust based on your needs
+    marker->confidence = std::min(1.0f, perimeter / 400.0f);
+}
+
+// Build a C detection result from OpenCV output, shifting corners by (offset_x, offset_y)
+static DetectionResult* make_detection_result(const MarkerList& list, float offset_x, float offset_y) {
     DetectionResult* result = new DetectionResult();
-    result->count = markerIds.size();
+    result->count = list.ids.size();
     
     if (result->count > 0) {
         result->markers = new DetectedMarker[result->count];
         
         for (int i = 0; i < result->count; i++) {
-            result->markers[i].id = markerIds[i];
+            fill_detected_marker(&result->markers[i], list.ids[i], list.corners[i], offset_x, offset_y);
+        }
+    } else {
+        result->markers = nullptr;
+    }
+    
+    return result;
+}
+
+// Fill a caller-provided result (markers beyond capacity are dropped), returns the count
+static int fill_detection_result(const MarkerList& list, DetectionResult* result, int capacity) {
+    int count = std::min((int)list.ids.size(), capacity);
+    for (int i = 0; i < count; i++) {
+        fill_detected_marker(&result->markers[i], list.ids[i], list.corners[i], 0.0f, 0.0f);
+    }
+    result->count = count;
+    return count;
+}
+
+static bool valid_result_storage(const DetectionResult* result, int capacity) {
+    return result != nullptr && capacity >= 0 && (capacity == 0 || result->markers != nullptr);
+}
+
+static bool detect_plain(ArucoDetectorState* state, const cv::Mat& img, MarkerList& out) {
+    // Detect markers using OpenCV 4.6 API
+    detect_markers(state, img, state->parameters, out);
+    return true;
+}
+
+DetectionResult* detectMarkersWithConfidence(ArucoDetectorHandle* detector, ImageHandle* image) {
+    if (detector == nullptr || image == nullptr) return nullptr;
+    
+    MarkerList& markers = scratch_markers();
+    detect_plain(reinterpret_cast<ArucoDetectorState*>(detector), *reinterpret_cast<cv::Mat*>(image), markers);
+    return make_detection_result(markers, 0.0f, 0.0f);
+}
+
+int detectMarkersInto(ArucoDetectorHandle* detector, ImageHandle* image, DetectionResult* result, int capacity) {
+    if (detector == nullptr || image == nullptr || !valid_result_storage(result, capacity)) return -1;
+    
+    MarkerList& markers = scratch_markers();
+    detect_plain(reinterpret_cast<ArucoDetectorState*>(detector), *reinterpret_cast<cv::Mat*>(image), markers);
+    return fill_detection_result(markers, result, capacity);
+}
+
+ImageHandle* create_image_roi_view(ImageHandle* handle, RoiRect rect) {
+    if (handle == nullptr) return nullptr;
+    
+    cv::Mat* image = reinterpret_cast<cv::Mat*>(handle);
+    cv::Rect roi = cv::Rect(rect.x, rect.y, rect.width, rect.height) & cv::Rect(0, 0, image->cols, image->rows);
+    if (roi.width <= 0 || roi.height <= 0) return nullptr;
+    
+    // Sub-matrix header (data refcount incremented when owned)
+    cv::Mat* view = new cv::Mat((*image)(roi));
+    return reinterpret_cast<ImageHandle*>(view);
+}
+
+// True if a marker with the same ID and a center closer than half a side is already in the list
+static bool is_duplicate_marker(const MarkerList& list, int id, const std::vector<cv::Point2f>& marker) {
+    cv::Point2f center = (marker[0] + marker[2]) * 0.5f;
+    for (size_t k = 0; k < list.ids.size(); k++) {
+        if (list.ids[k] != id) continue;
+        cv::Point2f other = (list.corners[k][0] + list.corners[k][2]) * 0.5f;
+        float side = (float)cv::norm(list.corners[k][1] - list.corners[k][0]);
+        if (cv::norm(center - other) < 0.5f * side) return true;
+    }
+    return false;
+}
+
+static bool detect_in_regions(ArucoDetectorState* state, const cv::Mat& img,
+                              const RoiRect* regions, int region_count, MarkerList& out) {
+    cv::Rect bounds(0, 0, img.cols, img.rows);
+    static thread_local MarkerList region_markers;
+    
+    for (int r = 0; r < region_count; r++) {
+        cv::Rect rect = cv::Rect(regions[r].x, regions[r].y, regions[r].width, regions[r].height) & bounds;
+        if (rect.width <= 0 || rect.height <= 0) continue;
+        
+        // Sub-matrix header on the region (no copy), detection runs on the crop only
+        cv::Mat crop = img(rect);
+        region_markers.clear();
+        detect_markers(state, crop, state->parameters, region_markers);
+        
+        for (size_t i = 0; i < region_markers.ids.size(); i++) {
+            for (auto& corner : region_markers.corners[i]) {
+                corner.x += rect.x;
+                corner.y += rect.y;
+            }
             
-            // Copy corner coordinates
-            for (int j = 0; j < 4; j++) {
-                result->markers[i].corners[j][0] = markerCorners[i][j].x;
-                result->markers[i].corners[j][1] = markerCorners[i][j].y;
+            // Overlapping regions can see the same marker twice: keep the first one
+            if (!is_duplicate_marker(out, region_markers.ids[i], region_markers.corners[i])) {
+                out.ids.push_back(region_markers.ids[i]);
+                out.corners.push_back(region_markers.corners[i]);
             }
+        }
+    }
+    
+    return true;
+}
+
+DetectionResult* detectMarkersInRegions(ArucoDetectorHandle* detector, ImageHandle* image,
+                                        const RoiRect* regions, int region_count) {
+    if (detector == nullptr || image == nullptr || (region_count > 0 && regions == nullptr)) return nullptr;
+    
+    MarkerList& markers = scratch_markers();
+    detect_in_regions(reinterpret_cast<ArucoDetectorState*>(detector), *reinterpret_cast<cv::Mat*>(image),
+                      regions, region_count, markers);
+    return make_detection_result(markers, 0.0f, 0.0f);
+}
+
+int detectMarkersInRegionsInto(ArucoDetectorHandle* detector, ImageHandle* image,
+                               const RoiRect* regions, int region_count, DetectionResult* result, int capacity) {
+    if (detector == nullptr || image == nullptr || (region_count > 0 && regions == nullptr)) return -1;
+    if (!valid_result_storage(result, capacity)) return -1;
+    
+    MarkerList& markers = scratch_markers();
+    detect_in_regions(reinterpret_cast<ArucoDetectorState*>(detector), *reinterpret_cast<cv::Mat*>(image),
+                      regions, region_count, markers);
+    return fill_detection_result(markers, result, capacity);
+}
+
+static bool detect_pyramid(ArucoDetectorState* state, const cv::Mat& img, float scale, MarkerList& out) {
+    if (scale >= 1.0f) return detect_plain(state, img, out);
+    if (scale <= 0.0f) return false;
+    
+    // Coarse level: candidates on the downscaled image, corners refined later
+    static thread_local cv::Mat small;
+    cv::resize(img, small, cv::Size(), scale, scale, cv::INTER_AREA);
+    
+    detect_markers(state, small, state->coarse_parameters, out);
+    
+    // Fine level: subpixel refinement on a full resolution crop around each marker.
+    // The window must cover the coarse corner uncertainty (about 1 / scale pixels)
+    float inv_scale = 1.0f / scale;
+    int win = std::max(state->parameters->cornerRefinementWinSize, (int)std::ceil(2.0f * inv_scale));
+    int max_iter = std::max(state->parameters->cornerRefinementMaxIterations, 1);
+    cv::TermCriteria criteria(cv::TermCriteria::MAX_ITER | cv::TermCriteria::EPS, max_iter, 0.01);
+    cv::Rect bounds(0, 0, img.cols, img.rows);
+    static thread_local cv::Mat gray_crop;
+    static thread_local std::vector<cv::Point2f> local(4);
+    
+    for (size_t i = 0; i < out.ids.size(); i++) {
+        for (auto& corner : out.corners[i]) {
+            corner *= inv_scale;
+        }
+        
+        cv::Rect rect = cv::boundingRect(out.corners[i]);
+        rect.x -= win + 1;
+        rect.y -= win + 1;
+        rect.width += 2 * (win + 1);
+        rect.height += 2 * (win + 1);
+        rect &= bounds;
+        if (rect.width <= 2 * win + 1 || rect.height <= 2 * win + 1) continue;
+        
+        // Only the crop is converted to gray (sub-matrix header, no full frame copy)
+        cv::Mat crop = img(rect);
+        if (crop.channels() == 1) {
+            gray_crop = crop;
+        } else {
+            cv::cvtColor(crop, gray_crop, cv::COLOR_BGR2GRAY);
+        }
+        
+        for (int j = 0; j < 4; j++) {
+            local[j] = out.corners[i][j] - cv::Point2f((float)rect.x, (float)rect.y);
+        }
+        cv::cornerSubPix(gray_crop, local, cv::Size(win, win), cv::Size(-1, -1), criteria);
+        for (int j = 0; j < 4; j++) {
+            out.corners[i][j] = local[j] + cv::Point2f((float)rect.x, (float)rect.y);
+        }
+    }
+    
+    return true;
+}
+
+DetectionResult* detectMarkersPyramid(ArucoDetectorHandle* detector, ImageHandle* image, float scale) {
+    if (detector == nullptr || image == nullptr) return nullptr;
+    
+    MarkerList& markers = scratch_markers();
+    if (!detect_pyramid(reinterpret_cast<ArucoDetectorState*>(detector), *reinterpret_cast<cv::Mat*>(image),
+                        scale, markers)) {
+        return nullptr;
+    }
+    return make_detection_result(markers, 0.0f, 0.0f);
+}
+
+int detectMarkersPyramidInto(ArucoDetectorHandle* detector, ImageHandle* image, float scale,
+                             DetectionResult* result, int capacity) {
+    if (detector == nullptr || image == nullptr || !valid_result_storage(result, capacity)) return -1;
+    
+    MarkerList& markers = scratch_markers();
+    if (!detect_pyramid(reinterpret_cast<ArucoDetectorState*>(detector), *reinterpret_cast<cv::Mat*>(image),
+                        scale, markers)) {
+        return -1;
+    }
+    return fill_detection_result(markers, result, capacity);
+}
+
+static bool detect_tiled(ArucoDetectorState* state, const cv::Mat& img,
+                         int tile_cols, int tile_rows, int overlap, MarkerList& out) {
+    if (tile_cols < 1 || tile_rows < 1 || overlap < 0) return false;
+    if (tile_cols * tile_rows == 1) return detect_plain(state, img, out);
+    
+    cv::Rect bounds(0, 0, img.cols, img.rows);
+    int tile_count = tile_cols * tile_rows;
+    int core_width = (img.cols + tile_cols - 1) / tile_cols;
+    int core_height = (img.rows + tile_rows - 1) / tile_rows;
+    if (core_width <= 0 || core_height <= 0) return false;
+    
+    // Besides the marker itself, a tile must contain the whole adaptive threshold
+    // and subpixel windows around it so the pixels seen by the detector are the
+    // same as on the full image. No marker is larger than the perimeter rate allows
+    const cv::aruco::DetectorParameters& base = *state->parameters;
+    int full_side = std::max(img.cols, img.rows);
+    float full_dim = (float)full_side;
+    int largest = (int)std::ceil(base.maxMarkerPerimeterRate * full_dim * 0.25 * std::sqrt(2.0));
+    int margin = std::min(overlap, largest) + base.adaptiveThreshWinSizeMax / 2 + base.cornerRefinementWinSize + 1;
+
+    // Tiles as large as the image: a single call does the same work once
+    if (core_width + 2 * margin >= img.cols && core_height + 2 * margin >= img.rows) {
+        return detect_plain(state, img, out);
+    }
+    
+    // One list per tile, filled by its own worker (kept between calls of the calling
+    // thread; workers must see this thread's lists, not their own thread_local copy)
+    static thread_local std::vector<MarkerList> tile_lists;
+    std::vector<MarkerList>& tiles = tile_lists;
+    if ((int)tiles.size() < tile_count) tiles.resize(tile_count);
+    
+    // Sized before the workers start: each one only touches the entry of its tile
+    std::vector<TileParameters>& tile_params = state->tile_parameters;
+    if ((int)tile_params.size() < tile_count) tile_params.resize(tile_count);
+    
+    cv::parallel_for_(cv::Range(0, tile_count), [&](const cv::Range& range) {
+        for (int t = range.start; t < range.end; t++) {
+            MarkerList& tile = tiles[t];
+            tile.clear();
             
-            // Calculate confidence score based on corner quality
-            // For now, we use a simple metric: marker perimeter vs expected perimeter
-            // A better metric would consider image quality, corner sharpness, etc.
-            float perimeter = 0.0f;
-            for (int j = 0; j < 4; j++) {
-                int next = (j + 1) % 4;
-                float dx = markerCorners[i][next].x - markerCorners[i][j].x;
-                float dy = markerCorners[i][next].y - markerCorners[i][j].y;
-                perimeter += std::sqrt(dx * dx + dy * dy);
+            cv::Rect core = cv::Rect((t % tile_cols) * core_width, (t / tile_cols) * core_height,
+                                     core_width, core_height) & bounds;
+            if (core.width <= 0 || core.height <= 0) continue;
+            cv::Rect rect = cv::Rect(core.x - margin, core.y - margin,
+                                     core.width + 2 * margin, core.height + 2 * margin) & bounds;
+            
+            // Perimeter rates are relative to the largest image side: rescale them
+            // so the pixel limits are the ones of the full image. Rebuilt only when
+            // the tile or image size changes
+            TileParameters& cached = tile_params[t];
+            int side = std::max(rect.width, rect.height);
+            if (!cached.parameters || cached.side != side || cached.full_side != full_side) {
+                cached.parameters = cv::makePtr<cv::aruco::DetectorParameters>(base);
+                float rate_scale = full_dim / (float)side;
+                cached.parameters->minMarkerPerimeterRate = base.minMarkerPerimeterRate * rate_scale;
+                cached.parameters->maxMarkerPerimeterRate = base.maxMarkerPerimeterRate * rate_scale;
+                cached.side = side;
+                cached.full_side = full_side;
             }
             
-            // Normalize confidence (larger markers = higher confidence, up to 1.0)
-            // This is a simplified metric; adjust based on your needs
-            result->markers[i].confidence = std::min(1.0f, perimeter / 400.0f);
+            // Sub-matrix header on the tile (no copy)
+            cv::Mat crop = img(rect);
+            detect_markers(state, crop, cached.parameters, tile);
+            
+            size_t kept = 0;
+            for (size_t i = 0; i < tile.ids.size(); i++) {
+                for (auto& corner : tile.corners[i]) {
+                    corner.x += rect.x;
+                    corner.y += rect.y;
+                }
+                
+                // Cores partition the image: a marker belongs to the tile whose core
+                // holds its center, that tile contains it entirely
+                cv::Point2f center = (tile.corners[i][0] + tile.corners[i][2]) * 0.5f;
+                if (center.x < core.x || center.x >= core.x + core.width ||
+                    center.y < core.y || center.y >= core.y + core.height) continue;
+                
+                tile.ids[kept] = tile.ids[i];
+                std::swap(tile.corners[kept], tile.corners[i]);
+                kept++;
+            }
+            tile.ids.resize(kept);
+            tile.corners.resize(kept);
+        }
+    }, tile_count);
+    
+    // Merge in tile order, so the output does not depend on thread scheduling
+    for (int t = 0; t < tile_count; t++) {
+        for (size_t i = 0; i < tiles[t].ids.size(); i++) {
+            if (!is_duplicate_marker(out, tiles[t].ids[i], tiles[t].corners[i])) {
+                out.ids.push_back(tiles[t].ids[i]);
+                out.corners.push_back(tiles[t].corners[i]);
+            }
         }
-    } else {
-        result->markers = nullptr;
     }
     
-    return result;
+    return true;
+}
+
+DetectionResult* detectMarkersTiled(ArucoDetectorHandle* detector, ImageHandle* image,
+                                    int tile_cols, int tile_rows, int overlap) {
+    if (detector == nullptr || image == nullptr) return nullptr;
+    
+    MarkerList& markers = scratch_markers();
+    if (!detect_tiled(reinterpret_cast<ArucoDetectorState*>(detector), *reinterpret_cast<cv::Mat*>(image),
+                      tile_cols, tile_rows, overlap, markers)) {
+        return nullptr;
+    }
+    return make_detection_result(markers, 0.0f, 0.0f);
+}
+
+int detectMarkersTiledInto(ArucoDetectorHandle* detector, ImageHandle* image,
+                           int tile_cols, int tile_rows, int overlap, DetectionResult* result, int capacity) {
+    if (detector == nullptr || image == nullptr || !valid_result_storage(result, capacity)) return -1;
+    
+    MarkerList& markers = scratch_markers();
+    if (!detect_tiled(reinterpret_cast<ArucoDetectorState*>(detector), *reinterpret_cast<cv::Mat*>(image),
+                      tile_cols, tile_rows, overlap, markers)) {
+        return -1;
+    }
+    return fill_detection_result(markers, result, capacity);
 }
 
 void releaseDetectionResult(DetectionResult* result) {
@@ -534,6 +1008,29 @@ ImageHandle* resize_image_reuse(ImageHandle* src, int new_width, int new_height,
     return reinterpret_cast<ImageHandle*>(dst_mat);
 }
 
+ImageHandle* resize_to_bgr_reuse(ImageHandle* src, int new_width, int new_height, ImageHandle* dst) {
+    if (src == nullptr || new_width <= 0 || new_height <= 0) return nullptr;
+    
+    cv::Mat* src_mat = reinterpret_cast<cv::Mat*>(src);
+    if (src_mat->channels() != 1 && src_mat->channels() != 3) return nullptr;
+    
+    cv::Mat* dst_mat = (dst == nullptr) ? new cv::Mat() : reinterpret_cast<cv::Mat*>(dst);
+    if (dst_mat->rows != new_height || dst_mat->cols != new_width || dst_mat->type() != CV_8UC3) {
+        *dst_mat = cv::Mat(new_height, new_width, CV_8UC3);
+    }
+    
+    if (src_mat->channels() == 3) {
+        cv::resize(*src_mat, *dst_mat, cv::Size(new_width, new_height), 0, 0, cv::INTER_AREA);
+    } else {
+        // Gray: resize first, the color expansion then only touches output pixels
+        static thread_local cv::Mat gray;
+        cv::resize(*src_mat, gray, cv::Size(new_width, new_height), 0, 0, cv::INTER_AREA);
+        cv::cvtColor(gray, *dst_mat, cv::COLOR_GRAY2BGR);
+    }
+    
+    return reinterpret_cast<ImageHandle*>(dst_mat);
+}
+
 ImageHandle* bitwise_and_mask_reuse(ImageHandle* src, ImageHandle* mask, ImageHandle* dst) {
     if (src == nullptr || mask == nullptr) return nullptr;
     
@@ -561,6 +1058,310 @@ ImageHandle* bitwise_and_mask_reuse(ImageHandle* src, ImageHandle* mask, ImageHa
     return reinterpret_cast<ImageHandle*>(dst_mat);
 }
 
+// ===== Fused preprocessing (sharpen + mask + gray in one pass) =====
+
+// Integer luma weights, sum = 256 (same rounding as cv::cvtColor BGR2GRAY)
+#define GRAY_WEIGHT_B 29
+#define GRAY_WEIGHT_G 150
+#define GRAY_WEIGHT_R 77
+
+// Convert one BGR row to gray
+static void bgr_row_to_gray(const uint8_t* src, uint8_t* dst, int width) {
+    int x = 0;
+#if defined(__ARM_NEON)
+    const uint8x8_t wb = vdup_n_u8(GRAY_WEIGHT_B);
+    const uint8x8_t wg = vdup_n_u8(GRAY_WEIGHT_G);
+    const uint8x8_t wr = vdup_n_u8(GRAY_WEIGHT_R);
+    for (; x + 16 <= width; x += 16) {
+        uint8x16x3_t bgr = vld3q_u8(src + 3 * x);
+        uint16x8_t lo = vmull_u8(vget_low_u8(bgr.val[0]), wb);
+        lo = vmlal_u8(lo, vget_low_u8(bgr.val[1]), wg);
+        lo = vmlal_u8(lo, vget_low_u8(bgr.val[2]), wr);
+        uint16x8_t hi = vmull_u8(vget_high_u8(bgr.val[0]), wb);
+        hi = vmlal_u8(hi, vget_high_u8(bgr.val[1]), wg);
+        hi = vmlal_u8(hi, vget_high_u8(bgr.val[2]), wr);
+        vst1q_u8(dst + x, vcombine_u8(vrshrn_n_u16(lo, 8), vrshrn_n_u16(hi, 8)));
+    }
+#endif
+    for (; x < width; x++) {
+        const uint8_t* p = src + 3 * x;
+        dst[x] = (uint8_t)((GRAY_WEIGHT_B * p[0] + GRAY_WEIGHT_G * p[1] + GRAY_WEIGHT_R * p[2] + 128) >> 8);
+    }
+}
+
+// Same kernel as sharpen_image_reuse (9 * center - 8 neighbours = 10 * center - 3x3 sum)
+static inline uint8_t sharpen_pixel(const uint8_t* up, const uint8_t* mid, const uint8_t* down,
+                                    int xl, int x, int xr) {
+    int sum = up[xl] + up[x] + up[xr] + mid[xl] + mid[x] + mid[xr] + down[xl] + down[x] + down[xr];
+    int value = 10 * mid[x] - sum;
+    return (uint8_t)(value < 0 ? 0 : (value > 255 ? 255 : value));
+}
+
+// Sharpen one gray row (rows above and below given) and zero pixels outside the mask
+static void sharpen_mask_row(const uint8_t* up, const uint8_t* mid, const uint8_t* down,
+                             const uint8_t* mask, uint8_t* dst, int width) {
+    // Borders are reflected like cv::filter2D (BORDER_REFLECT_101)
+    dst[0] = (mask && !mask[0]) ? 0 : sharpen_pixel(up, mid, down, 1, 0, 1);
+    
+    int x = 1;
+#if defined(__ARM_NEON)
+    for (; x + 9 <= width; x += 8) {
+        uint16x8_t sum = vaddw_u8(vaddl_u8(vld1_u8(up + x - 1), vld1_u8(up + x)), vld1_u8(up + x + 1));
+        sum = vaddq_u16(sum, vaddw_u8(vaddl_u8(vld1_u8(mid + x - 1), vld1_u8(mid + x)), vld1_u8(mid + x + 1)));
+        sum = vaddq_u16(sum, vaddw_u8(vaddl_u8(vld1_u8(down + x - 1), vld1_u8(down + x)), vld1_u8(down + x + 1)));
+        uint16x8_t center = vmulq_n_u16(vmovl_u8(vld1_u8(mid + x)), 10);
+        int16x8_t value = vsubq_s16(vreinterpretq_s16_u16(center), vreinterpretq_s16_u16(sum));
+        uint8x8_t out = vqmovun_s16(value);
+        if (mask) {
+            uint8x8_t m = vld1_u8(mask + x);
+            out = vand_u8(out, vtst_u8(m, m));
+        }
+        vst1_u8(dst + x, out);
+    }
+#endif
+    for (; x < width - 1; x++) {
+        dst[x] = (mask && !mask[x]) ? 0 : sharpen_pixel(up, mid, down, x - 1, x, x + 1);
+    }
+    
+    dst[width - 1] = (mask && !mask[width - 1]) ? 0 : sharpen_pixel(up, mid, down, width - 2, width - 1, width - 2);
+}
+
+// Process rows [y0, y1): each source row is converted to gray once into a 3-row ring
+static void sharpen_mask_gray_rows(const cv::Mat& src, const cv::Mat* mask, cv::Mat& dst, int y0, int y1) {
+    const int width = src.cols;
+    const int height = src.rows;
+    const bool is_gray = src.channels() == 1;
+    
+    // One ring per worker thread, grown only when a wider image comes in
+    static thread_local std::vector<uint8_t> ring;
+    if (!is_gray && ring.size() < (size_t)width * 3) {
+        ring.resize((size_t)width * 3);
+    }
+    int cached[3] = {-1, -1, -1};
+    
+    auto fetch = [&](int y) -> const uint8_t* {
+        if (is_gray) return src.ptr<uint8_t>(y);
+        int slot = y % 3;
+        uint8_t* row = ring.data() + (size_t)slot * width;
+        if (cached[slot] != y) {
+            bgr_row_to_gray(src.ptr<uint8_t>(y), row, width);
+            cached[slot] = y;
+        }
+        return row;
+    };
+    
+    for (int y = y0; y < y1; y++) {
+        const uint8_t* up = fetch(y > 0 ? y - 1 : 1);
+        const uint8_t* mid = fetch(y);
+        const uint8_t* down = fetch(y < height - 1 ? y + 1 : height - 2);
+        sharpen_mask_row(up, mid, down, mask ? mask->ptr<uint8_t>(y) : nullptr, dst.ptr<uint8_t>(y), width);
+    }
+}
+
+ImageHandle* sharpen_mask_gray_reuse(ImageHandle* src, ImageHandle* mask, ImageHandle* dst) {
+    if (src == nullptr) return nullptr;
+    
+    cv::Mat* src_mat = reinterpret_cast<cv::Mat*>(src);
+    cv::Mat* mask_mat = reinterpret_cast<cv::Mat*>(mask);
+    
+    if (src_mat->depth() != CV_8U || (src_mat->channels() != 1 && src_mat->channels() != 3) ||
+        src_mat->cols < 3 || src_mat->rows < 3) {
+        fprintf(stderr, "sharpen_mask_gray_reuse: expected 8-bit BGR or gray image of at least 3x3\n");
+        return nullptr;
+    }
+    if (mask_mat != nullptr &&
+        (mask_mat->type() != CV_8UC1 || mask_mat->rows != src_mat->rows || mask_mat->cols != src_mat->cols)) {
+        fprintf(stderr, "sharpen_mask_gray_reuse: mask must be single channel and the size of the image\n");
+        return nullptr;
+    }
+    
+    cv::Mat* dst_mat = nullptr;
+    if (dst == nullptr) {
+        // No buffer provided, allocate new one
+        dst_mat = new cv::Mat(src_mat->rows, src_mat->cols, CV_8UC1);
+    } else {
+        // Reuse provided buffer
+        dst_mat = reinterpret_cast<cv::Mat*>(dst);
+        // Ensure buffer has correct dimensions (single channel output)
+        if (dst_mat->rows != src_mat->rows || 
+            dst_mat->cols != src_mat->cols || 
+            dst_mat->type() != CV_8UC1) {
+            // Reallocate if size mismatch
+            *dst_mat = cv::Mat(src_mat->rows, src_mat->cols, CV_8UC1);
+        }
+    }
+    
+    // One stripe per worker thread: stripe borders re-convert only two rows
+    cv::parallel_for_(cv::Range(0, src_mat->rows), [&](const cv::Range& range) {
+        sharpen_mask_gray_rows(*src_mat, mask_mat, *dst_mat, range.start, range.end);
+    }, std::max(1, cv::getNumThreads()));
+    
+    return reinterpret_cast<ImageHandle*>(dst_mat);
+}
+
+// ===== Image Pool =====
+
+struct ImagePoolEntry {
+    cv::Mat mat;
+    bool in_use = false;
+    bool owned = false;   // mat holds a pool buffer (kept on release), otherwise a view
+};
+
+struct ImagePool {
+    std::mutex lock;
+    std::vector<ImagePoolEntry> entries;  // Never resized: handles point into it
+};
+
+static int pool_image_type(int channels) {
+    if (channels == 1) return CV_8UC1;
+    if (channels == 3) return CV_8UC3;
+    if (channels == 4) return CV_8UC4;
+    return -1;
+}
+
+// Reserve a free entry, preferring one with a buffer of this geometry (owned)
+// or without buffer (views); must be called with the pool locked
+static ImagePoolEntry* pool_reserve(ImagePool* pool, bool owned, int width, int height, int type) {
+    ImagePoolEntry* match = nullptr;
+    ImagePoolEntry* empty = nullptr;
+    ImagePoolEntry* any = nullptr;
+    
+    for (auto& entry : pool->entries) {
+        if (entry.in_use) continue;
+        if (owned && entry.owned && entry.mat.cols == width && entry.mat.rows == height && entry.mat.type() == type) {
+            match = &entry;
+            break;
+        }
+        if (!entry.owned && empty == nullptr) empty = &entry;
+        if (any == nullptr) any = &entry;
+    }
+    
+    ImagePoolEntry* entry = match ? match : (empty ? empty : any);
+    if (entry != nullptr) {
+        entry->in_use = true;
+    }
+    return entry;
+}
+
+ImagePool* image_pool_create(int capacity) {
+    if (capacity <= 0) return nullptr;
+    
+    ImagePool* pool = new ImagePool();
+    pool->entries.resize(capacity);
+    return pool;
+}
+
+void image_pool_destroy(ImagePool* pool) {
+    if (pool == nullptr) return;
+    
+    for (const auto& entry : pool->entries) {
+        if (entry.in_use) {
+            fprintf(stderr, "image_pool_destroy: image still in use\n");
+            break;
+        }
+    }
+    delete pool;
+}
+
+ImageHandle* image_pool_acquire(ImagePool* pool, int width, int height, int channels) {
+    int type = pool_image_type(channels);
+    if (pool == nullptr || width <= 0 || height <= 0 || type < 0) return nullptr;
+    
+    ImagePoolEntry* entry;
+    {
+        std::lock_guard<std::mutex> guard(pool->lock);
+        entry = pool_reserve(pool, true, width, height, type);
+    }
+    if (entry == nullptr) {
+        // Exhausted: plain allocation, image_pool_release() frees it
+        return reinterpret_cast<ImageHandle*>(new cv::Mat(height, width, type));
+    }
+    
+    // The entry is reserved, its buffer is (re)allocated outside the lock
+    // (no-op when the geometry matches)
+    if (!entry->owned) entry->mat.release();
+    entry->mat.create(height, width, type);
+    entry->owned = true;
+    return reinterpret_cast<ImageHandle*>(&entry->mat);
+}
+
+ImageHandle* image_pool_acquire_copy(ImagePool* pool, ImageHandle* src) {
+    if (pool == nullptr || src == nullptr) return nullptr;
+    
+    cv::Mat* image = reinterpret_cast<cv::Mat*>(src);
+    ImageHandle* copy = image_pool_acquire(pool, image->cols, image->rows, image->channels());
+    if (copy != nullptr) {
+        image->copyTo(*reinterpret_cast<cv::Mat*>(copy));
+    }
+    return copy;
+}
+
+ImageHandle* image_pool_acquire_view(ImagePool* pool, uint8_t* data, int width, int height, int channels, size_t stride) {
+    int type = pool_image_type(channels);
+    if (pool == nullptr || data == nullptr || width <= 0 || height <= 0 || type < 0) return nullptr;
+    
+    if (stride == 0) {
+        stride = static_cast<size_t>(width) * channels;
+    } else if (stride < static_cast<size_t>(width) * channels) {
+        return nullptr;
+    }
+    
+    ImagePoolEntry* entry;
+    {
+        std::lock_guard<std::mutex> guard(pool->lock);
+        entry = pool_reserve(pool, false, width, height, type);
+    }
+    if (entry == nullptr) {
+        return create_image_view_from_buffer(data, width, height, channels, stride);
+    }
+    
+    // Non-owning header over the external buffer
+    entry->mat = cv::Mat(height, width, type, data, stride);
+    entry->owned = false;
+    return reinterpret_cast<ImageHandle*>(&entry->mat);
+}
+
+ImageHandle* image_pool_acquire_roi_view(ImagePool* pool, ImageHandle* handle, RoiRect rect) {
+    if (pool == nullptr || handle == nullptr) return nullptr;
+    
+    cv::Mat* image = reinterpret_cast<cv::Mat*>(handle);
+    cv::Rect roi = cv::Rect(rect.x, rect.y, rect.width, rect.height) & cv::Rect(0, 0, image->cols, image->rows);
+    if (roi.width <= 0 || roi.height <= 0) return nullptr;
+    
+    ImagePoolEntry* entry;
+    {
+        std::lock_guard<std::mutex> guard(pool->lock);
+        entry = pool_reserve(pool, false, roi.width, roi.height, image->type());
+    }
+    if (entry == nullptr) {
+        return create_image_roi_view(handle, rect);
+    }
+    
+    // Sub-matrix header (data refcount incremented when owned)
+    entry->mat = (*image)(roi);
+    entry->owned = false;
+    return reinterpret_cast<ImageHandle*>(&entry->mat);
+}
+
+void image_pool_release(ImagePool* pool, ImageHandle* image) {
+    if (image == nullptr) return;
+    
+    cv::Mat* mat = reinterpret_cast<cv::Mat*>(image);
+    if (pool != nullptr) {
+        std::lock_guard<std::mutex> guard(pool->lock);
+        for (auto& entry : pool->entries) {
+            if (&entry.mat != mat) continue;
+            // Views drop their reference, owned buffers stay for the next acquire
+            if (!entry.owned) entry.mat.release();
+            entry.in_use = false;
+            return;
+        }
+    }
+    
+    // Not from the pool (allocated while it was exhausted)
+    release_image(image);
+}
+
 // ===== Drawing Functions =====
 
 void put_text(ImageHandle* image, const char* text, int x, int y, 
@@ -725,6 +1526,42 @@ Point2f* fisheye_undistort_points(Point2f* points, int num_points,
     return result;
 }
 
+int fisheye_undistort_points_into(const Point2f* points, int num_points,
+                                  const float* camera_matrix,
+                                  const float* dist_coeffs,
+                                  const float* output_camera_matrix,
+                                  Point2f* out) {
+    if (points == nullptr || camera_matrix == nullptr || dist_coeffs == nullptr || out == nullptr || num_points < 0) {
+        return -1;
+    }
+    if (num_points == 0) return 0;
+    
+    // Matrix headers over stack storage: nothing is allocated per call
+    double k[9], p[9], d[4];
+    const float* p_src = output_camera_matrix ? output_camera_matrix : camera_matrix;
+    for (int i = 0; i < 9; i++) {
+        k[i] = camera_matrix[i];
+        p[i] = p_src[i];
+    }
+    for (int i = 0; i < 4; i++) {
+        d[i] = dist_coeffs[i];
+    }
+    cv::Mat K(3, 3, CV_64F, k);
+    cv::Mat P(3, 3, CV_64F, p);
+    cv::Mat D(1, 4, CV_64F, d);
+    
+    // Point2f has the CV_32FC2 layout: wrap input and output in place
+    // (undistortPoints keeps the output header since size and type already match)
+    cv::Mat src(num_points, 1, CV_32FC2, const_cast<Point2f*>(points));
+    cv::Mat dst(num_points, 1, CV_32FC2, out);
+    if (points == out) {
+        src = src.clone();  // In-place call: keep the input while the output is written
+    }
+    cv::fisheye::undistortPoints(src, dst, K, D, cv::noArray(), P);
+    
+    return 0;
+}
+
 float* find_homography(Point2f* src_points, Point2f* dst_points, int num_points) {
     if (src_points == nullptr || dst_points == nullptr || num_points < 4) {
         return nullptr;
@@ -780,6 +1617,23 @@ Point2f* perspective_transform(Point2f* points, int num_points, float* homograph
     return result;
 }
 
+int perspective_transform_into(const Point2f* points, int num_points, const float* homography, Point2f* out) {
+    if (points == nullptr || homography == nullptr || out == nullptr || num_points < 0) return -1;
+    
+    // Plain 3x3 projection in double precision (same math as cv::perspectiveTransform)
+    const float* h = homography;
+    for (int i = 0; i < num_points; i++) {
+        double x = points[i].x;
+        double y = points[i].y;
+        double w = h[6] * x + h[7] * y + h[8];
+        w = (w != 0.0) ? 1.0 / w : 0.0;
+        out[i].x = static_cast<float>((h[0] * x + h[1] * y + h[2]) * w);
+        out[i].y = static_cast<float>((h[3] * x + h[4] * y + h[5]) * w);
+    }
+    
+    return 0;
+}
+
 // ===== Pose Estimation =====
 
 PnPResult solve_pnp(Point3f* object_points, Point2f* image_points, int num_points,
@@ -826,6 +1680,109 @@ PnPResult solve_pnp(Point3f* object_points, Point2f* image_points, int num_point
     return result;
 }
 
+// Largest reprojection error (RMS, pixels) of the IPPE solution closest to the guess
+// for it to be kept over the best one
+#define PNP_GUESS_MAX_ERROR_PX 2.0
+
+// trace(Ra^T Rb): 1 + 2 cos(angle between the two rotations), larger is closer
+static double rotation_similarity(const cv::Matx33d& Ra, const cv::Matx33d& Rb) {
+    double trace = 0.0;
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++) {
+            trace += Ra(i, j) * Rb(i, j);
+        }
+    }
+    return trace;
+}
+
+int solve_pnp_squares_into(const Point2f* image_points, const float* marker_sizes, int count,
+                           const float* camera_matrix, const float* dist_coeffs,
+                           const PnPResult* guesses, PnPResult* out) {
+    if (image_points == nullptr || marker_sizes == nullptr || camera_matrix == nullptr ||
+        out == nullptr || count < 0) {
+        return -1;
+    }
+    if (count == 0) return 0;
+    
+    // Undistort every corner at once: IPPE then runs on an ideal pinhole camera
+    static thread_local std::vector<Point2f> undistorted;
+    const Point2f* points = image_points;
+    if (dist_coeffs != nullptr) {
+        undistorted.resize(static_cast<size_t>(count) * 4);
+        if (fisheye_undistort_points_into(image_points, count * 4, camera_matrix, dist_coeffs,
+                                          nullptr, undistorted.data()) != 0) {
+            return -1;
+        }
+        points = undistorted.data();
+    }
+    
+    double k[9];
+    for (int i = 0; i < 9; i++) {
+        k[i] = camera_matrix[i];
+    }
+    cv::Mat K(3, 3, CV_64F, k);
+    
+    static thread_local std::vector<cv::Mat> rvecs;
+    static thread_local std::vector<cv::Mat> tvecs;
+    static thread_local std::vector<double> errors;
+    
+    int found = 0;
+    for (int m = 0; m < count; m++) {
+        PnPResult* result = &out[m];
+        *result = PnPResult{{0, 0, 0}, {0, 0, 0}, 0};
+        if (marker_sizes[m] <= 0.0f) continue;
+        
+        // Object points in the order IPPE_SQUARE requires (same as ArUco corners)
+        float half = marker_sizes[m] / 2.0f;
+        float object[4][3] = {
+            {-half, half, 0.0f},
+            {half, half, 0.0f},
+            {half, -half, 0.0f},
+            {-half, -half, 0.0f}
+        };
+        cv::Mat obj_pts(4, 1, CV_32FC3, object);
+        cv::Mat img_pts(4, 1, CV_32FC2, const_cast<Point2f*>(&points[m * 4]));
+        
+        int solutions = cv::solvePnPGeneric(obj_pts, img_pts, K, cv::noArray(), rvecs, tvecs,
+                                            false, cv::SOLVEPNP_IPPE_SQUARE, cv::noArray(),
+                                            cv::noArray(), errors);
+        if (solutions <= 0) continue;
+        
+        int best = 0;
+        for (int s = 1; s < solutions; s++) {
+            if (errors[s] < errors[best]) best = s;
+        }
+        
+        if (guesses != nullptr && guesses[m].success && solutions > 1) {
+            cv::Vec3d guess_rvec(guesses[m].rvec[0], guesses[m].rvec[1], guesses[m].rvec[2]);
+            cv::Matx33d R_guess;
+            cv::Rodrigues(guess_rvec, R_guess);
+            
+            int closest = 0;
+            double closest_similarity = -4.0;
+            for (int s = 0; s < solutions; s++) {
+                cv::Matx33d R;
+                cv::Rodrigues(rvecs[s], R);
+                double similarity = rotation_similarity(R, R_guess);
+                if (similarity > closest_similarity) {
+                    closest_similarity = similarity;
+                    closest = s;
+                }
+            }
+            if (errors[closest] <= PNP_GUESS_MAX_ERROR_PX) best = closest;
+        }
+        
+        for (int i = 0; i < 3; i++) {
+            result->rvec[i] = static_cast<float>(rvecs[best].at<double>(i));
+            result->tvec[i] = static_cast<float>(tvecs[best].at<double>(i));
+        }
+        result->success = 1;
+        found++;
+    }
+    
+    return found;
+}
+
 // ===== Memory Management =====
 
 void free_points_2f(Point2f* points) {
@@ -45,6 +45,20 @@ ImageHandle* load_image(const char* path);
 // format: 0=BGR, 1=RGB, 2=RGBA, 3=BGRA, 4=GRAY
 ImageHandle* create_image_from_buffer(uint8_t* data, int width, int height, int channels, int format);
 
+// Wrap an external buffer as an image without copying it
+// data: pointer to image data (BGR, BGRA or GRAY, must outlive the returned image)
+// stride: bytes per row (0 = width * channels, i.e. no padding)
+// release_image() only frees the handle, never the data
+ImageHandle* create_image_view_from_buffer(uint8_t* data, int width, int height, int channels, size_t stride);
+
+// Deep copy of an image (always continuous, owns its data)
+ImageHandle* clone_image(ImageHandle* handle);
+
+// New handle on the same pixel data (reference counted, no copy)
+// The data is freed when the last handle is released. Do not use on views
+// created by create_image_view_from_buffer() (their data is not owned).
+ImageHandle* share_image(ImageHandle* handle);
+
 // Release image memory
 void release_image(ImageHandle* handle);
 
@@ -68,9 +82,19 @@ ImageHandle* convert_bgr_to_rgb(ImageHandle* handle);
 // Convert image to grayscale
 ImageHandle* convert_to_grayscale(ImageHandle* handle);
 
+// Convert grayscale image to BGR (e.g. to draw colored annotations)
+ImageHandle* convert_gray_to_bgr(ImageHandle* handle);
+
 // Save image to file
 int save_image(const char* path, ImageHandle* handle);
 
+// Save image to file with a JPEG quality (1-100, <= 0 = default 95, ignored for PNG)
+int save_image_with_quality(const char* path, ImageHandle* handle, int jpeg_quality);
+
+// Encode image to JPEG in memory (quality 1-100, swap_rb != 0 = swap red and blue first)
+// Returns the encoded bytes, valid until the next call on the same thread, NULL on error
+const uint8_t* encode_jpeg(ImageHandle* handle, int jpeg_quality, int swap_rb, size_t* size);
+
 // ArUco marker detection structures
 typedef struct {
     int id;
@@ -85,6 +109,10 @@ typedef struct {
 
 // ArUco functions
 ArucoDictionaryHandle* getPredefinedDictionary(int dict_id);
+// Dictionary holding only the given entries of a predefined dictionary
+// Fewer entries to match (and fewer false candidates); detections still report
+// the original IDs. Returns NULL if an ID is not in the predefined dictionary
+ArucoDictionaryHandle* createRestrictedDictionary(int dict_id, const int* ids, int count);
 DetectorParametersHandle* createDetectorParameters();
 ArucoDetectorHandle* createArucoDetector(ArucoDictionaryHandle* dict, DetectorParametersHandle* params);
 void releaseArucoDetector(ArucoDetectorHandle* detector);
@@ -111,8 +139,54 @@ void setPerspectiveRemoveIgnoredMarginPerCell(DetectorParametersHandle* params,
 #define CORNER_REFINE_CONTOUR 2
 #define CORNER_REFINE_APRILTAG 3
 
+// Rectangle in image coordinates (pixels)
+typedef struct {
+    int x;
+    int y;
+    int width;
+    int height;
+} RoiRect;
+
+// View on a rectangle of an image (clamped to the image, no copy)
+// The view shares the pixels of `handle`, it must not outlive them when
+// `handle` is a view created by create_image_view_from_buffer()
+// Returns NULL if the clamped rectangle is empty
+ImageHandle* create_image_roi_view(ImageHandle* handle, RoiRect rect);
+
 // Detect markers with confidence scores
 DetectionResult* detectMarkersWithConfidence(ArucoDetectorHandle* detector, ImageHandle* image);
+
+// Detect markers only inside the given regions (clamped to the image, no copy)
+// Corners are returned in full image coordinates, a marker seen by two
+// overlapping regions is reported once
+DetectionResult* detectMarkersInRegions(ArucoDetectorHandle* detector, ImageHandle* image,
+                                        const RoiRect* regions, int region_count);
+// Coarse-to-fine detection: candidates are found on the image downscaled by
+// `scale` (0 < scale < 1), then corners are refined with subpixel accuracy on
+// a full resolution crop around each marker. scale >= 1 is a plain detection
+// Corners are returned in full image coordinates
+DetectionResult* detectMarkersPyramid(ArucoDetectorHandle* detector, ImageHandle* image, float scale);
+// Parallel tiled detection: the image is split into tile_cols x tile_rows cores,
+// each core is extended by `overlap` pixels (at least the largest marker extent,
+// the threshold and refinement windows are added internally) and detected on its
+// own thread. Perimeter rates are rescaled to the tile so a marker fully inside
+// one tile gets the same corners as with a plain detection. A marker is reported
+// by the tile whose core holds its center, duplicates are merged by ID and distance
+// Corners are returned in full image coordinates
+DetectionResult* detectMarkersTiled(ArucoDetectorHandle* detector, ImageHandle* image,
+                                    int tile_cols, int tile_rows, int overlap);
+
+// Same detections written into a caller-provided result (no allocation of the result)
+// result->markers must hold `capacity` markers, detections beyond it are dropped
+// Return the number of markers written, -1 on error
+int detectMarkersInto(ArucoDetectorHandle* detector, ImageHandle* image, DetectionResult* result, int capacity);
+int detectMarkersInRegionsInto(ArucoDetectorHandle* detector, ImageHandle* image,
+                               const RoiRect* regions, int region_count, DetectionResult* result, int capacity);
+int detectMarkersPyramidInto(ArucoDetectorHandle* detector, ImageHandle* image, float scale,
+                             DetectionResult* result, int capacity);
+int detectMarkersTiledInto(ArucoDetectorHandle* detector, ImageHandle* image,
+                           int tile_cols, int tile_rows, int overlap, DetectionResult* result, int capacity);
+
 void releaseDetectionResult(DetectionResult* result);
 
 // Draw detected markers on an image
@@ -143,10 +217,41 @@ ImageHandle* sharpen_image_reuse(ImageHandle* src, ImageHandle* dst);
 // If dst is NULL, allocates new image. Returns dst or newly allocated image.
 ImageHandle* resize_image_reuse(ImageHandle* src, int new_width, int new_height, ImageHandle* dst);
 
+// Resize a BGR or gray image to BGR - reuse dst buffer if provided (reallocated on size mismatch)
+// The pixels are copied once, at the output size. Returns dst or newly allocated image.
+ImageHandle* resize_to_bgr_reuse(ImageHandle* src, int new_width, int new_height, ImageHandle* dst);
+
 // Apply mask - reuse dst buffer if provided (must be same size as src)
 // If dst is NULL, allocates new image. Returns dst or newly allocated image.
 ImageHandle* bitwise_and_mask_reuse(ImageHandle* src, ImageHandle* mask, ImageHandle* dst);
 
+// Fused preprocessing: sharpen + mask + grayscale in a single pass over src
+// src is 8-bit BGR or gray, mask is single channel (NULL = no mask)
+// Output is 8-bit gray; dst is reused if provided (reallocated on size/type mismatch)
+// Uses NEON on ARM, integer arithmetic everywhere
+ImageHandle* sharpen_mask_gray_reuse(ImageHandle* src, ImageHandle* mask, ImageHandle* dst);
+
+// ===== Image Pool (no allocation once warmed up) =====
+
+// Fixed set of image headers and buffers shared by several threads
+// Pool images are regular handles, but must go back with image_pool_release()
+// When the pool is exhausted, images are allocated normally (and released the same way)
+typedef struct ImagePool ImagePool;
+
+ImagePool* image_pool_create(int capacity);
+// All images must have been released
+void image_pool_destroy(ImagePool* pool);
+
+// Owned image; a released buffer of the same geometry is reused (pixels are not cleared)
+ImageHandle* image_pool_acquire(ImagePool* pool, int width, int height, int channels);
+// Owned copy of src in a pooled buffer
+ImageHandle* image_pool_acquire_copy(ImagePool* pool, ImageHandle* src);
+// View on an external buffer, like create_image_view_from_buffer()
+ImageHandle* image_pool_acquire_view(ImagePool* pool, uint8_t* data, int width, int height, int channels, size_t stride);
+// View on a rectangle of an image, like create_image_roi_view()
+ImageHandle* image_pool_acquire_roi_view(ImagePool* pool, ImageHandle* handle, RoiRect rect);
+void image_pool_release(ImagePool* pool, ImageHandle* image);
+
 // ===== Drawing Functions =====
 
 // Color structure for drawing
@@ -198,6 +303,14 @@ Point2f* fisheye_undistort_points(Point2f* points, int num_points,
                                    float* dist_coeffs,     // 4 coefficients
                                    float* output_camera_matrix);  // 3x3 matrix (can be NULL)
 
+// Batched variant without allocations: writes num_points points to out
+// (out may alias points). Returns 0 on success, -1 on error
+int fisheye_undistort_points_into(const Point2f* points, int num_points,
+                                  const float* camera_matrix,         // 3x3 matrix
+                                  const float* dist_coeffs,           // 4 coefficients
+                                  const float* output_camera_matrix,  // 3x3 matrix (can be NULL)
+                                  Point2f* out);
+
 // Find homography matrix between two sets of points
 // Returns 3x3 homography matrix (caller must free)
 float* find_homography(Point2f* src_points, Point2f* dst_points, int num_points);
@@ -205,6 +318,10 @@ float* find_homography(Point2f* src_points, Point2f* dst_points, int num_points)
 // Apply perspective transform to points
 Point2f* perspective_transform(Point2f* points, int num_points, float* homography);
 
+// Batched variant without allocations: writes num_points points to out
+// (out may alias points). Returns 0 on success, -1 on error
+int perspective_transform_into(const Point2f* points, int num_points, const float* homography, Point2f* out);
+
 // ===== Pose Estimation =====
 
 // SolvePnP result structure
@@ -218,6 +335,17 @@ typedef struct {
 PnPResult solve_pnp(Point3f* object_points, Point2f* image_points, int num_points,
                     float* camera_matrix, float* dist_coeffs);
 
+// Batched pose of square markers (IPPE_SQUARE), buffers reused from one call to the next
+// image_points: 4 corners per marker (ArUco order), marker_sizes: side of each marker (mm, <= 0 = skip)
+// dist_coeffs: fisheye coefficients, all corners are undistorted in one call (NULL = already undistorted)
+// guesses: previous pose of each marker (NULL, or success == 0 for none). IPPE gives two
+// solutions for a planar square: the one closest to the guess is kept while it reprojects
+// well (no flip from one frame to the next), the one with the lowest error otherwise
+// Returns the number of poses found (out[i].success), -1 on error
+int solve_pnp_squares_into(const Point2f* image_points, const float* marker_sizes, int count,
+                           const float* camera_matrix, const float* dist_coeffs,
+                           const PnPResult* guesses, PnPResult* out);
+
 // Free allocated arrays
 void free_points_2f(Point2f* points);
 void free_points_3f(Point3f* points);
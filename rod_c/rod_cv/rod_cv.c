@@ -29,8 +29,24 @@
 #define M_PI 3.14159265358979323846
 #endif
 
+// Number of markers undistorted/projected per batch in localize_markers_in_playground()
+#define LOCALIZE_BATCH_SIZE 64
+#define POSE_BATCH_SIZE 32        // Markers solved per batch in estimate_marker_poses()
+#define EXTENT_GRID_SIZE 8        // Samples per side of the area for estimate_marker_extent_px
+#define EXTENT_STEP_PX 4.0f       // Finite difference step in pixels
+#define EXTENT_MAX_MARKER_ID 64   // Marker IDs scanned for the largest size
+#define FIXED_TAG_FIRST_ID 20     // Fixed tags are IDs 20 to 20 + ROD_FIXED_MARKER_COUNT - 1
+
 /* ************************************************** Public types definition ******************************************** */
 
+// Known real-world positions of fixed tags (in mm), tag order (ID 20 first)
+static const Point2f FIXED_TAG_POSITIONS[ROD_FIXED_MARKER_COUNT] = {
+    {600, 600},    // ID 20
+    {600, 2400},   // ID 21
+    {1400, 600},   // ID 22
+    {1400, 2400}   // ID 23
+};
+
 /* *********************************************** Public functions declarations ***************************************** */
 
 /* ******************************************* Public callback functions declarations ************************************ */
@@ -123,6 +139,7 @@ int filter_valid_markers(DetectionResult* result, MarkerData* filtered_markers,
         filtered_markers[valid_count].angle = angle;
         filtered_markers[valid_count].pixel_x = center.x;  // Same as x for this function
         filtered_markers[valid_count].pixel_y = center.y;  // Same as y for this function
+        filtered_markers[valid_count].age_us = 0;
         valid_count++;
     }
     
@@ -157,26 +174,97 @@ PnPResult estimate_marker_pose_camera_frame(float corners[4][2],
                                              float marker_size,
                                              const float* camera_matrix,
                                              const float* dist_coeffs) {
-    // Define 3D points of marker corners in marker's local coordinate system
     // Corner order matches OpenCV ArUco detection (top-left, top-right, bottom-right, bottom-left)
-    float half_size = marker_size / 2.0f;
-    Point3f object_points[4] = {
-        {-half_size, half_size, 0.0f},   // Top-left
-        {half_size, half_size, 0.0f},    // Top-right
-        {half_size, -half_size, 0.0f},   // Bottom-right
-        {-half_size, -half_size, 0.0f}   // Bottom-left
-    };
-    
-    // Convert corners to Point2f array
     Point2f image_points[4];
     for (int i = 0; i < 4; i++) {
         image_points[i].x = corners[i][0];
         image_points[i].y = corners[i][1];
     }
     
-    // Call OpenCV wrapper's solve_pnp
-    return solve_pnp(object_points, image_points, 4, 
-                     (float*)camera_matrix, (float*)dist_coeffs);
+    // Batch of one marker
+    PnPResult result = {{0, 0, 0}, {0, 0, 0}, 0};
+    solve_pnp_squares_into(image_points, &marker_size, 1, camera_matrix, dist_coeffs, NULL, &result);
+    return result;
+}
+
+/**
+ * @brief Previous pose of the same marker nearest to a center, within ROD_POSE_WARM_START_GATE_PX
+ * @return Guess with success = 1, or success = 0 if there is none
+ */
+static PnPResult find_previous_pose(const MarkerPose* previous, int previous_count, int id, Point2f center) {
+    PnPResult guess = {{0, 0, 0}, {0, 0, 0}, 0};
+    float best_distance = ROD_POSE_WARM_START_GATE_PX;
+    for (int p = 0; p < previous_count; p++) {
+        if (previous[p].id != id) continue;
+        float distance = hypotf(previous[p].pixel_x - center.x, previous[p].pixel_y - center.y);
+        if (distance <= best_distance) {
+            best_distance = distance;
+            memcpy(guess.rvec, previous[p].rvec, sizeof(guess.rvec));
+            memcpy(guess.tvec, previous[p].tvec, sizeof(guess.tvec));
+            guess.success = 1;
+        }
+    }
+    return guess;
+}
+
+int estimate_marker_poses(const DetectionResult* detection, int min_id, int max_id,
+                          const float* camera_matrix, const float* dist_coeffs,
+                          const MarkerPose* previous, int previous_count,
+                          MarkerPose* poses, int max_poses) {
+    if (!detection || !camera_matrix || !poses || max_poses <= 0 ||
+        previous_count < 0 || (previous_count > 0 && !previous)) {
+        return -1;
+    }
+    
+    // Stack buffers: one undistortion call and no allocation per batch
+    Point2f corners[POSE_BATCH_SIZE * 4];
+    Point2f centers[POSE_BATCH_SIZE];
+    float sizes[POSE_BATCH_SIZE];
+    int ids[POSE_BATCH_SIZE];
+    PnPResult guesses[POSE_BATCH_SIZE];
+    PnPResult results[POSE_BATCH_SIZE];
+    
+    int pose_count = 0;
+    int i = 0;
+    while (i < detection->count && pose_count < max_poses) {
+        int batch_count = 0;
+        for (; i < detection->count && batch_count < POSE_BATCH_SIZE && pose_count + batch_count < max_poses; i++) {
+            const DetectedMarker* marker = &detection->markers[i];
+            if (marker->id < min_id || marker->id > max_id) continue;
+            float size = rod_config_get_marker_size(marker->id);
+            if (size <= 0.0f) continue;
+            
+            Point2f center = {0.0f, 0.0f};
+            for (int k = 0; k < 4; k++) {
+                corners[batch_count * 4 + k].x = marker->corners[k][0];
+                corners[batch_count * 4 + k].y = marker->corners[k][1];
+                center.x += marker->corners[k][0] / 4.0f;
+                center.y += marker->corners[k][1] / 4.0f;
+            }
+            centers[batch_count] = center;
+            sizes[batch_count] = size;
+            ids[batch_count] = marker->id;
+            guesses[batch_count] = find_previous_pose(previous, previous_count, marker->id, center);
+            batch_count++;
+        }
+        if (batch_count == 0) break;
+        
+        if (solve_pnp_squares_into(corners, sizes, batch_count, camera_matrix, dist_coeffs, guesses, results) < 0) {
+            return -1;
+        }
+        
+        for (int b = 0; b < batch_count; b++) {
+            if (!results[b].success) continue;
+            MarkerPose* pose = &poses[pose_count++];
+            pose->id = ids[b];
+            pose->pixel_x = centers[b].x;
+            pose->pixel_y = centers[b].y;
+            memcpy(pose->rvec, results[b].rvec, sizeof(pose->rvec));
+            memcpy(pose->tvec, results[b].tvec, sizeof(pose->tvec));
+        }
+    }
+    
+    return pose_count;
 }
 
 int compute_camera_to_playground_transform(DetectionResult* detection,
@@ -197,43 +285,63 @@ int compute_camera_to_playground_transform(DetectionResult* detection,
         {23, 1400, 2400, 30}     // ID 23
     };
     
-    // Find fixed markers and get their camera frame positions
-    Point3f camera_points[4];
-    Point3f playground_points[4];
-    int found_count = 0;
+    // Gather the corners of the fixed markers (first detection of each ID)
+    Point2f corners[4 * 4];
+    float sizes[4];
+    int fixed_index[4];
+    int candidate_count = 0;
+    int seen[4] = {0, 0, 0, 0};
     
-    for (int i = 0; i < detection->count && found_count < 4; i++) {
+    for (int i = 0; i < detection->count && candidate_count < 4; i++) {
         int marker_id = detection->markers[i].id;
         
-        // Check if this is a fixed marker
         for (int j = 0; j < 4; j++) {
-            if (marker_id == (int)fixed_markers_playground[j][0]) {
-                // Estimate pose in camera frame
-                PnPResult pose = estimate_marker_pose_camera_frame(
-                    detection->markers[i].corners,
-                    marker_size,
-                    camera_matrix,
-                    dist_coeffs
-                );
-                
-                if (pose.success) {
-                    // Store camera frame position (tvec is the marker center in camera frame)
-                    camera_points[found_count].x = pose.tvec[0];
-                    camera_points[found_count].y = pose.tvec[1];
-                    camera_points[found_count].z = pose.tvec[2];
-                    
-                    // Store corresponding playground position
-                    playground_points[found_count].x = fixed_markers_playground[j][1];
-                    playground_points[found_count].y = fixed_markers_playground[j][2];
-                    playground_points[found_count].z = fixed_markers_playground[j][3];
-                    
-                    found_count++;
+            if (marker_id == (int)fixed_markers_playground[j][0] && !seen[j]) {
+                for (int k = 0; k < 4; k++) {
+                    corners[candidate_count * 4 + k].x = detection->markers[i].corners[k][0];
+                    corners[candidate_count * 4 + k].y = detection->markers[i].corners[k][1];
                 }
+                sizes[candidate_count] = marker_size;
+                fixed_index[candidate_count] = j;
+                seen[j] = 1;
+                candidate_count++;
                 break;
             }
         }
     }
     
+    // All four are needed below: not worth solving the poses of the others
+    if (candidate_count < 4) {
+        fprintf(stderr, "compute_camera_to_playground_transform: only %d/4 fixed markers found\n", candidate_count);
+        return -1;
+    }
+
+    // Poses of all fixed markers in camera frame, in one call
+    PnPResult poses[4];
+    if (solve_pnp_squares_into(corners, sizes, candidate_count, camera_matrix, dist_coeffs, NULL, poses) < 0) {
+        return -1;
+    }
+    
+    Point3f camera_points[4];
+    Point3f playground_points[4];
+    int found_count = 0;
+    for (int c = 0; c < candidate_count; c++) {
+        if (!poses[c].success) continue;
+        int j = fixed_index[c];
+        
+        // Store camera frame position (tvec is the marker center in camera frame)
+        camera_points[found_count].x = poses[c].tvec[0];
+        camera_points[found_count].y = poses[c].tvec[1];
+        camera_points[found_count].z = poses[c].tvec[2];
+        
+        // Store corresponding playground position
+        playground_points[found_count].x = fixed_markers_playground[j][1];
+        playground_points[found_count].y = fixed_markers_playground[j][2];
+        playground_points[found_count].z = fixed_markers_playground[j][3];
+        
+        found_count++;
+    }
+    
     if (found_count < 4) {
         fprintf(stderr, "compute_camera_to_playground_transform: only %d/4 fixed markers found\n", found_count);
         return -1;
@@ -336,71 +444,194 @@ int localize_markers_in_playground(DetectionResult* detection,
         return -1;
     }
     
+    const float* K = rod_config_get_camera_matrix();
+    const float* D = rod_config_get_distortion_coeffs();
+    
+    // Markers are processed in batches so that undistortion and projection run
+    // once per batch on stack buffers (no per-marker allocation)
+    Point2f centers[LOCALIZE_BATCH_SIZE];
+    Point2f undistorted[LOCALIZE_BATCH_SIZE];
+    
     int valid_count = 0;
+    int i = 0;
     
-    for (int i = 0; i < detection->count && valid_count < max_markers; i++) {
-        DetectedMarker* marker = &detection->markers[i];
+    while (i < detection->count && valid_count < max_markers) {
+        int batch_start = valid_count;
+        int batch_count = 0;
         
-        // Only process valid marker IDs
-        if (!rod_config_is_valid_marker_id(marker->id)) {
-            continue;
+        // Gather a batch of valid markers
+        for (; i < detection->count && valid_count < max_markers && batch_count < LOCALIZE_BATCH_SIZE; i++) {
+            DetectedMarker* marker = &detection->markers[i];
+            
+            // Only process valid marker IDs
+            if (!rod_config_is_valid_marker_id(marker->id)) {
+                continue;
+            }
+            
+            Point2f pixel_center = calculate_marker_center(marker->corners);
+            centers[batch_count++] = pixel_center;
+            
+            markers[valid_count].id = marker->id;
+            markers[valid_count].angle = calculate_marker_angle(marker->corners);
+            markers[valid_count].pixel_x = pixel_center.x;  // X in pixels (for visualization)
+            markers[valid_count].pixel_y = pixel_center.y;  // Y in pixels (for visualization)
+            markers[valid_count].age_us = 0;
+            valid_count++;
         }
         
-        // Calculate pixel center from corners
-        Point2f pixel_center = calculate_marker_center(marker->corners);
-        float angle = calculate_marker_angle(marker->corners);
-        
-        // Undistort pixel point using fisheye model before applying homography
-        const float* K = rod_config_get_camera_matrix();
-        const float* D = rod_config_get_distortion_coeffs();
-        Point2f pixel_point = {pixel_center.x, pixel_center.y};
-        // Pass K as output matrix to keep points in pixel coordinates (like Python: undistortPoints(..., K, D, None, K))
-        Point2f* pixel_undistorted = fisheye_undistort_points(&pixel_point, 1, (float*)K, (float*)D, (float*)K);
-        
-        if (!pixel_undistorted) {
-            fprintf(stderr, "Warning: Failed to undistort point for marker ID %d\n", marker->id);
-            continue;
+        if (batch_count == 0) {
+            break;
         }
         
-        // Transform undistorted pixel coordinates to playground coordinates using homography
-        Point2f* terrain_point = perspective_transform(pixel_undistorted, 1, (float*)homography_inv);
-        free_points_2f(pixel_undistorted);
+        // Undistort with the fisheye model (K as output matrix keeps pixel coordinates,
+        // like Python: undistortPoints(..., K, D, None, K)), then apply the homography
+        int ret = fisheye_undistort_points_into(centers, batch_count, K, D, K, undistorted);
+        if (ret == 0) {
+            ret = perspective_transform_into(undistorted, batch_count, homography_inv, undistorted);
+        }
         
-        if (!terrain_point) {
+        for (int j = 0; j < batch_count; j++) {
             // Fallback: use pixel coordinates if transformation fails
-            markers[valid_count].id = marker->id;
-            markers[valid_count].x = pixel_center.x;
-            markers[valid_count].y = pixel_center.y;
-            markers[valid_count].angle = angle;
-            markers[valid_count].pixel_x = pixel_center.x;
-            markers[valid_count].pixel_y = pixel_center.y;
-            valid_count++;
-            continue;
+            Point2f terrain_point = (ret == 0) ? undistorted[j] : centers[j];
+            markers[batch_start + j].x = terrain_point.x;  // X in mm (terrain)
+            markers[batch_start + j].y = terrain_point.y;  // Y in mm (terrain)
         }
-        
-        // Store marker data with playground coordinates (mm) and pixel coordinates
-        markers[valid_count].id = marker->id;
-        markers[valid_count].x = terrain_point[0].x;  // X in mm (terrain)
-        markers[valid_count].y = terrain_point[0].y;  // Y in mm (terrain)
-        markers[valid_count].angle = angle;
-        markers[valid_count].pixel_x = pixel_center.x;  // X in pixels (for visualization)
-        markers[valid_count].pixel_y = pixel_center.y;  // Y in pixels (for visualization)
-        
-        // Free allocated memory
-        free_points_2f(terrain_point);
-        
-        valid_count++;
     }
     
     return valid_count;
 }
 
+int estimate_marker_extent_px(const float* homography_inv, RoiRect area) {
+    if (!homography_inv || area.width <= 0 || area.height <= 0) {
+        return -1;
+    }
+    
+    float marker_size = 0.0f;
+    for (int id = 0; id < EXTENT_MAX_MARKER_ID; id++) {
+        float size = rod_config_get_marker_size(id);
+        if (size > marker_size) marker_size = size;
+    }
+    if (marker_size <= 0.0f) {
+        return -1;
+    }
+    
+    const float* K = rod_config_get_camera_matrix();
+    const float* D = rod_config_get_distortion_coeffs();
+    
+    // Each sample is a point and its two neighbours along x and y
+    Point2f points[EXTENT_GRID_SIZE * EXTENT_GRID_SIZE * 3];
+    int count = 0;
+    for (int gy = 0; gy < EXTENT_GRID_SIZE; gy++) {
+        for (int gx = 0; gx < EXTENT_GRID_SIZE; gx++) {
+            float x = area.x + (area.width - EXTENT_STEP_PX) * gx / (float)(EXTENT_GRID_SIZE - 1);
+            float y = area.y + (area.height - EXTENT_STEP_PX) * gy / (float)(EXTENT_GRID_SIZE - 1);
+            points[count++] = (Point2f){x, y};
+            points[count++] = (Point2f){x + EXTENT_STEP_PX, y};
+            points[count++] = (Point2f){x, y + EXTENT_STEP_PX};
+        }
+    }
+    
+    if (fisheye_undistort_points_into(points, count, K, D, K, points) != 0 ||
+        perspective_transform_into(points, count, homography_inv, points) != 0) {
+        return -1;
+    }
+    
+    // Smallest singular value of the local Jacobian (mm per pixel) gives the
+    // direction in which a millimetre spans the most pixels
+    float min_mm_per_px = INFINITY;
+    for (int i = 0; i < count; i += 3) {
+        float a = (points[i + 1].x - points[i].x) / EXTENT_STEP_PX;
+        float c = (points[i + 1].y - points[i].y) / EXTENT_STEP_PX;
+        float b = (points[i + 2].x - points[i].x) / EXTENT_STEP_PX;
+        float d = (points[i + 2].y - points[i].y) / EXTENT_STEP_PX;
+        float sum = a * a + b * b + c * c + d * d;
+        float det = a * d - b * c;
+        float disc = sqrtf(fmaxf(sum * sum - 4.0f * det * det, 0.0f));
+        float sigma_min = sqrtf(fmaxf(0.5f * (sum - disc), 0.0f));
+        if (sigma_min > 0.0f && sigma_min < min_mm_per_px) {
+            min_mm_per_px = sigma_min;
+        }
+    }
+    if (!isfinite(min_mm_per_px)) {
+        return -1;
+    }
+    
+    return (int)ceilf(marker_size * (float)M_SQRT2 / min_mm_per_px);
+}
+
 ImageHandle* create_field_mask_from_image(ImageHandle* image,
                                            ArucoDetectorHandle* detector,
                                            int output_width, 
                                            int output_height,
                                            float scale_y,
                                            float* homography_inv) {
+    return create_field_mask_with_roi(image, detector, output_width, output_height, scale_y, homography_inv, NULL);
+}
+
+int find_fixed_marker_centers(const DetectionResult* detection, Point2f centers[ROD_FIXED_MARKER_COUNT]) {
+    if (!detection || !centers) return 0;
+    
+    int found = 0;
+    for (int i = 0; i < detection->count; i++) {
+        int tag = detection->markers[i].id - FIXED_TAG_FIRST_ID;
+        if (tag < 0 || tag >= ROD_FIXED_MARKER_COUNT || (found & (1 << tag))) continue;
+        centers[tag] = calculate_marker_center(detection->markers[i].corners);
+        found |= 1 << tag;
+    }
+    
+    return found;
+}
+
+int compute_field_homography(const Point2f centers[ROD_FIXED_MARKER_COUNT], float* homography, float* homography_inv) {
+    if (!centers) return -1;
+    
+    // Known real-world positions of fixed tags (in mm), tag order
+    Point2f src_pts[ROD_FIXED_MARKER_COUNT];
+    for (int i = 0; i < ROD_FIXED_MARKER_COUNT; i++) {
+        src_pts[i] = FIXED_TAG_POSITIONS[i];
+    }
+    
+    // Get calibration parameters
+    const float* K = rod_config_get_camera_matrix();
+    const float* D = rod_config_get_distortion_coeffs();
+    
+    // Undistort the image points before calculating homography
+    Point2f dst_pts_undistorted[ROD_FIXED_MARKER_COUNT];
+    if (fisheye_undistort_points_into(centers, ROD_FIXED_MARKER_COUNT, K, D, K, dst_pts_undistorted) != 0) {
+        fprintf(stderr, "compute_field_homography: failed to undistort points\n");
+        return -1;
+    }
+    
+    // Homography (real-world -> image) and inverse (image -> real-world)
+    if (homography) {
+        float* H = find_homography(src_pts, dst_pts_undistorted, ROD_FIXED_MARKER_COUNT);
+        if (!H) {
+            fprintf(stderr, "compute_field_homography: failed to calculate homography\n");
+            return -1;
+        }
+        memcpy(homography, H, 9 * sizeof(float));
+        free_matrix(H);
+    }
+    if (homography_inv) {
+        float* H_inv = find_homography(dst_pts_undistorted, src_pts, ROD_FIXED_MARKER_COUNT);
+        if (!H_inv) {
+            fprintf(stderr, "compute_field_homography: failed to calculate inverse homography\n");
+            return -1;
+        }
+        memcpy(homography_inv, H_inv, 9 * sizeof(float));
+        free_matrix(H_inv);
+    }
+    
+    return 0;
+}
+
+ImageHandle* create_field_mask_with_roi(ImageHandle* image,
+                                        ArucoDetectorHandle* detector,
+                                        int output_width,
+                                        int output_height,
+                                        float scale_y,
+                                        float* homography_inv,
+                                        RoiRect* field_roi) {
     if (!image || !detector) {
         fprintf(stderr, "create_field_mask_from_image: invalid parameters\n");
         return NULL;
@@ -415,82 +646,45 @@ ImageHandle* create_field_mask_from_image(ImageHandle* image,
         return NULL;
     }
     
-    // Known real-world positions of fixed tags (in mm)
-    // Tag ID -> (x, y) position
-    float tag_irl[4][3] = {
-        {20, 600, 600},
-        {21, 600, 2400},
-        {22, 1400, 600},
-        {23, 1400, 2400}
-    };
-    
-    // Find detected fixed tags and build point correspondences
-    Point2f src_pts[4];  // Real-world positions
-    Point2f dst_pts[4];  // Image positions
-    int found_count = 0;
-    
-    for (int i = 0; i < detection->count && found_count < 4; i++) {
-        int id = detection->markers[i].id;
-        
-        // Check if this is one of the fixed tags
-        for (int j = 0; j < 4; j++) {
-            if ((int)tag_irl[j][0] == id) {
-                // Store real-world position
-                src_pts[found_count].x = tag_irl[j][1];
-                src_pts[found_count].y = tag_irl[j][2];
-                
-                // Calculate marker center in image
-                Point2f center = calculate_marker_center(detection->markers[i].corners);
-                dst_pts[found_count].x = center.x;
-                dst_pts[found_count].y = center.y;
-                
-                found_count++;
-                break;
-            }
-        }
-    }
-    
+    // Find detected fixed tags
+    Point2f centers[ROD_FIXED_MARKER_COUNT];
+    int found = find_fixed_marker_centers(detection, centers);
     releaseDetectionResult(detection);
     
-    if (found_count != 4) {
+    if (found != ROD_FIXED_MARKERS_ALL) {
+        int found_count = 0;
+        for (int i = 0; i < ROD_FIXED_MARKER_COUNT; i++) {
+            if (found & (1 << i)) found_count++;
+        }
         fprintf(stderr, "create_field_mask: only %d/4 fixed tags detected\n", found_count);
         return NULL;
     }
     
-    // Get calibration parameters
-    const float* K = rod_config_get_camera_matrix();
-    const float* D = rod_config_get_distortion_coeffs();
-    
-    // Undistort the image points before calculating homography
-    Point2f* dst_pts_undistorted = fisheye_undistort_points(dst_pts, 4, 
-                                                             (float*)K, (float*)D, (float*)K);
-    if (!dst_pts_undistorted) {
-        fprintf(stderr, "create_field_mask: failed to undistort points\n");
+    float H[9];
+    float H_inv[9];
+    if (compute_field_homography(centers, H, homography_inv ? H_inv : NULL) != 0) {
+        fprintf(stderr, "create_field_mask: failed to calculate homography\n");
         return NULL;
     }
     
-    // Calculate homography (real-world -> image)
-    float* H = find_homography(src_pts, dst_pts_undistorted, 4);
-    free_points_2f(dst_pts_undistorted);
+    ImageHandle* mask = create_field_mask_from_homography(H, output_width, output_height, scale_y, field_roi);
     
-    if (!H) {
-        fprintf(stderr, "create_field_mask: failed to calculate homography\n");
-        return NULL;
+    // Store inverse homography if requested (for image -> real-world transformation)
+    if (mask && homography_inv) {
+        memcpy(homography_inv, H_inv, sizeof(H_inv));
     }
     
-    // Store inverse homography if requested (for image -> real-world transformation)
-    if (homography_inv) {
-        // Calculate inverse homography using simple matrix inversion
-        // For 3x3 matrix: inv(H) can be computed but we'll use find_homography with swapped points
-        Point2f* inv_dst_undistorted = fisheye_undistort_points(dst_pts, 4,
-                                                                 (float*)K, (float*)D, (float*)K);
-        float* H_inv = find_homography(inv_dst_undistorted, src_pts, 4);
-        free_points_2f(inv_dst_undistorted);
-        
-        if (H_inv) {
-            memcpy(homography_inv, H_inv, 9 * sizeof(float));
-            free_matrix(H_inv);
-        }
+    return mask;
+}
+
+ImageHandle* create_field_mask_from_homography(const float* homography,
+                                               int output_width,
+                                               int output_height,
+                                               float scale_y,
+                                               RoiRect* field_roi) {
+    if (!homography || output_width <= 0 || output_height <= 0) {
+        fprintf(stderr, "create_field_mask_from_homography: invalid parameters\n");
+        return NULL;
     }
     
     // Define field corners in real-world coordinates (2000mm x 3000mm)
@@ -502,10 +696,8 @@ ImageHandle* create_field_mask_from_image(ImageHandle* image,
     };
     
     // Transform field corners to image coordinates
-    Point2f* field_img = perspective_transform(field_corners, 4, H);
-    free_matrix(H);
-    
-    if (!field_img) {
+    Point2f field_img[4];
+    if (perspective_transform_into(field_corners, 4, homography, field_img) != 0) {
         fprintf(stderr, "create_field_mask: failed to transform field corners\n");
         return NULL;
     }
@@ -530,17 +722,21 @@ ImageHandle* create_field_mask_from_image(ImageHandle* image,
     ImageHandle* mask = create_empty_image(output_width, output_height, 1);
     if (!mask) {
         fprintf(stderr, "create_field_mask: failed to create mask image\n");
-        free_points_2f(field_img);
         return NULL;
     }
     
     // Convert Point2f array to float array for fill_poly
     float points[8];
+    float min_x = field_img[0].x, max_x = field_img[0].x;
+    float min_y = field_img[0].y, max_y = field_img[0].y;
     for (int i = 0; i < 4; i++) {
         points[i * 2] = field_img[i].x;
         points[i * 2 + 1] = field_img[i].y;
+        if (field_img[i].x < min_x) min_x = field_img[i].x;
+        if (field_img[i].x > max_x) max_x = field_img[i].x;
+        if (field_img[i].y < min_y) min_y = field_img[i].y;
+        if (field_img[i].y > max_y) max_y = field_img[i].y;
     }
-    free_points_2f(field_img);
     
     // Fill polygon with white (255)
     Color white = {255, 255, 255};
@@ -552,7 +748,27 @@ ImageHandle* create_field_mask_from_image(ImageHandle* image,
         return NULL;
     }
     
-    return filled_mask;
+    if (!field_roi) {
+        return filled_mask;
+    }
+    
+    // Bounding box of the (clipped) polygon, then keep only that part of the mask
+    field_roi->x = (int)floorf(min_x);
+    field_roi->y = (int)floorf(min_y);
+    field_roi->width = (int)ceilf(max_x) + 1 - field_roi->x;
+    field_roi->height = (int)ceilf(max_y) + 1 - field_roi->y;
+    
+    ImageHandle* mask_view = create_image_roi_view(filled_mask, *field_roi);
+    ImageHandle* cropped_mask = mask_view ? clone_image(mask_view) : NULL;
+    release_image(mask_view);
+    release_image(filled_mask);
+    
+    if (!cropped_mask) {
+        fprintf(stderr, "create_field_mask_from_image: failed to crop mask to field\n");
+        return NULL;
+    }
+    
+    return cropped_mask;
 }
 
 ImageHandle* create_field_mask(const char* image_path, 
@@ -15,6 +15,10 @@
 
 /* ***************************************************** Public macros *************************************************** */
 
+#define ROD_FIXED_MARKER_COUNT 4    // Fixed field tags, IDs 20-23
+#define ROD_FIXED_MARKERS_ALL 0xF   // find_fixed_marker_centers() mask when all of them are visible
+#define ROD_POSE_WARM_START_GATE_PX 40.0f  // estimate_marker_poses() previous pose search radius
+
 /* ************************************************** Public types definition ******************************************** */
 
 /**
@@ -27,6 +31,7 @@ typedef struct {
     float angle;     // Rotation angle in radians
     float pixel_x;   // X coordinate in image (pixels, for visualization)
     float pixel_y;   // Y coordinate in image (pixels, for visualization)
+    uint32_t age_us; // Time since the marker was measured (0 = this frame, > 0 = predicted by rod_marker_filter)
 } MarkerData;
 
 /**
@@ -53,6 +58,17 @@ typedef struct {
     float yaw;
 } Pose3D;
 
+/**
+ * @brief 3D pose of a marker in camera frame (estimate_marker_poses)
+ */
+typedef struct {
+    int id;
+    float pixel_x;   // Marker center in image (pixels), matches a marker from one frame to the next
+    float pixel_y;
+    float rvec[3];   // Rotation vector (marker -> camera)
+    float tvec[3];   // Marker center in camera frame (mm)
+} MarkerPose;
+
 /**
  * @brief Structure to hold 2D position and orientation
  */
@@ -146,6 +162,31 @@ PnPResult estimate_marker_pose_camera_frame(float corners[4][2],
                                              const float* camera_matrix,
                                              const float* dist_coeffs);
 
+/**
+ * @brief Estimate the 3D pose of every marker of a detection in one batch
+ * @param detection Detection result (pixel corners)
+ * @param min_id Smallest marker ID to estimate (e.g. 1 for robot markers)
+ * @param max_id Largest marker ID to estimate (e.g. 10 for robot markers)
+ * @param camera_matrix Camera intrinsic matrix (3x3)
+ * @param dist_coeffs Distortion coefficients (4 elements for fisheye)
+ * @param previous Poses of the previous frame, used as warm start (may be NULL)
+ * @param previous_count Number of previous poses
+ * @param poses Output poses (caller owned, must not alias previous)
+ * @param max_poses Output capacity
+ * @return Number of poses written, -1 on error
+ *
+ * Marker sizes come from rod_config_get_marker_size() (IDs without a size are
+ * skipped). Corners are undistorted in one call per batch and every marker is
+ * solved with IPPE_SQUARE (closed form, cheap enough for every frame). A marker
+ * with the same ID within ROD_POSE_WARM_START_GATE_PX of a previous pose keeps
+ * the IPPE solution closest to it, so planar ambiguity does not flip the pose
+ * from one frame to the next: pass the previous output back (double buffer).
+ */
+int estimate_marker_poses(const DetectionResult* detection, int min_id, int max_id,
+                          const float* camera_matrix, const float* dist_coeffs,
+                          const MarkerPose* previous, int previous_count,
+                          MarkerPose* poses, int max_poses);
+
 /**
  * @brief Compute transformation matrix from camera frame to playground frame
  * @param detection Detection result containing all markers
@@ -189,6 +230,9 @@ void transform_camera_to_playground(const float* camera_point,
  * 2. Applies homography transformation: (x_pixel, y_pixel) -> (x_mm, y_mm)
  * 3. Stores both pixel and terrain coordinates in MarkerData
  * 
+ * Undistortion and projection are batched (one call per group of markers,
+ * stack buffers only): no allocation per marker.
+ * 
  * Note: Uses 2D homography instead of 3D pose estimation for planar terrain
  */
 int localize_markers_in_playground(DetectionResult* detection,
@@ -196,6 +240,20 @@ int localize_markers_in_playground(DetectionResult* detection,
                                    int max_markers,
                                    const float* homography_inv);
 
+/**
+ * @brief Estimate the largest image extent of a marker over an image area
+ * @param homography_inv Inverse homography (undistorted image -> playground), 3x3
+ * @param area Image area to sample (e.g. the field bounding box), in image coordinates
+ * @return Diagonal in pixels of the largest marker (see rod_config_get_marker_size)
+ *         at the place of the area where the playground looks biggest, or -1 on failure
+ * 
+ * The local scale is measured on a grid of the area through the same
+ * fisheye undistortion + homography chain as localize_markers_in_playground.
+ * The value is for markers lying on the ground plane: callers add a margin
+ * for markers seen closer to the camera (on top of robots).
+ */
+int estimate_marker_extent_px(const float* homography_inv, RoiRect area);
+
 /**
  * @brief Create a mask for the playing field based on fixed markers
  * @param image_path Path to the image (for initial detection)
@@ -234,5 +292,54 @@ ImageHandle* create_field_mask_from_image(ImageHandle* image,
                                            float scale_y,
                                            float* homography_inv);
 
+/**
+ * @brief Create field mask cropped to the field bounding box
+ * @param field_roi Output bounding box of the projected field (with scale_y margin), in image coordinates
+ * @return Mask image of field_roi size (255=valid area, 0=masked), or NULL on failure
+ * 
+ * Same as create_field_mask_from_image, but the mask only covers field_roi:
+ * processing can run on a view of that rectangle and skip the pixels
+ * outside the field (see create_image_roi_view).
+ */
+ImageHandle* create_field_mask_with_roi(ImageHandle* image,
+                                        ArucoDetectorHandle* detector,
+                                        int output_width,
+                                        int output_height,
+                                        float scale_y,
+                                        float* homography_inv,
+                                        RoiRect* field_roi);
+
+
+/**
+ * @brief Find the centers of the fixed field tags (IDs 20-23) in a detection
+ * @param detection Detection result (pixel coordinates)
+ * @param centers Output centers in pixels, tag order (ID 20 first); only found tags are written
+ * @return Bit mask of the tags found (bit i = ID 20 + i), ROD_FIXED_MARKERS_ALL when all are visible
+ */
+int find_fixed_marker_centers(const DetectionResult* detection, Point2f centers[ROD_FIXED_MARKER_COUNT]);
+
+/**
+ * @brief Compute the field homography from the centers of the fixed tags
+ * @param centers Tag centers in pixels (distorted, as detected), tag order (ID 20 first)
+ * @param homography Output playground -> undistorted image homography 3x3 (NULL if not needed)
+ * @param homography_inv Output undistorted image -> playground homography 3x3 (NULL if not needed)
+ * @return 0 on success, -1 on failure
+ */
+int compute_field_homography(const Point2f centers[ROD_FIXED_MARKER_COUNT], float* homography, float* homography_inv);
+
+/**
+ * @brief Create the field mask from a playground -> image homography (no detection)
+ * @param homography Playground -> undistorted image homography 3x3 (see compute_field_homography)
+ * @param output_width Mask width (image width)
+ * @param output_height Mask height (image height)
+ * @param scale_y Vertical scaling of the field polygon around its center (margin)
+ * @param field_roi Output bounding box of the field, mask cropped to it (NULL = whole image mask)
+ * @return Mask image (255=valid area, 0=masked), or NULL on failure
+ */
+ImageHandle* create_field_mask_from_homography(const float* homography,
+                                               int output_width,
+                                               int output_height,
+                                               float scale_y,
+                                               RoiRect* field_roi);
 
 /* ******************************************* Public callback functions declarations ************************************ */
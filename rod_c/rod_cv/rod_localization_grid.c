@@ -0,0 +1,187 @@
+/**
+ * @file rod_localization_grid.c
+ * @brief Precomputed pixel -> playground lookup grid for ROD
+ * @author Noé Game
+ * @date 14/10/2026
+ * @see rod_localization_grid.h
+ * @copyright Cecill-C (Cf. LICENCE.txt)
+ */
+
+/* ******************************************************* Includes ****************************************************** */
+
+#include "rod_localization_grid.h"
+#include "../rod_config/rod_config.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* ***************************************************** Public macros *************************************************** */
+
+/* ************************************************** Public types definition ******************************************** */
+
+/**
+ * @brief Localization grid structure
+ */
+struct RodLocalizationGrid {
+    int width;                  // Image size covered by the grid
+    int height;
+    int cell_size;              // Node spacing in pixels
+    int cols;                   // Number of cells (nodes = (cols + 1) x (rows + 1))
+    int rows;
+    Point2f* nodes;             // Playground position of each node (mm), row-major
+    Point2f* scratch;           // Node pixel positions, then undistorted positions (build only)
+    float homography_inv[9];    // Homography the grid was built with
+    bool ready;
+};
+
+/* *********************************************** Public functions declarations ***************************************** */
+
+/* ******************************************* Public callback functions declarations ************************************ */
+
+/* ********************************************* Function implementations *********************************************** */
+
+RodLocalizationGrid* rod_localization_grid_create(int width, int height, int cell_size) {
+    if (width <= 0 || height <= 0 || cell_size <= 0) {
+        fprintf(stderr, "rod_localization_grid: Invalid parameters\n");
+        return NULL;
+    }
+    
+    RodLocalizationGrid* grid = (RodLocalizationGrid*)calloc(1, sizeof(RodLocalizationGrid));
+    if (!grid) {
+        fprintf(stderr, "rod_localization_grid: Failed to allocate grid\n");
+        return NULL;
+    }
+    
+    grid->width = width;
+    grid->height = height;
+    grid->cell_size = cell_size;
+    grid->cols = (width + cell_size - 1) / cell_size;
+    grid->rows = (height + cell_size - 1) / cell_size;
+    
+    size_t node_count = (size_t)(grid->cols + 1) * (size_t)(grid->rows + 1);
+    grid->nodes = (Point2f*)malloc(node_count * sizeof(Point2f));
+    grid->scratch = (Point2f*)malloc(node_count * sizeof(Point2f));
+    if (!grid->nodes || !grid->scratch) {
+        fprintf(stderr, "rod_localization_grid: Failed to allocate %zu nodes\n", node_count);
+        rod_localization_grid_destroy(grid);
+        return NULL;
+    }
+    
+    return grid;
+}
+
+void rod_localization_grid_destroy(RodLocalizationGrid* grid) {
+    if (!grid) return;
+    free(grid->nodes);
+    free(grid->scratch);
+    free(grid);
+}
+
+int rod_localization_grid_update(RodLocalizationGrid* grid, const float* homography_inv) {
+    if (!grid || !homography_inv) return -1;
+    
+    if (grid->ready && memcmp(grid->homography_inv, homography_inv, sizeof(grid->homography_inv)) == 0) {
+        return 0;
+    }
+    
+    // Sample every node with the exact path (undistort then project), in two batched calls
+    int stride = grid->cols + 1;
+    int node_count = stride * (grid->rows + 1);
+    for (int r = 0; r <= grid->rows; r++) {
+        for (int c = 0; c <= grid->cols; c++) {
+            grid->scratch[r * stride + c].x = (float)(c * grid->cell_size);
+            grid->scratch[r * stride + c].y = (float)(r * grid->cell_size);
+        }
+    }
+    
+    const float* K = rod_config_get_camera_matrix();
+    const float* D = rod_config_get_distortion_coeffs();
+    if (fisheye_undistort_points_into(grid->scratch, node_count, K, D, K, grid->nodes) != 0 ||
+        perspective_transform_into(grid->nodes, node_count, homography_inv, grid->nodes) != 0) {
+        fprintf(stderr, "rod_localization_grid: Failed to build grid\n");
+        grid->ready = false;
+        return -1;
+    }
+    
+    memcpy(grid->homography_inv, homography_inv, sizeof(grid->homography_inv));
+    grid->ready = true;
+    return 1;
+}
+
+bool rod_localization_grid_matches(const RodLocalizationGrid* grid, int width, int height) {
+    return grid && grid->width == width && grid->height == height;
+}
+
+int rod_localization_grid_lookup(const RodLocalizationGrid* grid, Point2f pixel, Point2f* terrain) {
+    if (!grid || !grid->ready || !terrain) return -1;
+    
+    // Outside the image: no nodes around, use the exact path (no allocation)
+    if (pixel.x < 0.0f || pixel.y < 0.0f || pixel.x > (float)grid->width || pixel.y > (float)grid->height) {
+        Point2f undistorted;
+        const float* K = rod_config_get_camera_matrix();
+        const float* D = rod_config_get_distortion_coeffs();
+        if (fisheye_undistort_points_into(&pixel, 1, K, D, K, &undistorted) != 0) return -1;
+        return perspective_transform_into(&undistorted, 1, grid->homography_inv, terrain);
+    }
+    
+    float fx = pixel.x / (float)grid->cell_size;
+    float fy = pixel.y / (float)grid->cell_size;
+    int c = (int)fx;
+    int r = (int)fy;
+    if (c >= grid->cols) c = grid->cols - 1;
+    if (r >= grid->rows) r = grid->rows - 1;
+    float tx = fx - (float)c;
+    float ty = fy - (float)r;
+    
+    int stride = grid->cols + 1;
+    const Point2f* p00 = &grid->nodes[r * stride + c];
+    const Point2f* p01 = p00 + 1;
+    const Point2f* p10 = p00 + stride;
+    const Point2f* p11 = p10 + 1;
+    
+    float top_x = p00->x + (p01->x - p00->x) * tx;
+    float top_y = p00->y + (p01->y - p00->y) * tx;
+    float bottom_x = p10->x + (p11->x - p10->x) * tx;
+    float bottom_y = p10->y + (p11->y - p10->y) * tx;
+    terrain->x = top_x + (bottom_x - top_x) * ty;
+    terrain->y = top_y + (bottom_y - top_y) * ty;
+    return 0;
+}
+
+int rod_localization_grid_localize_markers(const RodLocalizationGrid* grid,
+                                           DetectionResult* detection,
+                                           MarkerData* markers,
+                                           int max_markers) {
+    if (!grid || !grid->ready || !detection || !markers || max_markers <= 0) {
+        return -1;
+    }
+    
+    int valid_count = 0;
+    
+    for (int i = 0; i < detection->count && valid_count < max_markers; i++) {
+        DetectedMarker* marker = &detection->markers[i];
+        
+        // Only process valid marker IDs
+        if (!rod_config_is_valid_marker_id(marker->id)) {
+            continue;
+        }
+        
+        Point2f pixel_center = calculate_marker_center(marker->corners);
+        Point2f terrain_point;
+        if (rod_localization_grid_lookup(grid, pixel_center, &terrain_point) != 0) {
+            // Fallback: use pixel coordinates if transformation fails
+            terrain_point = pixel_center;
+        }
+        
+        markers[valid_count].id = marker->id;
+        markers[valid_count].x = terrain_point.x;     // X in mm (terrain)
+        markers[valid_count].y = terrain_point.y;     // Y in mm (terrain)
+        markers[valid_count].angle = calculate_marker_angle(marker->corners);
+        markers[valid_count].pixel_x = pixel_center.x;  // X in pixels (for visualization)
+        markers[valid_count].pixel_y = pixel_center.y;  // Y in pixels (for visualization)
+        markers[valid_count].age_us = 0;
+        valid_count++;
+    }
+    
+    return valid_count;
+}
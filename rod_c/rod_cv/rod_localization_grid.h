@@ -0,0 +1,89 @@
+/**
+ * @file rod_localization_grid.h
+ * @brief Precomputed pixel -> playground lookup grid for ROD
+ * @author Noé Game
+ * @date 14/10/2026
+ * @see rod_localization_grid.c
+ * @copyright Cecill-C (Cf. LICENCE.txt)
+ * 
+ * Localizing a marker means undistorting its center (fisheye model) and
+ * projecting it with the inverse homography. Both only depend on the pixel
+ * position, so this module samples them once on a regular grid of image
+ * nodes and answers lookups with a bilinear interpolation between the four
+ * surrounding nodes. The grid is rebuilt only when the homography changes.
+ */
+
+#pragma once
+
+/* ******************************************************* Includes ****************************************************** */
+
+#include "rod_cv.h"
+#include "opencv_wrapper.h"
+#include <stdbool.h>
+
+/* ***************************************************** Public macros *************************************************** */
+
+/* ************************************************** Public types definition ******************************************** */
+
+/**
+ * @brief Opaque localization grid
+ */
+typedef struct RodLocalizationGrid RodLocalizationGrid;
+
+/* *********************************************** Public functions declarations ***************************************** */
+
+/**
+ * @brief Create a localization grid covering a width x height image
+ * @param width Image width in pixels
+ * @param height Image height in pixels
+ * @param cell_size Distance between grid nodes in pixels
+ * @return Grid (not ready until rod_localization_grid_update()), or NULL on failure
+ */
+RodLocalizationGrid* rod_localization_grid_create(int width, int height, int cell_size);
+
+/**
+ * @brief Destroy a localization grid
+ * @param grid Localization grid
+ */
+void rod_localization_grid_destroy(RodLocalizationGrid* grid);
+
+/**
+ * @brief Rebuild the grid if the homography differs from the one it was built with
+ * @param grid Localization grid
+ * @param homography_inv Inverse homography (3x3) for pixel -> terrain transformation
+ * @return 1 if rebuilt, 0 if unchanged, -1 on error
+ */
+int rod_localization_grid_update(RodLocalizationGrid* grid, const float* homography_inv);
+
+/**
+ * @brief Check whether the grid covers a width x height image
+ * @param grid Localization grid
+ * @param width Image width in pixels
+ * @param height Image height in pixels
+ * @return true if the grid was created for this image size
+ */
+bool rod_localization_grid_matches(const RodLocalizationGrid* grid, int width, int height);
+
+/**
+ * @brief Convert a pixel position to playground coordinates (bilinear lookup)
+ * @param grid Localization grid (must have been updated)
+ * @param pixel Pixel position (distorted, as detected)
+ * @param terrain Output position in playground frame (mm)
+ * @return 0 on success, -1 if the grid is not ready
+ * 
+ * Positions outside the image are computed exactly instead of extrapolated.
+ */
+int rod_localization_grid_lookup(const RodLocalizationGrid* grid, Point2f pixel, Point2f* terrain);
+
+/**
+ * @brief Same as localize_markers_in_playground(), using the grid
+ * @param grid Localization grid (must have been updated)
+ * @param detection Detection result with pixel coordinates
+ * @param markers Output array of markers with playground coordinates (x,y in mm)
+ * @param max_markers Maximum number of markers to process
+ * @return Number of markers successfully localized, -1 on error
+ */
+int rod_localization_grid_localize_markers(const RodLocalizationGrid* grid,
+                                           DetectionResult* detection,
+                                           MarkerData* markers,
+                                           int max_markers);
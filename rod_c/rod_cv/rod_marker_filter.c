@@ -0,0 +1,247 @@
+/**
+ * @file rod_marker_filter.c
+ * @brief Per marker temporal filter (alpha-beta, constant velocity) for ROD
+ * @author Noé Game
+ * @date 14/10/2026
+ * @see rod_marker_filter.h
+ * @copyright Cecill-C (Cf. LICENCE.txt)
+ */
+
+/* ******************************************************* Includes ****************************************************** */
+
+#include "rod_marker_filter.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <stdbool.h>
+
+/* ***************************************************** Public macros *************************************************** */
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+#define MIN_DT_S 1e-4f  // Frames closer than this do not update velocities
+
+/* ************************************************** Public types definition ******************************************** */
+
+/**
+ * @brief One tracked marker
+ */
+typedef struct {
+    int id;
+    float x;                 // Filtered position (mm) at updated_us
+    float y;
+    float angle;             // Filtered angle (radians, -pi..pi)
+    float vx;                // Velocity (mm/s)
+    float vy;
+    float omega;             // Angular velocity (rad/s)
+    float pixel_x;           // Last measured pixel position
+    float pixel_y;
+    uint64_t updated_us;     // Time of the state
+    uint64_t measured_us;    // Time of the last measurement
+    int hits;                // Measurements since the track started
+    bool matched;            // Measured in the current frame
+} MarkerTrack;
+
+/**
+ * @brief Marker filter structure
+ */
+struct RodMarkerFilter {
+    float alpha;
+    float beta;
+    float gate_mm;
+    int confirm_hits;
+    uint64_t max_age_us;
+    float velocity_decay;
+    MarkerTrack tracks[ROD_MARKER_FILTER_MAX_TRACKS];
+    int track_count;
+};
+
+/* *********************************************** Public functions declarations ***************************************** */
+
+/* ******************************************* Public callback functions declarations ************************************ */
+
+/* ********************************************* Function implementations *********************************************** */
+
+static float wrap_angle(float angle) {
+    while (angle > (float)M_PI) angle -= 2.0f * (float)M_PI;
+    while (angle < -(float)M_PI) angle += 2.0f * (float)M_PI;
+    return angle;
+}
+
+RodMarkerFilter* rod_marker_filter_create(float alpha, float beta, float gate_mm, int confirm_hits,
+                                          int max_age_ms, float velocity_decay) {
+    if (alpha <= 0.0f || alpha > 1.0f || beta < 0.0f || beta >= 2.0f || gate_mm <= 0.0f ||
+        confirm_hits < 1 || max_age_ms < 0 || velocity_decay < 0.0f || velocity_decay > 1.0f) {
+        fprintf(stderr, "rod_marker_filter: Invalid parameters\n");
+        return NULL;
+    }
+
+    RodMarkerFilter* filter = (RodMarkerFilter*)calloc(1, sizeof(RodMarkerFilter));
+    if (!filter) {
+        fprintf(stderr, "rod_marker_filter: Failed to allocate filter\n");
+        return NULL;
+    }
+
+    filter->alpha = alpha;
+    filter->beta = beta;
+    filter->gate_mm = gate_mm;
+    filter->confirm_hits = confirm_hits;
+    filter->max_age_us = (uint64_t)max_age_ms * 1000ULL;
+    filter->velocity_decay = velocity_decay;
+    return filter;
+}
+
+void rod_marker_filter_destroy(RodMarkerFilter* filter) {
+    free(filter);
+}
+
+void rod_marker_filter_reset(RodMarkerFilter* filter) {
+    if (filter) filter->track_count = 0;
+}
+
+/**
+ * @brief Predict a track to a time (constant velocity)
+ */
+static void predict(const MarkerTrack* track, uint64_t timestamp_us, float* x, float* y, float* angle) {
+    float dt = timestamp_us > track->updated_us ? (float)(timestamp_us - track->updated_us) * 1e-6f : 0.0f;
+    *x = track->x + track->vx * dt;
+    *y = track->y + track->vy * dt;
+    *angle = wrap_angle(track->angle + track->omega * dt);
+}
+
+/**
+ * @brief Nearest unmatched track of the same ID within the gate
+ * @return Track index, -1 if none
+ */
+static int find_track(const RodMarkerFilter* filter, const MarkerData* marker, uint64_t timestamp_us) {
+    int best = -1;
+    float best_distance = filter->gate_mm;
+    for (int t = 0; t < filter->track_count; t++) {
+        const MarkerTrack* track = &filter->tracks[t];
+        if (track->id != marker->id || track->matched) continue;
+
+        float x, y, angle;
+        predict(track, timestamp_us, &x, &y, &angle);
+        float distance = hypotf(marker->x - x, marker->y - y);
+        if (distance <= best_distance) {
+            best_distance = distance;
+            best = t;
+        }
+    }
+    return best;
+}
+
+/**
+ * @brief Alpha-beta correction of a track with a measurement
+ */
+static void correct(const RodMarkerFilter* filter, MarkerTrack* track, const MarkerData* marker, uint64_t timestamp_us) {
+    float dt = timestamp_us > track->updated_us ? (float)(timestamp_us - track->updated_us) * 1e-6f : 0.0f;
+    float x, y, angle;
+    predict(track, timestamp_us, &x, &y, &angle);
+
+    float rx = marker->x - x;
+    float ry = marker->y - y;
+    float ra = wrap_angle(marker->angle - angle);
+    track->x = x + filter->alpha * rx;
+    track->y = y + filter->alpha * ry;
+    track->angle = wrap_angle(angle + filter->alpha * ra);
+    if (dt >= MIN_DT_S) {
+        track->vx += filter->beta / dt * rx;
+        track->vy += filter->beta / dt * ry;
+        track->omega += filter->beta / dt * ra;
+    }
+
+    track->pixel_x = marker->pixel_x;
+    track->pixel_y = marker->pixel_y;
+    track->updated_us = timestamp_us;
+    track->measured_us = timestamp_us;
+    track->hits++;
+    track->matched = true;
+}
+
+/**
+ * @brief Advance a track not measured in this frame
+ */
+static void coast(const RodMarkerFilter* filter, MarkerTrack* track, uint64_t timestamp_us) {
+    predict(track, timestamp_us, &track->x, &track->y, &track->angle);
+    track->vx *= filter->velocity_decay;
+    track->vy *= filter->velocity_decay;
+    track->omega *= filter->velocity_decay;
+    track->updated_us = timestamp_us;
+}
+
+static void start_track(RodMarkerFilter* filter, const MarkerData* marker, uint64_t timestamp_us) {
+    if (filter->track_count >= ROD_MARKER_FILTER_MAX_TRACKS) return;
+
+    MarkerTrack* track = &filter->tracks[filter->track_count++];
+    memset(track, 0, sizeof(*track));
+    track->id = marker->id;
+    track->x = marker->x;
+    track->y = marker->y;
+    track->angle = wrap_angle(marker->angle);
+    track->pixel_x = marker->pixel_x;
+    track->pixel_y = marker->pixel_y;
+    track->updated_us = timestamp_us;
+    track->measured_us = timestamp_us;
+    track->hits = 1;
+    track->matched = true;
+}
+
+int rod_marker_filter_update(RodMarkerFilter* filter, uint64_t timestamp_us,
+                             const MarkerData* measured, int count,
+                             MarkerData* output, int max_output) {
+    if (!filter || count < 0 || (count > 0 && !measured) || (max_output > 0 && !output)) return -1;
+
+    for (int t = 0; t < filter->track_count; t++) {
+        filter->tracks[t].matched = false;
+    }
+
+    // Existing tracks first, so that new tracks never steal a measurement from them
+    int track_count = filter->track_count;
+    bool used[ROD_MARKER_FILTER_MAX_TRACKS] = {false};
+    for (int m = 0; m < count && m < ROD_MARKER_FILTER_MAX_TRACKS; m++) {
+        int t = find_track(filter, &measured[m], timestamp_us);
+        if (t >= 0) {
+            correct(filter, &filter->tracks[t], &measured[m], timestamp_us);
+            used[m] = true;
+        }
+    }
+
+    // Misses coast, old tracks are dropped (swap with the last one)
+    for (int t = 0; t < track_count; t++) {
+        MarkerTrack* track = &filter->tracks[t];
+        if (track->matched) continue;
+        if (timestamp_us > track->measured_us && timestamp_us - track->measured_us > filter->max_age_us) {
+            *track = filter->tracks[--track_count];
+            t--;
+            continue;
+        }
+        coast(filter, track, timestamp_us);
+    }
+    filter->track_count = track_count;
+
+    // Measurements outside every gate start tentative tracks
+    for (int m = 0; m < count && m < ROD_MARKER_FILTER_MAX_TRACKS; m++) {
+        if (!used[m]) start_track(filter, &measured[m], timestamp_us);
+    }
+
+    int output_count = 0;
+    for (int t = 0; t < filter->track_count && output_count < max_output; t++) {
+        const MarkerTrack* track = &filter->tracks[t];
+        if (track->hits < filter->confirm_hits) continue;
+
+        MarkerData* marker = &output[output_count++];
+        marker->id = track->id;
+        marker->x = track->x;
+        marker->y = track->y;
+        marker->angle = track->angle;
+        marker->pixel_x = track->pixel_x;
+        marker->pixel_y = track->pixel_y;
+        marker->age_us = timestamp_us > track->measured_us ? (uint32_t)(timestamp_us - track->measured_us) : 0;
+    }
+
+    return output_count;
+}
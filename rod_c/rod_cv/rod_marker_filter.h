@@ -0,0 +1,82 @@
+/**
+ * @file rod_marker_filter.h
+ * @brief Per marker temporal filter (alpha-beta, constant velocity) for ROD
+ * @author Noé Game
+ * @date 14/10/2026
+ * @see rod_marker_filter.c
+ * @copyright Cecill-C (Cf. LICENCE.txt)
+ *
+ * localize_markers_in_playground() gives raw positions of one frame: they
+ * jitter, and a marker missed for one frame disappears. This module keeps one
+ * track per physical marker (same ID, nearest prediction) and filters
+ * (x, y, angle) with an alpha-beta filter on a constant velocity model:
+ * - Measurements farther than a gate from every prediction start a new track,
+ *   which is only published once confirmed (a single wrong reading is never sent)
+ * - A missed marker keeps being published at its predicted position, with its
+ *   velocity decaying, until it has not been measured for max_age_ms
+ * - Every output carries its age (time since its last measurement)
+ *
+ * Tracks live in a fixed array: updating never allocates.
+ */
+
+#pragma once
+
+/* ******************************************************* Includes ****************************************************** */
+
+#include "rod_cv.h"
+#include <stdint.h>
+
+/* ***************************************************** Public macros *************************************************** */
+
+#define ROD_MARKER_FILTER_MAX_TRACKS 128
+
+/* ************************************************** Public types definition ******************************************** */
+
+/**
+ * @brief Opaque marker filter
+ */
+typedef struct RodMarkerFilter RodMarkerFilter;
+
+/* *********************************************** Public functions declarations ***************************************** */
+
+/**
+ * @brief Create a marker filter
+ * @param alpha Position gain, 0 < alpha <= 1 (1 = no smoothing)
+ * @param beta Velocity gain, 0 <= beta < 2 (0 = no velocity, alpha^2 / (2 - alpha) is a good start)
+ * @param gate_mm Largest distance between a prediction and a measurement of the same marker
+ * @param confirm_hits Measurements needed before a new track is published (1 = immediately)
+ * @param max_age_ms Tracks not measured for longer are dropped
+ * @param velocity_decay Velocity kept per missed frame, 0 to 1 (0 = hold the last position)
+ * @return Filter, or NULL on failure
+ */
+RodMarkerFilter* rod_marker_filter_create(float alpha, float beta, float gate_mm, int confirm_hits,
+                                          int max_age_ms, float velocity_decay);
+
+/**
+ * @brief Destroy a marker filter
+ * @param filter Filter (NULL is ignored)
+ */
+void rod_marker_filter_destroy(RodMarkerFilter* filter);
+
+/**
+ * @brief Drop every track (e.g. after the homography changed)
+ * @param filter Filter
+ */
+void rod_marker_filter_reset(RodMarkerFilter* filter);
+
+/**
+ * @brief Filter the markers measured in one frame
+ * @param filter Filter
+ * @param timestamp_us Frame timestamp in microseconds (increasing from one call to the next)
+ * @param measured Markers measured in this frame, playground coordinates (may be NULL if count is 0)
+ * @param count Number of measured markers
+ * @param output Output filtered markers: confirmed tracks at timestamp_us, with their age_us
+ * @param max_output Output capacity
+ * @return Number of output markers, -1 on error
+ *
+ * Call it for every frame, with or without markers: misses age the tracks.
+ * Output pixel positions are the ones of the last measurement.
+ */
+int rod_marker_filter_update(RodMarkerFilter* filter, uint64_t timestamp_us,
+                             const MarkerData* measured, int count,
+                             MarkerData* output, int max_output);
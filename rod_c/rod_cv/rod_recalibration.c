@@ -0,0 +1,270 @@
+/**
+ * @file rod_recalibration.c
+ * @brief Background field recalibration (homography + field mask) for ROD
+ * @author Noé Game
+ * @date 14/10/2026
+ * @see rod_recalibration.h
+ * @copyright Cecill-C (Cf. LICENCE.txt)
+ */
+
+#define _GNU_SOURCE  // Required for SCHED_IDLE
+
+/* ******************************************************* Includes ****************************************************** */
+
+#include "rod_recalibration.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+
+/* ***************************************************** Public macros *************************************************** */
+
+#define FIELD_WIDTH_MM 2000.0f
+#define FIELD_HEIGHT_MM 3000.0f
+
+/* ************************************************** Public types definition ******************************************** */
+
+/**
+ * @brief Recalibrator structure
+ */
+struct RodRecalibrator {
+    bool crop_to_field;
+    float scale_y;
+    float drift_threshold_mm;
+
+    pthread_t thread;
+    pthread_mutex_t lock;      // Protects everything up to stop
+    pthread_cond_t cond;
+    Point2f samples[ROD_FIXED_MARKER_COUNT][ROD_RECALIBRATION_WINDOW];  // Ring of centers per tag
+    int sample_count[ROD_FIXED_MARKER_COUNT];
+    int sample_next[ROD_FIXED_MARKER_COUNT];
+    int new_samples;           // Frames submitted since the last estimate
+    bool has_reference;
+    float reference_inv[9];    // Homography in use (or handed over)
+    int width;
+    int height;
+    bool stop;
+
+    RodCalibration back;       // Owned by the thread while ready == 0, by the consumer otherwise
+    atomic_int ready;          // 1 = back holds a calibration not swapped in yet
+};
+
+/* *********************************************** Public functions declarations ***************************************** */
+
+/* ******************************************* Public callback functions declarations ************************************ */
+
+/* ********************************************* Function implementations *********************************************** */
+
+static float median(float* values, int count) {
+    // Insertion sort: count is at most ROD_RECALIBRATION_WINDOW
+    for (int i = 1; i < count; i++) {
+        float value = values[i];
+        int j = i - 1;
+        while (j >= 0 && values[j] > value) {
+            values[j + 1] = values[j];
+            j--;
+        }
+        values[j + 1] = value;
+    }
+    return (count % 2) ? values[count / 2] : 0.5f * (values[count / 2 - 1] + values[count / 2]);
+}
+
+/**
+ * @brief Largest error of a homography at the field corners, measured through a candidate
+ * @return Distance in mm between each field corner and its position seen through
+ *         candidate (playground -> image) then reference_inv (image -> playground), -1 on failure
+ */
+static float field_corner_error(const float* candidate, const float* reference_inv) {
+    Point2f corners[4] = {
+        {0.0f, 0.0f},
+        {FIELD_WIDTH_MM, 0.0f},
+        {FIELD_WIDTH_MM, FIELD_HEIGHT_MM},
+        {0.0f, FIELD_HEIGHT_MM}
+    };
+    Point2f image[4];
+    Point2f seen[4];
+    if (perspective_transform_into(corners, 4, candidate, image) != 0 ||
+        perspective_transform_into(image, 4, reference_inv, seen) != 0) {
+        return -1.0f;
+    }
+
+    float error = 0.0f;
+    for (int i = 0; i < 4; i++) {
+        error = fmaxf(error, hypotf(seen[i].x - corners[i].x, seen[i].y - corners[i].y));
+    }
+    return error;
+}
+
+/**
+ * @brief Estimate the tag centers, and build a new calibration if the reference drifted
+ * @return true if a calibration was handed over
+ */
+static bool recalibrate(RodRecalibrator* recal, Point2f samples[ROD_FIXED_MARKER_COUNT][ROD_RECALIBRATION_WINDOW],
+                        const int* sample_count, const float* reference_inv, int width, int height) {
+    // The previous calibration was not swapped in yet: back is not ours
+    if (atomic_load_explicit(&recal->ready, memory_order_acquire)) return false;
+
+    // Robust center of each tag: per coordinate median of the window
+    Point2f centers[ROD_FIXED_MARKER_COUNT];
+    float values[ROD_RECALIBRATION_WINDOW];
+    for (int i = 0; i < ROD_FIXED_MARKER_COUNT; i++) {
+        if (sample_count[i] < ROD_RECALIBRATION_MIN_SAMPLES) return false;
+        for (int k = 0; k < sample_count[i]; k++) values[k] = samples[i][k].x;
+        centers[i].x = median(values, sample_count[i]);
+        for (int k = 0; k < sample_count[i]; k++) values[k] = samples[i][k].y;
+        centers[i].y = median(values, sample_count[i]);
+    }
+
+    float H[9];
+    float H_inv[9];
+    if (compute_field_homography(centers, H, H_inv) != 0) return false;
+
+    float drift = field_corner_error(H, reference_inv);
+    if (drift < 0.0f || drift <= recal->drift_threshold_mm) return false;
+
+    RoiRect roi = {0, 0, width, height};
+    ImageHandle* mask = create_field_mask_from_homography(H, width, height, recal->scale_y,
+                                                          recal->crop_to_field ? &roi : NULL);
+    if (!mask) return false;
+
+    // Fill the back buffer (the mask it holds was retired by the last swap)
+    release_image(recal->back.field_mask);
+    recal->back.field_mask = mask;
+    recal->back.field_roi = roi;
+    memcpy(recal->back.homography_inv, H_inv, sizeof(H_inv));
+    recal->back.drift_mm = drift;
+    atomic_store_explicit(&recal->ready, 1, memory_order_release);
+
+    pthread_mutex_lock(&recal->lock);
+    memcpy(recal->reference_inv, H_inv, sizeof(H_inv));
+    pthread_mutex_unlock(&recal->lock);
+    return true;
+}
+
+static void* recalibration_thread_main(void* arg) {
+    RodRecalibrator* recal = (RodRecalibrator*)arg;
+
+    // Only use otherwise idle CPU time (best effort)
+    struct sched_param param = {0};
+    if (pthread_setschedparam(pthread_self(), SCHED_IDLE, &param) != 0) {
+        fprintf(stderr, "rod_recalibration: SCHED_IDLE not available, running at normal priority\n");
+    }
+
+    Point2f samples[ROD_FIXED_MARKER_COUNT][ROD_RECALIBRATION_WINDOW];
+    int sample_count[ROD_FIXED_MARKER_COUNT];
+    float reference_inv[9];
+
+    pthread_mutex_lock(&recal->lock);
+    while (!recal->stop) {
+        if (!recal->has_reference || recal->new_samples < ROD_RECALIBRATION_WINDOW) {
+            pthread_cond_wait(&recal->cond, &recal->lock);
+            continue;
+        }
+
+        // Copy the windows and estimate without holding the lock
+        memcpy(samples, recal->samples, sizeof(samples));
+        memcpy(sample_count, recal->sample_count, sizeof(sample_count));
+        memcpy(reference_inv, recal->reference_inv, sizeof(reference_inv));
+        int width = recal->width;
+        int height = recal->height;
+        recal->new_samples = 0;
+        pthread_mutex_unlock(&recal->lock);
+
+        recalibrate(recal, samples, sample_count, reference_inv, width, height);
+
+        pthread_mutex_lock(&recal->lock);
+    }
+    pthread_mutex_unlock(&recal->lock);
+
+    return NULL;
+}
+
+RodRecalibrator* rod_recalibrator_create(bool crop_to_field, float scale_y, float drift_threshold_mm) {
+    if (scale_y <= 0.0f || drift_threshold_mm <= 0.0f) {
+        fprintf(stderr, "rod_recalibration: Invalid parameters\n");
+        return NULL;
+    }
+
+    RodRecalibrator* recal = (RodRecalibrator*)calloc(1, sizeof(RodRecalibrator));
+    if (!recal) {
+        fprintf(stderr, "rod_recalibration: Failed to allocate recalibrator\n");
+        return NULL;
+    }
+    recal->crop_to_field = crop_to_field;
+    recal->scale_y = scale_y;
+    recal->drift_threshold_mm = drift_threshold_mm;
+    atomic_init(&recal->ready, 0);
+    pthread_mutex_init(&recal->lock, NULL);
+    pthread_cond_init(&recal->cond, NULL);
+
+    if (pthread_create(&recal->thread, NULL, recalibration_thread_main, recal) != 0) {
+        fprintf(stderr, "rod_recalibration: Failed to start recalibration thread\n");
+        pthread_cond_destroy(&recal->cond);
+        pthread_mutex_destroy(&recal->lock);
+        free(recal);
+        return NULL;
+    }
+
+    return recal;
+}
+
+void rod_recalibrator_destroy(RodRecalibrator* recal) {
+    if (!recal) return;
+
+    pthread_mutex_lock(&recal->lock);
+    recal->stop = true;
+    pthread_cond_signal(&recal->cond);
+    pthread_mutex_unlock(&recal->lock);
+    pthread_join(recal->thread, NULL);
+
+    release_image(recal->back.field_mask);
+    pthread_cond_destroy(&recal->cond);
+    pthread_mutex_destroy(&recal->lock);
+    free(recal);
+}
+
+void rod_recalibrator_set_reference(RodRecalibrator* recal, const float* homography_inv, int width, int height) {
+    if (!recal || !homography_inv || width <= 0 || height <= 0) return;
+
+    pthread_mutex_lock(&recal->lock);
+    memcpy(recal->reference_inv, homography_inv, sizeof(recal->reference_inv));
+    recal->width = width;
+    recal->height = height;
+    recal->has_reference = true;
+    pthread_mutex_unlock(&recal->lock);
+}
+
+void rod_recalibrator_submit(RodRecalibrator* recal, const DetectionResult* detection) {
+    if (!recal || !detection) return;
+
+    Point2f centers[ROD_FIXED_MARKER_COUNT];
+    int found = find_fixed_marker_centers(detection, centers);
+    if (found == 0) return;
+
+    // The thread only holds the lock to copy the windows: skipping a frame is harmless
+    if (pthread_mutex_trylock(&recal->lock) != 0) return;
+    for (int i = 0; i < ROD_FIXED_MARKER_COUNT; i++) {
+        if (!(found & (1 << i))) continue;
+        recal->samples[i][recal->sample_next[i]] = centers[i];
+        recal->sample_next[i] = (recal->sample_next[i] + 1) % ROD_RECALIBRATION_WINDOW;
+        if (recal->sample_count[i] < ROD_RECALIBRATION_WINDOW) recal->sample_count[i]++;
+    }
+    if (++recal->new_samples >= ROD_RECALIBRATION_WINDOW) {
+        pthread_cond_signal(&recal->cond);
+    }
+    pthread_mutex_unlock(&recal->lock);
+}
+
+bool rod_recalibrator_swap(RodRecalibrator* recal, RodCalibration* active) {
+    if (!recal || !active) return false;
+    if (!atomic_load_explicit(&recal->ready, memory_order_acquire)) return false;
+
+    RodCalibration retired = *active;
+    *active = recal->back;
+    recal->back = retired;
+    atomic_store_explicit(&recal->ready, 0, memory_order_release);
+    return true;
+}
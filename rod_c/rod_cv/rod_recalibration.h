@@ -0,0 +1,97 @@
+/**
+ * @file rod_recalibration.h
+ * @brief Background field recalibration (homography + field mask) for ROD
+ * @author Noé Game
+ * @date 14/10/2026
+ * @see rod_recalibration.c
+ * @copyright Cecill-C (Cf. LICENCE.txt)
+ *
+ * The field mask and homography are computed once from the first frame
+ * showing the four fixed tags. If the camera moves afterwards, every
+ * position drifts. This module watches the fixed tag centers the pipeline
+ * already detects in each frame and re-calibrates on a low priority thread:
+ * - submit() only copies four centers (never blocks, skipped when busy)
+ * - The thread keeps the median of the last ROD_RECALIBRATION_WINDOW
+ *   centers of each tag (one bad detection does not move it)
+ * - When the current homography is off by more than a threshold at the
+ *   field corners, a new homography and mask are built off the hot path
+ * - Double buffer: the new calibration is handed over with one atomic flag,
+ *   swap() exchanges it with the one in use (the old mask is freed by the thread)
+ */
+
+#pragma once
+
+/* ******************************************************* Includes ****************************************************** */
+
+#include "rod_cv.h"
+#include "opencv_wrapper.h"
+#include <stdbool.h>
+
+/* ***************************************************** Public macros *************************************************** */
+
+#define ROD_RECALIBRATION_WINDOW 15        // Centers kept per tag (median window)
+#define ROD_RECALIBRATION_MIN_SAMPLES 8    // Centers needed per tag before estimating
+
+/* ************************************************** Public types definition ******************************************** */
+
+/**
+ * @brief Field calibration: what the preprocess and publish stages need
+ */
+typedef struct {
+    ImageHandle* field_mask;   // Field mask, field_roi sized
+    RoiRect field_roi;         // Field bounding box in frame coordinates (whole frame when not cropped)
+    float homography_inv[9];   // Undistorted image -> playground homography
+    float drift_mm;            // Error of the previous homography at the field corners
+} RodCalibration;
+
+/**
+ * @brief Opaque background recalibrator
+ */
+typedef struct RodRecalibrator RodRecalibrator;
+
+/* *********************************************** Public functions declarations ***************************************** */
+
+/**
+ * @brief Create a recalibrator and start its low priority thread
+ * @param crop_to_field true = masks cropped to the field bounding box, false = whole frame masks
+ * @param scale_y Vertical margin of the field polygon (see create_field_mask_with_roi)
+ * @param drift_threshold_mm Field corner error that triggers a new calibration
+ * @return Recalibrator (idle until rod_recalibrator_set_reference()), or NULL on failure
+ */
+RodRecalibrator* rod_recalibrator_create(bool crop_to_field, float scale_y, float drift_threshold_mm);
+
+/**
+ * @brief Stop the thread and destroy the recalibrator
+ * @param recal Recalibrator (NULL is ignored)
+ *
+ * A calibration not yet swapped in is released.
+ */
+void rod_recalibrator_destroy(RodRecalibrator* recal);
+
+/**
+ * @brief Set the calibration in use (once the first field mask exists)
+ * @param recal Recalibrator
+ * @param homography_inv Undistorted image -> playground homography in use
+ * @param width Frame width in pixels
+ * @param height Frame height in pixels
+ */
+void rod_recalibrator_set_reference(RodRecalibrator* recal, const float* homography_inv, int width, int height);
+
+/**
+ * @brief Give the fixed tags of a frame to the recalibrator
+ * @param recal Recalibrator (NULL is ignored)
+ * @param detection Detection result in frame coordinates
+ *
+ * Never blocks: the frame is skipped if the thread holds the sample lock.
+ */
+void rod_recalibrator_submit(RodRecalibrator* recal, const DetectionResult* detection);
+
+/**
+ * @brief Swap in a new calibration if one is ready
+ * @param recal Recalibrator (NULL is ignored)
+ * @param active Calibration in use, replaced by the new one (the old one goes back to the recalibrator)
+ * @return true if active was replaced
+ *
+ * Lock free, meant for a single consumer thread.
+ */
+bool rod_recalibrator_swap(RodRecalibrator* recal, RodCalibration* active);
@@ -0,0 +1,311 @@
+/**
+ * @file rod_roi_tracker.c
+ * @brief ROI-tracked incremental ArUco detection for ROD
+ * @author Noé Game
+ * @date 14/10/2026
+ * @see rod_roi_tracker.h
+ * @copyright Cecill-C (Cf. LICENCE.txt)
+ */
+
+/* ******************************************************* Includes ****************************************************** */
+
+#include "rod_roi_tracker.h"
+#include "rod_cv.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+/* ***************************************************** Public macros *************************************************** */
+
+// Minimum padding around a marker in pixels (covers fast moves of small markers)
+#define ROI_MIN_PADDING_PX 32
+
+/* ************************************************** Public types definition ******************************************** */
+
+/**
+ * @brief Last known position of one marker
+ */
+typedef struct {
+    int id;
+    float corners[4][2];
+} TrackedMarker;
+
+/**
+ * @brief ROI tracker structure
+ */
+struct RodRoiTracker {
+    TrackedMarker tracks[ROD_ROI_TRACKER_MAX_TRACKS];
+    int track_count;
+    RoiRect regions[ROD_ROI_TRACKER_MAX_TRACKS];
+    int full_scan_interval;
+    float padding_ratio;
+    float pyramid_scale;          // Full-frame scan coarse level scale (1.0 = plain detection)
+    int tiles_x;                  // Full-frame scan tiling (1 x 1 = single call detection)
+    int tiles_y;
+    int tile_overlap;             // Tile overlap in pixels
+    int frames_since_full_scan;
+    RodRoiTrackerStats stats;
+};
+
+/* *********************************************** Public functions declarations ***************************************** */
+
+/* ******************************************* Public callback functions declarations ************************************ */
+
+/* ********************************************* Function implementations *********************************************** */
+
+RodRoiTracker* rod_roi_tracker_create(int full_scan_interval, float padding_ratio) {
+    if (full_scan_interval < 1 || padding_ratio < 0.0f) {
+        fprintf(stderr, "rod_roi_tracker: Invalid parameters\n");
+        return NULL;
+    }
+    
+    RodRoiTracker* tracker = (RodRoiTracker*)calloc(1, sizeof(RodRoiTracker));
+    if (!tracker) {
+        fprintf(stderr, "rod_roi_tracker: Failed to allocate tracker\n");
+        return NULL;
+    }
+    
+    tracker->full_scan_interval = full_scan_interval;
+    tracker->padding_ratio = padding_ratio;
+    tracker->pyramid_scale = 1.0f;
+    tracker->tiles_x = 1;
+    tracker->tiles_y = 1;
+    return tracker;
+}
+
+void rod_roi_tracker_destroy(RodRoiTracker* tracker) {
+    free(tracker);
+}
+
+void rod_roi_tracker_set_pyramid_scale(RodRoiTracker* tracker, float scale) {
+    if (!tracker) return;
+    if (scale <= 0.0f || scale > 1.0f) {
+        fprintf(stderr, "rod_roi_tracker: Invalid pyramid scale %.2f, using full resolution\n", scale);
+        scale = 1.0f;
+    }
+    tracker->pyramid_scale = scale;
+}
+
+void rod_roi_tracker_set_tiling(RodRoiTracker* tracker, int tiles_x, int tiles_y, int overlap) {
+    if (!tracker) return;
+    if (tiles_x < 1 || tiles_y < 1 || overlap < 0) {
+        fprintf(stderr, "rod_roi_tracker: Invalid tiling %dx%d (overlap %d), using single call detection\n",
+                tiles_x, tiles_y, overlap);
+        tiles_x = 1;
+        tiles_y = 1;
+        overlap = 0;
+    }
+    tracker->tiles_x = tiles_x;
+    tracker->tiles_y = tiles_y;
+    tracker->tile_overlap = overlap;
+}
+
+void rod_roi_tracker_reset(RodRoiTracker* tracker) {
+    if (!tracker) return;
+    tracker->track_count = 0;
+    tracker->frames_since_full_scan = 0;
+}
+
+/**
+ * @brief Replace all tracks with the markers of a detection result
+ */
+static void update_tracks(RodRoiTracker* tracker, const DetectionResult* result) {
+    tracker->track_count = 0;
+    for (int i = 0; i < result->count && tracker->track_count < ROD_ROI_TRACKER_MAX_TRACKS; i++) {
+        TrackedMarker* track = &tracker->tracks[tracker->track_count++];
+        track->id = result->markers[i].id;
+        memcpy(track->corners, result->markers[i].corners, sizeof(track->corners));
+    }
+}
+
+/**
+ * @brief Padded bounding box of a tracked marker
+ */
+static RoiRect track_region(const RodRoiTracker* tracker, const TrackedMarker* track) {
+    float min_x = track->corners[0][0], max_x = min_x;
+    float min_y = track->corners[0][1], max_y = min_y;
+    for (int j = 1; j < 4; j++) {
+        min_x = fminf(min_x, track->corners[j][0]);
+        max_x = fmaxf(max_x, track->corners[j][0]);
+        min_y = fminf(min_y, track->corners[j][1]);
+        max_y = fmaxf(max_y, track->corners[j][1]);
+    }
+    
+    float size = fmaxf(max_x - min_x, max_y - min_y);
+    float padding = fmaxf(size * tracker->padding_ratio, (float)ROI_MIN_PADDING_PX);
+    
+    RoiRect rect;
+    rect.x = (int)floorf(min_x - padding);
+    rect.y = (int)floorf(min_y - padding);
+    rect.width = (int)ceilf(max_x + padding) - rect.x;
+    rect.height = (int)ceilf(max_y + padding) - rect.y;
+    return rect;
+}
+
+static bool regions_overlap(const RoiRect* a, const RoiRect* b) {
+    return a->x < b->x + b->width && b->x < a->x + a->width &&
+           a->y < b->y + b->height && b->y < a->y + a->height;
+}
+
+/**
+ * @brief Build scan regions from tracks, merging overlapping ones
+ * @return Number of regions
+ */
+static int build_regions(RodRoiTracker* tracker) {
+    int count = 0;
+    for (int i = 0; i < tracker->track_count; i++) {
+        RoiRect rect = track_region(tracker, &tracker->tracks[i]);
+        
+        // Merge with existing regions until it overlaps none of them
+        bool merged = true;
+        while (merged) {
+            merged = false;
+            for (int k = 0; k < count; k++) {
+                if (!regions_overlap(&rect, &tracker->regions[k])) continue;
+                
+                RoiRect* other = &tracker->regions[k];
+                int x0 = rect.x < other->x ? rect.x : other->x;
+                int y0 = rect.y < other->y ? rect.y : other->y;
+                int x1 = (rect.x + rect.width > other->x + other->width) ? rect.x + rect.width : other->x + other->width;
+                int y1 = (rect.y + rect.height > other->y + other->height) ? rect.y + rect.height : other->y + other->height;
+                rect.x = x0;
+                rect.y = y0;
+                rect.width = x1 - x0;
+                rect.height = y1 - y0;
+                
+                tracker->regions[k] = tracker->regions[--count];
+                merged = true;
+                break;
+            }
+        }
+        tracker->regions[count++] = rect;
+    }
+    return count;
+}
+
+/**
+ * @brief Count tracked markers without a matching detection (same ID, close center)
+ */
+static int count_lost_tracks(RodRoiTracker* tracker, const DetectionResult* result) {
+    int lost = 0;
+    for (int i = 0; i < tracker->track_count; i++) {
+        TrackedMarker* track = &tracker->tracks[i];
+        Point2f center = calculate_marker_center(track->corners);
+        RoiRect region = track_region(tracker, track);
+        float gate = 0.5f * fmaxf((float)region.width, (float)region.height);
+        
+        bool found = false;
+        for (int j = 0; j < result->count && !found; j++) {
+            if (result->markers[j].id != track->id) continue;
+            Point2f other = calculate_marker_center(result->markers[j].corners);
+            found = hypotf(other.x - center.x, other.y - center.y) < gate;
+        }
+        if (!found) lost++;
+    }
+    return lost;
+}
+
+/**
+ * @brief Detect in the tracked regions, into the caller's result if given (allocated otherwise)
+ */
+static DetectionResult* scan_regions(RodRoiTracker* tracker, ArucoDetectorHandle* detector, ImageHandle* image,
+                                     int region_count, DetectionResult* into, int capacity) {
+    if (!into) {
+        return detectMarkersInRegions(detector, image, tracker->regions, region_count);
+    }
+    return detectMarkersInRegionsInto(detector, image, tracker->regions, region_count, into, capacity) >= 0 ? into : NULL;
+}
+
+/**
+ * @brief Detect on the full image, into the caller's result if given (allocated otherwise)
+ */
+static DetectionResult* scan_full(RodRoiTracker* tracker, ArucoDetectorHandle* detector, ImageHandle* image,
+                                  DetectionResult* into, int capacity) {
+    // Regions are already small: only full-frame scans use tiles or the pyramid
+    bool tiled = tracker->tiles_x * tracker->tiles_y > 1;
+    if (!into) {
+        return tiled ? detectMarkersTiled(detector, image, tracker->tiles_x, tracker->tiles_y, tracker->tile_overlap)
+                     : detectMarkersPyramid(detector, image, tracker->pyramid_scale);
+    }
+    int count = tiled ? detectMarkersTiledInto(detector, image, tracker->tiles_x, tracker->tiles_y,
+                                               tracker->tile_overlap, into, capacity)
+                      : detectMarkersPyramidInto(detector, image, tracker->pyramid_scale, into, capacity);
+    return count >= 0 ? into : NULL;
+}
+
+static DetectionResult* track_and_detect(RodRoiTracker* tracker, ArucoDetectorHandle* detector, ImageHandle* image,
+                                         DetectionResult* into, int capacity, bool periodic_scan) {
+    memset(&tracker->stats, 0, sizeof(tracker->stats));
+    tracker->frames_since_full_scan++;
+    
+    bool full_scan = tracker->track_count == 0 ||
+                     (periodic_scan && tracker->frames_since_full_scan >= tracker->full_scan_interval);
+    
+    DetectionResult* result = NULL;
+    if (!full_scan) {
+        int region_count = build_regions(tracker);
+        result = scan_regions(tracker, detector, image, region_count, into, capacity);
+        tracker->stats.region_count = region_count;
+        
+        if (result) {
+            tracker->stats.lost = count_lost_tracks(tracker, result);
+        }
+        
+        // A marker left its region (or disappeared): rescan this frame fully
+        if (!result || tracker->stats.lost > 0) {
+            if (result != into) {
+                releaseDetectionResult(result);
+            }
+            result = NULL;
+            full_scan = true;
+        }
+    }
+    
+    if (full_scan) {
+        result = scan_full(tracker, detector, image, into, capacity);
+        tracker->frames_since_full_scan = 0;
+    }
+    
+    if (result) {
+        update_tracks(tracker, result);
+    }
+    
+    tracker->stats.full_scan = full_scan;
+    tracker->stats.tracked = tracker->track_count;
+    return result;
+}
+
+DetectionResult* rod_roi_tracker_detect(RodRoiTracker* tracker,
+                                        ArucoDetectorHandle* detector,
+                                        ImageHandle* image) {
+    if (!tracker || !detector || !image) return NULL;
+    return track_and_detect(tracker, detector, image, NULL, 0, true);
+}
+
+int rod_roi_tracker_detect_into(RodRoiTracker* tracker,
+                                ArucoDetectorHandle* detector,
+                                ImageHandle* image,
+                                DetectionResult* result,
+                                int capacity) {
+    if (!tracker || !detector || !image || !result) return -1;
+    return track_and_detect(tracker, detector, image, result, capacity, true) ? result->count : -1;
+}
+
+int rod_roi_tracker_detect_regions_into(RodRoiTracker* tracker,
+                                        ArucoDetectorHandle* detector,
+                                        ImageHandle* image,
+                                        DetectionResult* result,
+                                        int capacity) {
+    if (!tracker || !detector || !image || !result) return -1;
+    return track_and_detect(tracker, detector, image, result, capacity, false) ? result->count : -1;
+}
+
+void rod_roi_tracker_get_stats(RodRoiTracker* tracker, RodRoiTrackerStats* stats) {
+    if (!stats) return;
+    if (!tracker) {
+        memset(stats, 0, sizeof(RodRoiTrackerStats));
+        return;
+    }
+    *stats = tracker->stats;
+}
@@ -0,0 +1,129 @@
+/**
+ * @file rod_roi_tracker.h
+ * @brief ROI-tracked incremental ArUco detection for ROD
+ * @author Noé Game
+ * @date 14/10/2026
+ * @see rod_roi_tracker.c
+ * @copyright Cecill-C (Cf. LICENCE.txt)
+ * 
+ * Most markers barely move from one frame to the next. This module keeps the
+ * last known quad of every marker and only runs detection on padded regions
+ * around them. A full-frame scan is done:
+ * - on the first frame and every full_scan_interval frames (finds new markers)
+ * - as soon as a tracked marker is not found in its region (same frame)
+ * 
+ * rod_roi_tracker_detect_regions_into() postpones the periodic full-frame scan
+ * (static scene, see rod_motion_gate.h) and keeps the two other cases.
+ */
+
+#pragma once
+
+/* ******************************************************* Includes ****************************************************** */
+
+#include "opencv_wrapper.h"
+#include <stdbool.h>
+
+/* ***************************************************** Public macros *************************************************** */
+
+// Maximum number of tracked markers
+#define ROD_ROI_TRACKER_MAX_TRACKS 128
+
+/* ************************************************** Public types definition ******************************************** */
+
+/**
+ * @brief Opaque ROI tracker
+ */
+typedef struct RodRoiTracker RodRoiTracker;
+
+/**
+ * @brief Statistics of the last rod_roi_tracker_detect() call
+ */
+typedef struct {
+    bool full_scan;      // true if the full frame was scanned
+    int region_count;    // Number of regions scanned (0 on full scan only)
+    int tracked;         // Number of tracked markers after the call
+    int lost;            // Tracked markers not found in their region (triggers a full scan)
+} RodRoiTrackerStats;
+
+/* *********************************************** Public functions declarations ***************************************** */
+
+/**
+ * @brief Create a ROI tracker
+ * @param full_scan_interval Full-frame scan every N frames (1 = always full frame)
+ * @param padding_ratio Region padding around each marker, relative to the marker size
+ * @return Tracker, or NULL on failure
+ */
+RodRoiTracker* rod_roi_tracker_create(int full_scan_interval, float padding_ratio);
+
+/**
+ * @brief Destroy a ROI tracker
+ * @param tracker ROI tracker
+ */
+void rod_roi_tracker_destroy(RodRoiTracker* tracker);
+
+/**
+ * @brief Forget all tracks (next call does a full-frame scan)
+ * @param tracker ROI tracker
+ */
+void rod_roi_tracker_reset(RodRoiTracker* tracker);
+
+/**
+ * @brief Use coarse-to-fine pyramid detection for full-frame scans
+ * @param tracker ROI tracker
+ * @param scale Coarse level scale (see detectMarkersPyramid), 1.0 = plain detection
+ */
+void rod_roi_tracker_set_pyramid_scale(RodRoiTracker* tracker, float scale);
+
+/**
+ * @brief Split full-frame scans into parallel tiles
+ * @param tracker ROI tracker
+ * @param tiles_x Tile columns, tiles_y Tile rows (1 x 1 = single call detection)
+ * @param overlap Tile overlap in pixels, at least the largest marker extent (see detectMarkersTiled)
+ * 
+ * Tiling replaces the pyramid for full-frame scans. Call again whenever the
+ * expected marker extent changes (e.g. new homography).
+ */
+void rod_roi_tracker_set_tiling(RodRoiTracker* tracker, int tiles_x, int tiles_y, int overlap);
+
+/**
+ * @brief Detect markers, scanning only the tracked regions when possible
+ * @param tracker ROI tracker
+ * @param detector ArUco detector handle
+ * @param image Image to process
+ * @return Detection result in full image coordinates (release with releaseDetectionResult), NULL on error
+ */
+DetectionResult* rod_roi_tracker_detect(RodRoiTracker* tracker,
+                                        ArucoDetectorHandle* detector,
+                                        ImageHandle* image);
+
+/**
+ * @brief Same as rod_roi_tracker_detect, into a caller-provided result (no allocation)
+ * @param result Result whose markers array holds capacity markers
+ * @param capacity Capacity of result->markers (extra detections are dropped)
+ * @return Number of markers written, -1 on error
+ */
+int rod_roi_tracker_detect_into(RodRoiTracker* tracker,
+                                ArucoDetectorHandle* detector,
+                                ImageHandle* image,
+                                DetectionResult* result,
+                                int capacity);
+
+/**
+ * @brief Same as rod_roi_tracker_detect_into, without the periodic full-frame scan
+ * 
+ * The full frame is still scanned when nothing is tracked or a tracked marker is
+ * lost. A periodic scan falling due is done by the next rod_roi_tracker_detect_into().
+ * @return Number of markers written, -1 on error
+ */
+int rod_roi_tracker_detect_regions_into(RodRoiTracker* tracker,
+                                        ArucoDetectorHandle* detector,
+                                        ImageHandle* image,
+                                        DetectionResult* result,
+                                        int capacity);
+
+/**
+ * @brief Get statistics of the last detection
+ * @param tracker ROI tracker
+ * @param stats Output statistics
+ */
+void rod_roi_tracker_get_stats(RodRoiTracker* tracker, RodRoiTrackerStats* stats);
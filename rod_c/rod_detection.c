@@ -5,11 +5,38 @@
  * @date 15/02/2026
  * @see rod_detection.c
  * @copyright Cecill-C (Cf. LICENCE.txt)
- * 
+ *
  * This program implements the computer vision thread that:
  * - Captures images using the emulated camera
  * - Detects ArUco markers on game elements
  * - Sends detected positions to the IPC thread via socket communication
+ *
+ * The work is split in four stages (capture / preprocess / detect / publish),
+ * each running on its own thread and exchanging frame slots through bounded
+ * queues. When a stage falls behind, the oldest waiting frame is dropped so the
+ * publish rate follows the slowest stage instead of the sum of all stages.
+ * Use --sequential to run the same stages one after another on a single thread.
+ * With --realtime, the stage threads are pinned to their own CPUs with
+ * SCHED_FIFO priorities and the process memory is locked (rod_realtime.h).
+ *
+ * Detector parameters, camera controls, debug save interval and pipeline mode
+ * are read from ROD_RUNTIME_CONFIG_FILE (--config) and reloaded on SIGHUP
+ * (systemctl reload rod-detection): the capture stage swaps them in between two
+ * frames and every frame carries the settings it was captured with.
+ *
+ * With --record file, the raw frames are appended to a session file with their
+ * timestamp, camera controls and published detections (rod_session.h), instead
+ * of being saved as JPEGs. Giving that file as image folder replays it.
+ *
+ * While the field is static (before the match, robots parked), the motion gate
+ * (rod_motion_gate.h) skips the detection of most frames and publishes the
+ * previous markers again, flagged as carried over, or searches only around the
+ * known markers, with a full-frame detection at least every
+ * ROD_MOTION_GATE_FULL_INTERVAL_MS.
+ *
+ * Built with ROD_BENCH defined (rod_bench target), the same stages replay a
+ * recorded folder from memory for a fixed number of frames and write a
+ * benchmark result that can be compared against a saved baseline.
  */
 
 #define _POSIX_C_SOURCE 199309L  // Required for clock_gettime and CLOCK_MONOTONIC
@@ -20,9 +47,23 @@
 #include "camera_interface.h"
 #include "opencv_wrapper.h"
 #include "rod_cv.h"
+#include "rod_roi_tracker.h"
+#include "rod_localization_grid.h"
+#include "rod_recalibration.h"
+#include "rod_marker_filter.h"
 #include "rod_config.h"
+#include "rod_runtime_config.h"
 #include "rod_visualization.h"
 #include "rod_socket.h"
+#include "rod_shm.h"
+#include "rod_frame_queue.h"
+#include "rod_metrics.h"
+#include "rod_realtime.h"
+#include "rod_motion_gate.h"
+#include "rod_bench_report.h"
+#include "rod_writer.h"
+#include "rod_session.h"
+#include "rod_stream.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -30,6 +71,8 @@
 #include <unistd.h>
 #include <signal.h>
 #include <stdbool.h>
+#include <stdatomic.h>
+#include <pthread.h>
 #include <time.h>
 
 /* ***************************************************** Public macros *************************************************** */
@@ -45,35 +88,220 @@
 
 // Socket configuration
 #define SOCKET_PATH ROD_SOCKET_PATH
-#define MAX_DETECTION_SIZE ROD_MAX_DETECTION_SIZE
+#define SHM_ENABLED ROD_SHM_ENABLED
+#define SHM_NAME ROD_SHM_NAME
 
-// Debug image saving (save one annotated image every N frames)
-#define SAVE_DEBUG_IMAGE_INTERVAL ROD_SAVE_DEBUG_IMAGE_INTERVAL
+// Debug image saving (annotated preview size and quality, the interval is a runtime setting)
+#define DEBUG_PREVIEW_WIDTH ROD_DEBUG_PREVIEW_WIDTH
+#define DEBUG_JPEG_QUALITY ROD_DEBUG_JPEG_QUALITY
+
+// Session recording (--record)
+#define SESSION_RECORD_INTERVAL ROD_SESSION_RECORD_INTERVAL
+
+// Live stream of the annotated preview (HTTP MJPEG)
+#define STREAM_ENABLED ROD_STREAM_ENABLED
+#define STREAM_PORT ROD_STREAM_PORT
+#define STREAM_MAX_FPS ROD_STREAM_MAX_FPS
+#define STREAM_WIDTH ROD_STREAM_WIDTH
+#define STREAM_JPEG_QUALITY ROD_STREAM_JPEG_QUALITY
+#define STREAM_ENCODER_DEVICE ROD_STREAM_ENCODER_DEVICE
 
 // Detection pipeline parameters (must match Python implementation)
 #define DETECTION_SCALE_FACTOR 1.0f  // Resize scale for better detection
+#define DETECTION_PYRAMID_SCALE ROD_DETECTION_PYRAMID_SCALE  // Coarse-to-fine detection when < 1.0
+#define PREPROCESS_FUSED ROD_PREPROCESS_FUSED  // Single-pass sharpen + mask + gray
+#define CROP_TO_FIELD ROD_CROP_TO_FIELD  // Process only the field bounding box once the mask exists
+#define DETECTION_TILES_X ROD_DETECTION_TILES_X  // Full-frame detection split across cores
+#define DETECTION_TILES_Y ROD_DETECTION_TILES_Y
+#define DETECTION_TILE_MARGIN ROD_DETECTION_TILE_MARGIN
+#define LOCALIZATION_GRID_ENABLED ROD_LOCALIZATION_GRID_ENABLED  // Bilinear lookup instead of exact undistort+homography
+#define LOCALIZATION_GRID_CELL ROD_LOCALIZATION_GRID_CELL
+#define RECALIBRATION_ENABLED ROD_RECALIBRATION_ENABLED  // Background homography/mask refresh when the camera moved
+#define RECALIBRATION_DRIFT_MM ROD_RECALIBRATION_DRIFT_MM
+#define FIELD_MASK_SCALE_Y 1.1f  // Vertical margin of the field polygon
+#define MARKER_FILTER_ENABLED ROD_MARKER_FILTER_ENABLED  // Smoothed, predicted positions sent instead of raw ones
+
+// Maximum number of markers kept per frame
+#define MAX_MARKERS_PER_FRAME 100
+#define DETECTION_CAPACITY 128  // Raw detections kept per frame (any ID, before filtering)
+#define IMAGE_POOL_SIZE (PIPELINE_SLOTS * 3)  // Frame, field and preview views of every slot
+#define SENSOR_MODE_MAX 16  // Sensor modes listed at startup
+
+// Runtime configuration (reloaded on SIGHUP)
+#define RUNTIME_CONFIG_FILE ROD_RUNTIME_CONFIG_FILE
+
+// Pipeline configuration
+#define PIPELINE_SLOTS ROD_PIPELINE_SLOTS
+#define PIPELINE_QUEUE_DEPTH ROD_PIPELINE_QUEUE_DEPTH
+#define PIPELINE_STAGE_COUNT 4
+#define STAGE_POP_TIMEOUT_MS 100     // Stage threads re-check for shutdown at this period
+
+// Real-time mode (--realtime): stage CPUs and priorities are set in run_pipelined()
+#define REALTIME_ENABLED ROD_REALTIME_ENABLED
+#define REALTIME_HEAP_PREFAULT ROD_REALTIME_HEAP_PREFAULT
+#define REALTIME_STACK_PREFAULT ROD_REALTIME_STACK_PREFAULT
+
+// Instrumentation
+#define METRICS_FILE ROD_METRICS_FILE
+#define METRICS_DUMP_INTERVAL_MS ROD_METRICS_DUMP_INTERVAL_MS
+#define LOG_FRAME_SUMMARY ROD_LOG_FRAME_SUMMARY
+#define METRICS_REPORT_SIZE 1024
+
+// Replay benchmark (rod_bench): decoded frames in memory, outputs kept off the production names,
+// every frame detected (the detection cost is what is measured)
+#ifdef ROD_BENCH
+#define EMULATED_PRELOAD 1
+#define MOTION_GATE_ENABLED 0
+#else
+#define EMULATED_PRELOAD ROD_EMULATED_PRELOAD
+#define MOTION_GATE_ENABLED ROD_MOTION_GATE_ENABLED
+#endif
+#define BENCH_FRAMES ROD_BENCH_FRAMES
+#define BENCH_OUTPUT_FILE ROD_BENCH_OUTPUT_FILE
+#define BENCH_TOLERANCE ROD_BENCH_TOLERANCE
+#define BENCH_SHM_NAME "/rod_bench_detections"
+#define BENCH_EXIT_REGRESSION 2
 
 /* ************************************************** Public types definition ******************************************** */
 
 /**
- * @brief Application context
+ * @brief Timestamps of one frame through the pipeline (milliseconds, CLOCK_MONOTONIC)
+ */
+typedef struct {
+    double exposure;                // Sensor timestamp of the frame (capture_end if the camera gives none)
+    double capture_start, capture_end;
+    double create_start, create_end;
+    double sharpen_start, sharpen_end;
+    double mask_start, mask_end;
+    double resize_start, resize_end;
+    double detect_start, detect_end;
+    double pose_start, pose_end;
+    double send_end;
+    double annotate_start, annotate_end;
+    double save_start, save_end;
+    double publish_end;
+} FrameTimings;
+
+/**
+ * @brief Frame slot: one frame and all the buffers it needs through the pipeline
+ *
+ * Slots are preallocated and recycled, the image buffers they own are reused
+ * from one frame to the next.
+ */
+typedef struct {
+    int frame_index;                // Capture order (1-based)
+    char timestamp[32];             // Filename timestamp generated at capture
+    uint32_t sequence;              // Camera frame sequence number (sent to clients)
+    RodRuntimeConfig config;        // Settings in force when the frame was captured
+
+    CameraFrame frame;              // Borrowed camera frame (valid while has_frame)
+    bool has_frame;
+    ImageHandle* original_image;    // View on frame.data (no copy)
+    ImageHandle* raw_copy;          // Owned copy of the raw frame or preview (debug save frames only)
+    float raw_scale;                // raw_copy size / frame size (< 1 when taken from the preview)
+    ImageHandle* stream_copy;       // Owned BGR copy at stream size (frames tapped by the live stream only)
+    float stream_scale;             // stream_copy size / frame size
+    ImageHandle* session_copy;      // Owned copy of the main frame (recorded frames only)
+
+    // Reusable buffers to reduce memory allocations
+    ImageHandle* buffer_sharpened;  // Buffer for sharpened image (gray with fused preprocessing)
+    ImageHandle* buffer_masked;     // Buffer for masked image
+    ImageHandle* detect_input;      // Image given to the detector (points to one of the above)
+    int detect_offset_x;            // Position of detect_input in the frame (field crop)
+    int detect_offset_y;
+
+    DetectionResult* detection;     // Points to detection_storage once detected (NULL otherwise)
+    DetectionResult detection_storage;
+    DetectedMarker detected_markers[DETECTION_CAPACITY];
+    RodRoiTrackerStats roi_stats;   // How the detect stage scanned this frame
+    MarkerData markers[MAX_MARKERS_PER_FRAME];
+    int valid_count;
+    MarkerData filtered[MAX_MARKERS_PER_FRAME];  // Marker filter output, sent instead of markers when enabled
+    int filtered_count;
+
+    RodMotionDecision schedule;     // How the motion gate scheduled this frame (set by the preprocess stage)
+    float homography_inv[9];        // Homography snapshot taken at preprocess time
+    bool has_homography;
+    int tile_overlap;               // Tile overlap for full-frame detection (-1 = no tiling yet)
+
+    FrameTimings t;
+} FrameSlot;
+
+struct AppContext;
+
+/**
+ * @brief One pipeline stage thread
  */
 typedef struct {
+    const char* name;
+    struct AppContext* app;
+    int (*run)(struct AppContext* ctx, FrameSlot* slot);  // 0 = forward slot, -1 = recycle it
+    RodFrameQueue* input;
+    RodFrameQueue* output;       // NULL for the last stage (slot is recycled)
+    bool drop_oldest;            // Evict the oldest waiting frame when output is full
+    uint64_t cpu_mask;           // CPUs of the thread in real-time mode (0 = not pinned)
+    int priority;                // SCHED_FIFO priority in real-time mode (0 = SCHED_OTHER)
+    pthread_t thread;
+    bool started;
+} PipelineStage;
+
+/**
+ * @brief Application context
+ */
+typedef struct AppContext {
     Camera* camera;
-    ArucoDetectorHandle* detector;
+    ArucoDetectorHandle* detector;       // Detect stage only (rebuilt when the detector settings change)
+    ArucoDetectorHandle* mask_detector;  // Field mask creation, preprocess stage only (startup settings)
     ArucoDictionaryHandle* dictionary;
-    DetectorParametersHandle* params;
+    DetectorParametersHandle* params;    // Startup detector parameters
+    RodRoiTracker* roi_tracker;  // Incremental detection around known markers (detect stage only, NULL if disabled)
+    RodLocalizationGrid* localization_grid;  // Pixel -> playground lookup (publish stage only, created lazily)
+    RodRecalibrator* recalibrator;  // Fed by the publish stage, swapped in by the preprocess stage (NULL if disabled)
+    RodMarkerFilter* marker_filter;  // Per marker tracks (publish stage only, NULL if disabled)
+    RodMotionGate* motion_gate;      // Detection scheduling on field changes (preprocess stage only, NULL if disabled)
+    MarkerData carried[MAX_MARKERS_PER_FRAME];  // Last markers published from a detected frame (publish stage only)
+    int carried_count;
+    double carried_exposure;         // Sensor timestamp of the frame they come from
     RodSocketServer* socket_server;
-    ImageHandle* field_mask;  // Field mask for filtering detections
+    RodShmPublisher* shm_publisher;  // Lock-free snapshots for any number of readers (NULL if disabled)
+    RodWriter* writer;        // Background encoder for raw/debug images
+    RodSessionWriter* session;  // Session file fed by the writer (--record, NULL if not recording)
+    RodStream* stream;        // Live annotated preview over HTTP (NULL if disabled or benchmarking)
+    ImagePool* image_pool;    // Per-frame image views (no allocation once warmed up)
+    ImageHandle* field_mask;  // Field mask for filtering detections, field_roi sized (preprocess stage only)
+    RoiRect field_roi;        // Field bounding box in frame coordinates (valid once field_mask exists)
+    int detect_offset_x;      // Offset of the last detected image (detect stage only)
+    int detect_offset_y;
     float homography_inv[9];  // Inverse homography matrix (image -> playground)
     bool has_homography;      // Flag indicating if homography is valid
-    
-    // Reusable buffers to reduce memory allocations
-    ImageHandle* buffer_sharpened;  // Buffer for sharpened image
-    ImageHandle* buffer_masked;     // Buffer for masked image
-    ImageHandle* buffer_resized;    // Buffer for resized image
-    
-    bool running;
+    int tile_overlap;         // Largest marker extent with margin, -1 until the homography exists (preprocess stage only)
+    int detect_tile_overlap;  // Tile overlap applied to the detector (detect stage only)
+
+    // Runtime configuration
+    const char* config_path;          // Reloaded file (NULL = built-in defaults only)
+    RodRuntimeConfig base_config;     // Values of the keys missing from the file (defaults and command line)
+    RodRuntimeConfig config;          // Settings stamped on new frames (capture stage only)
+    RodRuntimeConfig detector_config; // Settings ctx->detector was built with (detect stage only)
+    pthread_mutex_t config_lock;      // Protects pending_config and config_pending
+    RodRuntimeConfig pending_config;  // Loaded by a reload, swapped in by the capture stage between frames
+    bool config_pending;
+    bool sequential;                  // Pipeline mode to run (main thread only, changed by a reload)
+
+    // Frame slots and stage queues
+    FrameSlot slots[PIPELINE_SLOTS];
+    RodFrameQueue* free_slots;        // Slots ready for capture
+    RodFrameQueue* preprocess_queue;  // Captured frames
+    RodFrameQueue* detect_queue;      // Preprocessed frames
+    RodFrameQueue* publish_queue;     // Detection results
+    PipelineStage stages[PIPELINE_STAGE_COUNT];
+
+    int frame_count;                  // Frames captured (capture stage only)
+    int max_frames;                   // Stop once this many frames are published (0 = until signaled)
+    RodMetrics* metrics;              // Stage latencies, published and dropped frames (any thread)
+    double metrics_dumped_at;         // Last report write (main thread only)
+    bool realtime;                    // Pinned SCHED_FIFO stage threads, locked memory (--realtime)
+
+    atomic_bool running;              // Cleared by the publish stage once max_frames is reached, read by the main thread
 } AppContext;
 
 /* *********************************************** Public functions declarations ***************************************** */
@@ -83,9 +311,12 @@ typedef struct {
  * @param ctx Application context
  * @param camera_type Camera type (CAMERA_TYPE_REAL or CAMERA_TYPE_EMULATED)
  * @param image_folder Path to image folder (for emulated camera)
+ * @param config_path Runtime configuration file (NULL = built-in defaults, no reload)
+ * @param sequential Pipeline mode used when the file does not set pipeline_mode
  * @return 0 on success, -1 on failure
  */
-static int init_app_context(AppContext* ctx, CameraType camera_type, const char* image_folder);
+static int init_app_context(AppContext* ctx, CameraType camera_type, const char* image_folder,
+                            const char* config_path, bool sequential);
 
 /**
  * @brief Cleanup application context
@@ -93,7 +324,63 @@ static int init_app_context(AppContext* ctx, CameraType camera_type, const char*
  */
 static void cleanup_app_context(AppContext* ctx);
 
+/**
+ * @brief Capture stage: borrow a camera frame and wrap it in an image view
+ * @return 0 on success, -1 on failure
+ */
+static int stage_capture(AppContext* ctx, FrameSlot* slot);
+
+/**
+ * @brief Preprocess stage: sharpen, build field mask, apply mask, give the camera buffer back
+ * (single gray pass when PREPROCESS_FUSED is set)
+ * @return 0 on success, -1 on failure
+ */
+static int stage_preprocess(AppContext* ctx, FrameSlot* slot);
+
+/**
+ * @brief Detect stage: ArUco detection on the preprocessed image
+ * @return 0 on success, -1 on failure
+ */
+static int stage_detect(AppContext* ctx, FrameSlot* slot);
+
+/**
+ * @brief Publish stage: localize markers, send them, save debug images, print summary
+ * @return 0 (the slot is always recycled afterwards)
+ */
+static int stage_publish(AppContext* ctx, FrameSlot* slot);
+
+/**
+ * @brief Localize the slot markers in playground coordinates
+ * (grid lookup when LOCALIZATION_GRID_ENABLED, rebuilt only when the homography changes)
+ * @return Number of localized markers, -1 on error
+ */
+static int localize_slot_markers(AppContext* ctx, FrameSlot* slot);
+
+/**
+ * @brief Publish the sent markers of a slot in the shared memory ring (every frame, even without markers)
+ */
+static void publish_shm_snapshot(AppContext* ctx, const FrameSlot* slot, const MarkerData* markers, int marker_count,
+                                 const RodProtocolTimings* timings);
+
+/**
+ * @brief Run each stage on a dedicated thread until shutdown
+ * @param ctx Application context
+ * @return 0 on success, -1 on failure
+ */
+static int run_pipelined(AppContext* ctx);
+
+/**
+ * @brief Run all stages one after another on the calling thread until shutdown
+ * @param ctx Application context
+ */
+static void run_sequential(AppContext* ctx);
 
+/**
+ * @brief Run the pipeline in the configured mode until shutdown (restarted when a reload switches the mode)
+ * @param ctx Application context
+ * @return 0 on success, -1 on failure
+ */
+static int run_detection(AppContext* ctx);
 
 /**
  * @brief Signal handler for graceful shutdown
@@ -101,15 +388,22 @@ static void cleanup_app_context(AppContext* ctx);
  */
 static void signal_handler(int signum);
 
+/**
+ * @brief Signal handler for configuration reload (SIGHUP)
+ * @param signum Signal number
+ */
+static void reload_signal_handler(int signum);
+
 /* ******************************************* Global variables ******************************************************* */
 
 static volatile bool g_running = true;
+static volatile sig_atomic_t g_reload_requested = 0;
 
 /* ******************************************* Public callback functions declarations ************************************ */
 
 /**
  * @brief Get current time in milliseconds
- * @return Time in milliseconds  
+ * @return Time in milliseconds
  */
 static double get_time_ms(void) {
     struct timespec ts;
@@ -123,33 +417,100 @@ static void signal_handler(int signum) {
     printf("\nReceived interrupt signal, shutting down...\n");
 }
 
-static int init_app_context(AppContext* ctx, CameraType camera_type, const char* image_folder) {
+static void reload_signal_handler(int signum) {
+    (void)signum;  // Unused parameter
+    g_reload_requested = 1;
+}
+
+static bool is_running(AppContext* ctx) {
+    return g_running && atomic_load(&ctx->running);
+}
+
+/**
+ * @brief Fill camera parameters from the runtime camera controls (frame rate and crop stay compile-time)
+ */
+static void fill_camera_parameters(const RodRuntimeConfig* config, RodCameraParameters* params) {
+    camera_get_default_parameters(params);
+    params->exposure_time = config->camera.exposure_time;
+    params->analogue_gain = config->camera.analogue_gain;
+    params->brightness = config->camera.brightness;
+    params->contrast = config->camera.contrast;
+    params->saturation = config->camera.saturation;
+    params->sharpness = config->camera.sharpness;
+    params->awb_enable = config->camera.awb_enable;
+    params->aec_enable = config->camera.aec_enable;
+    params->noise_reduction_mode = config->camera.noise_reduction_mode;
+    params->frame_duration_min = ROD_CAMERA_FRAME_DURATION_US;
+    params->frame_duration_max = ROD_CAMERA_FRAME_DURATION_US;
+    if (ROD_CAMERA_CROP_WIDTH > 0) {
+        params->crop_x = ROD_CAMERA_CROP_X;
+        params->crop_y = ROD_CAMERA_CROP_Y;
+        params->crop_width = ROD_CAMERA_CROP_WIDTH;
+        params->crop_height = ROD_CAMERA_CROP_HEIGHT;
+    }
+}
+
+static int init_app_context(AppContext* ctx, CameraType camera_type, const char* image_folder,
+                            const char* config_path, bool sequential) {
     memset(ctx, 0, sizeof(AppContext));
     ctx->socket_server = NULL;
     ctx->field_mask = NULL;
     ctx->has_homography = false;
-    ctx->buffer_sharpened = NULL;
-    ctx->buffer_masked = NULL;
-    ctx->buffer_resized = NULL;
-    ctx->running = true;
-    
+    ctx->tile_overlap = -1;
+    ctx->detect_tile_overlap = -1;
+    pthread_mutex_init(&ctx->config_lock, NULL);
+
+    // Runtime settings: built-in defaults and command line, then the file on top
+    rod_runtime_config_set_defaults(&ctx->base_config);
+    ctx->base_config.sequential = sequential;
+    ctx->config = ctx->base_config;
+    ctx->config_path = config_path;
+    if (config_path) {
+        if (rod_runtime_config_load(config_path, &ctx->base_config, &ctx->config) == 0) {
+            printf("Runtime configuration: %s (reload with SIGHUP)\n", config_path);
+        } else {
+            printf("Runtime configuration: built-in defaults (%s not loaded, reload with SIGHUP)\n", config_path);
+        }
+    }
+    ctx->detector_config = ctx->config;
+    ctx->sequential = ctx->config.sequential;
+
+    ctx->metrics = rod_metrics_create();
+    if (!ctx->metrics) {
+        fprintf(stderr, "Failed to create metrics\n");
+        return -1;
+    }
+    atomic_init(&ctx->running, true);
+
     // Initialize camera based on type
-    printf("Initializing %s camera...\n", 
+    printf("Initializing %s camera...\n",
            camera_type == CAMERA_TYPE_EMULATED ? "emulated" : "real");
     ctx->camera = camera_create(camera_type);
     if (!ctx->camera) {
         fprintf(stderr, "Failed to initialize camera\n");
         return -1;
     }
-    
-    // Set camera resolution to full IMX477 sensor resolution (4056x3040)
-    if (camera_interface_set_size(ctx->camera, 4056, 3040) != 0) {
-        fprintf(stderr, "Failed to set camera resolution to 4056x3040\n");
+
+    // Set camera resolution (full IMX477 sensor resolution by default, 4056x3040)
+    if (camera_interface_set_size(ctx->camera, ROD_CAMERA_WIDTH, ROD_CAMERA_HEIGHT) != 0) {
+        fprintf(stderr, "Failed to set camera resolution to %dx%d\n", ROD_CAMERA_WIDTH, ROD_CAMERA_HEIGHT);
         camera_destroy(ctx->camera);
+        ctx->camera = NULL;
+        return -1;
+    }
+    printf("Camera resolution set to %dx%d\n", ROD_CAMERA_WIDTH, ROD_CAMERA_HEIGHT);
+
+    // Luma-only main stream for detection, low resolution color stream for debug images
+    if (camera_interface_set_format(ctx->camera, ROD_CAMERA_FORMAT,
+                                    ROD_CAMERA_PREVIEW_WIDTH, ROD_CAMERA_PREVIEW_HEIGHT) != 0) {
+        fprintf(stderr, "Failed to set camera format\n");
+        return -1;
+    }
+    if (camera_interface_set_buffering(ctx->camera, ROD_CAMERA_BUFFER_COUNT, ROD_CAMERA_NEWEST_FRAME_ONLY) != 0) {
+        fprintf(stderr, "Failed to set camera buffering\n");
         return -1;
     }
-    printf("Camera resolution set to 4056x3040\n");
-    
+
     // Configure camera based on type
     if (camera_type == CAMERA_TYPE_EMULATED) {
         // Set image folder for emulated camera
@@ -158,472 +519,1585 @@ static int init_app_context(AppContext* ctx, CameraType camera_type, const char*
             return -1;
         }
         printf("Emulated camera folder: %s\n", image_folder);
+        if (camera_interface_set_prefetch(ctx->camera, ROD_EMULATED_PREFETCH_DEPTH, EMULATED_PRELOAD) != 0) {
+            fprintf(stderr, "Failed to set emulated camera prefetch\n");
+            return -1;
+        }
     } else {
-        // Configure real camera with "match" parameters from test_camera_parameters.c
-        // ArUco optimized for full resolution (4056x3040)
+        // Sensor modes: pick ROD_CAMERA_SENSOR_MODE_* among these for the speed vs resolution trade-off
+        CameraSensorMode modes[SENSOR_MODE_MAX];
+        int mode_count = camera_interface_list_sensor_modes(ctx->camera, modes, SENSOR_MODE_MAX);
+        for (int i = 0; i < mode_count; i++) {
+            printf("Sensor mode %d: %dx%d %d bits, up to %.1f fps\n", i, modes[i].width, modes[i].height,
+                   modes[i].bit_depth, modes[i].max_fps);
+        }
+        if (ROD_CAMERA_SENSOR_MODE_WIDTH > 0) {
+            CameraSensorMode mode = {ROD_CAMERA_SENSOR_MODE_WIDTH, ROD_CAMERA_SENSOR_MODE_HEIGHT,
+                                     ROD_CAMERA_SENSOR_MODE_BIT_DEPTH, 0.0};
+            if (camera_interface_set_sensor_mode(ctx->camera, &mode) != 0) {
+                fprintf(stderr, "Failed to set sensor mode %dx%d\n", mode.width, mode.height);
+                return -1;
+            }
+        }
+
+        // Camera controls of the runtime configuration
+        // (defaults: "match" parameters from test_camera_parameters.c, ArUco optimized for 4056x3040)
         RodCameraParameters params;
-        params.exposure_time = -1;           // Let AE decide (auto-exposure)
-        params.analogue_gain = -1.0f;        // Let AE decide (auto-exposure)
-        params.brightness = 0.0f;            // Default brightness
-        params.contrast = 1.5f;              // Slight contrast boost for black/white markers
-        params.saturation = -1.0f;           // Default saturation (auto)
-        params.sharpness = 4.0f;             // Moderate sharpness boost for ArUco detection
-        params.awb_enable = 1;               // Auto white balance enabled
-        params.aec_enable = 1;               // Auto-exposure enabled for adaptability
-        params.noise_reduction_mode = 2;     // HighQuality
-        
+        fill_camera_parameters(&ctx->config, &params);
         camera_interface_set_parameters(ctx->camera, &params);
-        printf("Real camera using 'match' parameters (4056x3040, ArUco optimized)\n");
+        printf("Real camera using 'match' parameters (%dx%d, ArUco optimized)\n", ROD_CAMERA_WIDTH, ROD_CAMERA_HEIGHT);
     }
-    
+
     // Start camera
     if (camera_interface_start(ctx->camera) != 0) {
         fprintf(stderr, "Failed to start camera\n");
         return -1;
     }
     printf("Camera started successfully\n");
-    
+
     // Initialize ArUco detector
     printf("Initializing ArUco detector...\n");
-    ctx->dictionary = getPredefinedDictionary(rod_config_get_aruco_dictionary_type());
+    ctx->dictionary = rod_config_create_aruco_dictionary();
     if (!ctx->dictionary) {
         fprintf(stderr, "Failed to create ArUco dictionary\n");
         return -1;
     }
-    
+
     ctx->params = createDetectorParameters();
     if (!ctx->params) {
         fprintf(stderr, "Failed to create detector parameters\n");
         return -1;
     }
-    
-    // Configure detector with optimized parameters
-    rod_config_configure_detector_parameters(ctx->params);
-    
+
+    // Configure detector with the runtime detector settings (optimized defaults)
+    rod_runtime_config_apply_detector(&ctx->config, ctx->params);
+
+    // Two detectors: the detect stage replaces its own on reload while the preprocess stage may read the other
     ctx->detector = createArucoDetector(ctx->dictionary, ctx->params);
-    if (!ctx->detector) {
+    ctx->mask_detector = createArucoDetector(ctx->dictionary, ctx->params);
+    if (!ctx->detector || !ctx->mask_detector) {
         fprintf(stderr, "Failed to create ArUco detector\n");
         return -1;
     }
-    printf("ArUco detector initialized (DICT_4X4_50)\n");
-    
+    printf("ArUco detector initialized (DICT_4X4_50%s, threshold windows %d-%d step %d)\n",
+           ROD_RESTRICTED_DICTIONARY ? " restricted to valid IDs" : "",
+           ctx->config.detector.adaptive_thresh_win_size_min, ctx->config.detector.adaptive_thresh_win_size_max,
+           ctx->config.detector.adaptive_thresh_win_size_step);
+
+    if (ROD_ROI_TRACKING_ENABLED) {
+        ctx->roi_tracker = rod_roi_tracker_create(ROD_ROI_FULL_SCAN_INTERVAL, ROD_ROI_PADDING_RATIO);
+        if (!ctx->roi_tracker) {
+            fprintf(stderr, "Failed to create ROI tracker\n");
+            return -1;
+        }
+        rod_roi_tracker_set_pyramid_scale(ctx->roi_tracker, DETECTION_PYRAMID_SCALE);
+        printf("ROI tracking enabled (full scan every %d frames)\n", ROD_ROI_FULL_SCAN_INTERVAL);
+    }
+    if (DETECTION_TILES_X * DETECTION_TILES_Y > 1) {
+        printf("Tiled detection enabled (%dx%d tiles once the field is known)\n", DETECTION_TILES_X, DETECTION_TILES_Y);
+    }
+    if (DETECTION_PYRAMID_SCALE < 1.0f) {
+        printf("Pyramid detection enabled (coarse scale %.2f, full resolution corner refinement)\n",
+               DETECTION_PYRAMID_SCALE);
+    }
+
     // Field mask will be created dynamically from first captured frame
     // that contains all 4 fixed markers (IDs 20-23)
     printf("Field mask will be created dynamically from captured frames\n");
     ctx->field_mask = NULL;
-    
+
+    // Then refreshed in the background if the camera moves
+    if (RECALIBRATION_ENABLED) {
+        ctx->recalibrator = rod_recalibrator_create(CROP_TO_FIELD, FIELD_MASK_SCALE_Y, RECALIBRATION_DRIFT_MM);
+        if (!ctx->recalibrator) {
+            fprintf(stderr, "Failed to create recalibrator\n");
+            return -1;
+        }
+        printf("Background recalibration enabled (field corner drift > %.1f mm)\n", RECALIBRATION_DRIFT_MM);
+    }
+
+    if (MARKER_FILTER_ENABLED) {
+        ctx->marker_filter = rod_marker_filter_create(ROD_MARKER_FILTER_ALPHA, ROD_MARKER_FILTER_BETA,
+                                                      ROD_MARKER_FILTER_GATE_MM, ROD_MARKER_FILTER_CONFIRM_HITS,
+                                                      ROD_MARKER_FILTER_MAX_AGE_MS, ROD_MARKER_FILTER_VELOCITY_DECAY);
+        if (!ctx->marker_filter) {
+            fprintf(stderr, "Failed to create marker filter\n");
+            return -1;
+        }
+        printf("Marker filter enabled (gate %.0f mm, predicted up to %d ms)\n",
+               ROD_MARKER_FILTER_GATE_MM, ROD_MARKER_FILTER_MAX_AGE_MS);
+    }
+
+    // Without ROI tracking there is no regions-only detection: static frames are all carried over
+    if (MOTION_GATE_ENABLED) {
+        RodMotionGateConfig gate_config = {
+            .grid_cols = ROD_MOTION_GATE_GRID_COLS,
+            .grid_rows = ROD_MOTION_GATE_GRID_ROWS,
+            .cell_threshold = ROD_MOTION_GATE_CELL_THRESHOLD,
+            .min_changed_cells = ROD_MOTION_GATE_MIN_CELLS,
+            .settle_frames = ROD_MOTION_GATE_SETTLE_FRAMES,
+            .roi_interval = ctx->roi_tracker ? ROD_MOTION_GATE_ROI_INTERVAL : 0,
+            .full_interval_us = (uint64_t)ROD_MOTION_GATE_FULL_INTERVAL_MS * 1000,
+        };
+        ctx->motion_gate = rod_motion_gate_create(&gate_config);
+        if (!ctx->motion_gate) {
+            fprintf(stderr, "Failed to create motion gate\n");
+            return -1;
+        }
+        printf("Motion-gated detection enabled (static field: full frame every %d ms)\n",
+               ROD_MOTION_GATE_FULL_INTERVAL_MS);
+    }
+
+    // Image headers reused for every frame, detections written into the slots
+    ctx->image_pool = image_pool_create(IMAGE_POOL_SIZE);
+    if (!ctx->image_pool) {
+        fprintf(stderr, "Failed to create image pool\n");
+        return -1;
+    }
+    for (int i = 0; i < PIPELINE_SLOTS; i++) {
+        ctx->slots[i].detection_storage.markers = ctx->slots[i].detected_markers;
+        ctx->slots[i].detection_storage.count = 0;
+    }
+
+    // Start background image writer (JPEG encoding and disk I/O off the pipeline)
+    ctx->writer = rod_writer_create(ROD_WRITER_QUEUE_DEPTH, ROD_WRITER_DROP_POLICY);
+    if (!ctx->writer) {
+        fprintf(stderr, "Failed to start image writer\n");
+        return -1;
+    }
+
     return 0;
 }
 
+/**
+ * @brief Give the borrowed camera frame of a slot back to the camera
+ */
+static void release_slot_frame(AppContext* ctx, FrameSlot* slot) {
+    if (slot->original_image) {
+        image_pool_release(ctx->image_pool, slot->original_image);
+        slot->original_image = NULL;
+    }
+
+    if (slot->has_frame) {
+        camera_interface_release_frame(ctx->camera, &slot->frame);
+        slot->has_frame = false;
+    }
+}
+
+/**
+ * @brief Release per-frame resources of a slot (reusable buffers are kept)
+ */
+static void reset_slot(AppContext* ctx, FrameSlot* slot) {
+    release_slot_frame(ctx, slot);
+
+    if (slot->raw_copy) {
+        release_image(slot->raw_copy);
+        slot->raw_copy = NULL;
+    }
+    if (slot->stream_copy) {
+        release_image(slot->stream_copy);
+        slot->stream_copy = NULL;
+    }
+    if (slot->session_copy) {
+        release_image(slot->session_copy);
+        slot->session_copy = NULL;
+    }
+
+    slot->detection = NULL;
+
+    slot->detect_input = NULL;
+    slot->tile_overlap = -1;
+    slot->detect_offset_x = 0;
+    slot->detect_offset_y = 0;
+    slot->valid_count = 0;
+    slot->filtered_count = 0;
+    slot->schedule = ROD_MOTION_DETECT;
+}
+
+/**
+ * @brief Reset a slot and hand it back to the capture stage
+ */
+static void recycle_slot(AppContext* ctx, FrameSlot* slot) {
+    reset_slot(ctx, slot);
+
+    // Fails only once the pipeline is shut down (slots are then released in cleanup)
+    if (ctx->free_slots) {
+        rod_frame_queue_push(ctx->free_slots, slot);
+    }
+}
+
 static void cleanup_app_context(AppContext* ctx) {
     if (!ctx) return;
-    
-    // Release reusable buffers
-    if (ctx->buffer_resized) {
-        release_image(ctx->buffer_resized);
-        ctx->buffer_resized = NULL;
-    }
-    
-    if (ctx->buffer_masked) {
-        release_image(ctx->buffer_masked);
-        ctx->buffer_masked = NULL;
-    }
-    
-    if (ctx->buffer_sharpened) {
-        release_image(ctx->buffer_sharpened);
-        ctx->buffer_sharpened = NULL;
-    }
-    
+
+    // Release frame slots (borrowed frames must go back before the camera stops)
+    for (int i = 0; i < PIPELINE_SLOTS; i++) {
+        FrameSlot* slot = &ctx->slots[i];
+        reset_slot(ctx, slot);
+
+        if (slot->buffer_masked) {
+            release_image(slot->buffer_masked);
+            slot->buffer_masked = NULL;
+        }
+
+        if (slot->buffer_sharpened) {
+            release_image(slot->buffer_sharpened);
+            slot->buffer_sharpened = NULL;
+        }
+    }
+
+    // Disconnect stream clients
+    if (ctx->stream) {
+        rod_stream_destroy(ctx->stream);
+        ctx->stream = NULL;
+    }
+
+    // Flush pending debug images
+    if (ctx->writer) {
+        rod_writer_destroy(ctx->writer);
+        ctx->writer = NULL;
+    }
+
+    // Index the recorded session (every queued frame is written by now)
+    if (ctx->session) {
+        int recorded = rod_session_writer_count(ctx->session);
+        if (rod_session_writer_close(ctx->session) == 0) {
+            printf("Session recorded: %d frames\n", recorded);
+        } else {
+            fprintf(stderr, "Session closed without index, %d frames recoverable\n", recorded);
+        }
+        ctx->session = NULL;
+    }
+
+    // Destroy stage queues
+    rod_frame_queue_destroy(ctx->free_slots);
+    rod_frame_queue_destroy(ctx->preprocess_queue);
+    rod_frame_queue_destroy(ctx->detect_queue);
+    rod_frame_queue_destroy(ctx->publish_queue);
+    ctx->free_slots = NULL;
+    ctx->preprocess_queue = NULL;
+    ctx->detect_queue = NULL;
+    ctx->publish_queue = NULL;
+
+    // Stop the recalibration thread (releases a calibration not swapped in yet)
+    rod_recalibrator_destroy(ctx->recalibrator);
+    ctx->recalibrator = NULL;
+
     // Release field mask
     if (ctx->field_mask) {
         release_image(ctx->field_mask);
         ctx->field_mask = NULL;
     }
-    
+
+    // Slot views went back above
+    if (ctx->image_pool) {
+        image_pool_destroy(ctx->image_pool);
+        ctx->image_pool = NULL;
+    }
+
+    rod_metrics_destroy(ctx->metrics);
+    ctx->metrics = NULL;
+
+    if (ctx->roi_tracker) {
+        rod_roi_tracker_destroy(ctx->roi_tracker);
+        ctx->roi_tracker = NULL;
+    }
+
+    if (ctx->localization_grid) {
+        rod_localization_grid_destroy(ctx->localization_grid);
+        ctx->localization_grid = NULL;
+    }
+
+    rod_marker_filter_destroy(ctx->marker_filter);
+    ctx->marker_filter = NULL;
+
+    rod_motion_gate_destroy(ctx->motion_gate);
+    ctx->motion_gate = NULL;
+
     // Cleanup ArUco detector
     if (ctx->detector) {
         releaseArucoDetector(ctx->detector);
         ctx->detector = NULL;
     }
-    
+    if (ctx->mask_detector) {
+        releaseArucoDetector(ctx->mask_detector);
+        ctx->mask_detector = NULL;
+    }
+
     if (ctx->dictionary) {
         releaseArucoDictionary(ctx->dictionary);
         ctx->dictionary = NULL;
     }
-    
+
     if (ctx->params) {
         releaseDetectorParameters(ctx->params);
         ctx->params = NULL;
     }
-    
+
     // Cleanup camera
     if (ctx->camera) {
         camera_interface_stop(ctx->camera);
         camera_destroy(ctx->camera);
         ctx->camera = NULL;
     }
-    
+
     // Close socket
+    if (ctx->shm_publisher) {
+        rod_shm_publisher_destroy(ctx->shm_publisher);
+        ctx->shm_publisher = NULL;
+    }
+
     if (ctx->socket_server) {
         rod_socket_server_destroy(ctx->socket_server);
         ctx->socket_server = NULL;
     }
+
+    pthread_mutex_destroy(&ctx->config_lock);
 }
 
+/* ************************************************** Runtime configuration ********************************************** */
+
 /**
- * @brief Main function of the program
- * Takes a picture with the camera, find the aruco markers position with rod-cv, 
- * and send the position to rod-com via socket.
+ * @brief Load the configuration file after a SIGHUP and hand it to the capture stage (main thread)
  */
-int main(int argc, char* argv[]) {
-    AppContext ctx;
-    const char* image_folder = DEFAULT_IMAGE_FOLDER;
-    CameraType camera_type = CAMERA_TYPE_IMX477;  // Default to real camera
-    
-    // Parse command line arguments
-    // Usage: rod_detection [--camera real|emulated] [image_folder]
-    for (int i = 1; i < argc; i++) {
-        if (strcmp(argv[i], "--camera") == 0 && i + 1 < argc) {
-            i++;
-            if (strcmp(argv[i], "real") == 0) {
-                camera_type = CAMERA_TYPE_IMX477;
-            } else if (strcmp(argv[i], "emulated") == 0) {
-                camera_type = CAMERA_TYPE_EMULATED;
-            } else {
-                fprintf(stderr, "Unknown camera type: %s (use 'real' or 'emulated')\n", argv[i]);
-                return 1;
-            }
-        } else {
-            // Assume it's the image folder path
-            image_folder = argv[i];
-        }
-    }
-    
-    // Check environment variable for camera type (command-line takes precedence)
-    const char* env_camera = getenv("ROD_CAMERA_TYPE");
-    if (env_camera && argc == 1) {  // Only use env var if no command-line args
-        if (strcmp(env_camera, "real") == 0) {
-            camera_type = CAMERA_TYPE_IMX477;
-        } else if (strcmp(env_camera, "emulated") == 0) {
-            camera_type = CAMERA_TYPE_EMULATED;
-        }
+static void reload_config_if_requested(AppContext* ctx) {
+    if (!g_reload_requested) return;
+    g_reload_requested = 0;
+
+    if (!ctx->config_path) {
+        printf("Reload ignored: no runtime configuration file\n");
+        return;
     }
-    
-    printf("=== ROD Detection - Computer Vision Thread ===\n");
-    printf("Camera type: %s\n", camera_type == CAMERA_TYPE_IMX477 ? "Real (IMX477)" : "Emulated");
-    if (camera_type == CAMERA_TYPE_EMULATED) {
-        printf("Image folder: %s\n", image_folder);
+
+    // An invalid file is rejected as a whole: the frames keep the current settings
+    RodRuntimeConfig config;
+    if (rod_runtime_config_load(ctx->config_path, &ctx->base_config, &config) != 0) {
+        fprintf(stderr, "Reload of %s failed, current settings kept\n", ctx->config_path);
+        return;
     }
-    printf("\n");
-    
-    // Setup signal handler for graceful shutdown
-    signal(SIGINT, signal_handler);
-    signal(SIGTERM, signal_handler);
-    
-    // Initialize application context
-    if (init_app_context(&ctx, camera_type, image_folder) != 0) {
-        fprintf(stderr, "Failed to initialize application\n");
-        cleanup_app_context(&ctx);
-        return 1;
+
+    pthread_mutex_lock(&ctx->config_lock);
+    ctx->pending_config = config;
+    ctx->config_pending = true;
+    pthread_mutex_unlock(&ctx->config_lock);
+    printf("Runtime configuration reloaded from %s\n", ctx->config_path);
+
+    if (config.sequential != ctx->sequential) {
+        ctx->sequential = config.sequential;
+        printf("Switching to %s mode\n", config.sequential ? "sequential" : "pipelined");
     }
-    
-    // Initialize socket server
-    ctx.socket_server = rod_socket_server_create(SOCKET_PATH);
-    if (!ctx.socket_server) {
-        fprintf(stderr, "Failed to initialize socket server\n");
-        cleanup_app_context(&ctx);
-        return 1;
+}
+
+/**
+ * @brief Swap in a reloaded configuration between two frames (capture stage)
+ */
+static void apply_pending_config(AppContext* ctx) {
+    pthread_mutex_lock(&ctx->config_lock);
+    bool pending = ctx->config_pending;
+    RodRuntimeConfig config;
+    if (pending) {
+        config = ctx->pending_config;
+        ctx->config_pending = false;
     }
-    
-    printf("\nStarting detection loop (Ctrl+C to stop)...\n");
-    
-    // Main detection loop
-    int frame_count = 0;
-    while (g_running && ctx.running) {
-        frame_count++;
-        double t_loop_start = get_time_ms();
-        
-        // Generate timestamp for this frame (used for both logging and file naming)
-        char frame_timestamp[32];
-        rod_config_generate_filename_timestamp(frame_timestamp, sizeof(frame_timestamp));
-        
-        // Try to accept a client connection if not already connected
-        rod_socket_server_accept(ctx.socket_server);
-        
-        // Capture image from camera
-        uint8_t* image_buffer = NULL;
-        int width, height;
-        size_t size;
-        double t_capture_start = get_time_ms();
-        
-        if (camera_interface_capture_frame(ctx.camera, &image_buffer, 
-                                &width, &height, &size) != 0) {
-            fprintf(stderr, "Failed to capture image\n");
-            usleep(10000);  // Wait 10ms before retry
-            continue;
+    pthread_mutex_unlock(&ctx->config_lock);
+    if (!pending) return;
+
+    // Camera: new controls on the next requests, the stream keeps running
+    if (!rod_runtime_config_same_camera(&ctx->config, &config)) {
+        RodCameraParameters params;
+        fill_camera_parameters(&config, &params);
+        if (camera_interface_set_parameters(ctx->camera, &params) != 0) {
+            fprintf(stderr, "Failed to apply camera controls, previous ones kept\n");
+            config.camera = ctx->config.camera;
         }
-        double t_capture_end = get_time_ms();
-        
-        // Create OpenCV image handle from BGR buffer
-        // Camera returns BGR format (format=0, OpenCV native - no conversion)
-        double t_create_start = get_time_ms();
-        ImageHandle* original_image = create_image_from_buffer(image_buffer, width, height, 3, 0);
-        free(image_buffer);  // Buffer is copied by create_image_from_buffer
-        double t_create_end = get_time_ms();
-        
-        if (!original_image) {
-            fprintf(stderr, "Failed to create image from buffer\n");
-            usleep(10000);  // Wait 10ms before retry
-            continue;
+    }
+    ctx->config = config;
+}
+
+/**
+ * @brief Rebuild the detector when the frame was captured with other detector settings (detect stage)
+ */
+static void update_detector(AppContext* ctx, const FrameSlot* slot) {
+    if (rod_runtime_config_same_detector(&slot->config, &ctx->detector_config)) return;
+    ctx->detector_config = slot->config;  // Not retried on every frame if the build fails
+
+    // New parameters object: the mask detector still shares the startup one
+    DetectorParametersHandle* params = createDetectorParameters();
+    ArucoDetectorHandle* detector = NULL;
+    if (params) {
+        rod_runtime_config_apply_detector(&slot->config, params);
+        detector = createArucoDetector(ctx->dictionary, params);
+        releaseDetectorParameters(params);  // The detector keeps its own reference
+    }
+    if (!detector) {
+        fprintf(stderr, "Failed to rebuild ArUco detector, previous settings kept\n");
+        return;
+    }
+
+    releaseArucoDetector(ctx->detector);
+    ctx->detector = detector;
+    printf("ArUco detector rebuilt from frame %d (threshold windows %d-%d step %d)\n", slot->frame_index,
+           slot->config.detector.adaptive_thresh_win_size_min, slot->config.detector.adaptive_thresh_win_size_max,
+           slot->config.detector.adaptive_thresh_win_size_step);
+}
+
+/* ******************************************************* Pipeline stages *********************************************** */
+
+static int stage_capture(AppContext* ctx, FrameSlot* slot) {
+    memset(&slot->t, 0, sizeof(slot->t));
+    apply_pending_config(ctx);
+
+    // Borrow frame from camera (zero-copy: data stays in the camera buffer)
+    slot->t.capture_start = get_time_ms();
+    if (camera_interface_acquire_frame(ctx->camera, &slot->frame) != 0) {
+        fprintf(stderr, "Failed to capture image\n");
+        usleep(10000);  // Wait 10ms before retry
+        return -1;
+    }
+    slot->has_frame = true;
+    slot->t.capture_end = get_time_ms();
+    slot->t.exposure = slot->frame.timestamp_ns > 0 ? slot->frame.timestamp_ns / 1000000.0 : slot->t.capture_end;
+
+    slot->frame_index = ++ctx->frame_count;
+    slot->sequence = slot->frame.sequence;
+    slot->config = ctx->config;
+
+    // Generate timestamp for this frame (used for both logging and file naming)
+    rod_config_generate_filename_timestamp(slot->timestamp, sizeof(slot->timestamp));
+
+    // Wrap the borrowed buffer in an image view (no copy)
+    // BGR888 (OpenCV native) or the YUV420 Y plane, used directly as a gray image
+    slot->t.create_start = get_time_ms();
+    slot->original_image = image_pool_acquire_view(ctx->image_pool, slot->frame.data, slot->frame.width,
+                                                   slot->frame.height, camera_frame_channels(&slot->frame),
+                                                   slot->frame.stride);
+    slot->t.create_end = get_time_ms();
+
+    if (!slot->original_image) {
+        fprintf(stderr, "Failed to create image from buffer\n");
+        release_slot_frame(ctx, slot);
+        usleep(10000);  // Wait 10ms before retry
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Keep a raw copy on debug save frames, a stream copy on tapped frames and
+ * a full frame copy on recorded frames, then give the camera buffer back
+ */
+static void keep_raw_and_release_frame(AppContext* ctx, FrameSlot* slot) {
+    // Sessions keep the main stream as delivered (luma plane in YUV420), at full resolution
+    if (ctx->session && slot->frame_index % SESSION_RECORD_INTERVAL == 0) {
+        slot->session_copy = clone_image(slot->original_image);
+    }
+
+    // Copy the raw frame only when it will be saved or streamed, then release the
+    // camera buffer as early as possible (the preprocessed image is owned).
+    // The color preview is preferred: smaller, and the main stream may be luma only
+    bool save = slot->frame_index % slot->config.save_debug_image_interval == 0;
+    bool stream = rod_stream_wants_frame(ctx->stream, (uint64_t)(get_time_ms() * 1000.0));
+    if (save || stream) {
+        ImageHandle* source = slot->original_image;
+        ImageHandle* preview = NULL;
+        float source_scale = 1.0f;
+        if (slot->frame.preview_data) {
+            preview = image_pool_acquire_view(ctx->image_pool, slot->frame.preview_data,
+                                              slot->frame.preview_width, slot->frame.preview_height, 3,
+                                              slot->frame.preview_stride);
+            if (preview) {
+                source = preview;
+                source_scale = (float)slot->frame.preview_width / (float)slot->frame.width;
+            }
         }
-        
-        // ===== PREPROCESSING PIPELINE (matching Python implementation) =====
-        // Step 1: Apply sharpening filter to enhance marker edges (reuse buffer)
-        double t_sharpen_start = get_time_ms();
-        ctx.buffer_sharpened = sharpen_image_reuse(original_image, ctx.buffer_sharpened);
-        double t_sharpen_end = get_time_ms();
-        if (!ctx.buffer_sharpened) {
-            fprintf(stderr, "Failed to sharpen image\n");
-            release_image(original_image);
-            usleep(10000);
-            continue;
+
+        if (save) {
+            slot->raw_copy = clone_image(source);
+            slot->raw_scale = source_scale;
         }
-        
-        // Step 2: Create field mask if not already created (from current frame)
-        double t_mask_start = get_time_ms();
-        if (!ctx.field_mask) {
-            // Try to create mask and compute homography from current sharpened image
-            ctx.field_mask = create_field_mask_from_image(ctx.buffer_sharpened, ctx.detector, width, height, 1.1f, ctx.homography_inv);
-            if (ctx.field_mask) {
-                ctx.has_homography = true;
-                printf("[Frame %d] Field mask and homography created successfully from captured frame\n", frame_count);
-            }
+
+        // Stream copy: downscaled and expanded to BGR in one copy
+        int source_width = get_image_width(source);
+        if (stream && source_width > 0) {
+            int width = (STREAM_WIDTH > 0 && source_width > STREAM_WIDTH) ? STREAM_WIDTH : source_width;
+            int height = (int)((float)get_image_height(source) * (float)width / (float)source_width + 0.5f);
+            slot->stream_copy = resize_to_bgr_reuse(source, width, height > 0 ? height : 1, NULL);
+            slot->stream_scale = source_scale * (float)width / (float)source_width;
         }
-        
-        // Step 3: Apply field mask to filter out areas outside the playing field (reuse buffer)
-        ImageHandle* masked_image = ctx.buffer_sharpened;  // Default to sharpened
-        if (ctx.field_mask) {
-            ctx.buffer_masked = bitwise_and_mask_reuse(ctx.buffer_sharpened, ctx.field_mask, ctx.buffer_masked);
-            if (!ctx.buffer_masked) {
-                fprintf(stderr, "Failed to apply mask, using unmasked image\n");
-                masked_image = ctx.buffer_sharpened;
-            } else {
-                masked_image = ctx.buffer_masked;
-            }
+
+        if (preview) {
+            image_pool_release(ctx->image_pool, preview);
         }
-        double t_mask_end = get_time_ms();
-        
-        // Step 4: Resize image (1.5x scale) for better detection of small/distant markers (reuse buffer)
-        double t_resize_start = get_time_ms();
-        // Resizing disabled for now (DETECTION_SCALE_FACTOR = 1.0)
-        // int new_width = (int)(width * DETECTION_SCALE_FACTOR);
-        // int new_height = (int)(height * DETECTION_SCALE_FACTOR);
-        // ctx.buffer_resized = resize_image_reuse(masked_image, new_width, new_height, ctx.buffer_resized);
-        
-        ctx.buffer_resized = masked_image;  // No resizing for now (keep original size for detection)
-        double t_resize_end = get_time_ms();
-        
-        // Step 5: Detect ArUco markers on preprocessed image
-        double t_detect_start = get_time_ms();
-        DetectionResult* detection = detectMarkersWithConfidence(ctx.detector, ctx.buffer_resized);
-        // Note: We keep buffer_resized for reuse in next frame
-        double t_detect_end = get_time_ms();
-        
-        // Step 6: Scale coordinates back to original image size
-        if (detection && detection->count > 0) {
-            for (int i = 0; i < detection->count; i++) {
-                for (int j = 0; j < 4; j++) {
-                    detection->markers[i].corners[j][0] /= DETECTION_SCALE_FACTOR;
-                    detection->markers[i].corners[j][1] /= DETECTION_SCALE_FACTOR;
-                }
-            }
+    }
+    release_slot_frame(ctx, slot);
+}
+
+/**
+ * @brief Create the field mask if needed and snapshot the homography into the slot
+ * @return true if the mask was created from this frame
+ */
+static bool update_field_mask(AppContext* ctx, FrameSlot* slot, ImageHandle* image) {
+    bool created = false;
+
+    // Own detector: the detect stage may replace its detector meanwhile
+    if (!ctx->field_mask) {
+        // Try to create mask and compute homography from current preprocessed image
+        if (CROP_TO_FIELD) {
+            ctx->field_mask = create_field_mask_with_roi(image, ctx->mask_detector, slot->frame.width, slot->frame.height,
+                                                         FIELD_MASK_SCALE_Y, ctx->homography_inv, &ctx->field_roi);
+        } else {
+            ctx->field_mask = create_field_mask_from_image(image, ctx->mask_detector, slot->frame.width, slot->frame.height,
+                                                           FIELD_MASK_SCALE_Y, ctx->homography_inv);
+            ctx->field_roi = (RoiRect){0, 0, slot->frame.width, slot->frame.height};
         }
-        
-        if (detection && detection->count > 0) {
-            // Localize markers in playground coordinates using homography transformation
-            double t_pose_start = get_time_ms();
-            MarkerData markers[100];  // Max 100 markers
-            int valid_count = 0;
-            
-            if (ctx.has_homography) {
-                // Use homography for pixel -> terrain transformation
-                valid_count = localize_markers_in_playground(detection, markers, 100, ctx.homography_inv);
-            } else {
-                // Fallback to pixel coordinates if no homography available
-                valid_count = filter_valid_markers(detection, markers, 100);
+        if (ctx->field_mask) {
+            ctx->has_homography = true;
+            created = true;
+            rod_recalibrator_set_reference(ctx->recalibrator, ctx->homography_inv,
+                                           slot->frame.width, slot->frame.height);
+            // Tiles must hold the largest marker: measure it where the field looks biggest
+            int extent = estimate_marker_extent_px(ctx->homography_inv, ctx->field_roi);
+            ctx->tile_overlap = extent > 0 ? (int)ceilf(extent * DETECTION_TILE_MARGIN) : -1;
+            printf("[Frame %d] Field mask and homography created successfully from captured frame\n", slot->frame_index);
+            if (CROP_TO_FIELD) {
+                printf("[Frame %d] Processing cropped to field %dx%d at (%d,%d), %.0f%% of the frame\n",
+                       slot->frame_index, ctx->field_roi.width, ctx->field_roi.height, ctx->field_roi.x, ctx->field_roi.y,
+                       100.0 * ctx->field_roi.width * ctx->field_roi.height / ((double)slot->frame.width * slot->frame.height));
+            }
+            if (DETECTION_TILES_X * DETECTION_TILES_Y > 1 && ctx->tile_overlap >= 0) {
+                printf("[Frame %d] Tiled detection %dx%d, overlap %d px\n",
+                       slot->frame_index, DETECTION_TILES_X, DETECTION_TILES_Y, ctx->tile_overlap);
             }
-            double t_pose_end = get_time_ms();
-            
-            // Count markers by category for reporting
-            MarkerCounts marker_counts = count_markers_by_category(markers, valid_count);
-            
-            // Send detection results
-            if (valid_count > 0) {
-                rod_socket_server_send_detections(ctx.socket_server, markers, valid_count);
+        }
+    }
+
+    // Snapshot the homography so the publish stage never reads it while it changes
+    slot->has_homography = ctx->has_homography;
+    slot->tile_overlap = ctx->tile_overlap;
+    if (ctx->has_homography) {
+        memcpy(slot->homography_inv, ctx->homography_inv, sizeof(slot->homography_inv));
+    }
+
+    return created;
+}
+
+/**
+ * @brief Swap in the calibration rebuilt by the recalibration thread, if one is ready
+ *
+ * Runs before anything reads the mask of this frame: the old mask is handed
+ * back to the recalibrator, and the homography reaches the publish stage
+ * through the slot snapshot like the first one.
+ */
+static void apply_recalibration(AppContext* ctx, FrameSlot* slot) {
+    if (!ctx->field_mask) return;
+
+    RodCalibration active = {ctx->field_mask, ctx->field_roi, {0}, 0.0f};
+    memcpy(active.homography_inv, ctx->homography_inv, sizeof(active.homography_inv));
+    if (!rod_recalibrator_swap(ctx->recalibrator, &active)) return;
+
+    ctx->field_mask = active.field_mask;
+    ctx->field_roi = active.field_roi;
+    memcpy(ctx->homography_inv, active.homography_inv, sizeof(ctx->homography_inv));
+    int extent = estimate_marker_extent_px(ctx->homography_inv, ctx->field_roi);
+    ctx->tile_overlap = extent > 0 ? (int)ceilf(extent * DETECTION_TILE_MARGIN) : -1;
+    rod_motion_gate_force_full(ctx->motion_gate);  // Carried positions came from the previous homography
+    printf("[Frame %d] Field recalibrated in background (previous homography off by %.1f mm), field %dx%d at (%d,%d)\n",
+           slot->frame_index, active.drift_mm, ctx->field_roi.width, ctx->field_roi.height,
+           ctx->field_roi.x, ctx->field_roi.y);
+}
+
+/**
+ * @brief Let the motion gate decide how the frame is detected, from the changes on the field
+ *
+ * Gated once the field is known only: until then any frame may create the field mask.
+ * @return true if the frame is skipped (nothing to preprocess nor detect)
+ */
+static bool schedule_detection(AppContext* ctx, FrameSlot* slot) {
+    slot->schedule = ROD_MOTION_DETECT;
+    if (!ctx->motion_gate || !ctx->field_mask) return false;
+
+    // The camera buffer is still borrowed: compare the field bounding box in place
+    int channels = camera_frame_channels(&slot->frame);
+    const uint8_t* field = slot->frame.data + (size_t)ctx->field_roi.y * slot->frame.stride +
+                           (size_t)ctx->field_roi.x * (size_t)channels;
+    slot->schedule = rod_motion_gate_update(ctx->motion_gate, field, ctx->field_roi.width, ctx->field_roi.height,
+                                            slot->frame.stride, channels, (uint64_t)(slot->t.exposure * 1000.0));
+    if (slot->schedule != ROD_MOTION_SKIP) return false;
+
+    // Static field: the previous markers are carried over by the publish stage
+    keep_raw_and_release_frame(ctx, slot);
+    slot->t.sharpen_end = get_time_ms();
+    slot->t.mask_start = slot->t.mask_end = slot->t.sharpen_end;
+    slot->t.resize_start = slot->t.resize_end = slot->t.sharpen_end;
+    return true;
+}
+
+/**
+ * @brief Get the part of the camera frame to preprocess: the field bounding box once known
+ * @return View on the field (release to the image pool after use), or NULL to use the whole frame
+ */
+static ImageHandle* field_view(AppContext* ctx, FrameSlot* slot, ImageHandle* image) {
+    // The mask and its rectangle are only written by this stage, reading them here is safe
+    if (!ctx->field_mask) {
+        slot->detect_offset_x = 0;
+        slot->detect_offset_y = 0;
+        return NULL;
+    }
+    slot->detect_offset_x = ctx->field_roi.x;
+    slot->detect_offset_y = ctx->field_roi.y;
+    return image_pool_acquire_roi_view(ctx->image_pool, image, ctx->field_roi);
+}
+
+/**
+ * @brief Apply the field mask to a whole frame image (frame that created the mask only)
+ * @return Masked image of field_roi size (slot->buffer_masked), or NULL on failure
+ */
+static ImageHandle* mask_whole_frame(AppContext* ctx, FrameSlot* slot, ImageHandle* image) {
+    ImageHandle* view = field_view(ctx, slot, image);
+    if (!view) return NULL;
+    slot->buffer_masked = bitwise_and_mask_reuse(view, ctx->field_mask, slot->buffer_masked);
+    image_pool_release(ctx->image_pool, view);
+    return slot->buffer_masked;
+}
+
+/**
+ * @brief Fused preprocessing: one pass from the camera buffer to a masked, sharpened gray image
+ */
+static int preprocess_fused(AppContext* ctx, FrameSlot* slot) {
+    // Step 1-3: Sharpen, mask and convert to gray in a single pass (reuse buffer),
+    // on the field bounding box only once the mask exists
+    slot->t.sharpen_start = get_time_ms();
+    apply_recalibration(ctx, slot);
+    if (schedule_detection(ctx, slot)) return 0;
+    ImageHandle* view = field_view(ctx, slot, slot->original_image);
+    slot->buffer_sharpened = sharpen_mask_gray_reuse(view ? view : slot->original_image, ctx->field_mask,
+                                                     slot->buffer_sharpened);
+    image_pool_release(ctx->image_pool, view);
+    slot->t.sharpen_end = get_time_ms();
+    if (!slot->buffer_sharpened) {
+        fprintf(stderr, "Failed to preprocess image\n");
+        return -1;
+    }
+
+    keep_raw_and_release_frame(ctx, slot);
+
+    // Field mask creation (first frames only); the frame that creates it is masked separately
+    slot->t.mask_start = get_time_ms();
+    slot->detect_input = slot->buffer_sharpened;
+    if (update_field_mask(ctx, slot, slot->buffer_sharpened)) {
+        if (mask_whole_frame(ctx, slot, slot->buffer_sharpened)) {
+            slot->detect_input = slot->buffer_masked;
+        } else {
+            slot->detect_offset_x = 0;
+            slot->detect_offset_y = 0;
+        }
+    }
+    slot->t.mask_end = get_time_ms();
+
+    // No resizing (see DETECTION_SCALE_FACTOR)
+    slot->t.resize_start = slot->t.resize_end = get_time_ms();
+
+    return 0;
+}
+
+static int stage_preprocess(AppContext* ctx, FrameSlot* slot) {
+    if (PREPROCESS_FUSED) {
+        return preprocess_fused(ctx, slot);
+    }
+
+    // ===== PREPROCESSING PIPELINE (matching Python implementation) =====
+    // Step 1: Apply sharpening filter to enhance marker edges (reuse buffer),
+    // on the field bounding box only once the mask exists
+    slot->t.sharpen_start = get_time_ms();
+    apply_recalibration(ctx, slot);
+    if (schedule_detection(ctx, slot)) return 0;
+    ImageHandle* view = field_view(ctx, slot, slot->original_image);
+    slot->buffer_sharpened = sharpen_image_reuse(view ? view : slot->original_image, slot->buffer_sharpened);
+    image_pool_release(ctx->image_pool, view);
+    slot->t.sharpen_end = get_time_ms();
+    if (!slot->buffer_sharpened) {
+        fprintf(stderr, "Failed to sharpen image\n");
+        return -1;
+    }
+
+    keep_raw_and_release_frame(ctx, slot);
+
+    // Step 2: Create field mask if not already created (from current frame)
+    slot->t.mask_start = get_time_ms();
+    bool whole_frame = update_field_mask(ctx, slot, slot->buffer_sharpened);
+
+    // Step 3: Apply field mask to filter out areas outside the playing field (reuse buffer)
+    ImageHandle* masked_image = slot->buffer_sharpened;  // Default to sharpened
+    if (ctx->field_mask) {
+        if (whole_frame) {
+            // Mask created from this whole frame: crop to the field while masking
+            mask_whole_frame(ctx, slot, slot->buffer_sharpened);
+        } else {
+            slot->buffer_masked = bitwise_and_mask_reuse(slot->buffer_sharpened, ctx->field_mask, slot->buffer_masked);
+        }
+        if (!slot->buffer_masked) {
+            if (whole_frame) {
+                slot->detect_offset_x = 0;
+                slot->detect_offset_y = 0;
             }
-            double t_send_end = get_time_ms();
-            
-            // Save images periodically (raw camera + debug annotated)
-            double t_annotate_start = get_time_ms();
-            double t_annotate_end = t_annotate_start;  // Will be updated if annotation happens
-            double t_save_start = get_time_ms();
-            if (frame_count % SAVE_DEBUG_IMAGE_INTERVAL == 0) {
-                // Ensure date folders exist
-                char pictures_date_folder[256];
-                char debug_date_folder[256];
-                if (rod_config_ensure_date_folder(PICTURES_BASE_FOLDER, pictures_date_folder, sizeof(pictures_date_folder)) == 0 &&
-                    rod_config_ensure_date_folder(DEBUG_BASE_FOLDER, debug_date_folder, sizeof(debug_date_folder)) == 0) {
-                    
-                    // 1. Save raw camera image: /var/roboteseo/pictures/YYYY_MM_DD/YYYYMMDD_HHMMSS_MS.jpg
-                    char filename_camera[512];
-                    snprintf(filename_camera, sizeof(filename_camera), "%s/%s.jpg", pictures_date_folder, frame_timestamp);
-                    save_image(filename_camera, original_image);
-                    
-                    // 2. Save annotated debug image: /var/roboteseo/pictures/debug/YYYY_MM_DD/YYYYMMDD_HHMMSS_MS_debug.png
-                    int img_width = get_image_width(original_image);
-                    int img_height = get_image_height(original_image);
-                    int img_channels = get_image_channels(original_image);
-                    uint8_t* img_data = get_image_data(original_image);
-                    size_t img_data_size = get_image_data_size(original_image);
-                    
-                    if (img_data && img_data_size > 0) {
-                        uint8_t* data_copy = (uint8_t*)malloc(img_data_size);
-                        if (data_copy) {
-                            memcpy(data_copy, img_data, img_data_size);
-                            ImageHandle* annotated = create_image_from_buffer(data_copy, img_width, img_height, img_channels, 0);
-                            free(data_copy);
-                            
-                            if (annotated) {
-                                t_annotate_start = get_time_ms();
-                                // Only draw quadrilaterals for valid markers
-                                for (int i = 0; i < valid_count; i++) {
-                                    // Find corresponding marker in detection for corners
-                                    for (int j = 0; j < detection->count; j++) {
-                                        if (detection->markers[j].id == markers[i].id) {
-                                            DetectionResult single_marker;
-                                            single_marker.count = 1;
-                                            single_marker.markers = &detection->markers[j];
-                                            rod_viz_annotate_with_colored_quadrilaterals(annotated, &single_marker);
-                                            break;
-                                        }
-                                    }
-                                }
-                                rod_viz_annotate_with_counter(annotated, marker_counts);
-                                rod_viz_annotate_with_full_info(annotated, markers, valid_count);
-                                t_annotate_end = get_time_ms();
-                                
-                                // Convert BGR to RGB for output
-                                ImageHandle* annotated_rgb = convert_bgr_to_rgb(annotated);
-                                if (annotated_rgb) {
-                                    release_image(annotated);
-                                    annotated = annotated_rgb;
-                                }
-                                
-                                char filename_debug[512];
-                                snprintf(filename_debug, sizeof(filename_debug), "%s/%s_debug.jpg", debug_date_folder, frame_timestamp);
-                                save_image(filename_debug, annotated);
-                                release_image(annotated);
-                            }
-                        }
-                    }
-                    
-                    // Frame saved message will be printed below
-                }
+            fprintf(stderr, "Failed to apply mask, using unmasked image\n");
+            masked_image = slot->buffer_sharpened;
+        } else {
+            masked_image = slot->buffer_masked;
+        }
+    }
+    slot->t.mask_end = get_time_ms();
+
+    // Step 4: Resize image (1.5x scale) for better detection of small/distant markers (reuse buffer)
+    slot->t.resize_start = get_time_ms();
+    // Resizing disabled for now (DETECTION_SCALE_FACTOR = 1.0)
+    // int new_width = (int)(slot->frame.width * DETECTION_SCALE_FACTOR);
+    // int new_height = (int)(slot->frame.height * DETECTION_SCALE_FACTOR);
+    // slot->buffer_resized = resize_image_reuse(masked_image, new_width, new_height, slot->buffer_resized);
+
+    slot->detect_input = masked_image;  // No resizing for now (keep original size for detection)
+    slot->t.resize_end = get_time_ms();
+
+    return 0;
+}
+
+static int stage_detect(AppContext* ctx, FrameSlot* slot) {
+    update_detector(ctx, slot);
+
+    // Static field: nothing detected, the tracker keeps its tracks for the next detected frame
+    if (slot->schedule == ROD_MOTION_SKIP) {
+        memset(&slot->roi_stats, 0, sizeof(slot->roi_stats));
+        slot->t.detect_start = slot->t.detect_end = get_time_ms();
+        return 0;
+    }
+
+    // Step 5: Detect ArUco markers on preprocessed image
+    // (only around previously seen markers when ROI tracking is enabled)
+    slot->t.detect_start = get_time_ms();
+    if (ctx->roi_tracker && (slot->detect_offset_x != ctx->detect_offset_x || slot->detect_offset_y != ctx->detect_offset_y ||
+                             slot->schedule == ROD_MOTION_DETECT_FULL)) {
+        // Image now cropped to the field: tracked positions are in the previous coordinates
+        // (or full-frame detection due: the tracks are rebuilt from the whole frame)
+        rod_roi_tracker_reset(ctx->roi_tracker);
+    }
+    ctx->detect_offset_x = slot->detect_offset_x;
+    ctx->detect_offset_y = slot->detect_offset_y;
+    bool tiled = DETECTION_TILES_X * DETECTION_TILES_Y > 1 && slot->tile_overlap >= 0;
+    if (ctx->roi_tracker && slot->tile_overlap != ctx->detect_tile_overlap) {
+        if (tiled) {
+            rod_roi_tracker_set_tiling(ctx->roi_tracker, DETECTION_TILES_X, DETECTION_TILES_Y, slot->tile_overlap);
+        } else {
+            rod_roi_tracker_set_tiling(ctx->roi_tracker, 1, 1, 0);
+        }
+    }
+    ctx->detect_tile_overlap = slot->tile_overlap;
+    // Written into the slot: no allocation per frame
+    DetectionResult* storage = &slot->detection_storage;
+    int detected;
+    if (ctx->roi_tracker && slot->schedule == ROD_MOTION_DETECT_REGIONS) {
+        detected = rod_roi_tracker_detect_regions_into(ctx->roi_tracker, ctx->detector, slot->detect_input,
+                                                       storage, DETECTION_CAPACITY);
+        rod_roi_tracker_get_stats(ctx->roi_tracker, &slot->roi_stats);
+    } else if (ctx->roi_tracker) {
+        detected = rod_roi_tracker_detect_into(ctx->roi_tracker, ctx->detector, slot->detect_input,
+                                               storage, DETECTION_CAPACITY);
+        rod_roi_tracker_get_stats(ctx->roi_tracker, &slot->roi_stats);
+    } else {
+        if (tiled) {
+            detected = detectMarkersTiledInto(ctx->detector, slot->detect_input, DETECTION_TILES_X, DETECTION_TILES_Y,
+                                              slot->tile_overlap, storage, DETECTION_CAPACITY);
+        } else {
+            detected = detectMarkersPyramidInto(ctx->detector, slot->detect_input, DETECTION_PYRAMID_SCALE,
+                                                storage, DETECTION_CAPACITY);
+        }
+        slot->roi_stats.full_scan = true;
+    }
+    slot->detection = detected >= 0 ? storage : NULL;
+    slot->t.detect_end = get_time_ms();
+
+    // Step 6: Scale coordinates back to original image size, then to frame coordinates (field crop)
+    DetectionResult* detection = slot->detection;
+    if (detection && detection->count > 0) {
+        for (int i = 0; i < detection->count; i++) {
+            for (int j = 0; j < 4; j++) {
+                detection->markers[i].corners[j][0] = detection->markers[i].corners[j][0] / DETECTION_SCALE_FACTOR + slot->detect_offset_x;
+                detection->markers[i].corners[j][1] = detection->markers[i].corners[j][1] / DETECTION_SCALE_FACTOR + slot->detect_offset_y;
             }
-            double t_save_end = get_time_ms();
-            
-            // Print detection summary and timing breakdown
-            double t_loop_end = get_time_ms();
-            
-            printf("\n=== Frame %s ===\n", frame_timestamp);
-            printf("\n=== Detection Summary ===\n");
-            printf("Black markers: %d\n", marker_counts.black_markers);
-            printf("Blue markers: %d\n", marker_counts.blue_markers);
-            printf("Yellow markers: %d\n", marker_counts.yellow_markers);
-            printf("Robots markers: %d\n", marker_counts.robot_markers);
-            printf("Fixed markers: %d\n", marker_counts.fixed_markers);
-            printf("TOTAL: %d\n", valid_count);
-            
-            printf("\n=== Timing Summary ===\n");
-            printf("Capture: %.1fms\n", t_capture_end - t_capture_start);
-            printf("Load: %.1fms\n", t_create_end - t_create_start);
-            printf("Sharpen: %.1fms\n", t_sharpen_end - t_sharpen_start);
-            printf("Mask: %.1fms\n", t_mask_end - t_mask_start);
-            printf("Resize: %.1fms\n", t_resize_end - t_resize_start);
-            printf("Detect: %.1fms\n", t_detect_end - t_detect_start);
-            printf("Pose: %.1fms\n", t_pose_end - t_pose_start);
-            printf("Process: %.1fms\n", t_send_end - t_pose_end);
-            printf("Reload: 0.0ms\n");  // Buffers are reused, no reload
-            printf("Annotate: %.1fms\n", t_annotate_end - t_annotate_start);
-            printf("Save: %.1fms\n", t_save_end - t_save_start);
-            printf("TOTAL: %.1fms\n", t_loop_end - t_loop_start);
-            
-            releaseDetectionResult(detection);
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Queue raw camera image and debug image of a slot to the writer (debug save frames only)
+ */
+static void save_debug_images(AppContext* ctx, FrameSlot* slot, MarkerCounts marker_counts) {
+    if (!slot->raw_copy) return;
+
+    // Ensure date folders exist
+    char pictures_date_folder[256];
+    char debug_date_folder[256];
+    if (rod_config_ensure_date_folder(PICTURES_BASE_FOLDER, pictures_date_folder, sizeof(pictures_date_folder)) != 0 ||
+        rod_config_ensure_date_folder(DEBUG_BASE_FOLDER, debug_date_folder, sizeof(debug_date_folder)) != 0) {
+        return;
+    }
+
+    // Debug image: annotated preview when markers were detected, raw image otherwise
+    // (rendered from the raw image in one copy, downscaled to DEBUG_PREVIEW_WIDTH)
+    bool raw_is_gray = get_image_channels(slot->raw_copy) == 1;
+    ImageHandle* debug_image = NULL;
+    DetectionResult* detection = slot->detection;
+    if (detection && detection->count > 0) {
+        slot->t.annotate_start = get_time_ms();
+        int raw_width = get_image_width(slot->raw_copy);
+        float preview_scale = (DEBUG_PREVIEW_WIDTH > 0 && raw_width > DEBUG_PREVIEW_WIDTH)
+                                  ? (float)DEBUG_PREVIEW_WIDTH / (float)raw_width : 1.0f;
+        debug_image = rod_viz_render_debug(slot->raw_copy, slot->raw_scale, preview_scale, detection,
+                                           slot->markers, slot->valid_count, marker_counts, NULL);
+        slot->t.annotate_end = get_time_ms();
+    }
+
+    // 1. Debug image: /var/roboteseo/pictures/debug/YYYY_MM_DD/YYYYMMDD_HHMMSS_MS_debug.jpg (RGB output)
+    char filename_debug[512];
+    snprintf(filename_debug, sizeof(filename_debug), "%s/%s_debug.jpg", debug_date_folder, slot->timestamp);
+    if (debug_image) {
+        rod_writer_submit_with_quality(ctx->writer, filename_debug, debug_image, true, DEBUG_JPEG_QUALITY);
+    } else {
+        // Same pixels as the raw image: share them instead of copying
+        rod_writer_submit_with_quality(ctx->writer, filename_debug, share_image(slot->raw_copy), !raw_is_gray,
+                                       DEBUG_JPEG_QUALITY);
+    }
+
+    // 2. Raw camera image: /var/roboteseo/pictures/YYYY_MM_DD/YYYYMMDD_HHMMSS_MS.jpg
+    //    (ownership of the raw copy goes to the writer)
+    //    Not encoded when the frame is recorded: the session holds it at full resolution
+    if (slot->session_copy) {
+        release_image(slot->raw_copy);
+        slot->raw_copy = NULL;
+        return;
+    }
+    char filename_camera[512];
+    snprintf(filename_camera, sizeof(filename_camera), "%s/%s.jpg", pictures_date_folder, slot->timestamp);
+    rod_writer_submit(ctx->writer, filename_camera, slot->raw_copy, false);
+    slot->raw_copy = NULL;
+}
+
+/**
+ * @brief Queue the full frame copy of a slot to the session file with its metadata (recorded frames only)
+ */
+static void record_session_frame(AppContext* ctx, FrameSlot* slot, const MarkerData* markers, int marker_count) {
+    if (!slot->session_copy) return;
+
+    RodSessionFrame meta;
+    memset(&meta, 0, sizeof(meta));
+    meta.sequence = slot->sequence;
+    meta.timestamp_ns = (uint64_t)(slot->t.exposure * 1000000.0);
+
+    const RodCameraControls* camera = &slot->config.camera;
+    meta.controls.exposure_time = camera->exposure_time;
+    meta.controls.analogue_gain = camera->analogue_gain;
+    meta.controls.brightness = camera->brightness;
+    meta.controls.contrast = camera->contrast;
+    meta.controls.saturation = camera->saturation;
+    meta.controls.sharpness = camera->sharpness;
+    meta.controls.awb_enable = camera->awb_enable;
+    meta.controls.aec_enable = camera->aec_enable;
+    meta.controls.noise_reduction_mode = camera->noise_reduction_mode;
+
+    // Published positions (filtered when the marker filter is on)
+    meta.detection_count = marker_count < ROD_SESSION_MAX_DETECTIONS ? marker_count : ROD_SESSION_MAX_DETECTIONS;
+    for (int i = 0; i < meta.detection_count; i++) {
+        meta.detections[i].id = markers[i].id;
+        meta.detections[i].x = markers[i].x;
+        meta.detections[i].y = markers[i].y;
+        meta.detections[i].angle = markers[i].angle;
+    }
+
+    // Ownership of the copy goes to the writer
+    rod_writer_submit_session_frame(ctx->writer, ctx->session, slot->session_copy, &meta);
+    slot->session_copy = NULL;
+}
+
+/**
+ * @brief Annotate the stream copy of a slot and hand it to the live stream (tapped frames only)
+ */
+static void stream_debug_image(AppContext* ctx, FrameSlot* slot, MarkerCounts marker_counts) {
+    if (!slot->stream_copy) return;
+
+    // Already at stream size: the render copies it once more, with the annotations
+    ImageHandle* annotated = rod_viz_render_debug(slot->stream_copy, slot->stream_scale, 1.0f, slot->detection,
+                                                  slot->markers, slot->valid_count, marker_counts, NULL);
+    release_image(slot->stream_copy);
+    slot->stream_copy = NULL;
+    if (annotated) {
+        rod_stream_submit(ctx->stream, annotated);
+    }
+}
+
+/**
+ * @brief Print detection summary and timing breakdown of a slot
+ */
+static void print_frame_summary(AppContext* ctx, FrameSlot* slot, MarkerCounts marker_counts) {
+    const FrameTimings* t = &slot->t;
+
+    printf("\n=== Frame %s ===\n", slot->timestamp);
+    printf("\n=== Detection Summary ===\n");
+    printf("Black markers: %d\n", marker_counts.black_markers);
+    printf("Blue markers: %d\n", marker_counts.blue_markers);
+    printf("Yellow markers: %d\n", marker_counts.yellow_markers);
+    printf("Robots markers: %d\n", marker_counts.robot_markers);
+    printf("Fixed markers: %d\n", marker_counts.fixed_markers);
+    printf("TOTAL: %d\n", slot->valid_count);
+
+    printf("\n=== Timing Summary ===\n");
+    printf("Capture: %.1fms\n", t->capture_end - t->capture_start);
+    printf("Load: %.1fms\n", t->create_end - t->create_start);
+    printf("Sharpen: %.1fms%s\n", t->sharpen_end - t->sharpen_start, PREPROCESS_FUSED ? " (fused sharpen+mask+gray)" : "");
+    printf("Mask: %.1fms\n", t->mask_end - t->mask_start);
+    printf("Resize: %.1fms\n", t->resize_end - t->resize_start);
+    printf("Detect: %.1fms (%s)\n", t->detect_end - t->detect_start,
+           slot->schedule == ROD_MOTION_SKIP ? "skipped, static field" :
+           slot->roi_stats.full_scan ? "full frame" : "tracked regions");
+    printf("Pose: %.1fms\n", t->pose_end - t->pose_start);
+    printf("Process: %.1fms\n", t->send_end - t->pose_end);
+    printf("Reload: 0.0ms\n");  // Buffers are reused, no reload
+    printf("Annotate: %.1fms\n", t->annotate_end - t->annotate_start);
+    printf("Save: %.1fms (queued)\n", t->save_end - t->save_start);
+    printf("TOTAL: %.1fms\n", t->publish_end - t->exposure);  // Exposure-to-publish latency
+    printf("Dropped: %llu\n", (unsigned long long)rod_metrics_get_counter(ctx->metrics, ROD_COUNTER_DROPPED));
+
+    RodWriterStats writer_stats;
+    rod_writer_get_stats(ctx->writer, &writer_stats);
+    printf("Writer: %d queued, %d written, %d dropped, %d failed\n",
+           writer_stats.queue_depth, writer_stats.written, writer_stats.dropped, writer_stats.failed);
+}
+
+/**
+ * @brief Add the stage durations of a published slot to the latency histograms
+ */
+static void record_slot_metrics(AppContext* ctx, const FrameSlot* slot) {
+    const FrameTimings* t = &slot->t;
+
+    rod_metrics_record(ctx->metrics, ROD_METRIC_CAPTURE, t->capture_end - t->capture_start);
+    rod_metrics_record(ctx->metrics, ROD_METRIC_SHARPEN, t->sharpen_end - t->sharpen_start);
+    rod_metrics_record(ctx->metrics, ROD_METRIC_MASK, t->mask_end - t->mask_start);
+    rod_metrics_record(ctx->metrics, ROD_METRIC_DETECT, t->detect_end - t->detect_start);
+    rod_metrics_record(ctx->metrics, ROD_METRIC_POSE, t->pose_end - t->pose_start);
+    rod_metrics_record(ctx->metrics, ROD_METRIC_SEND, t->send_end - t->pose_end);
+    rod_metrics_record(ctx->metrics, ROD_METRIC_SAVE, t->save_end - t->save_start);
+    rod_metrics_record(ctx->metrics, ROD_METRIC_TOTAL, t->publish_end - t->exposure);
+    rod_metrics_increment(ctx->metrics, ROD_COUNTER_FRAMES);
+    if (slot->schedule == ROD_MOTION_DETECT_REGIONS) {
+        rod_metrics_increment(ctx->metrics, ROD_COUNTER_MOTION_REGIONS);
+    } else if (slot->schedule == ROD_MOTION_SKIP) {
+        rod_metrics_increment(ctx->metrics, ROD_COUNTER_MOTION_SKIPPED);
+    }
+}
+
+/**
+ * @brief Copy the process page faults and context switches into the metrics counters
+ */
+static void record_process_usage(AppContext* ctx) {
+    RodRealtimeUsage usage;
+    if (rod_realtime_get_usage(&usage) != 0) return;
+    rod_metrics_set_counter(ctx->metrics, ROD_COUNTER_MINOR_FAULTS, usage.minor_faults);
+    rod_metrics_set_counter(ctx->metrics, ROD_COUNTER_MAJOR_FAULTS, usage.major_faults);
+    rod_metrics_set_counter(ctx->metrics, ROD_COUNTER_VOLUNTARY_SWITCHES, usage.voluntary_switches);
+    rod_metrics_set_counter(ctx->metrics, ROD_COUNTER_INVOLUNTARY_SWITCHES, usage.involuntary_switches);
+}
+
+/**
+ * @brief Rewrite the metrics report when METRICS_DUMP_INTERVAL_MS has elapsed (main thread)
+ */
+static void dump_metrics_if_due(AppContext* ctx) {
+    if (METRICS_DUMP_INTERVAL_MS <= 0) return;
+
+    double now = get_time_ms();
+    if (now - ctx->metrics_dumped_at < METRICS_DUMP_INTERVAL_MS) return;
+    ctx->metrics_dumped_at = now;
+    record_process_usage(ctx);
+    rod_metrics_dump(ctx->metrics, METRICS_FILE);
+}
+
+static int localize_slot_markers(AppContext* ctx, FrameSlot* slot) {
+    if (LOCALIZATION_GRID_ENABLED) {
+        // Frame size survives the buffer release, (re)create the grid if it changed
+        if (!rod_localization_grid_matches(ctx->localization_grid, slot->frame.width, slot->frame.height)) {
+            rod_localization_grid_destroy(ctx->localization_grid);
+            ctx->localization_grid = rod_localization_grid_create(slot->frame.width, slot->frame.height,
+                                                                  LOCALIZATION_GRID_CELL);
+        }
+        if (ctx->localization_grid && rod_localization_grid_update(ctx->localization_grid, slot->homography_inv) >= 0) {
+            return rod_localization_grid_localize_markers(ctx->localization_grid, slot->detection,
+                                                          slot->markers, MAX_MARKERS_PER_FRAME);
+        }
+    }
+
+    return localize_markers_in_playground(slot->detection, slot->markers, MAX_MARKERS_PER_FRAME, slot->homography_inv);
+}
+
+/**
+ * @brief Microseconds from the sensor timestamp of a slot to a pipeline time (0 if before it)
+ */
+static uint32_t since_exposure_us(const FrameSlot* slot, double time_ms) {
+    double delta_us = (time_ms - slot->t.exposure) * 1000.0;
+    return delta_us > 0.0 ? (uint32_t)delta_us : 0;
+}
+
+/**
+ * @brief Keep the markers published for a detected frame, or send them again for a skipped one
+ * @return Markers to publish (slot->filtered for a skipped frame), count in *count
+ */
+static const MarkerData* carry_over_markers(AppContext* ctx, FrameSlot* slot, const MarkerData* markers, int* count) {
+    if (slot->schedule != ROD_MOTION_SKIP) {
+        memcpy(ctx->carried, markers, (size_t)*count * sizeof(MarkerData));
+        ctx->carried_count = *count;
+        ctx->carried_exposure = slot->t.exposure;
+        return markers;
+    }
+
+    // Same positions, older by the time elapsed since the frame they were measured on
+    double elapsed_ms = slot->t.exposure - ctx->carried_exposure;
+    uint32_t elapsed_us = elapsed_ms > 0.0 ? (uint32_t)(elapsed_ms * 1000.0) : 0;
+    for (int i = 0; i < ctx->carried_count; i++) {
+        slot->filtered[i] = ctx->carried[i];
+        slot->filtered[i].age_us += elapsed_us;
+    }
+    slot->filtered_count = ctx->carried_count;
+    *count = ctx->carried_count;
+    return slot->filtered;
+}
+
+/**
+ * @brief Protocol flags of a published frame: how much of it was searched
+ */
+static uint32_t publish_flags(const FrameSlot* slot) {
+    if (slot->schedule == ROD_MOTION_SKIP) return ROD_PROTOCOL_FLAG_CARRIED_OVER;
+    return slot->roi_stats.full_scan ? 0 : ROD_PROTOCOL_FLAG_ROI_ONLY;
+}
+
+static void publish_shm_snapshot(AppContext* ctx, const FrameSlot* slot, const MarkerData* markers, int marker_count,
+                                 const RodProtocolTimings* timings) {
+    RodProtocolMessage* message = rod_shm_publisher_begin(ctx->shm_publisher);
+    int count = marker_count < ROD_PROTOCOL_MAX_MARKERS ? marker_count : ROD_PROTOCOL_MAX_MARKERS;
+
+    message->sequence = slot->sequence;
+    message->timestamp_us = (uint64_t)(slot->t.exposure * 1000.0);
+    message->timings = *timings;
+    message->flags = publish_flags(slot);
+    message->count = count;
+    for (int i = 0; i < count; i++) {
+        message->markers[i].id = markers[i].id;
+        message->markers[i].x = markers[i].x;
+        message->markers[i].y = markers[i].y;
+        message->markers[i].angle = markers[i].angle;
+        message->markers[i].age_us = markers[i].age_us;
+    }
+
+    rod_shm_publisher_commit(ctx->shm_publisher);
+}
+
+static int stage_publish(AppContext* ctx, FrameSlot* slot) {
+    // Try to accept a client connection if not already connected
+    rod_socket_server_accept(ctx->socket_server);
+
+    DetectionResult* detection = slot->detection;
+    bool has_markers = detection && detection->count > 0;
+    MarkerCounts marker_counts;
+    memset(&marker_counts, 0, sizeof(marker_counts));
+
+    slot->t.pose_start = get_time_ms();
+    if (has_markers) {
+        // Localize markers in playground coordinates using homography transformation
+        if (slot->has_homography) {
+            // Use homography for pixel -> terrain transformation
+            slot->valid_count = localize_slot_markers(ctx, slot);
         } else {
-            // No markers detected
-            double t_loop_end = get_time_ms();
-            if (frame_count % 10 == 0) {
-                printf("\n=== Frame %s ===\n", frame_timestamp);
-                printf("\n=== Detection Summary ===\n");
-                printf("Black markers: 0\n");
-                printf("Blue markers: 0\n");
-                printf("Yellow markers: 0\n");
-                printf("Robots markers: 0\n");
-                printf("Fixed markers: 0\n");
-                printf("TOTAL: 0\n");
-                
-                printf("\n=== Timing Summary ===\n");
-                printf("Capture: %.1fms\n", t_capture_end - t_capture_start);
-                printf("Load: %.1fms\n", t_create_end - t_create_start);
-                printf("Sharpen: %.1fms\n", t_sharpen_end - t_sharpen_start);
-                printf("Mask: %.1fms\n", t_mask_end - t_mask_start);
-                printf("Resize: %.1fms\n", t_resize_end - t_resize_start);
-                printf("Detect: %.1fms\n", t_detect_end - t_detect_start);
-                printf("Pose: 0.0ms\n");  // No pose estimation when no markers
-                printf("Process: 0.0ms\n");  // No processing when no markers
-                printf("Reload: 0.0ms\n");
-                printf("Annotate: 0.0ms\n");
-                printf("Save: 0.0ms\n");  // No save on this frame (if not SAVE_DEBUG_IMAGE_INTERVAL)
-                printf("TOTAL: %.1fms\n", t_loop_end - t_loop_start);
+            // Fallback to pixel coordinates if no homography available
+            slot->valid_count = filter_valid_markers(detection, slot->markers, MAX_MARKERS_PER_FRAME);
+        }
+        if (slot->valid_count < 0) slot->valid_count = 0;
+
+        // Count markers by category for reporting
+        marker_counts = count_markers_by_category(slot->markers, slot->valid_count);
+
+        // Fixed tags of this frame feed the background recalibration (copy only)
+        if (slot->has_homography) {
+            rod_recalibrator_submit(ctx->recalibrator, detection);
+        }
+    }
+
+    // Every detected frame updates the tracks (misses age them): smoothed positions, briefly lost markers predicted
+    const MarkerData* sent_markers = slot->markers;
+    int sent_count = slot->valid_count;
+    if (ctx->marker_filter && slot->has_homography && slot->schedule != ROD_MOTION_SKIP) {
+        slot->filtered_count = rod_marker_filter_update(ctx->marker_filter, (uint64_t)(slot->t.exposure * 1000.0),
+                                                        slot->markers, slot->valid_count,
+                                                        slot->filtered, MAX_MARKERS_PER_FRAME);
+        if (slot->filtered_count >= 0) {
+            sent_markers = slot->filtered;
+            sent_count = slot->filtered_count;
+        }
+    }
+    sent_markers = carry_over_markers(ctx, slot, sent_markers, &sent_count);
+    slot->t.pose_end = get_time_ms();
+
+    // Send detection results with the stage timestamps (clients measure the receive latency)
+    RodProtocolTimings timings;
+    timings.acquired_us = since_exposure_us(slot, slot->t.capture_end);
+    timings.detected_us = since_exposure_us(slot, slot->t.detect_end);
+    timings.published_us = since_exposure_us(slot, get_time_ms());
+    if (sent_count > 0) {
+        rod_socket_server_send_detections(ctx->socket_server, slot->sequence,
+                                          (uint64_t)(slot->t.exposure * 1000.0), &timings, publish_flags(slot),
+                                          sent_markers, sent_count);
+    }
+    if (ctx->shm_publisher) {
+        publish_shm_snapshot(ctx, slot, sent_markers, sent_count, &timings);
+    }
+    slot->t.send_end = get_time_ms();
+
+    // Queue images periodically (raw camera + debug), even when no markers detected
+    slot->t.save_start = get_time_ms();
+    slot->t.annotate_start = slot->t.save_start;
+    slot->t.annotate_end = slot->t.save_start;  // Will be updated if annotation happens
+    save_debug_images(ctx, slot, marker_counts);
+    record_session_frame(ctx, slot, sent_markers, sent_count);
+    stream_debug_image(ctx, slot, marker_counts);
+    slot->t.save_end = get_time_ms();
+
+    slot->t.publish_end = get_time_ms();
+    record_slot_metrics(ctx, slot);
+    if (ctx->max_frames > 0 && rod_metrics_get_counter(ctx->metrics, ROD_COUNTER_FRAMES) >= (uint64_t)ctx->max_frames) {
+        atomic_store(&ctx->running, false);
+    }
+
+    // Print every frame with markers, every 10th frame otherwise
+    if (LOG_FRAME_SUMMARY && (has_markers || slot->frame_index % 10 == 0)) {
+        print_frame_summary(ctx, slot, marker_counts);
+    }
+
+    return 0;
+}
+
+/* ****************************************************** Pipeline runners *********************************************** */
+
+/**
+ * @brief Lock the process memory once everything is allocated, stage threads pick up ctx->realtime when started
+ */
+static void enable_realtime(AppContext* ctx, bool realtime) {
+    ctx->realtime = realtime;
+    if (!realtime) return;
+
+    printf("Real-time mode (pipelined stages only): pinned threads, SCHED_FIFO, locked memory\n");
+    if (rod_realtime_lock_memory(REALTIME_HEAP_PREFAULT) == 0) {
+        printf("Memory locked (%u MB of heap pre-faulted)\n", (unsigned)(REALTIME_HEAP_PREFAULT >> 20));
+    }
+}
+
+/**
+ * @brief Pass a slot to the next stage (or recycle it after the last stage)
+ */
+static void forward_slot(PipelineStage* stage, FrameSlot* slot) {
+    AppContext* ctx = stage->app;
+
+    if (!stage->output) {
+        recycle_slot(ctx, slot);
+        return;
+    }
+
+    if (stage->drop_oldest) {
+        void* dropped = NULL;
+        if (rod_frame_queue_push_drop_oldest(stage->output, slot, &dropped) != 0) {
+            recycle_slot(ctx, slot);
+        }
+        if (dropped) {
+            // Next stage is behind: the oldest waiting frame is no longer worth processing
+            rod_metrics_increment(ctx->metrics, ROD_COUNTER_DROPPED);
+            if (stage->output == ctx->detect_queue) {
+                // Still this stage's thread: the gate must not keep an undetected frame as reference
+                rod_motion_gate_reject(ctx->motion_gate, ((FrameSlot*)dropped)->schedule);
             }
-            
-            // Save images periodically even when no markers detected
-            if (frame_count % SAVE_DEBUG_IMAGE_INTERVAL == 0) {
-                // Ensure date folders exist
-                char pictures_date_folder[256];
-                char debug_date_folder[256];
-                if (rod_config_ensure_date_folder(PICTURES_BASE_FOLDER, pictures_date_folder, sizeof(pictures_date_folder)) == 0 &&
-                    rod_config_ensure_date_folder(DEBUG_BASE_FOLDER, debug_date_folder, sizeof(debug_date_folder)) == 0) {
-                    
-                    // Save raw camera image
-                    char filename_camera[512];
-                    snprintf(filename_camera, sizeof(filename_camera), "%s/%s.jpg", pictures_date_folder, frame_timestamp);
-                    save_image(filename_camera, original_image);
-                    
-                    // Save debug image (no annotations, but in debug folder) in RGB format
-                    ImageHandle* debug_rgb = convert_bgr_to_rgb(original_image);
-                    if (debug_rgb) {
-                        char filename_debug[512];
-                        snprintf(filename_debug, sizeof(filename_debug), "%s/%s_debug.jpg", debug_date_folder, frame_timestamp);
-                        save_image(filename_debug, debug_rgb);
-                        release_image(debug_rgb);
-                    }
-                    
-                    // Image saved (no markers case)
-                }
+            recycle_slot(ctx, (FrameSlot*)dropped);
+        }
+    } else if (rod_frame_queue_push(stage->output, slot) != 0) {
+        recycle_slot(ctx, slot);
+    }
+}
+
+/**
+ * @brief Stage thread body: pop a slot, run the stage, forward the slot
+ */
+static void* stage_thread_main(void* arg) {
+    PipelineStage* stage = (PipelineStage*)arg;
+    AppContext* ctx = stage->app;
+
+    if (ctx->realtime) {
+        // Before the first frame: a refused setting only leaves this stage on the default scheduling
+        rod_realtime_prefault_stack(REALTIME_STACK_PREFAULT);
+        if (rod_realtime_set_thread(stage->name, stage->cpu_mask, stage->priority) == 0) {
+            printf("%s thread: CPUs 0x%llx, %s %d\n", stage->name, (unsigned long long)stage->cpu_mask,
+                   stage->priority > 0 ? "SCHED_FIFO" : "SCHED_OTHER", stage->priority);
+        }
+    }
+
+    while (!rod_frame_queue_is_closed(stage->input)) {
+        FrameSlot* slot = (FrameSlot*)rod_frame_queue_pop(stage->input, STAGE_POP_TIMEOUT_MS);
+        if (!slot) continue;
+
+        if (stage->run(ctx, slot) != 0) {
+            recycle_slot(ctx, slot);
+            continue;
+        }
+        forward_slot(stage, slot);
+    }
+
+    return NULL;
+}
+
+static int run_pipelined(AppContext* ctx) {
+    ctx->free_slots = rod_frame_queue_create(PIPELINE_SLOTS);
+    ctx->preprocess_queue = rod_frame_queue_create(PIPELINE_QUEUE_DEPTH);
+    ctx->detect_queue = rod_frame_queue_create(PIPELINE_QUEUE_DEPTH);
+    ctx->publish_queue = rod_frame_queue_create(PIPELINE_QUEUE_DEPTH);
+    if (!ctx->free_slots || !ctx->preprocess_queue || !ctx->detect_queue || !ctx->publish_queue) {
+        fprintf(stderr, "Failed to create pipeline queues\n");
+        return -1;
+    }
+
+    for (int i = 0; i < PIPELINE_SLOTS; i++) {
+        rod_frame_queue_push(ctx->free_slots, &ctx->slots[i]);
+    }
+
+    // Capture and preprocess drop the oldest waiting frame when the next stage is busy.
+    // Detection results are never dropped (publishing is cheap).
+    PipelineStage stages[PIPELINE_STAGE_COUNT] = {
+        { "capture",    ctx, stage_capture,    ctx->free_slots,       ctx->preprocess_queue, true,
+          ROD_REALTIME_CPUS_CAPTURE,    ROD_REALTIME_PRIORITY_CAPTURE,    0, false },
+        { "preprocess", ctx, stage_preprocess, ctx->preprocess_queue, ctx->detect_queue,     true,
+          ROD_REALTIME_CPUS_PREPROCESS, ROD_REALTIME_PRIORITY_PREPROCESS, 0, false },
+        { "detect",     ctx, stage_detect,     ctx->detect_queue,     ctx->publish_queue,    false,
+          ROD_REALTIME_CPUS_DETECT,     ROD_REALTIME_PRIORITY_DETECT,     0, false },
+        { "publish",    ctx, stage_publish,    ctx->publish_queue,    NULL,                  false,
+          ROD_REALTIME_CPUS_PUBLISH,    ROD_REALTIME_PRIORITY_PUBLISH,    0, false },
+    };
+    memcpy(ctx->stages, stages, sizeof(stages));
+
+    int result = 0;
+    for (int i = 0; i < PIPELINE_STAGE_COUNT; i++) {
+        if (pthread_create(&ctx->stages[i].thread, NULL, stage_thread_main, &ctx->stages[i]) != 0) {
+            fprintf(stderr, "Failed to start %s thread\n", ctx->stages[i].name);
+            result = -1;
+            break;
+        }
+        ctx->stages[i].started = true;
+    }
+
+    // The main thread only refreshes the metrics report and reloads the configuration while the stages run
+    while (result == 0 && is_running(ctx) && !ctx->sequential) {
+        usleep(STAGE_POP_TIMEOUT_MS * 1000);
+        dump_metrics_if_due(ctx);
+        reload_config_if_requested(ctx);
+    }
+
+    // Stop all stages, then wait for them
+    rod_frame_queue_close(ctx->free_slots);
+    rod_frame_queue_close(ctx->preprocess_queue);
+    rod_frame_queue_close(ctx->detect_queue);
+    rod_frame_queue_close(ctx->publish_queue);
+    for (int i = 0; i < PIPELINE_STAGE_COUNT; i++) {
+        if (ctx->stages[i].started) {
+            pthread_join(ctx->stages[i].thread, NULL);
+            ctx->stages[i].started = false;
+        }
+    }
+
+    // Slots left in the queues are released, so the pipeline can run again after a mode switch
+    for (int i = 0; i < PIPELINE_SLOTS; i++) {
+        reset_slot(ctx, &ctx->slots[i]);
+    }
+    rod_frame_queue_destroy(ctx->free_slots);
+    rod_frame_queue_destroy(ctx->preprocess_queue);
+    rod_frame_queue_destroy(ctx->detect_queue);
+    rod_frame_queue_destroy(ctx->publish_queue);
+    ctx->free_slots = NULL;
+    ctx->preprocess_queue = NULL;
+    ctx->detect_queue = NULL;
+    ctx->publish_queue = NULL;
+
+    return result;
+}
+
+static void run_sequential(AppContext* ctx) {
+    FrameSlot* slot = &ctx->slots[0];
+
+    while (is_running(ctx) && ctx->sequential) {
+        if (stage_capture(ctx, slot) == 0 &&
+            stage_preprocess(ctx, slot) == 0 &&
+            stage_detect(ctx, slot) == 0) {
+            stage_publish(ctx, slot);
+        }
+        reset_slot(ctx, slot);
+        dump_metrics_if_due(ctx);
+        reload_config_if_requested(ctx);
+    }
+}
+
+static int run_detection(AppContext* ctx) {
+    int result = 0;
+    while (result == 0 && is_running(ctx)) {
+        // Each runner returns when a reload switches the mode
+        if (ctx->sequential) {
+            run_sequential(ctx);
+        } else {
+            result = run_pipelined(ctx);
+        }
+    }
+    return result;
+}
+
+#ifdef ROD_BENCH
+
+/**
+ * @brief Replay benchmark: the rod_detection stages on a recorded folder or session, at full speed
+ * Usage: rod_bench [--sequential] [--realtime] [--frames N] [--output file] [--baseline file] [--tolerance ratio]
+ *                  image_folder | session_file
+ * @return 0 on success, 1 on error, BENCH_EXIT_REGRESSION if the baseline comparison fails
+ */
+int main(int argc, char* argv[]) {
+    AppContext ctx;
+    const char* image_folder = DEFAULT_IMAGE_FOLDER;
+    const char* output_path = BENCH_OUTPUT_FILE;
+    const char* baseline_path = NULL;
+    double tolerance = BENCH_TOLERANCE;
+    int max_frames = BENCH_FRAMES;
+    bool sequential = false;
+    bool realtime = REALTIME_ENABLED;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--sequential") == 0) {
+            sequential = true;
+        } else if (strcmp(argv[i], "--realtime") == 0) {
+            realtime = true;
+        } else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            max_frames = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--output") == 0 && i + 1 < argc) {
+            output_path = argv[++i];
+        } else if (strcmp(argv[i], "--baseline") == 0 && i + 1 < argc) {
+            baseline_path = argv[++i];
+        } else if (strcmp(argv[i], "--tolerance") == 0 && i + 1 < argc) {
+            tolerance = atof(argv[++i]);
+        } else if (argv[i][0] == '-') {
+            fprintf(stderr, "Usage: %s [--sequential] [--realtime] [--frames N] [--output file] [--baseline file] "
+                            "[--tolerance ratio] image_folder\n", argv[0]);
+            return 1;
+        } else {
+            image_folder = argv[i];
+        }
+    }
+    if (max_frames <= 0 || tolerance < 0.0) {
+        fprintf(stderr, "Invalid --frames or --tolerance\n");
+        return 1;
+    }
+
+    printf("=== ROD Bench - Replay benchmark ===\n");
+    printf("Image folder: %s (preloaded)\n", image_folder);
+    printf("Mode: %s, %d frames\n\n", sequential ? "sequential" : "pipelined", max_frames);
+
+    signal(SIGINT, signal_handler);
+    signal(SIGTERM, signal_handler);
+    signal(SIGHUP, reload_signal_handler);  // No file: a reload is only reported as ignored
+
+    if (init_app_context(&ctx, CAMERA_TYPE_EMULATED, image_folder, NULL, sequential) != 0) {
+        fprintf(stderr, "Failed to initialize application\n");
+        cleanup_app_context(&ctx);
+        return 1;
+    }
+    ctx.max_frames = max_frames;
+    enable_realtime(&ctx, realtime);
+
+    // Same publication work as production, under a name no client reads (no socket: nobody connects)
+    if (SHM_ENABLED) {
+        ctx.shm_publisher = rod_shm_publisher_create(BENCH_SHM_NAME);
+        if (!ctx.shm_publisher) {
+            fprintf(stderr, "Failed to initialize shared memory publication\n");
+            cleanup_app_context(&ctx);
+            return 1;
+        }
+    }
+
+    double start = get_time_ms();
+    int result = run_detection(&ctx);
+    double elapsed_s = (get_time_ms() - start) / 1000.0;
+
+    RodBenchResult bench;
+    record_process_usage(&ctx);
+    rod_bench_result_from_metrics(&bench, ctx.metrics, elapsed_s);
+    char report[METRICS_REPORT_SIZE];
+    if (rod_metrics_format(ctx.metrics, report, sizeof(report)) > 0) {
+        printf("\n%s", report);
+    }
+    double fps = 0.0, rss = 0.0;
+    rod_bench_result_get(&bench, "fps", &fps);
+    rod_bench_result_get(&bench, "peak_rss_kb", &rss);
+    printf("End to end: %.1f fps over %.2f s, peak RSS %.1f MB\n", fps, elapsed_s, rss / 1024.0);
+
+    if (result == 0 && rod_bench_result_write(&bench, output_path) == 0) {
+        printf("Result written to %s\n", output_path);
+    } else {
+        result = -1;
+    }
+
+    int exit_code = result == 0 ? 0 : 1;
+    if (result == 0 && baseline_path) {
+        RodBenchResult baseline;
+        if (rod_bench_result_read(&baseline, baseline_path) != 0) {
+            exit_code = 1;
+        } else {
+            printf("\nComparison with %s (tolerance %.0f%%):\n", baseline_path, tolerance * 100.0);
+            int regressions = rod_bench_result_compare(&bench, &baseline, tolerance, stdout);
+            printf("%d regression(s)\n", regressions);
+            if (regressions > 0) exit_code = BENCH_EXIT_REGRESSION;
+        }
+    }
+
+    cleanup_app_context(&ctx);
+    return exit_code;
+}
+
+#else
+
+/**
+ * @brief Main function of the program
+ * Takes a picture with the camera, find the aruco markers position with rod-cv,
+ * and send the position to rod-com via socket.
+ */
+int main(int argc, char* argv[]) {
+    AppContext ctx;
+    const char* image_folder = DEFAULT_IMAGE_FOLDER;
+    CameraType camera_type = CAMERA_TYPE_IMX477;  // Default to real camera
+    bool sequential = false;
+    bool realtime = REALTIME_ENABLED;
+    const char* config_path = RUNTIME_CONFIG_FILE;
+    const char* record_path = NULL;
+
+    // Parse command line arguments
+    // Usage: rod_detection [--camera real|emulated] [--sequential] [--realtime] [--config file] [--record file]
+    //                      [image_folder | session_file]
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--camera") == 0 && i + 1 < argc) {
+            i++;
+            if (strcmp(argv[i], "real") == 0) {
+                camera_type = CAMERA_TYPE_IMX477;
+            } else if (strcmp(argv[i], "emulated") == 0) {
+                camera_type = CAMERA_TYPE_EMULATED;
+            } else {
+                fprintf(stderr, "Unknown camera type: %s (use 'real' or 'emulated')\n", argv[i]);
+                return 1;
             }
+        } else if (strcmp(argv[i], "--sequential") == 0) {
+            sequential = true;
+        } else if (strcmp(argv[i], "--realtime") == 0) {
+            realtime = true;
+        } else if (strcmp(argv[i], "--config") == 0 && i + 1 < argc) {
+            config_path = argv[++i];
+        } else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            record_path = argv[++i];
+        } else {
+            // Assume it's the image folder path (or a recorded session)
+            image_folder = argv[i];
+        }
+    }
+
+    // Check environment variable for camera type (command-line takes precedence)
+    const char* env_camera = getenv("ROD_CAMERA_TYPE");
+    if (env_camera && argc == 1) {  // Only use env var if no command-line args
+        if (strcmp(env_camera, "real") == 0) {
+            camera_type = CAMERA_TYPE_IMX477;
+        } else if (strcmp(env_camera, "emulated") == 0) {
+            camera_type = CAMERA_TYPE_EMULATED;
+        }
+    }
+
+    printf("=== ROD Detection - Computer Vision Thread ===\n");
+    printf("Camera type: %s\n", camera_type == CAMERA_TYPE_IMX477 ? "Real (IMX477)" : "Emulated");
+    if (camera_type == CAMERA_TYPE_EMULATED) {
+        printf("Image folder: %s\n", image_folder);
+    }
+    printf("\n");
+
+    // Setup signal handler for graceful shutdown, and configuration reload
+    signal(SIGINT, signal_handler);
+    signal(SIGTERM, signal_handler);
+    signal(SIGHUP, reload_signal_handler);
+
+    // Initialize application context
+    if (init_app_context(&ctx, camera_type, image_folder, config_path, sequential) != 0) {
+        fprintf(stderr, "Failed to initialize application\n");
+        cleanup_app_context(&ctx);
+        return 1;
+    }
+
+    // Initialize socket server
+    ctx.socket_server = rod_socket_server_create(SOCKET_PATH);
+    if (!ctx.socket_server) {
+        fprintf(stderr, "Failed to initialize socket server\n");
+        cleanup_app_context(&ctx);
+        return 1;
+    }
+
+    // Initialize shared memory publication
+    if (SHM_ENABLED) {
+        ctx.shm_publisher = rod_shm_publisher_create(SHM_NAME);
+        if (!ctx.shm_publisher) {
+            fprintf(stderr, "Failed to initialize shared memory publication\n");
+            cleanup_app_context(&ctx);
+            return 1;
         }
-        
-        // Release only original_image (buffers are reused and freed in cleanup)
-        release_image(original_image);
     }
-    
+
+    // Record raw frames and their metadata (replayed with the session file as image folder)
+    if (record_path) {
+        ctx.session = rod_session_writer_create(record_path);
+        if (!ctx.session) {
+            fprintf(stderr, "Failed to create session file %s\n", record_path);
+            cleanup_app_context(&ctx);
+            return 1;
+        }
+        printf("Recording session: %s (every %d frames)\n", record_path, SESSION_RECORD_INTERVAL);
+    }
+
+    // Start the live stream (optional: detection runs without it)
+    if (STREAM_ENABLED) {
+        ctx.stream = rod_stream_create(STREAM_PORT, STREAM_MAX_FPS, STREAM_JPEG_QUALITY, STREAM_ENCODER_DEVICE, true);
+        if (ctx.stream) {
+            printf("Live stream: http://<host>:%d/ (%d fps max)\n", rod_stream_get_port(ctx.stream), STREAM_MAX_FPS);
+        } else {
+            fprintf(stderr, "Failed to start live stream, continuing without it\n");
+        }
+    }
+
+    printf("Mode: %s\n", ctx.sequential ? "sequential" : "pipelined (capture/preprocess/detect/publish threads)");
+    enable_realtime(&ctx, realtime);
+    printf("\nStarting detection loop (Ctrl+C to stop)...\n");
+
+    // Main detection loop
+    int result = run_detection(&ctx);
+
     printf("\nShutting down...\n");
-    printf("Total frames processed: %d\n", frame_count);
-    
+    record_process_usage(&ctx);
+    char report[METRICS_REPORT_SIZE];
+    if (rod_metrics_format(ctx.metrics, report, sizeof(report)) > 0) {
+        printf("%s", report);
+    }
+    rod_metrics_dump(ctx.metrics, METRICS_FILE);
+
     // Cleanup
     cleanup_app_context(&ctx);
-    
+
     printf("ROD Detection stopped successfully\n");
-    return 0;
-}
\ No newline at end of file
+    return result == 0 ? 0 : 1;
+}
+
+#endif // ROD_BENCH
@@ -0,0 +1,198 @@
+/**
+ * @file rod_bench_report.c
+ * @brief Machine-readable replay benchmark results and baseline comparison
+ * @author Noé Game
+ * @date 14/10/2026
+ * @see rod_bench_report.h
+ * @copyright Cecill-C (Cf. LICENCE.txt)
+ */
+
+/* ******************************************************* Includes ****************************************************** */
+
+#include "rod_bench_report.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <ctype.h>
+#include <sys/resource.h>
+
+/* ***************************************************** Public macros *************************************************** */
+
+#define LINE_SIZE 128
+
+/* ********************************************* Function implementations *********************************************** */
+
+void rod_bench_result_init(RodBenchResult* result) {
+    if (!result) return;
+    result->count = 0;
+}
+
+static int find_key(const RodBenchResult* result, const char* key) {
+    for (int i = 0; i < result->count; i++) {
+        if (strncmp(result->values[i].key, key, ROD_BENCH_KEY_SIZE - 1) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+int rod_bench_result_set(RodBenchResult* result, const char* key, double value) {
+    if (!result || !key || key[0] == '\0') return -1;
+    for (const char* c = key; *c; c++) {
+        if (isspace((unsigned char)*c)) return -1;
+    }
+
+    int index = find_key(result, key);
+    if (index < 0) {
+        if (result->count >= ROD_BENCH_MAX_VALUES) {
+            fprintf(stderr, "rod_bench_report: Result full, %s dropped\n", key);
+            return -1;
+        }
+        index = result->count++;
+        snprintf(result->values[index].key, ROD_BENCH_KEY_SIZE, "%s", key);
+    }
+    result->values[index].value = value;
+    return 0;
+}
+
+int rod_bench_result_get(const RodBenchResult* result, const char* key, double* value) {
+    if (!result || !key || !value) return -1;
+
+    int index = find_key(result, key);
+    if (index < 0) return -1;
+    *value = result->values[index].value;
+    return 0;
+}
+
+long rod_bench_peak_rss_kb(void) {
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return -1;
+    return usage.ru_maxrss;  // Kilobytes on Linux
+}
+
+void rod_bench_result_from_metrics(RodBenchResult* result, RodMetrics* metrics, double elapsed_s) {
+    if (!result) return;
+    rod_bench_result_init(result);
+
+    uint64_t frames = rod_metrics_get_counter(metrics, ROD_COUNTER_FRAMES);
+    rod_bench_result_set(result, "frames", (double)frames);
+    rod_bench_result_set(result, "dropped", (double)rod_metrics_get_counter(metrics, ROD_COUNTER_DROPPED));
+    rod_bench_result_set(result, "elapsed_s", elapsed_s);
+    rod_bench_result_set(result, "fps", elapsed_s > 0.0 ? (double)frames / elapsed_s : 0.0);
+    rod_bench_result_set(result, "peak_rss_kb", (double)rod_bench_peak_rss_kb());
+
+    for (int m = 0; m < ROD_METRIC_COUNT; m++) {
+        RodMetricSummary summary;
+        rod_metrics_get_summary(metrics, (RodMetric)m, &summary);
+
+        const char* name = rod_metrics_name((RodMetric)m);
+        char key[ROD_BENCH_KEY_SIZE];
+        snprintf(key, sizeof(key), "%s.p50_ms", name);
+        rod_bench_result_set(result, key, summary.p50_ms);
+        snprintf(key, sizeof(key), "%s.p99_ms", name);
+        rod_bench_result_set(result, key, summary.p99_ms);
+        snprintf(key, sizeof(key), "%s.max_ms", name);
+        rod_bench_result_set(result, key, summary.max_ms);
+        snprintf(key, sizeof(key), "%s.mean_ms", name);
+        rod_bench_result_set(result, key, summary.mean_ms);
+        snprintf(key, sizeof(key), "%s.fps", name);
+        rod_bench_result_set(result, key, summary.mean_ms > 0.0 ? 1000.0 / summary.mean_ms : 0.0);
+    }
+}
+
+int rod_bench_result_write(const RodBenchResult* result, const char* path) {
+    if (!result || !path) return -1;
+
+    char tmp_path[512];
+    if (snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path) >= (int)sizeof(tmp_path)) {
+        fprintf(stderr, "rod_bench_report: Path too long: %s\n", path);
+        return -1;
+    }
+
+    FILE* file = fopen(tmp_path, "w");
+    if (!file) {
+        fprintf(stderr, "rod_bench_report: Failed to open %s\n", tmp_path);
+        return -1;
+    }
+    bool ok = true;
+    for (int i = 0; i < result->count && ok; i++) {
+        ok = fprintf(file, "%s %.6f\n", result->values[i].key, result->values[i].value) > 0;
+    }
+    ok = (fclose(file) == 0) && ok;
+    if (!ok || rename(tmp_path, path) != 0) {
+        fprintf(stderr, "rod_bench_report: Failed to write %s\n", path);
+        remove(tmp_path);
+        return -1;
+    }
+
+    return 0;
+}
+
+int rod_bench_result_read(RodBenchResult* result, const char* path) {
+    if (!result || !path) return -1;
+    rod_bench_result_init(result);
+
+    FILE* file = fopen(path, "r");
+    if (!file) {
+        fprintf(stderr, "rod_bench_report: Failed to open %s\n", path);
+        return -1;
+    }
+
+    char line[LINE_SIZE];
+    int line_number = 0;
+    int status = 0;
+    while (status == 0 && fgets(line, sizeof(line), file)) {
+        line_number++;
+        if (line[0] == '\n' || line[0] == '#') continue;
+
+        char key[ROD_BENCH_KEY_SIZE];
+        double value;
+        if (sscanf(line, "%31s %lf", key, &value) != 2 || rod_bench_result_set(result, key, value) != 0) {
+            fprintf(stderr, "rod_bench_report: Malformed line %d in %s\n", line_number, path);
+            status = -1;
+        }
+    }
+
+    fclose(file);
+    return status;
+}
+
+static bool ends_with(const char* key, const char* suffix) {
+    size_t key_length = strlen(key);
+    size_t suffix_length = strlen(suffix);
+    return key_length >= suffix_length && strcmp(key + key_length - suffix_length, suffix) == 0;
+}
+
+int rod_bench_result_compare(const RodBenchResult* result, const RodBenchResult* baseline,
+                             double tolerance, FILE* report) {
+    if (!result || !baseline) return -1;
+
+    int regressions = 0;
+    for (int i = 0; i < baseline->count; i++) {
+        const char* key = baseline->values[i].key;
+        double expected = baseline->values[i].value;
+        double value;
+        if (rod_bench_result_get(result, key, &value) != 0) continue;
+
+        bool higher_is_better = ends_with(key, "fps");
+        bool is_latency = ends_with(key, "_ms");
+        if (!higher_is_better && !is_latency && !ends_with(key, "_kb")) continue;
+
+        bool regressed;
+        if (higher_is_better) {
+            regressed = value < expected * (1.0 - tolerance);
+        } else {
+            double limit = expected * (1.0 + tolerance) + (is_latency ? ROD_BENCH_MIN_SLACK_MS : 0.0);
+            regressed = value > limit;
+        }
+        if (regressed) regressions++;
+
+        if (report) {
+            double change = expected != 0.0 ? (value - expected) / expected * 100.0 : 0.0;
+            fprintf(report, "%-20s %12.3f -> %12.3f (%+6.1f%%)%s\n", key, expected, value, change,
+                    regressed ? "  REGRESSION" : "");
+        }
+    }
+
+    return regressions;
+}
@@ -0,0 +1,123 @@
+/**
+ * @file rod_bench_report.h
+ * @brief Machine-readable replay benchmark results and baseline comparison
+ * @author Noé Game
+ * @date 14/10/2026
+ * @see rod_bench_report.c
+ * @copyright Cecill-C (Cf. LICENCE.txt)
+ *
+ * This module turns a benchmark run into a flat list of named values:
+ * - Frame counters, end-to-end fps, peak RSS
+ * - p50 / p99 / max / mean and fps of every pipeline stage (from RodMetrics)
+ * - One "key value" line per value in the result file (easy to diff and parse)
+ *
+ * A result can be compared against a saved baseline: fps must not drop and
+ * latencies / memory must not grow by more than a relative tolerance.
+ */
+
+#pragma once
+
+/* ******************************************************* Includes ****************************************************** */
+
+#include <stdio.h>
+#include "rod_metrics.h"
+
+/* ***************************************************** Public macros *************************************************** */
+
+#define ROD_BENCH_MAX_VALUES 64
+#define ROD_BENCH_KEY_SIZE 32
+#define ROD_BENCH_MIN_SLACK_MS 0.2   // Latency changes below this are timer noise, never regressions
+
+/* ************************************************** Public types definition ******************************************** */
+
+/**
+ * @brief One named benchmark value
+ */
+typedef struct {
+    char key[ROD_BENCH_KEY_SIZE];
+    double value;
+} RodBenchValue;
+
+/**
+ * @brief Benchmark result (insertion order is kept in the file)
+ */
+typedef struct {
+    RodBenchValue values[ROD_BENCH_MAX_VALUES];
+    int count;
+} RodBenchResult;
+
+/* *********************************************** Public functions declarations ***************************************** */
+
+/**
+ * @brief Empty a result
+ * @param result Result
+ */
+void rod_bench_result_init(RodBenchResult* result);
+
+/**
+ * @brief Set a value (replaced if the key exists)
+ * @param result Result
+ * @param key Value name (truncated to ROD_BENCH_KEY_SIZE - 1, no whitespace)
+ * @param value Value
+ * @return 0 on success, -1 if the result is full or the key invalid
+ */
+int rod_bench_result_set(RodBenchResult* result, const char* key, double value);
+
+/**
+ * @brief Get a value
+ * @param result Result
+ * @param key Value name
+ * @param value Output value
+ * @return 0 if found, -1 otherwise
+ */
+int rod_bench_result_get(const RodBenchResult* result, const char* key, double* value);
+
+/**
+ * @brief Fill a result from the pipeline metrics of a run
+ * @param result Result (emptied first)
+ * @param metrics Metrics of the run
+ * @param elapsed_s Wall time of the run in seconds
+ *
+ * Keys: frames, dropped, elapsed_s, fps, peak_rss_kb, then <metric>.p50_ms,
+ * <metric>.p99_ms, <metric>.max_ms, <metric>.mean_ms and <metric>.fps
+ * (1000 / mean, the rate the stage alone could sustain) for each metric.
+ */
+void rod_bench_result_from_metrics(RodBenchResult* result, RodMetrics* metrics, double elapsed_s);
+
+/**
+ * @brief Peak resident set size of the process
+ * @return Peak RSS in kilobytes, -1 on failure
+ */
+long rod_bench_peak_rss_kb(void);
+
+/**
+ * @brief Write a result file ("key value" lines)
+ * @param result Result
+ * @param path Output file (written to path.tmp, then renamed)
+ * @return 0 on success, -1 on failure
+ */
+int rod_bench_result_write(const RodBenchResult* result, const char* path);
+
+/**
+ * @brief Read a result file written by rod_bench_result_write()
+ * @param result Output result
+ * @param path Result file
+ * @return 0 on success, -1 on failure (missing file or malformed line)
+ */
+int rod_bench_result_read(RodBenchResult* result, const char* path);
+
+/**
+ * @brief Compare a result against a baseline
+ * @param result Current result
+ * @param baseline Saved baseline
+ * @param tolerance Allowed relative degradation (0.10 = 10%)
+ * @param report Output for one line per compared value (NULL = silent)
+ * @return Number of regressions (0 = no regression)
+ *
+ * Keys ending in "fps" must not drop below baseline * (1 - tolerance); keys
+ * ending in "_ms" or "_kb" must not exceed baseline * (1 + tolerance)
+ * (plus ROD_BENCH_MIN_SLACK_MS for latencies). Other keys and keys
+ * missing from either side are not compared.
+ */
+int rod_bench_result_compare(const RodBenchResult* result, const RodBenchResult* baseline,
+                             double tolerance, FILE* report);
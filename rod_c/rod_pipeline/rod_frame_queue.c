@@ -0,0 +1,215 @@
+/**
+ * @file rod_frame_queue.c
+ * @brief Bounded thread-safe queue of frame slots for the ROD detection pipeline
+ * @author Noé Game
+ * @date 14/10/2026
+ * @see rod_frame_queue.h
+ * @copyright Cecill-C (Cf. LICENCE.txt)
+ */
+
+#define _POSIX_C_SOURCE 200809L  // Required for pthread_condattr_setclock
+
+/* ******************************************************* Includes ****************************************************** */
+
+#include "rod_frame_queue.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <time.h>
+
+/* ***************************************************** Public macros *************************************************** */
+
+/* ************************************************** Public types definition ******************************************** */
+
+/**
+ * @brief Frame queue structure (ring buffer protected by a mutex)
+ */
+struct RodFrameQueue {
+    void** items;             // Ring storage
+    int capacity;             // Maximum number of items
+    int head;                 // Index of the oldest item
+    int count;                // Number of queued items
+    bool closed;              // Set by rod_frame_queue_close()
+    pthread_mutex_t lock;
+    pthread_cond_t not_empty;
+    pthread_cond_t not_full;
+};
+
+/* *********************************************** Public functions declarations ***************************************** */
+
+/* ******************************************* Public callback functions declarations ************************************ */
+
+/* ********************************************* Function implementations *********************************************** */
+
+RodFrameQueue* rod_frame_queue_create(int capacity) {
+    if (capacity <= 0) {
+        fprintf(stderr, "rod_frame_queue: Invalid capacity %d\n", capacity);
+        return NULL;
+    }
+    
+    RodFrameQueue* queue = (RodFrameQueue*)calloc(1, sizeof(RodFrameQueue));
+    if (!queue) {
+        fprintf(stderr, "rod_frame_queue: Failed to allocate queue\n");
+        return NULL;
+    }
+    
+    queue->items = (void**)calloc(capacity, sizeof(void*));
+    if (!queue->items) {
+        fprintf(stderr, "rod_frame_queue: Failed to allocate queue storage\n");
+        free(queue);
+        return NULL;
+    }
+    queue->capacity = capacity;
+    
+    // Timed waits use CLOCK_MONOTONIC (immune to wall clock changes)
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_mutex_init(&queue->lock, NULL);
+    pthread_cond_init(&queue->not_empty, &attr);
+    pthread_cond_init(&queue->not_full, &attr);
+    pthread_condattr_destroy(&attr);
+    
+    return queue;
+}
+
+void rod_frame_queue_destroy(RodFrameQueue* queue) {
+    if (!queue) return;
+    
+    pthread_cond_destroy(&queue->not_full);
+    pthread_cond_destroy(&queue->not_empty);
+    pthread_mutex_destroy(&queue->lock);
+    free(queue->items);
+    free(queue);
+}
+
+/**
+ * @brief Append an item at the tail (lock must be held, queue not full)
+ */
+static void enqueue_locked(RodFrameQueue* queue, void* item) {
+    int tail = (queue->head + queue->count) % queue->capacity;
+    queue->items[tail] = item;
+    queue->count++;
+    pthread_cond_signal(&queue->not_empty);
+}
+
+/**
+ * @brief Remove the item at the head (lock must be held, queue not empty)
+ */
+static void* dequeue_locked(RodFrameQueue* queue) {
+    void* item = queue->items[queue->head];
+    queue->items[queue->head] = NULL;
+    queue->head = (queue->head + 1) % queue->capacity;
+    queue->count--;
+    pthread_cond_signal(&queue->not_full);
+    return item;
+}
+
+int rod_frame_queue_push(RodFrameQueue* queue, void* item) {
+    if (!queue || !item) return -1;
+    
+    pthread_mutex_lock(&queue->lock);
+    while (queue->count == queue->capacity && !queue->closed) {
+        pthread_cond_wait(&queue->not_full, &queue->lock);
+    }
+    
+    if (queue->closed) {
+        pthread_mutex_unlock(&queue->lock);
+        return -1;
+    }
+    
+    enqueue_locked(queue, item);
+    pthread_mutex_unlock(&queue->lock);
+    return 0;
+}
+
+int rod_frame_queue_try_push(RodFrameQueue* queue, void* item) {
+    if (!queue || !item) return -1;
+    
+    pthread_mutex_lock(&queue->lock);
+    if (queue->closed || queue->count == queue->capacity) {
+        pthread_mutex_unlock(&queue->lock);
+        return -1;
+    }
+    
+    enqueue_locked(queue, item);
+    pthread_mutex_unlock(&queue->lock);
+    return 0;
+}
+
+int rod_frame_queue_push_drop_oldest(RodFrameQueue* queue, void* item, void** dropped) {
+    if (dropped) *dropped = NULL;
+    if (!queue || !item) return -1;
+    
+    pthread_mutex_lock(&queue->lock);
+    if (queue->closed) {
+        pthread_mutex_unlock(&queue->lock);
+        return -1;
+    }
+    
+    // Evict the oldest item instead of blocking the producer
+    if (queue->count == queue->capacity) {
+        void* oldest = dequeue_locked(queue);
+        if (dropped) *dropped = oldest;
+    }
+    
+    enqueue_locked(queue, item);
+    pthread_mutex_unlock(&queue->lock);
+    return 0;
+}
+
+void* rod_frame_queue_pop(RodFrameQueue* queue, int timeout_ms) {
+    if (!queue) return NULL;
+    
+    struct timespec deadline;
+    if (timeout_ms >= 0) {
+        clock_gettime(CLOCK_MONOTONIC, &deadline);
+        deadline.tv_sec += timeout_ms / 1000;
+        deadline.tv_nsec += (long)(timeout_ms % 1000) * 1000000L;
+        if (deadline.tv_nsec >= 1000000000L) {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000L;
+        }
+    }
+    
+    pthread_mutex_lock(&queue->lock);
+    while (queue->count == 0 && !queue->closed) {
+        if (timeout_ms < 0) {
+            pthread_cond_wait(&queue->not_empty, &queue->lock);
+        } else if (pthread_cond_timedwait(&queue->not_empty, &queue->lock, &deadline) != 0) {
+            break;  // Timeout
+        }
+    }
+    
+    void* item = queue->count > 0 ? dequeue_locked(queue) : NULL;
+    pthread_mutex_unlock(&queue->lock);
+    return item;
+}
+
+void rod_frame_queue_close(RodFrameQueue* queue) {
+    if (!queue) return;
+    
+    pthread_mutex_lock(&queue->lock);
+    queue->closed = true;
+    pthread_cond_broadcast(&queue->not_empty);
+    pthread_cond_broadcast(&queue->not_full);
+    pthread_mutex_unlock(&queue->lock);
+}
+
+int rod_frame_queue_depth(RodFrameQueue* queue) {
+    if (!queue) return 0;
+    
+    pthread_mutex_lock(&queue->lock);
+    int depth = queue->count;
+    pthread_mutex_unlock(&queue->lock);
+    return depth;
+}
+
+bool rod_frame_queue_is_closed(RodFrameQueue* queue) {
+    if (!queue) return true;
+    
+    pthread_mutex_lock(&queue->lock);
+    bool closed = queue->closed;
+    pthread_mutex_unlock(&queue->lock);
+    return closed;
+}
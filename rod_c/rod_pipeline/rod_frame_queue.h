@@ -0,0 +1,101 @@
+/**
+ * @file rod_frame_queue.h
+ * @brief Bounded thread-safe queue of frame slots for the ROD detection pipeline
+ * @author Noé Game
+ * @date 14/10/2026
+ * @see rod_frame_queue.c
+ * @copyright Cecill-C (Cf. LICENCE.txt)
+ * 
+ * This module provides the hand-off between pipeline stages:
+ * - Fixed capacity ring (no allocation after creation)
+ * - Blocking pop with timeout
+ * - Drop-oldest push for backpressure (the freshest frame always wins)
+ * - Close operation to wake up and stop all stage threads
+ */
+
+#pragma once
+
+/* ******************************************************* Includes ****************************************************** */
+
+#include <stdbool.h>
+
+/* ***************************************************** Public macros *************************************************** */
+
+/* ************************************************** Public types definition ******************************************** */
+
+/**
+ * @brief Opaque frame queue
+ */
+typedef struct RodFrameQueue RodFrameQueue;
+
+/* *********************************************** Public functions declarations ***************************************** */
+
+/**
+ * @brief Create a bounded frame queue
+ * @param capacity Maximum number of items held by the queue
+ * @return Queue, or NULL on failure
+ */
+RodFrameQueue* rod_frame_queue_create(int capacity);
+
+/**
+ * @brief Destroy a frame queue (items still queued are not freed)
+ * @param queue Frame queue
+ */
+void rod_frame_queue_destroy(RodFrameQueue* queue);
+
+/**
+ * @brief Push an item, blocking while the queue is full
+ * @param queue Frame queue
+ * @param item Item to push (must not be NULL)
+ * @return 0 on success, -1 if the queue is closed
+ */
+int rod_frame_queue_push(RodFrameQueue* queue, void* item);
+
+/**
+ * @brief Push an item only if there is room (never blocks)
+ * @param queue Frame queue
+ * @param item Item to push (must not be NULL)
+ * @return 0 on success, -1 if the queue is full or closed
+ */
+int rod_frame_queue_try_push(RodFrameQueue* queue, void* item);
+
+/**
+ * @brief Push an item, evicting the oldest one if the queue is full
+ * @param queue Frame queue
+ * @param item Item to push (must not be NULL)
+ * @param dropped Output for the evicted item (NULL if nothing was evicted)
+ * @return 0 on success, -1 if the queue is closed
+ * 
+ * The caller owns the evicted item and must recycle it.
+ */
+int rod_frame_queue_push_drop_oldest(RodFrameQueue* queue, void* item, void** dropped);
+
+/**
+ * @brief Pop the oldest item
+ * @param queue Frame queue
+ * @param timeout_ms Maximum wait in milliseconds (-1 = wait forever)
+ * @return Item, or NULL on timeout or when the queue is closed and empty
+ */
+void* rod_frame_queue_pop(RodFrameQueue* queue, int timeout_ms);
+
+/**
+ * @brief Close the queue and wake up all waiting threads
+ * @param queue Frame queue
+ * 
+ * After closing, push fails and pop only drains the remaining items.
+ */
+void rod_frame_queue_close(RodFrameQueue* queue);
+
+/**
+ * @brief Get the number of queued items
+ * @param queue Frame queue
+ * @return Queue depth
+ */
+int rod_frame_queue_depth(RodFrameQueue* queue);
+
+/**
+ * @brief Check if the queue has been closed
+ * @param queue Frame queue
+ * @return true if closed
+ */
+bool rod_frame_queue_is_closed(RodFrameQueue* queue);
@@ -0,0 +1,258 @@
+/**
+ * @file rod_metrics.c
+ * @brief Lock-free per-stage latency histograms and counters for the ROD detection pipeline
+ * @author Noé Game
+ * @date 14/10/2026
+ * @see rod_metrics.h
+ * @copyright Cecill-C (Cf. LICENCE.txt)
+ */
+
+/* ******************************************************* Includes ****************************************************** */
+
+#include "rod_metrics.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+
+/* ***************************************************** Public macros *************************************************** */
+
+// Log-linear buckets: values below SUB_BUCKET_COUNT us are exact, above that each
+// power of two is split in SUB_BUCKET_COUNT buckets
+#define SUB_BUCKET_BITS 4
+#define SUB_BUCKET_COUNT (1 << SUB_BUCKET_BITS)
+#define MAX_EXPONENT 31  // Largest recorded value 2^32 - 1 us (about 71 minutes)
+#define MAX_VALUE_US ((1ULL << (MAX_EXPONENT + 1)) - 1)
+#define BUCKET_COUNT ((MAX_EXPONENT - SUB_BUCKET_BITS + 2) * SUB_BUCKET_COUNT)
+
+#define REPORT_LINE_SIZE 128
+
+/* ************************************************** Public types definition ******************************************** */
+
+/**
+ * @brief Latency histogram (microseconds)
+ */
+typedef struct {
+    atomic_uint_fast64_t buckets[BUCKET_COUNT];
+    atomic_uint_fast64_t sum_us;
+    atomic_uint_fast64_t max_us;
+} RodHistogram;
+
+/**
+ * @brief Metrics registry
+ */
+struct RodMetrics {
+    RodHistogram histograms[ROD_METRIC_COUNT];
+    atomic_uint_fast64_t counters[ROD_COUNTER_COUNT];
+};
+
+/* ******************************************* Global variables ******************************************************* */
+
+static const char* const METRIC_NAMES[ROD_METRIC_COUNT] = {
+    "capture", "sharpen", "mask", "detect", "pose", "send", "save", "total"
+};
+
+static const char* const COUNTER_NAMES[ROD_COUNTER_COUNT] = {
+    "frames", "dropped", "motion_regions", "motion_skipped",
+    "minor_faults", "major_faults", "voluntary_switches", "involuntary_switches"
+};
+
+/* ********************************************* Function implementations *********************************************** */
+
+static int bucket_index(uint64_t value_us) {
+    if (value_us < SUB_BUCKET_COUNT) {
+        return (int)value_us;
+    }
+    if (value_us > MAX_VALUE_US) {
+        value_us = MAX_VALUE_US;
+    }
+
+    int exponent = 63 - __builtin_clzll(value_us);  // >= SUB_BUCKET_BITS
+    int sub = (int)(value_us >> (exponent - SUB_BUCKET_BITS)) - SUB_BUCKET_COUNT;
+    return (exponent - SUB_BUCKET_BITS + 1) * SUB_BUCKET_COUNT + sub;
+}
+
+// Middle of the value range covered by a bucket
+static double bucket_value_us(int index) {
+    if (index < SUB_BUCKET_COUNT) {
+        return (double)index;
+    }
+
+    int exponent = index / SUB_BUCKET_COUNT + SUB_BUCKET_BITS - 1;
+    int sub = index % SUB_BUCKET_COUNT;
+    uint64_t width = 1ULL << (exponent - SUB_BUCKET_BITS);
+    uint64_t lower = (uint64_t)(SUB_BUCKET_COUNT + sub) * width;
+    return (double)lower + (double)(width - 1) / 2.0;
+}
+
+RodMetrics* rod_metrics_create(void) {
+    RodMetrics* metrics = (RodMetrics*)calloc(1, sizeof(RodMetrics));
+    if (!metrics) {
+        fprintf(stderr, "rod_metrics: Failed to allocate metrics\n");
+        return NULL;
+    }
+
+    for (int m = 0; m < ROD_METRIC_COUNT; m++) {
+        RodHistogram* histogram = &metrics->histograms[m];
+        for (int i = 0; i < BUCKET_COUNT; i++) {
+            atomic_init(&histogram->buckets[i], 0);
+        }
+        atomic_init(&histogram->sum_us, 0);
+        atomic_init(&histogram->max_us, 0);
+    }
+    for (int c = 0; c < ROD_COUNTER_COUNT; c++) {
+        atomic_init(&metrics->counters[c], 0);
+    }
+
+    return metrics;
+}
+
+void rod_metrics_destroy(RodMetrics* metrics) {
+    free(metrics);
+}
+
+void rod_metrics_record(RodMetrics* metrics, RodMetric metric, double duration_ms) {
+    if (!metrics || metric < 0 || metric >= ROD_METRIC_COUNT) return;
+
+    double value = duration_ms * 1000.0 + 0.5;
+    uint64_t value_us = value <= 0.0 ? 0 : (value >= (double)MAX_VALUE_US ? MAX_VALUE_US : (uint64_t)value);
+    RodHistogram* histogram = &metrics->histograms[metric];
+
+    atomic_fetch_add_explicit(&histogram->buckets[bucket_index(value_us)], 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&histogram->sum_us, value_us, memory_order_relaxed);
+
+    uint_fast64_t max = atomic_load_explicit(&histogram->max_us, memory_order_relaxed);
+    while (value_us > max &&
+           !atomic_compare_exchange_weak_explicit(&histogram->max_us, &max, value_us,
+                                                  memory_order_relaxed, memory_order_relaxed)) {
+        // max reloaded by the failed exchange
+    }
+}
+
+void rod_metrics_increment(RodMetrics* metrics, RodCounter counter) {
+    if (!metrics || counter < 0 || counter >= ROD_COUNTER_COUNT) return;
+    atomic_fetch_add_explicit(&metrics->counters[counter], 1, memory_order_relaxed);
+}
+
+void rod_metrics_set_counter(RodMetrics* metrics, RodCounter counter, uint64_t value) {
+    if (!metrics || counter < 0 || counter >= ROD_COUNTER_COUNT) return;
+    atomic_store_explicit(&metrics->counters[counter], value, memory_order_relaxed);
+}
+
+uint64_t rod_metrics_get_counter(RodMetrics* metrics, RodCounter counter) {
+    if (!metrics || counter < 0 || counter >= ROD_COUNTER_COUNT) return 0;
+    return atomic_load_explicit(&metrics->counters[counter], memory_order_relaxed);
+}
+
+void rod_metrics_get_summary(RodMetrics* metrics, RodMetric metric, RodMetricSummary* summary) {
+    if (!summary) return;
+    summary->count = 0;
+    summary->p50_ms = summary->p99_ms = summary->max_ms = summary->mean_ms = 0.0;
+    if (!metrics || metric < 0 || metric >= ROD_METRIC_COUNT) return;
+
+    // Snapshot the buckets once: recorders may keep adding while we read,
+    // the total is taken from the snapshot so the percentiles stay consistent
+    RodHistogram* histogram = &metrics->histograms[metric];
+    uint64_t snapshot[BUCKET_COUNT];
+    uint64_t total = 0;
+    for (int i = 0; i < BUCKET_COUNT; i++) {
+        snapshot[i] = atomic_load_explicit(&histogram->buckets[i], memory_order_relaxed);
+        total += snapshot[i];
+    }
+    if (total == 0) return;
+
+    double max_us = (double)atomic_load_explicit(&histogram->max_us, memory_order_relaxed);
+    uint64_t rank50 = (total * 50 + 99) / 100;  // Smallest rank covering the percentile
+    uint64_t rank99 = (total * 99 + 99) / 100;
+    double p50_us = max_us;
+    double p99_us = max_us;
+    bool found50 = false;
+    uint64_t seen = 0;
+    for (int i = 0; i < BUCKET_COUNT; i++) {
+        if (snapshot[i] == 0) continue;
+        seen += snapshot[i];
+        if (!found50 && seen >= rank50) {
+            p50_us = bucket_value_us(i);
+            found50 = true;
+        }
+        if (seen >= rank99) {
+            p99_us = bucket_value_us(i);
+            break;
+        }
+    }
+
+    summary->count = total;
+    summary->max_ms = max_us / 1000.0;
+    summary->p50_ms = (p50_us < max_us ? p50_us : max_us) / 1000.0;
+    summary->p99_ms = (p99_us < max_us ? p99_us : max_us) / 1000.0;
+    summary->mean_ms = (double)atomic_load_explicit(&histogram->sum_us, memory_order_relaxed) / (double)total / 1000.0;
+}
+
+const char* rod_metrics_name(RodMetric metric) {
+    if (metric < 0 || metric >= ROD_METRIC_COUNT) return "unknown";
+    return METRIC_NAMES[metric];
+}
+
+// Append to a report, keeping track of the full length even once truncated
+static void report_append(char* buffer, size_t size, size_t* length, const char* format, ...) {
+    size_t offset = *length < size ? *length : size - 1;
+    va_list args;
+    va_start(args, format);
+    int n = vsnprintf(buffer + offset, size - offset, format, args);
+    va_end(args);
+    if (n > 0) *length += (size_t)n;
+}
+
+int rod_metrics_format(RodMetrics* metrics, char* buffer, size_t size) {
+    if (!metrics || !buffer || size == 0) return -1;
+
+    size_t length = 0;
+    buffer[0] = '\0';
+
+    for (int c = 0; c < ROD_COUNTER_COUNT; c++) {
+        report_append(buffer, size, &length, "%s %llu\n", COUNTER_NAMES[c],
+                      (unsigned long long)rod_metrics_get_counter(metrics, (RodCounter)c));
+    }
+
+    report_append(buffer, size, &length, "%-8s %8s %9s %9s %9s %9s\n",
+                  "metric", "count", "p50_ms", "p99_ms", "max_ms", "mean_ms");
+    for (int m = 0; m < ROD_METRIC_COUNT; m++) {
+        RodMetricSummary summary;
+        rod_metrics_get_summary(metrics, (RodMetric)m, &summary);
+        report_append(buffer, size, &length, "%-8s %8llu %9.2f %9.2f %9.2f %9.2f\n",
+                      METRIC_NAMES[m], (unsigned long long)summary.count,
+                      summary.p50_ms, summary.p99_ms, summary.max_ms, summary.mean_ms);
+    }
+
+    return (int)(length < size ? length : size - 1);
+}
+
+int rod_metrics_dump(RodMetrics* metrics, const char* path) {
+    if (!metrics || !path) return -1;
+
+    char report[REPORT_LINE_SIZE * (ROD_METRIC_COUNT + ROD_COUNTER_COUNT + 1)];
+    int length = rod_metrics_format(metrics, report, sizeof(report));
+    if (length < 0) return -1;
+
+    char tmp_path[512];
+    if (snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path) >= (int)sizeof(tmp_path)) {
+        fprintf(stderr, "rod_metrics: Path too long: %s\n", path);
+        return -1;
+    }
+
+    FILE* file = fopen(tmp_path, "w");
+    if (!file) {
+        fprintf(stderr, "rod_metrics: Failed to open %s\n", tmp_path);
+        return -1;
+    }
+    bool ok = fwrite(report, 1, (size_t)length, file) == (size_t)length;
+    ok = (fclose(file) == 0) && ok;
+    if (!ok || rename(tmp_path, path) != 0) {
+        fprintf(stderr, "rod_metrics: Failed to write %s\n", path);
+        remove(tmp_path);
+        return -1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,154 @@
+/**
+ * @file rod_metrics.h
+ * @brief Lock-free per-stage latency histograms and counters for the ROD detection pipeline
+ * @author Noé Game
+ * @date 14/10/2026
+ * @see rod_metrics.c
+ * @copyright Cecill-C (Cf. LICENCE.txt)
+ *
+ * This module replaces per-frame timing logs with aggregated numbers:
+ * - One log-linear histogram per stage (16 sub-buckets per power of two,
+ *   about 6% relative error, from 1 us to more than an hour)
+ * - Recording is a few relaxed atomic additions (no lock, no allocation),
+ *   any thread can record while another one reads
+ * - p50 / p99 / max / mean per stage, frame and drop counters
+ * - Text report written atomically to a file (write + rename)
+ *
+ * Values are cumulative since creation.
+ */
+
+#pragma once
+
+/* ******************************************************* Includes ****************************************************** */
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* ***************************************************** Public macros *************************************************** */
+
+/* ************************************************** Public types definition ******************************************** */
+
+/**
+ * @brief Measured durations
+ */
+typedef enum {
+    ROD_METRIC_CAPTURE = 0,  // Camera frame acquisition
+    ROD_METRIC_SHARPEN,      // Sharpen (whole fused preprocessing when enabled)
+    ROD_METRIC_MASK,         // Field mask
+    ROD_METRIC_DETECT,       // ArUco detection
+    ROD_METRIC_POSE,         // Playground localization
+    ROD_METRIC_SEND,         // Socket and shared memory publication
+    ROD_METRIC_SAVE,         // Debug image annotation and queuing
+    ROD_METRIC_TOTAL,        // Sensor timestamp to publish end
+    ROD_METRIC_COUNT
+} RodMetric;
+
+/**
+ * @brief Event counters
+ */
+typedef enum {
+    ROD_COUNTER_FRAMES = 0,  // Frames published
+    ROD_COUNTER_DROPPED,     // Frames dropped between stages
+    ROD_COUNTER_MOTION_REGIONS,        // Static field: frames searched around the known markers only (rod_motion_gate.h)
+    ROD_COUNTER_MOTION_SKIPPED,        // Static field: frames not detected, markers carried over
+    ROD_COUNTER_MINOR_FAULTS,          // Page faults served without I/O (process, see rod_realtime_get_usage())
+    ROD_COUNTER_MAJOR_FAULTS,          // Page faults that needed I/O
+    ROD_COUNTER_VOLUNTARY_SWITCHES,    // Context switches while waiting (queues, camera, I/O)
+    ROD_COUNTER_INVOLUNTARY_SWITCHES,  // Context switches forced by the scheduler (preempted)
+    ROD_COUNTER_COUNT
+} RodCounter;
+
+/**
+ * @brief Latency summary of one metric
+ */
+typedef struct {
+    uint64_t count;
+    double p50_ms;
+    double p99_ms;
+    double max_ms;
+    double mean_ms;
+} RodMetricSummary;
+
+/**
+ * @brief Opaque metrics registry
+ */
+typedef struct RodMetrics RodMetrics;
+
+/* *********************************************** Public functions declarations ***************************************** */
+
+/**
+ * @brief Create a metrics registry (all histograms and counters at zero)
+ * @return Metrics, or NULL on failure
+ */
+RodMetrics* rod_metrics_create(void);
+
+/**
+ * @brief Destroy a metrics registry
+ * @param metrics Metrics (NULL is ignored)
+ */
+void rod_metrics_destroy(RodMetrics* metrics);
+
+/**
+ * @brief Record one duration
+ * @param metrics Metrics (NULL is ignored)
+ * @param metric Measured duration
+ * @param duration_ms Duration in milliseconds (negative values count as 0)
+ */
+void rod_metrics_record(RodMetrics* metrics, RodMetric metric, double duration_ms);
+
+/**
+ * @brief Increment a counter
+ * @param metrics Metrics (NULL is ignored)
+ * @param counter Counter
+ */
+void rod_metrics_increment(RodMetrics* metrics, RodCounter counter);
+
+/**
+ * @brief Overwrite a counter (values sampled elsewhere, such as the process resource usage)
+ * @param metrics Metrics (NULL is ignored)
+ * @param counter Counter
+ * @param value New value
+ */
+void rod_metrics_set_counter(RodMetrics* metrics, RodCounter counter, uint64_t value);
+
+/**
+ * @brief Get a counter value
+ * @param metrics Metrics
+ * @param counter Counter
+ * @return Counter value (0 for NULL metrics)
+ */
+uint64_t rod_metrics_get_counter(RodMetrics* metrics, RodCounter counter);
+
+/**
+ * @brief Compute the latency summary of a metric
+ * @param metrics Metrics
+ * @param metric Measured duration
+ * @param summary Output summary (all zero when nothing was recorded)
+ *
+ * Percentiles are bucket midpoints (never above the exact maximum).
+ */
+void rod_metrics_get_summary(RodMetrics* metrics, RodMetric metric, RodMetricSummary* summary);
+
+/**
+ * @brief Get the short name of a metric ("capture", "detect", ...)
+ * @param metric Measured duration
+ * @return Static string ("unknown" if out of range)
+ */
+const char* rod_metrics_name(RodMetric metric);
+
+/**
+ * @brief Format a text report: counters, then one line per metric (count p50 p99 max mean)
+ * @param metrics Metrics
+ * @param buffer Output buffer
+ * @param size Buffer size in bytes
+ * @return Report length (truncated to size - 1), -1 on error
+ */
+int rod_metrics_format(RodMetrics* metrics, char* buffer, size_t size);
+
+/**
+ * @brief Write the text report to a file
+ * @param metrics Metrics
+ * @param path Output file (written to path.tmp, then renamed: readers never see a partial report)
+ * @return 0 on success, -1 on failure
+ */
+int rod_metrics_dump(RodMetrics* metrics, const char* path);
@@ -0,0 +1,218 @@
+/**
+ * @file rod_motion_gate.c
+ * @brief Motion-gated detection scheduling: skip or downgrade detection while the field is static
+ * @author Noé Game
+ * @date 14/10/2026
+ * @see rod_motion_gate.h
+ * @copyright Cecill-C (Cf. LICENCE.txt)
+ */
+
+/* ******************************************************* Includes ****************************************************** */
+
+#include "rod_motion_gate.h"
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* ***************************************************** Public macros *************************************************** */
+
+/* ************************************************** Public types definition ******************************************** */
+
+/**
+ * @brief Motion gate structure
+ */
+struct RodMotionGate {
+    RodMotionGateConfig config;
+    uint8_t reference[ROD_MOTION_GATE_MAX_CELLS];  // Thumbnail of the last detected frame
+    uint8_t current[ROD_MOTION_GATE_MAX_CELLS];
+    bool has_reference;
+    int reference_width;         // Area size the reference was built from
+    int reference_height;
+    int static_frames;           // Consecutive frames without motion
+    uint64_t last_full_us;       // Timestamp of the last full (or normal) detection
+    bool full_requested;
+    bool detect_requested;       // A detected frame was dropped: detect the next one
+    RodMotionGateStats stats;
+};
+
+/* *********************************************** Public functions declarations ***************************************** */
+
+/* ******************************************* Public callback functions declarations ************************************ */
+
+/* ********************************************* Function implementations *********************************************** */
+
+RodMotionGate* rod_motion_gate_create(const RodMotionGateConfig* config) {
+    if (!config || config->grid_cols < 1 || config->grid_rows < 1 ||
+        config->grid_cols * config->grid_rows > ROD_MOTION_GATE_MAX_CELLS ||
+        config->cell_threshold < 0 || config->cell_threshold > 255 ||
+        config->min_changed_cells < 1 || config->min_changed_cells > config->grid_cols * config->grid_rows ||
+        config->settle_frames < 0 || config->roi_interval < 0) {
+        fprintf(stderr, "rod_motion_gate: Invalid parameters\n");
+        return NULL;
+    }
+
+    RodMotionGate* gate = (RodMotionGate*)calloc(1, sizeof(RodMotionGate));
+    if (!gate) {
+        fprintf(stderr, "rod_motion_gate: Failed to allocate gate\n");
+        return NULL;
+    }
+
+    gate->config = *config;
+    return gate;
+}
+
+void rod_motion_gate_destroy(RodMotionGate* gate) {
+    free(gate);
+}
+
+/**
+ * @brief Reduce the area to one mean value per cell, from CELL_SAMPLES x CELL_SAMPLES pixels each
+ */
+static void build_thumbnail(RodMotionGate* gate, const uint8_t* data, int width, int height,
+                            size_t stride, int channels) {
+    const int cols = gate->config.grid_cols;
+    const int rows = gate->config.grid_rows;
+    const int samples = ROD_MOTION_GATE_CELL_SAMPLES;
+    const int offset = channels > 1 ? 1 : 0;  // Green of BGR, closest to luma
+
+    for (int cy = 0; cy < rows; cy++) {
+        int y0 = cy * height / rows;
+        int cell_height = (cy + 1) * height / rows - y0;
+        for (int cx = 0; cx < cols; cx++) {
+            int x0 = cx * width / cols;
+            int cell_width = (cx + 1) * width / cols - x0;
+
+            // Samples at the centers of a samples x samples split of the cell
+            unsigned int sum = 0;
+            for (int sy = 0; sy < samples; sy++) {
+                const uint8_t* row = data + (size_t)(y0 + (2 * sy + 1) * cell_height / (2 * samples)) * stride;
+                for (int sx = 0; sx < samples; sx++) {
+                    int x = x0 + (2 * sx + 1) * cell_width / (2 * samples);
+                    sum += row[(size_t)x * (size_t)channels + (size_t)offset];
+                }
+            }
+            gate->current[cy * cols + cx] = (uint8_t)(sum / (unsigned int)(samples * samples));
+        }
+    }
+}
+
+static int count_changed_cells(const RodMotionGate* gate) {
+    int cells = gate->config.grid_cols * gate->config.grid_rows;
+    int changed = 0;
+    for (int i = 0; i < cells; i++) {
+        int delta = (int)gate->current[i] - (int)gate->reference[i];
+        if (delta > gate->config.cell_threshold || -delta > gate->config.cell_threshold) {
+            changed++;
+        }
+    }
+    return changed;
+}
+
+/**
+ * @brief Decision for a static frame
+ */
+static RodMotionDecision static_decision(const RodMotionGate* gate, uint64_t timestamp_us) {
+    // Time going backwards (replay restarted) counts as elapsed
+    if (timestamp_us < gate->last_full_us || timestamp_us - gate->last_full_us >= gate->config.full_interval_us) {
+        return ROD_MOTION_DETECT_FULL;
+    }
+
+    int static_count = gate->static_frames - gate->config.settle_frames;
+    if (gate->config.roi_interval > 0 && static_count % gate->config.roi_interval == 0) {
+        return ROD_MOTION_DETECT_REGIONS;
+    }
+    return ROD_MOTION_SKIP;
+}
+
+RodMotionDecision rod_motion_gate_update(RodMotionGate* gate, const uint8_t* data, int width, int height,
+                                         size_t stride, int channels, uint64_t timestamp_us) {
+    if (!gate) return ROD_MOTION_DETECT;
+
+    // Area too small to be sampled: never gated
+    if (!data || channels < 1 || width < gate->config.grid_cols * ROD_MOTION_GATE_CELL_SAMPLES ||
+        height < gate->config.grid_rows * ROD_MOTION_GATE_CELL_SAMPLES) {
+        gate->has_reference = false;
+        gate->stats.frames++;
+        gate->stats.detected++;
+        return ROD_MOTION_DETECT;
+    }
+
+    build_thumbnail(gate, data, width, height, stride, channels);
+
+    RodMotionDecision decision;
+    gate->stats.changed_cells = 0;
+    if (!gate->has_reference || gate->full_requested ||
+        width != gate->reference_width || height != gate->reference_height) {
+        decision = ROD_MOTION_DETECT_FULL;
+        gate->static_frames = 0;
+        gate->full_requested = false;
+        gate->detect_requested = false;
+    } else if (gate->detect_requested) {
+        decision = ROD_MOTION_DETECT;
+        gate->static_frames = 0;
+        gate->detect_requested = false;
+    } else {
+        gate->stats.changed_cells = count_changed_cells(gate);
+        if (gate->stats.changed_cells >= gate->config.min_changed_cells) {
+            gate->static_frames = 0;
+        } else {
+            gate->static_frames++;
+        }
+        decision = gate->static_frames <= gate->config.settle_frames ? ROD_MOTION_DETECT
+                                                                      : static_decision(gate, timestamp_us);
+    }
+
+    // Detected frames become the reference of the next ones
+    if (decision != ROD_MOTION_SKIP) {
+        memcpy(gate->reference, gate->current, (size_t)(gate->config.grid_cols * gate->config.grid_rows));
+        gate->has_reference = true;
+        gate->reference_width = width;
+        gate->reference_height = height;
+    }
+    if (decision == ROD_MOTION_DETECT || decision == ROD_MOTION_DETECT_FULL) {
+        gate->last_full_us = timestamp_us;
+    }
+
+    gate->stats.frames++;
+    switch (decision) {
+        case ROD_MOTION_DETECT:         gate->stats.detected++; break;
+        case ROD_MOTION_DETECT_FULL:    gate->stats.full++; break;
+        case ROD_MOTION_DETECT_REGIONS: gate->stats.regions++; break;
+        case ROD_MOTION_SKIP:           gate->stats.skipped++; break;
+    }
+    return decision;
+}
+
+void rod_motion_gate_force_full(RodMotionGate* gate) {
+    if (gate) gate->full_requested = true;
+}
+
+void rod_motion_gate_reject(RodMotionGate* gate, RodMotionDecision decision) {
+    if (!gate) return;
+    switch (decision) {
+        case ROD_MOTION_DETECT_FULL:    gate->full_requested = true; break;
+        case ROD_MOTION_DETECT:
+        case ROD_MOTION_DETECT_REGIONS: gate->detect_requested = true; break;
+        case ROD_MOTION_SKIP:           break;
+    }
+}
+
+void rod_motion_gate_get_stats(const RodMotionGate* gate, RodMotionGateStats* stats) {
+    if (!stats) return;
+    if (!gate) {
+        memset(stats, 0, sizeof(RodMotionGateStats));
+        return;
+    }
+    *stats = gate->stats;
+}
+
+const char* rod_motion_gate_decision_name(RodMotionDecision decision) {
+    switch (decision) {
+        case ROD_MOTION_DETECT:         return "detect";
+        case ROD_MOTION_DETECT_FULL:    return "full";
+        case ROD_MOTION_DETECT_REGIONS: return "regions";
+        case ROD_MOTION_SKIP:           return "skip";
+    }
+    return "unknown";
+}
@@ -0,0 +1,149 @@
+/**
+ * @file rod_motion_gate.h
+ * @brief Motion-gated detection scheduling: skip or downgrade detection while the field is static
+ * @author Noé Game
+ * @date 14/10/2026
+ * @see rod_motion_gate.c
+ * @copyright Cecill-C (Cf. LICENCE.txt)
+ *
+ * Before the match or while the robots are parked, every frame shows the same
+ * field and a full detection finds the same markers again. The gate reduces
+ * each frame to a small luma thumbnail (a grid of cell means, 16 sampled
+ * pixels per cell whatever the frame size) and compares it with the thumbnail
+ * of the last detected frame:
+ * - enough changed cells: the scene moves, normal detection (ROD_MOTION_DETECT),
+ *   kept for settle_frames frames once it stops moving
+ * - static scene: the frame is not detected, the previous markers are carried
+ *   over (ROD_MOTION_SKIP), except every roi_interval frames where only the
+ *   regions around the known markers are searched (ROD_MOTION_DETECT_REGIONS)
+ * - whatever the scene, a full-frame detection at least every full_interval_us
+ *   (ROD_MOTION_DETECT_FULL), so new markers are never missed for long
+ *
+ * The comparison is made against the last detected frame, not the previous
+ * one: a slow drift adds up until it is detected. A frame the gate chose to
+ * detect becomes the reference when the decision is taken: if it is dropped
+ * before detection, rod_motion_gate_reject() makes the next frame detected.
+ *
+ * Not thread-safe: owned by one pipeline stage. No OpenCV dependency.
+ */
+
+#pragma once
+
+/* ******************************************************* Includes ****************************************************** */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ***************************************************** Public macros *************************************************** */
+
+#define ROD_MOTION_GATE_MAX_CELLS 4096  // grid_cols * grid_rows upper bound
+#define ROD_MOTION_GATE_CELL_SAMPLES 4  // Sampled pixels per cell side (16 per cell)
+
+/* ************************************************** Public types definition ******************************************** */
+
+/**
+ * @brief Opaque motion gate
+ */
+typedef struct RodMotionGate RodMotionGate;
+
+/**
+ * @brief How a frame must be processed
+ */
+typedef enum {
+    ROD_MOTION_DETECT = 0,       // Scene moving: normal detection
+    ROD_MOTION_DETECT_FULL,      // Full-frame detection (first frame, input change, full_interval_us elapsed)
+    ROD_MOTION_DETECT_REGIONS,   // Static scene: search only around the known markers
+    ROD_MOTION_SKIP              // Static scene: no detection, previous markers carried over
+} RodMotionDecision;
+
+/**
+ * @brief Gate settings
+ */
+typedef struct {
+    int grid_cols;               // Thumbnail cells (grid_cols * grid_rows <= ROD_MOTION_GATE_MAX_CELLS)
+    int grid_rows;
+    int cell_threshold;          // Mean luma change (0-255) for a cell to count as changed
+    int min_changed_cells;       // Changed cells for the scene to count as moving
+    int settle_frames;           // Frames still detected normally once the scene stopped moving
+    int roi_interval;            // Static scene: regions-only detection every N frames (0 = skip them all, 1 = never skip)
+    uint64_t full_interval_us;   // Maximum time between two full-frame detections
+} RodMotionGateConfig;
+
+/**
+ * @brief Decisions taken since the gate was created
+ */
+typedef struct {
+    uint64_t frames;
+    uint64_t detected;           // ROD_MOTION_DETECT
+    uint64_t full;               // ROD_MOTION_DETECT_FULL
+    uint64_t regions;            // ROD_MOTION_DETECT_REGIONS
+    uint64_t skipped;            // ROD_MOTION_SKIP
+    int changed_cells;           // Changed cells of the last frame
+} RodMotionGateStats;
+
+/* *********************************************** Public functions declarations ***************************************** */
+
+/**
+ * @brief Create a motion gate
+ * @param config Gate settings (copied)
+ * @return Gate, or NULL if a setting is out of range
+ */
+RodMotionGate* rod_motion_gate_create(const RodMotionGateConfig* config);
+
+/**
+ * @brief Destroy a motion gate
+ * @param gate Gate (NULL is ignored)
+ */
+void rod_motion_gate_destroy(RodMotionGate* gate);
+
+/**
+ * @brief Decide how to process a frame
+ * @param gate Gate
+ * @param data First pixel of the compared area
+ * @param width Area width in pixels
+ * @param height Area height in pixels
+ * @param stride Bytes between rows
+ * @param channels 1 = luma plane, 3 = BGR (the green channel is compared)
+ * @param timestamp_us Frame timestamp (microseconds, monotonic)
+ * @return Decision for this frame (ROD_MOTION_DETECT_FULL if the area size changed since the last frame,
+ *         ROD_MOTION_DETECT if it is too small for the grid)
+ */
+RodMotionDecision rod_motion_gate_update(RodMotionGate* gate, const uint8_t* data, int width, int height,
+                                         size_t stride, int channels, uint64_t timestamp_us);
+
+/**
+ * @brief Make the next frame a full-frame detection (e.g. markers lost, calibration changed)
+ * @param gate Gate (NULL is ignored)
+ */
+void rod_motion_gate_force_full(RodMotionGate* gate);
+
+/**
+ * @brief Report a frame dropped before its detection (e.g. detect stage behind)
+ *
+ * The dropped frame is already the reference: without detection of the next
+ * frame, static frames after it would carry over markers measured before it.
+ * @param gate Gate (NULL is ignored)
+ * @param decision Decision returned for the dropped frame: the next frame is detected
+ *                 (over the full frame if it was ROD_MOTION_DETECT_FULL); ROD_MOTION_SKIP is ignored
+ */
+void rod_motion_gate_reject(RodMotionGate* gate, RodMotionDecision decision);
+
+/**
+ * @brief Get the decisions taken so far
+ * @param gate Gate
+ * @param stats Output statistics (zero if gate is NULL)
+ */
+void rod_motion_gate_get_stats(const RodMotionGate* gate, RodMotionGateStats* stats);
+
+/**
+ * @brief Name of a decision, for logs
+ */
+const char* rod_motion_gate_decision_name(RodMotionDecision decision);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,148 @@
+/**
+ * @file rod_realtime.c
+ * @brief CPU affinity, real-time scheduling and memory locking for the detection pipeline threads
+ * @author Noé Game
+ * @date 14/10/2026
+ * @see rod_realtime.h
+ * @copyright Cecill-C (Cf. LICENCE.txt)
+ */
+
+#define _GNU_SOURCE  // Required for pthread_setaffinity_np and CPU_SET
+
+/* ******************************************************* Includes ****************************************************** */
+
+#include "rod_realtime.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <malloc.h>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+
+/* ***************************************************** Public macros *************************************************** */
+
+#define DEFAULT_PAGE_SIZE 4096
+
+/* ********************************************* Function implementations *********************************************** */
+
+static size_t page_size(void) {
+    long size = sysconf(_SC_PAGESIZE);
+    return size > 0 ? (size_t)size : DEFAULT_PAGE_SIZE;
+}
+
+/**
+ * @brief Restrict the calling thread to the CPUs of mask it is currently allowed on
+ */
+static int set_affinity(const char* name, uint64_t cpu_mask) {
+    cpu_set_t allowed;
+    if (pthread_getaffinity_np(pthread_self(), sizeof(allowed), &allowed) != 0) {
+        CPU_ZERO(&allowed);
+        for (int cpu = 0; cpu < ROD_REALTIME_MAX_CPUS && cpu < CPU_SETSIZE; cpu++) CPU_SET(cpu, &allowed);
+    }
+
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    for (int cpu = 0; cpu < ROD_REALTIME_MAX_CPUS && cpu < CPU_SETSIZE; cpu++) {
+        if ((cpu_mask >> cpu) & 1ULL && CPU_ISSET(cpu, &allowed)) {
+            CPU_SET(cpu, &cpus);
+        }
+    }
+    if (CPU_COUNT(&cpus) == 0) {
+        fprintf(stderr, "rod_realtime: No CPU of mask 0x%llx available for %s\n", (unsigned long long)cpu_mask, name);
+        return -1;
+    }
+
+    int err = pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+    if (err != 0) {
+        fprintf(stderr, "rod_realtime: Failed to pin %s: %s\n", name, strerror(err));
+        return -1;
+    }
+    return 0;
+}
+
+int rod_realtime_set_thread(const char* name, uint64_t cpu_mask, int priority) {
+    if (!name) name = "thread";
+    int result = 0;
+
+    if (cpu_mask != 0 && set_affinity(name, cpu_mask) != 0) {
+        result = -1;
+    }
+
+    if (priority != 0) {
+        if (priority < sched_get_priority_min(SCHED_FIFO) || priority > sched_get_priority_max(SCHED_FIFO)) {
+            fprintf(stderr, "rod_realtime: Invalid SCHED_FIFO priority %d for %s\n", priority, name);
+            return -1;
+        }
+        struct sched_param param;
+        memset(&param, 0, sizeof(param));
+        param.sched_priority = priority;
+        int err = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+        if (err != 0) {
+            fprintf(stderr, "rod_realtime: Failed to set SCHED_FIFO %d for %s: %s%s\n", priority, name, strerror(err),
+                    err == EPERM ? " (needs RLIMIT_RTPRIO or CAP_SYS_NICE)" : "");
+            result = -1;
+        }
+    }
+
+    return result;
+}
+
+void rod_realtime_prefault_stack(size_t size) {
+    if (size == 0) return;
+    unsigned char stack[size];
+    volatile unsigned char* touch = stack;  // Keeps the writes from being optimized away
+    size_t step = page_size();
+    for (size_t i = 0; i < size; i += step) {
+        touch[i] = 0;
+    }
+    touch[size - 1] = 0;
+}
+
+int rod_realtime_lock_memory(size_t heap_size) {
+    // Serve every allocation from one heap that is never trimmed: freed frame buffers stay
+    // resident and locked instead of going back to the system (and faulting in again)
+    mallopt(M_MMAP_MAX, 0);
+    mallopt(M_TRIM_THRESHOLD, -1);
+    mallopt(M_ARENA_MAX, 1);
+
+    if (heap_size > 0) {
+        unsigned char* heap = malloc(heap_size);
+        if (!heap) {
+            fprintf(stderr, "rod_realtime: Failed to pre-fault %zu bytes of heap\n", heap_size);
+        } else {
+            volatile unsigned char* touch = heap;
+            size_t step = page_size();
+            for (size_t i = 0; i < heap_size; i += step) {
+                touch[i] = 0;
+            }
+            free(heap);
+        }
+    }
+
+    if (mlockall(MCL_CURRENT | MCL_FUTURE) != 0) {
+        int err = errno;
+        fprintf(stderr, "rod_realtime: Failed to lock memory: %s%s\n", strerror(err),
+                (err == ENOMEM || err == EPERM) ? " (needs RLIMIT_MEMLOCK or CAP_IPC_LOCK)" : "");
+        return -1;
+    }
+    return 0;
+}
+
+int rod_realtime_get_usage(RodRealtimeUsage* usage) {
+    if (!usage) return -1;
+    memset(usage, 0, sizeof(*usage));
+
+    struct rusage ru;
+    if (getrusage(RUSAGE_SELF, &ru) != 0) {
+        return -1;
+    }
+    usage->minor_faults = (uint64_t)ru.ru_minflt;
+    usage->major_faults = (uint64_t)ru.ru_majflt;
+    usage->voluntary_switches = (uint64_t)ru.ru_nvcsw;
+    usage->involuntary_switches = (uint64_t)ru.ru_nivcsw;
+    return 0;
+}
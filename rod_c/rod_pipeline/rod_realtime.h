@@ -0,0 +1,79 @@
+/**
+ * @file rod_realtime.h
+ * @brief CPU affinity, real-time scheduling and memory locking for the detection pipeline threads
+ * @author Noé Game
+ * @date 14/10/2026
+ * @see rod_realtime.c
+ * @copyright Cecill-C (Cf. LICENCE.txt)
+ *
+ * Used by rod_detection --realtime so logging, SSH or other services sharing
+ * the Raspberry Pi cannot preempt a frame in flight:
+ * - Each pipelined stage thread is pinned to its own CPUs and optionally
+ *   switched to SCHED_FIFO (threads it creates, such as the OpenCV workers,
+ *   inherit both)
+ * - The heap is grown and touched once, kept by malloc instead of being given
+ *   back to the system, then every page of the process is locked (mlockall):
+ *   frame buffers allocated later reuse resident memory and never page fault
+ * - Page faults and context switches are sampled for the metrics report
+ *
+ * All of this needs privileges (RLIMIT_RTPRIO / CAP_SYS_NICE, RLIMIT_MEMLOCK /
+ * CAP_IPC_LOCK, see systemd/rod_detection.service). Each function reports a
+ * failure and leaves the thread or process as it was, so rod_detection still
+ * runs with the default scheduling when they are missing.
+ */
+
+#pragma once
+
+/* ******************************************************* Includes ****************************************************** */
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* ***************************************************** Public macros *************************************************** */
+
+#define ROD_REALTIME_MAX_CPUS 64  // CPU masks are 64-bit
+
+/* ************************************************** Public types definition ******************************************** */
+
+/**
+ * @brief Resource usage of the whole process since it started
+ */
+typedef struct {
+    uint64_t minor_faults;          // Page faults served without I/O (first touch of an allocation)
+    uint64_t major_faults;          // Page faults that needed I/O
+    uint64_t voluntary_switches;    // The process gave up the CPU (waiting)
+    uint64_t involuntary_switches;  // The process was preempted
+} RodRealtimeUsage;
+
+/* *********************************************** Public functions declarations ***************************************** */
+
+/**
+ * @brief Pin the calling thread and set its scheduling policy
+ * @param name Thread name, for messages
+ * @param cpu_mask Allowed CPUs (bit n = CPU n), 0 keeps the current affinity
+ * @param priority SCHED_FIFO priority (1-99), 0 keeps the current policy
+ * @return 0 on success, -1 if a setting was invalid or refused (the others are still applied)
+ *
+ * CPUs missing from the machine are ignored, a mask without any present CPU is refused.
+ */
+int rod_realtime_set_thread(const char* name, uint64_t cpu_mask, int priority);
+
+/**
+ * @brief Touch the first pages of the calling thread stack, so they are resident before locking
+ * @param size Bytes of stack to touch (must fit in the thread stack)
+ */
+void rod_realtime_prefault_stack(size_t size);
+
+/**
+ * @brief Pre-fault the heap, then lock all current and future pages of the process in memory
+ * @param heap_size Bytes allocated and touched once, then kept by malloc for later allocations
+ * @return 0 on success, -1 if the pages could not be locked (heap tuning is kept)
+ */
+int rod_realtime_lock_memory(size_t heap_size);
+
+/**
+ * @brief Sample the resource usage of the process
+ * @param usage Output usage
+ * @return 0 on success, -1 on failure (usage set to zero)
+ */
+int rod_realtime_get_usage(RodRealtimeUsage* usage);
@@ -0,0 +1,491 @@
+/**
+ * @file rod_session.c
+ * @brief Recorded session file: raw frames and their metadata in one indexed file
+ * @author Noé Game
+ * @date 14/10/2026
+ * @see rod_session.h
+ * @copyright Cecill-C (Cf. LICENCE.txt)
+ */
+
+/* ******************************************************* Includes ****************************************************** */
+
+#include "rod_session.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/* ***************************************************** Public macros *************************************************** */
+
+#define FILE_MAGIC "RODSESS"             // 8 bytes with the terminating zero
+#define INDEX_MAGIC "RODINDEX"           // 8 bytes, no terminating zero
+#define RECORD_MAGIC 0x454D5246u         // "FRME"
+#define MAGIC_SIZE 8
+
+#define HEADER_SIZE 64
+#define RECORD_HEADER_SIZE 80
+#define DETECTION_SIZE 16
+#define INDEX_HEADER_SIZE 16
+
+// File header fields
+#define HEADER_VERSION 8
+#define HEADER_HEADER_SIZE 12
+#define HEADER_FRAME_COUNT 16
+#define HEADER_INDEX_OFFSET 24
+
+// Record header fields
+#define RECORD_SIZE 4
+#define RECORD_SEQUENCE 8
+#define RECORD_WIDTH 12
+#define RECORD_HEIGHT 16
+#define RECORD_CHANNELS 20
+#define RECORD_TIMESTAMP 24
+#define RECORD_DETECTION_COUNT 32
+#define RECORD_DATA_OFFSET 36
+#define RECORD_CONTROLS 40
+
+#define WRITE_BUFFER_SIZE (1 << 20)      // stdio buffer of the writer
+#define INITIAL_CAPACITY 256             // Record offsets kept by writer and reader before growing
+
+/* ************************************************** Public types definition ******************************************** */
+
+struct RodSessionWriter {
+    FILE* file;
+    char* buffer;
+    uint64_t offset;           // End of the last record
+    uint64_t* offsets;         // Start of each record, for the index
+    int count;
+    int capacity;
+    bool failed;               // A write failed, the index no longer matches the file
+};
+
+struct RodSessionReader {
+    const uint8_t* map;
+    size_t size;
+    const uint8_t* index;      // Offsets from the file index (complete file)
+    uint64_t* offsets;         // Offsets found by walking the records (recovered file)
+    int count;
+    bool complete;
+};
+
+/* ********************************************* Function implementations *********************************************** */
+
+static void put_u32(uint8_t* p, uint32_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+static void put_u64(uint8_t* p, uint64_t v) {
+    put_u32(p, (uint32_t)v);
+    put_u32(p + 4, (uint32_t)(v >> 32));
+}
+
+static void put_f32(uint8_t* p, float v) {
+    uint32_t bits;
+    memcpy(&bits, &v, sizeof(bits));
+    put_u32(p, bits);
+}
+
+static uint32_t get_u32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint64_t get_u64(const uint8_t* p) {
+    return (uint64_t)get_u32(p) | ((uint64_t)get_u32(p + 4) << 32);
+}
+
+static float get_f32(const uint8_t* p) {
+    uint32_t bits = get_u32(p);
+    float v;
+    memcpy(&v, &bits, sizeof(v));
+    return v;
+}
+
+static size_t align_up(size_t size) {
+    return (size + ROD_SESSION_ALIGN - 1) & ~(size_t)(ROD_SESSION_ALIGN - 1);
+}
+
+/**
+ * @brief Offset of the pixels from the start of the record
+ */
+static size_t data_offset(int detection_count) {
+    return align_up(RECORD_HEADER_SIZE + (size_t)detection_count * DETECTION_SIZE);
+}
+
+static void encode_header(uint8_t* header, uint32_t frame_count, uint64_t index_offset) {
+    memset(header, 0, HEADER_SIZE);
+    memcpy(header, FILE_MAGIC, MAGIC_SIZE);
+    put_u32(header + HEADER_VERSION, ROD_SESSION_VERSION);
+    put_u32(header + HEADER_HEADER_SIZE, HEADER_SIZE);
+    put_u32(header + HEADER_FRAME_COUNT, frame_count);
+    put_u64(header + HEADER_INDEX_OFFSET, index_offset);
+}
+
+static int write_bytes(RodSessionWriter* writer, const void* data, size_t size) {
+    if (size > 0 && fwrite(data, 1, size, writer->file) != size) {
+        if (!writer->failed) {
+            fprintf(stderr, "rod_session: Write failed: %s\n", strerror(errno));
+        }
+        writer->failed = true;
+        return -1;
+    }
+    writer->offset += size;
+    return 0;
+}
+
+static int write_padding(RodSessionWriter* writer, size_t size) {
+    static const uint8_t zeros[ROD_SESSION_ALIGN];
+    return write_bytes(writer, zeros, size);
+}
+
+RodSessionWriter* rod_session_writer_create(const char* path) {
+    if (!path) return NULL;
+
+    RodSessionWriter* writer = calloc(1, sizeof(RodSessionWriter));
+    if (!writer) return NULL;
+
+    writer->file = fopen(path, "wb");
+    if (!writer->file) {
+        fprintf(stderr, "rod_session: Failed to create %s: %s\n", path, strerror(errno));
+        free(writer);
+        return NULL;
+    }
+
+    // Pixels are written in large blocks, a bigger buffer only helps the small metadata writes
+    writer->buffer = malloc(WRITE_BUFFER_SIZE);
+    if (writer->buffer) {
+        setvbuf(writer->file, writer->buffer, _IOFBF, WRITE_BUFFER_SIZE);
+    }
+
+    uint8_t header[HEADER_SIZE];
+    encode_header(header, 0, 0);
+    if (write_bytes(writer, header, sizeof(header)) != 0) {
+        rod_session_writer_close(writer);
+        return NULL;
+    }
+    return writer;
+}
+
+int rod_session_writer_append(RodSessionWriter* writer, const RodSessionFrame* frame) {
+    if (!writer || !frame || !frame->data || frame->width <= 0 || frame->height <= 0 ||
+        (frame->channels != 1 && frame->channels != 3)) {
+        return -1;
+    }
+    if (writer->failed) return -1;
+
+    size_t row_size = (size_t)frame->width * (size_t)frame->channels;
+    size_t stride = frame->stride ? frame->stride : row_size;
+    if (stride < row_size) return -1;
+
+    if (writer->count == writer->capacity) {
+        int capacity = writer->capacity ? writer->capacity * 2 : INITIAL_CAPACITY;
+        uint64_t* offsets = realloc(writer->offsets, (size_t)capacity * sizeof(uint64_t));
+        if (!offsets) return -1;
+        writer->offsets = offsets;
+        writer->capacity = capacity;
+    }
+
+    int detection_count = frame->detection_count;
+    if (detection_count < 0) detection_count = 0;
+    if (detection_count > ROD_SESSION_MAX_DETECTIONS) detection_count = ROD_SESSION_MAX_DETECTIONS;
+
+    size_t pixels_offset = data_offset(detection_count);
+    size_t data_size = row_size * (size_t)frame->height;
+    size_t record_size = align_up(pixels_offset + data_size);
+    if (record_size > UINT32_MAX) {
+        fprintf(stderr, "rod_session: Frame %dx%d too large\n", frame->width, frame->height);
+        return -1;
+    }
+
+    uint8_t header[RECORD_HEADER_SIZE];
+    memset(header, 0, sizeof(header));
+    put_u32(header, RECORD_MAGIC);
+    put_u32(header + RECORD_SIZE, (uint32_t)record_size);
+    put_u32(header + RECORD_SEQUENCE, frame->sequence);
+    put_u32(header + RECORD_WIDTH, (uint32_t)frame->width);
+    put_u32(header + RECORD_HEIGHT, (uint32_t)frame->height);
+    put_u32(header + RECORD_CHANNELS, (uint32_t)frame->channels);
+    put_u64(header + RECORD_TIMESTAMP, frame->timestamp_ns);
+    put_u32(header + RECORD_DETECTION_COUNT, (uint32_t)detection_count);
+    put_u32(header + RECORD_DATA_OFFSET, (uint32_t)pixels_offset);
+
+    const RodSessionControls* controls = &frame->controls;
+    uint8_t* p = header + RECORD_CONTROLS;
+    put_u32(p, (uint32_t)controls->exposure_time);
+    put_f32(p + 4, controls->analogue_gain);
+    put_f32(p + 8, controls->brightness);
+    put_f32(p + 12, controls->contrast);
+    put_f32(p + 16, controls->saturation);
+    put_f32(p + 20, controls->sharpness);
+    put_u32(p + 24, (uint32_t)controls->awb_enable);
+    put_u32(p + 28, (uint32_t)controls->aec_enable);
+    put_u32(p + 32, (uint32_t)controls->noise_reduction_mode);
+
+    uint64_t start = writer->offset;
+    if (write_bytes(writer, header, sizeof(header)) != 0) return -1;
+
+    for (int i = 0; i < detection_count; i++) {
+        const RodSessionDetection* detection = &frame->detections[i];
+        uint8_t record[DETECTION_SIZE];
+        put_u32(record, (uint32_t)detection->id);
+        put_f32(record + 4, detection->x);
+        put_f32(record + 8, detection->y);
+        put_f32(record + 12, detection->angle);
+        if (write_bytes(writer, record, sizeof(record)) != 0) return -1;
+    }
+    if (write_padding(writer, pixels_offset - RECORD_HEADER_SIZE - (size_t)detection_count * DETECTION_SIZE) != 0) {
+        return -1;
+    }
+
+    // Rows are stored packed, a padded source is written row by row
+    if (stride == row_size) {
+        if (write_bytes(writer, frame->data, data_size) != 0) return -1;
+    } else {
+        for (int y = 0; y < frame->height; y++) {
+            if (write_bytes(writer, frame->data + (size_t)y * stride, row_size) != 0) return -1;
+        }
+    }
+    if (write_padding(writer, record_size - pixels_offset - data_size) != 0) return -1;
+
+    writer->offsets[writer->count++] = start;
+    return 0;
+}
+
+int rod_session_writer_count(const RodSessionWriter* writer) {
+    return writer ? writer->count : 0;
+}
+
+int rod_session_writer_close(RodSessionWriter* writer) {
+    if (!writer) return 0;
+
+    int result = 0;
+    if (writer->failed) {
+        // Without an index the reader walks the records written before the failure
+        result = -1;
+    } else {
+        uint64_t index_offset = writer->offset;
+        uint8_t index_header[INDEX_HEADER_SIZE];
+        memset(index_header, 0, sizeof(index_header));
+        memcpy(index_header, INDEX_MAGIC, MAGIC_SIZE);
+        put_u32(index_header + 8, (uint32_t)writer->count);
+
+        if (write_bytes(writer, index_header, sizeof(index_header)) != 0) result = -1;
+        for (int i = 0; result == 0 && i < writer->count; i++) {
+            uint8_t entry[8];
+            put_u64(entry, writer->offsets[i]);
+            if (write_bytes(writer, entry, sizeof(entry)) != 0) result = -1;
+        }
+
+        // Count and index offset go in last, so a file cut short never points at a missing index
+        uint8_t header[HEADER_SIZE];
+        encode_header(header, (uint32_t)writer->count, index_offset);
+        if (result == 0 && (fflush(writer->file) != 0 || fseek(writer->file, 0, SEEK_SET) != 0 ||
+                            fwrite(header, 1, sizeof(header), writer->file) != sizeof(header))) {
+            fprintf(stderr, "rod_session: Failed to write the index: %s\n", strerror(errno));
+            result = -1;
+        }
+    }
+
+    if (fflush(writer->file) != 0 || fsync(fileno(writer->file)) != 0) result = -1;
+    if (fclose(writer->file) != 0) result = -1;
+    free(writer->buffer);
+    free(writer->offsets);
+    free(writer);
+    return result;
+}
+
+bool rod_session_is_file(const char* path) {
+    if (!path) return false;
+    FILE* file = fopen(path, "rb");
+    if (!file) return false;
+    uint8_t magic[MAGIC_SIZE];
+    bool is_session = fread(magic, 1, sizeof(magic), file) == sizeof(magic) &&
+                      memcmp(magic, FILE_MAGIC, MAGIC_SIZE) == 0;
+    fclose(file);
+    return is_session;
+}
+
+/**
+ * @brief Check that a whole record lies in the file and holds a consistent frame
+ * @return Record size, or 0 for an invalid or truncated record
+ */
+static size_t check_record(const RodSessionReader* reader, uint64_t offset) {
+    if (offset < HEADER_SIZE || offset % ROD_SESSION_ALIGN != 0 || offset > reader->size ||
+        reader->size - offset < RECORD_HEADER_SIZE) {
+        return 0;
+    }
+    const uint8_t* record = reader->map + offset;
+    if (get_u32(record) != RECORD_MAGIC) return 0;
+
+    uint64_t record_size = get_u32(record + RECORD_SIZE);
+    uint64_t width = get_u32(record + RECORD_WIDTH);
+    uint64_t height = get_u32(record + RECORD_HEIGHT);
+    uint32_t channels = get_u32(record + RECORD_CHANNELS);
+    uint32_t detection_count = get_u32(record + RECORD_DETECTION_COUNT);
+    uint64_t pixels_offset = get_u32(record + RECORD_DATA_OFFSET);
+
+    if (width == 0 || height == 0 || width > INT32_MAX || height > INT32_MAX || (channels != 1 && channels != 3) ||
+        detection_count > ROD_SESSION_MAX_DETECTIONS || pixels_offset % ROD_SESSION_ALIGN != 0 ||
+        pixels_offset < RECORD_HEADER_SIZE + (uint64_t)detection_count * DETECTION_SIZE ||
+        record_size % ROD_SESSION_ALIGN != 0 || record_size > reader->size - offset) {
+        return 0;
+    }
+    if (pixels_offset > record_size || width * height * channels > record_size - pixels_offset) return 0;
+    return (size_t)record_size;
+}
+
+/**
+ * @brief Use the index written on close
+ * @return 0 if the index is present and every entry is a valid record
+ */
+static int load_index(RodSessionReader* reader) {
+    uint32_t frame_count = get_u32(reader->map + HEADER_FRAME_COUNT);
+    uint64_t index_offset = get_u64(reader->map + HEADER_INDEX_OFFSET);
+    if (index_offset == 0 || index_offset % 8 != 0 || index_offset > reader->size ||
+        reader->size - index_offset < INDEX_HEADER_SIZE + (uint64_t)frame_count * 8) {
+        return -1;
+    }
+
+    const uint8_t* index = reader->map + index_offset;
+    if (memcmp(index, INDEX_MAGIC, MAGIC_SIZE) != 0 || get_u32(index + 8) != frame_count || frame_count > INT32_MAX) {
+        return -1;
+    }
+
+    const uint8_t* offsets = index + INDEX_HEADER_SIZE;
+    for (uint32_t i = 0; i < frame_count; i++) {
+        if (check_record(reader, get_u64(offsets + (size_t)i * 8)) == 0) return -1;
+    }
+    reader->index = offsets;
+    reader->count = (int)frame_count;
+    reader->complete = true;
+    return 0;
+}
+
+/**
+ * @brief Find the records of a session that was not closed, up to the first invalid one
+ */
+static int scan_records(RodSessionReader* reader) {
+    int capacity = 0;
+    uint64_t offset = HEADER_SIZE;
+    size_t record_size;
+    while ((record_size = check_record(reader, offset)) != 0) {
+        if (reader->count == capacity) {
+            capacity = capacity ? capacity * 2 : INITIAL_CAPACITY;
+            uint64_t* offsets = realloc(reader->offsets, (size_t)capacity * sizeof(uint64_t));
+            if (!offsets) return -1;
+            reader->offsets = offsets;
+        }
+        reader->offsets[reader->count++] = offset;
+        offset += record_size;
+    }
+    return 0;
+}
+
+RodSessionReader* rod_session_reader_open(const char* path) {
+    if (!path) return NULL;
+
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        fprintf(stderr, "rod_session: Failed to open %s: %s\n", path, strerror(errno));
+        return NULL;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size < HEADER_SIZE) {
+        fprintf(stderr, "rod_session: %s is not a session file\n", path);
+        close(fd);
+        return NULL;
+    }
+
+    void* map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        fprintf(stderr, "rod_session: Failed to map %s: %s\n", path, strerror(errno));
+        return NULL;
+    }
+
+    RodSessionReader* reader = calloc(1, sizeof(RodSessionReader));
+    if (!reader) {
+        munmap(map, (size_t)st.st_size);
+        return NULL;
+    }
+    reader->map = map;
+    reader->size = (size_t)st.st_size;
+
+    if (memcmp(reader->map, FILE_MAGIC, MAGIC_SIZE) != 0 ||
+        get_u32(reader->map + HEADER_VERSION) != ROD_SESSION_VERSION ||
+        get_u32(reader->map + HEADER_HEADER_SIZE) != HEADER_SIZE) {
+        fprintf(stderr, "rod_session: %s is not a version %d session file\n", path, ROD_SESSION_VERSION);
+        rod_session_reader_close(reader);
+        return NULL;
+    }
+
+    if (load_index(reader) != 0) {
+        if (scan_records(reader) != 0) {
+            rod_session_reader_close(reader);
+            return NULL;
+        }
+        fprintf(stderr, "rod_session: %s was not closed, %d frames recovered\n", path, reader->count);
+    }
+
+    // Replay mostly reads frames in order
+    madvise((void*)reader->map, reader->size, MADV_SEQUENTIAL);
+    return reader;
+}
+
+int rod_session_reader_count(const RodSessionReader* reader) {
+    return reader ? reader->count : 0;
+}
+
+bool rod_session_reader_is_complete(const RodSessionReader* reader) {
+    return reader && reader->complete;
+}
+
+int rod_session_reader_get(const RodSessionReader* reader, int index, RodSessionFrame* frame) {
+    if (!reader || !frame || index < 0 || index >= reader->count) return -1;
+
+    uint64_t offset = reader->index ? get_u64(reader->index + (size_t)index * 8) : reader->offsets[index];
+    const uint8_t* record = reader->map + offset;
+
+    frame->sequence = get_u32(record + RECORD_SEQUENCE);
+    frame->timestamp_ns = get_u64(record + RECORD_TIMESTAMP);
+    frame->width = (int)get_u32(record + RECORD_WIDTH);
+    frame->height = (int)get_u32(record + RECORD_HEIGHT);
+    frame->channels = (int)get_u32(record + RECORD_CHANNELS);
+    frame->stride = (size_t)frame->width * (size_t)frame->channels;
+    frame->data = record + get_u32(record + RECORD_DATA_OFFSET);
+
+    const uint8_t* p = record + RECORD_CONTROLS;
+    frame->controls.exposure_time = (int)get_u32(p);
+    frame->controls.analogue_gain = get_f32(p + 4);
+    frame->controls.brightness = get_f32(p + 8);
+    frame->controls.contrast = get_f32(p + 12);
+    frame->controls.saturation = get_f32(p + 16);
+    frame->controls.sharpness = get_f32(p + 20);
+    frame->controls.awb_enable = (int)get_u32(p + 24);
+    frame->controls.aec_enable = (int)get_u32(p + 28);
+    frame->controls.noise_reduction_mode = (int)get_u32(p + 32);
+
+    frame->detection_count = (int)get_u32(record + RECORD_DETECTION_COUNT);
+    const uint8_t* detection = record + RECORD_HEADER_SIZE;
+    for (int i = 0; i < frame->detection_count; i++, detection += DETECTION_SIZE) {
+        frame->detections[i].id = (int)get_u32(detection);
+        frame->detections[i].x = get_f32(detection + 4);
+        frame->detections[i].y = get_f32(detection + 8);
+        frame->detections[i].angle = get_f32(detection + 12);
+    }
+    return 0;
+}
+
+void rod_session_reader_close(RodSessionReader* reader) {
+    if (!reader) return;
+    munmap((void*)reader->map, reader->size);
+    free(reader->offsets);
+    free(reader);
+}
@@ -0,0 +1,172 @@
+/**
+ * @file rod_session.h
+ * @brief Recorded session file: raw frames and their metadata in one indexed file
+ * @author Noé Game
+ * @date 14/10/2026
+ * @see rod_session.c
+ * @copyright Cecill-C (Cf. LICENCE.txt)
+ *
+ * rod_detection --record appends every recorded frame to a single file instead
+ * of encoding JPEGs: the raw pixels (luma plane, or BGR) written as they are,
+ * with the capture timestamp, the camera controls in force and the published
+ * detections. The emulated camera replays such a file through an mmap: frames
+ * are read in place, without any decoding, in the recorded order or at random.
+ *
+ * File layout (little-endian):
+ *     header          64 bytes   magic "RODSESS", version, frame count, index offset
+ *     frame records   each one starts on a ROD_SESSION_ALIGN boundary
+ *         record header        80 bytes   size, sequence, dimensions, timestamp, controls
+ *         detections           16 bytes each
+ *         pixels               rows of width * channels bytes, ROD_SESSION_ALIGN aligned
+ *     index           "RODINDEX", count, offset of each record (written on close)
+ *
+ * The frame count and index are written when the writer is closed. A file left
+ * without them (crash, power loss) is still readable: the reader walks the
+ * records and drops a truncated last one.
+ */
+
+#pragma once
+
+/* ******************************************************* Includes ****************************************************** */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ***************************************************** Public macros *************************************************** */
+
+#define ROD_SESSION_VERSION 1
+#define ROD_SESSION_ALIGN 64             // Record and pixel alignment in the file (cache line)
+#define ROD_SESSION_MAX_DETECTIONS 128   // Detections stored per frame
+
+/* ************************************************** Public types definition ******************************************** */
+
+/**
+ * @brief Opaque session writer (recording)
+ */
+typedef struct RodSessionWriter RodSessionWriter;
+
+/**
+ * @brief Opaque session reader (replay)
+ */
+typedef struct RodSessionReader RodSessionReader;
+
+/**
+ * @brief Camera controls in force when the frame was captured (-1 = auto / default)
+ */
+typedef struct {
+    int exposure_time;         // Microseconds
+    float analogue_gain;
+    float brightness;
+    float contrast;
+    float saturation;
+    float sharpness;
+    int awb_enable;
+    int aec_enable;
+    int noise_reduction_mode;
+} RodSessionControls;
+
+/**
+ * @brief Detection published for the frame
+ */
+typedef struct {
+    int id;
+    float x;       // Playground coordinates (mm)
+    float y;
+    float angle;   // Radians
+} RodSessionDetection;
+
+/**
+ * @brief One recorded frame
+ */
+typedef struct {
+    uint32_t sequence;          // Sensor frame number
+    uint64_t timestamp_ns;      // Capture time (CLOCK_MONOTONIC)
+    int width;
+    int height;
+    int channels;               // 1 = luma plane, 3 = BGR
+    size_t stride;              // Bytes between rows of data
+    const uint8_t* data;        // Pixels (reader: points into the mapping, valid until the reader is closed)
+    RodSessionControls controls;
+    int detection_count;
+    RodSessionDetection detections[ROD_SESSION_MAX_DETECTIONS];
+} RodSessionFrame;
+
+/* *********************************************** Public functions declarations ***************************************** */
+
+/**
+ * @brief Create a session file (replaces an existing file)
+ * @param path File path
+ * @return Writer, or NULL on failure
+ */
+RodSessionWriter* rod_session_writer_create(const char* path);
+
+/**
+ * @brief Append a frame to the session
+ * @param writer Writer
+ * @param frame Frame to append (detections beyond ROD_SESSION_MAX_DETECTIONS are dropped)
+ * @return 0 on success, -1 on failure (the file keeps the frames appended before)
+ *
+ * Not thread-safe: call it from a single thread (rod_writer worker).
+ */
+int rod_session_writer_append(RodSessionWriter* writer, const RodSessionFrame* frame);
+
+/**
+ * @brief Number of frames appended so far
+ */
+int rod_session_writer_count(const RodSessionWriter* writer);
+
+/**
+ * @brief Write the index, flush the file to disk and destroy the writer
+ * @param writer Writer (NULL is ignored)
+ * @return 0 on success, -1 if the index could not be written (frames stay readable)
+ */
+int rod_session_writer_close(RodSessionWriter* writer);
+
+/**
+ * @brief Check whether a file starts with a session header
+ * @param path File path
+ * @return true for a session file
+ */
+bool rod_session_is_file(const char* path);
+
+/**
+ * @brief Map a session file for replay
+ * @param path File path
+ * @return Reader, or NULL if the file is not a readable session
+ */
+RodSessionReader* rod_session_reader_open(const char* path);
+
+/**
+ * @brief Number of frames in the session
+ */
+int rod_session_reader_count(const RodSessionReader* reader);
+
+/**
+ * @brief Whether the session was closed properly (index present)
+ * @return false for a file recovered by walking its records
+ */
+bool rod_session_reader_is_complete(const RodSessionReader* reader);
+
+/**
+ * @brief Read a frame (O(1), no copy of the pixels)
+ * @param reader Reader
+ * @param index Frame index, 0 to count - 1
+ * @param frame Output frame, data points into the mapping
+ * @return 0 on success, -1 if index is out of range
+ */
+int rod_session_reader_get(const RodSessionReader* reader, int index, RodSessionFrame* frame);
+
+/**
+ * @brief Unmap the session and destroy the reader (frame data becomes invalid)
+ * @param reader Reader (NULL is ignored)
+ */
+void rod_session_reader_close(RodSessionReader* reader);
+
+#ifdef __cplusplus
+}
+#endif
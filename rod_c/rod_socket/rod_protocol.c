@@ -0,0 +1,191 @@
+/**
+ * @file rod_protocol.c
+ * @brief Binary framed message format between rod_detection and its clients
+ * @author Noé Game
+ * @date 14/10/2026
+ * @see rod_protocol.h
+ * @copyright Cecill-C (Cf. LICENCE.txt)
+ */
+
+/* ******************************************************* Includes ****************************************************** */
+
+#include "rod_protocol.h"
+#include <string.h>
+
+/* ***************************************************** Public macros *************************************************** */
+
+// Bytes covered by the length field in an empty message
+#define LENGTH_BASE (ROD_PROTOCOL_HEADER_SIZE - 4)
+
+/* ************************************************** Public types definition ******************************************** */
+
+/* *********************************************** Public functions declarations ***************************************** */
+
+/* ******************************************* Public callback functions declarations ************************************ */
+
+/* ********************************************* Function implementations *********************************************** */
+
+static void put_u16(uint8_t* p, uint16_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void put_u32(uint8_t* p, uint32_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+static void put_u64(uint8_t* p, uint64_t v) {
+    put_u32(p, (uint32_t)v);
+    put_u32(p + 4, (uint32_t)(v >> 32));
+}
+
+static void put_f32(uint8_t* p, float v) {
+    uint32_t bits;
+    memcpy(&bits, &v, sizeof(bits));
+    put_u32(p, bits);
+}
+
+static uint16_t get_u16(const uint8_t* p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t get_u32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint64_t get_u64(const uint8_t* p) {
+    return (uint64_t)get_u32(p) | ((uint64_t)get_u32(p + 4) << 32);
+}
+
+static float get_f32(const uint8_t* p) {
+    uint32_t bits = get_u32(p);
+    float v;
+    memcpy(&v, &bits, sizeof(v));
+    return v;
+}
+
+size_t rod_protocol_encode_header(uint8_t* buffer, uint32_t sequence, uint64_t timestamp_us,
+                                  const RodProtocolTimings* timings, uint32_t flags, int count) {
+    if (!buffer || count < 0 || count > ROD_PROTOCOL_MAX_MARKERS) return 0;
+    
+    put_u32(buffer, (uint32_t)(LENGTH_BASE + count * ROD_PROTOCOL_RECORD_SIZE));
+    put_u16(buffer + 4, ROD_PROTOCOL_MAGIC);
+    buffer[6] = ROD_PROTOCOL_VERSION;
+    buffer[7] = ROD_PROTOCOL_MSG_DETECTIONS;
+    put_u32(buffer + 8, sequence);
+    put_u64(buffer + 12, timestamp_us);
+    put_u16(buffer + 20, (uint16_t)count);
+    put_u16(buffer + 22, ROD_PROTOCOL_RECORD_SIZE);
+    put_u32(buffer + 24, timings ? timings->acquired_us : 0);
+    put_u32(buffer + 28, timings ? timings->detected_us : 0);
+    put_u32(buffer + 32, timings ? timings->published_us : 0);
+    put_u32(buffer + 36, flags);
+    return ROD_PROTOCOL_HEADER_SIZE;
+}
+
+size_t rod_protocol_encode_marker(uint8_t* buffer, int id, float x, float y, float angle, uint32_t age_us) {
+    put_u32(buffer, (uint32_t)(int32_t)id);
+    put_f32(buffer + 4, x);
+    put_f32(buffer + 8, y);
+    put_f32(buffer + 12, angle);
+    put_u32(buffer + 16, age_us);
+    return ROD_PROTOCOL_RECORD_SIZE;
+}
+
+void rod_protocol_decoder_init(RodProtocolDecoder* decoder) {
+    decoder->start = 0;
+    decoder->end = 0;
+    decoder->discarded = 0;
+}
+
+uint8_t* rod_protocol_decoder_write_ptr(RodProtocolDecoder* decoder, size_t* available) {
+    // Move the pending bytes to the front when the tail is getting short
+    if (decoder->start > 0 && decoder->end + ROD_PROTOCOL_MAX_MESSAGE_SIZE > ROD_PROTOCOL_DECODER_CAPACITY) {
+        memmove(decoder->buffer, decoder->buffer + decoder->start, decoder->end - decoder->start);
+        decoder->end -= decoder->start;
+        decoder->start = 0;
+    }
+    *available = ROD_PROTOCOL_DECODER_CAPACITY - decoder->end;
+    return decoder->buffer + decoder->end;
+}
+
+void rod_protocol_decoder_commit(RodProtocolDecoder* decoder, size_t length) {
+    decoder->end += length;
+    if (decoder->end > ROD_PROTOCOL_DECODER_CAPACITY) {
+        decoder->end = ROD_PROTOCOL_DECODER_CAPACITY;
+    }
+}
+
+size_t rod_protocol_decoder_feed(RodProtocolDecoder* decoder, const uint8_t* data, size_t length) {
+    size_t available;
+    uint8_t* dst = rod_protocol_decoder_write_ptr(decoder, &available);
+    if (length > available) length = available;
+    memcpy(dst, data, length);
+    rod_protocol_decoder_commit(decoder, length);
+    return length;
+}
+
+/**
+ * @brief Check a complete header, return the message size or 0 if invalid
+ */
+static size_t validate_header(const uint8_t* p) {
+    uint32_t length = get_u32(p);
+    uint16_t count = get_u16(p + 20);
+    
+    if (get_u16(p + 4) != ROD_PROTOCOL_MAGIC ||
+        p[6] != ROD_PROTOCOL_VERSION ||
+        p[7] != ROD_PROTOCOL_MSG_DETECTIONS ||
+        get_u16(p + 22) != ROD_PROTOCOL_RECORD_SIZE ||
+        count > ROD_PROTOCOL_MAX_MARKERS ||
+        length != LENGTH_BASE + (uint32_t)count * ROD_PROTOCOL_RECORD_SIZE) {
+        return 0;
+    }
+    return ROD_PROTOCOL_MESSAGE_SIZE(count);
+}
+
+int rod_protocol_decoder_next(RodProtocolDecoder* decoder, RodProtocolMessage* message) {
+    size_t pending = decoder->end - decoder->start;
+    if (pending < ROD_PROTOCOL_HEADER_SIZE) return 0;
+    
+    const uint8_t* p = decoder->buffer + decoder->start;
+    size_t size = validate_header(p);
+    if (size == 0) {
+        // Resynchronize: skip to the next byte that could start a header
+        size_t skip = 1;
+        while (skip + 7 <= pending &&
+               !(get_u16(p + skip + 4) == ROD_PROTOCOL_MAGIC && p[skip + 6] == ROD_PROTOCOL_VERSION)) {
+            skip++;
+        }
+        decoder->start += skip;
+        decoder->discarded += skip;
+        return -1;
+    }
+    if (pending < size) return 0;
+    
+    message->sequence = get_u32(p + 8);
+    message->timestamp_us = get_u64(p + 12);
+    message->count = get_u16(p + 20);
+    message->timings.acquired_us = get_u32(p + 24);
+    message->timings.detected_us = get_u32(p + 28);
+    message->timings.published_us = get_u32(p + 32);
+    message->flags = get_u32(p + 36);
+    
+    const uint8_t* record = p + ROD_PROTOCOL_HEADER_SIZE;
+    for (int i = 0; i < message->count; i++, record += ROD_PROTOCOL_RECORD_SIZE) {
+        message->markers[i].id = (int32_t)get_u32(record);
+        message->markers[i].x = get_f32(record + 4);
+        message->markers[i].y = get_f32(record + 8);
+        message->markers[i].angle = get_f32(record + 12);
+        message->markers[i].age_us = get_u32(record + 16);
+    }
+    
+    decoder->start += size;
+    if (decoder->start == decoder->end) {
+        decoder->start = 0;
+        decoder->end = 0;
+    }
+    return 1;
+}
@@ -0,0 +1,193 @@
+/**
+ * @file rod_protocol.h
+ * @brief Binary framed message format between rod_detection and its clients
+ * @author Noé Game
+ * @date 14/10/2026
+ * @see rod_protocol.c
+ * @copyright Cecill-C (Cf. LICENCE.txt)
+ * 
+ * Every message is length prefixed, so a stream reader always knows where a
+ * message ends whatever the way recv() splits it. All fields are little-endian.
+ * 
+ *   offset  size  field
+ *   0       4     length        Bytes following this field (36 + count * record_size)
+ *   4       2     magic         ROD_PROTOCOL_MAGIC
+ *   6       1     version       ROD_PROTOCOL_VERSION
+ *   7       1     type          RodProtocolMessageType
+ *   8       4     sequence      Camera frame sequence number (gaps = frames not published)
+ *   12      8     timestamp_us  Sensor timestamp (microseconds, CLOCK_MONOTONIC)
+ *   20      2     count         Number of marker records
+ *   22      2     record_size   Bytes per marker record (ROD_PROTOCOL_RECORD_SIZE)
+ *   24      4     acquired_us   Frame received from the camera   \
+ *   28      4     detected_us   Markers detected                  > microseconds after timestamp_us
+ *   32      4     published_us  Message sent                      /
+ *   36      4     flags         ROD_PROTOCOL_FLAG_* bits
+ *   40      ...   records       count x { int32 id, float x, float y, float angle, uint32 age_us }
+ * 
+ * age_us is the time since the marker was last measured: 0 for a marker seen in
+ * this frame, > 0 for a position predicted by the marker filter (rod_marker_filter.h).
+ * 
+ * flags tells how the frame was processed (rod_motion_gate.h): without any flag
+ * the whole frame was searched. ROD_PROTOCOL_FLAG_ROI_ONLY: only the regions
+ * around the known markers were searched. ROD_PROTOCOL_FLAG_CARRIED_OVER: the
+ * scene was static, nothing was detected and the records are the previous ones,
+ * their age_us grown by the time elapsed since.
+ * 
+ * Both processes run on the same machine: a client compares timestamp_us with its own
+ * CLOCK_MONOTONIC on reception to get the full capture to receive latency.
+ * 
+ * Encoding and decoding never allocate: the caller owns every buffer.
+ * This module has no OpenCV dependency so that clients only link rod_protocol.
+ */
+
+#pragma once
+
+/* ******************************************************* Includes ****************************************************** */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ***************************************************** Public macros *************************************************** */
+
+#define ROD_PROTOCOL_MAGIC 0x4452          // "RD" on the wire
+#define ROD_PROTOCOL_VERSION 4            // 2: stage timings in the header, 3: marker age, 4: flags
+#define ROD_PROTOCOL_HEADER_SIZE 40
+#define ROD_PROTOCOL_RECORD_SIZE 20
+#define ROD_PROTOCOL_MAX_MARKERS 128       // Upper bound of markers per message
+
+// Header flags
+#define ROD_PROTOCOL_FLAG_ROI_ONLY 0x1u      // Detection limited to the regions of known markers
+#define ROD_PROTOCOL_FLAG_CARRIED_OVER 0x2u  // Not detected: previous markers carried over a static frame
+
+// Size in bytes of a message carrying count markers
+#define ROD_PROTOCOL_MESSAGE_SIZE(count) (ROD_PROTOCOL_HEADER_SIZE + (size_t)(count) * ROD_PROTOCOL_RECORD_SIZE)
+#define ROD_PROTOCOL_MAX_MESSAGE_SIZE ROD_PROTOCOL_MESSAGE_SIZE(ROD_PROTOCOL_MAX_MARKERS)
+
+// Decoder stream buffer: room for one full message plus the start of the next
+#define ROD_PROTOCOL_DECODER_CAPACITY (2 * ROD_PROTOCOL_MAX_MESSAGE_SIZE)
+
+/* ************************************************** Public types definition ******************************************** */
+
+/**
+ * @brief Message types
+ */
+typedef enum {
+    ROD_PROTOCOL_MSG_DETECTIONS = 1  // Markers detected in one frame
+} RodProtocolMessageType;
+
+/**
+ * @brief One marker record (playground coordinates)
+ */
+typedef struct {
+    int32_t id;
+    float x;        // mm
+    float y;        // mm
+    float angle;    // radians
+    uint32_t age_us; // Time since last measured (0 = this frame)
+} RodProtocolMarker;
+
+/**
+ * @brief Pipeline stage timestamps of a frame (microseconds after the sensor timestamp)
+ */
+typedef struct {
+    uint32_t acquired_us;   // Frame received from the camera
+    uint32_t detected_us;   // Markers detected
+    uint32_t published_us;  // Message sent
+} RodProtocolTimings;
+
+/**
+ * @brief Decoded detections message
+ */
+typedef struct {
+    uint32_t sequence;
+    uint64_t timestamp_us;
+    RodProtocolTimings timings;
+    uint32_t flags;         // ROD_PROTOCOL_FLAG_* bits
+    int count;
+    RodProtocolMarker markers[ROD_PROTOCOL_MAX_MARKERS];
+} RodProtocolMessage;
+
+/**
+ * @brief Stream decoder (caller allocated, see rod_protocol_decoder_init())
+ * 
+ * Bytes are received straight into the decoder buffer
+ * (rod_protocol_decoder_write_ptr() / rod_protocol_decoder_commit()), then
+ * complete messages are extracted with rod_protocol_decoder_next().
+ */
+typedef struct {
+    uint8_t buffer[ROD_PROTOCOL_DECODER_CAPACITY];
+    size_t start;           // First unread byte
+    size_t end;             // One past the last received byte
+    unsigned long discarded; // Bytes dropped while resynchronizing
+} RodProtocolDecoder;
+
+/* *********************************************** Public functions declarations ***************************************** */
+
+/**
+ * @brief Write a detections message header
+ * @param buffer Output buffer (at least ROD_PROTOCOL_HEADER_SIZE bytes)
+ * @param sequence Frame sequence number
+ * @param timestamp_us Sensor timestamp in microseconds
+ * @param timings Stage timestamps (NULL = all zero)
+ * @param flags ROD_PROTOCOL_FLAG_* bits
+ * @param count Number of marker records that will follow (<= ROD_PROTOCOL_MAX_MARKERS)
+ * @return Number of bytes written (ROD_PROTOCOL_HEADER_SIZE), 0 if count is out of range
+ */
+size_t rod_protocol_encode_header(uint8_t* buffer, uint32_t sequence, uint64_t timestamp_us,
+                                  const RodProtocolTimings* timings, uint32_t flags, int count);
+
+/**
+ * @brief Write one marker record
+ * @param buffer Output buffer (at least ROD_PROTOCOL_RECORD_SIZE bytes)
+ * @return Number of bytes written (ROD_PROTOCOL_RECORD_SIZE)
+ */
+size_t rod_protocol_encode_marker(uint8_t* buffer, int id, float x, float y, float angle, uint32_t age_us);
+
+/**
+ * @brief Reset a stream decoder
+ * @param decoder Decoder
+ */
+void rod_protocol_decoder_init(RodProtocolDecoder* decoder);
+
+/**
+ * @brief Get the free space where the next received bytes must be written
+ * @param decoder Decoder
+ * @param available Output number of writable bytes (> 0 as long as rod_protocol_decoder_next()
+ *                  is called until it returns 0 after each commit)
+ * @return Write pointer inside the decoder buffer
+ */
+uint8_t* rod_protocol_decoder_write_ptr(RodProtocolDecoder* decoder, size_t* available);
+
+/**
+ * @brief Record bytes written at rod_protocol_decoder_write_ptr()
+ * @param decoder Decoder
+ * @param length Number of bytes received
+ */
+void rod_protocol_decoder_commit(RodProtocolDecoder* decoder, size_t length);
+
+/**
+ * @brief Copy received bytes into the decoder (when they were not received in place)
+ * @param decoder Decoder
+ * @param data Received bytes
+ * @param length Number of bytes
+ * @return Number of bytes consumed (may be less than length if the buffer is full)
+ */
+size_t rod_protocol_decoder_feed(RodProtocolDecoder* decoder, const uint8_t* data, size_t length);
+
+/**
+ * @brief Extract the next complete message
+ * @param decoder Decoder
+ * @param message Output message
+ * @return 1 if a message was decoded, 0 if more bytes are needed,
+ *         -1 if invalid bytes were skipped (call again to continue)
+ */
+int rod_protocol_decoder_next(RodProtocolDecoder* decoder, RodProtocolMessage* message);
+
+#ifdef __cplusplus
+}
+#endif
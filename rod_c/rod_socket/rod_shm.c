@@ -0,0 +1,326 @@
+/**
+ * @file rod_shm.c
+ * @brief Shared memory publication of detection snapshots for ROD
+ * @author Noé Game
+ * @date 14/10/2026
+ * @see rod_shm.h
+ * @copyright Cecill-C (Cf. LICENCE.txt)
+ */
+
+#define _GNU_SOURCE  // Required for syscall
+
+/* ******************************************************* Includes ****************************************************** */
+
+#include "rod_shm.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <stdatomic.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+/* ***************************************************** Public macros *************************************************** */
+
+#define SHM_MAGIC 0x524F4453u   // "RODS"
+#define SHM_VERSION 4             // 2: stage timings in RodProtocolMessage, 3: marker age, 4: flags
+
+/* ************************************************** Public types definition ******************************************** */
+
+/**
+ * @brief One ring slot guarded by a seqlock (odd sequence = write in progress)
+ */
+typedef struct {
+    _Atomic uint32_t sequence;
+    uint32_t reserved;
+    RodProtocolMessage message;
+} ShmSlot;
+
+/**
+ * @brief Shared memory layout
+ */
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t slot_count;
+    uint32_t slot_size;
+    _Atomic uint32_t open;          // 1 while the publisher runs, 0 once closed
+    _Atomic uint32_t futex_word;    // Incremented at each publication
+    _Atomic uint32_t waiters;       // Readers sleeping on futex_word
+    uint32_t reserved;
+    _Atomic uint64_t published;     // Number of snapshots published (slot = index % slot_count)
+    ShmSlot slots[ROD_SHM_SLOTS];
+} ShmRegion;
+
+struct RodShmPublisher {
+    ShmRegion* region;
+    char* name;
+    uint64_t next_index;    // Index of the slot being filled
+};
+
+struct RodShmReader {
+    ShmRegion* region;
+    uint64_t next_index;    // Index of the next snapshot to read
+    uint32_t futex_seen;    // futex_word value when the last snapshot was read
+};
+
+/* *********************************************** Public functions declarations ***************************************** */
+
+/* ******************************************* Public callback functions declarations ************************************ */
+
+/* ********************************************* Function implementations *********************************************** */
+
+static long futex(_Atomic uint32_t* word, int op, uint32_t value, const struct timespec* timeout) {
+    return syscall(SYS_futex, (uint32_t*)word, op, value, timeout, NULL, 0);
+}
+
+RodShmPublisher* rod_shm_publisher_create(const char* name) {
+    if (!name) {
+        fprintf(stderr, "rod_shm: name is NULL\n");
+        return NULL;
+    }
+    
+    RodShmPublisher* publisher = (RodShmPublisher*)calloc(1, sizeof(RodShmPublisher));
+    if (!publisher) {
+        fprintf(stderr, "rod_shm: Failed to allocate publisher\n");
+        return NULL;
+    }
+    publisher->name = strdup(name);
+    if (!publisher->name) {
+        free(publisher);
+        return NULL;
+    }
+    
+    // Start from a fresh object: readers of a previous run see it closed
+    shm_unlink(name);
+    int fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0666);
+    if (fd < 0) {
+        fprintf(stderr, "rod_shm: Failed to create %s: %s\n", name, strerror(errno));
+        free(publisher->name);
+        free(publisher);
+        return NULL;
+    }
+    
+    if (ftruncate(fd, sizeof(ShmRegion)) != 0) {
+        fprintf(stderr, "rod_shm: Failed to size %s: %s\n", name, strerror(errno));
+        close(fd);
+        shm_unlink(name);
+        free(publisher->name);
+        free(publisher);
+        return NULL;
+    }
+    
+    void* map = mmap(NULL, sizeof(ShmRegion), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        fprintf(stderr, "rod_shm: Failed to map %s: %s\n", name, strerror(errno));
+        shm_unlink(name);
+        free(publisher->name);
+        free(publisher);
+        return NULL;
+    }
+    
+    // ftruncate zero-fills, only the header needs to be set
+    publisher->region = (ShmRegion*)map;
+    publisher->region->magic = SHM_MAGIC;
+    publisher->region->version = SHM_VERSION;
+    publisher->region->slot_count = ROD_SHM_SLOTS;
+    publisher->region->slot_size = sizeof(ShmSlot);
+    atomic_store(&publisher->region->open, 1);
+    
+    printf("rod_shm: Publishing detections on %s\n", name);
+    return publisher;
+}
+
+void rod_shm_publisher_destroy(RodShmPublisher* publisher) {
+    if (!publisher) return;
+    
+    if (publisher->region) {
+        // Wake sleeping readers so they notice the ring is closed
+        atomic_store(&publisher->region->open, 0);
+        atomic_fetch_add(&publisher->region->futex_word, 1);
+        futex(&publisher->region->futex_word, FUTEX_WAKE, INT32_MAX, NULL);
+        munmap(publisher->region, sizeof(ShmRegion));
+    }
+    if (publisher->name) {
+        shm_unlink(publisher->name);
+        free(publisher->name);
+    }
+    free(publisher);
+}
+
+RodProtocolMessage* rod_shm_publisher_begin(RodShmPublisher* publisher) {
+    ShmSlot* slot = &publisher->region->slots[publisher->next_index % ROD_SHM_SLOTS];
+    
+    // Odd sequence: readers of this slot retry until the commit
+    uint32_t sequence = atomic_load_explicit(&slot->sequence, memory_order_relaxed);
+    atomic_store_explicit(&slot->sequence, sequence + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    return &slot->message;
+}
+
+void rod_shm_publisher_commit(RodShmPublisher* publisher) {
+    ShmRegion* region = publisher->region;
+    ShmSlot* slot = &region->slots[publisher->next_index % ROD_SHM_SLOTS];
+    
+    uint32_t sequence = atomic_load_explicit(&slot->sequence, memory_order_relaxed);
+    atomic_store_explicit(&slot->sequence, sequence + 1, memory_order_release);
+    
+    publisher->next_index++;
+    atomic_store_explicit(&region->published, publisher->next_index, memory_order_release);
+    
+    // A reader either sees the new futex value or is counted in waiters (both seq_cst)
+    atomic_fetch_add(&region->futex_word, 1);
+    if (atomic_load(&region->waiters) > 0) {
+        futex(&region->futex_word, FUTEX_WAKE, INT32_MAX, NULL);
+    }
+}
+
+RodShmReader* rod_shm_reader_open(const char* name) {
+    if (!name) return NULL;
+    
+    int fd = shm_open(name, O_RDWR, 0);
+    if (fd < 0) {
+        return NULL;  // Publisher not started yet
+    }
+    
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(ShmRegion)) {
+        close(fd);
+        return NULL;  // Publisher still creating the object
+    }
+    
+    void* map = mmap(NULL, sizeof(ShmRegion), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        fprintf(stderr, "rod_shm: Failed to map %s: %s\n", name, strerror(errno));
+        return NULL;
+    }
+    
+    ShmRegion* region = (ShmRegion*)map;
+    if (region->magic != SHM_MAGIC || region->version != SHM_VERSION ||
+        region->slot_count != ROD_SHM_SLOTS || region->slot_size != sizeof(ShmSlot) ||
+        !atomic_load(&region->open)) {
+        munmap(map, sizeof(ShmRegion));
+        return NULL;
+    }
+    
+    RodShmReader* reader = (RodShmReader*)calloc(1, sizeof(RodShmReader));
+    if (!reader) {
+        munmap(map, sizeof(ShmRegion));
+        return NULL;
+    }
+    reader->region = region;
+    reader->futex_seen = atomic_load(&region->futex_word);
+    
+    // Start with the latest snapshot (older ones are not interesting to a new reader)
+    uint64_t published = atomic_load_explicit(&region->published, memory_order_acquire);
+    reader->next_index = published > 0 ? published - 1 : 0;
+    return reader;
+}
+
+void rod_shm_reader_close(RodShmReader* reader) {
+    if (!reader) return;
+    munmap(reader->region, sizeof(ShmRegion));
+    free(reader);
+}
+
+/**
+ * @brief Seqlock read of one snapshot
+ * @return true if the copy is consistent and still holds snapshot index
+ */
+static bool read_slot(const ShmRegion* region, uint64_t index, RodProtocolMessage* message) {
+    const ShmSlot* slot = &region->slots[index % ROD_SHM_SLOTS];
+    
+    uint32_t before = atomic_load_explicit((_Atomic uint32_t*)&slot->sequence, memory_order_acquire);
+    if (before & 1u) return false;
+    
+    // Header first, then only the markers in use
+    message->sequence = slot->message.sequence;
+    message->timestamp_us = slot->message.timestamp_us;
+    message->timings = slot->message.timings;
+    message->flags = slot->message.flags;
+    int count = slot->message.count;
+    if (count < 0 || count > ROD_PROTOCOL_MAX_MARKERS) count = 0;  // Torn value, rejected below
+    message->count = count;
+    memcpy(message->markers, slot->message.markers, (size_t)count * sizeof(RodProtocolMarker));
+    
+    atomic_thread_fence(memory_order_acquire);
+    uint32_t after = atomic_load_explicit((_Atomic uint32_t*)&slot->sequence, memory_order_relaxed);
+    if (before != after) return false;
+    
+    // Slot may have been reused for a later snapshot while we were reading it
+    uint64_t published = atomic_load_explicit((_Atomic uint64_t*)&region->published, memory_order_acquire);
+    return published - index <= ROD_SHM_SLOTS;
+}
+
+int rod_shm_reader_next(RodShmReader* reader, RodProtocolMessage* message, unsigned long* lost) {
+    if (!reader || !message) return -1;
+    if (lost) *lost = 0;
+    
+    ShmRegion* region = reader->region;
+    if (!atomic_load_explicit(&region->open, memory_order_relaxed)) return -1;
+    
+    for (;;) {
+        uint32_t futex_value = atomic_load(&region->futex_word);
+        uint64_t published = atomic_load_explicit(&region->published, memory_order_acquire);
+        if (reader->next_index >= published) {
+            reader->futex_seen = futex_value;
+            return 0;
+        }
+        
+        // Overrun: the oldest slots still in the ring are the only ones readable
+        // (keep one slot of margin, the writer may be filling the next one)
+        uint64_t oldest = published > ROD_SHM_SLOTS - 1 ? published - (ROD_SHM_SLOTS - 1) : 0;
+        if (reader->next_index < oldest) {
+            if (lost) *lost += (unsigned long)(oldest - reader->next_index);
+            reader->next_index = oldest;
+        }
+        
+        if (read_slot(region, reader->next_index, message)) {
+            reader->next_index++;
+            if (reader->next_index >= published) reader->futex_seen = futex_value;
+            return 1;
+        }
+        // Slot overwritten during the copy: retry from the new oldest snapshot
+    }
+}
+
+int rod_shm_reader_latest(RodShmReader* reader, RodProtocolMessage* message) {
+    if (!reader || !message) return -1;
+    
+    ShmRegion* region = reader->region;
+    uint64_t published = atomic_load_explicit(&region->published, memory_order_acquire);
+    if (published > reader->next_index + 1) {
+        reader->next_index = published - 1;
+    }
+    return rod_shm_reader_next(reader, message, NULL);
+}
+
+bool rod_shm_reader_wait(RodShmReader* reader, int timeout_ms) {
+    if (!reader) return false;
+    
+    ShmRegion* region = reader->region;
+    if (atomic_load_explicit(&region->published, memory_order_acquire) > reader->next_index) {
+        return true;
+    }
+    
+    struct timespec timeout;
+    timeout.tv_sec = timeout_ms / 1000;
+    timeout.tv_nsec = (long)(timeout_ms % 1000) * 1000000L;
+    
+    atomic_fetch_add(&region->waiters, 1);
+    if (atomic_load(&region->futex_word) == reader->futex_seen && atomic_load(&region->open)) {
+        // Returns early if futex_word moved on in between (EAGAIN)
+        futex(&region->futex_word, FUTEX_WAIT, reader->futex_seen, &timeout);
+    }
+    atomic_fetch_sub(&region->waiters, 1);
+    
+    return atomic_load(&region->open) &&
+           atomic_load_explicit(&region->published, memory_order_acquire) > reader->next_index;
+}
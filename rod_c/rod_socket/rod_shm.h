@@ -0,0 +1,123 @@
+/**
+ * @file rod_shm.h
+ * @brief Shared memory publication of detection snapshots for ROD
+ * @author Noé Game
+ * @date 14/10/2026
+ * @see rod_shm.c
+ * @copyright Cecill-C (Cf. LICENCE.txt)
+ * 
+ * The detection process (single writer) publishes one snapshot per frame in a
+ * ring of ROD_SHM_SLOTS slots mapped from a POSIX shared memory object. Any
+ * number of readers (rod_communication, logger, dashboard...) map the same
+ * object read-write and read snapshots without locks:
+ * 
+ * - Each slot is protected by a seqlock: the writer makes the slot sequence
+ *   odd while it writes, readers retry when the sequence is odd or changed
+ *   during their copy. The writer never waits for readers.
+ * - A futex word is incremented on each publication. Readers can sleep on it
+ *   with rod_shm_reader_wait(), the writer only issues FUTEX_WAKE when at
+ *   least one reader sleeps.
+ * 
+ * Publishing is O(1) whatever the number of readers. A reader slower than
+ * ROD_SHM_SLOTS frames loses the oldest snapshots (reported in `lost`).
+ */
+
+#pragma once
+
+/* ******************************************************* Includes ****************************************************** */
+
+#include "rod_protocol.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ***************************************************** Public macros *************************************************** */
+
+#define ROD_SHM_SLOTS 16    // Snapshots kept in the ring (layout constant, shared by writer and readers)
+
+/* ************************************************** Public types definition ******************************************** */
+
+/**
+ * @brief Opaque publisher (detection process)
+ */
+typedef struct RodShmPublisher RodShmPublisher;
+
+/**
+ * @brief Opaque reader (any consumer process)
+ */
+typedef struct RodShmReader RodShmReader;
+
+/* *********************************************** Public functions declarations ***************************************** */
+
+/**
+ * @brief Create the shared memory object and map it
+ * @param name POSIX shared memory name (e.g. "/rod_detections")
+ * @return Publisher, or NULL on failure
+ * 
+ * Any existing object with this name is replaced.
+ */
+RodShmPublisher* rod_shm_publisher_create(const char* name);
+
+/**
+ * @brief Mark the ring as closed, unmap and remove the shared memory object
+ * @param publisher Publisher
+ */
+void rod_shm_publisher_destroy(RodShmPublisher* publisher);
+
+/**
+ * @brief Get the message of the next slot, to be filled in place
+ * @param publisher Publisher
+ * @return Message to fill (sequence, timestamp_us, timings, flags, count, markers), then call rod_shm_publisher_commit()
+ */
+RodProtocolMessage* rod_shm_publisher_begin(RodShmPublisher* publisher);
+
+/**
+ * @brief Publish the message filled since rod_shm_publisher_begin() and wake sleeping readers
+ * @param publisher Publisher
+ */
+void rod_shm_publisher_commit(RodShmPublisher* publisher);
+
+/**
+ * @brief Open and map an existing shared memory object
+ * @param name POSIX shared memory name
+ * @return Reader positioned on the latest snapshot, or NULL if the publisher is not running
+ */
+RodShmReader* rod_shm_reader_open(const char* name);
+
+/**
+ * @brief Unmap the shared memory object
+ * @param reader Reader
+ */
+void rod_shm_reader_close(RodShmReader* reader);
+
+/**
+ * @brief Copy the next unread snapshot
+ * @param reader Reader
+ * @param message Output message
+ * @param lost Output number of snapshots overwritten before they were read (may be NULL)
+ * @return 1 if a snapshot was copied, 0 if none is pending, -1 if the publisher closed the ring
+ */
+int rod_shm_reader_next(RodShmReader* reader, RodProtocolMessage* message, unsigned long* lost);
+
+/**
+ * @brief Copy the most recent snapshot, skipping older unread ones
+ * @param reader Reader
+ * @param message Output message
+ * @return 1 if a new snapshot was copied, 0 if nothing new, -1 if the publisher closed the ring
+ */
+int rod_shm_reader_latest(RodShmReader* reader, RodProtocolMessage* message);
+
+/**
+ * @brief Sleep until a snapshot is published after the last one read
+ * @param reader Reader
+ * @param timeout_ms Maximum wait in milliseconds
+ * @return true if a new snapshot is available, false on timeout, signal or closed ring
+ */
+bool rod_shm_reader_wait(RodShmReader* reader, int timeout_ms);
+
+#ifdef __cplusplus
+}
+#endif
@@ -10,6 +10,7 @@
 /* ******************************************************* Includes ****************************************************** */
 
 #include "rod_socket.h"
+#include "rod_protocol.h"
 #include "rod_config.h"
 #include <stdio.h>
 #include <stdlib.h>
@@ -22,6 +23,13 @@
 
 /* ***************************************************** Public macros *************************************************** */
 
+// Longest text record: "[id,x,y,angle]," with 32-bit id and float fields
+#define TEXT_RECORD_MAX_SIZE 64
+#define TEXT_MESSAGE_MAX_SIZE (ROD_PROTOCOL_MAX_MARKERS * TEXT_RECORD_MAX_SIZE + 4)
+
+#define SEND_BUFFER_SIZE (TEXT_MESSAGE_MAX_SIZE > ROD_PROTOCOL_MAX_MESSAGE_SIZE ? \
+                          TEXT_MESSAGE_MAX_SIZE : ROD_PROTOCOL_MAX_MESSAGE_SIZE)
+
 /* ************************************************** Public types definition ******************************************** */
 
 /**
@@ -31,6 +39,11 @@ struct RodSocketServer {
     int socket_fd;      // Server socket file descriptor
     int client_fd;      // Connected client file descriptor (-1 if no client)
     char* socket_path;  // Path to Unix domain socket
+    bool text_mode;     // Legacy text lines instead of binary messages
+    uint8_t buffer[SEND_BUFFER_SIZE];   // Encoded message (reused for every send)
+    uint8_t pending[SEND_BUFFER_SIZE];  // Unsent tail of the last message (client socket full)
+    size_t pending_length;
+    unsigned long dropped;              // Messages dropped since the client became slow
 };
 
 /* *********************************************** Public functions declarations ***************************************** */
@@ -54,6 +67,9 @@ RodSocketServer* rod_socket_server_create(const char* socket_path) {
     
     server->socket_fd = -1;
     server->client_fd = -1;
+    server->text_mode = ROD_SOCKET_TEXT_PROTOCOL;
+    server->pending_length = 0;
+    server->dropped = 0;
     server->socket_path = strdup(socket_path);
     if (!server->socket_path) {
         fprintf(stderr, "rod_socket: Failed to duplicate socket path\n");
@@ -153,6 +169,8 @@ bool rod_socket_server_accept(RodSocketServer* server) {
     
     if (server->client_fd >= 0) {
         printf("rod_socket: Client connected\n");
+        server->pending_length = 0;
+        server->dropped = 0;
         return true;
     } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
         // No client waiting, not an error
@@ -167,74 +185,145 @@ bool rod_socket_server_has_client(RodSocketServer* server) {
     return server && server->client_fd >= 0;
 }
 
-bool rod_socket_server_send_detections(RodSocketServer* server, 
-                                        const MarkerData* markers, 
-                                        int count) {
-    if (!server) return false;
-    
-    // If no client connected, return success (no-op)
-    if (server->client_fd < 0) {
-        return true;
+void rod_socket_server_set_text_mode(RodSocketServer* server, bool text_mode) {
+    if (server) server->text_mode = text_mode;
+}
+
+/**
+ * @brief Encode markers as a binary message (see rod_protocol.h)
+ * @return Message size in bytes
+ */
+static size_t encode_binary(RodSocketServer* server, uint32_t sequence, uint64_t timestamp_us,
+                            const RodProtocolTimings* timings, uint32_t flags,
+                            const MarkerData* markers, int count) {
+    uint8_t* p = server->buffer;
+    p += rod_protocol_encode_header(p, sequence, timestamp_us, timings, flags, count);
+    for (int i = 0; i < count; i++) {
+        p += rod_protocol_encode_marker(p, markers[i].id, markers[i].x, markers[i].y, markers[i].angle,
+                                        markers[i].age_us);
     }
-    
-    // Format detection results as JSON-like array: [[id, x, y, angle], ...]
-    char buffer[ROD_MAX_DETECTION_SIZE];
+    return (size_t)(p - server->buffer);
+}
+
+/**
+ * @brief Encode markers as a legacy text line: [[id, x, y, angle], ...]
+ * @return Message size in bytes
+ */
+static size_t encode_text(RodSocketServer* server, const MarkerData* markers, int count) {
+    char* buffer = (char*)server->buffer;
     int offset = 0;
     
-    // Start array
-    offset += snprintf(buffer + offset, ROD_MAX_DETECTION_SIZE - offset, "[");
-    
-    // Add each marker
+    buffer[offset++] = '[';
     for (int i = 0; i < count; i++) {
-        if (i > 0) {
-            offset += snprintf(buffer + offset, ROD_MAX_DETECTION_SIZE - offset, ",");
-        }
-        offset += snprintf(buffer + offset, ROD_MAX_DETECTION_SIZE - offset,
-                          "[%d,%.2f,%.2f,%.4f]",
-                          markers[i].id, markers[i].x, markers[i].y, markers[i].angle);
-        
-        // Check buffer overflow
-        if (offset >= ROD_MAX_DETECTION_SIZE - 100) {
-            fprintf(stderr, "rod_socket: Buffer too small, truncating results\n");
-            break;
+        int written = snprintf(buffer + offset, TEXT_RECORD_MAX_SIZE, "%s[%d,%.2f,%.2f,%.4f]",
+                               i > 0 ? "," : "",
+                               markers[i].id, markers[i].x, markers[i].y, markers[i].angle);
+        if (written < 0 || written >= TEXT_RECORD_MAX_SIZE) {
+            fprintf(stderr, "rod_socket: Marker %d does not fit a text record, skipped\n", markers[i].id);
+            continue;
         }
+        offset += written;
     }
+    buffer[offset++] = ']';
+    buffer[offset++] = '\n';
     
-    // Close array and add newline
-    offset += snprintf(buffer + offset, ROD_MAX_DETECTION_SIZE - offset, "]\n");
-    
-    // Print to console for debugging
-    printf("rod_socket: Sending %d markers: %s", count, buffer);
-    
-    // Send via socket
-    ssize_t total_sent = 0;
-    ssize_t bytes_to_send = strlen(buffer);
+    return (size_t)offset;
+}
+
+/**
+ * @brief Send as much of a buffer as the client socket accepts without blocking
+ * @return Number of bytes sent, -1 if the client was disconnected
+ */
+static ssize_t send_nonblocking(RodSocketServer* server, const uint8_t* data, size_t length) {
+    size_t total_sent = 0;
     
-    while (total_sent < bytes_to_send) {
-        ssize_t sent = send(server->client_fd, buffer + total_sent, 
-                          bytes_to_send - total_sent, MSG_NOSIGNAL);
+    while (total_sent < length) {
+        ssize_t sent = send(server->client_fd, data + total_sent, 
+                          length - total_sent, MSG_NOSIGNAL | MSG_DONTWAIT);
         
         if (sent < 0) {
-            if (errno == EPIPE || errno == ECONNRESET) {
+            if (errno == EINTR) {
+                continue;
+            } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                // Client socket full: never wait for a slow client
+                break;
+            } else if (errno == EPIPE || errno == ECONNRESET) {
                 // Client disconnected
                 printf("rod_socket: Client disconnected\n");
-                close(server->client_fd);
-                server->client_fd = -1;
-                return false;
-            } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
-                // Would block, try again
-                usleep(1000);
-                continue;
             } else {
                 fprintf(stderr, "rod_socket: Error sending data: %s\n", strerror(errno));
-                close(server->client_fd);
-                server->client_fd = -1;
-                return false;
             }
+            close(server->client_fd);
+            server->client_fd = -1;
+            server->pending_length = 0;
+            return -1;
         }
         
-        total_sent += sent;
+        total_sent += (size_t)sent;
     }
     
+    return (ssize_t)total_sent;
+}
+
+/**
+ * @brief Try to finish sending the tail of the previous message
+ * @return 1 if nothing is pending anymore, 0 if still pending, -1 if the client was disconnected
+ */
+static int flush_pending(RodSocketServer* server) {
+    if (server->pending_length == 0) return 1;
+    
+    ssize_t sent = send_nonblocking(server, server->pending, server->pending_length);
+    if (sent < 0) return -1;
+    
+    server->pending_length -= (size_t)sent;
+    if (server->pending_length > 0) {
+        memmove(server->pending, server->pending + sent, server->pending_length);
+        return 0;
+    }
+    return 1;
+}
+
+bool rod_socket_server_send_detections(RodSocketServer* server, 
+                                        uint32_t sequence,
+                                        uint64_t timestamp_us,
+                                        const RodProtocolTimings* timings,
+                                        uint32_t flags,
+                                        const MarkerData* markers, 
+                                        int count) {
+    if (!server || (count > 0 && !markers)) return false;
+    
+    // If no client connected, return success (no-op)
+    if (server->client_fd < 0) {
+        return true;
+    }
+    
+    if (count < 0) count = 0;
+    if (count > ROD_PROTOCOL_MAX_MARKERS) {
+        fprintf(stderr, "rod_socket: %d markers, only %d sent\n", count, ROD_PROTOCOL_MAX_MARKERS);
+        count = ROD_PROTOCOL_MAX_MARKERS;
+    }
+    
+    // Messages are never split: while a previous tail is pending, new ones are dropped
+    int flushed = flush_pending(server);
+    if (flushed < 0) return false;
+    if (flushed == 0) {
+        if (server->dropped++ == 0) {
+            fprintf(stderr, "rod_socket: Client too slow, dropping messages\n");
+        }
+        return true;
+    }
+    if (server->dropped > 0) {
+        fprintf(stderr, "rod_socket: Client caught up, %lu messages dropped\n", server->dropped);
+        server->dropped = 0;
+    }
+    
+    size_t length = server->text_mode ? encode_text(server, markers, count)
+                                      : encode_binary(server, sequence, timestamp_us, timings, flags, markers, count);
+    ssize_t sent = send_nonblocking(server, server->buffer, length);
+    if (sent < 0) return false;
+    
+    // Keep the unsent tail for the next call
+    server->pending_length = length - (size_t)sent;
+    memcpy(server->pending, server->buffer + sent, server->pending_length);
     return true;
 }
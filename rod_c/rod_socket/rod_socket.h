@@ -15,8 +15,10 @@
 /* ******************************************************* Includes ****************************************************** */
 
 #include "rod_cv.h"
+#include "rod_protocol.h"
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 
 /* ***************************************************** Public macros *************************************************** */
 
@@ -56,17 +58,36 @@ bool rod_socket_server_accept(RodSocketServer* server);
  */
 bool rod_socket_server_has_client(RodSocketServer* server);
 
+/**
+ * @brief Select the wire format
+ * @param server Socket server context
+ * @param text_mode true = legacy text lines, false = binary messages (default from ROD_SOCKET_TEXT_PROTOCOL)
+ */
+void rod_socket_server_set_text_mode(RodSocketServer* server, bool text_mode);
+
 /**
  * @brief Send detection results to connected client
  * @param server Socket server context
+ * @param sequence Camera frame sequence number
+ * @param timestamp_us Sensor timestamp in microseconds (CLOCK_MONOTONIC)
+ * @param timings Stage timestamps relative to timestamp_us (NULL = all zero)
+ * @param flags ROD_PROTOCOL_FLAG_* bits (how the frame was processed)
  * @param markers Array of detected markers
- * @param count Number of markers
+ * @param count Number of markers (at most ROD_PROTOCOL_MAX_MARKERS are sent)
  * @return true on success, false on failure (client disconnected)
  * 
- * Formats detection results as JSON-like array: [[id, x, y, angle], ...]
+ * Binary mode sends one framed message (see rod_protocol.h).
+ * Text mode sends a JSON-like line [[id, x, y, angle], ...] without sequence, timestamp or flags.
+ * The message is encoded in a buffer owned by the server (no allocation).
+ * Never blocks: if the client socket is full, the unsent tail is kept for the
+ * next call and messages are dropped until the client catches up.
  * If client is not connected, returns true (no-op).
  */
 bool rod_socket_server_send_detections(RodSocketServer* server, 
+                                        uint32_t sequence,
+                                        uint64_t timestamp_us,
+                                        const RodProtocolTimings* timings,
+                                        uint32_t flags,
                                         const MarkerData* markers, 
                                         int count);
 
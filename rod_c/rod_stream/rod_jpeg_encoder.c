@@ -0,0 +1,322 @@
+/**
+ * @file rod_jpeg_encoder.c
+ * @brief JPEG encoder for the live stream: V4L2 M2M hardware encoder, software fallback
+ * @author Noé Game
+ * @date 14/10/2026
+ * @see rod_jpeg_encoder.h
+ * @copyright Cecill-C (Cf. LICENCE.txt)
+ */
+
+/* ******************************************************* Includes ****************************************************** */
+
+#include "rod_jpeg_encoder.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <linux/videodev2.h>
+
+/* ***************************************************** Public macros *************************************************** */
+
+#define ENCODE_TIMEOUT_MS 1000  // Longest wait for the hardware encoder
+
+/* ************************************************** Public types definition ******************************************** */
+
+/**
+ * @brief JPEG encoder structure
+ */
+struct RodJpegEncoder {
+    int quality;
+    int fd;                  // V4L2 M2M device, -1 = software encoding
+    bool configured;         // Formats set, buffers mapped, streaming
+    int width;               // Configured input format
+    int height;
+    bool swap_rb;
+    uint32_t input_stride;   // Bytes per input row required by the device
+    void* input_map;         // Raw image buffer (V4L2 OUTPUT queue)
+    size_t input_length;
+    void* output_map;        // JPEG buffer (V4L2 CAPTURE queue)
+    size_t output_length;
+};
+
+/* *********************************************** Public functions declarations ***************************************** */
+
+/* ******************************************* Public callback functions declarations ************************************ */
+
+/* ********************************************* Function implementations *********************************************** */
+
+static int xioctl(int fd, unsigned long request, void* arg) {
+    int result;
+    do {
+        result = ioctl(fd, request, arg);
+    } while (result == -1 && errno == EINTR);
+    return result;
+}
+
+/**
+ * @brief Check that a device is a memory-to-memory encoder producing JPEG
+ */
+static bool is_jpeg_m2m_device(int fd) {
+    struct v4l2_capability cap;
+    memset(&cap, 0, sizeof(cap));
+    if (xioctl(fd, VIDIOC_QUERYCAP, &cap) != 0) return false;
+
+    uint32_t caps = (cap.capabilities & V4L2_CAP_DEVICE_CAPS) ? cap.device_caps : cap.capabilities;
+    if (!(caps & V4L2_CAP_VIDEO_M2M_MPLANE) || !(caps & V4L2_CAP_STREAMING)) return false;
+
+    struct v4l2_fmtdesc desc;
+    memset(&desc, 0, sizeof(desc));
+    desc.type = V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE;
+    for (desc.index = 0; xioctl(fd, VIDIOC_ENUM_FMT, &desc) == 0; desc.index++) {
+        if (desc.pixelformat == V4L2_PIX_FMT_JPEG || desc.pixelformat == V4L2_PIX_FMT_MJPEG) return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Stop streaming, unmap and free the device buffers
+ */
+static void unconfigure(RodJpegEncoder* encoder) {
+    if (!encoder->configured) return;
+
+    enum v4l2_buf_type types[2] = {V4L2_BUF_TYPE_VIDEO_OUTPUT_MPLANE, V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE};
+    for (int i = 0; i < 2; i++) {
+        xioctl(encoder->fd, VIDIOC_STREAMOFF, &types[i]);
+    }
+    if (encoder->input_map) munmap(encoder->input_map, encoder->input_length);
+    if (encoder->output_map) munmap(encoder->output_map, encoder->output_length);
+    encoder->input_map = NULL;
+    encoder->output_map = NULL;
+    for (int i = 0; i < 2; i++) {
+        struct v4l2_requestbuffers req;
+        memset(&req, 0, sizeof(req));
+        req.type = types[i];
+        req.memory = V4L2_MEMORY_MMAP;
+        xioctl(encoder->fd, VIDIOC_REQBUFS, &req);
+    }
+    encoder->configured = false;
+}
+
+/**
+ * @brief Give up on the hardware encoder for the rest of the run
+ */
+static void disable_hardware(RodJpegEncoder* encoder, const char* reason) {
+    fprintf(stderr, "rod_jpeg_encoder: %s (%s), using software encoding\n", reason, strerror(errno));
+    unconfigure(encoder);
+    close(encoder->fd);
+    encoder->fd = -1;
+}
+
+/**
+ * @brief Allocate and map the single buffer of a queue
+ */
+static int map_buffer(int fd, enum v4l2_buf_type type, void** map, size_t* length) {
+    struct v4l2_requestbuffers req;
+    memset(&req, 0, sizeof(req));
+    req.count = 1;
+    req.type = type;
+    req.memory = V4L2_MEMORY_MMAP;
+    if (xioctl(fd, VIDIOC_REQBUFS, &req) != 0 || req.count < 1) return -1;
+
+    struct v4l2_plane planes[VIDEO_MAX_PLANES];
+    struct v4l2_buffer buf;
+    memset(planes, 0, sizeof(planes));
+    memset(&buf, 0, sizeof(buf));
+    buf.type = type;
+    buf.memory = V4L2_MEMORY_MMAP;
+    buf.index = 0;
+    buf.m.planes = planes;
+    buf.length = VIDEO_MAX_PLANES;
+    if (xioctl(fd, VIDIOC_QUERYBUF, &buf) != 0) return -1;
+
+    void* mapped = mmap(NULL, planes[0].length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, planes[0].m.mem_offset);
+    if (mapped == MAP_FAILED) return -1;
+    *map = mapped;
+    *length = planes[0].length;
+    return 0;
+}
+
+/**
+ * @brief Set the formats for an image size and start streaming
+ */
+static int configure(RodJpegEncoder* encoder, int width, int height, bool swap_rb) {
+    unconfigure(encoder);
+
+    // Input: packed 24 bit pixels, in the byte order of the image
+    // (swap_rb: the BGR bytes are declared as RGB, the device does the swap for free)
+    struct v4l2_format fmt;
+    memset(&fmt, 0, sizeof(fmt));
+    fmt.type = V4L2_BUF_TYPE_VIDEO_OUTPUT_MPLANE;
+    fmt.fmt.pix_mp.width = (uint32_t)width;
+    fmt.fmt.pix_mp.height = (uint32_t)height;
+    fmt.fmt.pix_mp.pixelformat = swap_rb ? V4L2_PIX_FMT_RGB24 : V4L2_PIX_FMT_BGR24;
+    fmt.fmt.pix_mp.field = V4L2_FIELD_NONE;
+    fmt.fmt.pix_mp.num_planes = 1;
+    fmt.fmt.pix_mp.plane_fmt[0].bytesperline = (uint32_t)width * 3;
+    if (xioctl(encoder->fd, VIDIOC_S_FMT, &fmt) != 0 ||
+        fmt.fmt.pix_mp.width != (uint32_t)width || fmt.fmt.pix_mp.height != (uint32_t)height ||
+        fmt.fmt.pix_mp.pixelformat != (swap_rb ? V4L2_PIX_FMT_RGB24 : V4L2_PIX_FMT_BGR24)) {
+        return -1;
+    }
+    encoder->input_stride = fmt.fmt.pix_mp.plane_fmt[0].bytesperline;
+
+    // Output: JPEG, the driver sizes the buffer
+    memset(&fmt, 0, sizeof(fmt));
+    fmt.type = V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE;
+    fmt.fmt.pix_mp.width = (uint32_t)width;
+    fmt.fmt.pix_mp.height = (uint32_t)height;
+    fmt.fmt.pix_mp.pixelformat = V4L2_PIX_FMT_JPEG;
+    fmt.fmt.pix_mp.field = V4L2_FIELD_NONE;
+    fmt.fmt.pix_mp.num_planes = 1;
+    if (xioctl(encoder->fd, VIDIOC_S_FMT, &fmt) != 0) return -1;
+
+    // Quality is best effort (not every driver exposes it)
+    struct v4l2_control control;
+    memset(&control, 0, sizeof(control));
+    control.id = V4L2_CID_JPEG_COMPRESSION_QUALITY;
+    control.value = encoder->quality;
+    xioctl(encoder->fd, VIDIOC_S_CTRL, &control);
+
+    encoder->configured = true;  // From here unconfigure() cleans up partial setups
+    if (map_buffer(encoder->fd, V4L2_BUF_TYPE_VIDEO_OUTPUT_MPLANE, &encoder->input_map, &encoder->input_length) != 0 ||
+        map_buffer(encoder->fd, V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE, &encoder->output_map, &encoder->output_length) != 0) {
+        return -1;
+    }
+    if (encoder->input_length < (size_t)encoder->input_stride * (size_t)height) return -1;
+
+    enum v4l2_buf_type types[2] = {V4L2_BUF_TYPE_VIDEO_OUTPUT_MPLANE, V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE};
+    for (int i = 0; i < 2; i++) {
+        if (xioctl(encoder->fd, VIDIOC_STREAMON, &types[i]) != 0) return -1;
+    }
+
+    encoder->width = width;
+    encoder->height = height;
+    encoder->swap_rb = swap_rb;
+    return 0;
+}
+
+/**
+ * @brief Dequeue a buffer, waiting for it up to ENCODE_TIMEOUT_MS
+ */
+static int dequeue(int fd, struct v4l2_buffer* buf, short events) {
+    if (xioctl(fd, VIDIOC_DQBUF, buf) == 0) return 0;
+    if (errno != EAGAIN) return -1;
+
+    struct pollfd pfd = {fd, events, 0};
+    if (poll(&pfd, 1, ENCODE_TIMEOUT_MS) <= 0) {
+        errno = ETIMEDOUT;
+        return -1;
+    }
+    return xioctl(fd, VIDIOC_DQBUF, buf);
+}
+
+static const uint8_t* encode_hardware(RodJpegEncoder* encoder, ImageHandle* image, bool swap_rb, size_t* size) {
+    int width = get_image_width(image);
+    int height = get_image_height(image);
+    if (!encoder->configured || width != encoder->width || height != encoder->height || swap_rb != encoder->swap_rb) {
+        if (configure(encoder, width, height, swap_rb) != 0) {
+            disable_hardware(encoder, "Failed to configure hardware encoder");
+            return NULL;
+        }
+    }
+
+    // The only copy: image rows into the device buffer (its stride may be padded)
+    const uint8_t* data = get_image_data(image);
+    size_t row = (size_t)width * 3;
+    for (int y = 0; y < height; y++) {
+        memcpy((uint8_t*)encoder->input_map + (size_t)y * encoder->input_stride, data + (size_t)y * row, row);
+    }
+
+    struct v4l2_plane input_plane;
+    struct v4l2_buffer input;
+    memset(&input_plane, 0, sizeof(input_plane));
+    memset(&input, 0, sizeof(input));
+    input_plane.bytesused = encoder->input_stride * (uint32_t)height;
+    input_plane.length = (uint32_t)encoder->input_length;
+    input.type = V4L2_BUF_TYPE_VIDEO_OUTPUT_MPLANE;
+    input.memory = V4L2_MEMORY_MMAP;
+    input.index = 0;
+    input.m.planes = &input_plane;
+    input.length = 1;
+
+    struct v4l2_plane output_plane;
+    struct v4l2_buffer output;
+    memset(&output_plane, 0, sizeof(output_plane));
+    memset(&output, 0, sizeof(output));
+    output_plane.length = (uint32_t)encoder->output_length;
+    output.type = V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE;
+    output.memory = V4L2_MEMORY_MMAP;
+    output.index = 0;
+    output.m.planes = &output_plane;
+    output.length = 1;
+
+    if (xioctl(encoder->fd, VIDIOC_QBUF, &input) != 0 ||
+        xioctl(encoder->fd, VIDIOC_QBUF, &output) != 0 ||
+        dequeue(encoder->fd, &output, POLLIN) != 0 ||
+        dequeue(encoder->fd, &input, POLLOUT) != 0) {
+        disable_hardware(encoder, "Hardware encoding failed");
+        return NULL;
+    }
+
+    *size = output_plane.bytesused;
+    return (const uint8_t*)encoder->output_map;
+}
+
+RodJpegEncoder* rod_jpeg_encoder_create(const char* device, int quality) {
+    if (quality < 1 || quality > 100) {
+        fprintf(stderr, "rod_jpeg_encoder: Invalid quality %d\n", quality);
+        return NULL;
+    }
+
+    RodJpegEncoder* encoder = (RodJpegEncoder*)calloc(1, sizeof(RodJpegEncoder));
+    if (!encoder) {
+        fprintf(stderr, "rod_jpeg_encoder: Failed to allocate encoder\n");
+        return NULL;
+    }
+    encoder->quality = quality;
+    encoder->fd = -1;
+
+    if (device && device[0]) {
+        encoder->fd = open(device, O_RDWR | O_NONBLOCK | O_CLOEXEC);
+        if (encoder->fd < 0) {
+            fprintf(stderr, "rod_jpeg_encoder: %s not available (%s), using software encoding\n",
+                    device, strerror(errno));
+        } else if (!is_jpeg_m2m_device(encoder->fd)) {
+            fprintf(stderr, "rod_jpeg_encoder: %s is not a JPEG M2M encoder, using software encoding\n", device);
+            close(encoder->fd);
+            encoder->fd = -1;
+        }
+    }
+
+    return encoder;
+}
+
+void rod_jpeg_encoder_destroy(RodJpegEncoder* encoder) {
+    if (!encoder) return;
+    if (encoder->fd >= 0) {
+        unconfigure(encoder);
+        close(encoder->fd);
+    }
+    free(encoder);
+}
+
+const uint8_t* rod_jpeg_encoder_encode(RodJpegEncoder* encoder, ImageHandle* image, bool swap_rb, size_t* size) {
+    if (!encoder || !image || !size || get_image_channels(image) != 3) return NULL;
+
+    if (encoder->fd >= 0 &&
+        get_image_data_size(image) == (size_t)get_image_width(image) * (size_t)get_image_height(image) * 3) {
+        const uint8_t* encoded = encode_hardware(encoder, image, swap_rb, size);
+        if (encoded) return encoded;
+    }
+
+    return encode_jpeg(image, encoder->quality, swap_rb ? 1 : 0, size);
+}
+
+bool rod_jpeg_encoder_is_hardware(const RodJpegEncoder* encoder) {
+    return encoder && encoder->fd >= 0;
+}
@@ -0,0 +1,70 @@
+/**
+ * @file rod_jpeg_encoder.h
+ * @brief JPEG encoder for the live stream: V4L2 M2M hardware encoder, software fallback
+ * @author Noé Game
+ * @date 14/10/2026
+ * @see rod_jpeg_encoder.c
+ * @copyright Cecill-C (Cf. LICENCE.txt)
+ *
+ * On the Raspberry Pi the VideoCore codec exposes a memory-to-memory JPEG
+ * encoder (bcm2835-codec, /dev/video31): frames are copied into its input
+ * buffer and come back encoded, without using the CPU cores the pipeline
+ * runs on. When the device is missing or fails, encoding falls back to
+ * encode_jpeg() (OpenCV, software) for the rest of the run.
+ *
+ * An encoder is used by one thread at a time.
+ */
+
+#pragma once
+
+/* ******************************************************* Includes ****************************************************** */
+
+#include "opencv_wrapper.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* ***************************************************** Public macros *************************************************** */
+
+/* ************************************************** Public types definition ******************************************** */
+
+/**
+ * @brief Opaque JPEG encoder
+ */
+typedef struct RodJpegEncoder RodJpegEncoder;
+
+/* *********************************************** Public functions declarations ***************************************** */
+
+/**
+ * @brief Create a JPEG encoder
+ * @param device V4L2 M2M encoder device (e.g. "/dev/video31"), NULL or "" = software only
+ * @param quality JPEG quality, 1 to 100
+ * @return Encoder, or NULL on failure (a missing device is not a failure)
+ */
+RodJpegEncoder* rod_jpeg_encoder_create(const char* device, int quality);
+
+/**
+ * @brief Destroy a JPEG encoder
+ * @param encoder Encoder (NULL is ignored)
+ */
+void rod_jpeg_encoder_destroy(RodJpegEncoder* encoder);
+
+/**
+ * @brief Encode a BGR image
+ * @param encoder Encoder
+ * @param image Continuous 3 channel image
+ * @param swap_rb Swap red and blue (same meaning as convert_to_rgb in rod_writer_submit())
+ * @param size Output encoded size in bytes
+ * @return Encoded bytes, owned by the encoder and valid until the next call, NULL on error
+ *
+ * The hardware encoder is configured for the first image size and reconfigured
+ * when it changes.
+ */
+const uint8_t* rod_jpeg_encoder_encode(RodJpegEncoder* encoder, ImageHandle* image, bool swap_rb, size_t* size);
+
+/**
+ * @brief Check whether images are encoded by the hardware encoder
+ * @param encoder Encoder
+ * @return true if the V4L2 M2M device is in use
+ */
+bool rod_jpeg_encoder_is_hardware(const RodJpegEncoder* encoder);
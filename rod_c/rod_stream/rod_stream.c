@@ -0,0 +1,448 @@
+/**
+ * @file rod_stream.c
+ * @brief Live MJPEG stream of the annotated preview over HTTP for ROD
+ * @author Noé Game
+ * @date 14/10/2026
+ * @see rod_stream.h
+ * @copyright Cecill-C (Cf. LICENCE.txt)
+ */
+
+#define _GNU_SOURCE  // Required for accept4 and pipe2
+
+/* ******************************************************* Includes ****************************************************** */
+
+#include "rod_stream.h"
+#include "rod_jpeg_encoder.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+
+/* ***************************************************** Public macros *************************************************** */
+
+#define REQUEST_BUFFER_SIZE 1024
+#define BOUNDARY "frame"
+
+/* ************************************************** Public types definition ******************************************** */
+
+/**
+ * @brief State of a connection
+ */
+typedef enum {
+    CLIENT_FREE,       // Slot unused
+    CLIENT_REQUEST,    // Connected, HTTP request not complete yet
+    CLIENT_STREAMING   // Receiving /video_feed
+} ClientState;
+
+/**
+ * @brief One connection (stream thread only)
+ */
+typedef struct {
+    int fd;
+    ClientState state;
+    char request[REQUEST_BUFFER_SIZE];
+    size_t request_length;
+} StreamClient;
+
+/**
+ * @brief Stream server structure
+ */
+struct RodStream {
+    int listen_fd;
+    int wake_pipe[2];             // Written by submit/destroy, wakes the thread
+    pthread_t thread;
+    RodJpegEncoder* encoder;      // Stream thread only
+    bool convert_to_rgb;
+    uint64_t min_interval_us;     // 1 / max_fps
+    StreamClient clients[ROD_STREAM_MAX_CLIENTS];  // Stream thread only
+
+    pthread_mutex_t lock;         // Protects pending
+    ImageHandle* pending;         // Newest submitted frame not encoded yet
+
+    atomic_bool stop;
+    atomic_int streaming_clients;
+    atomic_uint_fast64_t last_tap_us;
+    atomic_int frames_sent;
+    atomic_int frames_skipped;
+    atomic_bool hardware;         // Last frame encoded by the hardware encoder
+};
+
+/* *********************************************** Public functions declarations ***************************************** */
+
+/* ******************************************* Public callback functions declarations ************************************ */
+
+/* ********************************************* Function implementations *********************************************** */
+
+static const char PAGE_RESPONSE[] =
+    "HTTP/1.0 200 OK\r\n"
+    "Content-Type: text/html\r\n"
+    "Connection: close\r\n"
+    "\r\n"
+    "<html>\n"
+    "<head><title>ROD Live Stream</title></head>\n"
+    "<body>\n"
+    "    <h1>ROD Live Stream</h1>\n"
+    "    <img src=\"/video_feed\" style=\"max-width: 100%; border: 1px solid #ccc;\">\n"
+    "</body>\n"
+    "</html>\n";
+
+static const char STREAM_RESPONSE[] =
+    "HTTP/1.0 200 OK\r\n"
+    "Cache-Control: no-cache, private\r\n"
+    "Pragma: no-cache\r\n"
+    "Connection: close\r\n"
+    "Content-Type: multipart/x-mixed-replace; boundary=" BOUNDARY "\r\n"
+    "\r\n";
+
+static const char NOT_FOUND_RESPONSE[] =
+    "HTTP/1.0 404 Not Found\r\n"
+    "Content-Type: text/plain\r\n"
+    "Connection: close\r\n"
+    "\r\n"
+    "Not found\n";
+
+/**
+ * @brief Send a whole buffer (blocking, up to ROD_STREAM_SEND_TIMEOUT_MS per send)
+ * @return 0 on success, -1 if the client is gone or too slow
+ */
+static int send_all(int fd, const void* data, size_t length, int flags) {
+    const uint8_t* bytes = (const uint8_t*)data;
+    while (length > 0) {
+        ssize_t sent = send(fd, bytes, length, flags | MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno == EINTR) continue;
+            return -1;  // EAGAIN here is the send timeout
+        }
+        bytes += sent;
+        length -= (size_t)sent;
+    }
+    return 0;
+}
+
+static void close_client(RodStream* stream, StreamClient* client) {
+    if (client->state == CLIENT_FREE) return;
+    if (client->state == CLIENT_STREAMING) {
+        atomic_fetch_sub(&stream->streaming_clients, 1);
+    }
+    close(client->fd);
+    client->fd = -1;
+    client->state = CLIENT_FREE;
+    client->request_length = 0;
+}
+
+static void accept_client(RodStream* stream) {
+    int fd = accept4(stream->listen_fd, NULL, NULL, SOCK_CLOEXEC);
+    if (fd < 0) return;
+
+    StreamClient* client = NULL;
+    for (int i = 0; i < ROD_STREAM_MAX_CLIENTS; i++) {
+        if (stream->clients[i].state == CLIENT_FREE) {
+            client = &stream->clients[i];
+            break;
+        }
+    }
+    if (!client) {
+        close(fd);
+        return;
+    }
+
+    // A client that stops reading is dropped instead of blocking the stream thread
+    struct timeval timeout = {ROD_STREAM_SEND_TIMEOUT_MS / 1000, (ROD_STREAM_SEND_TIMEOUT_MS % 1000) * 1000};
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+    client->fd = fd;
+    client->state = CLIENT_REQUEST;
+    client->request_length = 0;
+}
+
+/**
+ * @brief Read the request of a client (or notice a streaming client left), then answer it
+ */
+static void handle_client_input(RodStream* stream, StreamClient* client) {
+    if (client->state == CLIENT_STREAMING) {
+        // Nothing is expected from a streaming client: data is ignored, 0 means it left
+        char discard[256];
+        ssize_t received = recv(client->fd, discard, sizeof(discard), MSG_DONTWAIT);
+        if (received == 0 || (received < 0 && errno != EAGAIN && errno != EINTR)) {
+            close_client(stream, client);
+            printf("rod_stream: Client disconnected (%d watching)\n", atomic_load(&stream->streaming_clients));
+        }
+        return;
+    }
+
+    size_t room = sizeof(client->request) - 1 - client->request_length;
+    ssize_t received = recv(client->fd, client->request + client->request_length, room, MSG_DONTWAIT);
+    if (received <= 0) {
+        if (received == 0 || (errno != EAGAIN && errno != EINTR)) close_client(stream, client);
+        return;
+    }
+    client->request_length += (size_t)received;
+    client->request[client->request_length] = '\0';
+
+    // Only the request line matters: wait for the end of the headers (or a full buffer)
+    if (!strstr(client->request, "\r\n\r\n") && client->request_length < sizeof(client->request) - 1) return;
+
+    if (strncmp(client->request, "GET /video_feed ", 16) == 0) {
+        if (send_all(client->fd, STREAM_RESPONSE, sizeof(STREAM_RESPONSE) - 1, 0) != 0) {
+            close_client(stream, client);
+            return;
+        }
+        client->state = CLIENT_STREAMING;
+        atomic_fetch_add(&stream->streaming_clients, 1);
+        printf("rod_stream: Client connected (%d watching)\n", atomic_load(&stream->streaming_clients));
+        return;
+    }
+
+    if (strncmp(client->request, "GET / ", 6) == 0) {
+        send_all(client->fd, PAGE_RESPONSE, sizeof(PAGE_RESPONSE) - 1, 0);
+    } else {
+        send_all(client->fd, NOT_FOUND_RESPONSE, sizeof(NOT_FOUND_RESPONSE) - 1, 0);
+    }
+    close_client(stream, client);
+}
+
+/**
+ * @brief Encode a frame once and send it to every streaming client
+ */
+static void send_frame(RodStream* stream, ImageHandle* image) {
+    size_t size = 0;
+    const uint8_t* jpeg = rod_jpeg_encoder_encode(stream->encoder, image, stream->convert_to_rgb, &size);
+    atomic_store(&stream->hardware, rod_jpeg_encoder_is_hardware(stream->encoder));
+    if (!jpeg) return;
+
+    char header[128];
+    int header_length = snprintf(header, sizeof(header),
+                                 "--" BOUNDARY "\r\nContent-Type: image/jpeg\r\nContent-Length: %zu\r\n\r\n", size);
+
+    for (int i = 0; i < ROD_STREAM_MAX_CLIENTS; i++) {
+        StreamClient* client = &stream->clients[i];
+        if (client->state != CLIENT_STREAMING) continue;
+        if (send_all(client->fd, header, (size_t)header_length, MSG_MORE) != 0 ||
+            send_all(client->fd, jpeg, size, MSG_MORE) != 0 ||
+            send_all(client->fd, "\r\n", 2, 0) != 0) {
+            close_client(stream, client);
+            printf("rod_stream: Client disconnected (%d watching)\n", atomic_load(&stream->streaming_clients));
+        }
+    }
+    atomic_fetch_add(&stream->frames_sent, 1);
+}
+
+static void* stream_thread_main(void* arg) {
+    RodStream* stream = (RodStream*)arg;
+    struct pollfd fds[2 + ROD_STREAM_MAX_CLIENTS];
+    StreamClient* polled[ROD_STREAM_MAX_CLIENTS];
+
+    while (!atomic_load(&stream->stop)) {
+        fds[0].fd = stream->listen_fd;
+        fds[0].events = POLLIN;
+        fds[1].fd = stream->wake_pipe[0];
+        fds[1].events = POLLIN;
+        int count = 2;
+        for (int i = 0; i < ROD_STREAM_MAX_CLIENTS; i++) {
+            if (stream->clients[i].state == CLIENT_FREE) continue;
+            polled[count - 2] = &stream->clients[i];
+            fds[count].fd = stream->clients[i].fd;
+            fds[count].events = POLLIN;
+            count++;
+        }
+        for (int i = 0; i < count; i++) {
+            fds[i].revents = 0;
+        }
+
+        if (poll(fds, (nfds_t)count, -1) < 0) {
+            if (errno == EINTR) continue;
+            fprintf(stderr, "rod_stream: poll failed: %s\n", strerror(errno));
+            break;
+        }
+
+        if (fds[1].revents & POLLIN) {
+            char drain[64];
+            while (read(stream->wake_pipe[0], drain, sizeof(drain)) > 0) {
+            }
+        }
+        for (int i = 2; i < count; i++) {
+            if (fds[i].revents & (POLLIN | POLLHUP | POLLERR)) handle_client_input(stream, polled[i - 2]);
+        }
+        if (fds[0].revents & POLLIN) accept_client(stream);
+
+        pthread_mutex_lock(&stream->lock);
+        ImageHandle* image = stream->pending;
+        stream->pending = NULL;
+        pthread_mutex_unlock(&stream->lock);
+
+        if (image) {
+            if (atomic_load(&stream->streaming_clients) > 0) send_frame(stream, image);
+            release_image(image);
+        }
+    }
+
+    for (int i = 0; i < ROD_STREAM_MAX_CLIENTS; i++) {
+        close_client(stream, &stream->clients[i]);
+    }
+    return NULL;
+}
+
+static int create_listen_socket(int port) {
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+    if (fd < 0) {
+        fprintf(stderr, "rod_stream: Failed to create socket: %s\n", strerror(errno));
+        return -1;
+    }
+
+    int reuse = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons((uint16_t)port);
+    if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+        fprintf(stderr, "rod_stream: Failed to bind port %d: %s\n", port, strerror(errno));
+        close(fd);
+        return -1;
+    }
+    if (listen(fd, ROD_STREAM_MAX_CLIENTS) < 0) {
+        fprintf(stderr, "rod_stream: Failed to listen: %s\n", strerror(errno));
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+RodStream* rod_stream_create(int port, int max_fps, int jpeg_quality, const char* encoder_device, bool convert_to_rgb) {
+    if (port < 0 || port > 65535 || max_fps <= 0) {
+        fprintf(stderr, "rod_stream: Invalid parameters\n");
+        return NULL;
+    }
+
+    RodStream* stream = (RodStream*)calloc(1, sizeof(RodStream));
+    if (!stream) {
+        fprintf(stderr, "rod_stream: Failed to allocate stream\n");
+        return NULL;
+    }
+    stream->listen_fd = -1;
+    stream->wake_pipe[0] = -1;
+    stream->wake_pipe[1] = -1;
+    stream->convert_to_rgb = convert_to_rgb;
+    stream->min_interval_us = 1000000ULL / (uint64_t)max_fps;
+    for (int i = 0; i < ROD_STREAM_MAX_CLIENTS; i++) {
+        stream->clients[i].fd = -1;
+        stream->clients[i].state = CLIENT_FREE;
+    }
+    atomic_init(&stream->stop, false);
+    atomic_init(&stream->streaming_clients, 0);
+    atomic_init(&stream->last_tap_us, 0);
+    atomic_init(&stream->frames_sent, 0);
+    atomic_init(&stream->frames_skipped, 0);
+    atomic_init(&stream->hardware, false);
+    pthread_mutex_init(&stream->lock, NULL);
+
+    stream->encoder = rod_jpeg_encoder_create(encoder_device, jpeg_quality);
+    if (!stream->encoder) goto fail;
+    atomic_store(&stream->hardware, rod_jpeg_encoder_is_hardware(stream->encoder));
+
+    stream->listen_fd = create_listen_socket(port);
+    if (stream->listen_fd < 0) goto fail;
+
+    if (pipe2(stream->wake_pipe, O_CLOEXEC | O_NONBLOCK) != 0) {
+        fprintf(stderr, "rod_stream: Failed to create wake pipe: %s\n", strerror(errno));
+        goto fail;
+    }
+
+    if (pthread_create(&stream->thread, NULL, stream_thread_main, stream) != 0) {
+        fprintf(stderr, "rod_stream: Failed to start stream thread\n");
+        goto fail;
+    }
+
+    printf("rod_stream: Serving http://0.0.0.0:%d/ (%d fps max, %s JPEG encoder)\n", rod_stream_get_port(stream),
+           max_fps, rod_jpeg_encoder_is_hardware(stream->encoder) ? "hardware" : "software");
+    return stream;
+
+fail:
+    if (stream->wake_pipe[0] >= 0) close(stream->wake_pipe[0]);
+    if (stream->wake_pipe[1] >= 0) close(stream->wake_pipe[1]);
+    if (stream->listen_fd >= 0) close(stream->listen_fd);
+    rod_jpeg_encoder_destroy(stream->encoder);
+    pthread_mutex_destroy(&stream->lock);
+    free(stream);
+    return NULL;
+}
+
+static void wake(RodStream* stream) {
+    // A full pipe already holds a wake up
+    ssize_t written = write(stream->wake_pipe[1], "w", 1);
+    (void)written;
+}
+
+void rod_stream_destroy(RodStream* stream) {
+    if (!stream) return;
+
+    atomic_store(&stream->stop, true);
+    wake(stream);
+    pthread_join(stream->thread, NULL);
+
+    release_image(stream->pending);
+    close(stream->wake_pipe[0]);
+    close(stream->wake_pipe[1]);
+    close(stream->listen_fd);
+    rod_jpeg_encoder_destroy(stream->encoder);
+    pthread_mutex_destroy(&stream->lock);
+    free(stream);
+}
+
+bool rod_stream_wants_frame(RodStream* stream, uint64_t timestamp_us) {
+    if (!stream || atomic_load(&stream->streaming_clients) == 0) return false;
+
+    uint_fast64_t last = atomic_load(&stream->last_tap_us);
+    if (last != 0 && timestamp_us >= last && timestamp_us - last < stream->min_interval_us) return false;
+
+    // Reserve the frame (another thread asking for the same period gets false)
+    return atomic_compare_exchange_strong(&stream->last_tap_us, &last, timestamp_us);
+}
+
+void rod_stream_submit(RodStream* stream, ImageHandle* image) {
+    if (!stream || !image) {
+        release_image(image);
+        return;
+    }
+
+    pthread_mutex_lock(&stream->lock);
+    ImageHandle* replaced = stream->pending;
+    stream->pending = image;
+    pthread_mutex_unlock(&stream->lock);
+
+    if (replaced) {
+        atomic_fetch_add(&stream->frames_skipped, 1);
+        release_image(replaced);
+    }
+    wake(stream);
+}
+
+int rod_stream_get_port(RodStream* stream) {
+    if (!stream) return -1;
+
+    struct sockaddr_in addr;
+    socklen_t length = sizeof(addr);
+    if (getsockname(stream->listen_fd, (struct sockaddr*)&addr, &length) != 0) return -1;
+    return ntohs(addr.sin_port);
+}
+
+void rod_stream_get_stats(RodStream* stream, RodStreamStats* stats) {
+    if (!stats) return;
+    memset(stats, 0, sizeof(RodStreamStats));
+    if (!stream) return;
+
+    stats->clients = atomic_load(&stream->streaming_clients);
+    stats->frames_sent = atomic_load(&stream->frames_sent);
+    stats->frames_skipped = atomic_load(&stream->frames_skipped);
+    stats->hardware = atomic_load(&stream->hardware);
+}
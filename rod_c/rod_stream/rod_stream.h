@@ -0,0 +1,98 @@
+/**
+ * @file rod_stream.h
+ * @brief Live MJPEG stream of the annotated preview over HTTP for ROD
+ * @author Noé Game
+ * @date 14/10/2026
+ * @see rod_stream.c
+ * @copyright Cecill-C (Cf. LICENCE.txt)
+ *
+ * rod_detection serves its own annotated preview, so operators watch the field
+ * without a second camera consumer (tools/stream.py) or disk writes:
+ * - Same URLs as tools/stream.py: "/" (page) and "/video_feed"
+ *   (multipart/x-mixed-replace, one JPEG per part, any browser or VLC)
+ * - Frame tap: rod_stream_wants_frame() is false when nobody watches or the
+ *   last frame is too recent, so the pipeline renders nothing in that case
+ * - One pending frame (the newest replaces an older one), encoded and sent on
+ *   the stream thread (hardware JPEG encoder when available, rod_jpeg_encoder.h)
+ * - A client that cannot keep up is disconnected, it never slows the others
+ */
+
+#pragma once
+
+/* ******************************************************* Includes ****************************************************** */
+
+#include "opencv_wrapper.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+/* ***************************************************** Public macros *************************************************** */
+
+#define ROD_STREAM_MAX_CLIENTS 8        // Connections served at once (others are refused)
+#define ROD_STREAM_SEND_TIMEOUT_MS 200  // A client not accepting a frame within this is disconnected
+
+/* ************************************************** Public types definition ******************************************** */
+
+/**
+ * @brief Opaque stream server
+ */
+typedef struct RodStream RodStream;
+
+/**
+ * @brief Stream counters
+ */
+typedef struct {
+    int clients;         // Clients receiving the stream
+    int frames_sent;     // Frames encoded and sent
+    int frames_skipped;  // Submitted frames replaced by a newer one before being encoded
+    bool hardware;       // Frames encoded by the hardware encoder
+} RodStreamStats;
+
+/* *********************************************** Public functions declarations ***************************************** */
+
+/**
+ * @brief Create a stream server and start its thread
+ * @param port TCP port (0 = any free port, see rod_stream_get_port())
+ * @param max_fps Largest frame rate sent to clients
+ * @param jpeg_quality JPEG quality, 1 to 100
+ * @param encoder_device V4L2 M2M JPEG encoder (NULL or "" = software encoding)
+ * @param convert_to_rgb Swap red and blue before encoding (as rod_writer_submit())
+ * @return Stream server, or NULL on failure
+ */
+RodStream* rod_stream_create(int port, int max_fps, int jpeg_quality, const char* encoder_device, bool convert_to_rgb);
+
+/**
+ * @brief Disconnect every client, stop the thread and free the server
+ * @param stream Stream server (NULL is ignored)
+ */
+void rod_stream_destroy(RodStream* stream);
+
+/**
+ * @brief Frame tap: check whether a frame should be rendered for the stream
+ * @param stream Stream server (NULL = never)
+ * @param timestamp_us Current time in microseconds
+ * @return true if a client is connected and the last tapped frame is older than 1 / max_fps
+ *
+ * A true result reserves the frame: the caller then submits it (or not).
+ */
+bool rod_stream_wants_frame(RodStream* stream, uint64_t timestamp_us);
+
+/**
+ * @brief Queue a frame to be encoded and sent to every client
+ * @param stream Stream server
+ * @param image BGR image, ownership is always transferred (released by the stream)
+ */
+void rod_stream_submit(RodStream* stream, ImageHandle* image);
+
+/**
+ * @brief Get the TCP port the server listens on
+ * @param stream Stream server
+ * @return Port, -1 on error
+ */
+int rod_stream_get_port(RodStream* stream);
+
+/**
+ * @brief Get stream counters
+ * @param stream Stream server
+ * @param stats Output counters
+ */
+void rod_stream_get_stats(RodStream* stream, RodStreamStats* stats);
@@ -19,6 +19,8 @@
 
 /* ***************************************************** Public macros *************************************************** */
 
+#define RENDER_QUAD_THICKNESS 2  // Quadrilateral thickness on the preview
+
 /* ************************************************** Public types definition ******************************************** */
 
 /* *********************************************** Public functions declarations ***************************************** */
@@ -95,46 +97,124 @@ void rod_viz_annotate_with_full_info(ImageHandle* image, MarkerData* markers, in
     }
 }
 
+/**
+ * @brief Outline color of a marker (BGR format)
+ */
+static Color quadrilateral_color(int id) {
+    Color blue = {255, 0, 0};      // Blue for ID 36
+    Color black = {0, 0, 0};       // Black for ID 41
+    Color green = {0, 255, 0};     // Green for ID 20-23
+    Color yellow = {0, 255, 255};  // Yellow for ID 47
+    
+    if (id == 36) {
+        // Blue box gets blue outline
+        return blue;
+    } else if (id == 47) {
+        // Yellow box (47) gets yellow outline
+        return yellow;
+    } else if (id == 41) {
+        // Empty box gets black outline
+        return black;
+    }
+    // Fixed field markers get green outline, and so does any other marker
+    return green;
+}
+
 void rod_viz_annotate_with_colored_quadrilaterals(ImageHandle* image, DetectionResult* detection) {
     if (!image || !detection) {
         return;
     }
     
-    // Define colors (BGR format)
-    Color blue = {255, 0, 0};    // Blue for ID 36
-    Color black = {0, 0, 0};     // Black for ID 41
-    Color green = {0, 255, 0};   // Green for ID 20-23
-    Color yellow = {0, 255, 255};  // Yellow for ID 47
-    
     int thickness = 3;
     
     for (int i = 0; i < detection->count; i++) {
         DetectedMarker* marker = &detection->markers[i];
-        int id = marker->id;
-        
-        // Select color based on marker ID
-        Color* color = NULL;
-        if (id == 36) {
-            // Blue box (36) and Yellow box (47) get blue outline
-            color = &blue;
-        } else if (id == 47) {
-            // Yellow box (47) gets yellow outline
-            color = &yellow;
-        } else if (id == 41) {
-            // Empty box gets black outline
-            color = &black;
-        } else if (id >= 20 && id <= 23) {
-            // Fixed field markers get green outline
-            color = &green;
-        } else {
-            color = &green;  // Default to green for any other markers (optional)
+        draw_polyline(image, marker->corners, quadrilateral_color(marker->id), thickness);
+    }
+}
+
+/**
+ * @brief Detection of the same ID nearest to a marker center, through the ID index
+ * @return Detection index, -1 if none
+ */
+static int find_detection(const DetectionResult* detection, const int* first, const int* next, const MarkerData* marker) {
+    if (marker->id < 0 || marker->id >= ROD_VIZ_MAX_INDEXED_ID) return -1;
+    
+    int best = -1;
+    float best_distance = 0.0f;
+    for (int j = first[marker->id]; j >= 0; j = next[j]) {
+        const DetectedMarker* candidate = &detection->markers[j];
+        float cx = (candidate->corners[0][0] + candidate->corners[1][0] + candidate->corners[2][0] + candidate->corners[3][0]) / 4.0f;
+        float cy = (candidate->corners[0][1] + candidate->corners[1][1] + candidate->corners[2][1] + candidate->corners[3][1]) / 4.0f;
+        float distance = (cx - marker->pixel_x) * (cx - marker->pixel_x) + (cy - marker->pixel_y) * (cy - marker->pixel_y);
+        if (best < 0 || distance < best_distance) {
+            best = j;
+            best_distance = distance;
         }
+    }
+    return best;
+}
+
+ImageHandle* rod_viz_render_debug(ImageHandle* source, float source_scale, float preview_scale,
+                                  const DetectionResult* detection, const MarkerData* markers, int count,
+                                  MarkerCounts counts, ImageHandle* canvas) {
+    if (!source || source_scale <= 0.0f || preview_scale <= 0.0f || preview_scale > 1.0f ||
+        count < 0 || (count > 0 && !markers)) {
+        return NULL;
+    }
+    
+    int width = (int)((float)get_image_width(source) * preview_scale + 0.5f);
+    int height = (int)((float)get_image_height(source) * preview_scale + 0.5f);
+    ImageHandle* preview = resize_to_bgr_reuse(source, width > 0 ? width : 1, height > 0 ? height : 1, canvas);
+    if (!preview) {
+        fprintf(stderr, "rod_viz_render_debug: Failed to create preview\n");
+        return NULL;
+    }
+    
+    // ID index, built once: first detection of each ID, chained to the next one of the same ID
+    int first[ROD_VIZ_MAX_INDEXED_ID];
+    int next[ROD_VIZ_MAX_INDEXED_DETECTIONS];
+    for (int id = 0; id < ROD_VIZ_MAX_INDEXED_ID; id++) {
+        first[id] = -1;
+    }
+    int detection_count = detection ? detection->count : 0;
+    if (detection_count > ROD_VIZ_MAX_INDEXED_DETECTIONS) detection_count = ROD_VIZ_MAX_INDEXED_DETECTIONS;
+    for (int j = detection_count - 1; j >= 0; j--) {
+        int id = detection->markers[j].id;
+        if (id < 0 || id >= ROD_VIZ_MAX_INDEXED_ID) continue;
+        next[j] = first[id];
+        first[id] = j;
+    }
+    
+    // One pass over the markers: quadrilateral, then its text on top
+    float scale = source_scale * preview_scale;  // Frame pixels -> preview pixels
+    Color black = {0, 0, 0};
+    Color green = {0, 255, 0};
+    double font_scale = 0.6;
+    for (int i = 0; i < count; i++) {
+        const MarkerData* marker = &markers[i];
         
-        // Draw quadrilateral if color was selected
-        if (color) {
-            draw_polyline(image, marker->corners, *color, thickness);
+        int j = detection_count > 0 ? find_detection(detection, first, next, marker) : -1;
+        if (j >= 0) {
+            float corners[4][2];
+            for (int k = 0; k < 4; k++) {
+                corners[k][0] = detection->markers[j].corners[k][0] * scale;
+                corners[k][1] = detection->markers[j].corners[k][1] * scale;
+            }
+            draw_polyline(preview, corners, quadrilateral_color(marker->id), RENDER_QUAD_THICKNESS);
         }
+        
+        // Same text as rod_viz_annotate_with_full_info()
+        char text[128];
+        snprintf(text, sizeof(text), "%d, %d, %d, %.2f", marker->id, (int)marker->x, (int)marker->y, marker->angle);
+        int x = (int)(marker->pixel_x * scale);
+        int y = (int)(marker->pixel_y * scale);
+        put_text(preview, text, x, y, font_scale, black, 3);
+        put_text(preview, text, x, y, font_scale, green, 2);
     }
+    
+    rod_viz_annotate_with_counter(preview, counts);
+    return preview;
 }
 
 void rod_viz_annotate_with_counter(ImageHandle* image, MarkerCounts counts) {
@@ -196,44 +276,14 @@ int rod_viz_save_debug_image(ImageHandle* image, MarkerData* markers, int count,
         return -1;
     }
     
-    // Create a copy of the image by extracting its data
-    int width = get_image_width(image);
-    int height = get_image_height(image);
-    int channels = get_image_channels(image);
-    uint8_t* data = get_image_data(image);
-    size_t data_size = get_image_data_size(image);
-    
-    if (!data || data_size == 0) {
-        fprintf(stderr, "Failed to get image data for debug output\n");
-        return -1;
-    }
-    
-    // Create a copy of the data
-    uint8_t* data_copy = (uint8_t*)malloc(data_size);
-    if (!data_copy) {
-        fprintf(stderr, "Failed to allocate memory for image copy\n");
-        return -1;
-    }
-    memcpy(data_copy, data, data_size);
-    
-    // Create new image from the copy (format=0 for BGR)
-    ImageHandle* annotated = create_image_from_buffer(data_copy, width, height, channels, 0);
-    free(data_copy);  // Buffer is copied by create_image_from_buffer
-    
+    // Annotated copy (one copy of the pixels): counter and full marker info (ID, x, y, angle)
+    MarkerCounts marker_counts = count_markers_by_category(markers, count);
+    ImageHandle* annotated = rod_viz_render_debug(image, 1.0f, 1.0f, NULL, markers, count, marker_counts, NULL);
     if (!annotated) {
         fprintf(stderr, "Failed to create image copy for debug output\n");
         return -1;
     }
     
-    // Count markers by category
-    MarkerCounts marker_counts = count_markers_by_category(markers, count);
-    
-    // Annotate the copied image with counter and full marker info (ID, x, y, angle)
-    rod_viz_annotate_with_counter(annotated, marker_counts);
-    if (count > 0) {
-        rod_viz_annotate_with_full_info(annotated, markers, count);
-    }
-    
     // Generate timestamp for filename
     char timestamp[32];
     rod_config_generate_filename_timestamp(timestamp, sizeof(timestamp));
@@ -21,6 +21,9 @@
 
 /* ***************************************************** Public macros *************************************************** */
 
+#define ROD_VIZ_MAX_INDEXED_ID 64          // Marker IDs found by rod_viz_render_debug() (valid IDs are below)
+#define ROD_VIZ_MAX_INDEXED_DETECTIONS 256 // Detections indexed per render
+
 /* ************************************************** Public types definition ******************************************** */
 
 /* *********************************************** Public functions declarations ***************************************** */
@@ -71,6 +74,27 @@ void rod_viz_annotate_with_full_info(ImageHandle* image, MarkerData* markers, in
  */
 void rod_viz_annotate_with_colored_quadrilaterals(ImageHandle* image, DetectionResult* detection);
 
+/**
+ * @brief Render every debug overlay in one pass onto a downscaled preview
+ * @param source Source image (BGR or gray), e.g. the raw frame or the camera preview
+ * @param source_scale Source size / frame size (detection and marker pixels are frame pixels)
+ * @param preview_scale Preview size / source size, 0 < preview_scale <= 1 (e.g. 0.25)
+ * @param detection Detection result holding the marker corners (may be NULL: no quadrilaterals)
+ * @param markers Markers to annotate (colored quadrilateral + "ID, x, y, angle")
+ * @param count Number of markers
+ * @param counts Marker counts drawn in the top-left corner
+ * @param canvas Image to reuse (e.g. the previous preview, NULL = allocate)
+ * @return BGR preview (canvas when reused), NULL on failure
+ *
+ * The source pixels are copied once, straight to the preview size (gray sources
+ * are expanded to BGR after the resize). Corners are found through an ID index
+ * built once per call (nearest detection of the same ID to the marker center),
+ * instead of a search of the detection per marker.
+ */
+ImageHandle* rod_viz_render_debug(ImageHandle* source, float source_scale, float preview_scale,
+                                  const DetectionResult* detection, const MarkerData* markers, int count,
+                                  MarkerCounts counts, ImageHandle* canvas);
+
 /**
  * @brief Annotate image with categorized marker counts
  * @param image Image handle (will be modified in place)
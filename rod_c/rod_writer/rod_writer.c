@@ -0,0 +1,237 @@
+/**
+ * @file rod_writer.c
+ * @brief Asynchronous image writer for ROD system
+ * @author Noé Game
+ * @date 14/10/2026
+ * @see rod_writer.h
+ * @copyright Cecill-C (Cf. LICENCE.txt)
+ */
+
+/* ******************************************************* Includes ****************************************************** */
+
+#include "rod_writer.h"
+#include "rod_frame_queue.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <pthread.h>
+
+/* ***************************************************** Public macros *************************************************** */
+
+#define ROD_WRITER_PATH_SIZE 512
+
+/* ************************************************** Public types definition ******************************************** */
+
+/**
+ * @brief One pending image
+ */
+typedef struct {
+    char path[ROD_WRITER_PATH_SIZE];
+    ImageHandle* image;
+    bool convert_to_rgb;
+    int jpeg_quality;            // <= 0 = save_image() default
+    RodSessionWriter* session;   // Not NULL: append image to this session instead of writing path
+    RodSessionFrame meta;        // Session frame metadata
+} RodWriterJob;
+
+/**
+ * @brief Writer context structure
+ */
+struct RodWriter {
+    RodFrameQueue* queue;         // Pending RodWriterJob*
+    RodWriterDropPolicy policy;
+    pthread_t thread;
+    atomic_int written;
+    atomic_int dropped;
+    atomic_int failed;
+};
+
+/* *********************************************** Public functions declarations ***************************************** */
+
+/* ******************************************* Public callback functions declarations ************************************ */
+
+/* ********************************************* Function implementations *********************************************** */
+
+static void free_job(RodWriterJob* job) {
+    if (!job) return;
+    release_image(job->image);
+    free(job);
+}
+
+/**
+ * @brief Encode and write one job
+ */
+static void write_job(RodWriter* writer, RodWriterJob* job) {
+    if (job->session) {
+        job->meta.width = get_image_width(job->image);
+        job->meta.height = get_image_height(job->image);
+        job->meta.channels = get_image_channels(job->image);
+        job->meta.stride = (size_t)job->meta.width * (size_t)job->meta.channels;
+        job->meta.data = get_image_data(job->image);
+        if (rod_session_writer_append(job->session, &job->meta) == 0) {
+            atomic_fetch_add(&writer->written, 1);
+        } else {
+            atomic_fetch_add(&writer->failed, 1);
+        }
+        return;
+    }
+    
+    ImageHandle* output = job->image;
+    ImageHandle* converted = NULL;
+    
+    if (job->convert_to_rgb) {
+        converted = convert_bgr_to_rgb(job->image);
+        if (converted) output = converted;
+    }
+    
+    if (save_image_with_quality(job->path, output, job->jpeg_quality)) {
+        atomic_fetch_add(&writer->written, 1);
+    } else {
+        atomic_fetch_add(&writer->failed, 1);
+    }
+    
+    release_image(converted);
+}
+
+/**
+ * @brief Writer thread: write jobs until the queue is closed and drained
+ */
+static void* writer_thread_main(void* arg) {
+    RodWriter* writer = (RodWriter*)arg;
+    
+    for (;;) {
+        RodWriterJob* job = (RodWriterJob*)rod_frame_queue_pop(writer->queue, -1);
+        if (!job) break;  // Closed and empty
+        
+        write_job(writer, job);
+        free_job(job);
+    }
+    
+    return NULL;
+}
+
+RodWriter* rod_writer_create(int capacity, RodWriterDropPolicy policy) {
+    RodWriter* writer = (RodWriter*)calloc(1, sizeof(RodWriter));
+    if (!writer) {
+        fprintf(stderr, "rod_writer: Failed to allocate writer context\n");
+        return NULL;
+    }
+    
+    writer->queue = rod_frame_queue_create(capacity);
+    if (!writer->queue) {
+        free(writer);
+        return NULL;
+    }
+    writer->policy = policy;
+    atomic_init(&writer->written, 0);
+    atomic_init(&writer->dropped, 0);
+    atomic_init(&writer->failed, 0);
+    
+    if (pthread_create(&writer->thread, NULL, writer_thread_main, writer) != 0) {
+        fprintf(stderr, "rod_writer: Failed to start writer thread\n");
+        rod_frame_queue_destroy(writer->queue);
+        free(writer);
+        return NULL;
+    }
+    
+    return writer;
+}
+
+void rod_writer_destroy(RodWriter* writer) {
+    if (!writer) return;
+    
+    // Pending images are still written before the thread exits
+    rod_frame_queue_close(writer->queue);
+    pthread_join(writer->thread, NULL);
+    rod_frame_queue_destroy(writer->queue);
+    free(writer);
+}
+
+bool rod_writer_submit(RodWriter* writer, const char* path, ImageHandle* image, bool convert_to_rgb) {
+    return rod_writer_submit_with_quality(writer, path, image, convert_to_rgb, 0);
+}
+
+/**
+ * @brief Queue a job according to the drop policy
+ * @return true if queued, false if dropped (job freed)
+ */
+static bool push_job(RodWriter* writer, RodWriterJob* job) {
+    int result;
+    if (writer->policy == ROD_WRITER_DROP_OLDEST) {
+        void* evicted = NULL;
+        result = rod_frame_queue_push_drop_oldest(writer->queue, job, &evicted);
+        if (evicted) {
+            atomic_fetch_add(&writer->dropped, 1);
+            free_job((RodWriterJob*)evicted);
+        }
+    } else if (writer->policy == ROD_WRITER_BLOCK) {
+        result = rod_frame_queue_push(writer->queue, job);
+    } else {
+        result = rod_frame_queue_try_push(writer->queue, job);
+    }
+    
+    if (result != 0) {
+        atomic_fetch_add(&writer->dropped, 1);
+        free_job(job);
+        return false;
+    }
+    
+    return true;
+}
+
+bool rod_writer_submit_with_quality(RodWriter* writer, const char* path, ImageHandle* image,
+                                    bool convert_to_rgb, int jpeg_quality) {
+    if (!writer || !path || !image) {
+        release_image(image);
+        return false;
+    }
+    
+    RodWriterJob* job = (RodWriterJob*)malloc(sizeof(RodWriterJob));
+    if (!job) {
+        fprintf(stderr, "rod_writer: Failed to allocate job\n");
+        release_image(image);
+        return false;
+    }
+    snprintf(job->path, sizeof(job->path), "%s", path);
+    job->image = image;
+    job->convert_to_rgb = convert_to_rgb;
+    job->jpeg_quality = jpeg_quality;
+    job->session = NULL;
+    
+    return push_job(writer, job);
+}
+
+bool rod_writer_submit_session_frame(RodWriter* writer, RodSessionWriter* session, ImageHandle* image,
+                                     const RodSessionFrame* meta) {
+    if (!writer || !session || !image || !meta) {
+        release_image(image);
+        return false;
+    }
+    
+    RodWriterJob* job = (RodWriterJob*)malloc(sizeof(RodWriterJob));
+    if (!job) {
+        fprintf(stderr, "rod_writer: Failed to allocate job\n");
+        release_image(image);
+        return false;
+    }
+    job->path[0] = '\0';
+    job->image = image;
+    job->convert_to_rgb = false;
+    job->jpeg_quality = 0;
+    job->session = session;
+    job->meta = *meta;
+    
+    return push_job(writer, job);
+}
+
+void rod_writer_get_stats(RodWriter* writer, RodWriterStats* stats) {
+    if (!stats) return;
+    memset(stats, 0, sizeof(RodWriterStats));
+    if (!writer) return;
+    
+    stats->queue_depth = rod_frame_queue_depth(writer->queue);
+    stats->written = atomic_load(&writer->written);
+    stats->dropped = atomic_load(&writer->dropped);
+    stats->failed = atomic_load(&writer->failed);
+}
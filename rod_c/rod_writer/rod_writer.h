@@ -0,0 +1,109 @@
+/**
+ * @file rod_writer.h
+ * @brief Asynchronous image writer for ROD system
+ * @author Noé Game
+ * @date 14/10/2026
+ * @see rod_writer.c
+ * @copyright Cecill-C (Cf. LICENCE.txt)
+ * 
+ * This module encodes and writes images on a background thread so that
+ * detection latency never depends on JPEG encoding or SD card speed:
+ * - Bounded job queue (memory use is capped)
+ * - Configurable drop policy when the disk cannot keep up
+ * - Queue depth / written / dropped counters
+ *
+ * Frames of a recorded session (rod_session.h) go through the same queue:
+ * their pixels are appended as they are, nothing is encoded.
+ */
+
+#pragma once
+
+/* ******************************************************* Includes ****************************************************** */
+
+#include "opencv_wrapper.h"
+#include "rod_session.h"
+#include <stdbool.h>
+
+/* ***************************************************** Public macros *************************************************** */
+
+/* ************************************************** Public types definition ******************************************** */
+
+/**
+ * @brief Behavior of rod_writer_submit() when the queue is full
+ */
+typedef enum {
+    ROD_WRITER_DROP_NEWEST,  // Reject the submitted image (keeps the backlog in order)
+    ROD_WRITER_DROP_OLDEST,  // Evict the oldest pending image (keeps the most recent ones)
+    ROD_WRITER_BLOCK         // Wait for room (disk speed leaks into the caller, debug only)
+} RodWriterDropPolicy;
+
+/**
+ * @brief Writer counters
+ */
+typedef struct {
+    int queue_depth;   // Images waiting to be written
+    int written;       // Images successfully written
+    int dropped;       // Images discarded by the drop policy
+    int failed;        // Images that could not be written
+} RodWriterStats;
+
+/**
+ * @brief Opaque writer context
+ */
+typedef struct RodWriter RodWriter;
+
+/* *********************************************** Public functions declarations ***************************************** */
+
+/**
+ * @brief Create a writer and start its background thread
+ * @param capacity Maximum number of pending images
+ * @param policy Drop policy applied when the queue is full
+ * @return Writer context, or NULL on failure
+ */
+RodWriter* rod_writer_create(int capacity, RodWriterDropPolicy policy);
+
+/**
+ * @brief Write all pending images, stop the thread and free the writer
+ * @param writer Writer context
+ */
+void rod_writer_destroy(RodWriter* writer);
+
+/**
+ * @brief Queue an image to be written
+ * @param writer Writer context
+ * @param path Output file path (format from extension, see save_image())
+ * @param image Image to write, ownership is always transferred (released by the writer, even on drop)
+ * @param convert_to_rgb Convert BGR to RGB before encoding (done on the writer thread)
+ * @return true if queued, false if dropped or on error
+ */
+bool rod_writer_submit(RodWriter* writer, const char* path, ImageHandle* image, bool convert_to_rgb);
+
+/**
+ * @brief Queue an image to be written with a JPEG quality
+ * @param writer Writer context
+ * @param path Output file path (format from extension, see save_image_with_quality())
+ * @param image Image to write, ownership is always transferred (released by the writer, even on drop)
+ * @param convert_to_rgb Convert BGR to RGB before encoding (done on the writer thread)
+ * @param jpeg_quality JPEG quality 1-100 (<= 0 = default, as rod_writer_submit())
+ * @return true if queued, false if dropped or on error
+ */
+bool rod_writer_submit_with_quality(RodWriter* writer, const char* path, ImageHandle* image,
+                                    bool convert_to_rgb, int jpeg_quality);
+
+/**
+ * @brief Queue a frame to be appended to a recorded session
+ * @param writer Writer context
+ * @param session Session file, owned by the caller and closed after rod_writer_destroy()
+ * @param image Continuous image (clone_image()), 1 or 3 channels, ownership is always transferred
+ * @param meta Frame metadata (sequence, timestamp, controls, detections), copied; size and data come from image
+ * @return true if queued, false if dropped or on error (the frame is missing from the session)
+ */
+bool rod_writer_submit_session_frame(RodWriter* writer, RodSessionWriter* session, ImageHandle* image,
+                                     const RodSessionFrame* meta);
+
+/**
+ * @brief Get writer counters
+ * @param writer Writer context
+ * @param stats Output counters
+ */
+void rod_writer_get_stats(RodWriter* writer, RodWriterStats* stats);
@@ -18,6 +18,7 @@
 #include "rod_cv.h"
 #include "rod_config.h"
 #include "rod_visualization.h"
+#include "rod_roi_tracker.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -141,7 +142,7 @@ int main(int argc, char** argv) {
     printf("      Sharpening applied (%.1fms)\n", t_sharpen_end - t_sharpen_start);
     
     // Need to create detector early for mask creation
-    ArucoDictionaryHandle* dictionary = getPredefinedDictionary(rod_config_get_aruco_dictionary_type());
+    ArucoDictionaryHandle* dictionary = rod_config_create_aruco_dictionary();
     if (dictionary == NULL) {
         fprintf(stderr, "Error: Could not create ArUco dictionary\n");
         release_image(image);
@@ -179,7 +180,9 @@ int main(int argc, char** argv) {
     
     if (field_mask) {
         printf("      Field mask created successfully\n");
+        double t_apply_start = get_time_ms();
         ImageHandle* temp_masked = bitwise_and_mask(sharpened, field_mask);
+        double t_apply = get_time_ms() - t_apply_start;
         if (temp_masked) {
             release_image(sharpened);
             masked_image = temp_masked;
@@ -187,6 +190,55 @@ int main(int argc, char** argv) {
         } else {
             fprintf(stderr, "      Warning: Failed to apply mask, using unmasked image\n");
         }
+        
+        // Fused single-pass preprocessing (gray output) must find the same markers
+        double t_fused_start = get_time_ms();
+        ImageHandle* fused = sharpen_mask_gray_reuse(image, field_mask, NULL);
+        double t_fused = get_time_ms() - t_fused_start;
+        if (fused) {
+            DetectionResult* fused_result = detectMarkersWithConfidence(detector, fused);
+            DetectionResult* separate_result = detectMarkersWithConfidence(detector, masked_image);
+            int fused_count = fused_result ? fused_result->count : -1;
+            int separate_count = separate_result ? separate_result->count : -1;
+            printf("      Fused sharpen+mask+gray: %d marker(s) (%.1fms), separate passes: %d marker(s) (%.1fms)\n",
+                   fused_count, t_fused, separate_count, (t_sharpen_end - t_sharpen_start) + t_apply);
+            if (fused_count != separate_count) {
+                printf("      Warning: Fused preprocessing found %d marker(s), separate passes found %d\n",
+                       fused_count, separate_count);
+            }
+            
+            // Field crop: same fused pass and detection on the field bounding box only
+            RoiRect field_roi;
+            ImageHandle* roi_mask = create_field_mask_with_roi(masked_image, detector, orig_width, orig_height,
+                                                               1.1f, NULL, &field_roi);
+            ImageHandle* field_view = roi_mask ? create_image_roi_view(image, field_roi) : NULL;
+            if (field_view) {
+                double t_crop_start = get_time_ms();
+                ImageHandle* cropped = sharpen_mask_gray_reuse(field_view, roi_mask, NULL);
+                DetectionResult* crop_result = cropped ? detectMarkersWithConfidence(detector, cropped) : NULL;
+                double t_crop = get_time_ms() - t_crop_start;
+                int crop_count = crop_result ? crop_result->count : -1;
+                printf("      Field crop %dx%d (%.0f%% of the frame): %d marker(s) (%.1fms preprocess+detect)\n",
+                       field_roi.width, field_roi.height,
+                       100.0 * field_roi.width * field_roi.height / ((double)orig_width * orig_height),
+                       crop_count, t_crop);
+                if (crop_count != fused_count) {
+                    printf("      Warning: Field crop found %d marker(s), whole frame found %d\n",
+                           crop_count, fused_count);
+                }
+                releaseDetectionResult(crop_result);
+                release_image(cropped);
+                release_image(field_view);
+            } else {
+                fprintf(stderr, "      Warning: Field crop failed\n");
+            }
+            release_image(roi_mask);
+            releaseDetectionResult(fused_result);
+            releaseDetectionResult(separate_result);
+            release_image(fused);
+        } else {
+            fprintf(stderr, "      Warning: Fused preprocessing failed\n");
+        }
         release_image(field_mask);
     } else {
         printf("      Warning: Could not create field mask (need 4 fixed markers), proceeding without mask\n");
@@ -243,6 +295,90 @@ int main(int argc, char** argv) {
     printf("      Filtered to %d valid marker(s) (rejected %d invalid ID(s))\n", 
            valid_count, rejected_count);
     
+    // Restricted dictionary: same valid markers as the full DICT_4X4_50
+    ArucoDictionaryHandle* full_dictionary = getPredefinedDictionary(rod_config_get_aruco_dictionary_type());
+    ArucoDetectorHandle* full_detector = full_dictionary ? createArucoDetector(full_dictionary, params) : NULL;
+    DetectionResult* full_result = full_detector ? detectMarkersWithConfidence(full_detector, resized) : NULL;
+    if (full_result) {
+        MarkerData full_filtered[100];
+        int full_valid = filter_valid_markers(full_result, full_filtered, 100);
+        printf("      Full DICT_4X4_50: %d valid marker(s) out of %d, detector profile: %d valid marker(s)\n",
+               full_valid, full_result->count, valid_count);
+        if (full_valid != valid_count) {
+            printf("      Warning: Restricted dictionary found %d valid marker(s), full dictionary found %d\n",
+                   valid_count, full_valid);
+        }
+        releaseDetectionResult(full_result);
+    } else {
+        fprintf(stderr, "      Warning: Full dictionary detection failed\n");
+    }
+    releaseArucoDetector(full_detector);
+    releaseArucoDictionary(full_dictionary);
+    
+    // Tiled detection: same markers with the same corners as the single call
+    int tile_overlap = 0;
+    for (int i = 0; i < result_raw->count; i++) {
+        float dx = result_raw->markers[i].corners[2][0] - result_raw->markers[i].corners[0][0];
+        float dy = result_raw->markers[i].corners[2][1] - result_raw->markers[i].corners[0][1];
+        int diagonal = (int)ceilf(sqrtf(dx * dx + dy * dy) * ROD_DETECTION_TILE_MARGIN);
+        if (diagonal > tile_overlap) tile_overlap = diagonal;
+    }
+    double t_tiled_start = get_time_ms();
+    DetectionResult* tiled_result = detectMarkersTiled(detector, resized, ROD_DETECTION_TILES_X, ROD_DETECTION_TILES_Y,
+                                                       tile_overlap);
+    double t_tiled = get_time_ms() - t_tiled_start;
+    if (tiled_result) {
+        int matched = 0;
+        float max_diff = 0.0f;
+        for (int i = 0; i < tiled_result->count; i++) {
+            for (int k = 0; k < result_raw->count; k++) {
+                if (result_raw->markers[k].id != tiled_result->markers[i].id) continue;
+                float diff = 0.0f;
+                for (int j = 0; j < 4; j++) {
+                    diff = fmaxf(diff, fabsf(result_raw->markers[k].corners[j][0] - tiled_result->markers[i].corners[j][0]));
+                    diff = fmaxf(diff, fabsf(result_raw->markers[k].corners[j][1] - tiled_result->markers[i].corners[j][1]));
+                }
+                if (diff < 1.0f) {
+                    matched++;
+                    max_diff = fmaxf(max_diff, diff);
+                    break;
+                }
+            }
+        }
+        printf("      Tiled %dx%d (overlap %d px): %d marker(s), %d matching, max corner diff %.4f px (%.1fms)\n",
+               ROD_DETECTION_TILES_X, ROD_DETECTION_TILES_Y, tile_overlap, tiled_result->count, matched, max_diff, t_tiled);
+        if (tiled_result->count != result_raw->count || matched != result_raw->count || max_diff > 0.0f) {
+            printf("      Warning: Tiled detection differs from the single call\n");
+        }
+        releaseDetectionResult(tiled_result);
+    } else {
+        fprintf(stderr, "      Warning: Tiled detection failed\n");
+    }
+    
+    // ROI tracking: first call scans the full frame, second one only the tracked regions
+    double t_roi_detect = 0.0;
+    RodRoiTracker* tracker = rod_roi_tracker_create(ROD_ROI_FULL_SCAN_INTERVAL, ROD_ROI_PADDING_RATIO);
+    if (tracker) {
+        releaseDetectionResult(rod_roi_tracker_detect(tracker, detector, resized));
+        double t_roi_start = get_time_ms();
+        DetectionResult* result_roi = rod_roi_tracker_detect(tracker, detector, resized);
+        t_roi_detect = get_time_ms() - t_roi_start;
+        
+        RodRoiTrackerStats roi_stats;
+        rod_roi_tracker_get_stats(tracker, &roi_stats);
+        int roi_count = result_roi ? result_roi->count : -1;
+        printf("      ROI tracking: %d marker(s) in %d region(s)%s (%.1fms)\n",
+               roi_count, roi_stats.region_count, roi_stats.full_scan ? " [fell back to full scan]" : "",
+               t_roi_detect);
+        if (roi_count != result_raw->count) {
+            printf("      Warning: ROI tracking found %d marker(s), full frame found %d\n",
+                   roi_count, result_raw->count);
+        }
+        
+        releaseDetectionResult(result_roi);
+        rod_roi_tracker_destroy(tracker);
+    }
+    
     // ========== STEP 6: CALCULATE CENTERS (for display) ==========
     double t_process_start = get_time_ms();
     printf("[6/8] Calculating marker centers...\n");
@@ -362,6 +498,7 @@ int main(int argc, char** argv) {
     printf("Mask:      %.1fms\n", t_mask_end - t_mask_start);
     printf("Resize:    %.1fms\n", t_resize_end - t_resize_start);
     printf("Detect:    %.1fms\n", t_detect_end - t_detect_start);
+    printf("Detect ROI:%.1fms\n", t_roi_detect);
     printf("Process:   %.1fms\n", t_process_end - t_process_start);
     printf("Reload:    %.1fms\n", t_reload_end - t_reload_start);
     printf("Annotate:  %.1fms\n", t_annotate_end - t_annotate_start);
@@ -0,0 +1,195 @@
+/**
+ * test_bench_report.c
+ *
+ * Validates the replay benchmark result file and the baseline comparison used by rod_bench.
+ *
+ * Tests:
+ * - Set / get / replace values, invalid keys
+ * - Result built from pipeline metrics (keys and per-stage fps)
+ * - File write / read round trip, malformed file
+ * - Baseline comparison (fps drop, latency growth, tolerance, noise slack)
+ */
+
+#define _POSIX_C_SOURCE 200809L  // Required for mkdtemp
+
+#include "rod_bench_report.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+
+// ANSI color codes
+#define COLOR_RED "\033[1;31m"
+#define COLOR_GREEN "\033[1;32m"
+#define COLOR_RESET "\033[0m"
+
+// Test case counter
+static int test_passed = 0;
+static int test_failed = 0;
+
+// Helper macro for test assertions
+#define TEST_ASSERT(condition, message) \
+    do { \
+        if (!(condition)) { \
+            fprintf(stderr, "    ASSERTION FAILED: %s\n", message); \
+            return -1; \
+        } \
+    } while(0)
+
+static int test_values(void) {
+    RodBenchResult result;
+    rod_bench_result_init(&result);
+
+    double value = 0.0;
+    TEST_ASSERT(rod_bench_result_get(&result, "fps", &value) == -1, "Empty result must not hold keys");
+    TEST_ASSERT(rod_bench_result_set(&result, "fps", 30.0) == 0, "Set failed");
+    TEST_ASSERT(rod_bench_result_set(&result, "fps", 31.0) == 0, "Replace failed");
+    TEST_ASSERT(result.count == 1, "Replace must not add a value");
+    TEST_ASSERT(rod_bench_result_get(&result, "fps", &value) == 0 && value == 31.0, "Wrong value");
+
+    TEST_ASSERT(rod_bench_result_set(&result, "", 1.0) == -1, "Empty key must fail");
+    TEST_ASSERT(rod_bench_result_set(&result, "two words", 1.0) == -1, "Key with space must fail");
+
+    char key[ROD_BENCH_KEY_SIZE];
+    for (int i = result.count; i < ROD_BENCH_MAX_VALUES; i++) {
+        snprintf(key, sizeof(key), "key%d", i);
+        TEST_ASSERT(rod_bench_result_set(&result, key, (double)i) == 0, "Set failed before full");
+    }
+    TEST_ASSERT(rod_bench_result_set(&result, "overflow", 1.0) == -1, "Full result must fail");
+    return 0;
+}
+
+static int test_from_metrics(void) {
+    RodMetrics* metrics = rod_metrics_create();
+    TEST_ASSERT(metrics != NULL, "Metrics creation failed");
+    for (int i = 0; i < 100; i++) {
+        rod_metrics_record(metrics, ROD_METRIC_DETECT, 20.0);
+        rod_metrics_increment(metrics, ROD_COUNTER_FRAMES);
+    }
+
+    RodBenchResult result;
+    rod_bench_result_from_metrics(&result, metrics, 4.0);
+
+    double value = 0.0;
+    TEST_ASSERT(rod_bench_result_get(&result, "frames", &value) == 0 && value == 100.0, "Wrong frames");
+    TEST_ASSERT(rod_bench_result_get(&result, "fps", &value) == 0 && fabs(value - 25.0) < 1e-9, "Wrong fps");
+    TEST_ASSERT(rod_bench_result_get(&result, "detect.fps", &value) == 0 && fabs(value - 50.0) < 0.1, "Wrong stage fps");
+    TEST_ASSERT(rod_bench_result_get(&result, "detect.p99_ms", &value) == 0 && fabs(value - 20.0) < 1.5,
+                "Wrong stage p99");
+    TEST_ASSERT(rod_bench_result_get(&result, "capture.fps", &value) == 0 && value == 0.0, "Idle stage fps must be 0");
+    TEST_ASSERT(rod_bench_result_get(&result, "peak_rss_kb", &value) == 0 && value > 0.0, "Missing peak RSS");
+
+    rod_metrics_destroy(metrics);
+    return 0;
+}
+
+static int test_file(void) {
+    char folder[] = "/tmp/rod_bench_testXXXXXX";
+    TEST_ASSERT(mkdtemp(folder) != NULL, "Temporary folder creation failed");
+    char path[256];
+    snprintf(path, sizeof(path), "%s/result.txt", folder);
+
+    RodBenchResult written;
+    rod_bench_result_init(&written);
+    rod_bench_result_set(&written, "fps", 42.5);
+    rod_bench_result_set(&written, "total.p99_ms", 61.25);
+    TEST_ASSERT(rod_bench_result_write(&written, path) == 0, "Write failed");
+
+    RodBenchResult read;
+    TEST_ASSERT(rod_bench_result_read(&read, path) == 0, "Read failed");
+    TEST_ASSERT(read.count == 2, "Wrong value count");
+    TEST_ASSERT(strcmp(read.values[0].key, "fps") == 0, "Order not kept");
+    double value = 0.0;
+    TEST_ASSERT(rod_bench_result_get(&read, "total.p99_ms", &value) == 0 && fabs(value - 61.25) < 1e-6, "Wrong value");
+
+    FILE* file = fopen(path, "w");
+    TEST_ASSERT(file != NULL, "Cannot rewrite the file");
+    fprintf(file, "# comment\nfps 10\nbroken\n");
+    fclose(file);
+    TEST_ASSERT(rod_bench_result_read(&read, path) == -1, "Malformed file must fail");
+    TEST_ASSERT(rod_bench_result_read(&read, "/nonexistent_dir/result.txt") == -1, "Missing file must fail");
+
+    remove(path);
+    rmdir(folder);
+    return 0;
+}
+
+static int test_compare(void) {
+    RodBenchResult baseline;
+    rod_bench_result_init(&baseline);
+    rod_bench_result_set(&baseline, "frames", 300.0);
+    rod_bench_result_set(&baseline, "fps", 40.0);
+    rod_bench_result_set(&baseline, "detect.p99_ms", 30.0);
+    rod_bench_result_set(&baseline, "send.p99_ms", 0.05);
+    rod_bench_result_set(&baseline, "peak_rss_kb", 100000.0);
+
+    // Within tolerance (and frames is not compared)
+    RodBenchResult result = baseline;
+    rod_bench_result_set(&result, "frames", 10.0);
+    rod_bench_result_set(&result, "fps", 37.0);
+    rod_bench_result_set(&result, "detect.p99_ms", 32.5);
+    TEST_ASSERT(rod_bench_result_compare(&result, &baseline, 0.10, NULL) == 0, "Changes within tolerance");
+
+    // Tiny latencies only regress beyond the noise slack
+    rod_bench_result_set(&result, "send.p99_ms", 0.2);
+    TEST_ASSERT(rod_bench_result_compare(&result, &baseline, 0.10, NULL) == 0, "Noise must not regress");
+    rod_bench_result_set(&result, "send.p99_ms", 0.5);
+    TEST_ASSERT(rod_bench_result_compare(&result, &baseline, 0.10, NULL) == 1, "Latency growth beyond slack");
+
+    // fps drop and latency growth both count
+    rod_bench_result_set(&result, "fps", 30.0);
+    rod_bench_result_set(&result, "detect.p99_ms", 40.0);
+    rod_bench_result_set(&result, "peak_rss_kb", 150000.0);
+    TEST_ASSERT(rod_bench_result_compare(&result, &baseline, 0.10, NULL) == 4, "Wrong regression count");
+    rod_bench_result_set(&result, "send.p99_ms", 0.05);
+    TEST_ASSERT(rod_bench_result_compare(&result, &baseline, 0.60, NULL) == 0, "Large tolerance accepts all");
+
+    // Keys missing from the result are skipped
+    RodBenchResult partial;
+    rod_bench_result_init(&partial);
+    rod_bench_result_set(&partial, "fps", 45.0);
+    TEST_ASSERT(rod_bench_result_compare(&partial, &baseline, 0.10, NULL) == 0, "Missing keys must be skipped");
+    return 0;
+}
+
+typedef struct {
+    const char* name;
+    int (*func)(void);
+} TestCase;
+
+static const TestCase TESTS[] = {
+    {"Values", test_values},
+    {"Result from metrics", test_from_metrics},
+    {"File round trip", test_file},
+    {"Baseline comparison", test_compare}
+};
+
+#define NUM_TESTS (sizeof(TESTS) / sizeof(TestCase))
+
+int main() {
+    printf("========================================\n");
+    printf("Benchmark Report Test\n");
+    printf("========================================\n");
+    printf("Number of tests: %zu\n", NUM_TESTS);
+    printf("========================================\n\n");
+
+    for (size_t i = 0; i < NUM_TESTS; i++) {
+        printf("[%zu/%zu] %s... ", i + 1, NUM_TESTS, TESTS[i].name);
+        fflush(stdout);
+
+        if (TESTS[i].func() == 0) {
+            printf(COLOR_GREEN "PASS" COLOR_RESET "\n");
+            test_passed++;
+        } else {
+            printf(COLOR_RED "FAIL" COLOR_RESET "\n");
+            test_failed++;
+        }
+    }
+
+    printf("\n========================================\n");
+    printf("Results: %d passed, %d failed\n", test_passed, test_failed);
+    printf("========================================\n");
+
+    return (test_failed == 0) ? 0 : 1;
+}
@@ -11,6 +11,7 @@
  * - Start/stop behavior
  * - Take picture with/without start
  * - Multiple consecutive captures
+ * - Zero-copy acquire/release
  * - Size setting
  * - Error handling
  */
@@ -234,6 +235,91 @@ int test_invalid_dimensions() {
     return 0;
 }
 
+/**
+ * Test 9: Zero-copy acquire/release cycle
+ */
+int test_acquire_release() {
+    Camera* camera = camera_create(CAMERA_TYPE_EMULATED);
+    TEST_ASSERT(camera != NULL, "camera_create() failed");
+    
+    CameraFrame frame;
+    memset(&frame, 0, sizeof(frame));
+    TEST_ASSERT(camera_interface_acquire_frame(camera, &frame) != 0, "acquire without start must fail");
+    
+    camera_interface_set_folder(camera, g_test_folder);
+    camera_interface_set_size(camera, 320, 240);
+    TEST_ASSERT(camera_interface_start(camera) == 0, "start must succeed");
+    
+    uint64_t last_timestamp = 0;
+    for (int i = 0; i < 3; i++) {
+        int result = camera_interface_acquire_frame(camera, &frame);
+        TEST_ASSERT(result == 0, "acquire must succeed after start");
+        TEST_ASSERT(frame.data != NULL, "frame data must be set");
+        TEST_ASSERT(frame.sequence == (uint32_t)i, "sequence must count acquired frames");
+        TEST_ASSERT(frame.timestamp_ns > last_timestamp, "timestamps must increase");
+        last_timestamp = frame.timestamp_ns;
+        TEST_ASSERT(frame.width == 320 && frame.height == 240, "frame size must match request");
+        TEST_ASSERT(frame.stride >= (size_t)frame.width * 3, "stride must hold a full BGR row");
+        TEST_ASSERT(frame.size >= frame.stride * (frame.height - 1) + (size_t)frame.width * 3,
+                    "size must cover all rows");
+        
+        result = camera_interface_release_frame(camera, &frame);
+        TEST_ASSERT(result == 0, "release must succeed");
+        TEST_ASSERT(frame.data == NULL, "frame data must be cleared on release");
+    }
+    
+    camera_interface_stop(camera);
+    camera_destroy(camera);
+    return 0;
+}
+
+/**
+ * Test 10: YUV420 format (luma plane) with low resolution color preview
+ */
+int test_yuv420_preview() {
+    Camera* camera = camera_create(CAMERA_TYPE_EMULATED);
+    TEST_ASSERT(camera != NULL, "camera_create() failed");
+    
+    TEST_ASSERT(camera_interface_set_format(camera, CAMERA_FORMAT_YUV420, 160, 0) != 0,
+                "set_format with half-specified preview must fail");
+    TEST_ASSERT(camera_interface_set_format(camera, CAMERA_FORMAT_YUV420, 160, 120) == 0,
+                "set_format must succeed before start");
+    TEST_ASSERT(camera_interface_set_buffering(camera, -1, 1) != 0,
+                "set_buffering with negative count must fail");
+    TEST_ASSERT(camera_interface_set_buffering(camera, 4, 1) == 0,
+                "set_buffering must succeed before start");
+    
+    CameraSensorMode modes[4];
+    TEST_ASSERT(camera_interface_list_sensor_modes(camera, modes, 4) == 0,
+                "emulated camera must report no sensor mode");
+    TEST_ASSERT(camera_interface_set_sensor_mode(camera, NULL) == 0,
+                "automatic sensor mode must be accepted");
+    
+    camera_interface_set_folder(camera, g_test_folder);
+    camera_interface_set_size(camera, 320, 240);
+    TEST_ASSERT(camera_interface_start(camera) == 0, "start must succeed");
+    
+    CameraFrame frame;
+    memset(&frame, 0, sizeof(frame));
+    int result = camera_interface_acquire_frame(camera, &frame);
+    TEST_ASSERT(result == 0, "acquire must succeed after start");
+    TEST_ASSERT(frame.format == CAMERA_FORMAT_YUV420, "frame format must match request");
+    TEST_ASSERT(camera_frame_channels(&frame) == 1, "YUV420 frame must expose one channel (Y plane)");
+    TEST_ASSERT(frame.width == 320 && frame.height == 240, "frame size must match request");
+    TEST_ASSERT(frame.stride >= (size_t)frame.width, "stride must hold a full Y row");
+    TEST_ASSERT(frame.preview_data != NULL, "preview data must be set");
+    TEST_ASSERT(frame.preview_width == 160 && frame.preview_height == 120, "preview size must match request");
+    TEST_ASSERT(frame.preview_stride >= (size_t)frame.preview_width * 3, "preview stride must hold a full BGR row");
+    
+    result = camera_interface_release_frame(camera, &frame);
+    TEST_ASSERT(result == 0, "release must succeed");
+    TEST_ASSERT(frame.data == NULL && frame.preview_data == NULL, "frame data must be cleared on release");
+    
+    camera_interface_stop(camera);
+    camera_destroy(camera);
+    return 0;
+}
+
 // Test suite definition
 typedef struct {
     const char* name;
@@ -248,7 +334,9 @@ static const TestCase TESTS[] = {
     {"Multiple consecutive captures", test_multiple_captures},
     {"Stop/restart cycle", test_restart_cycle},
     {"Invalid folder handling", test_invalid_folder},
-    {"Invalid dimensions handling", test_invalid_dimensions}
+    {"Invalid dimensions handling", test_invalid_dimensions},
+    {"Zero-copy acquire/release", test_acquire_release},
+    {"YUV420 format with preview", test_yuv420_preview}
 };
 
 #define NUM_TESTS (sizeof(TESTS) / sizeof(TestCase))
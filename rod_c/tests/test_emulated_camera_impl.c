@@ -6,12 +6,15 @@
  * - Error handling (missing files, invalid images)
  * - Dimension consistency
  * - Loop-around behavior when cycling through images
+ * - Prefetch thread and preload modes (same frames as synchronous decoding)
+ * - Session replay (recorded metadata kept aside, live clock monotonic on loop around)
  * 
  * This test focuses on emulated_camera.c specific behavior,
  * while test_camera_interface.c tests the generic contract.
  */
 
 #include "camera_interface.h"
+#include "rod_session.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -296,6 +299,134 @@ int test_bgr_format() {
     return 0;
 }
 
+/**
+ * Acquire two rounds of the folder and compare each frame's first bytes with the synchronous decode.
+ */
+static int replay_matches_sync(int depth, int preload, int num_images) {
+    enum { CHECK_BYTES = 256 };
+    
+    Camera* reference = camera_create(CAMERA_TYPE_EMULATED);
+    Camera* camera = camera_create(CAMERA_TYPE_EMULATED);
+    TEST_ASSERT(reference != NULL && camera != NULL, "camera_create() failed");
+    
+    camera_interface_set_folder(reference, g_test_folder);
+    camera_interface_set_size(reference, 320, 240);
+    camera_interface_set_folder(camera, g_test_folder);
+    camera_interface_set_size(camera, 320, 240);
+    TEST_ASSERT(camera_interface_set_prefetch(camera, depth, preload) == 0, "set_prefetch must succeed before start");
+    TEST_ASSERT(camera_interface_start(reference) == 0 && camera_interface_start(camera) == 0, "start must succeed");
+    TEST_ASSERT(camera_interface_set_prefetch(camera, depth, preload) != 0, "set_prefetch after start must fail");
+    
+    uint8_t* first_data = NULL;
+    for (int i = 0; i < 2 * num_images; i++) {
+        CameraFrame expected, frame;
+        TEST_ASSERT(camera_interface_acquire_frame(reference, &expected) == 0, "reference acquire failed");
+        TEST_ASSERT(camera_interface_acquire_frame(camera, &frame) == 0, "acquire failed");
+        TEST_ASSERT(frame.sequence == (uint32_t)i, "sequence must count acquired frames");
+        TEST_ASSERT(frame.width == expected.width && frame.height == expected.height, "frame size differs");
+        TEST_ASSERT(memcmp(frame.data, expected.data, CHECK_BYTES) == 0, "frame content differs from synchronous decode");
+        
+        // Preloaded frames are decoded once: the second round lends the same pixels
+        if (i == 0) first_data = frame.data;
+        if (preload && i == num_images) {
+            TEST_ASSERT(frame.data == first_data, "preloaded frame must be reused on loop around");
+        }
+        
+        camera_interface_release_frame(reference, &expected);
+        camera_interface_release_frame(camera, &frame);
+    }
+    
+    // Stop with decoded frames still queued
+    camera_interface_stop(camera);
+    camera_interface_stop(reference);
+    camera_destroy(camera);
+    camera_destroy(reference);
+    return 0;
+}
+
+/**
+ * Test 7: Prefetch thread and preload deliver the synchronous frames in order
+ */
+int test_prefetch_preload() {
+    int num_images = count_images_in_folder(g_test_folder);
+    TEST_ASSERT(num_images > 0, "test folder must contain images");
+    
+    Camera* camera = camera_create(CAMERA_TYPE_EMULATED);
+    TEST_ASSERT(camera != NULL, "camera_create() failed");
+    TEST_ASSERT(camera_interface_set_prefetch(camera, -1, 0) != 0, "negative depth must fail");
+    camera_destroy(camera);
+    
+    TEST_ASSERT(replay_matches_sync(1, 0, num_images) == 0, "prefetch depth 1");
+    TEST_ASSERT(replay_matches_sync(4, 0, num_images) == 0, "prefetch depth 4");
+    TEST_ASSERT(replay_matches_sync(0, 1, num_images) == 0, "preload");
+    return 0;
+}
+
+#define SESSION_FILE "/tmp/test_emulated_camera.rods"
+#define SESSION_FRAMES 3
+
+/**
+ * Replay a session written here and check each frame reports the recorded metadata.
+ */
+static int replay_session(int preload) {
+    Camera* camera = camera_create(CAMERA_TYPE_EMULATED);
+    TEST_ASSERT(camera != NULL, "camera_create() failed");
+    TEST_ASSERT(camera_interface_set_folder(camera, SESSION_FILE) == 0, "session file must be accepted");
+    camera_interface_set_size(camera, 64, 48);
+    TEST_ASSERT(camera_interface_set_prefetch(camera, 0, preload) == 0, "set_prefetch must succeed before start");
+    TEST_ASSERT(camera_interface_start(camera) == 0, "start must succeed");
+    
+    // Two rounds: the loop around replays the same recorded values, the acquire clock keeps going
+    uint64_t previous_ns = 0;
+    for (int i = 0; i < 2 * SESSION_FRAMES; i++) {
+        int n = i % SESSION_FRAMES;
+        CameraFrame frame;
+        TEST_ASSERT(camera_interface_acquire_frame(camera, &frame) == 0, "acquire failed");
+        TEST_ASSERT(frame.sequence == (uint32_t)i, "sequence must count acquired frames");
+        TEST_ASSERT(frame.timestamp_ns >= previous_ns, "timestamp must not go back on loop around");
+        previous_ns = frame.timestamp_ns;
+        TEST_ASSERT(frame.recorded, "replayed frame must be flagged as recorded");
+        TEST_ASSERT(frame.recorded_sequence == (uint32_t)(500 + 2 * n), "recorded sequence expected");
+        TEST_ASSERT(frame.recorded_timestamp_ns == 7000000000ULL + 33333333ULL * (uint64_t)n,
+                    "recorded timestamp expected");
+        TEST_ASSERT(frame.data[0] == (uint8_t)(40 * n), "recorded pixels expected");
+        camera_interface_release_frame(camera, &frame);
+    }
+    
+    camera_interface_stop(camera);
+    camera_destroy(camera);
+    return 0;
+}
+
+/**
+ * Test 8: A replayed session keeps the recorded metadata apart from the acquire clock
+ */
+int test_session_replay() {
+    static uint8_t pixels[48][64 * 3];
+    RodSessionWriter* writer = rod_session_writer_create(SESSION_FILE);
+    TEST_ASSERT(writer != NULL, "session writer must be created");
+    for (int n = 0; n < SESSION_FRAMES; n++) {
+        // Recorded sequence with a gap (frames lost while recording) and a 30 fps clock
+        memset(pixels, 40 * n, sizeof(pixels));
+        RodSessionFrame frame = {
+            .sequence = (uint32_t)(500 + 2 * n),
+            .timestamp_ns = 7000000000ULL + 33333333ULL * (uint64_t)n,
+            .width = 64,
+            .height = 48,
+            .channels = 3,
+            .stride = sizeof(pixels[0]),
+            .data = &pixels[0][0]
+        };
+        TEST_ASSERT(rod_session_writer_append(writer, &frame) == 0, "frame must be recorded");
+    }
+    TEST_ASSERT(rod_session_writer_close(writer) == 0, "session must be indexed");
+    
+    int result = replay_session(0) == 0 && replay_session(1) == 0 ? 0 : -1;
+    unlink(SESSION_FILE);
+    TEST_ASSERT(result == 0, "session replay (decoded in acquire, then preloaded)");
+    return 0;
+}
+
 // Test suite definition
 typedef struct {
     const char* name;
@@ -308,7 +439,9 @@ static const TestCase TESTS[] = {
     {"Mixed dimensions with resize", test_mixed_dimensions},
     {"Change folder after start", test_change_folder_after_start},
     {"No resize (original dimensions)", test_no_resize},
-    {"BGR format verification", test_bgr_format}
+    {"BGR format verification", test_bgr_format},
+    {"Prefetch and preload replay", test_prefetch_preload},
+    {"Session replay metadata", test_session_replay}
 };
 
 #define NUM_TESTS (sizeof(TESTS) / sizeof(TestCase))
@@ -0,0 +1,207 @@
+/**
+ * test_frame_queue.c
+ * 
+ * Validates the bounded frame queue used between pipeline stages.
+ * 
+ * Tests:
+ * - FIFO order
+ * - Drop-oldest / try-push backpressure
+ * - Pop timeout on empty queue
+ * - Close wakes up blocked consumers
+ * - Producer/consumer threads (no item lost or duplicated)
+ */
+
+#define _DEFAULT_SOURCE  // Required for usleep
+
+#include "rod_frame_queue.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+
+// ANSI color codes
+#define COLOR_RED "\033[1;31m"
+#define COLOR_GREEN "\033[1;32m"
+#define COLOR_RESET "\033[0m"
+
+// Test case counter
+static int test_passed = 0;
+static int test_failed = 0;
+
+// Helper macro for test assertions
+#define TEST_ASSERT(condition, message) \
+    do { \
+        if (!(condition)) { \
+            fprintf(stderr, "    ASSERTION FAILED: %s\n", message); \
+            return -1; \
+        } \
+    } while(0)
+
+#define STRESS_ITEMS 10000
+
+static int g_items[STRESS_ITEMS];
+
+/**
+ * Test 1: Items come out in push order
+ */
+int test_fifo_order() {
+    RodFrameQueue* queue = rod_frame_queue_create(3);
+    TEST_ASSERT(queue != NULL, "create must succeed");
+    TEST_ASSERT(rod_frame_queue_create(0) == NULL, "create with zero capacity must fail");
+    
+    for (int i = 0; i < 3; i++) {
+        TEST_ASSERT(rod_frame_queue_push(queue, &g_items[i]) == 0, "push must succeed");
+    }
+    TEST_ASSERT(rod_frame_queue_depth(queue) == 3, "depth must be 3");
+    
+    for (int i = 0; i < 3; i++) {
+        TEST_ASSERT(rod_frame_queue_pop(queue, 0) == &g_items[i], "items must be popped in FIFO order");
+    }
+    TEST_ASSERT(rod_frame_queue_depth(queue) == 0, "queue must be empty");
+    
+    rod_frame_queue_destroy(queue);
+    return 0;
+}
+
+/**
+ * Test 2: Full queue evicts the oldest item
+ */
+int test_drop_oldest() {
+    RodFrameQueue* queue = rod_frame_queue_create(2);
+    TEST_ASSERT(queue != NULL, "create must succeed");
+    
+    void* dropped = &g_items[0];
+    TEST_ASSERT(rod_frame_queue_push_drop_oldest(queue, &g_items[1], &dropped) == 0, "push must succeed");
+    TEST_ASSERT(dropped == NULL, "nothing dropped while not full");
+    rod_frame_queue_push_drop_oldest(queue, &g_items[2], &dropped);
+    rod_frame_queue_push_drop_oldest(queue, &g_items[3], &dropped);
+    TEST_ASSERT(dropped == &g_items[1], "oldest item must be evicted");
+    TEST_ASSERT(rod_frame_queue_depth(queue) == 2, "depth must stay at capacity");
+    TEST_ASSERT(rod_frame_queue_pop(queue, 0) == &g_items[2], "second item must now be first");
+    TEST_ASSERT(rod_frame_queue_pop(queue, 0) == &g_items[3], "newest item must be last");
+    
+    // try_push never evicts
+    TEST_ASSERT(rod_frame_queue_try_push(queue, &g_items[4]) == 0, "try_push must succeed when not full");
+    TEST_ASSERT(rod_frame_queue_try_push(queue, &g_items[5]) == 0, "try_push must succeed when not full");
+    TEST_ASSERT(rod_frame_queue_try_push(queue, &g_items[6]) != 0, "try_push must fail when full");
+    TEST_ASSERT(rod_frame_queue_pop(queue, 0) == &g_items[4], "try_push must keep the oldest item");
+    
+    rod_frame_queue_destroy(queue);
+    return 0;
+}
+
+/**
+ * Test 3: Pop on an empty queue times out
+ */
+int test_pop_timeout() {
+    RodFrameQueue* queue = rod_frame_queue_create(1);
+    TEST_ASSERT(queue != NULL, "create must succeed");
+    
+    TEST_ASSERT(rod_frame_queue_pop(queue, 0) == NULL, "non-blocking pop on empty queue must return NULL");
+    TEST_ASSERT(rod_frame_queue_pop(queue, 20) == NULL, "timed pop on empty queue must return NULL");
+    
+    rod_frame_queue_destroy(queue);
+    return 0;
+}
+
+static void* blocked_consumer(void* arg) {
+    return rod_frame_queue_pop((RodFrameQueue*)arg, -1);
+}
+
+/**
+ * Test 4: Close wakes up a consumer blocked forever and rejects pushes
+ */
+int test_close() {
+    RodFrameQueue* queue = rod_frame_queue_create(1);
+    TEST_ASSERT(queue != NULL, "create must succeed");
+    
+    pthread_t thread;
+    TEST_ASSERT(pthread_create(&thread, NULL, blocked_consumer, queue) == 0, "thread must start");
+    usleep(20000);
+    rod_frame_queue_close(queue);
+    
+    void* result = &g_items[0];
+    pthread_join(thread, &result);
+    TEST_ASSERT(result == NULL, "blocked pop must return NULL after close");
+    TEST_ASSERT(rod_frame_queue_is_closed(queue), "queue must report closed");
+    TEST_ASSERT(rod_frame_queue_push(queue, &g_items[0]) != 0, "push after close must fail");
+    
+    rod_frame_queue_destroy(queue);
+    return 0;
+}
+
+static void* stress_producer(void* arg) {
+    RodFrameQueue* queue = (RodFrameQueue*)arg;
+    for (int i = 0; i < STRESS_ITEMS; i++) {
+        g_items[i] = i;
+        rod_frame_queue_push(queue, &g_items[i]);
+    }
+    return NULL;
+}
+
+/**
+ * Test 5: Blocking producer/consumer keeps every item, in order
+ */
+int test_producer_consumer() {
+    RodFrameQueue* queue = rod_frame_queue_create(4);
+    TEST_ASSERT(queue != NULL, "create must succeed");
+    
+    pthread_t thread;
+    TEST_ASSERT(pthread_create(&thread, NULL, stress_producer, queue) == 0, "thread must start");
+    
+    int expected = 0;
+    while (expected < STRESS_ITEMS) {
+        int* item = (int*)rod_frame_queue_pop(queue, 1000);
+        if (!item || *item != expected) break;
+        expected++;
+    }
+    pthread_join(thread, NULL);
+    TEST_ASSERT(expected == STRESS_ITEMS, "all items must be received in order");
+    
+    rod_frame_queue_destroy(queue);
+    return 0;
+}
+
+// Test suite definition
+typedef struct {
+    const char* name;
+    int (*func)();
+} TestCase;
+
+static const TestCase TESTS[] = {
+    {"FIFO order", test_fifo_order},
+    {"Drop-oldest backpressure", test_drop_oldest},
+    {"Pop timeout", test_pop_timeout},
+    {"Close wakes consumers", test_close},
+    {"Producer/consumer threads", test_producer_consumer}
+};
+
+#define NUM_TESTS (sizeof(TESTS) / sizeof(TestCase))
+
+int main() {
+    printf("========================================\n");
+    printf("Frame Queue Test\n");
+    printf("========================================\n");
+    printf("Number of tests: %zu\n", NUM_TESTS);
+    printf("========================================\n\n");
+    
+    for (size_t i = 0; i < NUM_TESTS; i++) {
+        printf("[%zu/%zu] %s... ", i + 1, NUM_TESTS, TESTS[i].name);
+        fflush(stdout);
+        
+        if (TESTS[i].func() == 0) {
+            printf(COLOR_GREEN "PASS" COLOR_RESET "\n");
+            test_passed++;
+        } else {
+            printf(COLOR_RED "FAIL" COLOR_RESET "\n");
+            test_failed++;
+        }
+    }
+    
+    printf("\n========================================\n");
+    printf("Results: %d passed, %d failed\n", test_passed, test_failed);
+    printf("========================================\n");
+    
+    return (test_failed == 0) ? 0 : 1;
+}
@@ -16,10 +16,16 @@
  * 6. Calculate position and angle errors
  * 7. Report detailed metrics and pass/fail status
  * 
+ * With --pyramid <scale>, detection uses the coarse-to-fine mode
+ * (detectMarkersPyramid) and a final section compares its mean position
+ * error and detection time against full resolution detection.
+ * 
  * This test measures the most critical ROD capability: accurate 
  * real-world positioning for the robotics competition.
  */
 
+#define _POSIX_C_SOURCE 199309L  // Required for clock_gettime and CLOCK_MONOTONIC
+
 #include "opencv_wrapper.h"
 #include "rod_cv.h"
 #include "rod_config.h"
@@ -29,6 +35,7 @@
 #include <string.h>
 #include <math.h>
 #include <float.h>
+#include <time.h>
 
 // ANSI color codes
 #define COLOR_RED "\033[1;31m"
@@ -47,6 +54,9 @@
 // Matching tolerance (max distance to consider same marker)
 #define MATCHING_DISTANCE_THRESHOLD 100.0  // mm
 
+// Pyramid comparison (detection timing averaged over several runs)
+#define PYRAMID_TIMING_RUNS 5
+
 /**
  * Ground truth marker structure
  */
@@ -85,6 +95,17 @@ typedef struct {
     int outlier_count;
 } ErrorStats;
 
+/**
+ * Accuracy and timing of one detection mode (pyramid comparison)
+ */
+typedef struct {
+    int valid;                  // 0 if detection or matching failed
+    int match_count;
+    float mean_position_error;  // mm
+    float max_position_error;   // mm
+    double mean_detect_ms;      // Averaged over PYRAMID_TIMING_RUNS
+} ModeSummary;
+
 // Ground truth dataset (Eurobot 2026 initial positions)
 // Format: {marker_id, zone_name, x, y, tolerance, angle}
 // Note: For positions with multiple possible IDs [36, 47], we'll create separate entries
@@ -231,11 +252,22 @@ float calculate_median(float* values, int count) {
     }
 }
 
+/**
+ * Get current time in milliseconds
+ */
+static double get_time_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
 /**
  * Run full detection pipeline on image
+ * pyramid_scale < 1.0 uses coarse-to-fine detection (1.0 = full resolution)
+ * detect_ms (optional) receives the time spent in marker detection only
  * Returns detection result with marker data
  */
-DetectionResult* detect_markers_in_image(const char* image_path) {
+DetectionResult* detect_markers_in_image(const char* image_path, float pyramid_scale, double* detect_ms) {
     // Load image
     ImageHandle* image = load_image(image_path);
     if (!image) {
@@ -292,7 +324,11 @@ DetectionResult* detect_markers_in_image(const char* image_path) {
     }
     
     // Detect markers
-    DetectionResult* result = detectMarkersWithConfidence(detector, resized);
+    double t_detect_start = get_time_ms();
+    DetectionResult* result = detectMarkersPyramid(detector, resized, pyramid_scale);
+    if (detect_ms) {
+        *detect_ms = get_time_ms() - t_detect_start;
+    }
     
     // Scale corners back to original size (detected on 1.5x image)
     if (result) {
@@ -540,12 +576,86 @@ int count_unique_ground_truth_positions() {
     return unique_count;
 }
 
+/**
+ * Evaluate one detection mode: accuracy of the first run, mean detection time
+ */
+ModeSummary evaluate_detection_mode(const char* image_path, float* H_inv, float pyramid_scale) {
+    ModeSummary summary;
+    memset(&summary, 0, sizeof(summary));
+    
+    double total_ms = 0.0;
+    DetectionResult* detections = NULL;
+    for (int run = 0; run < PYRAMID_TIMING_RUNS; run++) {
+        double detect_ms = 0.0;
+        DetectionResult* result = detect_markers_in_image(image_path, pyramid_scale, &detect_ms);
+        if (!result) {
+            releaseDetectionResult(detections);
+            return summary;
+        }
+        total_ms += detect_ms;
+        if (detections) {
+            releaseDetectionResult(result);
+        } else {
+            detections = result;
+        }
+    }
+    summary.mean_detect_ms = total_ms / PYRAMID_TIMING_RUNS;
+    
+    DetectedWorldMarker world_markers[100];
+    int world_count = transform_markers_to_world(detections, H_inv, world_markers, 100);
+    releaseDetectionResult(detections);
+    
+    int matched_indices[100];
+    float position_errors[100];
+    float angle_errors[100];
+    summary.match_count = match_markers_to_ground_truth(world_markers, world_count,
+                                                        GROUND_TRUTH, NUM_GROUND_TRUTH,
+                                                        matched_indices, position_errors, angle_errors);
+    if (summary.match_count == 0) {
+        return summary;
+    }
+    
+    ErrorStats stats = calculate_error_stats(position_errors, angle_errors, summary.match_count);
+    summary.mean_position_error = stats.mean_position_error;
+    summary.max_position_error = stats.max_position_error;
+    summary.valid = 1;
+    return summary;
+}
+
+/**
+ * Print full resolution vs pyramid detection comparison
+ */
+void print_pyramid_comparison(const char* image_path, float* H_inv, float pyramid_scale) {
+    printf("\n========================================\n");
+    printf("   PYRAMID COMPARISON (scale %.2f)\n", pyramid_scale);
+    printf("========================================\n");
+    
+    ModeSummary full = evaluate_detection_mode(image_path, H_inv, 1.0f);
+    ModeSummary pyramid = evaluate_detection_mode(image_path, H_inv, pyramid_scale);
+    
+    printf("\n%-16s %8s %12s %12s %12s\n", "Mode", "Matched", "Mean err", "Max err", "Detect");
+    printf("%-16s %8d %10.1fmm %10.1fmm %10.1fms\n", "Full resolution",
+           full.match_count, full.mean_position_error, full.max_position_error, full.mean_detect_ms);
+    printf("%-16s %8d %10.1fmm %10.1fmm %10.1fms\n", "Pyramid",
+           pyramid.match_count, pyramid.mean_position_error, pyramid.max_position_error, pyramid.mean_detect_ms);
+    
+    if (!full.valid || !pyramid.valid) {
+        printf(COLOR_YELLOW "\nWARNING: Comparison incomplete (no markers matched in one mode)\n" COLOR_RESET);
+        return;
+    }
+    
+    printf("\nTrade-off: %+.1fmm mean error, %.2fx detection speed (%d runs)\n",
+           pyramid.mean_position_error - full.mean_position_error,
+           pyramid.mean_detect_ms > 0.0 ? full.mean_detect_ms / pyramid.mean_detect_ms : 0.0,
+           PYRAMID_TIMING_RUNS);
+}
+
 /**
  * Main test function
  */
 int main(int argc, char* argv[]) {
     if (argc < 2) {
-        printf("Usage: %s <test_image_path>\n", argv[0]);
+        printf("Usage: %s <test_image_path> [--pyramid <scale>]\n", argv[0]);
         printf("\n");
         printf("Geometric Accuracy Benchmark Test\n");
         printf("----------------------------------\n");
@@ -556,10 +666,28 @@ int main(int argc, char* argv[]) {
         printf("  - Image must contain fixed markers (IDs 20-23) for homography\n");
         printf("  - Game element markers (IDs 36, 41, 47) at known positions\n");
         printf("\n");
+        printf("Options:\n");
+        printf("  --pyramid <scale>  Coarse-to-fine detection at the given scale (e.g. 0.5),\n");
+        printf("                     compared against full resolution detection\n");
+        printf("\n");
         return 1;
     }
     
     const char* image_path = argv[1];
+    float pyramid_scale = 1.0f;
+    
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "--pyramid") == 0 && i + 1 < argc) {
+            pyramid_scale = (float)atof(argv[++i]);
+            if (pyramid_scale <= 0.0f || pyramid_scale > 1.0f) {
+                fprintf(stderr, "ERROR: --pyramid scale must be in (0, 1]\n");
+                return 1;
+            }
+        } else {
+            fprintf(stderr, "ERROR: Unknown option: %s\n", argv[i]);
+            return 1;
+        }
+    }
     
     printf("\n");
     printf("========================================\n");
@@ -567,6 +695,9 @@ int main(int argc, char* argv[]) {
     printf("========================================\n");
     printf("\n");
     printf("Image: %s\n", image_path);
+    if (pyramid_scale < 1.0f) {
+        printf("Detection: pyramid (coarse scale %.2f)\n", pyramid_scale);
+    }
     
     // Count unique ground truth positions
     int unique_gt_count = count_unique_ground_truth_positions();
@@ -576,7 +707,7 @@ int main(int argc, char* argv[]) {
     
     // Step 1: Detect markers
     printf("Step 1: Detecting ArUco markers...\n");
-    DetectionResult* detections = detect_markers_in_image(image_path);
+    DetectionResult* detections = detect_markers_in_image(image_path, pyramid_scale, NULL);
     if (!detections) {
         printf(COLOR_RED "FAILED: Could not detect markers\n" COLOR_RESET);
         return 1;
@@ -735,6 +866,11 @@ int main(int argc, char* argv[]) {
     
     printf("\n========================================\n\n");
     
+    if (pyramid_scale < 1.0f) {
+        print_pyramid_comparison(image_path, H_inv, pyramid_scale);
+        printf("\n========================================\n\n");
+    }
+    
     // Cleanup
     free_matrix(H_inv);
     
@@ -0,0 +1,239 @@
+/**
+ * test_image_pool.c
+ *
+ * Validates the image pool and the caller-provided detection result API
+ * used by the pipeline to avoid per-frame allocations.
+ *
+ * Tests:
+ * - Create with invalid parameters
+ * - Owned buffers are reused for the same geometry
+ * - Views over external buffers and over image rectangles
+ * - Exhausted pool falls back to plain allocation
+ * - detectMarkersInto fills caller storage (invalid storage, blank image)
+ */
+
+#include "opencv_wrapper.h"
+#include "rod_config.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// ANSI color codes
+#define COLOR_RED "\033[1;31m"
+#define COLOR_GREEN "\033[1;32m"
+#define COLOR_RESET "\033[0m"
+
+// Test case counter
+static int test_passed = 0;
+static int test_failed = 0;
+
+// Helper macro for test assertions
+#define TEST_ASSERT(condition, message) \
+    do { \
+        if (!(condition)) { \
+            fprintf(stderr, "    ASSERTION FAILED: %s\n", message); \
+            return -1; \
+        } \
+    } while(0)
+
+#define POOL_SIZE 4
+#define IMAGE_WIDTH 640
+#define IMAGE_HEIGHT 480
+#define RESULT_CAPACITY 16
+
+static int test_create(void) {
+    TEST_ASSERT(image_pool_create(0) == NULL, "Zero capacity must fail");
+    TEST_ASSERT(image_pool_create(-1) == NULL, "Negative capacity must fail");
+
+    ImagePool* pool = image_pool_create(POOL_SIZE);
+    TEST_ASSERT(pool != NULL, "Pool creation failed");
+    TEST_ASSERT(image_pool_acquire(pool, 0, IMAGE_HEIGHT, 1) == NULL, "Zero width must fail");
+    TEST_ASSERT(image_pool_acquire(pool, IMAGE_WIDTH, IMAGE_HEIGHT, 2) == NULL, "Unsupported channel count must fail");
+    TEST_ASSERT(image_pool_acquire(NULL, IMAGE_WIDTH, IMAGE_HEIGHT, 1) == NULL, "NULL pool must fail");
+    image_pool_destroy(pool);
+    return 0;
+}
+
+static int test_reuse(void) {
+    ImagePool* pool = image_pool_create(POOL_SIZE);
+    TEST_ASSERT(pool != NULL, "Pool creation failed");
+
+    ImageHandle* first = image_pool_acquire(pool, IMAGE_WIDTH, IMAGE_HEIGHT, 3);
+    TEST_ASSERT(first != NULL, "Acquire failed");
+    TEST_ASSERT(get_image_width(first) == IMAGE_WIDTH && get_image_height(first) == IMAGE_HEIGHT, "Wrong geometry");
+    TEST_ASSERT(get_image_channels(first) == 3, "Wrong channel count");
+    uint8_t* data = get_image_data(first);
+    image_pool_release(pool, first);
+
+    // Same geometry: same header and same buffer
+    ImageHandle* second = image_pool_acquire(pool, IMAGE_WIDTH, IMAGE_HEIGHT, 3);
+    TEST_ASSERT(second == first, "Released handle not reused");
+    TEST_ASSERT(get_image_data(second) == data, "Released buffer not reused");
+
+    // Different geometry while the first is held: another entry
+    ImageHandle* gray = image_pool_acquire(pool, IMAGE_WIDTH, IMAGE_HEIGHT, 1);
+    TEST_ASSERT(gray != NULL && gray != second, "Second acquire must use another entry");
+    TEST_ASSERT(get_image_channels(gray) == 1, "Wrong channel count");
+
+    // Copy into a pooled buffer
+    memset(get_image_data(gray), 0x5A, get_image_data_size(gray));
+    ImageHandle* copy = image_pool_acquire_copy(pool, gray);
+    TEST_ASSERT(copy != NULL && copy != gray, "Copy failed");
+    TEST_ASSERT(get_image_data(copy) != get_image_data(gray), "Copy must not share pixels");
+    TEST_ASSERT(memcmp(get_image_data(copy), get_image_data(gray), get_image_data_size(gray)) == 0, "Copy content differs");
+
+    image_pool_release(pool, copy);
+    image_pool_release(pool, gray);
+    image_pool_release(pool, second);
+    image_pool_destroy(pool);
+    return 0;
+}
+
+static int test_views(void) {
+    ImagePool* pool = image_pool_create(POOL_SIZE);
+    TEST_ASSERT(pool != NULL, "Pool creation failed");
+
+    size_t stride = IMAGE_WIDTH + 64;
+    uint8_t* buffer = (uint8_t*)malloc(stride * IMAGE_HEIGHT);
+    TEST_ASSERT(buffer != NULL, "Buffer allocation failed");
+
+    TEST_ASSERT(image_pool_acquire_view(pool, buffer, IMAGE_WIDTH, IMAGE_HEIGHT, 1, IMAGE_WIDTH - 1) == NULL,
+                "Stride smaller than a row must fail");
+
+    ImageHandle* view = image_pool_acquire_view(pool, buffer, IMAGE_WIDTH, IMAGE_HEIGHT, 1, stride);
+    TEST_ASSERT(view != NULL, "View failed");
+    TEST_ASSERT(get_image_data(view) == buffer, "View must point to the external buffer");
+
+    RoiRect rect = {100, 50, 200, 100};
+    ImageHandle* roi = image_pool_acquire_roi_view(pool, view, rect);
+    TEST_ASSERT(roi != NULL, "ROI view failed");
+    TEST_ASSERT(get_image_width(roi) == 200 && get_image_height(roi) == 100, "Wrong ROI geometry");
+    TEST_ASSERT(get_image_data(roi) == buffer + 50 * stride + 100, "ROI must point into the external buffer");
+
+    RoiRect outside = {IMAGE_WIDTH + 10, 0, 50, 50};
+    TEST_ASSERT(image_pool_acquire_roi_view(pool, view, outside) == NULL, "ROI outside the image must fail");
+
+    image_pool_release(pool, roi);
+    image_pool_release(pool, view);
+
+    // Released view entries are reused for the next view
+    ImageHandle* again = image_pool_acquire_view(pool, buffer, IMAGE_WIDTH, IMAGE_HEIGHT, 1, stride);
+    TEST_ASSERT(again == view || again == roi, "Released view entry not reused");
+    image_pool_release(pool, again);
+
+    image_pool_destroy(pool);
+    free(buffer);
+    return 0;
+}
+
+static int test_exhausted(void) {
+    ImagePool* pool = image_pool_create(POOL_SIZE);
+    TEST_ASSERT(pool != NULL, "Pool creation failed");
+
+    ImageHandle* images[POOL_SIZE + 2];
+    for (int i = 0; i < POOL_SIZE + 2; i++) {
+        images[i] = image_pool_acquire(pool, IMAGE_WIDTH, IMAGE_HEIGHT, 1);
+        TEST_ASSERT(images[i] != NULL, "Acquire must not fail when exhausted");
+    }
+    for (int i = 0; i < POOL_SIZE + 2; i++) {
+        for (int j = i + 1; j < POOL_SIZE + 2; j++) {
+            TEST_ASSERT(images[i] != images[j], "Handles must be distinct");
+        }
+    }
+
+    // Fallback images are freed by image_pool_release as well
+    for (int i = 0; i < POOL_SIZE + 2; i++) {
+        image_pool_release(pool, images[i]);
+    }
+
+    ImageHandle* reused = image_pool_acquire(pool, IMAGE_WIDTH, IMAGE_HEIGHT, 1);
+    int from_pool = 0;
+    for (int i = 0; i < POOL_SIZE; i++) {
+        if (reused == images[i]) from_pool = 1;
+    }
+    TEST_ASSERT(from_pool, "Acquire after release must come from the pool");
+    image_pool_release(pool, reused);
+
+    image_pool_destroy(pool);
+    return 0;
+}
+
+static int test_detect_into(void) {
+    ArucoDictionaryHandle* dict = rod_config_create_aruco_dictionary();
+    DetectorParametersHandle* params = createDetectorParameters();
+    TEST_ASSERT(dict != NULL && params != NULL, "Detector setup failed");
+    rod_config_configure_detector_parameters(params);
+    ArucoDetectorHandle* detector = createArucoDetector(dict, params);
+    TEST_ASSERT(detector != NULL, "Detector creation failed");
+
+    ImagePool* pool = image_pool_create(POOL_SIZE);
+    ImageHandle* blank = image_pool_acquire(pool, IMAGE_WIDTH, IMAGE_HEIGHT, 1);
+    TEST_ASSERT(blank != NULL, "Acquire failed");
+    memset(get_image_data(blank), 0x80, get_image_data_size(blank));
+
+    DetectedMarker storage[RESULT_CAPACITY];
+    DetectionResult result = {storage, -1};
+    DetectionResult no_storage = {NULL, 0};
+
+    TEST_ASSERT(detectMarkersInto(detector, blank, NULL, RESULT_CAPACITY) == -1, "NULL result must fail");
+    TEST_ASSERT(detectMarkersInto(detector, blank, &no_storage, RESULT_CAPACITY) == -1, "NULL storage must fail");
+    TEST_ASSERT(detectMarkersInto(detector, blank, &result, -1) == -1, "Negative capacity must fail");
+
+    int count = detectMarkersInto(detector, blank, &result, RESULT_CAPACITY);
+    TEST_ASSERT(count == 0 && result.count == 0, "Blank image must give no marker");
+    TEST_ASSERT(result.markers == storage, "Caller storage must be kept");
+
+    // Same answer as the allocating variant
+    DetectionResult* allocated = detectMarkersWithConfidence(detector, blank);
+    TEST_ASSERT(allocated != NULL && allocated->count == count, "Allocating variant differs");
+    releaseDetectionResult(allocated);
+
+    image_pool_release(pool, blank);
+    image_pool_destroy(pool);
+    releaseArucoDetector(detector);
+    releaseDetectorParameters(params);
+    releaseArucoDictionary(dict);
+    return 0;
+}
+
+typedef struct {
+    const char* name;
+    int (*func)(void);
+} TestCase;
+
+static const TestCase TESTS[] = {
+    {"Create", test_create},
+    {"Buffer reuse", test_reuse},
+    {"Views", test_views},
+    {"Exhausted pool", test_exhausted},
+    {"Detection into caller storage", test_detect_into}
+};
+
+#define NUM_TESTS (sizeof(TESTS) / sizeof(TestCase))
+
+int main() {
+    printf("========================================\n");
+    printf("Image Pool Test\n");
+    printf("========================================\n");
+    printf("Number of tests: %zu\n", NUM_TESTS);
+    printf("========================================\n\n");
+
+    for (size_t i = 0; i < NUM_TESTS; i++) {
+        printf("[%zu/%zu] %s... ", i + 1, NUM_TESTS, TESTS[i].name);
+        fflush(stdout);
+
+        if (TESTS[i].func() == 0) {
+            printf(COLOR_GREEN "PASS" COLOR_RESET "\n");
+            test_passed++;
+        } else {
+            printf(COLOR_RED "FAIL" COLOR_RESET "\n");
+            test_failed++;
+        }
+    }
+
+    printf("\n========================================\n");
+    printf("Results: %d passed, %d failed\n", test_passed, test_failed);
+    printf("========================================\n");
+
+    return (test_failed == 0) ? 0 : 1;
+}
@@ -0,0 +1,222 @@
+/**
+ * test_localization_grid.c
+ * 
+ * Validates the precomputed pixel -> playground localization grid against
+ * the exact undistort + homography path (localize_markers_in_playground).
+ * 
+ * Tests:
+ * - Create with invalid parameters
+ * - Rebuild only when the homography changes
+ * - Bilinear lookup matches the exact path (whole image, out of image)
+ * - Marker localization matches the exact path (IDs, angles, pixels, mm)
+ */
+
+#include "rod_localization_grid.h"
+#include "rod_cv.h"
+#include "opencv_wrapper.h"
+#include "rod_config.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+// ANSI color codes
+#define COLOR_RED "\033[1;31m"
+#define COLOR_GREEN "\033[1;32m"
+#define COLOR_RESET "\033[0m"
+
+// Test case counter
+static int test_passed = 0;
+static int test_failed = 0;
+
+// Helper macro for test assertions
+#define TEST_ASSERT(condition, message) \
+    do { \
+        if (!(condition)) { \
+            fprintf(stderr, "    ASSERTION FAILED: %s\n", message); \
+            return -1; \
+        } \
+    } while(0)
+
+#define IMAGE_WIDTH 4000
+#define IMAGE_HEIGHT 4000
+#define GRID_CELL 16
+#define TOLERANCE_MM 0.5f     // Bilinear interpolation error bound (measured < 0.2mm with cell 16)
+#define RANDOM_POINTS 5000
+#define RANDOM_MARKERS 40
+
+// Synthetic inverse homography (pixel -> mm), slight perspective
+static const float HOMOGRAPHY_INV[9] = {
+    0.75f, 0.02f, -100.0f,
+    0.01f, 0.5f, -50.0f,
+    1e-6f, 2e-6f, 1.0f
+};
+
+static float random_range(float min, float max) {
+    return min + (max - min) * ((float)rand() / (float)RAND_MAX);
+}
+
+static int exact_transform(Point2f pixel, Point2f* terrain) {
+    Point2f undistorted;
+    const float* K = rod_config_get_camera_matrix();
+    const float* D = rod_config_get_distortion_coeffs();
+    if (fisheye_undistort_points_into(&pixel, 1, K, D, K, &undistorted) != 0) return -1;
+    return perspective_transform_into(&undistorted, 1, HOMOGRAPHY_INV, terrain);
+}
+
+/**
+ * Test 1: Invalid parameters are rejected
+ */
+int test_create() {
+    TEST_ASSERT(rod_localization_grid_create(0, IMAGE_HEIGHT, GRID_CELL) == NULL, "zero width must fail");
+    TEST_ASSERT(rod_localization_grid_create(IMAGE_WIDTH, IMAGE_HEIGHT, 0) == NULL, "zero cell must fail");
+    
+    RodLocalizationGrid* grid = rod_localization_grid_create(IMAGE_WIDTH, IMAGE_HEIGHT, GRID_CELL);
+    TEST_ASSERT(grid != NULL, "create must succeed");
+    TEST_ASSERT(rod_localization_grid_matches(grid, IMAGE_WIDTH, IMAGE_HEIGHT), "grid must match its size");
+    TEST_ASSERT(!rod_localization_grid_matches(grid, IMAGE_WIDTH / 2, IMAGE_HEIGHT), "grid must not match other sizes");
+    
+    Point2f terrain;
+    Point2f pixel = {100.0f, 100.0f};
+    TEST_ASSERT(rod_localization_grid_lookup(grid, pixel, &terrain) == -1, "lookup before update must fail");
+    
+    rod_localization_grid_destroy(grid);
+    return 0;
+}
+
+/**
+ * Test 2: Grid is rebuilt only when the homography changes
+ */
+int test_update() {
+    RodLocalizationGrid* grid = rod_localization_grid_create(IMAGE_WIDTH, IMAGE_HEIGHT, GRID_CELL);
+    TEST_ASSERT(grid != NULL, "create must succeed");
+    
+    TEST_ASSERT(rod_localization_grid_update(grid, HOMOGRAPHY_INV) == 1, "first update must rebuild");
+    TEST_ASSERT(rod_localization_grid_update(grid, HOMOGRAPHY_INV) == 0, "same homography must not rebuild");
+    
+    float changed[9];
+    memcpy(changed, HOMOGRAPHY_INV, sizeof(changed));
+    changed[2] += 1.0f;
+    TEST_ASSERT(rod_localization_grid_update(grid, changed) == 1, "new homography must rebuild");
+    TEST_ASSERT(rod_localization_grid_update(grid, NULL) == -1, "NULL homography must fail");
+    
+    rod_localization_grid_destroy(grid);
+    return 0;
+}
+
+/**
+ * Test 3: Lookup matches the exact transformation
+ */
+int test_lookup_accuracy() {
+    RodLocalizationGrid* grid = rod_localization_grid_create(IMAGE_WIDTH, IMAGE_HEIGHT, GRID_CELL);
+    TEST_ASSERT(grid != NULL, "create must succeed");
+    TEST_ASSERT(rod_localization_grid_update(grid, HOMOGRAPHY_INV) == 1, "update must succeed");
+    
+    float max_error = 0.0f;
+    srand(42);
+    for (int i = 0; i < RANDOM_POINTS; i++) {
+        // Include a margin outside the image (exact fallback path)
+        Point2f pixel = {random_range(-50.0f, IMAGE_WIDTH + 50.0f), random_range(-50.0f, IMAGE_HEIGHT + 50.0f)};
+        Point2f from_grid, exact;
+        TEST_ASSERT(rod_localization_grid_lookup(grid, pixel, &from_grid) == 0, "lookup must succeed");
+        TEST_ASSERT(exact_transform(pixel, &exact) == 0, "exact transform must succeed");
+        
+        float error = hypotf(from_grid.x - exact.x, from_grid.y - exact.y);
+        if (error > max_error) max_error = error;
+    }
+    printf("(max error %.3fmm) ", max_error);
+    TEST_ASSERT(max_error < TOLERANCE_MM, "grid lookup must match the exact transformation");
+    
+    rod_localization_grid_destroy(grid);
+    return 0;
+}
+
+/**
+ * Test 4: Marker localization matches localize_markers_in_playground()
+ */
+int test_localize_markers() {
+    static const int ids[] = {1, 6, 20, 36, 41, 47, 99};  // 99 is not a valid ID
+    const int num_ids = sizeof(ids) / sizeof(ids[0]);
+    
+    DetectedMarker detected[RANDOM_MARKERS];
+    DetectionResult detection = {detected, RANDOM_MARKERS};
+    srand(7);
+    for (int i = 0; i < RANDOM_MARKERS; i++) {
+        float cx = random_range(100.0f, IMAGE_WIDTH - 100.0f);
+        float cy = random_range(100.0f, IMAGE_HEIGHT - 100.0f);
+        float half = random_range(20.0f, 60.0f);
+        detected[i].id = ids[i % num_ids];
+        detected[i].confidence = 1.0f;
+        detected[i].corners[0][0] = cx - half; detected[i].corners[0][1] = cy - half;
+        detected[i].corners[1][0] = cx + half; detected[i].corners[1][1] = cy - half;
+        detected[i].corners[2][0] = cx + half; detected[i].corners[2][1] = cy + half;
+        detected[i].corners[3][0] = cx - half; detected[i].corners[3][1] = cy + half;
+    }
+    
+    MarkerData exact[RANDOM_MARKERS];
+    MarkerData from_grid[RANDOM_MARKERS];
+    int exact_count = localize_markers_in_playground(&detection, exact, RANDOM_MARKERS, HOMOGRAPHY_INV);
+    
+    RodLocalizationGrid* grid = rod_localization_grid_create(IMAGE_WIDTH, IMAGE_HEIGHT, GRID_CELL);
+    TEST_ASSERT(grid != NULL, "create must succeed");
+    TEST_ASSERT(rod_localization_grid_update(grid, HOMOGRAPHY_INV) == 1, "update must succeed");
+    int grid_count = rod_localization_grid_localize_markers(grid, &detection, from_grid, RANDOM_MARKERS);
+    rod_localization_grid_destroy(grid);
+    
+    TEST_ASSERT(exact_count > 0, "some markers must be localized");
+    TEST_ASSERT(exact_count < RANDOM_MARKERS, "invalid IDs must be skipped");
+    TEST_ASSERT(grid_count == exact_count, "both paths must keep the same markers");
+    
+    for (int i = 0; i < exact_count; i++) {
+        TEST_ASSERT(from_grid[i].id == exact[i].id, "IDs must match");
+        TEST_ASSERT(from_grid[i].angle == exact[i].angle, "angles must match");
+        TEST_ASSERT(from_grid[i].pixel_x == exact[i].pixel_x && from_grid[i].pixel_y == exact[i].pixel_y,
+                    "pixel positions must match");
+        TEST_ASSERT(hypotf(from_grid[i].x - exact[i].x, from_grid[i].y - exact[i].y) < TOLERANCE_MM,
+                    "playground positions must match");
+    }
+    
+    return 0;
+}
+
+// Test suite definition
+typedef struct {
+    const char* name;
+    int (*func)();
+} TestCase;
+
+static const TestCase TESTS[] = {
+    {"Create", test_create},
+    {"Rebuild on homography change", test_update},
+    {"Lookup accuracy", test_lookup_accuracy},
+    {"Marker localization", test_localize_markers}
+};
+
+#define NUM_TESTS (sizeof(TESTS) / sizeof(TestCase))
+
+int main() {
+    printf("========================================\n");
+    printf("Localization Grid Test\n");
+    printf("========================================\n");
+    printf("Number of tests: %zu\n", NUM_TESTS);
+    printf("========================================\n\n");
+    
+    for (size_t i = 0; i < NUM_TESTS; i++) {
+        printf("[%zu/%zu] %s... ", i + 1, NUM_TESTS, TESTS[i].name);
+        fflush(stdout);
+        
+        if (TESTS[i].func() == 0) {
+            printf(COLOR_GREEN "PASS" COLOR_RESET "\n");
+            test_passed++;
+        } else {
+            printf(COLOR_RED "FAIL" COLOR_RESET "\n");
+            test_failed++;
+        }
+    }
+    
+    printf("\n========================================\n");
+    printf("Results: %d passed, %d failed\n", test_passed, test_failed);
+    printf("========================================\n");
+    
+    return (test_failed == 0) ? 0 : 1;
+}
@@ -0,0 +1,302 @@
+/**
+ * test_marker_filter.c
+ *
+ * Validates the per marker alpha-beta filter applied before publication.
+ *
+ * Tests:
+ * - Create with invalid parameters
+ * - Confirmation: a new marker is only sent from its second measurement
+ * - Still marker: jitter is reduced
+ * - Moving marker: no lag once the velocity converged, angle wrap at +-pi
+ * - Missed frames: predicted position with increasing age, then dropped
+ * - Outlier: a single far reading neither moves the track nor is sent
+ * - Same ID twice: two tracks kept apart
+ */
+
+#include "rod_marker_filter.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <stdbool.h>
+
+// ANSI color codes
+#define COLOR_RED "\033[1;31m"
+#define COLOR_GREEN "\033[1;32m"
+#define COLOR_RESET "\033[0m"
+
+// Test case counter
+static int test_passed = 0;
+static int test_failed = 0;
+
+// Helper macro for test assertions
+#define TEST_ASSERT(condition, message) \
+    do { \
+        if (!(condition)) { \
+            fprintf(stderr, "    ASSERTION FAILED: %s\n", message); \
+            return -1; \
+        } \
+    } while(0)
+
+#define FRAME_US 33333ULL     // 30 fps
+#define ALPHA 0.5f
+#define BETA 0.17f
+#define GATE_MM 150.0f
+#define CONFIRM_HITS 2
+#define MAX_AGE_MS 300
+#define OUTPUT_SIZE 16
+
+static float random_range(float min, float max) {
+    return min + (max - min) * ((float)rand() / (float)RAND_MAX);
+}
+
+static MarkerData make_marker(int id, float x, float y, float angle) {
+    MarkerData marker = {id, x, y, angle, x / 2.0f, y / 2.0f, 0};
+    return marker;
+}
+
+static RodMarkerFilter* create_filter(float velocity_decay) {
+    return rod_marker_filter_create(ALPHA, BETA, GATE_MM, CONFIRM_HITS, MAX_AGE_MS, velocity_decay);
+}
+
+/**
+ * Test 1: Invalid parameters are rejected
+ */
+int test_create() {
+    TEST_ASSERT(rod_marker_filter_create(0.0f, BETA, GATE_MM, CONFIRM_HITS, MAX_AGE_MS, 0.8f) == NULL, "alpha 0 must fail");
+    TEST_ASSERT(rod_marker_filter_create(1.5f, BETA, GATE_MM, CONFIRM_HITS, MAX_AGE_MS, 0.8f) == NULL, "alpha > 1 must fail");
+    TEST_ASSERT(rod_marker_filter_create(ALPHA, 2.0f, GATE_MM, CONFIRM_HITS, MAX_AGE_MS, 0.8f) == NULL, "beta 2 must fail");
+    TEST_ASSERT(rod_marker_filter_create(ALPHA, BETA, 0.0f, CONFIRM_HITS, MAX_AGE_MS, 0.8f) == NULL, "gate 0 must fail");
+    TEST_ASSERT(rod_marker_filter_create(ALPHA, BETA, GATE_MM, 0, MAX_AGE_MS, 0.8f) == NULL, "0 hits must fail");
+    TEST_ASSERT(rod_marker_filter_create(ALPHA, BETA, GATE_MM, CONFIRM_HITS, MAX_AGE_MS, 1.5f) == NULL, "decay > 1 must fail");
+
+    RodMarkerFilter* filter = create_filter(0.8f);
+    TEST_ASSERT(filter != NULL, "create must succeed");
+    MarkerData output[OUTPUT_SIZE];
+    TEST_ASSERT(rod_marker_filter_update(filter, 0, NULL, 1, output, OUTPUT_SIZE) == -1, "NULL markers must fail");
+    TEST_ASSERT(rod_marker_filter_update(filter, 0, NULL, 0, output, OUTPUT_SIZE) == 0, "empty frame must succeed");
+    rod_marker_filter_destroy(filter);
+    rod_marker_filter_destroy(NULL);
+    return 0;
+}
+
+/**
+ * Test 2: A new marker is sent once confirmed, reset drops it
+ */
+int test_confirmation() {
+    RodMarkerFilter* filter = create_filter(0.8f);
+    TEST_ASSERT(filter != NULL, "create must succeed");
+
+    MarkerData marker = make_marker(3, 500.0f, 800.0f, 0.2f);
+    MarkerData output[OUTPUT_SIZE];
+    TEST_ASSERT(rod_marker_filter_update(filter, FRAME_US, &marker, 1, output, OUTPUT_SIZE) == 0,
+                "first measurement must not be sent");
+    TEST_ASSERT(rod_marker_filter_update(filter, 2 * FRAME_US, &marker, 1, output, OUTPUT_SIZE) == 1,
+                "second measurement must be sent");
+    TEST_ASSERT(output[0].id == 3 && output[0].age_us == 0, "measured marker must have age 0");
+    TEST_ASSERT(fabsf(output[0].x - 500.0f) < 1e-3f && fabsf(output[0].y - 800.0f) < 1e-3f, "still marker must stay");
+    TEST_ASSERT(output[0].pixel_x == 250.0f && output[0].pixel_y == 400.0f, "pixels must come from the measurement");
+
+    rod_marker_filter_reset(filter);
+    TEST_ASSERT(rod_marker_filter_update(filter, 3 * FRAME_US, &marker, 1, output, OUTPUT_SIZE) == 0,
+                "reset must drop the track");
+    rod_marker_filter_destroy(filter);
+    return 0;
+}
+
+/**
+ * Test 3: Jitter of a still marker is reduced
+ */
+int test_still_jitter() {
+    RodMarkerFilter* filter = create_filter(0.8f);
+    TEST_ASSERT(filter != NULL, "create must succeed");
+
+    const float x = 1000.0f, y = 1500.0f, noise = 6.0f;
+    double raw_error = 0.0, filtered_error = 0.0;
+    int samples = 0;
+    MarkerData output[OUTPUT_SIZE];
+    for (int f = 1; f <= 300; f++) {
+        MarkerData marker = make_marker(7, x + random_range(-noise, noise), y + random_range(-noise, noise), 0.0f);
+        int count = rod_marker_filter_update(filter, f * FRAME_US, &marker, 1, output, OUTPUT_SIZE);
+        TEST_ASSERT(count == (f >= CONFIRM_HITS ? 1 : 0), "one track expected");
+        if (f > 30) {
+            raw_error += (marker.x - x) * (marker.x - x) + (marker.y - y) * (marker.y - y);
+            filtered_error += (output[0].x - x) * (output[0].x - x) + (output[0].y - y) * (output[0].y - y);
+            samples++;
+        }
+    }
+    raw_error = sqrt(raw_error / samples);
+    filtered_error = sqrt(filtered_error / samples);
+    printf("(rms raw %.2f mm, filtered %.2f mm) ", raw_error, filtered_error);
+    TEST_ASSERT(filtered_error < 0.8 * raw_error, "filter must reduce jitter");
+
+    rod_marker_filter_destroy(filter);
+    return 0;
+}
+
+/**
+ * Test 4: A marker moving at constant speed is followed without lag
+ */
+int test_moving() {
+    RodMarkerFilter* filter = create_filter(0.8f);
+    TEST_ASSERT(filter != NULL, "create must succeed");
+
+    const float vx = 400.0f, vy = -250.0f, omega = 2.0f;  // mm/s, rad/s
+    MarkerData output[OUTPUT_SIZE];
+    for (int f = 1; f <= 90; f++) {
+        float t = f * FRAME_US * 1e-6f;
+        float angle = remainderf(3.0f + omega * t, 2.0f * (float)M_PI);  // Crosses +-pi
+        MarkerData marker = make_marker(2, 200.0f + vx * t, 2500.0f + vy * t, angle);
+        int count = rod_marker_filter_update(filter, f * FRAME_US, &marker, 1, output, OUTPUT_SIZE);
+        TEST_ASSERT(count == (f >= CONFIRM_HITS ? 1 : 0), "one track expected");
+        if (f > 60) {
+            TEST_ASSERT(hypotf(output[0].x - marker.x, output[0].y - marker.y) < 2.0f, "filter must not lag");
+            TEST_ASSERT(fabsf(remainderf(output[0].angle - angle, 2.0f * (float)M_PI)) < 0.01f,
+                        "angle must follow across +-pi");
+            TEST_ASSERT(output[0].angle >= -(float)M_PI && output[0].angle <= (float)M_PI, "angle must stay wrapped");
+        }
+    }
+
+    rod_marker_filter_destroy(filter);
+    return 0;
+}
+
+/**
+ * Test 5: Missed frames are predicted with their age, then the marker is dropped
+ */
+int test_missed_frames() {
+    RodMarkerFilter* filter = create_filter(1.0f);
+    TEST_ASSERT(filter != NULL, "create must succeed");
+
+    const float vx = 300.0f;
+    MarkerData output[OUTPUT_SIZE];
+    int f = 1;
+    for (; f <= 60; f++) {
+        MarkerData marker = make_marker(4, 100.0f + vx * f * FRAME_US * 1e-6f, 1000.0f, 0.0f);
+        rod_marker_filter_update(filter, f * FRAME_US, &marker, 1, output, OUTPUT_SIZE);
+    }
+    int last_measured = f - 1;
+
+    for (int miss = 1; miss <= 3; miss++, f++) {
+        int count = rod_marker_filter_update(filter, f * FRAME_US, NULL, 0, output, OUTPUT_SIZE);
+        TEST_ASSERT(count == 1, "missed marker must still be sent");
+        TEST_ASSERT(output[0].age_us == (uint32_t)(miss * FRAME_US), "age must count the missed frames");
+        float expected_x = 100.0f + vx * f * FRAME_US * 1e-6f;
+        TEST_ASSERT(fabsf(output[0].x - expected_x) < 3.0f, "missed marker must be predicted");
+    }
+
+    // Still predicted just before max age, dropped after
+    uint64_t limit_us = last_measured * FRAME_US + MAX_AGE_MS * 1000ULL;
+    TEST_ASSERT(rod_marker_filter_update(filter, limit_us, NULL, 0, output, OUTPUT_SIZE) == 1, "kept up to max age");
+    TEST_ASSERT(rod_marker_filter_update(filter, limit_us + 1, NULL, 0, output, OUTPUT_SIZE) == 0, "dropped after max age");
+
+    rod_marker_filter_destroy(filter);
+    return 0;
+}
+
+/**
+ * Test 6: One far reading does not move the track and is not sent
+ */
+int test_outlier() {
+    RodMarkerFilter* filter = create_filter(0.8f);
+    TEST_ASSERT(filter != NULL, "create must succeed");
+
+    MarkerData output[OUTPUT_SIZE];
+    MarkerData marker = make_marker(5, 1200.0f, 600.0f, 1.0f);
+    int f = 1;
+    for (; f <= 10; f++) {
+        rod_marker_filter_update(filter, f * FRAME_US, &marker, 1, output, OUTPUT_SIZE);
+    }
+
+    MarkerData wrong = make_marker(5, 1200.0f + 3.0f * GATE_MM, 600.0f, 1.0f);
+    int count = rod_marker_filter_update(filter, f++ * FRAME_US, &wrong, 1, output, OUTPUT_SIZE);
+    TEST_ASSERT(count == 1, "only the established track must be sent");
+    TEST_ASSERT(fabsf(output[0].x - 1200.0f) < 1e-3f, "outlier must not move the track");
+    TEST_ASSERT(output[0].age_us == FRAME_US, "track not measured in the outlier frame");
+
+    count = rod_marker_filter_update(filter, f++ * FRAME_US, &marker, 1, output, OUTPUT_SIZE);
+    TEST_ASSERT(count == 1 && output[0].age_us == 0, "track must be measured again");
+    TEST_ASSERT(fabsf(output[0].x - 1200.0f) < 1e-3f, "track must stay in place");
+
+    rod_marker_filter_destroy(filter);
+    return 0;
+}
+
+/**
+ * Test 7: Two markers sharing an ID keep their own tracks
+ */
+int test_same_id() {
+    RodMarkerFilter* filter = create_filter(0.8f);
+    TEST_ASSERT(filter != NULL, "create must succeed");
+
+    MarkerData output[OUTPUT_SIZE];
+    int count = 0;
+    for (int f = 1; f <= 20; f++) {
+        // Order changes every frame: association must not depend on it
+        MarkerData markers[2] = {
+            make_marker(36, 500.0f, 500.0f, 0.0f),
+            make_marker(36, 900.0f, 500.0f, 0.5f)
+        };
+        if (f % 2) {
+            MarkerData swap = markers[0];
+            markers[0] = markers[1];
+            markers[1] = swap;
+        }
+        count = rod_marker_filter_update(filter, f * FRAME_US, markers, 2, output, OUTPUT_SIZE);
+    }
+    TEST_ASSERT(count == 2, "two tracks expected");
+    for (int i = 0; i < count; i++) {
+        bool first = fabsf(output[i].x - 500.0f) < 1e-3f && fabsf(output[i].angle) < 1e-3f;
+        bool second = fabsf(output[i].x - 900.0f) < 1e-3f && fabsf(output[i].angle - 0.5f) < 1e-3f;
+        TEST_ASSERT(output[i].id == 36 && (first || second), "tracks must not mix");
+    }
+    TEST_ASSERT(fabsf(output[0].x - output[1].x) > 1.0f, "tracks must be distinct");
+
+    rod_marker_filter_destroy(filter);
+    return 0;
+}
+
+typedef struct {
+    const char* name;
+    int (*func)(void);
+} TestCase;
+
+static const TestCase TESTS[] = {
+    {"Create", test_create},
+    {"Confirmation", test_confirmation},
+    {"Still marker jitter", test_still_jitter},
+    {"Moving marker", test_moving},
+    {"Missed frames", test_missed_frames},
+    {"Outlier", test_outlier},
+    {"Same ID twice", test_same_id}
+};
+
+#define NUM_TESTS (sizeof(TESTS) / sizeof(TestCase))
+
+int main() {
+    printf("========================================\n");
+    printf("Marker Filter Test\n");
+    printf("========================================\n");
+    printf("Number of tests: %zu\n", NUM_TESTS);
+    printf("========================================\n\n");
+
+    srand(42);
+    for (size_t i = 0; i < NUM_TESTS; i++) {
+        printf("[%zu/%zu] %s... ", i + 1, NUM_TESTS, TESTS[i].name);
+        fflush(stdout);
+
+        if (TESTS[i].func() == 0) {
+            printf(COLOR_GREEN "PASS" COLOR_RESET "\n");
+            test_passed++;
+        } else {
+            printf(COLOR_RED "FAIL" COLOR_RESET "\n");
+            test_failed++;
+        }
+    }
+
+    printf("\n========================================\n");
+    printf("Results: %d passed, %d failed\n", test_passed, test_failed);
+    printf("========================================\n");
+
+    return (test_failed == 0) ? 0 : 1;
+}
@@ -0,0 +1,255 @@
+/**
+ * test_marker_pose.c
+ *
+ * Validates the batched marker pose estimation (estimate_marker_poses).
+ *
+ * Markers are projected with the pinhole model of the camera matrix and
+ * estimated without distortion, so the expected pose is known exactly.
+ *
+ * Tests:
+ * - Invalid arguments
+ * - Single marker: translation and yaw recovered
+ * - Per ID size: same corners, depth scales with rod_config_get_marker_size
+ * - ID range and capacity: only the requested IDs, at most max_poses
+ * - More markers than one batch: every marker solved
+ * - Warm start: a previous pose of the same marker gives the same pose back
+ */
+
+#include "rod_cv.h"
+#include "rod_config.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+// ANSI color codes
+#define COLOR_RED "\033[1;31m"
+#define COLOR_GREEN "\033[1;32m"
+#define COLOR_RESET "\033[0m"
+
+// Test case counter
+static int test_passed = 0;
+static int test_failed = 0;
+
+// Helper macro for test assertions
+#define TEST_ASSERT(condition, message) \
+    do { \
+        if (!(condition)) { \
+            fprintf(stderr, "    ASSERTION FAILED: %s\n", message); \
+            return -1; \
+        } \
+    } while(0)
+
+#define MAX_MARKERS 64
+#define DEPTH_MM 1200.0f
+#define TRANSLATION_TOLERANCE_MM 2.0f
+#define ANGLE_TOLERANCE_RAD 0.02f
+
+/**
+ * @brief Project a fronto-parallel marker (rotated by yaw around the optical axis) to pixel corners
+ */
+static void project_marker(DetectedMarker* marker, int id, float size, float x, float y, float z, float yaw) {
+    const float* K = rod_config_get_camera_matrix();
+    const float local[4][2] = {{-1, 1}, {1, 1}, {1, -1}, {-1, -1}};  // ArUco corner order
+    float half = size / 2.0f;
+
+    marker->id = id;
+    marker->confidence = 1.0f;
+    for (int k = 0; k < 4; k++) {
+        float lx = local[k][0] * half;
+        float ly = local[k][1] * half;
+        float cx = x + cosf(yaw) * lx - sinf(yaw) * ly;
+        float cy = y + sinf(yaw) * lx + cosf(yaw) * ly;
+        marker->corners[k][0] = K[0] * cx / z + K[2];
+        marker->corners[k][1] = K[4] * cy / z + K[5];
+    }
+}
+
+static const MarkerPose* find_pose(const MarkerPose* poses, int count, int id) {
+    for (int i = 0; i < count; i++) {
+        if (poses[i].id == id) return &poses[i];
+    }
+    return NULL;
+}
+
+static int test_invalid_arguments(void) {
+    DetectedMarker markers[1];
+    DetectionResult detection = {markers, 0};
+    MarkerPose poses[1];
+    const float* K = rod_config_get_camera_matrix();
+
+    TEST_ASSERT(estimate_marker_poses(NULL, 1, 10, K, NULL, NULL, 0, poses, 1) == -1, "NULL detection rejected");
+    TEST_ASSERT(estimate_marker_poses(&detection, 1, 10, NULL, NULL, NULL, 0, poses, 1) == -1, "NULL camera matrix rejected");
+    TEST_ASSERT(estimate_marker_poses(&detection, 1, 10, K, NULL, NULL, 0, NULL, 1) == -1, "NULL output rejected");
+    TEST_ASSERT(estimate_marker_poses(&detection, 1, 10, K, NULL, NULL, 2, poses, 1) == -1, "Previous count without poses rejected");
+    TEST_ASSERT(estimate_marker_poses(&detection, 1, 10, K, NULL, NULL, 0, poses, 1) == 0, "Empty detection gives no pose");
+    return 0;
+}
+
+static int test_single_marker(void) {
+    DetectedMarker markers[1];
+    DetectionResult detection = {markers, 1};
+    MarkerPose poses[1];
+    project_marker(&markers[0], 3, rod_config_get_marker_size(3), 150.0f, -80.0f, DEPTH_MM, 0.6f);
+
+    int count = estimate_marker_poses(&detection, 1, 10, rod_config_get_camera_matrix(), NULL, NULL, 0, poses, 1);
+    TEST_ASSERT(count == 1, "One pose");
+    TEST_ASSERT(poses[0].id == 3, "ID kept");
+    TEST_ASSERT(fabsf(poses[0].tvec[0] - 150.0f) < TRANSLATION_TOLERANCE_MM, "X recovered");
+    TEST_ASSERT(fabsf(poses[0].tvec[1] + 80.0f) < TRANSLATION_TOLERANCE_MM, "Y recovered");
+    TEST_ASSERT(fabsf(poses[0].tvec[2] - DEPTH_MM) < TRANSLATION_TOLERANCE_MM, "Depth recovered");
+
+    // Fronto-parallel: the rotation is the yaw around the optical axis
+    float angle = sqrtf(poses[0].rvec[0] * poses[0].rvec[0] + poses[0].rvec[1] * poses[0].rvec[1] +
+                        poses[0].rvec[2] * poses[0].rvec[2]);
+    TEST_ASSERT(fabsf(angle - 0.6f) < ANGLE_TOLERANCE_RAD, "Yaw recovered");
+
+    Point2f center = calculate_marker_center(markers[0].corners);
+    TEST_ASSERT(fabsf(poses[0].pixel_x - center.x) < 1e-3f && fabsf(poses[0].pixel_y - center.y) < 1e-3f,
+                "Pixel center kept");
+    return 0;
+}
+
+static int test_per_id_size(void) {
+    DetectedMarker markers[2];
+    DetectionResult detection = {markers, 2};
+    MarkerPose poses[2];
+
+    // Same pixel corners for a robot marker (70 mm) and a fixed marker (100 mm)
+    project_marker(&markers[0], 5, rod_config_get_marker_size(5), 0.0f, 0.0f, DEPTH_MM, 0.0f);
+    markers[1] = markers[0];
+    markers[1].id = 21;
+
+    int count = estimate_marker_poses(&detection, 1, 23, rod_config_get_camera_matrix(), NULL, NULL, 0, poses, 2);
+    TEST_ASSERT(count == 2, "Two poses");
+    const MarkerPose* robot = find_pose(poses, count, 5);
+    const MarkerPose* fixed = find_pose(poses, count, 21);
+    TEST_ASSERT(robot && fixed, "Both markers estimated");
+
+    float expected = DEPTH_MM * rod_config_get_marker_size(21) / rod_config_get_marker_size(5);
+    TEST_ASSERT(fabsf(robot->tvec[2] - DEPTH_MM) < TRANSLATION_TOLERANCE_MM, "Robot marker depth");
+    TEST_ASSERT(fabsf(fixed->tvec[2] - expected) < TRANSLATION_TOLERANCE_MM * 2.0f, "Fixed marker depth scaled by its size");
+    return 0;
+}
+
+static int test_id_range_and_capacity(void) {
+    DetectedMarker markers[5];
+    DetectionResult detection = {markers, 5};
+    MarkerPose poses[MAX_MARKERS];
+
+    project_marker(&markers[0], 2, 70.0f, -300.0f, 0.0f, DEPTH_MM, 0.0f);
+    project_marker(&markers[1], 22, 100.0f, 300.0f, 0.0f, DEPTH_MM, 0.0f);
+    project_marker(&markers[2], 36, 40.0f, 0.0f, 300.0f, DEPTH_MM, 0.0f);
+    project_marker(&markers[3], 8, 70.0f, 0.0f, -300.0f, DEPTH_MM, 0.0f);
+    project_marker(&markers[4], 9, 70.0f, 100.0f, 100.0f, DEPTH_MM, 0.0f);
+
+    const float* K = rod_config_get_camera_matrix();
+    int count = estimate_marker_poses(&detection, 1, 10, K, NULL, NULL, 0, poses, MAX_MARKERS);
+    TEST_ASSERT(count == 3, "Only robot markers");
+    for (int i = 0; i < count; i++) {
+        TEST_ASSERT(poses[i].id >= 1 && poses[i].id <= 10, "Robot ID");
+    }
+
+    count = estimate_marker_poses(&detection, 1, 10, K, NULL, NULL, 0, poses, 2);
+    TEST_ASSERT(count == 2, "Capacity respected");
+
+    // IDs without a size (not in the rules) are skipped
+    markers[0].id = 12;
+    count = estimate_marker_poses(&detection, 0, 50, K, NULL, NULL, 0, poses, MAX_MARKERS);
+    TEST_ASSERT(count == 4, "Unknown ID skipped");
+    return 0;
+}
+
+static int test_many_markers(void) {
+    DetectedMarker markers[MAX_MARKERS];
+    DetectionResult detection = {markers, MAX_MARKERS};
+    MarkerPose poses[MAX_MARKERS];
+
+    // 8 x 8 grid of robot markers, more than one batch
+    for (int i = 0; i < MAX_MARKERS; i++) {
+        float x = -560.0f + 160.0f * (float)(i % 8);
+        float y = -560.0f + 160.0f * (float)(i / 8);
+        project_marker(&markers[i], 1 + i % 10, 70.0f, x, y, DEPTH_MM, 0.1f * (float)(i % 7));
+    }
+
+    int count = estimate_marker_poses(&detection, 1, 10, rod_config_get_camera_matrix(), NULL, NULL, 0,
+                                      poses, MAX_MARKERS);
+    TEST_ASSERT(count == MAX_MARKERS, "Every marker estimated");
+    for (int i = 0; i < count; i++) {
+        float x = -560.0f + 160.0f * (float)(i % 8);
+        float y = -560.0f + 160.0f * (float)(i / 8);
+        TEST_ASSERT(poses[i].id == 1 + i % 10, "Detection order kept");
+        TEST_ASSERT(fabsf(poses[i].tvec[0] - x) < TRANSLATION_TOLERANCE_MM &&
+                    fabsf(poses[i].tvec[1] - y) < TRANSLATION_TOLERANCE_MM &&
+                    fabsf(poses[i].tvec[2] - DEPTH_MM) < TRANSLATION_TOLERANCE_MM, "Translation recovered");
+    }
+    return 0;
+}
+
+static int test_warm_start(void) {
+    DetectedMarker markers[1];
+    DetectionResult detection = {markers, 1};
+    MarkerPose previous[1];
+    MarkerPose poses[1];
+    const float* K = rod_config_get_camera_matrix();
+
+    project_marker(&markers[0], 7, 70.0f, 200.0f, 50.0f, DEPTH_MM, -0.4f);
+    TEST_ASSERT(estimate_marker_poses(&detection, 1, 10, K, NULL, NULL, 0, previous, 1) == 1, "Cold start");
+
+    // Next frame: the marker moved a bit, the previous pose is passed back
+    project_marker(&markers[0], 7, 70.0f, 204.0f, 52.0f, DEPTH_MM, -0.41f);
+    TEST_ASSERT(estimate_marker_poses(&detection, 1, 10, K, NULL, previous, 1, poses, 1) == 1, "Warm start");
+    TEST_ASSERT(fabsf(poses[0].tvec[0] - 204.0f) < TRANSLATION_TOLERANCE_MM &&
+                fabsf(poses[0].tvec[1] - 52.0f) < TRANSLATION_TOLERANCE_MM, "Translation follows the marker");
+    for (int i = 0; i < 3; i++) {
+        TEST_ASSERT(fabsf(poses[0].rvec[i] - previous[0].rvec[i]) < 0.05f, "Rotation consistent with the previous frame");
+    }
+
+    // A previous pose of another ID is not used, and does not prevent the estimation
+    previous[0].id = 8;
+    TEST_ASSERT(estimate_marker_poses(&detection, 1, 10, K, NULL, previous, 1, poses, 1) == 1, "Other ID ignored");
+    return 0;
+}
+
+typedef struct {
+    const char* name;
+    int (*func)(void);
+} TestCase;
+
+static const TestCase TESTS[] = {
+    {"Invalid arguments", test_invalid_arguments},
+    {"Single marker", test_single_marker},
+    {"Per ID size", test_per_id_size},
+    {"ID range and capacity", test_id_range_and_capacity},
+    {"More markers than one batch", test_many_markers},
+    {"Warm start", test_warm_start}
+};
+
+#define NUM_TESTS (sizeof(TESTS) / sizeof(TestCase))
+
+int main() {
+    printf("========================================\n");
+    printf("Marker Pose Test\n");
+    printf("========================================\n");
+    printf("Number of tests: %zu\n", NUM_TESTS);
+    printf("========================================\n\n");
+
+    for (size_t i = 0; i < NUM_TESTS; i++) {
+        printf("[%zu/%zu] %s... ", i + 1, NUM_TESTS, TESTS[i].name);
+        fflush(stdout);
+
+        if (TESTS[i].func() == 0) {
+            printf(COLOR_GREEN "PASS" COLOR_RESET "\n");
+            test_passed++;
+        } else {
+            printf(COLOR_RED "FAIL" COLOR_RESET "\n");
+            test_failed++;
+        }
+    }
+
+    printf("\n========================================\n");
+    printf("Results: %d passed, %d failed\n", test_passed, test_failed);
+    printf("========================================\n");
+
+    return (test_failed == 0) ? 0 : 1;
+}
@@ -0,0 +1,236 @@
+/**
+ * test_metrics.c
+ *
+ * Validates the per-stage latency histograms and counters of the detection pipeline.
+ *
+ * Tests:
+ * - Empty metrics (zero summary, NULL handling)
+ * - Percentiles and maximum (exact small values, bounded relative error above)
+ * - Concurrent recording from several threads (no lost sample)
+ * - Text report and atomic file dump
+ */
+
+#define _POSIX_C_SOURCE 200809L  // Required for mkdtemp
+
+#include "rod_metrics.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <pthread.h>
+#include <unistd.h>
+
+// ANSI color codes
+#define COLOR_RED "\033[1;31m"
+#define COLOR_GREEN "\033[1;32m"
+#define COLOR_RESET "\033[0m"
+
+// Test case counter
+static int test_passed = 0;
+static int test_failed = 0;
+
+// Helper macro for test assertions
+#define TEST_ASSERT(condition, message) \
+    do { \
+        if (!(condition)) { \
+            fprintf(stderr, "    ASSERTION FAILED: %s\n", message); \
+            return -1; \
+        } \
+    } while(0)
+
+#define RELATIVE_ERROR 0.07   // 16 sub-buckets per power of two: < 1/16 + rounding
+#define THREAD_COUNT 4
+#define SAMPLES_PER_THREAD 100000
+
+static int test_empty(void) {
+    RodMetrics* metrics = rod_metrics_create();
+    TEST_ASSERT(metrics != NULL, "Metrics creation failed");
+
+    RodMetricSummary summary;
+    rod_metrics_get_summary(metrics, ROD_METRIC_DETECT, &summary);
+    TEST_ASSERT(summary.count == 0 && summary.p99_ms == 0.0 && summary.max_ms == 0.0, "Empty summary must be zero");
+    TEST_ASSERT(rod_metrics_get_counter(metrics, ROD_COUNTER_DROPPED) == 0, "Counter must start at zero");
+    TEST_ASSERT(strcmp(rod_metrics_name(ROD_METRIC_DETECT), "detect") == 0, "Wrong metric name");
+    TEST_ASSERT(strcmp(rod_metrics_name(ROD_METRIC_COUNT), "unknown") == 0, "Out of range name");
+
+    // NULL and out of range are ignored
+    rod_metrics_record(NULL, ROD_METRIC_DETECT, 1.0);
+    rod_metrics_record(metrics, ROD_METRIC_COUNT, 1.0);
+    rod_metrics_increment(NULL, ROD_COUNTER_FRAMES);
+    rod_metrics_get_summary(NULL, ROD_METRIC_DETECT, &summary);
+    TEST_ASSERT(summary.count == 0, "NULL metrics summary must be zero");
+
+    rod_metrics_destroy(metrics);
+    return 0;
+}
+
+static int test_percentiles(void) {
+    RodMetrics* metrics = rod_metrics_create();
+    TEST_ASSERT(metrics != NULL, "Metrics creation failed");
+
+    // Sub-16 us values are exact
+    for (int i = 0; i < 10; i++) {
+        rod_metrics_record(metrics, ROD_METRIC_SEND, 0.005);
+    }
+    RodMetricSummary summary;
+    rod_metrics_get_summary(metrics, ROD_METRIC_SEND, &summary);
+    TEST_ASSERT(summary.count == 10, "Wrong count");
+    TEST_ASSERT(fabs(summary.p50_ms - 0.005) < 1e-9 && fabs(summary.max_ms - 0.005) < 1e-9, "Small values must be exact");
+
+    // 1..1000 ms uniform: p50 ~ 500, p99 ~ 990, max exact
+    for (int i = 1; i <= 1000; i++) {
+        rod_metrics_record(metrics, ROD_METRIC_DETECT, (double)i);
+    }
+    rod_metrics_get_summary(metrics, ROD_METRIC_DETECT, &summary);
+    TEST_ASSERT(summary.count == 1000, "Wrong count");
+    TEST_ASSERT(fabs(summary.p50_ms - 500.0) / 500.0 < RELATIVE_ERROR, "p50 out of tolerance");
+    TEST_ASSERT(fabs(summary.p99_ms - 990.0) / 990.0 < RELATIVE_ERROR, "p99 out of tolerance");
+    TEST_ASSERT(fabs(summary.max_ms - 1000.0) < 1e-6, "Max must be exact");
+    TEST_ASSERT(fabs(summary.mean_ms - 500.5) < 1e-3, "Mean must be exact");
+    TEST_ASSERT(summary.p99_ms <= summary.max_ms, "p99 above max");
+
+    // A single outlier moves the max but not the p50
+    rod_metrics_record(metrics, ROD_METRIC_DETECT, 60000.0);
+    rod_metrics_get_summary(metrics, ROD_METRIC_DETECT, &summary);
+    TEST_ASSERT(fabs(summary.max_ms - 60000.0) < 1e-6, "Outlier max");
+    TEST_ASSERT(fabs(summary.p50_ms - 500.0) / 500.0 < RELATIVE_ERROR, "p50 moved by the outlier");
+
+    // Negative durations count as 0
+    rod_metrics_record(metrics, ROD_METRIC_MASK, -3.0);
+    rod_metrics_get_summary(metrics, ROD_METRIC_MASK, &summary);
+    TEST_ASSERT(summary.count == 1 && summary.max_ms == 0.0, "Negative duration");
+
+    rod_metrics_destroy(metrics);
+    return 0;
+}
+
+static void* record_thread(void* arg) {
+    RodMetrics* metrics = (RodMetrics*)arg;
+    for (int i = 0; i < SAMPLES_PER_THREAD; i++) {
+        rod_metrics_record(metrics, ROD_METRIC_TOTAL, (double)(i % 100) * 0.5);
+        rod_metrics_increment(metrics, ROD_COUNTER_FRAMES);
+    }
+    return NULL;
+}
+
+static int test_concurrent(void) {
+    RodMetrics* metrics = rod_metrics_create();
+    TEST_ASSERT(metrics != NULL, "Metrics creation failed");
+
+    pthread_t threads[THREAD_COUNT];
+    for (int i = 0; i < THREAD_COUNT; i++) {
+        TEST_ASSERT(pthread_create(&threads[i], NULL, record_thread, metrics) == 0, "Thread creation failed");
+    }
+
+    // Read while writers are running (must not crash or go backwards)
+    uint64_t last = 0;
+    for (int i = 0; i < 100; i++) {
+        RodMetricSummary summary;
+        rod_metrics_get_summary(metrics, ROD_METRIC_TOTAL, &summary);
+        TEST_ASSERT(summary.count >= last, "Count went backwards");
+        TEST_ASSERT(summary.max_ms <= 49.5 + 1e-6, "Max out of range");
+        last = summary.count;
+    }
+
+    for (int i = 0; i < THREAD_COUNT; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    RodMetricSummary summary;
+    rod_metrics_get_summary(metrics, ROD_METRIC_TOTAL, &summary);
+    TEST_ASSERT(summary.count == (uint64_t)THREAD_COUNT * SAMPLES_PER_THREAD, "Lost samples");
+    TEST_ASSERT(rod_metrics_get_counter(metrics, ROD_COUNTER_FRAMES) == (uint64_t)THREAD_COUNT * SAMPLES_PER_THREAD,
+                "Lost increments");
+    TEST_ASSERT(fabs(summary.max_ms - 49.5) < 1e-6, "Wrong max");
+
+    rod_metrics_destroy(metrics);
+    return 0;
+}
+
+static int test_report(void) {
+    RodMetrics* metrics = rod_metrics_create();
+    TEST_ASSERT(metrics != NULL, "Metrics creation failed");
+
+    rod_metrics_record(metrics, ROD_METRIC_CAPTURE, 12.0);
+    rod_metrics_increment(metrics, ROD_COUNTER_DROPPED);
+    rod_metrics_set_counter(metrics, ROD_COUNTER_INVOLUNTARY_SWITCHES, 42);
+    rod_metrics_set_counter(NULL, ROD_COUNTER_INVOLUNTARY_SWITCHES, 1);
+
+    char report[2048];
+    int length = rod_metrics_format(metrics, report, sizeof(report));
+    TEST_ASSERT(length > 0 && (size_t)length == strlen(report), "Wrong report length");
+    TEST_ASSERT(strstr(report, "dropped 1\n") != NULL, "Missing counter");
+    TEST_ASSERT(strstr(report, "involuntary_switches 42\n") != NULL, "Missing sampled counter");
+    TEST_ASSERT(strstr(report, "minor_faults 0\n") != NULL, "Missing fault counter");
+    TEST_ASSERT(strstr(report, "capture ") != NULL && strstr(report, "total ") != NULL, "Missing metric lines");
+
+    // Truncated report stays terminated
+    char small[16];
+    TEST_ASSERT(rod_metrics_format(metrics, small, sizeof(small)) == (int)sizeof(small) - 1, "Truncated length");
+    TEST_ASSERT(strncmp(small, report, sizeof(small) - 1) == 0, "Truncated content");
+
+    char folder[] = "/tmp/rod_metrics_testXXXXXX";
+    TEST_ASSERT(mkdtemp(folder) != NULL, "Temporary folder creation failed");
+    char path[256];
+    snprintf(path, sizeof(path), "%s/metrics.txt", folder);
+
+    TEST_ASSERT(rod_metrics_dump(metrics, path) == 0, "Dump failed");
+    FILE* file = fopen(path, "r");
+    TEST_ASSERT(file != NULL, "Dump file missing");
+    char content[2048];
+    size_t read = fread(content, 1, sizeof(content) - 1, file);
+    fclose(file);
+    content[read] = '\0';
+    TEST_ASSERT(strcmp(content, report) == 0, "Dump content differs from report");
+
+    char tmp_path[300];
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path);
+    TEST_ASSERT(access(tmp_path, F_OK) != 0, "Temporary file left behind");
+    TEST_ASSERT(rod_metrics_dump(metrics, "/nonexistent_dir/metrics.txt") == -1, "Dump to invalid path must fail");
+
+    remove(path);
+    rmdir(folder);
+    rod_metrics_destroy(metrics);
+    return 0;
+}
+
+typedef struct {
+    const char* name;
+    int (*func)(void);
+} TestCase;
+
+static const TestCase TESTS[] = {
+    {"Empty metrics", test_empty},
+    {"Percentiles", test_percentiles},
+    {"Concurrent recording", test_concurrent},
+    {"Report and dump", test_report}
+};
+
+#define NUM_TESTS (sizeof(TESTS) / sizeof(TestCase))
+
+int main() {
+    printf("========================================\n");
+    printf("Pipeline Metrics Test\n");
+    printf("========================================\n");
+    printf("Number of tests: %zu\n", NUM_TESTS);
+    printf("========================================\n\n");
+
+    for (size_t i = 0; i < NUM_TESTS; i++) {
+        printf("[%zu/%zu] %s... ", i + 1, NUM_TESTS, TESTS[i].name);
+        fflush(stdout);
+
+        if (TESTS[i].func() == 0) {
+            printf(COLOR_GREEN "PASS" COLOR_RESET "\n");
+            test_passed++;
+        } else {
+            printf(COLOR_RED "FAIL" COLOR_RESET "\n");
+            test_failed++;
+        }
+    }
+
+    printf("\n========================================\n");
+    printf("Results: %d passed, %d failed\n", test_passed, test_failed);
+    printf("========================================\n");
+
+    return (test_failed == 0) ? 0 : 1;
+}
@@ -0,0 +1,365 @@
+/**
+ * test_motion_gate.c
+ *
+ * Validates the motion-gated detection scheduling (rod_motion_gate): which
+ * frames are detected normally, over the full frame, around the known markers
+ * only, or skipped with their markers carried over.
+ *
+ * Frames are small synthetic luma images: a background with a little sensor
+ * noise, and bright squares standing for robots that move between frames.
+ *
+ * Tests:
+ * - Static scene: first frame full, settle frames, then regions-only every roi_interval frames, others skipped
+ * - Motion: a moving square is detected, noise and a too small change are not
+ * - Full rate: full-frame detection once full_interval_us elapsed, and when time goes backwards
+ * - Slow drift: changes too small frame to frame add up against the last detected frame
+ * - Input changes: area size change, forced full detection, BGR and padded rows, area too small, invalid settings
+ * - Dropped detections: a frame dropped before detection makes the next similar frame detected
+ */
+
+#include "rod_motion_gate.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// ANSI color codes
+#define COLOR_RED "\033[1;31m"
+#define COLOR_GREEN "\033[1;32m"
+#define COLOR_RESET "\033[0m"
+
+// Test case counter
+static int test_passed = 0;
+static int test_failed = 0;
+
+// Helper macro for test assertions
+#define TEST_ASSERT(condition, message) \
+    do { \
+        if (!(condition)) { \
+            fprintf(stderr, "    ASSERTION FAILED: %s\n", message); \
+            return -1; \
+        } \
+    } while(0)
+
+#define FRAME_WIDTH 256
+#define FRAME_HEIGHT 192
+#define FRAME_PERIOD_US 33333ULL   // 30 fps
+#define MAX_CHANNELS 3
+#define MAX_STRIDE (FRAME_WIDTH * MAX_CHANNELS + 64)
+
+static uint8_t g_frame[FRAME_HEIGHT * MAX_STRIDE];
+static unsigned int g_seed = 1;
+
+static RodMotionGateConfig test_config(void) {
+    RodMotionGateConfig config = {
+        .grid_cols = 16,               // 16 x 16 pixel cells
+        .grid_rows = 12,
+        .cell_threshold = 8,
+        .min_changed_cells = 3,
+        .settle_frames = 2,
+        .roi_interval = 4,
+        .full_interval_us = 1000000,
+    };
+    return config;
+}
+
+/**
+ * @brief Gray background with +-2 noise and a bright square (size 0 = none)
+ */
+static void draw_frame(int channels, size_t stride, int background, int square_x, int square_y, int square_size) {
+    for (int y = 0; y < FRAME_HEIGHT; y++) {
+        uint8_t* row = g_frame + (size_t)y * stride;
+        for (int x = 0; x < FRAME_WIDTH; x++) {
+            g_seed = g_seed * 1103515245u + 12345u;
+            int value = background + (int)((g_seed >> 16) % 5) - 2;
+            if (x >= square_x && x < square_x + square_size && y >= square_y && y < square_y + square_size) {
+                value = 220;
+            }
+            for (int c = 0; c < channels; c++) {
+                row[x * channels + c] = (uint8_t)value;
+            }
+        }
+    }
+}
+
+static RodMotionDecision update(RodMotionGate* gate, int frame) {
+    return rod_motion_gate_update(gate, g_frame, FRAME_WIDTH, FRAME_HEIGHT, FRAME_WIDTH, 1,
+                                  1000000ULL + (uint64_t)frame * FRAME_PERIOD_US);
+}
+
+/**
+ * Test 1: Static scene schedule
+ */
+static int test_static_scene(void) {
+    RodMotionGateConfig config = test_config();
+    RodMotionGate* gate = rod_motion_gate_create(&config);
+    TEST_ASSERT(gate != NULL, "Gate creation failed");
+
+    draw_frame(1, FRAME_WIDTH, 80, 100, 60, 40);
+    TEST_ASSERT(update(gate, 0) == ROD_MOTION_DETECT_FULL, "First frame must be full");
+    TEST_ASSERT(update(gate, 1) == ROD_MOTION_DETECT, "Settle frame 1 must be detected");
+    TEST_ASSERT(update(gate, 2) == ROD_MOTION_DETECT, "Settle frame 2 must be detected");
+
+    // Static count 1, 2, 3 skipped, 4 regions only, and so on
+    for (int frame = 3; frame < 15; frame++) {
+        draw_frame(1, FRAME_WIDTH, 80, 100, 60, 40);  // New noise on every frame
+        RodMotionDecision expected = (frame - 2) % config.roi_interval == 0 ? ROD_MOTION_DETECT_REGIONS
+                                                                              : ROD_MOTION_SKIP;
+        TEST_ASSERT(update(gate, frame) == expected, "Static frame must be skipped or regions only");
+    }
+
+    RodMotionGateStats stats;
+    rod_motion_gate_get_stats(gate, &stats);
+    TEST_ASSERT(stats.frames == 15 && stats.full == 1 && stats.detected == 2 &&
+                stats.regions == 3 && stats.skipped == 9, "Wrong decision counts");
+    TEST_ASSERT(stats.changed_cells < config.min_changed_cells, "Noise must not change cells");
+    rod_motion_gate_destroy(gate);
+
+    // roi_interval 0: every static frame skipped
+    config.roi_interval = 0;
+    gate = rod_motion_gate_create(&config);
+    TEST_ASSERT(gate != NULL, "Gate creation failed");
+    for (int frame = 0; frame < 3; frame++) update(gate, frame);
+    for (int frame = 3; frame < 12; frame++) {
+        TEST_ASSERT(update(gate, frame) == ROD_MOTION_SKIP, "Static frame must be skipped");
+    }
+    rod_motion_gate_destroy(gate);
+
+    rod_motion_gate_get_stats(NULL, &stats);
+    TEST_ASSERT(stats.frames == 0, "NULL gate stats must be zero");
+    return 0;
+}
+
+/**
+ * Test 2: Motion restarts normal detection
+ */
+static int test_motion(void) {
+    RodMotionGateConfig config = test_config();
+    RodMotionGate* gate = rod_motion_gate_create(&config);
+    TEST_ASSERT(gate != NULL, "Gate creation failed");
+
+    int frame = 0;
+    draw_frame(1, FRAME_WIDTH, 80, 100, 60, 40);
+    while (frame < 5) update(gate, frame++);
+    TEST_ASSERT(update(gate, frame++) == ROD_MOTION_SKIP, "Static scene must be skipped");
+
+    // Robot moves by a cell: detected, then settle frames once it stops
+    draw_frame(1, FRAME_WIDTH, 80, 116, 60, 40);
+    TEST_ASSERT(update(gate, frame++) == ROD_MOTION_DETECT, "Moving square must be detected");
+    RodMotionGateStats stats;
+    rod_motion_gate_get_stats(gate, &stats);
+    TEST_ASSERT(stats.changed_cells >= config.min_changed_cells, "Moving square must change cells");
+    TEST_ASSERT(update(gate, frame++) == ROD_MOTION_DETECT, "Settle frame 1 must be detected");
+    TEST_ASSERT(update(gate, frame++) == ROD_MOTION_DETECT, "Settle frame 2 must be detected");
+    TEST_ASSERT(update(gate, frame++) == ROD_MOTION_SKIP, "Stopped square must be skipped again");
+
+    // A change in fewer than min_changed_cells cells is not motion
+    draw_frame(1, FRAME_WIDTH, 80, 116, 60, 40);
+    for (int y = 0; y < 12; y++) {
+        memset(g_frame + (size_t)y * FRAME_WIDTH, 255, 32);  // Two cells
+    }
+    TEST_ASSERT(update(gate, frame++) == ROD_MOTION_SKIP, "Two changed cells must not count as motion");
+    rod_motion_gate_get_stats(gate, &stats);
+    TEST_ASSERT(stats.changed_cells == 2, "Two cells must have changed");
+
+    rod_motion_gate_destroy(gate);
+    return 0;
+}
+
+/**
+ * Test 3: Guaranteed full-frame detection rate
+ */
+static int test_full_rate(void) {
+    RodMotionGateConfig config = test_config();
+    config.roi_interval = 0;
+    RodMotionGate* gate = rod_motion_gate_create(&config);
+    TEST_ASSERT(gate != NULL, "Gate creation failed");
+
+    draw_frame(1, FRAME_WIDTH, 80, 100, 60, 40);
+    int full_frames[4];
+    int full_count = 0;
+    for (int frame = 0; frame < 100 && full_count < 4; frame++) {
+        if (update(gate, frame) == ROD_MOTION_DETECT_FULL) {
+            full_frames[full_count++] = frame;
+        }
+    }
+    // Last normal detection at frame 2, then one full frame per second (31 frames at 30 fps)
+    TEST_ASSERT(full_count == 4, "Static scene must get full-frame detections");
+    TEST_ASSERT(full_frames[0] == 0 && full_frames[1] == 33 && full_frames[2] == 64 && full_frames[3] == 95,
+                "Full-frame detection must come every full_interval_us");
+
+    // Replay restarted: timestamp before the last full detection
+    TEST_ASSERT(update(gate, 96) == ROD_MOTION_SKIP, "Static frame must be skipped");
+    TEST_ASSERT(update(gate, 0) == ROD_MOTION_DETECT_FULL, "Time going backwards must trigger a full detection");
+    TEST_ASSERT(update(gate, 1) == ROD_MOTION_SKIP, "Static frame after it must be skipped");
+
+    rod_motion_gate_destroy(gate);
+    return 0;
+}
+
+/**
+ * Test 4: Slow drift adds up against the last detected frame
+ */
+static int test_slow_drift(void) {
+    RodMotionGateConfig config = test_config();
+    config.settle_frames = 0;
+    config.roi_interval = 0;
+    RodMotionGate* gate = rod_motion_gate_create(&config);
+    TEST_ASSERT(gate != NULL, "Gate creation failed");
+
+    // Background brightens by 2 per frame: below the threshold frame to frame
+    draw_frame(1, FRAME_WIDTH, 80, 0, 0, 0);
+    TEST_ASSERT(update(gate, 0) == ROD_MOTION_DETECT_FULL, "First frame must be full");
+    int detected_at = -1;
+    for (int frame = 1; frame < 10 && detected_at < 0; frame++) {
+        draw_frame(1, FRAME_WIDTH, 80 + 2 * frame, 0, 0, 0);
+        if (update(gate, frame) == ROD_MOTION_DETECT) {
+            detected_at = frame;
+        }
+    }
+    TEST_ASSERT(detected_at >= 4 && detected_at <= 6, "Drift must be detected once it exceeds the threshold");
+
+    rod_motion_gate_destroy(gate);
+    return 0;
+}
+
+/**
+ * Test 5: Input changes and settings
+ */
+static int test_input_changes(void) {
+    RodMotionGateConfig config = test_config();
+    RodMotionGate* gate = rod_motion_gate_create(&config);
+    TEST_ASSERT(gate != NULL, "Gate creation failed");
+
+    // BGR frame with padded rows
+    size_t stride = FRAME_WIDTH * 3 + 64;
+    draw_frame(3, stride, 80, 100, 60, 40);
+    for (int frame = 0; frame < 4; frame++) {
+        rod_motion_gate_update(gate, g_frame, FRAME_WIDTH, FRAME_HEIGHT, stride, 3, (uint64_t)frame * FRAME_PERIOD_US);
+    }
+    TEST_ASSERT(rod_motion_gate_update(gate, g_frame, FRAME_WIDTH, FRAME_HEIGHT, stride, 3, 4 * FRAME_PERIOD_US) ==
+                ROD_MOTION_SKIP, "Static BGR frame must be skipped");
+
+    // Compared area changed (field crop): full detection
+    TEST_ASSERT(rod_motion_gate_update(gate, g_frame, FRAME_WIDTH - 16, FRAME_HEIGHT, stride, 3, 5 * FRAME_PERIOD_US) ==
+                ROD_MOTION_DETECT_FULL, "Area size change must trigger a full detection");
+
+    // Forced full detection
+    draw_frame(1, FRAME_WIDTH, 80, 100, 60, 40);
+    for (int frame = 6; frame < 10; frame++) update(gate, frame);
+    TEST_ASSERT(update(gate, 10) == ROD_MOTION_SKIP, "Static frame must be skipped");
+    rod_motion_gate_force_full(gate);
+    TEST_ASSERT(update(gate, 11) == ROD_MOTION_DETECT_FULL, "Forced frame must be full");
+    TEST_ASSERT(update(gate, 12) == ROD_MOTION_DETECT, "Force must last one frame");
+
+    // Area smaller than the sampling grid: never gated
+    TEST_ASSERT(rod_motion_gate_update(gate, g_frame, 32, 32, FRAME_WIDTH, 1, 13 * FRAME_PERIOD_US) ==
+                ROD_MOTION_DETECT, "Too small area must be detected");
+    TEST_ASSERT(rod_motion_gate_update(gate, NULL, FRAME_WIDTH, FRAME_HEIGHT, FRAME_WIDTH, 1, 0) ==
+                ROD_MOTION_DETECT, "Missing data must be detected");
+    TEST_ASSERT(rod_motion_gate_update(NULL, g_frame, FRAME_WIDTH, FRAME_HEIGHT, FRAME_WIDTH, 1, 0) ==
+                ROD_MOTION_DETECT, "NULL gate must detect");
+    rod_motion_gate_force_full(NULL);
+    rod_motion_gate_destroy(gate);
+
+    // Invalid settings
+    config = test_config();
+    config.grid_cols = 0;
+    TEST_ASSERT(rod_motion_gate_create(&config) == NULL, "Empty grid must be refused");
+    config = test_config();
+    config.grid_cols = 128;
+    config.grid_rows = 64;
+    TEST_ASSERT(rod_motion_gate_create(&config) == NULL, "Too many cells must be refused");
+    config = test_config();
+    config.min_changed_cells = 0;
+    TEST_ASSERT(rod_motion_gate_create(&config) == NULL, "Zero changed cells must be refused");
+    config = test_config();
+    config.roi_interval = -1;
+    TEST_ASSERT(rod_motion_gate_create(&config) == NULL, "Negative interval must be refused");
+    TEST_ASSERT(rod_motion_gate_create(NULL) == NULL, "NULL settings must be refused");
+
+    TEST_ASSERT(strcmp(rod_motion_gate_decision_name(ROD_MOTION_SKIP), "skip") == 0, "Wrong decision name");
+    return 0;
+}
+
+/**
+ * Test 6: Frames dropped between the gate and the detector
+ */
+static int test_dropped_detection(void) {
+    RodMotionGateConfig config = test_config();
+    config.settle_frames = 0;   // A similar frame right after motion is skipped
+    config.roi_interval = 0;
+    RodMotionGate* gate = rod_motion_gate_create(&config);
+    TEST_ASSERT(gate != NULL, "Gate creation failed");
+
+    int frame = 0;
+    draw_frame(1, FRAME_WIDTH, 80, 100, 60, 40);
+    TEST_ASSERT(update(gate, frame++) == ROD_MOTION_DETECT_FULL, "First frame must be full");
+    TEST_ASSERT(update(gate, frame++) == ROD_MOTION_SKIP, "Static frame must be skipped");
+
+    // Detected motion frame: the next similar frame is skipped
+    draw_frame(1, FRAME_WIDTH, 80, 116, 60, 40);
+    TEST_ASSERT(update(gate, frame++) == ROD_MOTION_DETECT, "Moving square must be detected");
+    TEST_ASSERT(update(gate, frame++) == ROD_MOTION_SKIP, "Frame after a detected motion must be skipped");
+
+    // Dropped motion frame: its markers were never measured, the next similar frame must be detected
+    draw_frame(1, FRAME_WIDTH, 80, 132, 60, 40);
+    TEST_ASSERT(update(gate, frame++) == ROD_MOTION_DETECT, "Moving square must be detected");
+    rod_motion_gate_reject(gate, ROD_MOTION_DETECT);
+    TEST_ASSERT(update(gate, frame++) == ROD_MOTION_DETECT, "Frame after a dropped motion must be detected");
+    TEST_ASSERT(update(gate, frame++) == ROD_MOTION_SKIP, "Reject must last one frame");
+
+    // Regions-only frame dropped: detected too; dropped full frame: full again; dropped skip: nothing to redo
+    rod_motion_gate_reject(gate, ROD_MOTION_DETECT_REGIONS);
+    TEST_ASSERT(update(gate, frame++) == ROD_MOTION_DETECT, "Frame after a dropped regions frame must be detected");
+    rod_motion_gate_reject(gate, ROD_MOTION_DETECT_FULL);
+    TEST_ASSERT(update(gate, frame++) == ROD_MOTION_DETECT_FULL, "Frame after a dropped full frame must be full");
+    rod_motion_gate_reject(gate, ROD_MOTION_SKIP);
+    TEST_ASSERT(update(gate, frame++) == ROD_MOTION_SKIP, "Dropped skipped frame must change nothing");
+    rod_motion_gate_reject(NULL, ROD_MOTION_DETECT);
+
+    rod_motion_gate_destroy(gate);
+    return 0;
+}
+
+typedef struct {
+    const char* name;
+    int (*func)(void);
+} TestCase;
+
+static const TestCase TESTS[] = {
+    {"Static scene", test_static_scene},
+    {"Motion", test_motion},
+    {"Full rate", test_full_rate},
+    {"Slow drift", test_slow_drift},
+    {"Input changes", test_input_changes},
+    {"Dropped detections", test_dropped_detection}
+};
+
+#define NUM_TESTS (sizeof(TESTS) / sizeof(TestCase))
+
+int main() {
+    printf("========================================\n");
+    printf("Motion Gate Test\n");
+    printf("========================================\n");
+    printf("Number of tests: %zu\n", NUM_TESTS);
+    printf("========================================\n\n");
+
+    for (size_t i = 0; i < NUM_TESTS; i++) {
+        printf("[%zu/%zu] %s... ", i + 1, NUM_TESTS, TESTS[i].name);
+        fflush(stdout);
+
+        if (TESTS[i].func() == 0) {
+            printf(COLOR_GREEN "PASS" COLOR_RESET "\n");
+            test_passed++;
+        } else {
+            printf(COLOR_RED "FAIL" COLOR_RESET "\n");
+            test_failed++;
+        }
+    }
+
+    printf("\n========================================\n");
+    printf("Results: %d passed, %d failed\n", test_passed, test_failed);
+    printf("========================================\n");
+
+    return (test_failed == 0) ? 0 : 1;
+}
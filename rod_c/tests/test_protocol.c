@@ -0,0 +1,244 @@
+/**
+ * test_protocol.c
+ * 
+ * Validates the binary framed message format used on the detection socket.
+ * 
+ * Tests:
+ * - Encode / decode round trip (header fields, marker records)
+ * - Out of range marker count
+ * - Partial reads (message fed one byte at a time)
+ * - Several messages in one read
+ * - Resynchronization after corrupted bytes
+ */
+
+#include "rod_protocol.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// ANSI color codes
+#define COLOR_RED "\033[1;31m"
+#define COLOR_GREEN "\033[1;32m"
+#define COLOR_RESET "\033[0m"
+
+// Test case counter
+static int test_passed = 0;
+static int test_failed = 0;
+
+// Helper macro for test assertions
+#define TEST_ASSERT(condition, message) \
+    do { \
+        if (!(condition)) { \
+            fprintf(stderr, "    ASSERTION FAILED: %s\n", message); \
+            return -1; \
+        } \
+    } while(0)
+
+static uint8_t g_buffer[4 * ROD_PROTOCOL_MAX_MESSAGE_SIZE];
+static RodProtocolDecoder g_decoder;
+static RodProtocolMessage g_message;
+
+/**
+ * @brief Encode a message with count markers derived from sequence
+ * @return Message size in bytes
+ */
+static size_t encode_message(uint8_t* buffer, uint32_t sequence, int count) {
+    uint8_t* p = buffer;
+    RodProtocolTimings timings = { 1000 + sequence, 20000 + sequence, 30000 + sequence };
+    uint32_t flags = sequence & (ROD_PROTOCOL_FLAG_ROI_ONLY | ROD_PROTOCOL_FLAG_CARRIED_OVER);
+    p += rod_protocol_encode_header(p, sequence, 1000000ULL * sequence + 123, &timings, flags, count);
+    for (int i = 0; i < count; i++) {
+        p += rod_protocol_encode_marker(p, i + 1, 100.5f * i, -20.25f * i, 0.001f * i, 1000u * i);
+    }
+    return (size_t)(p - buffer);
+}
+
+static int check_message(const RodProtocolMessage* message, uint32_t sequence, int count) {
+    TEST_ASSERT(message->sequence == sequence, "sequence must match");
+    TEST_ASSERT(message->timestamp_us == 1000000ULL * sequence + 123, "timestamp must match");
+    TEST_ASSERT(message->timings.acquired_us == 1000 + sequence &&
+                message->timings.detected_us == 20000 + sequence &&
+                message->timings.published_us == 30000 + sequence, "timings must match");
+    TEST_ASSERT(message->flags == (sequence & (ROD_PROTOCOL_FLAG_ROI_ONLY | ROD_PROTOCOL_FLAG_CARRIED_OVER)),
+                "flags must match");
+    TEST_ASSERT(message->count == count, "count must match");
+    for (int i = 0; i < count; i++) {
+        TEST_ASSERT(message->markers[i].id == i + 1, "marker id must match");
+        TEST_ASSERT(message->markers[i].x == 100.5f * i, "marker x must match");
+        TEST_ASSERT(message->markers[i].y == -20.25f * i, "marker y must match");
+        TEST_ASSERT(message->markers[i].angle == 0.001f * i, "marker angle must match");
+        TEST_ASSERT(message->markers[i].age_us == 1000u * (uint32_t)i, "marker age must match");
+    }
+    return 0;
+}
+
+/**
+ * Test 1: Encoded message decodes to the same values
+ */
+int test_round_trip() {
+    size_t size = encode_message(g_buffer, 42, 5);
+    TEST_ASSERT(size == ROD_PROTOCOL_MESSAGE_SIZE(5), "message size must match");
+    
+    rod_protocol_decoder_init(&g_decoder);
+    TEST_ASSERT(rod_protocol_decoder_feed(&g_decoder, g_buffer, size) == size, "feed must consume all bytes");
+    TEST_ASSERT(rod_protocol_decoder_next(&g_decoder, &g_message) == 1, "message must be decoded");
+    TEST_ASSERT(check_message(&g_message, 42, 5) == 0, "decoded values must match");
+    TEST_ASSERT(rod_protocol_decoder_next(&g_decoder, &g_message) == 0, "no more messages");
+    
+    // Empty and full messages
+    size = encode_message(g_buffer, 1, 0);
+    rod_protocol_decoder_feed(&g_decoder, g_buffer, size);
+    TEST_ASSERT(rod_protocol_decoder_next(&g_decoder, &g_message) == 1, "empty message must be decoded");
+    TEST_ASSERT(check_message(&g_message, 1, 0) == 0, "empty message values must match");
+    
+    size = encode_message(g_buffer, 2, ROD_PROTOCOL_MAX_MARKERS);
+    rod_protocol_decoder_feed(&g_decoder, g_buffer, size);
+    TEST_ASSERT(rod_protocol_decoder_next(&g_decoder, &g_message) == 1, "full message must be decoded");
+    TEST_ASSERT(check_message(&g_message, 2, ROD_PROTOCOL_MAX_MARKERS) == 0, "full message values must match");
+    return 0;
+}
+
+/**
+ * Test 2: Marker count out of range is rejected by the encoder
+ */
+int test_count_range() {
+    TEST_ASSERT(rod_protocol_encode_header(g_buffer, 0, 0, NULL, 0, -1) == 0, "negative count must fail");
+    TEST_ASSERT(rod_protocol_encode_header(g_buffer, 0, 0, NULL, 0, ROD_PROTOCOL_MAX_MARKERS + 1) == 0,
+                "count above maximum must fail");
+    
+    // Missing timings are sent as zero
+    size_t size = rod_protocol_encode_header(g_buffer, 3, 4, NULL, 0, 0);
+    rod_protocol_decoder_init(&g_decoder);
+    rod_protocol_decoder_feed(&g_decoder, g_buffer, size);
+    TEST_ASSERT(rod_protocol_decoder_next(&g_decoder, &g_message) == 1, "message without timings must be decoded");
+    TEST_ASSERT(g_message.timings.acquired_us == 0 && g_message.timings.detected_us == 0 &&
+                g_message.timings.published_us == 0, "missing timings must be zero");
+    return 0;
+}
+
+/**
+ * Test 3: Message split in single bytes is decoded once complete
+ */
+int test_partial_reads() {
+    size_t size = encode_message(g_buffer, 7, 3);
+    rod_protocol_decoder_init(&g_decoder);
+    
+    for (size_t i = 0; i < size - 1; i++) {
+        size_t available;
+        uint8_t* dst = rod_protocol_decoder_write_ptr(&g_decoder, &available);
+        TEST_ASSERT(available > 0, "decoder must have room");
+        dst[0] = g_buffer[i];
+        rod_protocol_decoder_commit(&g_decoder, 1);
+        TEST_ASSERT(rod_protocol_decoder_next(&g_decoder, &g_message) == 0, "incomplete message must wait");
+    }
+    rod_protocol_decoder_feed(&g_decoder, g_buffer + size - 1, 1);
+    TEST_ASSERT(rod_protocol_decoder_next(&g_decoder, &g_message) == 1, "complete message must be decoded");
+    TEST_ASSERT(check_message(&g_message, 7, 3) == 0, "decoded values must match");
+    return 0;
+}
+
+/**
+ * Test 4: Several messages received at once, last one split across reads
+ */
+int test_multiple_messages() {
+    size_t size = 0;
+    for (uint32_t seq = 0; seq < 3; seq++) {
+        size += encode_message(g_buffer + size, seq, (int)seq * 10);
+    }
+    
+    rod_protocol_decoder_init(&g_decoder);
+    for (int round = 0; round < 50; round++) {
+        // Feed everything but 5 bytes, then the rest with the next round's start
+        size_t split = size - 5;
+        rod_protocol_decoder_feed(&g_decoder, g_buffer, split);
+        int decoded = 0;
+        while (rod_protocol_decoder_next(&g_decoder, &g_message) == 1) {
+            TEST_ASSERT(check_message(&g_message, (uint32_t)decoded, decoded * 10) == 0, "message values must match");
+            decoded++;
+        }
+        TEST_ASSERT(decoded == 2, "two complete messages must be decoded");
+        
+        rod_protocol_decoder_feed(&g_decoder, g_buffer + split, 5);
+        TEST_ASSERT(rod_protocol_decoder_next(&g_decoder, &g_message) == 1, "last message must be decoded");
+        TEST_ASSERT(check_message(&g_message, 2, 20) == 0, "last message values must match");
+    }
+    return 0;
+}
+
+/**
+ * Test 5: Garbage before a message is skipped
+ */
+int test_resync() {
+    static const uint8_t garbage[] = "[[1,2.00,3.00,0.1000]]\n";
+    size_t size = encode_message(g_buffer, 9, 2);
+    
+    rod_protocol_decoder_init(&g_decoder);
+    rod_protocol_decoder_feed(&g_decoder, garbage, sizeof(garbage) - 1);
+    rod_protocol_decoder_feed(&g_decoder, g_buffer, size);
+    
+    int ret;
+    int skipped = 0;
+    while ((ret = rod_protocol_decoder_next(&g_decoder, &g_message)) == -1) {
+        skipped++;
+        TEST_ASSERT(skipped < 100, "decoder must resynchronize");
+    }
+    TEST_ASSERT(ret == 1, "message after garbage must be decoded");
+    TEST_ASSERT(skipped > 0, "garbage must be reported");
+    TEST_ASSERT(g_decoder.discarded == sizeof(garbage) - 1, "exactly the garbage bytes must be discarded");
+    TEST_ASSERT(check_message(&g_message, 9, 2) == 0, "decoded values must match");
+    
+    // Corrupted length field
+    size = encode_message(g_buffer, 10, 1);
+    g_buffer[0] ^= 0xFF;
+    size += encode_message(g_buffer + size, 11, 1);
+    rod_protocol_decoder_init(&g_decoder);
+    rod_protocol_decoder_feed(&g_decoder, g_buffer, size);
+    while ((ret = rod_protocol_decoder_next(&g_decoder, &g_message)) == -1) {
+    }
+    TEST_ASSERT(ret == 1, "next valid message must be decoded");
+    TEST_ASSERT(check_message(&g_message, 11, 1) == 0, "next valid message values must match");
+    return 0;
+}
+
+// Test suite definition
+typedef struct {
+    const char* name;
+    int (*func)();
+} TestCase;
+
+static const TestCase TESTS[] = {
+    {"Round trip", test_round_trip},
+    {"Marker count range", test_count_range},
+    {"Partial reads", test_partial_reads},
+    {"Multiple messages per read", test_multiple_messages},
+    {"Resynchronization", test_resync}
+};
+
+#define NUM_TESTS (sizeof(TESTS) / sizeof(TestCase))
+
+int main() {
+    printf("========================================\n");
+    printf("Protocol Test\n");
+    printf("========================================\n");
+    printf("Number of tests: %zu\n", NUM_TESTS);
+    printf("========================================\n\n");
+    
+    for (size_t i = 0; i < NUM_TESTS; i++) {
+        printf("[%zu/%zu] %s... ", i + 1, NUM_TESTS, TESTS[i].name);
+        fflush(stdout);
+        
+        if (TESTS[i].func() == 0) {
+            printf(COLOR_GREEN "PASS" COLOR_RESET "\n");
+            test_passed++;
+        } else {
+            printf(COLOR_RED "FAIL" COLOR_RESET "\n");
+            test_failed++;
+        }
+    }
+    
+    printf("\n========================================\n");
+    printf("Results: %d passed, %d failed\n", test_passed, test_failed);
+    printf("========================================\n");
+    
+    return (test_failed == 0) ? 0 : 1;
+}
@@ -0,0 +1,190 @@
+/**
+ * test_realtime.c
+ *
+ * Validates the thread placement and resource usage helpers of real-time mode (rod_realtime).
+ *
+ * Settings are applied from a helper thread, so the test process keeps its
+ * own scheduling. SCHED_FIFO and memory locking need privileges and are not
+ * exercised here, only their argument checks.
+ *
+ * Tests:
+ * - Invalid arguments: NULL usage, out of range priority, mask without any present CPU
+ * - No-op settings: mask 0 and priority 0 leave the thread untouched
+ * - CPU pinning: thread restricted to the requested CPU
+ * - Resource usage: page faults and context switches counted
+ */
+
+#define _GNU_SOURCE  // Required for pthread_getaffinity_np and CPU_SET
+
+#include "rod_realtime.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+// ANSI color codes
+#define COLOR_RED "\033[1;31m"
+#define COLOR_GREEN "\033[1;32m"
+#define COLOR_RESET "\033[0m"
+
+// Test case counter
+static int test_passed = 0;
+static int test_failed = 0;
+
+// Helper macro for test assertions
+#define TEST_ASSERT(condition, message) \
+    do { \
+        if (!(condition)) { \
+            fprintf(stderr, "    ASSERTION FAILED: %s\n", message); \
+            return -1; \
+        } \
+    } while(0)
+
+#define FAULT_TEST_SIZE (4u << 20)
+
+/**
+ * @brief Settings applied by a helper thread, and the affinity it ends up with
+ */
+typedef struct {
+    uint64_t cpu_mask;
+    int priority;
+    int result;
+    cpu_set_t before;
+    cpu_set_t after;
+} ThreadRequest;
+
+static void* apply_thread_main(void* arg) {
+    ThreadRequest* request = (ThreadRequest*)arg;
+    pthread_getaffinity_np(pthread_self(), sizeof(request->before), &request->before);
+    request->result = rod_realtime_set_thread("test", request->cpu_mask, request->priority);
+    pthread_getaffinity_np(pthread_self(), sizeof(request->after), &request->after);
+    return NULL;
+}
+
+static int apply_in_thread(ThreadRequest* request) {
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, apply_thread_main, request) != 0) return -1;
+    pthread_join(thread, NULL);
+    return 0;
+}
+
+/**
+ * @brief First CPU the process may run on
+ */
+static int first_allowed_cpu(void) {
+    cpu_set_t cpus;
+    if (sched_getaffinity(0, sizeof(cpus), &cpus) != 0) return -1;
+    for (int cpu = 0; cpu < ROD_REALTIME_MAX_CPUS; cpu++) {
+        if (CPU_ISSET(cpu, &cpus)) return cpu;
+    }
+    return -1;
+}
+
+static int test_invalid_arguments(void) {
+    TEST_ASSERT(rod_realtime_get_usage(NULL) == -1, "NULL usage rejected");
+
+    ThreadRequest request = {.cpu_mask = 0, .priority = 100, .result = 0};
+    TEST_ASSERT(apply_in_thread(&request) == 0, "Helper thread started");
+    TEST_ASSERT(request.result == -1, "Priority above 99 rejected");
+
+    request.priority = -1;
+    TEST_ASSERT(apply_in_thread(&request) == 0 && request.result == -1, "Negative priority rejected");
+
+    if (sysconf(_SC_NPROCESSORS_CONF) < ROD_REALTIME_MAX_CPUS) {
+        request.cpu_mask = 1ULL << (ROD_REALTIME_MAX_CPUS - 1);
+        request.priority = 0;
+        TEST_ASSERT(apply_in_thread(&request) == 0 && request.result == -1, "Absent CPU rejected");
+        TEST_ASSERT(CPU_EQUAL(&request.before, &request.after), "Affinity unchanged");
+    }
+    rod_realtime_prefault_stack(0);
+    return 0;
+}
+
+static int test_no_op(void) {
+    ThreadRequest request = {.cpu_mask = 0, .priority = 0, .result = -1};
+    TEST_ASSERT(apply_in_thread(&request) == 0, "Helper thread started");
+    TEST_ASSERT(request.result == 0, "Nothing to apply succeeds");
+    TEST_ASSERT(CPU_EQUAL(&request.before, &request.after), "Affinity unchanged");
+    return 0;
+}
+
+static int test_cpu_pinning(void) {
+    int cpu = first_allowed_cpu();
+    TEST_ASSERT(cpu >= 0, "Allowed CPU found");
+
+    // Extra bits for CPUs the process may not use are ignored
+    ThreadRequest request = {.cpu_mask = (1ULL << cpu) | (1ULL << (ROD_REALTIME_MAX_CPUS - 1)), .priority = 0,
+                             .result = -1};
+    TEST_ASSERT(apply_in_thread(&request) == 0, "Helper thread started");
+    TEST_ASSERT(request.result == 0, "Pinning applied");
+    TEST_ASSERT(CPU_COUNT(&request.after) == 1 && CPU_ISSET(cpu, &request.after), "Thread restricted to the CPU");
+    return 0;
+}
+
+static int test_usage(void) {
+    RodRealtimeUsage before;
+    RodRealtimeUsage after;
+    TEST_ASSERT(rod_realtime_get_usage(&before) == 0, "Usage sampled");
+
+    // Fresh anonymous pages fault on first touch
+    unsigned char* pages = mmap(NULL, FAULT_TEST_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    TEST_ASSERT(pages != MAP_FAILED, "Pages mapped");
+    for (size_t i = 0; i < FAULT_TEST_SIZE; i += 4096) {
+        pages[i] = 1;
+    }
+    munmap(pages, FAULT_TEST_SIZE);
+    usleep(1000);  // Gives up the CPU
+
+    TEST_ASSERT(rod_realtime_get_usage(&after) == 0, "Usage sampled again");
+    TEST_ASSERT(after.minor_faults > before.minor_faults, "Page faults counted");
+    TEST_ASSERT(after.voluntary_switches > before.voluntary_switches, "Context switch counted");
+    TEST_ASSERT(after.major_faults >= before.major_faults && after.involuntary_switches >= before.involuntary_switches,
+                "Counters never decrease");
+
+    rod_realtime_prefault_stack(64u << 10);
+    return 0;
+}
+
+typedef struct {
+    const char* name;
+    int (*func)(void);
+} TestCase;
+
+static const TestCase TESTS[] = {
+    {"Invalid arguments", test_invalid_arguments},
+    {"No-op settings", test_no_op},
+    {"CPU pinning", test_cpu_pinning},
+    {"Resource usage", test_usage}
+};
+
+#define NUM_TESTS (sizeof(TESTS) / sizeof(TestCase))
+
+int main() {
+    printf("========================================\n");
+    printf("Real-time Mode Test\n");
+    printf("========================================\n");
+    printf("Number of tests: %zu\n", NUM_TESTS);
+    printf("========================================\n\n");
+
+    for (size_t i = 0; i < NUM_TESTS; i++) {
+        printf("[%zu/%zu] %s... ", i + 1, NUM_TESTS, TESTS[i].name);
+        fflush(stdout);
+
+        if (TESTS[i].func() == 0) {
+            printf(COLOR_GREEN "PASS" COLOR_RESET "\n");
+            test_passed++;
+        } else {
+            printf(COLOR_RED "FAIL" COLOR_RESET "\n");
+            test_failed++;
+        }
+    }
+
+    printf("\n========================================\n");
+    printf("Results: %d passed, %d failed\n", test_passed, test_failed);
+    printf("========================================\n");
+
+    return (test_failed == 0) ? 0 : 1;
+}
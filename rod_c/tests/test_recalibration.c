@@ -0,0 +1,283 @@
+/**
+ * test_recalibration.c
+ *
+ * Validates the background field recalibration: fixed tag centers fed frame
+ * by frame, a new homography and mask handed over only when the camera moved.
+ *
+ * Tests:
+ * - Create with invalid parameters
+ * - Still camera (small noise): no new calibration
+ * - Isolated bad centers are rejected by the median window
+ * - Moved camera: one new calibration, matching the new tag centers
+ */
+
+#define _DEFAULT_SOURCE  // Required for usleep
+
+#include "rod_recalibration.h"
+#include "rod_cv.h"
+#include "opencv_wrapper.h"
+#include "rod_config.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+
+// ANSI color codes
+#define COLOR_RED "\033[1;31m"
+#define COLOR_GREEN "\033[1;32m"
+#define COLOR_RESET "\033[0m"
+
+// Test case counter
+static int test_passed = 0;
+static int test_failed = 0;
+
+// Helper macro for test assertions
+#define TEST_ASSERT(condition, message) \
+    do { \
+        if (!(condition)) { \
+            fprintf(stderr, "    ASSERTION FAILED: %s\n", message); \
+            return -1; \
+        } \
+    } while(0)
+
+#define FRAME_WIDTH 4056
+#define FRAME_HEIGHT 3040
+#define DRIFT_MM 10.0f
+#define MARKER_HALF_SIZE 15.0f
+#define SETTLE_US 300000          // Time given to the thread before checking that nothing happened
+#define WAIT_STEP_US 10000
+#define WAIT_STEPS 300
+
+// Fixed tag centers (IDs 20-23) of the calibrated camera position, in pixels
+static const Point2f TAG_CENTERS[ROD_FIXED_MARKER_COUNT] = {
+    {1650.0f, 1150.0f},
+    {2450.0f, 1120.0f},
+    {1680.0f, 1900.0f},
+    {2420.0f, 1930.0f}
+};
+
+// Known playground positions of the same tags (mm)
+static const Point2f TAG_POSITIONS[ROD_FIXED_MARKER_COUNT] = {
+    {600.0f, 600.0f},
+    {600.0f, 2400.0f},
+    {1400.0f, 600.0f},
+    {1400.0f, 2400.0f}
+};
+
+static float random_range(float min, float max) {
+    return min + (max - min) * ((float)rand() / (float)RAND_MAX);
+}
+
+/**
+ * Build a detection holding the fixed tags at centers (plus noise) and one game element
+ */
+static void make_detection(DetectionResult* detection, DetectedMarker* markers, const Point2f* centers, float noise) {
+    for (int i = 0; i < ROD_FIXED_MARKER_COUNT; i++) {
+        float cx = centers[i].x + random_range(-noise, noise);
+        float cy = centers[i].y + random_range(-noise, noise);
+        markers[i].id = 20 + i;
+        markers[i].confidence = 1.0f;
+        markers[i].corners[0][0] = cx - MARKER_HALF_SIZE; markers[i].corners[0][1] = cy - MARKER_HALF_SIZE;
+        markers[i].corners[1][0] = cx + MARKER_HALF_SIZE; markers[i].corners[1][1] = cy - MARKER_HALF_SIZE;
+        markers[i].corners[2][0] = cx + MARKER_HALF_SIZE; markers[i].corners[2][1] = cy + MARKER_HALF_SIZE;
+        markers[i].corners[3][0] = cx - MARKER_HALF_SIZE; markers[i].corners[3][1] = cy + MARKER_HALF_SIZE;
+    }
+    DetectedMarker* element = &markers[ROD_FIXED_MARKER_COUNT];
+    *element = markers[0];
+    element->id = 36;
+    detection->markers = markers;
+    detection->count = ROD_FIXED_MARKER_COUNT + 1;
+}
+
+static void submit_frames(RodRecalibrator* recal, const Point2f* centers, float noise, int frames) {
+    DetectedMarker markers[ROD_FIXED_MARKER_COUNT + 1];
+    DetectionResult detection;
+    for (int f = 0; f < frames; f++) {
+        make_detection(&detection, markers, centers, noise);
+        rod_recalibrator_submit(recal, &detection);
+        usleep(1000);  // Frames arrive over time: the thread gets the lock between them
+    }
+}
+
+/**
+ * Largest playground error (mm) of a homography at the given tag centers
+ */
+static float tag_error_mm(const float* homography_inv, const Point2f* centers) {
+    Point2f undistorted[ROD_FIXED_MARKER_COUNT];
+    Point2f terrain[ROD_FIXED_MARKER_COUNT];
+    const float* K = rod_config_get_camera_matrix();
+    const float* D = rod_config_get_distortion_coeffs();
+    if (fisheye_undistort_points_into(centers, ROD_FIXED_MARKER_COUNT, K, D, K, undistorted) != 0) return INFINITY;
+    if (perspective_transform_into(undistorted, ROD_FIXED_MARKER_COUNT, homography_inv, terrain) != 0) return INFINITY;
+
+    float error = 0.0f;
+    for (int i = 0; i < ROD_FIXED_MARKER_COUNT; i++) {
+        error = fmaxf(error, hypotf(terrain[i].x - TAG_POSITIONS[i].x, terrain[i].y - TAG_POSITIONS[i].y));
+    }
+    return error;
+}
+
+static RodRecalibrator* create_with_reference(float* homography_inv) {
+    if (compute_field_homography(TAG_CENTERS, NULL, homography_inv) != 0) return NULL;
+    RodRecalibrator* recal = rod_recalibrator_create(true, 1.1f, DRIFT_MM);
+    if (recal) rod_recalibrator_set_reference(recal, homography_inv, FRAME_WIDTH, FRAME_HEIGHT);
+    return recal;
+}
+
+/**
+ * Test 1: Invalid parameters are rejected
+ */
+int test_create() {
+    TEST_ASSERT(rod_recalibrator_create(true, 0.0f, DRIFT_MM) == NULL, "zero scale must fail");
+    TEST_ASSERT(rod_recalibrator_create(true, 1.1f, 0.0f) == NULL, "zero threshold must fail");
+
+    RodRecalibrator* recal = rod_recalibrator_create(false, 1.1f, DRIFT_MM);
+    TEST_ASSERT(recal != NULL, "create must succeed");
+
+    // No reference yet: samples are kept but nothing is estimated
+    submit_frames(recal, TAG_CENTERS, 0.0f, 2 * ROD_RECALIBRATION_WINDOW);
+    usleep(SETTLE_US);
+    RodCalibration active = {NULL, {0, 0, 0, 0}, {0}, 0.0f};
+    TEST_ASSERT(!rod_recalibrator_swap(recal, &active), "nothing to swap without reference");
+
+    rod_recalibrator_submit(recal, NULL);
+    rod_recalibrator_destroy(recal);
+    rod_recalibrator_destroy(NULL);
+    return 0;
+}
+
+/**
+ * Test 2: A still camera never produces a new calibration
+ */
+int test_still_camera() {
+    float homography_inv[9];
+    RodRecalibrator* recal = create_with_reference(homography_inv);
+    TEST_ASSERT(recal != NULL, "create must succeed");
+
+    submit_frames(recal, TAG_CENTERS, 1.0f, 4 * ROD_RECALIBRATION_WINDOW);
+    usleep(SETTLE_US);
+
+    RodCalibration active = {NULL, {0, 0, 0, 0}, {0}, 0.0f};
+    memcpy(active.homography_inv, homography_inv, sizeof(homography_inv));
+    TEST_ASSERT(!rod_recalibrator_swap(recal, &active), "noise must not recalibrate");
+
+    rod_recalibrator_destroy(recal);
+    return 0;
+}
+
+/**
+ * Test 3: A few wrong centers inside the window are ignored (median)
+ */
+int test_outliers() {
+    float homography_inv[9];
+    RodRecalibrator* recal = create_with_reference(homography_inv);
+    TEST_ASSERT(recal != NULL, "create must succeed");
+
+    Point2f wrong[ROD_FIXED_MARKER_COUNT];
+    for (int i = 0; i < ROD_FIXED_MARKER_COUNT; i++) {
+        wrong[i].x = TAG_CENTERS[i].x + 300.0f;
+        wrong[i].y = TAG_CENTERS[i].y - 200.0f;
+    }
+    for (int round = 0; round < 8; round++) {
+        submit_frames(recal, TAG_CENTERS, 0.5f, 4);
+        submit_frames(recal, wrong, 0.0f, 1);
+    }
+    usleep(SETTLE_US);
+
+    RodCalibration active = {NULL, {0, 0, 0, 0}, {0}, 0.0f};
+    TEST_ASSERT(!rod_recalibrator_swap(recal, &active), "outliers must not recalibrate");
+
+    rod_recalibrator_destroy(recal);
+    return 0;
+}
+
+/**
+ * Test 4: Moving the camera hands over one calibration matching the new view
+ */
+int test_moved_camera() {
+    float homography_inv[9];
+    RodRecalibrator* recal = create_with_reference(homography_inv);
+    TEST_ASSERT(recal != NULL, "create must succeed");
+    TEST_ASSERT(tag_error_mm(homography_inv, TAG_CENTERS) < 1.0f, "reference must fit the tags");
+
+    // Mast bumped: the whole view shifts and rotates slightly
+    Point2f moved[ROD_FIXED_MARKER_COUNT];
+    const float angle = 0.01f;
+    for (int i = 0; i < ROD_FIXED_MARKER_COUNT; i++) {
+        float dx = TAG_CENTERS[i].x - FRAME_WIDTH / 2.0f;
+        float dy = TAG_CENTERS[i].y - FRAME_HEIGHT / 2.0f;
+        moved[i].x = FRAME_WIDTH / 2.0f + dx * cosf(angle) - dy * sinf(angle) + 25.0f;
+        moved[i].y = FRAME_HEIGHT / 2.0f + dx * sinf(angle) + dy * cosf(angle) - 15.0f;
+    }
+    TEST_ASSERT(tag_error_mm(homography_inv, moved) > DRIFT_MM, "moved tags must be off with the old homography");
+
+    RodCalibration active = {NULL, {0, 0, 0, 0}, {0}, 0.0f};
+    memcpy(active.homography_inv, homography_inv, sizeof(homography_inv));
+    bool swapped = false;
+    for (int step = 0; step < WAIT_STEPS && !swapped; step++) {
+        submit_frames(recal, moved, 0.5f, 1);
+        swapped = rod_recalibrator_swap(recal, &active);
+        if (!swapped) usleep(WAIT_STEP_US);
+    }
+    TEST_ASSERT(swapped, "moved camera must recalibrate");
+    TEST_ASSERT(active.field_mask != NULL, "new calibration must hold a mask");
+    TEST_ASSERT(active.drift_mm > DRIFT_MM, "drift must exceed the threshold");
+    TEST_ASSERT(tag_error_mm(active.homography_inv, moved) < 1.0f, "new homography must fit the moved tags");
+    TEST_ASSERT(active.field_roi.x >= 0 && active.field_roi.y >= 0 &&
+                active.field_roi.x + active.field_roi.width <= FRAME_WIDTH &&
+                active.field_roi.y + active.field_roi.height <= FRAME_HEIGHT, "field must lie in the frame");
+    TEST_ASSERT(get_image_width(active.field_mask) == active.field_roi.width &&
+                get_image_height(active.field_mask) == active.field_roi.height, "mask must be field sized");
+
+    // Same view again: the new reference holds
+    submit_frames(recal, moved, 0.5f, 4 * ROD_RECALIBRATION_WINDOW);
+    usleep(SETTLE_US);
+    TEST_ASSERT(!rod_recalibrator_swap(recal, &active), "no second calibration for the same view");
+
+    release_image(active.field_mask);
+    rod_recalibrator_destroy(recal);
+    return 0;
+}
+
+typedef struct {
+    const char* name;
+    int (*func)(void);
+} TestCase;
+
+static const TestCase TESTS[] = {
+    {"Create", test_create},
+    {"Still camera", test_still_camera},
+    {"Outliers", test_outliers},
+    {"Moved camera", test_moved_camera}
+};
+
+#define NUM_TESTS (sizeof(TESTS) / sizeof(TestCase))
+
+int main() {
+    printf("========================================\n");
+    printf("Recalibration Test\n");
+    printf("========================================\n");
+    printf("Number of tests: %zu\n", NUM_TESTS);
+    printf("========================================\n\n");
+
+    srand(42);
+    for (size_t i = 0; i < NUM_TESTS; i++) {
+        printf("[%zu/%zu] %s... ", i + 1, NUM_TESTS, TESTS[i].name);
+        fflush(stdout);
+
+        if (TESTS[i].func() == 0) {
+            printf(COLOR_GREEN "PASS" COLOR_RESET "\n");
+            test_passed++;
+        } else {
+            printf(COLOR_RED "FAIL" COLOR_RESET "\n");
+            test_failed++;
+        }
+    }
+
+    printf("\n========================================\n");
+    printf("Results: %d passed, %d failed\n", test_passed, test_failed);
+    printf("========================================\n");
+
+    return (test_failed == 0) ? 0 : 1;
+}
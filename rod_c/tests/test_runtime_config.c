@@ -0,0 +1,209 @@
+/**
+ * test_runtime_config.c
+ *
+ * Validates the runtime configuration file (rod_runtime_config).
+ *
+ * Files are written in /tmp and loaded on top of the built-in defaults, the
+ * same way rod_detection does at startup and on SIGHUP.
+ *
+ * Tests:
+ * - Defaults: rod_config.h values
+ * - Missing file: rejected, output untouched
+ * - Partial file: keys override the base, the others keep it (comments, spaces)
+ * - Unknown key: whole file rejected
+ * - Invalid values: out of range, not an integer, unknown pipeline mode, min above max
+ * - Comparisons: detector and camera changes detected separately
+ */
+
+#include "rod_runtime_config.h"
+#include "rod_config.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// ANSI color codes
+#define COLOR_RED "\033[1;31m"
+#define COLOR_GREEN "\033[1;32m"
+#define COLOR_RESET "\033[0m"
+
+// Test case counter
+static int test_passed = 0;
+static int test_failed = 0;
+
+// Helper macro for test assertions
+#define TEST_ASSERT(condition, message) \
+    do { \
+        if (!(condition)) { \
+            fprintf(stderr, "    ASSERTION FAILED: %s\n", message); \
+            return -1; \
+        } \
+    } while(0)
+
+#define TEST_FILE "/tmp/test_rod_runtime_config.conf"
+
+static int write_file(const char* content) {
+    FILE* file = fopen(TEST_FILE, "w");
+    if (!file) return -1;
+    fputs(content, file);
+    fclose(file);
+    return 0;
+}
+
+/**
+ * @brief Load TEST_FILE holding content on top of the defaults
+ * @return Load result, config is set to a marker value first to detect writes
+ */
+static int load_content(const char* content, RodRuntimeConfig* config) {
+    RodRuntimeConfig defaults;
+    rod_runtime_config_set_defaults(&defaults);
+    rod_runtime_config_set_defaults(config);
+    config->save_debug_image_interval = -42;
+    if (write_file(content) != 0) return -2;
+    return rod_runtime_config_load(TEST_FILE, &defaults, config);
+}
+
+static int test_defaults(void) {
+    RodRuntimeConfig config;
+    rod_runtime_config_set_defaults(&config);
+    TEST_ASSERT(config.detector.adaptive_thresh_win_size_min == ROD_ADAPTIVE_THRESH_WIN_SIZE_MIN, "Window min");
+    TEST_ASSERT(config.detector.adaptive_thresh_win_size_max == ROD_ADAPTIVE_THRESH_WIN_SIZE_MAX, "Window max");
+    TEST_ASSERT(config.detector.adaptive_thresh_win_size_step == ROD_ADAPTIVE_THRESH_WIN_SIZE_STEP, "Window step");
+    TEST_ASSERT(config.detector.corner_refinement_method == CORNER_REFINE_SUBPIX, "Subpixel corner refinement");
+    TEST_ASSERT(config.camera.contrast == 1.5f && config.camera.sharpness == 4.0f, "Match camera parameters");
+    TEST_ASSERT(config.save_debug_image_interval == ROD_SAVE_DEBUG_IMAGE_INTERVAL, "Save interval");
+    TEST_ASSERT(config.sequential == false, "Pipelined by default");
+    return 0;
+}
+
+static int test_missing_file(void) {
+    RodRuntimeConfig base;
+    RodRuntimeConfig config;
+    rod_runtime_config_set_defaults(&base);
+    rod_runtime_config_set_defaults(&config);
+    config.save_debug_image_interval = -42;
+    unlink(TEST_FILE);
+    TEST_ASSERT(rod_runtime_config_load(TEST_FILE, &base, &config) == -1, "Missing file rejected");
+    TEST_ASSERT(config.save_debug_image_interval == -42, "Output untouched");
+    TEST_ASSERT(rod_runtime_config_load(NULL, &base, &config) == -1, "NULL path rejected");
+    return 0;
+}
+
+static int test_partial_file(void) {
+    RodRuntimeConfig config;
+    int result = load_content("# Faster profile\n"
+                              "\n"
+                              "adaptive_thresh_win_size_max = 23\n"
+                              "  adaptive_thresh_win_size_step=10   # fewer passes\n"
+                              "min_otsu_std_dev = 5.5\n"
+                              "camera_exposure_time = 8000\n"
+                              "camera_contrast = 2\n"
+                              "save_debug_image_interval = 30\n"
+                              "pipeline_mode = sequential\n",
+                              &config);
+    TEST_ASSERT(result == 0, "File loaded");
+    TEST_ASSERT(config.detector.adaptive_thresh_win_size_max == 23, "Window max overridden");
+    TEST_ASSERT(config.detector.adaptive_thresh_win_size_step == 10, "Window step overridden");
+    TEST_ASSERT(config.detector.min_otsu_std_dev == 5.5, "Double overridden");
+    TEST_ASSERT(config.camera.exposure_time == 8000, "Exposure overridden");
+    TEST_ASSERT(config.camera.contrast == 2.0f, "Float overridden");
+    TEST_ASSERT(config.save_debug_image_interval == 30, "Save interval overridden");
+    TEST_ASSERT(config.sequential == true, "Pipeline mode overridden");
+
+    // Keys missing from the file keep the base value
+    TEST_ASSERT(config.detector.adaptive_thresh_win_size_min == ROD_ADAPTIVE_THRESH_WIN_SIZE_MIN, "Window min kept");
+    TEST_ASSERT(config.camera.sharpness == 4.0f, "Sharpness kept");
+    return 0;
+}
+
+static int test_unknown_key(void) {
+    RodRuntimeConfig config;
+    int result = load_content("adaptive_thresh_win_size_max = 23\n"
+                              "adaptive_tresh_win_size_step = 10\n",
+                              &config);
+    TEST_ASSERT(result == -1, "Unknown key rejected");
+    TEST_ASSERT(config.save_debug_image_interval == -42, "Nothing applied");
+    TEST_ASSERT(load_content("adaptive_thresh_win_size_max 23\n", &config) == -1, "Missing '=' rejected");
+    return 0;
+}
+
+static int test_invalid_values(void) {
+    RodRuntimeConfig config;
+    TEST_ASSERT(load_content("adaptive_thresh_win_size_step = 0\n", &config) == -1, "Below range rejected");
+    TEST_ASSERT(load_content("camera_noise_reduction_mode = 7\n", &config) == -1, "Above range rejected");
+    TEST_ASSERT(load_content("adaptive_thresh_win_size_max = 23.5\n", &config) == -1, "Fraction for an integer rejected");
+    TEST_ASSERT(load_content("camera_contrast = high\n", &config) == -1, "Text for a number rejected");
+    TEST_ASSERT(load_content("camera_contrast =\n", &config) == -1, "Empty value rejected");
+    TEST_ASSERT(load_content("pipeline_mode = parallel\n", &config) == -1, "Unknown pipeline mode rejected");
+    TEST_ASSERT(load_content("adaptive_thresh_win_size_min = 31\nadaptive_thresh_win_size_max = 23\n", &config) == -1,
+                "Window min above max rejected");
+    TEST_ASSERT(config.save_debug_image_interval == -42, "Nothing applied");
+    return 0;
+}
+
+static int test_comparisons(void) {
+    RodRuntimeConfig a;
+    RodRuntimeConfig b;
+    rod_runtime_config_set_defaults(&a);
+    rod_runtime_config_set_defaults(&b);
+    TEST_ASSERT(rod_runtime_config_same_detector(&a, &b) && rod_runtime_config_same_camera(&a, &b), "Defaults equal");
+
+    b.save_debug_image_interval = 10;
+    b.sequential = true;
+    TEST_ASSERT(rod_runtime_config_same_detector(&a, &b) && rod_runtime_config_same_camera(&a, &b),
+                "Other settings need neither a detector nor a camera update");
+
+    b.detector.min_marker_perimeter_rate = 0.02;
+    TEST_ASSERT(!rod_runtime_config_same_detector(&a, &b), "Detector change detected");
+    TEST_ASSERT(rod_runtime_config_same_camera(&a, &b), "Camera unchanged");
+
+    b = a;
+    b.camera.analogue_gain = 2.0f;
+    TEST_ASSERT(rod_runtime_config_same_detector(&a, &b), "Detector unchanged");
+    TEST_ASSERT(!rod_runtime_config_same_camera(&a, &b), "Camera change detected");
+    return 0;
+}
+
+typedef struct {
+    const char* name;
+    int (*func)(void);
+} TestCase;
+
+static const TestCase TESTS[] = {
+    {"Defaults", test_defaults},
+    {"Missing file", test_missing_file},
+    {"Partial file", test_partial_file},
+    {"Unknown key", test_unknown_key},
+    {"Invalid values", test_invalid_values},
+    {"Comparisons", test_comparisons}
+};
+
+#define NUM_TESTS (sizeof(TESTS) / sizeof(TestCase))
+
+int main() {
+    printf("========================================\n");
+    printf("Runtime Configuration Test\n");
+    printf("========================================\n");
+    printf("Number of tests: %zu\n", NUM_TESTS);
+    printf("========================================\n\n");
+
+    for (size_t i = 0; i < NUM_TESTS; i++) {
+        printf("[%zu/%zu] %s... ", i + 1, NUM_TESTS, TESTS[i].name);
+        fflush(stdout);
+
+        if (TESTS[i].func() == 0) {
+            printf(COLOR_GREEN "PASS" COLOR_RESET "\n");
+            test_passed++;
+        } else {
+            printf(COLOR_RED "FAIL" COLOR_RESET "\n");
+            test_failed++;
+        }
+    }
+    unlink(TEST_FILE);
+
+    printf("\n========================================\n");
+    printf("Results: %d passed, %d failed\n", test_passed, test_failed);
+    printf("========================================\n");
+
+    return (test_failed == 0) ? 0 : 1;
+}
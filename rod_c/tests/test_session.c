@@ -0,0 +1,322 @@
+/**
+ * test_session.c
+ *
+ * Validates the recorded session file (rod_session): writing raw frames with
+ * their metadata, and replaying them from the mapping.
+ *
+ * Sessions are written in /tmp with small synthetic frames whose pixels encode
+ * the frame number, so every frame read back can be checked byte for byte.
+ *
+ * Tests:
+ * - Round trip: luma and BGR frames, padded source rows, metadata and detections read back
+ * - Random access: any frame in any order, index bounds
+ * - Recovery: session not closed or cut in the middle of a frame, frames before the cut kept
+ * - Invalid files: missing file, wrong magic, invalid frames rejected by the writer
+ */
+
+#include "rod_session.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// ANSI color codes
+#define COLOR_RED "\033[1;31m"
+#define COLOR_GREEN "\033[1;32m"
+#define COLOR_RESET "\033[0m"
+
+// Test case counter
+static int test_passed = 0;
+static int test_failed = 0;
+
+// Helper macro for test assertions
+#define TEST_ASSERT(condition, message) \
+    do { \
+        if (!(condition)) { \
+            fprintf(stderr, "    ASSERTION FAILED: %s\n", message); \
+            return -1; \
+        } \
+    } while(0)
+
+#define TEST_FILE "/tmp/test_rod_session.rods"
+#define FRAME_WIDTH 37   // Odd sizes: rows and records need padding
+#define FRAME_HEIGHT 21
+#define FRAME_PADDING 11 // Extra bytes per source row
+#define FRAME_COUNT 12
+
+static uint8_t pixel_value(int frame, int x, int y) {
+    return (uint8_t)(frame * 31 + x * 7 + y * 3);
+}
+
+/**
+ * @brief Fill frame number n: pixels from pixel_value(), n % 5 detections, controls derived from n
+ */
+static void make_frame(RodSessionFrame* frame, uint8_t* pixels, int n, int channels, size_t stride) {
+    memset(frame, 0, sizeof(*frame));
+    for (int y = 0; y < FRAME_HEIGHT; y++) {
+        for (int x = 0; x < FRAME_WIDTH * channels; x++) {
+            pixels[(size_t)y * stride + (size_t)x] = pixel_value(n, x, y);
+        }
+    }
+    frame->sequence = (uint32_t)(100 + n);
+    frame->timestamp_ns = 1000000000ULL * (uint64_t)n + 123;
+    frame->width = FRAME_WIDTH;
+    frame->height = FRAME_HEIGHT;
+    frame->channels = channels;
+    frame->stride = stride;
+    frame->data = pixels;
+    frame->controls.exposure_time = 8000 + n;
+    frame->controls.analogue_gain = 1.5f;
+    frame->controls.sharpness = 4.0f;
+    frame->controls.awb_enable = -1;
+    frame->controls.noise_reduction_mode = 2;
+    frame->detection_count = n % 5;
+    for (int i = 0; i < frame->detection_count; i++) {
+        frame->detections[i].id = 20 + i;
+        frame->detections[i].x = 100.5f * (float)n;
+        frame->detections[i].y = -2.25f * (float)i;
+        frame->detections[i].angle = 0.5f;
+    }
+}
+
+/**
+ * @brief Check a frame read back against make_frame(n)
+ */
+static int check_frame(const RodSessionFrame* frame, int n, int channels) {
+    TEST_ASSERT(frame->sequence == (uint32_t)(100 + n), "Sequence read back");
+    TEST_ASSERT(frame->timestamp_ns == 1000000000ULL * (uint64_t)n + 123, "Timestamp read back");
+    TEST_ASSERT(frame->width == FRAME_WIDTH && frame->height == FRAME_HEIGHT, "Size read back");
+    TEST_ASSERT(frame->channels == channels, "Channels read back");
+    TEST_ASSERT(frame->stride == (size_t)FRAME_WIDTH * (size_t)channels, "Rows stored packed");
+    TEST_ASSERT(((uintptr_t)frame->data % ROD_SESSION_ALIGN) == 0, "Pixels aligned in the mapping");
+    for (int y = 0; y < FRAME_HEIGHT; y++) {
+        for (int x = 0; x < FRAME_WIDTH * channels; x++) {
+            TEST_ASSERT(frame->data[(size_t)y * frame->stride + (size_t)x] == pixel_value(n, x, y), "Pixels read back");
+        }
+    }
+    TEST_ASSERT(frame->controls.exposure_time == 8000 + n && frame->controls.analogue_gain == 1.5f &&
+                frame->controls.sharpness == 4.0f && frame->controls.awb_enable == -1 &&
+                frame->controls.noise_reduction_mode == 2, "Controls read back");
+    TEST_ASSERT(frame->detection_count == n % 5, "Detection count read back");
+    for (int i = 0; i < frame->detection_count; i++) {
+        TEST_ASSERT(frame->detections[i].id == 20 + i && frame->detections[i].x == 100.5f * (float)n &&
+                    frame->detections[i].y == -2.25f * (float)i && frame->detections[i].angle == 0.5f,
+                    "Detection read back");
+    }
+    return 0;
+}
+
+/**
+ * @brief Write FRAME_COUNT frames, luma on even frames and BGR on odd ones (BGR rows padded)
+ */
+static int write_session(void) {
+    RodSessionWriter* writer = rod_session_writer_create(TEST_FILE);
+    if (!writer) return -1;
+
+    size_t stride = (size_t)FRAME_WIDTH * 3 + FRAME_PADDING;
+    uint8_t* pixels = malloc(stride * FRAME_HEIGHT);
+    RodSessionFrame* frame = malloc(sizeof(RodSessionFrame));
+    int result = (pixels && frame) ? 0 : -1;
+    for (int n = 0; result == 0 && n < FRAME_COUNT; n++) {
+        int channels = (n % 2 == 0) ? 1 : 3;
+        make_frame(frame, pixels, n, channels, channels == 1 ? (size_t)FRAME_WIDTH : stride);
+        result = rod_session_writer_append(writer, frame);
+    }
+    if (result == 0 && rod_session_writer_count(writer) != FRAME_COUNT) result = -1;
+    free(pixels);
+    free(frame);
+
+    if (rod_session_writer_close(writer) != 0) result = -1;
+    return result;
+}
+
+static long file_size(const char* path) {
+    FILE* file = fopen(path, "rb");
+    if (!file) return -1;
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fclose(file);
+    return size;
+}
+
+static int test_round_trip(void) {
+    TEST_ASSERT(write_session() == 0, "Session written");
+    TEST_ASSERT(rod_session_is_file(TEST_FILE), "Session file recognized");
+
+    RodSessionReader* reader = rod_session_reader_open(TEST_FILE);
+    TEST_ASSERT(reader, "Session opened");
+    TEST_ASSERT(rod_session_reader_count(reader) == FRAME_COUNT, "Frame count");
+    TEST_ASSERT(rod_session_reader_is_complete(reader), "Index present");
+
+    RodSessionFrame* frame = malloc(sizeof(RodSessionFrame));
+    TEST_ASSERT(frame, "Frame allocated");
+    int result = 0;
+    for (int n = 0; result == 0 && n < FRAME_COUNT; n++) {
+        result = (rod_session_reader_get(reader, n, frame) == 0) ? check_frame(frame, n, n % 2 == 0 ? 1 : 3) : -1;
+    }
+    free(frame);
+    rod_session_reader_close(reader);
+    TEST_ASSERT(result == 0, "Every frame read back");
+    return 0;
+}
+
+static int test_random_access(void) {
+    TEST_ASSERT(write_session() == 0, "Session written");
+    RodSessionReader* reader = rod_session_reader_open(TEST_FILE);
+    TEST_ASSERT(reader, "Session opened");
+
+    static const int ORDER[] = {7, 0, 11, 3, 3, 10, 1};
+    RodSessionFrame* frame = malloc(sizeof(RodSessionFrame));
+    TEST_ASSERT(frame, "Frame allocated");
+    int result = 0;
+    for (size_t i = 0; result == 0 && i < sizeof(ORDER) / sizeof(ORDER[0]); i++) {
+        int n = ORDER[i];
+        result = (rod_session_reader_get(reader, n, frame) == 0) ? check_frame(frame, n, n % 2 == 0 ? 1 : 3) : -1;
+    }
+    int below = rod_session_reader_get(reader, -1, frame);
+    int above = rod_session_reader_get(reader, FRAME_COUNT, frame);
+    free(frame);
+    rod_session_reader_close(reader);
+
+    TEST_ASSERT(result == 0, "Frames read in any order");
+    TEST_ASSERT(below == -1 && above == -1, "Out of range index rejected");
+    TEST_ASSERT(rod_session_reader_count(NULL) == 0 && rod_session_reader_get(NULL, 0, NULL) == -1, "NULL reader");
+    return 0;
+}
+
+/**
+ * @brief Keep the first size bytes of TEST_FILE and clear the frame count and index offset from the header
+ */
+static int cut_session(long size) {
+    if (truncate(TEST_FILE, size) != 0) return -1;
+    FILE* file = fopen(TEST_FILE, "r+b");
+    if (!file) return -1;
+    static const uint8_t zeros[16];
+    int result = (fseek(file, 16, SEEK_SET) == 0 && fwrite(zeros, 1, sizeof(zeros), file) == sizeof(zeros)) ? 0 : -1;
+    fclose(file);
+    return result;
+}
+
+static int test_recovery(void) {
+    TEST_ASSERT(write_session() == 0, "Session written");
+    RodSessionFrame* frame = malloc(sizeof(RodSessionFrame));
+    TEST_ASSERT(frame, "Frame allocated");
+
+    // Process killed after the last frame: no index (16-byte header + offsets), every frame walked
+    long records_end = file_size(TEST_FILE) - (16 + 8 * FRAME_COUNT);
+    TEST_ASSERT(cut_session(records_end) == 0, "Index removed");
+    RodSessionReader* reader = rod_session_reader_open(TEST_FILE);
+    TEST_ASSERT(reader, "Session without index opened");
+    TEST_ASSERT(!rod_session_reader_is_complete(reader), "Reported as recovered");
+    TEST_ASSERT(rod_session_reader_count(reader) == FRAME_COUNT, "Every frame recovered");
+    TEST_ASSERT(rod_session_reader_get(reader, FRAME_COUNT - 1, frame) == 0 &&
+                check_frame(frame, FRAME_COUNT - 1, 3) == 0, "Last frame intact");
+    rod_session_reader_close(reader);
+
+    // Power lost in the middle of the last frame: it is dropped, the others are kept
+    TEST_ASSERT(cut_session(records_end - 100) == 0, "Last frame cut");
+    reader = rod_session_reader_open(TEST_FILE);
+    TEST_ASSERT(reader, "Cut session opened");
+    TEST_ASSERT(rod_session_reader_count(reader) == FRAME_COUNT - 1, "Truncated frame dropped");
+    TEST_ASSERT(rod_session_reader_get(reader, FRAME_COUNT - 2, frame) == 0 &&
+                check_frame(frame, FRAME_COUNT - 2, 1) == 0, "Frames before the cut intact");
+    rod_session_reader_close(reader);
+    free(frame);
+
+    // Header only: a valid, empty session
+    TEST_ASSERT(cut_session(64) == 0, "Every frame cut");
+    reader = rod_session_reader_open(TEST_FILE);
+    TEST_ASSERT(reader && rod_session_reader_count(reader) == 0, "Empty session");
+    rod_session_reader_close(reader);
+    return 0;
+}
+
+static int test_invalid_files(void) {
+    unlink(TEST_FILE);
+    TEST_ASSERT(!rod_session_is_file(TEST_FILE), "Missing file not a session");
+    TEST_ASSERT(rod_session_reader_open(TEST_FILE) == NULL, "Missing file rejected");
+    TEST_ASSERT(rod_session_reader_open(NULL) == NULL, "NULL path rejected");
+
+    // A JPEG (or any other file) with the same size as a header
+    FILE* file = fopen(TEST_FILE, "wb");
+    TEST_ASSERT(file, "File created");
+    uint8_t bytes[256];
+    memset(bytes, 0xAB, sizeof(bytes));
+    bytes[0] = 0xFF;
+    bytes[1] = 0xD8;
+    fwrite(bytes, 1, sizeof(bytes), file);
+    fclose(file);
+    TEST_ASSERT(!rod_session_is_file(TEST_FILE), "Other file not a session");
+    TEST_ASSERT(rod_session_reader_open(TEST_FILE) == NULL, "Wrong magic rejected");
+
+    // Frames the format cannot hold
+    RodSessionWriter* writer = rod_session_writer_create(TEST_FILE);
+    TEST_ASSERT(writer, "Session created");
+    uint8_t pixels[FRAME_WIDTH * 4];
+    RodSessionFrame* frame = calloc(1, sizeof(RodSessionFrame));
+    TEST_ASSERT(frame, "Frame allocated");
+    frame->width = FRAME_WIDTH;
+    frame->height = 1;
+    frame->channels = 4;
+    frame->data = pixels;
+    int four_channels = rod_session_writer_append(writer, frame);
+    frame->channels = 3;
+    frame->stride = FRAME_WIDTH;
+    int short_stride = rod_session_writer_append(writer, frame);
+    frame->stride = 0;
+    frame->data = NULL;
+    int no_data = rod_session_writer_append(writer, frame);
+    free(frame);
+    TEST_ASSERT(four_channels == -1 && short_stride == -1 && no_data == -1, "Invalid frames rejected");
+    TEST_ASSERT(rod_session_writer_count(writer) == 0, "Nothing appended");
+    TEST_ASSERT(rod_session_writer_close(writer) == 0, "Empty session closed");
+    TEST_ASSERT(rod_session_writer_close(NULL) == 0, "NULL writer ignored");
+
+    RodSessionReader* reader = rod_session_reader_open(TEST_FILE);
+    TEST_ASSERT(reader && rod_session_reader_count(reader) == 0 && rod_session_reader_is_complete(reader),
+                "Empty session readable");
+    rod_session_reader_close(reader);
+    return 0;
+}
+
+typedef struct {
+    const char* name;
+    int (*func)(void);
+} TestCase;
+
+static const TestCase TESTS[] = {
+    {"Round trip", test_round_trip},
+    {"Random access", test_random_access},
+    {"Recovery", test_recovery},
+    {"Invalid files", test_invalid_files}
+};
+
+#define NUM_TESTS (sizeof(TESTS) / sizeof(TestCase))
+
+int main() {
+    printf("========================================\n");
+    printf("Recorded Session Test\n");
+    printf("========================================\n");
+    printf("Number of tests: %zu\n", NUM_TESTS);
+    printf("========================================\n\n");
+
+    for (size_t i = 0; i < NUM_TESTS; i++) {
+        printf("[%zu/%zu] %s... ", i + 1, NUM_TESTS, TESTS[i].name);
+        fflush(stdout);
+
+        if (TESTS[i].func() == 0) {
+            printf(COLOR_GREEN "PASS" COLOR_RESET "\n");
+            test_passed++;
+        } else {
+            printf(COLOR_RED "FAIL" COLOR_RESET "\n");
+            test_failed++;
+        }
+    }
+    unlink(TEST_FILE);
+
+    printf("\n========================================\n");
+    printf("Results: %d passed, %d failed\n", test_passed, test_failed);
+    printf("========================================\n");
+
+    return (test_failed == 0) ? 0 : 1;
+}
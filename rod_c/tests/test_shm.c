@@ -0,0 +1,313 @@
+/**
+ * test_shm.c
+ * 
+ * Validates the shared memory snapshot ring (single writer, many readers).
+ * 
+ * Tests:
+ * - Reader cannot open before the publisher exists
+ * - Snapshots are read in order, nothing pending once caught up
+ * - Slow reader loses the oldest snapshots (counted)
+ * - Latest snapshot skips older ones
+ * - Concurrent writer and readers (no torn snapshot, futex wakeups)
+ * - Readers notice when the publisher closes the ring
+ */
+
+#define _DEFAULT_SOURCE  // Required for usleep
+
+#include "rod_shm.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <unistd.h>
+
+// ANSI color codes
+#define COLOR_RED "\033[1;31m"
+#define COLOR_GREEN "\033[1;32m"
+#define COLOR_RESET "\033[0m"
+
+// Test case counter
+static int test_passed = 0;
+static int test_failed = 0;
+
+// Helper macro for test assertions
+#define TEST_ASSERT(condition, message) \
+    do { \
+        if (!(condition)) { \
+            fprintf(stderr, "    ASSERTION FAILED: %s\n", message); \
+            return -1; \
+        } \
+    } while(0)
+
+#define STRESS_SNAPSHOTS 200000
+#define STRESS_READERS 3
+
+static char g_name[64];
+
+/**
+ * @brief Publish a snapshot whose content is derived from sequence
+ */
+static void publish(RodShmPublisher* publisher, uint32_t sequence) {
+    RodProtocolMessage* message = rod_shm_publisher_begin(publisher);
+    message->sequence = sequence;
+    message->timestamp_us = (uint64_t)sequence * 33333;
+    message->flags = sequence & ROD_PROTOCOL_FLAG_CARRIED_OVER;
+    message->count = (int)(sequence % (ROD_PROTOCOL_MAX_MARKERS + 1));
+    for (int i = 0; i < message->count; i++) {
+        message->markers[i].id = (int32_t)(sequence + i);
+        message->markers[i].x = (float)sequence;
+        message->markers[i].y = (float)i;
+        message->markers[i].angle = 0.0f;
+    }
+    rod_shm_publisher_commit(publisher);
+}
+
+/**
+ * @brief Check that a snapshot is consistent with its sequence
+ */
+static bool is_consistent(const RodProtocolMessage* message) {
+    if (message->timestamp_us != (uint64_t)message->sequence * 33333) return false;
+    if (message->flags != (message->sequence & ROD_PROTOCOL_FLAG_CARRIED_OVER)) return false;
+    if (message->count != (int)(message->sequence % (ROD_PROTOCOL_MAX_MARKERS + 1))) return false;
+    for (int i = 0; i < message->count; i++) {
+        if (message->markers[i].id != (int32_t)(message->sequence + i) ||
+            message->markers[i].x != (float)message->sequence ||
+            message->markers[i].y != (float)i) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static RodProtocolMessage g_message;
+
+/**
+ * Test 1: Reader needs a running publisher
+ */
+int test_open() {
+    TEST_ASSERT(rod_shm_reader_open(g_name) == NULL, "open without publisher must fail");
+    
+    RodShmPublisher* publisher = rod_shm_publisher_create(g_name);
+    TEST_ASSERT(publisher != NULL, "publisher create must succeed");
+    RodShmReader* reader = rod_shm_reader_open(g_name);
+    TEST_ASSERT(reader != NULL, "open with publisher must succeed");
+    TEST_ASSERT(rod_shm_reader_next(reader, &g_message, NULL) == 0, "nothing published yet");
+    TEST_ASSERT(!rod_shm_reader_wait(reader, 10), "wait must time out");
+    
+    rod_shm_reader_close(reader);
+    rod_shm_publisher_destroy(publisher);
+    return 0;
+}
+
+/**
+ * Test 2: Snapshots come out in publication order
+ */
+int test_in_order() {
+    RodShmPublisher* publisher = rod_shm_publisher_create(g_name);
+    TEST_ASSERT(publisher != NULL, "publisher create must succeed");
+    RodShmReader* reader = rod_shm_reader_open(g_name);
+    TEST_ASSERT(reader != NULL, "open must succeed");
+    
+    for (uint32_t seq = 1; seq <= 5; seq++) publish(publisher, seq);
+    TEST_ASSERT(rod_shm_reader_wait(reader, 10), "snapshots must be available");
+    
+    for (uint32_t seq = 1; seq <= 5; seq++) {
+        unsigned long lost;
+        TEST_ASSERT(rod_shm_reader_next(reader, &g_message, &lost) == 1, "snapshot must be read");
+        TEST_ASSERT(lost == 0, "nothing must be lost");
+        TEST_ASSERT(g_message.sequence == seq, "snapshots must be read in order");
+        TEST_ASSERT(is_consistent(&g_message), "snapshot must be consistent");
+    }
+    TEST_ASSERT(rod_shm_reader_next(reader, &g_message, NULL) == 0, "caught up");
+    
+    // A new reader starts at the latest snapshot
+    RodShmReader* late = rod_shm_reader_open(g_name);
+    TEST_ASSERT(late != NULL, "second open must succeed");
+    TEST_ASSERT(rod_shm_reader_next(late, &g_message, NULL) == 1 && g_message.sequence == 5,
+                "new reader must get the latest snapshot");
+    rod_shm_reader_close(late);
+    
+    rod_shm_reader_close(reader);
+    rod_shm_publisher_destroy(publisher);
+    return 0;
+}
+
+/**
+ * Test 3: Reader lapped by the writer loses the oldest snapshots
+ */
+int test_overrun() {
+    RodShmPublisher* publisher = rod_shm_publisher_create(g_name);
+    TEST_ASSERT(publisher != NULL, "publisher create must succeed");
+    RodShmReader* reader = rod_shm_reader_open(g_name);
+    TEST_ASSERT(reader != NULL, "open must succeed");
+    
+    const uint32_t total = 3 * ROD_SHM_SLOTS;
+    for (uint32_t seq = 1; seq <= total; seq++) publish(publisher, seq);
+    
+    unsigned long lost = 0;
+    TEST_ASSERT(rod_shm_reader_next(reader, &g_message, &lost) == 1, "snapshot must be read");
+    TEST_ASSERT(lost > 0, "lost snapshots must be reported");
+    TEST_ASSERT(g_message.sequence == lost + 1, "first readable snapshot follows the lost ones");
+    
+    uint32_t expected = g_message.sequence + 1;
+    while (rod_shm_reader_next(reader, &g_message, &lost) == 1) {
+        TEST_ASSERT(lost == 0 && g_message.sequence == expected, "remaining snapshots must be in order");
+        expected++;
+    }
+    TEST_ASSERT(expected == total + 1, "reader must reach the latest snapshot");
+    
+    rod_shm_reader_close(reader);
+    rod_shm_publisher_destroy(publisher);
+    return 0;
+}
+
+/**
+ * Test 4: Latest skips unread snapshots
+ */
+int test_latest() {
+    RodShmPublisher* publisher = rod_shm_publisher_create(g_name);
+    TEST_ASSERT(publisher != NULL, "publisher create must succeed");
+    RodShmReader* reader = rod_shm_reader_open(g_name);
+    TEST_ASSERT(reader != NULL, "open must succeed");
+    
+    for (uint32_t seq = 1; seq <= 7; seq++) publish(publisher, seq);
+    TEST_ASSERT(rod_shm_reader_latest(reader, &g_message) == 1, "latest must be read");
+    TEST_ASSERT(g_message.sequence == 7, "latest snapshot must be returned");
+    TEST_ASSERT(rod_shm_reader_latest(reader, &g_message) == 0, "nothing new");
+    
+    rod_shm_reader_close(reader);
+    rod_shm_publisher_destroy(publisher);
+    return 0;
+}
+
+typedef struct {
+    RodShmReader* reader;
+    atomic_bool* done;
+    unsigned long read;
+    unsigned long torn;
+    unsigned long out_of_order;
+} ReaderArgs;
+
+static void* reader_thread(void* arg) {
+    ReaderArgs* args = (ReaderArgs*)arg;
+    static _Thread_local RodProtocolMessage message;
+    uint32_t last = 0;
+    
+    while (!atomic_load(args->done)) {
+        rod_shm_reader_wait(args->reader, 10);
+        while (rod_shm_reader_next(args->reader, &message, NULL) == 1) {
+            if (!is_consistent(&message)) args->torn++;
+            if (message.sequence <= last) args->out_of_order++;
+            last = message.sequence;
+            args->read++;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Test 5: Concurrent writer and readers never see a torn snapshot
+ */
+int test_concurrent() {
+    RodShmPublisher* publisher = rod_shm_publisher_create(g_name);
+    TEST_ASSERT(publisher != NULL, "publisher create must succeed");
+    
+    atomic_bool done = false;
+    ReaderArgs args[STRESS_READERS];
+    pthread_t threads[STRESS_READERS];
+    for (int i = 0; i < STRESS_READERS; i++) {
+        memset(&args[i], 0, sizeof(args[i]));
+        args[i].reader = rod_shm_reader_open(g_name);
+        args[i].done = &done;
+        TEST_ASSERT(args[i].reader != NULL, "open must succeed");
+        pthread_create(&threads[i], NULL, reader_thread, &args[i]);
+    }
+    
+    for (uint32_t seq = 1; seq <= STRESS_SNAPSHOTS; seq++) {
+        publish(publisher, seq);
+        if (seq % 1000 == 0) usleep(100);  // Let sleeping readers be woken up
+    }
+    usleep(20000);
+    atomic_store(&done, true);
+    
+    unsigned long torn = 0, out_of_order = 0, read = 0;
+    for (int i = 0; i < STRESS_READERS; i++) {
+        pthread_join(threads[i], NULL);
+        torn += args[i].torn;
+        out_of_order += args[i].out_of_order;
+        read += args[i].read;
+        rod_shm_reader_close(args[i].reader);
+    }
+    rod_shm_publisher_destroy(publisher);
+    
+    printf("(%lu snapshots read) ", read);
+    TEST_ASSERT(read > 0, "readers must read snapshots");
+    TEST_ASSERT(torn == 0, "no snapshot may be torn");
+    TEST_ASSERT(out_of_order == 0, "snapshots must be read in order");
+    return 0;
+}
+
+/**
+ * Test 6: Closing the ring is reported to readers
+ */
+int test_close() {
+    RodShmPublisher* publisher = rod_shm_publisher_create(g_name);
+    TEST_ASSERT(publisher != NULL, "publisher create must succeed");
+    RodShmReader* reader = rod_shm_reader_open(g_name);
+    TEST_ASSERT(reader != NULL, "open must succeed");
+    
+    rod_shm_publisher_destroy(publisher);
+    TEST_ASSERT(!rod_shm_reader_wait(reader, 10), "wait must fail once closed");
+    TEST_ASSERT(rod_shm_reader_next(reader, &g_message, NULL) == -1, "next must report closed ring");
+    TEST_ASSERT(rod_shm_reader_open(g_name) == NULL, "open after close must fail");
+    
+    rod_shm_reader_close(reader);
+    return 0;
+}
+
+// Test suite definition
+typedef struct {
+    const char* name;
+    int (*func)();
+} TestCase;
+
+static const TestCase TESTS[] = {
+    {"Open", test_open},
+    {"In order", test_in_order},
+    {"Overrun", test_overrun},
+    {"Latest", test_latest},
+    {"Concurrent writer and readers", test_concurrent},
+    {"Close", test_close}
+};
+
+#define NUM_TESTS (sizeof(TESTS) / sizeof(TestCase))
+
+int main() {
+    snprintf(g_name, sizeof(g_name), "/rod_test_shm_%d", (int)getpid());
+    
+    printf("========================================\n");
+    printf("Shared Memory Ring Test\n");
+    printf("========================================\n");
+    printf("Number of tests: %zu\n", NUM_TESTS);
+    printf("========================================\n\n");
+    
+    for (size_t i = 0; i < NUM_TESTS; i++) {
+        printf("[%zu/%zu] %s... ", i + 1, NUM_TESTS, TESTS[i].name);
+        fflush(stdout);
+        
+        if (TESTS[i].func() == 0) {
+            printf(COLOR_GREEN "PASS" COLOR_RESET "\n");
+            test_passed++;
+        } else {
+            printf(COLOR_RED "FAIL" COLOR_RESET "\n");
+            test_failed++;
+        }
+    }
+    
+    printf("\n========================================\n");
+    printf("Results: %d passed, %d failed\n", test_passed, test_failed);
+    printf("========================================\n");
+    
+    return (test_failed == 0) ? 0 : 1;
+}
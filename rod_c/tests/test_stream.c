@@ -0,0 +1,294 @@
+/**
+ * test_stream.c
+ *
+ * Validates the live MJPEG stream server (rod_stream).
+ *
+ * The server listens on a free port (port 0) of the loopback interface and
+ * is driven by plain TCP clients. Encoding is software only (no V4L2
+ * encoder device), so the test runs on any machine.
+ *
+ * Tests:
+ * - Invalid arguments
+ * - Page and unknown URL: HTML page on "/", 404 otherwise
+ * - Frame tap: no frame wanted while nobody watches
+ * - Stream client: multipart header, then tap rate limited to max_fps
+ * - Submitted frame: one JPEG part per frame
+ * - Client leaving: counted out, tap stops
+ */
+
+#include "rod_stream.h"
+#include "opencv_wrapper.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <poll.h>
+#include <time.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+// ANSI color codes
+#define COLOR_RED "\033[1;31m"
+#define COLOR_GREEN "\033[1;32m"
+#define COLOR_RESET "\033[0m"
+
+// Test case counter
+static int test_passed = 0;
+static int test_failed = 0;
+
+// Helper macro for test assertions
+#define TEST_ASSERT(condition, message) \
+    do { \
+        if (!(condition)) { \
+            fprintf(stderr, "    ASSERTION FAILED: %s\n", message); \
+            return -1; \
+        } \
+    } while(0)
+
+#define TEST_FPS 10
+#define TEST_QUALITY 60
+#define RESPONSE_SIZE 65536
+#define RECEIVE_TIMEOUT_MS 2000
+
+static uint64_t now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ULL + (uint64_t)ts.tv_nsec / 1000ULL;
+}
+
+static void sleep_ms(int ms) {
+    struct timespec ts = {ms / 1000, (long)(ms % 1000) * 1000000L};
+    nanosleep(&ts, NULL);
+}
+
+/**
+ * @brief Connect to the server and send a GET request
+ * @return Socket, -1 on failure
+ */
+static int http_get(int port, const char* path) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons((uint16_t)port);
+    if (connect(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0) {
+        close(fd);
+        return -1;
+    }
+
+    char request[256];
+    int length = snprintf(request, sizeof(request), "GET %s HTTP/1.0\r\nHost: localhost\r\n\r\n", path);
+    if (send(fd, request, (size_t)length, 0) != length) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+/**
+ * @brief Receive until the response contains needle (or the connection closes / times out)
+ * @return Bytes received, the buffer is null terminated
+ */
+static size_t receive_until(int fd, char* buffer, size_t capacity, const char* needle) {
+    size_t length = 0;
+    buffer[0] = '\0';
+    while (length < capacity - 1 && !(needle && strstr(buffer, needle))) {
+        struct pollfd pfd = {fd, POLLIN, 0};
+        if (poll(&pfd, 1, RECEIVE_TIMEOUT_MS) <= 0) break;
+        ssize_t received = recv(fd, buffer + length, capacity - 1 - length, 0);
+        if (received <= 0) break;
+        length += (size_t)received;
+        buffer[length] = '\0';  // JPEG bytes may hold zeros: strstr only sees the text before them
+    }
+    return length;
+}
+
+/**
+ * @brief Wait until the server counts the expected number of stream clients
+ */
+static int wait_for_clients(RodStream* stream, int expected) {
+    for (int i = 0; i < RECEIVE_TIMEOUT_MS / 10; i++) {
+        RodStreamStats stats;
+        rod_stream_get_stats(stream, &stats);
+        if (stats.clients == expected) return 0;
+        sleep_ms(10);
+    }
+    return -1;
+}
+
+static RodStream* create_test_stream(void) {
+    return rod_stream_create(0, TEST_FPS, TEST_QUALITY, NULL, false);
+}
+
+static int test_invalid_arguments(void) {
+    TEST_ASSERT(rod_stream_create(-1, TEST_FPS, TEST_QUALITY, NULL, false) == NULL, "Negative port rejected");
+    TEST_ASSERT(rod_stream_create(0, 0, TEST_QUALITY, NULL, false) == NULL, "Zero frame rate rejected");
+    TEST_ASSERT(rod_stream_wants_frame(NULL, now_us()) == false, "NULL stream never wants a frame");
+    TEST_ASSERT(rod_stream_get_port(NULL) == -1, "NULL stream has no port");
+    rod_stream_submit(NULL, NULL);
+    rod_stream_destroy(NULL);
+    return 0;
+}
+
+static int test_page_and_not_found(void) {
+    RodStream* stream = create_test_stream();
+    TEST_ASSERT(stream != NULL, "Stream created");
+    int port = rod_stream_get_port(stream);
+    TEST_ASSERT(port > 0, "Listening on a port");
+
+    static char response[RESPONSE_SIZE];
+    int fd = http_get(port, "/");
+    TEST_ASSERT(fd >= 0, "Connected for the page");
+    receive_until(fd, response, sizeof(response), NULL);
+    close(fd);
+    TEST_ASSERT(strncmp(response, "HTTP/1.0 200 OK", 15) == 0, "Page answered with 200");
+    TEST_ASSERT(strstr(response, "Content-Type: text/html") != NULL, "Page is HTML");
+    TEST_ASSERT(strstr(response, "src=\"/video_feed\"") != NULL, "Page embeds the stream");
+
+    fd = http_get(port, "/missing");
+    TEST_ASSERT(fd >= 0, "Connected for an unknown URL");
+    receive_until(fd, response, sizeof(response), NULL);
+    close(fd);
+    TEST_ASSERT(strncmp(response, "HTTP/1.0 404", 12) == 0, "Unknown URL answered with 404");
+
+    rod_stream_destroy(stream);
+    return 0;
+}
+
+static int test_no_client_no_frame(void) {
+    RodStream* stream = create_test_stream();
+    TEST_ASSERT(stream != NULL, "Stream created");
+
+    TEST_ASSERT(rod_stream_wants_frame(stream, now_us()) == false, "No frame wanted without client");
+
+    // A page visitor is not a stream client
+    int fd = http_get(rod_stream_get_port(stream), "/");
+    TEST_ASSERT(fd >= 0, "Connected for the page");
+    static char response[RESPONSE_SIZE];
+    receive_until(fd, response, sizeof(response), NULL);
+    close(fd);
+    TEST_ASSERT(rod_stream_wants_frame(stream, now_us()) == false, "Still no frame wanted");
+
+    rod_stream_destroy(stream);
+    return 0;
+}
+
+static int test_stream_client_rate_limit(void) {
+    RodStream* stream = create_test_stream();
+    TEST_ASSERT(stream != NULL, "Stream created");
+
+    int fd = http_get(rod_stream_get_port(stream), "/video_feed");
+    TEST_ASSERT(fd >= 0, "Connected to the stream");
+    static char response[RESPONSE_SIZE];
+    receive_until(fd, response, sizeof(response), "\r\n\r\n");
+    TEST_ASSERT(strstr(response, "multipart/x-mixed-replace; boundary=frame") != NULL, "Multipart header received");
+    TEST_ASSERT(wait_for_clients(stream, 1) == 0, "Client counted");
+
+    uint64_t t = now_us();
+    uint64_t interval = 1000000ULL / TEST_FPS;
+    TEST_ASSERT(rod_stream_wants_frame(stream, t) == true, "First frame wanted");
+    TEST_ASSERT(rod_stream_wants_frame(stream, t + interval / 2) == false, "Frame within the period skipped");
+    TEST_ASSERT(rod_stream_wants_frame(stream, t + interval) == true, "Frame of the next period wanted");
+
+    close(fd);
+    rod_stream_destroy(stream);
+    return 0;
+}
+
+static int test_submitted_frame(void) {
+    RodStream* stream = create_test_stream();
+    TEST_ASSERT(stream != NULL, "Stream created");
+
+    int fd = http_get(rod_stream_get_port(stream), "/video_feed");
+    TEST_ASSERT(fd >= 0, "Connected to the stream");
+    static char response[RESPONSE_SIZE];
+    receive_until(fd, response, sizeof(response), "\r\n\r\n");
+    TEST_ASSERT(wait_for_clients(stream, 1) == 0, "Client counted");
+
+    ImageHandle* image = create_empty_image(64, 48, 3);
+    TEST_ASSERT(image != NULL, "Image created");
+    TEST_ASSERT(rod_stream_wants_frame(stream, now_us()) == true, "Frame wanted");
+    rod_stream_submit(stream, image);
+
+    receive_until(fd, response, sizeof(response), "Content-Length: ");
+    TEST_ASSERT(strstr(response, "--frame\r\nContent-Type: image/jpeg\r\n") != NULL, "JPEG part received");
+
+    RodStreamStats stats;
+    for (int i = 0; i < RECEIVE_TIMEOUT_MS / 10; i++) {
+        rod_stream_get_stats(stream, &stats);
+        if (stats.frames_sent == 1) break;
+        sleep_ms(10);
+    }
+    TEST_ASSERT(stats.frames_sent == 1, "One frame sent");
+    TEST_ASSERT(stats.hardware == false, "Software encoder without device");
+
+    close(fd);
+    rod_stream_destroy(stream);
+    return 0;
+}
+
+static int test_client_leaving(void) {
+    RodStream* stream = create_test_stream();
+    TEST_ASSERT(stream != NULL, "Stream created");
+
+    int fd = http_get(rod_stream_get_port(stream), "/video_feed");
+    TEST_ASSERT(fd >= 0, "Connected to the stream");
+    static char response[RESPONSE_SIZE];
+    receive_until(fd, response, sizeof(response), "\r\n\r\n");
+    TEST_ASSERT(wait_for_clients(stream, 1) == 0, "Client counted");
+
+    close(fd);
+    TEST_ASSERT(wait_for_clients(stream, 0) == 0, "Client counted out");
+    TEST_ASSERT(rod_stream_wants_frame(stream, now_us()) == false, "No frame wanted once the client left");
+
+    rod_stream_destroy(stream);
+    return 0;
+}
+
+typedef struct {
+    const char* name;
+    int (*func)(void);
+} TestCase;
+
+static const TestCase TESTS[] = {
+    {"Invalid arguments", test_invalid_arguments},
+    {"Page and unknown URL", test_page_and_not_found},
+    {"No client, no frame", test_no_client_no_frame},
+    {"Stream client and rate limit", test_stream_client_rate_limit},
+    {"Submitted frame", test_submitted_frame},
+    {"Client leaving", test_client_leaving}
+};
+
+#define NUM_TESTS (sizeof(TESTS) / sizeof(TestCase))
+
+int main() {
+    printf("========================================\n");
+    printf("Live Stream Test\n");
+    printf("========================================\n");
+    printf("Number of tests: %zu\n", NUM_TESTS);
+    printf("========================================\n\n");
+
+    for (size_t i = 0; i < NUM_TESTS; i++) {
+        printf("[%zu/%zu] %s... ", i + 1, NUM_TESTS, TESTS[i].name);
+        fflush(stdout);
+
+        if (TESTS[i].func() == 0) {
+            printf(COLOR_GREEN "PASS" COLOR_RESET "\n");
+            test_passed++;
+        } else {
+            printf(COLOR_RED "FAIL" COLOR_RESET "\n");
+            test_failed++;
+        }
+    }
+
+    printf("\n========================================\n");
+    printf("Results: %d passed, %d failed\n", test_passed, test_failed);
+    printf("========================================\n");
+
+    return (test_failed == 0) ? 0 : 1;
+}